@@ -0,0 +1,94 @@
+#! /usr/bin/env python
+"""
+Compare microbenchmark results against a stored baseline.
+
+The results are written by the 'tests microbench <file>' command, e.g. with
+'make px4_sitl_default microbench' (written to build/px4_sitl_default/microbench.json).
+
+Timings depend on the machine, so the baseline should be recorded on the
+same host the results are compared on:
+
+    microbench_compare.py --update microbench.json baseline.json
+    ...
+    microbench_compare.py microbench.json baseline.json
+
+Exits with a nonzero status if any benchmark got slower than the threshold.
+"""
+
+from __future__ import print_function
+
+import argparse
+import json
+import shutil
+import sys
+
+
+def load(file_name):
+    """ load a results file into a dict of (suite, name) -> mean in us """
+    with open(file_name, 'r') as f:
+        data = json.load(f)
+
+    results = {}
+    for entry in data['benchmarks']:
+        results[(entry['suite'], entry['name'])] = float(entry['mean_us'])
+    return results
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Compare microbenchmark results against a baseline')
+    parser.add_argument('results', help='JSON results of the current run')
+    parser.add_argument('baseline', help='JSON results to compare against')
+    parser.add_argument('-t', '--threshold', type=float, default=10.0,
+                        help='allowed slowdown in percent (default: %(default)s)')
+    parser.add_argument('--min-us', type=float, default=0.05,
+                        help='ignore differences below this absolute time in us (default: %(default)s)')
+    parser.add_argument('-u', '--update', action='store_true',
+                        help='store the results as new baseline instead of comparing')
+    parser.add_argument('-v', '--verbose', action='store_true',
+                        help='print all benchmarks, not only the regressions')
+    args = parser.parse_args()
+
+    if args.update:
+        load(args.results)  # make sure the file is valid
+        shutil.copyfile(args.results, args.baseline)
+        print('stored {:} as baseline {:}'.format(args.results, args.baseline))
+        return 0
+
+    results = load(args.results)
+    baseline = load(args.baseline)
+
+    regressions = 0
+
+    for key in sorted(results):
+        mean = results[key]
+        name = '{:} / {:}'.format(key[0], key[1])
+
+        if key not in baseline:
+            if args.verbose:
+                print('{:<60} {:10.3f} us (new)'.format(name, mean))
+            continue
+
+        base = baseline[key]
+        change = (mean - base) / base * 100.0 if base > 0 else 0.0
+        slower = mean > base * (1.0 + args.threshold / 100.0) and (mean - base) > args.min_us
+
+        if slower:
+            regressions += 1
+
+        if slower or args.verbose:
+            print('{:<60} {:10.3f} us (baseline {:10.3f} us, {:+6.1f}%){:}'.format(
+                name, mean, base, change, ' REGRESSION' if slower else ''))
+
+    for key in sorted(set(baseline) - set(results)):
+        print('{:} / {:} missing in results'.format(key[0], key[1]))
+
+    if regressions > 0:
+        print('{:} benchmark(s) more than {:}% slower than the baseline'.format(regressions, args.threshold))
+        return 1
+
+    print('no regressions ({:} benchmarks compared)'.format(len(set(results) & set(baseline))))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -18,9 +18,14 @@ set(tests
 	int
 	mathlib
 	matrix
+	microbench_dataman
 	microbench_hrt
 	microbench_math
 	microbench_matrix
+	microbench_mixer
+	microbench_param
+	microbench_perf
+	microbench_poll
 	microbench_uorb
 	mixer
 	param
@@ -140,6 +145,24 @@ foreach(cmd_name ${test_cmds})
 	set_tests_properties(posix_${cmd_name} PROPERTIES PASS_REGULAR_EXPRESSION "Shutting down")
 endforeach()
 
+# microbenchmarks, results are written to microbench.json in the build directory
+# (compare against a baseline with Tools/microbench_compare.py)
+set(test_name "microbench ${PX4_BINARY_DIR}/microbench.json")
+configure_file(${PX4_SOURCE_DIR}/posix-configs/SITL/init/test/test_template.in ${PX4_SOURCE_DIR}/posix-configs/SITL/init/test/test_microbench_generated)
+
+add_custom_target(microbench
+		COMMAND ${PX4_SOURCE_DIR}/Tools/sitl_run.sh
+			$<TARGET_FILE:px4>
+			none
+			none
+			test_microbench_generated
+			${PX4_SOURCE_DIR}
+			${PX4_BINARY_DIR}
+		DEPENDS px4
+		USES_TERMINAL
+		COMMENT "Running microbenchmarks in sitl"
+		WORKING_DIRECTORY ${SITL_WORKING_DIR})
+set_target_properties(microbench PROPERTIES EXCLUDE_FROM_ALL TRUE)
 
 add_custom_target(test_results
 		COMMAND ${CMAKE_CTEST_COMMAND} --output-on-failure -T Test
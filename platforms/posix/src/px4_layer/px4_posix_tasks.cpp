@@ -56,6 +56,11 @@
 #include <sys/types.h>
 #include <string>
 
+#ifdef __PX4_LINUX
+#include <dirent.h>
+#include <sys/syscall.h>
+#endif
+
 #include <px4_tasks.h>
 #include <px4_posix.h>
 #include <systemlib/err.h>
@@ -70,15 +75,17 @@ pthread_mutex_t task_mutex = PTHREAD_MUTEX_INITIALIZER;
 
 struct task_entry {
 	pthread_t pid;
+	int tid; // kernel thread id, set once the thread runs
 	std::string name;
 	bool isused;
-	task_entry() : isused(false) {}
+	task_entry() : tid(0), isused(false) {}
 };
 
 static task_entry taskmap[PX4_MAX_TASKS] = {};
 
 typedef struct {
 	px4_main_t entry;
+	px4_task_t taskid;
 	char name[16]; //pthread_setname_np is restricted to 16 chars
 	int argc;
 	char *argv[];
@@ -102,6 +109,12 @@ static void *entry_adapter(void *ptr)
 		PX4_ERR("px4_task_spawn_cmd: failed to set name of thread %d %d\n", rv, errno);
 	}
 
+#ifdef __PX4_LINUX
+	pthread_mutex_lock(&task_mutex);
+	taskmap[data->taskid].tid = (int)syscall(SYS_gettid);
+	pthread_mutex_unlock(&task_mutex);
+#endif
+
 	data->entry(data->argc, data->argv);
 	free(ptr);
 	PX4_DEBUG("Before px4_task_exit");
@@ -236,6 +249,7 @@ px4_task_t px4_task_spawn_cmd(const char *name, int scheduler, int priority, int
 	for (i = 0; i < PX4_MAX_TASKS; ++i) {
 		if (!taskmap[i].isused) {
 			taskmap[i].name = name;
+			taskmap[i].tid = 0;
 			taskmap[i].isused = true;
 			taskid = i;
 			break;
@@ -249,6 +263,8 @@ px4_task_t px4_task_spawn_cmd(const char *name, int scheduler, int priority, int
 		return -ENOSPC;
 	}
 
+	taskdata->taskid = taskid;
+
 	rv = pthread_create(&taskmap[taskid].pid, &attr, &entry_adapter, (void *) taskdata);
 
 	if (rv != 0) {
@@ -450,3 +466,155 @@ int px4_prctl(int option, const char *arg2, px4_task_t pid)
 	return rv;
 }
 
+#ifdef __PX4_LINUX
+static int read_proc_file(const char *path, char *buffer, int length)
+{
+	int fd = open(path, O_RDONLY);
+
+	if (fd < 0) {
+		return -errno;
+	}
+
+	int ret = read(fd, buffer, length - 1);
+	close(fd);
+
+	if (ret < 0) {
+		return -errno;
+	}
+
+	buffer[ret] = '\0';
+	return ret;
+}
+
+static uint64_t read_status_value(const char *status, const char *key)
+{
+	const char *value = strstr(status, key);
+	unsigned long long ret = 0;
+
+	if (value) {
+		sscanf(value + strlen(key), " %llu", &ret);
+	}
+
+	return ret;
+}
+
+static bool read_thread_stats(int tid, px4_task_stats_t *stats)
+{
+	char path[64];
+	char buffer[2048];
+
+	memset(stats, 0, sizeof(*stats));
+	stats->tid = tid;
+	stats->task = -1;
+
+	snprintf(path, sizeof(path), "/proc/self/task/%i/stat", tid);
+
+	if (read_proc_file(path, buffer, sizeof(buffer)) <= 0) {
+		return false; // thread exited in the meantime
+	}
+
+	// the name is in parentheses and can contain spaces, the other fields follow the last ')'
+	char *name_start = strchr(buffer, '(');
+	char *name_end = strrchr(buffer, ')');
+
+	if (name_start == nullptr || name_end == nullptr || name_end < name_start) {
+		return false;
+	}
+
+	size_t name_len = name_end - name_start - 1;
+
+	if (name_len >= sizeof(stats->name)) {
+		name_len = sizeof(stats->name) - 1;
+	}
+
+	memcpy(stats->name, name_start + 1, name_len);
+	stats->name[name_len] = '\0';
+
+	unsigned long utime = 0, stime = 0;
+	unsigned rt_priority = 0;
+
+	// fields 3 (state) to 40 (rt_priority), see proc(5)
+	sscanf(name_end + 1, " %c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %lu %lu"
+	       " %*d %*d %*d %*d %*d %*d %*u %*u %*d %*u %*u %*u %*u %*u %*u %*u %*u %*u %*u %*u %*u %*u %*d %*d %u",
+	       &stats->state, &utime, &stime, &rt_priority);
+
+	stats->priority = rt_priority;
+
+	// run and wait times with ns resolution, only available with CONFIG_SCHED_INFO
+	snprintf(path, sizeof(path), "/proc/self/task/%i/schedstat", tid);
+	unsigned long long run_ns = 0, wait_ns = 0, timeslices = 0;
+
+	if (read_proc_file(path, buffer, sizeof(buffer)) > 0 &&
+	    sscanf(buffer, "%llu %llu %llu", &run_ns, &wait_ns, &timeslices) == 3) {
+		stats->run_time = run_ns / 1000;
+		stats->wait_time = wait_ns / 1000;
+		stats->timeslices = timeslices;
+
+	} else {
+		const long ticks_per_sec = sysconf(_SC_CLK_TCK);
+		stats->run_time = (uint64_t)(utime + stime) * 1000000 / ticks_per_sec;
+	}
+
+	snprintf(path, sizeof(path), "/proc/self/task/%i/status", tid);
+
+	if (read_proc_file(path, buffer, sizeof(buffer)) > 0) {
+		stats->voluntary_switches = read_status_value(buffer, "voluntary_ctxt_switches:");
+		stats->involuntary_switches = read_status_value(buffer, "nonvoluntary_ctxt_switches:");
+	}
+
+	return true;
+}
+
+int px4_task_get_stats(px4_task_stats_t *stats, int max_count)
+{
+	DIR *dir = opendir("/proc/self/task");
+
+	if (dir == nullptr) {
+		return -errno;
+	}
+
+	int count = 0;
+	struct dirent *entry;
+
+	while ((entry = readdir(dir)) != nullptr) {
+		if (entry->d_name[0] < '0' || entry->d_name[0] > '9') {
+			continue;
+		}
+
+		if (count >= max_count) {
+			// stats is full, only count the remaining threads
+			++count;
+
+		} else if (read_thread_stats(atoi(entry->d_name), &stats[count])) {
+			++count;
+		}
+	}
+
+	closedir(dir);
+
+	const int filled = count < max_count ? count : max_count;
+
+	pthread_mutex_lock(&task_mutex);
+
+	for (int i = 0; i < filled; i++) {
+		for (int j = 0; j < PX4_MAX_TASKS; j++) {
+			if (taskmap[j].isused && taskmap[j].tid == stats[i].tid) {
+				stats[i].task = j;
+				break;
+			}
+		}
+	}
+
+	pthread_mutex_unlock(&task_mutex);
+
+	return count;
+}
+
+#else
+
+int px4_task_get_stats(px4_task_stats_t *stats, int max_count)
+{
+	return -ENOSYS;
+}
+
+#endif
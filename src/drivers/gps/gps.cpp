@@ -187,6 +187,18 @@ private:
 
 	const Instance 			_instance;
 
+	static constexpr size_t		RX_BUFFER_SIZE = 256;
+	uint8_t				_rx_buffer[RX_BUFFER_SIZE] {};			///< bytes of the last read() not yet handed to the parser
+	size_t				_rx_buffer_read{0};				///< next byte handed to the parser
+	size_t				_rx_buffer_end{0};				///< end of valid data in _rx_buffer
+	hrt_abstime			_rx_buffer_timestamp{0};			///< arrival time of the bytes in _rx_buffer
+	hrt_abstime			_rx_timestamp{0};				///< arrival time of the bytes last handed to the parser
+
+	static constexpr unsigned	LATENCY_BUCKETS = 8;
+	static constexpr unsigned	LATENCY_BUCKET_US = 250;			///< bucket i counts latencies below (LATENCY_BUCKET_US << i)
+	uint32_t			_latency_histogram[LATENCY_BUCKETS] {};		///< arrival to publication latency of position messages
+	hrt_abstime			_latency_max{0};
+
 	int				_orb_inject_data_fd{-1};
 	orb_advert_t			_dump_communication_pub{nullptr};		///< if non-null, dump communication
 	gps_dump_s			*_dump_to_device{nullptr};
@@ -219,6 +231,21 @@ private:
 	 */
 	int pollOrRead(uint8_t *buf, size_t buf_length, int timeout);
 
+	/**
+	 * Wait for serial data and read all of it into the receive buffer in one call.
+	 *
+	 * @param timeout: timeout in ms
+	 * @return: 0 for nothing read, or poll timed out
+	 *	    < 0 for error
+	 *	    > 0 number of bytes read
+	 */
+	int readSerial(int timeout);
+
+	/**
+	 * Add the latency from the arrival of the last message bytes to now to the histogram.
+	 */
+	void recordLatency();
+
 	/**
 	 * check for new messages on the inject data topic & handle them
 	 */
@@ -362,6 +389,27 @@ int GPS::pollOrRead(uint8_t *buf, size_t buf_length, int timeout)
 {
 	handleInjectDataTopic();
 
+	if (_rx_buffer_read == _rx_buffer_end) {
+		int ret = readSerial(timeout);
+
+		if (ret <= 0) {
+			return ret;
+		}
+	}
+
+	/* hand out what is left of the last read(), so all bytes of one call share one arrival time */
+	const size_t len = math::min(buf_length, _rx_buffer_end - _rx_buffer_read);
+	memcpy(buf, &_rx_buffer[_rx_buffer_read], len);
+	_rx_buffer_read += len;
+	_rx_timestamp = _rx_buffer_timestamp;
+
+	return len;
+}
+
+int GPS::readSerial(int timeout)
+{
+	int ret;
+
 #if !defined(__PX4_QURT)
 
 	/* For non QURT, use the usual polling. */
@@ -378,50 +426,83 @@ int GPS::pollOrRead(uint8_t *buf, size_t buf_length, int timeout)
 	fds[0].fd = _serial_fd;
 	fds[0].events = POLLIN;
 
-	int ret = poll(fds, sizeof(fds) / sizeof(fds[0]), math::min(max_timeout, timeout));
+	ret = poll(fds, sizeof(fds) / sizeof(fds[0]), math::min(max_timeout, timeout));
 
 	if (ret > 0) {
 		/* if we have new data from GPS, go handle it */
 		if (fds[0].revents & POLLIN) {
+			/* the bytes arrived when poll() returned, not after the wait for more below */
+			const hrt_abstime arrival = hrt_absolute_time();
+
 			/*
 			 * We are here because poll says there is some data, so this
 			 * won't block even on a blocking device. But don't read immediately
 			 * by 1-2 bytes, wait for some more data to save expensive read() calls.
 			 * If we have all requested data available, read it without waiting.
-			 * If more bytes are available, we'll go back to poll() again.
+			 * The parser is fed from the buffer until it is empty before the next read().
 			 */
 			const unsigned character_count = 32; // minimum bytes that we want to read
 			unsigned baudrate = _baudrate == 0 ? 115200 : _baudrate;
-			const unsigned sleeptime = character_count * 1000000 / (baudrate / 10);
+			int bytes_available = 0;
 
 #ifdef __PX4_NUTTX
-			int err = 0;
-			int bytes_available = 0;
-			err = ioctl(_serial_fd, FIONREAD, (unsigned long)&bytes_available);
+			int err = ioctl(_serial_fd, FIONREAD, (unsigned long)&bytes_available);
 
-			if (err != 0 || bytes_available < (int)character_count) {
-				px4_usleep(sleeptime);
+			if (err != 0) {
+				bytes_available = 0;
 			}
 
-#else
-			px4_usleep(sleeptime);
 #endif
 
-			ret = ::read(_serial_fd, buf, buf_length);
+			if (bytes_available < (int)character_count) {
+				/* only wait for the bytes that are still missing */
+				px4_usleep((character_count - bytes_available) * 1000000 / (baudrate / 10));
+			}
+
+			ret = ::read(_serial_fd, _rx_buffer, sizeof(_rx_buffer));
+
+			if (ret > 0) {
+				_rx_buffer_timestamp = arrival;
+			}
 
 		} else {
 			ret = -1;
 		}
 	}
 
-	return ret;
-
 #else
 	/* For QURT, just use read for now, since this doesn't block, we need to slow it down
 	 * just a bit. */
 	px4_usleep(10000);
-	return ::read(_serial_fd, buf, buf_length);
+	ret = ::read(_serial_fd, _rx_buffer, sizeof(_rx_buffer));
+
+	if (ret > 0) {
+		_rx_buffer_timestamp = hrt_absolute_time();
+	}
+
 #endif
+
+	_rx_buffer_read = 0;
+	_rx_buffer_end = (ret > 0) ? ret : 0;
+
+	return ret;
+}
+
+void GPS::recordLatency()
+{
+	const hrt_abstime latency = hrt_elapsed_time(&_rx_timestamp);
+
+	unsigned bucket = 0;
+
+	while (bucket < LATENCY_BUCKETS - 1 && latency >= (LATENCY_BUCKET_US << bucket)) {
+		bucket++;
+	}
+
+	_latency_histogram[bucket]++;
+
+	if (latency > _latency_max) {
+		_latency_max = latency;
+	}
 }
 
 void GPS::handleInjectDataTopic()
@@ -540,6 +621,10 @@ int GPS::setBaudrate(unsigned baud)
 		return -1;
 	}
 
+	/* anything still buffered was received at the old baudrate */
+	_rx_buffer_read = 0;
+	_rx_buffer_end = 0;
+
 	return 0;
 }
 
@@ -744,7 +829,13 @@ GPS::run()
 				while ((helper_ret = _helper->receive(TIMEOUT_5HZ)) > 0 && !should_exit()) {
 
 					if (helper_ret & 1) {
+						/* stamp the solution with the arrival of its last bytes rather than the parse time */
+						if (_rx_timestamp != 0 && _rx_timestamp < _report_gps_pos.timestamp) {
+							_report_gps_pos.timestamp = _rx_timestamp;
+						}
+
 						publish();
+						recordLatency();
 
 						last_rate_count++;
 					}
@@ -894,6 +985,15 @@ GPS::print_status()
 		if (!_fake_gps) {
 			PX4_INFO("rate publication:\t\t%6.2f Hz", (double)_rate);
 			PX4_INFO("rate RTCM injection:\t%6.2f Hz", (double)_rate_rtcm_injection);
+
+			PX4_INFO("message latency (max %llu us):", (unsigned long long)_latency_max);
+
+			for (unsigned i = 0; i < LATENCY_BUCKETS - 1; i++) {
+				PX4_INFO("  < %5u us:\t%u", LATENCY_BUCKET_US << i, (unsigned)_latency_histogram[i]);
+			}
+
+			PX4_INFO(" >= %5u us:\t%u", LATENCY_BUCKET_US << (LATENCY_BUCKETS - 2),
+				 (unsigned)_latency_histogram[LATENCY_BUCKETS - 1]);
 		}
 
 		print_message(_report_gps_pos);
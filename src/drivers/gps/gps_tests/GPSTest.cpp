@@ -0,0 +1,235 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2018 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+/**
+ * @file GPSTest.cpp
+ *
+ * Offline throughput benchmark of the GPS protocol parser: a synthesized UBX
+ * NAV-PVT stream (test_data/ubx_nav_pvt_10hz.txt, not a receiver recording) is
+ * fed through GPSDriverUBX by a simulated receiver that acknowledges all
+ * configuration messages.
+ */
+
+#include <unit_test.h>
+
+#include <stdio.h>
+#include <string.h>
+
+#include <drivers/drv_hrt.h>
+#include <uORB/topics/vehicle_gps_position.h>
+#include <uORB/topics/satellite_info.h>
+
+#include "../devices/src/ubx.h"
+
+#if defined(CONFIG_ARCH_BOARD_PX4_SITL)
+#define TEST_DATA_PATH "./test_data/"
+#else
+#define TEST_DATA_PATH "/fs/microsd"
+#endif
+
+extern "C" __EXPORT int gps_tests_main(int argc, char *argv[]);
+
+class GPSTest : public UnitTest
+{
+public:
+	virtual bool run_tests();
+
+private:
+	bool ubxThroughputTest();
+
+	bool loadStream(const char *filepath);
+
+	static int callback(GPSCallbackType type, void *data1, int data2, void *user);
+
+	int readDeviceData(uint8_t *buf, size_t buf_length);
+	void writeDeviceData(const uint8_t *buf, size_t len);
+
+	static constexpr size_t STREAM_SIZE_MAX = 16384;
+	static constexpr size_t READ_SIZE = 64;			///< bytes handed out per read, like a serial read
+	static constexpr unsigned REPETITIONS = 50;
+
+	uint8_t _stream[STREAM_SIZE_MAX];
+	size_t _stream_size{0};
+	unsigned _stream_messages{0};
+
+	const uint8_t *_rx{nullptr};				///< bytes the simulated receiver sends next
+	size_t _rx_remaining{0};
+
+	uint8_t _ack[10];					///< pending UBX-ACK-ACK of the last configuration message
+	size_t _ack_size{0};
+};
+
+bool GPSTest::run_tests()
+{
+	ut_run_test(ubxThroughputTest);
+
+	return (_tests_failed == 0);
+}
+
+bool GPSTest::loadStream(const char *filepath)
+{
+	FILE *fp = fopen(filepath, "rt");
+
+	if (fp == nullptr) {
+		return false;
+	}
+
+	char line[1024];
+
+	while (fgets(line, sizeof(line), fp) != nullptr) {
+		if (line[0] == '#') {
+			continue;
+		}
+
+		const char *file_buffer = line;
+		int offset;
+		unsigned number;
+
+		while (_stream_size < STREAM_SIZE_MAX && sscanf(file_buffer, "%x, %n", &number, &offset) > 0) {
+			_stream[_stream_size++] = number;
+			file_buffer += offset;
+		}
+
+		_stream_messages++;
+	}
+
+	fclose(fp);
+	return _stream_size > 0;
+}
+
+int GPSTest::callback(GPSCallbackType type, void *data1, int data2, void *user)
+{
+	GPSTest *test = (GPSTest *)user;
+
+	switch (type) {
+	case GPSCallbackType::readDeviceData:
+		return test->readDeviceData((uint8_t *)data1, data2);
+
+	case GPSCallbackType::writeDeviceData:
+		test->writeDeviceData((const uint8_t *)data1, data2);
+		return data2;
+
+	default:
+		break;
+	}
+
+	return 0;
+}
+
+int GPSTest::readDeviceData(uint8_t *buf, size_t buf_length)
+{
+	if (_ack_size > 0) {
+		const size_t len = _ack_size < buf_length ? _ack_size : buf_length;
+		memcpy(buf, _ack, len);
+		_ack_size = 0;
+		return len;
+	}
+
+	size_t len = _rx_remaining < buf_length ? _rx_remaining : buf_length;
+
+	if (len > READ_SIZE) {
+		len = READ_SIZE;
+	}
+
+	memcpy(buf, _rx, len);
+	_rx += len;
+	_rx_remaining -= len;
+
+	return len;
+}
+
+void GPSTest::writeDeviceData(const uint8_t *buf, size_t len)
+{
+	/* acknowledge every UBX-CFG message, so that configure() succeeds without a receiver */
+	if (len < 4 || buf[0] != 0xB5 || buf[1] != 0x62 || buf[2] != 0x06) {
+		return;
+	}
+
+	const uint8_t ack[] = {0xB5, 0x62, 0x05, 0x01, 0x02, 0x00, buf[2], buf[3]};
+	uint8_t ck_a = 0;
+	uint8_t ck_b = 0;
+
+	for (size_t i = 2; i < sizeof(ack); i++) {
+		ck_a += ack[i];
+		ck_b += ck_a;
+	}
+
+	memcpy(_ack, ack, sizeof(ack));
+	_ack[8] = ck_a;
+	_ack[9] = ck_b;
+	_ack_size = sizeof(_ack);
+}
+
+bool GPSTest::ubxThroughputTest()
+{
+	ut_test(loadStream(TEST_DATA_PATH "ubx_nav_pvt_10hz.txt"));
+
+	vehicle_gps_position_s gps_position{};
+	satellite_info_s satellite_info{};
+	GPSDriverUBX parser(GPSHelper::Interface::UART, &GPSTest::callback, this, &gps_position, &satellite_info, 7);
+
+	/* writeDeviceData() acknowledges every configuration message, so this must succeed */
+	ut_assert("configure() succeeds", parser.configure(115200, GPSHelper::OutputMode::GPS) == 0);
+
+	unsigned position_updates = 0;
+
+	const hrt_abstime start = hrt_absolute_time();
+
+	for (unsigned i = 0; i < REPETITIONS; i++) {
+		_rx = _stream;
+		_rx_remaining = _stream_size;
+
+		while (_rx_remaining > 0) {
+			const int ret = parser.receive(1);
+
+			if (ret > 0 && (ret & 1)) {
+				position_updates++;
+			}
+		}
+	}
+
+	const hrt_abstime elapsed = hrt_elapsed_time(&start);
+	const double bytes = (double)_stream_size * REPETITIONS;
+
+	PX4_INFO("%u messages, %.0f bytes in %llu us: %.2f MB/s, %.2f us/message, %u position updates",
+		 _stream_messages * REPETITIONS, bytes, (unsigned long long)elapsed, bytes / (double)elapsed,
+		 (double)elapsed / (_stream_messages * REPETITIONS), position_updates);
+
+	ut_test(_rx_remaining == 0);
+	ut_compare("every message yields a position update", position_updates, _stream_messages * REPETITIONS);
+
+	return true;
+}
+
+ut_declare_test_c(gps_tests_main, GPSTest)
@@ -133,7 +133,7 @@ class MPU6000 : public device::CDev
 {
 public:
 	MPU6000(device::Device *interface, const char *path_accel, const char *path_gyro, enum Rotation rotation,
-		int device_type);
+		int device_type, bool fifo_mode);
 
 	virtual ~MPU6000();
 
@@ -209,6 +209,16 @@ private:
 	perf_counter_t		_bad_registers;
 	perf_counter_t		_reset_retries;
 	perf_counter_t		_duplicates;
+	perf_counter_t		_fifo_empty;
+	perf_counter_t		_fifo_overflows;
+
+	// drain the sensor FIFO in bursts instead of reading the data registers
+	bool			_fifo_mode;
+	MPUFIFOReport		_fifo_report;
+
+	// CPU time spent in measure() and samples processed, for print_info()
+	uint64_t		_measure_time;
+	uint64_t		_measure_samples;
 
 	uint8_t			_register_wait;
 	uint64_t		_reset_wait;
@@ -229,7 +239,7 @@ private:
 	// configuration registers to detect SPI bus errors and sensor
 	// reset
 #define MPU6000_CHECKED_PRODUCT_ID_INDEX 0
-#define MPU6000_NUM_CHECKED_REGISTERS 10
+#define MPU6000_NUM_CHECKED_REGISTERS 11
 	static const uint8_t	_checked_registers[MPU6000_NUM_CHECKED_REGISTERS];
 	uint8_t			_checked_values[MPU6000_NUM_CHECKED_REGISTERS];
 	uint8_t			_checked_next;
@@ -245,6 +255,20 @@ private:
 	uint16_t		_last_accel[3];
 	bool			_got_duplicate;
 
+	/**
+	 * Raw sample in native byte order, as read from the data registers
+	 * or the FIFO.
+	 */
+	struct Report {
+		int16_t		accel_x;
+		int16_t		accel_y;
+		int16_t		accel_z;
+		int16_t		temp;
+		int16_t		gyro_x;
+		int16_t		gyro_y;
+		int16_t		gyro_z;
+	};
+
 	/**
 	 * Start automatic measurement.
 	 */
@@ -320,6 +344,47 @@ private:
 	 */
 	int			measure();
 
+	/**
+	 * Read a single sample from the data registers.
+	 */
+	int			measure_registers();
+
+	/**
+	 * Drain the sensor FIFO and process all samples in one pass.
+	 */
+	int			measure_fifo();
+
+	/**
+	 * Scale, filter and integrate one raw sample into the reports.
+	 *
+	 * The integrals in the reports are only updated when the integrator
+	 * resets, which is signalled through accel_notify / gyro_notify.
+	 */
+	void			process_sample(Report &report, hrt_abstime timestamp, sensor_accel_s &arb, sensor_gyro_s &grb,
+					       bool &accel_notify, bool &gyro_notify);
+
+	/**
+	 * Queue the reports and publish them if the integrators reset.
+	 */
+	void			publish_reports(sensor_accel_s &arb, sensor_gyro_s &grb, bool accel_notify, bool gyro_notify);
+
+	/**
+	 * Discard the FIFO contents and restart sampling into it.
+	 */
+	void			fifo_reset();
+
+	/**
+	 * FIFO size in bytes of the detected device.
+	 */
+	unsigned		fifo_size();
+
+	/**
+	 * Period of the measurement callback. Register reads poll a bit
+	 * faster than the sample rate and drop duplicates, the FIFO absorbs
+	 * any jitter so bursts run at the nominal interval.
+	 */
+	unsigned		call_period() { return _fifo_mode ? _call_interval : _call_interval - MPU6000_TIMER_REDUCTION; }
+
 	/**
 	 * Read a register from the MPU6000
 	 *
@@ -419,7 +484,8 @@ const uint8_t MPU6000::_checked_registers[MPU6000_NUM_CHECKED_REGISTERS] = { MPU
 									     MPUREG_ACCEL_CONFIG,
 									     MPUREG_INT_ENABLE,
 									     MPUREG_INT_PIN_CFG,
-									     MPUREG_ICM_UNDOC1
+									     MPUREG_ICM_UNDOC1,
+									     MPUREG_FIFO_EN
 									   };
 
 
@@ -458,7 +524,7 @@ private:
 extern "C" { __EXPORT int mpu6000_main(int argc, char *argv[]); }
 
 MPU6000::MPU6000(device::Device *interface, const char *path_accel, const char *path_gyro, enum Rotation rotation,
-		 int device_type) :
+		 int device_type, bool fifo_mode) :
 	CDev("MPU6000", path_accel),
 	_interface(interface),
 	_device_type(device_type),
@@ -490,6 +556,12 @@ MPU6000::MPU6000(device::Device *interface, const char *path_accel, const char *
 	_bad_registers(perf_alloc(PC_COUNT, "mpu6k_bad_reg")),
 	_reset_retries(perf_alloc(PC_COUNT, "mpu6k_reset")),
 	_duplicates(perf_alloc(PC_COUNT, "mpu6k_duplicates")),
+	_fifo_empty(perf_alloc(PC_COUNT, "mpu6k_fifo_empty")),
+	_fifo_overflows(perf_alloc(PC_COUNT, "mpu6k_fifo_overflow")),
+	_fifo_mode(fifo_mode),
+	_fifo_report{},
+	_measure_time(0),
+	_measure_samples(0),
 	_register_wait(0),
 	_reset_wait(0),
 	_accel_filter_x(MPU6000_ACCEL_DEFAULT_RATE, MPU6000_ACCEL_DEFAULT_DRIVER_FILTER_FREQ),
@@ -600,6 +672,8 @@ MPU6000::~MPU6000()
 	perf_free(_bad_registers);
 	perf_free(_reset_retries);
 	perf_free(_duplicates);
+	perf_free(_fifo_empty);
+	perf_free(_fifo_overflows);
 }
 
 int
@@ -610,6 +684,13 @@ MPU6000::init()
 	use_i2c(_interface->get_device_bus_type() == Device::DeviceBusType_I2C);
 #endif
 
+	// the ICM20602 FIFO_EN register has a different layout, and bursts
+	// are only worth it on SPI
+	if (_fifo_mode && (is_i2c() || _device_type == MPU_DEVICE_TYPE_ICM20602)) {
+		PX4_WARN("FIFO mode not supported, using register reads");
+		_fifo_mode = false;
+	}
+
 	/* probe again to get our settings that are based on the device type */
 	int ret = probe();
 
@@ -779,10 +860,17 @@ int MPU6000::reset()
 	px4_usleep(1000);
 
 	// SAMPLE RATE
-	_set_sample_rate(_sample_rate);
+	if (_fifo_mode) {
+		// no divider, the gyro runs at its full output rate with the DLPF bypassed
+		write_checked_reg(MPUREG_SMPLRT_DIV, 0);
+
+	} else {
+		_set_sample_rate(_sample_rate);
+	}
+
 	px4_usleep(1000);
 
-	_set_dlpf_filter(MPU6000_DEFAULT_ONCHIP_FILTER_FREQ);
+	_set_dlpf_filter(_fifo_mode ? MPU6000_FIFO_ONCHIP_FILTER_FREQ : MPU6000_DEFAULT_ONCHIP_FILTER_FREQ);
 
 	if (is_icm_device()) {
 		_set_icm_acc_dlpf_filter(MPU6000_DEFAULT_ONCHIP_FILTER_FREQ);
@@ -815,6 +903,16 @@ int MPU6000::reset()
 		write_checked_reg(MPUREG_ICM_UNDOC1, MPUREG_ICM_UNDOC1_VALUE);
 	}
 
+	if (_fifo_mode) {
+		// accel, temperature and gyro are written to the FIFO on every sample
+		write_checked_reg(MPUREG_FIFO_EN, BITS_FIFO_ENABLE_ALL);
+		write_checked_reg(MPUREG_USER_CTRL, BIT_I2C_IF_DIS | BIT_FIFO_EN);
+		fifo_reset();
+
+	} else {
+		write_checked_reg(MPUREG_FIFO_EN, 0);
+	}
+
 	// Oscillator set
 	// write_reg(MPUREG_PWR_MGMT_1,MPU_CLK_SEL_PLLGYROZ);
 	px4_usleep(1000);
@@ -1285,9 +1383,9 @@ MPU6000::ioctl(struct file *filp, int cmd, unsigned long arg)
 						return -EINVAL;
 					}
 
-					// adjust filters
+					// adjust filters, in FIFO mode they run at the sensor sample rate
 					float cutoff_freq_hz = _accel_filter_x.get_cutoff_freq();
-					float sample_rate = 1.0e6f / ticks;
+					float sample_rate = _fifo_mode ? MPU6000_FIFO_SAMPLE_RATE : 1.0e6f / ticks;
 
 					_accel_filter_x.set_cutoff_frequency(sample_rate, cutoff_freq_hz);
 					_accel_filter_y.set_cutoff_frequency(sample_rate, cutoff_freq_hz);
@@ -1300,7 +1398,7 @@ MPU6000::ioctl(struct file *filp, int cmd, unsigned long arg)
 
 					/* update interval for next measurement */
 					/* XXX this is a bit shady, but no other way to adjust... */
-					_call_interval = ticks;
+					_call_interval = _fifo_mode ? MPU6000_FIFO_INTERVAL_US : ticks;
 
 					/*
 					  set call interval faster then the sample time. We
@@ -1310,7 +1408,7 @@ MPU6000::ioctl(struct file *filp, int cmd, unsigned long arg)
 					 */
 
 					if (!is_i2c()) {
-						_call.period = _call_interval - MPU6000_TIMER_REDUCTION;
+						_call.period = call_period();
 					}
 
 					/* if we need to start the poll state machine, do it */
@@ -1477,7 +1575,7 @@ MPU6000::start()
 		/* start polling at the specified rate */
 		hrt_call_every(&_call,
 			       1000,
-			       _call_interval - MPU6000_TIMER_REDUCTION,
+			       call_period(),
 			       (hrt_callout)&MPU6000::measure_trampoline, this);
 
 	} else {
@@ -1630,21 +1728,27 @@ MPU6000::measure()
 		return OK;
 	}
 
-	struct MPUReport mpu_report;
-
-	struct Report {
-		int16_t		accel_x;
-		int16_t		accel_y;
-		int16_t		accel_z;
-		int16_t		temp;
-		int16_t		gyro_x;
-		int16_t		gyro_y;
-		int16_t		gyro_z;
-	} report;
+	const hrt_abstime measure_start = hrt_absolute_time();
 
 	/* start measuring */
 	perf_begin(_sample_perf);
 
+	int ret = _fifo_mode ? measure_fifo() : measure_registers();
+
+	/* stop measuring */
+	perf_end(_sample_perf);
+
+	_measure_time += hrt_elapsed_time(&measure_start);
+
+	return ret;
+}
+
+int
+MPU6000::measure_registers()
+{
+	struct MPUReport mpu_report;
+	Report report;
+
 	/*
 	 * Fetch the full set of measurements from the MPU6000 in one pass.
 	 */
@@ -1669,7 +1773,6 @@ MPU6000::measure()
 	*/
 	if (!_got_duplicate && memcmp(&mpu_report.accel_x[0], &_last_accel[0], 6) == 0) {
 		// it isn't new data - wait for next timer
-		perf_end(_sample_perf);
 		perf_count(_duplicates);
 		_got_duplicate = true;
 		return OK;
@@ -1701,7 +1804,6 @@ MPU6000::measure()
 	    report.gyro_z == 0) {
 		// all zero data - probably a SPI bus error
 		perf_count(_bad_transfers);
-		perf_end(_sample_perf);
 		// note that we don't call reset() here as a reset()
 		// costs 20ms with interrupts disabled. That means if
 		// the mpu6k does go bad it would cause a FMU failure,
@@ -1716,7 +1818,129 @@ MPU6000::measure()
 		return OK;
 	}
 
+	/*
+	 * Report buffers.
+	 */
+	sensor_accel_s arb{};
+	sensor_gyro_s grb{};
+	bool accel_notify = false;
+	bool gyro_notify = false;
+
+	process_sample(report, hrt_absolute_time(), arb, grb, accel_notify, gyro_notify);
+	publish_reports(arb, grb, accel_notify, gyro_notify);
+
+	_measure_samples++;
+
+	return OK;
+}
+
+int
+MPU6000::measure_fifo()
+{
+	uint8_t fifo_count[2];
+
+	// the FIFO is read at high clock speed like the sensor registers
+	if (sizeof(fifo_count) != _interface->read(MPU6000_HIGH_SPEED_OP(MPUREG_FIFO_COUNTH), fifo_count,
+			sizeof(fifo_count))) {
+		return -EIO;
+	}
+
+	check_registers();
+
+	const unsigned fifo_bytes = (fifo_count[0] << 8) | fifo_count[1];
+
+	if (fifo_bytes >= fifo_size() || (fifo_bytes % sizeof(MPUFIFOSample)) != 0) {
+		// the FIFO overflowed and lost samples or is no longer
+		// aligned to a sample boundary, start over
+		perf_count(_fifo_overflows);
+		fifo_reset();
+		return OK;
+	}
+
+	const unsigned fifo_samples = fifo_bytes / sizeof(MPUFIFOSample);
+	unsigned samples = fifo_samples;
+
+	if (samples < MPU6000_FIFO_MIN_SAMPLES) {
+		// leave it for the next burst
+		perf_count(_fifo_empty);
+		return OK;
+	}
+
+	if (samples > MPU6000_FIFO_MAX_SAMPLES) {
+		// the rest is read on the next callback
+		samples = MPU6000_FIFO_MAX_SAMPLES;
+	}
+
+	const unsigned transfer_size = sizeof(_fifo_report.cmd) + samples * sizeof(MPUFIFOSample);
+
+	if ((int)transfer_size != _interface->read(MPU6000_HIGH_SPEED_OP(MPUREG_FIFO_R_W), (uint8_t *)&_fifo_report,
+			transfer_size)) {
+		return -EIO;
+	}
+
+	if (_register_wait != 0) {
+		// we are waiting for some good transfers before using
+		// the sensor again, don't return any data yet
+		_register_wait--;
+		return OK;
+	}
+
+	// check the whole burst before any sample reaches the filters and integrators
+	for (unsigned i = 0; i < samples; i++) {
+		MPUFIFOSample &sample = _fifo_report.samples[i];
 
+		if (int16_t_from_bytes(sample.accel_x) == 0 &&
+		    int16_t_from_bytes(sample.accel_y) == 0 &&
+		    int16_t_from_bytes(sample.accel_z) == 0 &&
+		    int16_t_from_bytes(sample.temp) == 0 &&
+		    int16_t_from_bytes(sample.gyro_x) == 0 &&
+		    int16_t_from_bytes(sample.gyro_y) == 0 &&
+		    int16_t_from_bytes(sample.gyro_z) == 0) {
+			// all zero data - probably a SPI bus error
+			perf_count(_bad_transfers);
+			return -EIO;
+		}
+	}
+
+	sensor_accel_s arb{};
+	sensor_gyro_s grb{};
+	bool accel_notify = false;
+	bool gyro_notify = false;
+
+	// the last sample in the FIFO is the newest, the others are spaced
+	// by the sensor sample interval before it. Only the oldest samples
+	// are read if the FIFO holds more than a burst.
+	const hrt_abstime now = hrt_absolute_time();
+	const unsigned sample_interval_us = 1000000 / MPU6000_FIFO_SAMPLE_RATE;
+
+	for (unsigned i = 0; i < samples; i++) {
+		MPUFIFOSample &sample = _fifo_report.samples[i];
+		Report report;
+
+		report.accel_x = int16_t_from_bytes(sample.accel_x);
+		report.accel_y = int16_t_from_bytes(sample.accel_y);
+		report.accel_z = int16_t_from_bytes(sample.accel_z);
+
+		report.temp = int16_t_from_bytes(sample.temp);
+
+		report.gyro_x = int16_t_from_bytes(sample.gyro_x);
+		report.gyro_y = int16_t_from_bytes(sample.gyro_y);
+		report.gyro_z = int16_t_from_bytes(sample.gyro_z);
+
+		process_sample(report, now - (fifo_samples - 1 - i) * sample_interval_us, arb, grb, accel_notify, gyro_notify);
+	}
+
+	publish_reports(arb, grb, accel_notify, gyro_notify);
+
+	_measure_samples += samples;
+
+	return OK;
+}
+
+void
+MPU6000::process_sample(Report &report, hrt_abstime timestamp, sensor_accel_s &arb, sensor_gyro_s &grb,
+			bool &accel_notify, bool &gyro_notify)
+{
 	/*
 	 * Swap axes and negate y
 	 */
@@ -1734,22 +1958,10 @@ MPU6000::measure()
 	report.gyro_x = gyro_xt;
 	report.gyro_y = gyro_yt;
 
-	/*
-	 * Report buffers.
-	 */
-	sensor_accel_s arb;
-	sensor_gyro_s grb;
-
 	/*
 	 * Adjust and scale results to m/s^2.
 	 */
-	grb.timestamp = arb.timestamp = hrt_absolute_time();
-
-	// report the error count as the sum of the number of bad
-	// transfers and bad register reads. This allows the higher
-	// level code to decide if it should use this sensor based on
-	// whether it has had failures
-	grb.error_count = arb.error_count = perf_event_count(_bad_transfers) + perf_event_count(_bad_registers);
+	grb.timestamp = arb.timestamp = timestamp;
 
 	/*
 	 * 1) Scale raw value to SI units using scaling from datasheet.
@@ -1792,10 +2004,12 @@ MPU6000::measure()
 	matrix::Vector3f aval(x_in_new, y_in_new, z_in_new);
 	matrix::Vector3f aval_integrated;
 
-	bool accel_notify = _accel_int.put(arb.timestamp, aval, aval_integrated, arb.integral_dt);
-	arb.x_integral = aval_integrated(0);
-	arb.y_integral = aval_integrated(1);
-	arb.z_integral = aval_integrated(2);
+	if (_accel_int.put(arb.timestamp, aval, aval_integrated, arb.integral_dt)) {
+		arb.x_integral = aval_integrated(0);
+		arb.y_integral = aval_integrated(1);
+		arb.z_integral = aval_integrated(2);
+		accel_notify = true;
+	}
 
 	if (is_icm_device()) { // if it is an ICM20608
 		_last_temperature = (report.temp) / 326.8f + 25.0f;
@@ -1804,11 +2018,6 @@ MPU6000::measure()
 		_last_temperature = (report.temp) / 361.0f + 35.0f;
 	}
 
-	arb.temperature = _last_temperature;
-
-	/* return device ID */
-	arb.device_id = _device_id.devid;
-
 	grb.x_raw = report.gyro_x;
 	grb.y_raw = report.gyro_y;
 	grb.z_raw = report.gyro_z;
@@ -1831,16 +2040,30 @@ MPU6000::measure()
 	matrix::Vector3f gval(x_gyro_in_new, y_gyro_in_new, z_gyro_in_new);
 	matrix::Vector3f gval_integrated;
 
-	bool gyro_notify = _gyro_int.put(arb.timestamp, gval, gval_integrated, grb.integral_dt);
-	grb.x_integral = gval_integrated(0);
-	grb.y_integral = gval_integrated(1);
-	grb.z_integral = gval_integrated(2);
+	if (_gyro_int.put(arb.timestamp, gval, gval_integrated, grb.integral_dt)) {
+		grb.x_integral = gval_integrated(0);
+		grb.y_integral = gval_integrated(1);
+		grb.z_integral = gval_integrated(2);
+		gyro_notify = true;
+	}
 
 	grb.scaling = _gyro_range_scale;
+}
 
+void
+MPU6000::publish_reports(sensor_accel_s &arb, sensor_gyro_s &grb, bool accel_notify, bool gyro_notify)
+{
+	// report the error count as the sum of the number of bad
+	// transfers and bad register reads. This allows the higher
+	// level code to decide if it should use this sensor based on
+	// whether it has had failures
+	grb.error_count = arb.error_count = perf_event_count(_bad_transfers) + perf_event_count(_bad_registers);
+
+	arb.temperature = _last_temperature;
 	grb.temperature = _last_temperature;
 
 	/* return device ID */
+	arb.device_id = _device_id.devid;
 	grb.device_id = _gyro->_device_id.devid;
 
 	_accel_reports->force(&arb);
@@ -1864,10 +2087,29 @@ MPU6000::measure()
 		/* publish it */
 		orb_publish(ORB_ID(sensor_gyro), _gyro->_gyro_topic, &grb);
 	}
+}
 
-	/* stop measuring */
-	perf_end(_sample_perf);
-	return OK;
+void
+MPU6000::fifo_reset()
+{
+	// FIFO_RST only takes effect while the FIFO is disabled, it clears itself
+	write_reg(MPUREG_USER_CTRL, BIT_I2C_IF_DIS | BIT_FIFO_RST);
+	write_reg(MPUREG_USER_CTRL, BIT_I2C_IF_DIS | BIT_FIFO_EN);
+}
+
+unsigned
+MPU6000::fifo_size()
+{
+	switch (_device_type) {
+	case MPU_DEVICE_TYPE_ICM20608:
+		return 512;
+
+	case MPU_DEVICE_TYPE_ICM20689:
+		return 4096;
+
+	default:
+		return 1024;
+	}
 }
 
 void
@@ -1878,6 +2120,8 @@ MPU6000::print_info()
 	perf_print_counter(_bad_registers);
 	perf_print_counter(_reset_retries);
 	perf_print_counter(_duplicates);
+	perf_print_counter(_fifo_empty);
+	perf_print_counter(_fifo_overflows);
 	_accel_reports->print_info("accel queue");
 	_gyro_reports->print_info("gyro queue");
 	::printf("checked_next: %u\n", _checked_next);
@@ -1894,6 +2138,11 @@ MPU6000::print_info()
 	}
 
 	::printf("temperature: %.1f\n", (double)_last_temperature);
+
+	if (_measure_samples > 0) {
+		::printf("%s reads: %.2f us per sample\n", _fifo_mode ? "FIFO" : "register",
+			 (double)_measure_time / (double)_measure_samples);
+	}
 }
 
 void
@@ -2033,8 +2282,8 @@ struct mpu6000_bus_option {
 #define NUM_BUS_OPTIONS (sizeof(bus_options)/sizeof(bus_options[0]))
 
 
-void	start(enum MPU6000_BUS busid, enum Rotation rotation, int device_type);
-bool 	start_bus(struct mpu6000_bus_option &bus, enum Rotation rotation, int device_type);
+void	start(enum MPU6000_BUS busid, enum Rotation rotation, int device_type, bool fifo_mode);
+bool 	start_bus(struct mpu6000_bus_option &bus, enum Rotation rotation, int device_type, bool fifo_mode);
 void	stop(enum MPU6000_BUS busid);
 void	test(enum MPU6000_BUS busid);
 static struct mpu6000_bus_option &find_bus(enum MPU6000_BUS busid);
@@ -2064,7 +2313,7 @@ struct mpu6000_bus_option &find_bus(enum MPU6000_BUS busid)
  * start driver for a specific bus option
  */
 bool
-start_bus(struct mpu6000_bus_option &bus, enum Rotation rotation, int device_type)
+start_bus(struct mpu6000_bus_option &bus, enum Rotation rotation, int device_type, bool fifo_mode)
 {
 	int fd = -1;
 
@@ -2086,7 +2335,7 @@ start_bus(struct mpu6000_bus_option &bus, enum Rotation rotation, int device_typ
 		return false;
 	}
 
-	bus.dev = new MPU6000(interface, bus.accelpath, bus.gyropath, rotation, device_type);
+	bus.dev = new MPU6000(interface, bus.accelpath, bus.gyropath, rotation, device_type, fifo_mode);
 
 	if (bus.dev == nullptr) {
 		delete interface;
@@ -2134,7 +2383,7 @@ fail:
  * or failed to detect the sensor.
  */
 void
-start(enum MPU6000_BUS busid, enum Rotation rotation, int device_type)
+start(enum MPU6000_BUS busid, enum Rotation rotation, int device_type, bool fifo_mode)
 {
 
 	bool started = false;
@@ -2155,7 +2404,7 @@ start(enum MPU6000_BUS busid, enum Rotation rotation, int device_type)
 			continue;
 		}
 
-		started |= start_bus(bus_options[i], rotation, device_type);
+		started |= start_bus(bus_options[i], rotation, device_type, fifo_mode);
 	}
 
 	exit(started ? 0 : 1);
@@ -2354,6 +2603,7 @@ usage()
 	warnx("    -z internal2 SPI bus");
 	warnx("    -T 6000|20608|20602 (default 6000)");
 	warnx("    -R rotation");
+	warnx("    -F read the sensor FIFO in bursts (SPI only)");
 }
 
 } // namespace
@@ -2368,8 +2618,9 @@ mpu6000_main(int argc, char *argv[])
 	enum MPU6000_BUS busid = MPU6000_BUS_ALL;
 	int device_type = MPU_DEVICE_TYPE_MPU6000;
 	enum Rotation rotation = ROTATION_NONE;
+	bool fifo_mode = false;
 
-	while ((ch = px4_getopt(argc, argv, "T:XISsZzR:a:", &myoptind, &myoptarg)) != EOF) {
+	while ((ch = px4_getopt(argc, argv, "T:XISsZzR:a:F", &myoptind, &myoptarg)) != EOF) {
 		switch (ch) {
 		case 'X':
 			busid = MPU6000_BUS_I2C_EXTERNAL;
@@ -2403,6 +2654,10 @@ mpu6000_main(int argc, char *argv[])
 			rotation = (enum Rotation)atoi(myoptarg);
 			break;
 
+		case 'F':
+			fifo_mode = true;
+			break;
+
 		default:
 			mpu6000::usage();
 			return 0;
@@ -2420,7 +2675,7 @@ mpu6000_main(int argc, char *argv[])
 	 * Start/load the driver.
 	 */
 	if (!strcmp(verb, "start")) {
-		mpu6000::start(busid, rotation, device_type);
+		mpu6000::start(busid, rotation, device_type, fifo_mode);
 	}
 
 	if (!strcmp(verb, "stop")) {
@@ -145,6 +145,14 @@
 #define BIT_RAW_RDY_EN			0x01
 #define BIT_I2C_IF_DIS			0x10
 #define BIT_INT_STATUS_DATA		0x01
+#define BIT_FIFO_EN				0x40
+#define BIT_FIFO_RST			0x04
+#define BIT_TEMP_FIFO_EN		0x80
+#define BIT_XG_FIFO_EN			0x40
+#define BIT_YG_FIFO_EN			0x20
+#define BIT_ZG_FIFO_EN			0x10
+#define BIT_ACCEL_FIFO_EN		0x08
+#define BITS_FIFO_ENABLE_ALL	(BIT_TEMP_FIFO_EN | BIT_XG_FIFO_EN | BIT_YG_FIFO_EN | BIT_ZG_FIFO_EN | BIT_ACCEL_FIFO_EN)
 
 #define MPU_WHOAMI_6000			0x68
 #define ICM_WHOAMI_20602		0x12
@@ -214,6 +222,18 @@
 
 #define MPU6000_DEFAULT_ONCHIP_FILTER_FREQ			98
 
+/*
+  FIFO burst mode: the sensor samples at the full gyro output rate into
+  its FIFO and the driver drains it in bursts at a lower callback rate
+ */
+#define MPU6000_FIFO_SAMPLE_RATE					8000
+#define MPU6000_FIFO_ONCHIP_FILTER_FREQ				256
+#define MPU6000_FIFO_INTERVAL_US					1000
+/* twice the nominal burst to absorb callback jitter, the rest is read on the next callback */
+#define MPU6000_FIFO_MAX_SAMPLES					16
+/* the interface treats shorter transfers as plain register reads */
+#define MPU6000_FIFO_MIN_SAMPLES					2
+
 #pragma pack(push, 1)
 /**
  * Report conversation within the MPU6000, including command byte and
@@ -230,6 +250,28 @@ struct MPUReport {
 	uint8_t		gyro_y[2];
 	uint8_t		gyro_z[2];
 };
+
+/**
+ * One FIFO entry with accel, temperature and gyro enabled. The sensor
+ * writes them in register order.
+ */
+struct MPUFIFOSample {
+	uint8_t		accel_x[2];
+	uint8_t		accel_y[2];
+	uint8_t		accel_z[2];
+	uint8_t		temp[2];
+	uint8_t		gyro_x[2];
+	uint8_t		gyro_y[2];
+	uint8_t		gyro_z[2];
+};
+
+/**
+ * FIFO burst read, including the command byte.
+ */
+struct MPUFIFOReport {
+	uint8_t		cmd;
+	MPUFIFOSample	samples[MPU6000_FIFO_MAX_SAMPLES];
+};
 #pragma pack(pop)
 
 #define MPU_MAX_READ_BUFFER_SIZE (sizeof(MPUReport) + 1)
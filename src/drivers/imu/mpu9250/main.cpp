@@ -184,8 +184,9 @@ struct mpu9250_bus_option {
 #define NUM_BUS_OPTIONS (sizeof(bus_options)/sizeof(bus_options[0]))
 
 
-void	start(enum MPU9250_BUS busid, enum Rotation rotation, bool external_bus, bool magnetometer_only);
-bool	start_bus(struct mpu9250_bus_option &bus, enum Rotation rotation, bool external_bus, bool magnetometer_only);
+void	start(enum MPU9250_BUS busid, enum Rotation rotation, bool external_bus, bool magnetometer_only, bool fifo_mode);
+bool	start_bus(struct mpu9250_bus_option &bus, enum Rotation rotation, bool external_bus, bool magnetometer_only,
+		  bool fifo_mode);
 struct mpu9250_bus_option &find_bus(enum MPU9250_BUS busid);
 void	stop(enum MPU9250_BUS busid);
 void	reset(enum MPU9250_BUS busid);
@@ -211,7 +212,8 @@ struct mpu9250_bus_option &find_bus(enum MPU9250_BUS busid)
  * start driver for a specific bus option
  */
 bool
-start_bus(struct mpu9250_bus_option &bus, enum Rotation rotation, bool external, bool magnetometer_only)
+start_bus(struct mpu9250_bus_option &bus, enum Rotation rotation, bool external, bool magnetometer_only,
+	  bool fifo_mode)
 {
 	int fd = -1;
 
@@ -248,7 +250,7 @@ start_bus(struct mpu9250_bus_option &bus, enum Rotation rotation, bool external,
 #endif
 
 	bus.dev = new MPU9250(interface, mag_interface, bus.accelpath, bus.gyropath, bus.magpath, rotation,
-			      magnetometer_only);
+			      magnetometer_only, fifo_mode);
 
 	if (bus.dev == nullptr) {
 		delete interface;
@@ -301,7 +303,7 @@ fail:
  * or failed to detect the sensor.
  */
 void
-start(enum MPU9250_BUS busid, enum Rotation rotation, bool external, bool magnetometer_only)
+start(enum MPU9250_BUS busid, enum Rotation rotation, bool external, bool magnetometer_only, bool fifo_mode)
 {
 
 	bool started = false;
@@ -317,7 +319,7 @@ start(enum MPU9250_BUS busid, enum Rotation rotation, bool external, bool magnet
 			continue;
 		}
 
-		started |= start_bus(bus_options[i], rotation, external, magnetometer_only);
+		started |= start_bus(bus_options[i], rotation, external, magnetometer_only, fifo_mode);
 
 		if (started) { break; }
 	}
@@ -401,6 +403,7 @@ usage()
 	PX4_INFO("    -t    (spi internal bus, 2nd instance)");
 	PX4_INFO("    -R rotation");
 	PX4_INFO("    -M only enable magnetometer, accel/gyro disabled - not av. on MPU6500");
+	PX4_INFO("    -F    (read the sensor FIFO in bursts, SPI only)");
 }
 
 } // namespace
@@ -415,8 +418,9 @@ mpu9250_main(int argc, char *argv[])
 	enum MPU9250_BUS busid = MPU9250_BUS_ALL;
 	enum Rotation rotation = ROTATION_NONE;
 	bool magnetometer_only = false;
+	bool fifo_mode = false;
 
-	while ((ch = px4_getopt(argc, argv, "XISstMR:", &myoptind, &myoptarg)) != EOF) {
+	while ((ch = px4_getopt(argc, argv, "XISstMR:F", &myoptind, &myoptarg)) != EOF) {
 		switch (ch) {
 		case 'X':
 			busid = MPU9250_BUS_I2C_EXTERNAL;
@@ -446,6 +450,10 @@ mpu9250_main(int argc, char *argv[])
 			magnetometer_only = true;
 			break;
 
+		case 'F':
+			fifo_mode = true;
+			break;
+
 		default:
 			mpu9250::usage();
 			return 0;
@@ -464,7 +472,7 @@ mpu9250_main(int argc, char *argv[])
 	 * Start/load the driver.
 	 */
 	if (!strcmp(verb, "start")) {
-		mpu9250::start(busid, rotation, external, magnetometer_only);
+		mpu9250::start(busid, rotation, external, magnetometer_only, fifo_mode);
 	}
 
 	if (!strcmp(verb, "stop")) {
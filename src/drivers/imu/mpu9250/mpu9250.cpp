@@ -86,7 +86,8 @@ const uint16_t MPU9250::_mpu9250_checked_registers[MPU9250_NUM_CHECKED_REGISTERS
 										      MPUREG_ACCEL_CONFIG,
 										      MPUREG_ACCEL_CONFIG2,
 										      MPUREG_INT_ENABLE,
-										      MPUREG_INT_PIN_CFG
+										      MPUREG_INT_PIN_CFG,
+										      MPUREG_FIFO_EN
 										    };
 
 
@@ -112,7 +113,8 @@ const uint16_t MPU9250::_icm20948_checked_registers[ICM20948_NUM_CHECKED_REGISTE
 MPU9250::MPU9250(device::Device *interface, device::Device *mag_interface, const char *path_accel,
 		 const char *path_gyro, const char *path_mag,
 		 enum Rotation rotation,
-		 bool magnetometer_only) :
+		 bool magnetometer_only,
+		 bool fifo_mode) :
 	_interface(interface),
 	_whoami(0),
 	_accel(magnetometer_only ? nullptr : new MPU9250_accel(this, path_accel)),
@@ -149,6 +151,13 @@ MPU9250::MPU9250(device::Device *interface, device::Device *mag_interface, const
 	_good_transfers(perf_alloc(PC_COUNT, "mpu9250_good_trans")),
 	_reset_retries(perf_alloc(PC_COUNT, "mpu9250_reset")),
 	_duplicates(perf_alloc(PC_COUNT, "mpu9250_dupe")),
+	_fifo_empty(perf_alloc(PC_COUNT, "mpu9250_fifo_empty")),
+	_fifo_overflows(perf_alloc(PC_COUNT, "mpu9250_fifo_overflow")),
+	_fifo_mode(fifo_mode),
+	_fifo_report{},
+	_last_mag_measure(0),
+	_measure_time(0),
+	_measure_samples(0),
 	_register_wait(0),
 	_reset_wait(0),
 	_accel_filter_x(MPU9250_ACCEL_DEFAULT_RATE, MPU9250_ACCEL_DEFAULT_DRIVER_FILTER_FREQ),
@@ -247,6 +256,8 @@ MPU9250::~MPU9250()
 	perf_free(_good_transfers);
 	perf_free(_reset_retries);
 	perf_free(_duplicates);
+	perf_free(_fifo_empty);
+	perf_free(_fifo_overflows);
 }
 
 int
@@ -276,6 +287,13 @@ MPU9250::init()
 		return ret;
 	}
 
+	// bursts are only worth it on SPI, and the ICM20948 FIFO is configured
+	// through a different register bank
+	if (_fifo_mode && (is_i2c() || _magnetometer_only || _whoami == ICM_WHOAMI_20948)) {
+		PX4_WARN("FIFO mode not supported, using register reads");
+		_fifo_mode = false;
+	}
+
 	state = px4_enter_critical_section();
 	_reset_wait = hrt_absolute_time() + 100000;
 	px4_leave_critical_section(state);
@@ -389,6 +407,8 @@ MPU9250::init()
 		}
 	}
 
+	fifo_start();
+
 	measure();
 
 	if (!_magnetometer_only) {
@@ -447,6 +467,10 @@ int MPU9250::reset()
 		ret = _mag->ak8963_reset();
 	}
 
+	if (ret == OK) {
+		fifo_start();
+	}
+
 
 	state = px4_enter_critical_section();
 	_reset_wait = hrt_absolute_time() + 10;
@@ -481,13 +505,20 @@ int MPU9250::reset_mpu()
 	// Enable I2C bus or Disable I2C bus (recommended on data sheet)
 
 
-	write_checked_reg(MPU_OR_ICM(MPUREG_USER_CTRL, ICMREG_20948_USER_CTRL), is_i2c() ? 0 : BIT_I2C_IF_DIS);
+	write_checked_reg(MPU_OR_ICM(MPUREG_USER_CTRL, ICMREG_20948_USER_CTRL),
+			  (is_i2c() ? 0 : BIT_I2C_IF_DIS) | (_fifo_mode ? BIT_FIFO_EN : 0));
 
 
 	// SAMPLE RATE
-	_set_sample_rate(_sample_rate);
+	if (_fifo_mode) {
+		// no divider, the gyro runs at its full output rate with the DLPF bypassed
+		write_checked_reg(MPUREG_SMPLRT_DIV, 0);
 
-	_set_dlpf_filter(MPU9250_DEFAULT_ONCHIP_FILTER_FREQ);
+	} else {
+		_set_sample_rate(_sample_rate);
+	}
+
+	_set_dlpf_filter(_fifo_mode ? MPU9250_FIFO_ONCHIP_FILTER_FREQ : MPU9250_DEFAULT_ONCHIP_FILTER_FREQ);
 
 	// Gyro scale 2000 deg/s ()
 	switch (_whoami) {
@@ -537,6 +568,11 @@ int MPU9250::reset_mpu()
 	write_checked_reg(MPU_OR_ICM(MPUREG_ACCEL_CONFIG2, ICMREG_20948_ACCEL_CONFIG_2),
 			  MPU_OR_ICM(BITS_ACCEL_CONFIG2_41HZ, ICM_BITS_DEC3_CFG_32));
 
+	if (_whoami != ICM_WHOAMI_20948) {
+		// accel, temperature and gyro are written to the FIFO on every sample
+		write_checked_reg(MPUREG_FIFO_EN, _fifo_mode ? BITS_FIFO_ENABLE_ALL : 0);
+	}
+
 	retries = 3;
 	bool all_ok = false;
 
@@ -671,9 +707,9 @@ MPU9250::_set_pollrate(unsigned long rate)
 			return -EINVAL;
 		}
 
-		// adjust filters
+		// adjust filters, in FIFO mode they run at the sensor sample rate
 		float cutoff_freq_hz = _accel_filter_x.get_cutoff_freq();
-		float sample_rate = 1.0e6f / ticks;
+		float sample_rate = _fifo_mode ? MPU9250_FIFO_SAMPLE_RATE : 1.0e6f / ticks;
 		_accel_filter_x.set_cutoff_frequency(sample_rate, cutoff_freq_hz);
 		_accel_filter_y.set_cutoff_frequency(sample_rate, cutoff_freq_hz);
 		_accel_filter_z.set_cutoff_frequency(sample_rate, cutoff_freq_hz);
@@ -686,7 +722,7 @@ MPU9250::_set_pollrate(unsigned long rate)
 
 		/* update interval for next measurement */
 		/* XXX this is a bit shady, but no other way to adjust... */
-		_call_interval = ticks;
+		_call_interval = _fifo_mode ? MPU9250_FIFO_INTERVAL_US : ticks;
 
 		/*
 		  set call interval faster than the sample time. We
@@ -694,7 +730,7 @@ MPU9250::_set_pollrate(unsigned long rate)
 		  them. This prevents aliasing due to a beat between the
 		  stm32 clock and the mpu9250 clock
 		 */
-		_call.period = _call_interval - MPU9250_TIMER_REDUCTION;
+		_call.period = call_period();
 
 		/* if we need to start the poll state machine, do it */
 		if (want_start) {
@@ -1057,7 +1093,7 @@ MPU9250::start()
 		/* start polling at the specified rate */
 		hrt_call_every(&_call,
 			       1000,
-			       _call_interval - MPU9250_TIMER_REDUCTION,
+			       call_period(),
 			       (hrt_callout)&MPU9250::measure_trampoline, this);
 
 	} else {
@@ -1083,6 +1119,12 @@ MPU9250::stop()
 }
 
 
+unsigned
+MPU9250::call_period()
+{
+	return _fifo_mode ? _call_interval : _call_interval - MPU9250_TIMER_REDUCTION;
+}
+
 #if defined(USE_I2C)
 void
 MPU9250::cycle_trampoline(void *arg)
@@ -1238,25 +1280,31 @@ bool MPU9250::check_duplicate(uint8_t *accel_data)
 void
 MPU9250::measure()
 {
-
 	if (hrt_absolute_time() < _reset_wait) {
 		// we're waiting for a reset to complete
 		return;
 	}
 
+	const hrt_abstime measure_start = hrt_absolute_time();
+
+	if (_fifo_mode) {
+		measure_fifo();
+
+	} else {
+		measure_registers();
+	}
+
+	_measure_time += hrt_elapsed_time(&measure_start);
+}
+
+void
+MPU9250::measure_registers()
+{
 	struct MPUReport mpu_report;
 
 	struct ICMReport icm_report;
 
-	struct Report {
-		int16_t		accel_x;
-		int16_t		accel_y;
-		int16_t		accel_z;
-		int16_t		temp;
-		int16_t		gyro_x;
-		int16_t		gyro_y;
-		int16_t		gyro_z;
-	} report;
+	Report report;
 
 	/* start measuring */
 	perf_begin(_sample_perf);
@@ -1364,155 +1412,340 @@ MPU9250::measure()
 	if (!_magnetometer_only) {
 
 		/*
-		 * Keeping the axes as they are for ICM20948 so orientation will match the actual chip orientation
+		 * Report buffers.
 		 */
-		if (_whoami != ICM_WHOAMI_20948) {
-			/*
-			 * Swap axes and negate y
-			 */
-
-			int16_t accel_xt = report.accel_y;
-			int16_t accel_yt = ((report.accel_x == -32768) ? 32767 : -report.accel_x);
-
-			int16_t gyro_xt = report.gyro_y;
-			int16_t gyro_yt = ((report.gyro_x == -32768) ? 32767 : -report.gyro_x);
-
-			/*
-			 * Apply the swap
-			 */
-			report.accel_x = accel_xt;
-			report.accel_y = accel_yt;
-			report.gyro_x = gyro_xt;
-			report.gyro_y = gyro_yt;
+		sensor_accel_s		arb{};
+		sensor_gyro_s			grb{};
+		bool accel_notify = false;
+		bool gyro_notify = false;
+
+		process_sample(report, hrt_absolute_time(), arb, grb, accel_notify, gyro_notify);
+		publish_reports(arb, grb, accel_notify, gyro_notify);
+
+		_measure_samples++;
+	}
+
+	/* stop measuring */
+	perf_end(_sample_perf);
+}
+
+void
+MPU9250::measure_fifo()
+{
+	/* start measuring */
+	perf_begin(_sample_perf);
+
+	uint8_t fifo_count[2];
+
+	// the FIFO is read at high clock speed like the sensor registers
+	if (OK != read_reg_range(MPUREG_FIFO_COUNTH, MPU9250_HIGH_BUS_SPEED, fifo_count, sizeof(fifo_count))) {
+		perf_end(_sample_perf);
+		return;
+	}
+
+	check_registers();
+
+	/*
+	 * The magnetometer is not in the FIFO. The I2C master keeps copying it
+	 * into the external sensor registers, fetch them at the magnetometer rate.
+	 */
+	if (hrt_elapsed_time(&_last_mag_measure) >= MPU9250_FIFO_MAG_INTERVAL_US) {
+		_last_mag_measure = hrt_absolute_time();
+
+#   ifdef USE_I2C
+
+		if (_mag->is_passthrough()) {
+#   endif
+			// the interface needs a full report sized buffer for the transfer
+			struct MPUReport mpu_report;
+
+			if (OK == read_reg_range(MPUREG_INT_STATUS, MPU9250_HIGH_BUS_SPEED, (uint8_t *)&mpu_report, sizeof(mpu_report))) {
+				_mag->_measure(mpu_report.mag);
+			}
+
+#   ifdef USE_I2C
+
+		} else {
+			_mag->measure();
+		}
+
+#   endif
+	}
+
+	const unsigned fifo_bytes = (fifo_count[0] << 8) | fifo_count[1];
+
+	if (fifo_bytes >= MPU9250_FIFO_SIZE || (fifo_bytes % sizeof(MPUFIFOSample)) != 0) {
+		// the FIFO overflowed and lost samples or is no longer
+		// aligned to a sample boundary, start over
+		perf_count(_fifo_overflows);
+		fifo_reset();
+		perf_end(_sample_perf);
+		return;
+	}
+
+	const unsigned fifo_samples = fifo_bytes / sizeof(MPUFIFOSample);
+	unsigned samples = fifo_samples;
+
+	if (samples < MPU9250_FIFO_MIN_SAMPLES) {
+		// leave it for the next burst
+		perf_count(_fifo_empty);
+		perf_end(_sample_perf);
+		return;
+	}
+
+	if (samples > MPU9250_FIFO_MAX_SAMPLES) {
+		// the rest is read on the next callback
+		samples = MPU9250_FIFO_MAX_SAMPLES;
+	}
+
+	if (OK != read_reg_range(MPUREG_FIFO_R_W, MPU9250_HIGH_BUS_SPEED, (uint8_t *)&_fifo_report,
+				 sizeof(_fifo_report.cmd) + samples * sizeof(MPUFIFOSample))) {
+		perf_end(_sample_perf);
+		return;
+	}
+
+	if (_register_wait != 0) {
+		// we are waiting for some good transfers before using
+		// the sensor again, don't return any data yet
+		_register_wait--;
+		perf_end(_sample_perf);
+		return;
+	}
+
+	// check the whole burst before any sample reaches the filters and integrators
+	for (unsigned i = 0; i < samples; i++) {
+		MPUFIFOSample &sample = _fifo_report.samples[i];
+		Report report;
+
+		report.accel_x = int16_t_from_bytes(sample.accel_x);
+		report.accel_y = int16_t_from_bytes(sample.accel_y);
+		report.accel_z = int16_t_from_bytes(sample.accel_z);
+		report.temp    = int16_t_from_bytes(sample.temp);
+		report.gyro_x  = int16_t_from_bytes(sample.gyro_x);
+		report.gyro_y  = int16_t_from_bytes(sample.gyro_y);
+		report.gyro_z  = int16_t_from_bytes(sample.gyro_z);
+
+		// ends the sample perf counter on failure
+		if (check_null_data((uint16_t *)&report, sizeof(report) / 2)) {
+			return;
 		}
+	}
+
+	sensor_accel_s arb{};
+	sensor_gyro_s grb{};
+	bool accel_notify = false;
+	bool gyro_notify = false;
+
+	// the last sample in the FIFO is the newest, the others are spaced
+	// by the sensor sample interval before it. Only the oldest samples
+	// are read if the FIFO holds more than a burst.
+	const hrt_abstime now = hrt_absolute_time();
+	const unsigned sample_interval_us = 1000000 / MPU9250_FIFO_SAMPLE_RATE;
+
+	for (unsigned i = 0; i < samples; i++) {
+		MPUFIFOSample &sample = _fifo_report.samples[i];
+		Report report;
+
+		report.accel_x = int16_t_from_bytes(sample.accel_x);
+		report.accel_y = int16_t_from_bytes(sample.accel_y);
+		report.accel_z = int16_t_from_bytes(sample.accel_z);
+		report.temp    = int16_t_from_bytes(sample.temp);
+		report.gyro_x  = int16_t_from_bytes(sample.gyro_x);
+		report.gyro_y  = int16_t_from_bytes(sample.gyro_y);
+		report.gyro_z  = int16_t_from_bytes(sample.gyro_z);
 
 		/*
-		 * Report buffers.
+		 * Get sensor temperature
 		 */
-		sensor_accel_s		arb;
-		sensor_gyro_s			grb;
+		_last_temperature = (report.temp) / 333.87f + 21.0f;
+
+		process_sample(report, now - (fifo_samples - 1 - i) * sample_interval_us, arb, grb, accel_notify, gyro_notify);
+	}
+
+	publish_reports(arb, grb, accel_notify, gyro_notify);
+
+	_measure_samples += samples;
 
+	/* stop measuring */
+	perf_end(_sample_perf);
+}
+
+void
+MPU9250::process_sample(Report &report, hrt_abstime timestamp, sensor_accel_s &arb, sensor_gyro_s &grb,
+			bool &accel_notify, bool &gyro_notify)
+{
+	/*
+	 * Keeping the axes as they are for ICM20948 so orientation will match the actual chip orientation
+	 */
+	if (_whoami != ICM_WHOAMI_20948) {
 		/*
-		 * Adjust and scale results to m/s^2.
+		 * Swap axes and negate y
 		 */
-		grb.timestamp = arb.timestamp = hrt_absolute_time();
 
-		// report the error count as the sum of the number of bad
-		// transfers and bad register reads. This allows the higher
-		// level code to decide if it should use this sensor based on
-		// whether it has had failures
-		grb.error_count = arb.error_count = perf_event_count(_bad_transfers) + perf_event_count(_bad_registers);
+		int16_t accel_xt = report.accel_y;
+		int16_t accel_yt = ((report.accel_x == -32768) ? 32767 : -report.accel_x);
+
+		int16_t gyro_xt = report.gyro_y;
+		int16_t gyro_yt = ((report.gyro_x == -32768) ? 32767 : -report.gyro_x);
 
 		/*
-		 * 1) Scale raw value to SI units using scaling from datasheet.
-		 * 2) Subtract static offset (in SI units)
-		 * 3) Scale the statically calibrated values with a linear
-		 *    dynamically obtained factor
-		 *
-		 * Note: the static sensor offset is the number the sensor outputs
-		 * 	 at a nominally 'zero' input. Therefore the offset has to
-		 * 	 be subtracted.
-		 *
-		 *	 Example: A gyro outputs a value of 74 at zero angular rate
-		 *	 	  the offset is 74 from the origin and subtracting
-		 *		  74 from all measurements centers them around zero.
+		 * Apply the swap
 		 */
+		report.accel_x = accel_xt;
+		report.accel_y = accel_yt;
+		report.gyro_x = gyro_xt;
+		report.gyro_y = gyro_yt;
+	}
+
+	/*
+	 * Adjust and scale results to m/s^2.
+	 */
+	grb.timestamp = arb.timestamp = timestamp;
 
-		/* NOTE: Axes have been swapped to match the board a few lines above. */
+	/*
+	 * 1) Scale raw value to SI units using scaling from datasheet.
+	 * 2) Subtract static offset (in SI units)
+	 * 3) Scale the statically calibrated values with a linear
+	 *    dynamically obtained factor
+	 *
+	 * Note: the static sensor offset is the number the sensor outputs
+	 * 	 at a nominally 'zero' input. Therefore the offset has to
+	 * 	 be subtracted.
+	 *
+	 *	 Example: A gyro outputs a value of 74 at zero angular rate
+	 *	 	  the offset is 74 from the origin and subtracting
+	 *		  74 from all measurements centers them around zero.
+	 */
+
+	/* NOTE: Axes have been swapped to match the board a few lines above. */
 
-		arb.x_raw = report.accel_x;
-		arb.y_raw = report.accel_y;
-		arb.z_raw = report.accel_z;
+	arb.x_raw = report.accel_x;
+	arb.y_raw = report.accel_y;
+	arb.z_raw = report.accel_z;
 
-		float xraw_f = report.accel_x;
-		float yraw_f = report.accel_y;
-		float zraw_f = report.accel_z;
+	float xraw_f = report.accel_x;
+	float yraw_f = report.accel_y;
+	float zraw_f = report.accel_z;
 
-		// apply user specified rotation
-		rotate_3f(_rotation, xraw_f, yraw_f, zraw_f);
+	// apply user specified rotation
+	rotate_3f(_rotation, xraw_f, yraw_f, zraw_f);
 
-		float x_in_new = ((xraw_f * _accel_range_scale) - _accel_scale.x_offset) * _accel_scale.x_scale;
-		float y_in_new = ((yraw_f * _accel_range_scale) - _accel_scale.y_offset) * _accel_scale.y_scale;
-		float z_in_new = ((zraw_f * _accel_range_scale) - _accel_scale.z_offset) * _accel_scale.z_scale;
+	float x_in_new = ((xraw_f * _accel_range_scale) - _accel_scale.x_offset) * _accel_scale.x_scale;
+	float y_in_new = ((yraw_f * _accel_range_scale) - _accel_scale.y_offset) * _accel_scale.y_scale;
+	float z_in_new = ((zraw_f * _accel_range_scale) - _accel_scale.z_offset) * _accel_scale.z_scale;
 
-		arb.x = _accel_filter_x.apply(x_in_new);
-		arb.y = _accel_filter_y.apply(y_in_new);
-		arb.z = _accel_filter_z.apply(z_in_new);
+	arb.x = _accel_filter_x.apply(x_in_new);
+	arb.y = _accel_filter_y.apply(y_in_new);
+	arb.z = _accel_filter_z.apply(z_in_new);
 
-		matrix::Vector3f aval(x_in_new, y_in_new, z_in_new);
-		matrix::Vector3f aval_integrated;
+	matrix::Vector3f aval(x_in_new, y_in_new, z_in_new);
+	matrix::Vector3f aval_integrated;
 
-		bool accel_notify = _accel_int.put(arb.timestamp, aval, aval_integrated, arb.integral_dt);
+	if (_accel_int.put(arb.timestamp, aval, aval_integrated, arb.integral_dt)) {
 		arb.x_integral = aval_integrated(0);
 		arb.y_integral = aval_integrated(1);
 		arb.z_integral = aval_integrated(2);
+		accel_notify = true;
+	}
 
-		arb.scaling = _accel_range_scale;
-
-		arb.temperature = _last_temperature;
-
-		/* return device ID */
-		arb.device_id = _accel->_device_id.devid;
+	arb.scaling = _accel_range_scale;
 
-		grb.x_raw = report.gyro_x;
-		grb.y_raw = report.gyro_y;
-		grb.z_raw = report.gyro_z;
+	grb.x_raw = report.gyro_x;
+	grb.y_raw = report.gyro_y;
+	grb.z_raw = report.gyro_z;
 
-		xraw_f = report.gyro_x;
-		yraw_f = report.gyro_y;
-		zraw_f = report.gyro_z;
+	xraw_f = report.gyro_x;
+	yraw_f = report.gyro_y;
+	zraw_f = report.gyro_z;
 
-		// apply user specified rotation
-		rotate_3f(_rotation, xraw_f, yraw_f, zraw_f);
+	// apply user specified rotation
+	rotate_3f(_rotation, xraw_f, yraw_f, zraw_f);
 
-		float x_gyro_in_new = ((xraw_f * _gyro_range_scale) - _gyro_scale.x_offset) * _gyro_scale.x_scale;
-		float y_gyro_in_new = ((yraw_f * _gyro_range_scale) - _gyro_scale.y_offset) * _gyro_scale.y_scale;
-		float z_gyro_in_new = ((zraw_f * _gyro_range_scale) - _gyro_scale.z_offset) * _gyro_scale.z_scale;
+	float x_gyro_in_new = ((xraw_f * _gyro_range_scale) - _gyro_scale.x_offset) * _gyro_scale.x_scale;
+	float y_gyro_in_new = ((yraw_f * _gyro_range_scale) - _gyro_scale.y_offset) * _gyro_scale.y_scale;
+	float z_gyro_in_new = ((zraw_f * _gyro_range_scale) - _gyro_scale.z_offset) * _gyro_scale.z_scale;
 
-		grb.x = _gyro_filter_x.apply(x_gyro_in_new);
-		grb.y = _gyro_filter_y.apply(y_gyro_in_new);
-		grb.z = _gyro_filter_z.apply(z_gyro_in_new);
+	grb.x = _gyro_filter_x.apply(x_gyro_in_new);
+	grb.y = _gyro_filter_y.apply(y_gyro_in_new);
+	grb.z = _gyro_filter_z.apply(z_gyro_in_new);
 
-		matrix::Vector3f gval(x_gyro_in_new, y_gyro_in_new, z_gyro_in_new);
-		matrix::Vector3f gval_integrated;
+	matrix::Vector3f gval(x_gyro_in_new, y_gyro_in_new, z_gyro_in_new);
+	matrix::Vector3f gval_integrated;
 
-		bool gyro_notify = _gyro_int.put(arb.timestamp, gval, gval_integrated, grb.integral_dt);
+	if (_gyro_int.put(arb.timestamp, gval, gval_integrated, grb.integral_dt)) {
 		grb.x_integral = gval_integrated(0);
 		grb.y_integral = gval_integrated(1);
 		grb.z_integral = gval_integrated(2);
+		gyro_notify = true;
+	}
 
-		grb.scaling = _gyro_range_scale;
+	grb.scaling = _gyro_range_scale;
+}
 
-		grb.temperature = _last_temperature;
+void
+MPU9250::publish_reports(sensor_accel_s &arb, sensor_gyro_s &grb, bool accel_notify, bool gyro_notify)
+{
+	// report the error count as the sum of the number of bad
+	// transfers and bad register reads. This allows the higher
+	// level code to decide if it should use this sensor based on
+	// whether it has had failures
+	grb.error_count = arb.error_count = perf_event_count(_bad_transfers) + perf_event_count(_bad_registers);
 
-		/* return device ID */
-		grb.device_id = _gyro->_device_id.devid;
+	arb.temperature = _last_temperature;
+	grb.temperature = _last_temperature;
 
-		_accel_reports->force(&arb);
-		_gyro_reports->force(&grb);
+	/* return device ID */
+	arb.device_id = _accel->_device_id.devid;
+	grb.device_id = _gyro->_device_id.devid;
 
-		/* notify anyone waiting for data */
-		if (accel_notify) {
-			_accel->poll_notify(POLLIN);
-		}
+	_accel_reports->force(&arb);
+	_gyro_reports->force(&grb);
 
-		if (gyro_notify) {
-			_gyro->parent_poll_notify();
-		}
+	/* notify anyone waiting for data */
+	if (accel_notify) {
+		_accel->poll_notify(POLLIN);
+	}
 
-		if (accel_notify && !(_accel->_pub_blocked)) {
-			/* publish it */
-			orb_publish(ORB_ID(sensor_accel), _accel_topic, &arb);
-		}
+	if (gyro_notify) {
+		_gyro->parent_poll_notify();
+	}
 
-		if (gyro_notify && !(_gyro->_pub_blocked)) {
-			/* publish it */
-			orb_publish(ORB_ID(sensor_gyro), _gyro->_gyro_topic, &grb);
-		}
+	if (accel_notify && !(_accel->_pub_blocked)) {
+		/* publish it */
+		orb_publish(ORB_ID(sensor_accel), _accel_topic, &arb);
 	}
 
-	/* stop measuring */
-	perf_end(_sample_perf);
+	if (gyro_notify && !(_gyro->_pub_blocked)) {
+		/* publish it */
+		orb_publish(ORB_ID(sensor_gyro), _gyro->_gyro_topic, &grb);
+	}
+}
+
+void
+MPU9250::fifo_start()
+{
+	if (!_fifo_mode) {
+		return;
+	}
+
+	if (_whoami == MPU_WHOAMI_9250 && _mag->is_passthrough()) {
+		// slow down the magnetometer reads of the I2C master, at the
+		// FIFO sample rate it would not finish one before the next starts.
+		// Done after the magnetometer setup, which relies on the slave
+		// transfers happening right away.
+		write_reg(MPUREG_I2C_SLV4_CTRL, MPU9250_FIFO_I2C_MST_DLY);
+		write_reg(MPUREG_I2C_MST_DELAY_CTRL, BIT_I2C_SLV0_DLY_EN);
+	}
+
+	fifo_reset();
+}
+
+void
+MPU9250::fifo_reset()
+{
+	// FIFO_RST only takes effect while the FIFO is disabled, it clears itself
+	modify_reg(MPUREG_USER_CTRL, BIT_FIFO_EN, BIT_FIFO_RST);
+	modify_reg(MPUREG_USER_CTRL, 0, BIT_FIFO_EN);
 }
 
 void
@@ -1527,8 +1760,15 @@ MPU9250::print_info()
 	perf_print_counter(_good_transfers);
 	perf_print_counter(_reset_retries);
 	perf_print_counter(_duplicates);
+	perf_print_counter(_fifo_empty);
+	perf_print_counter(_fifo_overflows);
 	::printf("temperature: %.1f\n", (double)_last_temperature);
 
+	if (_measure_samples > 0) {
+		::printf("%s reads: %.2f us per sample\n", _fifo_mode ? "FIFO" : "register",
+			 (double)_measure_time / (double)_measure_samples);
+	}
+
 	if (!_magnetometer_only) {
 		_accel_reports->print_info("accel queue");
 		_gyro_reports->print_info("gyro queue");
@@ -160,6 +160,7 @@
 #define BIT_I2C_MST_EN              0x20
 #define BIT_I2C_IF_DIS              0x10
 #define BIT_FIFO_RST                0x04
+#define BIT_FIFO_EN                 0x40
 #define BIT_I2C_MST_RST             0x02
 #define BIT_SIG_COND_RST            0x01
 
@@ -180,6 +181,13 @@
 #define BIT_I2C_SLV2_DLY_EN         0x04
 #define BIT_I2C_SLV3_DLY_EN         0x08
 
+#define BIT_TEMP_FIFO_EN            0x80
+#define BIT_XG_FIFO_EN              0x40
+#define BIT_YG_FIFO_EN              0x20
+#define BIT_ZG_FIFO_EN              0x10
+#define BIT_ACCEL_FIFO_EN           0x08
+#define BITS_FIFO_ENABLE_ALL        (BIT_TEMP_FIFO_EN | BIT_XG_FIFO_EN | BIT_YG_FIFO_EN | BIT_ZG_FIFO_EN | BIT_ACCEL_FIFO_EN)
+
 #define MPU_WHOAMI_9250             0x71
 #define MPU_WHOAMI_6500             0x70
 #define ICM_WHOAMI_20948            0xEA
@@ -194,6 +202,23 @@
 
 #define MPU9250_DEFAULT_ONCHIP_FILTER_FREQ	92
 
+/*
+  FIFO burst mode: the sensor samples at the full gyro output rate into
+  its FIFO and the driver drains it in bursts at a lower callback rate
+ */
+#define MPU9250_FIFO_SAMPLE_RATE	8000
+#define MPU9250_FIFO_ONCHIP_FILTER_FREQ	250
+#define MPU9250_FIFO_INTERVAL_US	1000
+/* twice the nominal burst to absorb callback jitter, the rest is read on the next callback */
+#define MPU9250_FIFO_MAX_SAMPLES	16
+/* the interface treats shorter transfers as plain register reads */
+#define MPU9250_FIFO_MIN_SAMPLES	2
+#define MPU9250_FIFO_SIZE		512
+/* I2C master slave reads at 8 kHz / (1 + 7), the AK8963 itself runs at 100 Hz */
+#define MPU9250_FIFO_I2C_MST_DLY	7
+/* the magnetometer registers are fetched separately at twice the AK8963 rate */
+#define MPU9250_FIFO_MAG_INTERVAL_US	5000
+
 #define MPUIOCGIS_I2C	(unsigned)(DEVIOCGDEVICEID+100)
 
 
@@ -343,6 +368,28 @@ struct MPUReport {
 	uint8_t		gyro_z[2];
 	struct ak8963_regs mag;
 };
+
+/**
+ * One FIFO entry with accel, temperature and gyro enabled. The sensor
+ * writes them in register order.
+ */
+struct MPUFIFOSample {
+	uint8_t		accel_x[2];
+	uint8_t		accel_y[2];
+	uint8_t		accel_z[2];
+	uint8_t		temp[2];
+	uint8_t		gyro_x[2];
+	uint8_t		gyro_y[2];
+	uint8_t		gyro_z[2];
+};
+
+/**
+ * FIFO burst read, including the command byte.
+ */
+struct MPUFIFOReport {
+	uint8_t		cmd;
+	MPUFIFOSample	samples[MPU9250_FIFO_MAX_SAMPLES];
+};
 #pragma pack(pop)
 
 #define MPU_MAX_WRITE_BUFFER_SIZE (2)
@@ -381,7 +428,8 @@ public:
 	MPU9250(device::Device *interface, device::Device *mag_interface, const char *path_accel, const char *path_gyro,
 		const char *path_mag,
 		enum Rotation rotation,
-		bool magnetometer_only);
+		bool magnetometer_only,
+		bool fifo_mode);
 
 	virtual ~MPU9250();
 
@@ -448,6 +496,17 @@ private:
 	perf_counter_t		_good_transfers;
 	perf_counter_t		_reset_retries;
 	perf_counter_t		_duplicates;
+	perf_counter_t		_fifo_empty;
+	perf_counter_t		_fifo_overflows;
+
+	// drain the sensor FIFO in bursts instead of reading the data registers
+	bool			_fifo_mode;
+	MPUFIFOReport		_fifo_report;
+	hrt_abstime		_last_mag_measure;
+
+	// CPU time spent in measure() and samples processed, for print_info()
+	uint64_t		_measure_time;
+	uint64_t		_measure_samples;
 
 	uint8_t			_register_wait;
 	uint64_t		_reset_wait;
@@ -472,7 +531,7 @@ private:
 #define MAX(X,Y) ((X) > (Y) ? (X) : (Y))
 #endif
 
-#define MPU9250_NUM_CHECKED_REGISTERS 11
+#define MPU9250_NUM_CHECKED_REGISTERS 12
 	static const uint16_t	_mpu9250_checked_registers[MPU9250_NUM_CHECKED_REGISTERS];
 #define ICM20948_NUM_CHECKED_REGISTERS 15
 	static const uint16_t	_icm20948_checked_registers[ICM20948_NUM_CHECKED_REGISTERS];
@@ -494,6 +553,20 @@ private:
 	uint8_t			_last_accel_data[6];
 	bool			_got_duplicate;
 
+	/**
+	 * Raw sample in native byte order, as read from the data registers
+	 * or the FIFO.
+	 */
+	struct Report {
+		int16_t		accel_x;
+		int16_t		accel_y;
+		int16_t		accel_z;
+		int16_t		temp;
+		int16_t		gyro_x;
+		int16_t		gyro_y;
+		int16_t		gyro_z;
+	};
+
 	/**
 	 * Start automatic measurement.
 	 */
@@ -568,6 +641,47 @@ private:
 	 */
 	void			measure();
 
+	/**
+	 * Read a single sample from the data registers.
+	 */
+	void			measure_registers();
+
+	/**
+	 * Drain the sensor FIFO and process all samples in one pass.
+	 */
+	void			measure_fifo();
+
+	/**
+	 * Scale, filter and integrate one raw sample into the reports.
+	 *
+	 * The integrals in the reports are only updated when the integrator
+	 * resets, which is signalled through accel_notify / gyro_notify.
+	 */
+	void			process_sample(Report &report, hrt_abstime timestamp, sensor_accel_s &arb, sensor_gyro_s &grb,
+					       bool &accel_notify, bool &gyro_notify);
+
+	/**
+	 * Queue the reports and publish them if the integrators reset.
+	 */
+	void			publish_reports(sensor_accel_s &arb, sensor_gyro_s &grb, bool accel_notify, bool gyro_notify);
+
+	/**
+	 * Start sampling into the FIFO once the magnetometer is set up.
+	 */
+	void			fifo_start();
+
+	/**
+	 * Discard the FIFO contents and restart sampling into it.
+	 */
+	void			fifo_reset();
+
+	/**
+	 * Period of the measurement callback. Register reads poll a bit
+	 * faster than the sample rate and drop duplicates, the FIFO absorbs
+	 * any jitter so bursts run at the nominal interval.
+	 */
+	unsigned		call_period();
+
 	/**
 	 * Select a register bank in ICM20948
 	 *
@@ -50,6 +50,7 @@
 #include <px4_getopt.h>
 #include <px4_log.h>
 #include <px4_module.h>
+#include <actuator_latency/actuator_latency.h>
 #include <circuit_breaker/circuit_breaker.h>
 #include <lib/cdev/CDev.hpp>
 #include <lib/mixer/mixer.h>
@@ -241,6 +242,7 @@ private:
 	MotorOrdering _motor_ordering;
 
 	perf_counter_t	_perf_control_latency;
+	ActuatorLatency	_latency;	///< output pipeline latency tracing
 
 	static bool	arm_nothrottle()
 	{
@@ -1181,6 +1183,7 @@ PX4FMU::cycle()
 				/* do mixing */
 				float outputs[_max_actuators];
 				const unsigned mixed_num_outputs = _mixers->mix(outputs, _num_outputs);
+				const hrt_abstime mixed = hrt_absolute_time();
 
 				/* the PWM limit call takes care of out of band errors, NaN and constrains */
 				uint16_t pwm_limited[MAX_ACTUATORS];
@@ -1251,6 +1254,7 @@ PX4FMU::cycle()
 
 					if (required && (timestamp_sample > 0)) {
 						perf_set_elapsed(_perf_control_latency, actuator_outputs.timestamp - timestamp_sample);
+						_latency.update(_controls[i], mixed, actuator_outputs.timestamp);
 						break;
 					}
 				}
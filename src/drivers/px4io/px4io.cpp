@@ -68,6 +68,7 @@
 
 #include <rc/dsm.h>
 
+#include <lib/actuator_latency/actuator_latency.h>
 #include <lib/mixer/mixer.h>
 #include <perf/perf_counter.h>
 #include <systemlib/err.h>
@@ -244,6 +245,7 @@ private:
 	perf_counter_t		_perf_update;		///< local performance counter for status updates
 	perf_counter_t		_perf_write;		///< local performance counter for PWM control writes
 	perf_counter_t		_perf_sample_latency;	///< total system latency (based on passed-through timestamp)
+	ActuatorLatency		_latency;		///< output pipeline latency tracing
 
 	/* cached IO state */
 	uint16_t		_status;		///< Various IO status flags
@@ -301,6 +303,24 @@ private:
 	 */
 	int			io_set_control_state(unsigned group);
 
+	/**
+	 * Fetch the controls of one group and convert them to IO register values
+	 *
+	 * @param group		Control group index.
+	 * @param controls	Control structure to populate.
+	 * @param regs		Register buffer, at least _max_controls entries.
+	 * @return		true if there are controls to send.
+	 */
+	bool			io_get_control_state(unsigned group, actuator_controls_s &controls, uint16_t *regs);
+
+	/**
+	 * Send the group 0 controls and fetch status, alarms, PWM outputs and
+	 * raw RC input from IO in a single transaction.
+	 *
+	 * @param send_controls	Send the group 0 controls if they were updated.
+	 */
+	int			io_exchange(bool send_controls);
+
 	/**
 	 * Send all controls to IO
 	 */
@@ -336,16 +356,44 @@ private:
 	 */
 	int			io_get_raw_rc_input(input_rc_s &input_rc);
 
+	/**
+	 * Decode RC inputs from raw RC input page registers.
+	 *
+	 * Channels beyond those already in regs are fetched from IO.
+	 *
+	 * @param regs		Registers starting at PX4IO_P_RAW_RC_COUNT, with room
+	 *			for all channels.
+	 * @param num_regs	Number of valid registers in regs.
+	 * @param input_rc	Input structure to populate.
+	 * @return		OK if data was returned.
+	 */
+	int			io_decode_raw_rc_input(uint16_t *regs, unsigned num_regs, input_rc_s &input_rc);
+
 	/**
 	 * Fetch and publish raw RC input data.
 	 */
 	int			io_publish_raw_rc();
 
+	/**
+	 * Publish decoded RC input data, tagged with the source from the IO status.
+	 */
+	int			io_publish_rc_input(input_rc_s &rc_val);
+
 	/**
 	 * Fetch and publish the PWM servo outputs.
 	 */
 	int			io_publish_pwm_outputs();
 
+	/**
+	 * Publish PWM servo outputs.
+	 */
+	void			io_publish_outputs(const uint16_t *servos, unsigned count);
+
+	/**
+	 * Publish the mixer saturation status.
+	 */
+	void			io_publish_mixer_status(uint16_t status);
+
 	/**
 	 * write register(s)
 	 *
@@ -940,25 +988,22 @@ PX4IO::task_main()
 		hrt_abstime now = hrt_absolute_time();
 
 		/* if we have new control data from the ORB, handle it */
-		if (fds[0].revents & POLLIN) {
-
-			/* we're not nice to the lower-priority control groups and only check them
-			   when the primary group updated (which is now). */
-			(void)io_set_control_groups();
-		}
+		const bool controls_updated = (fds[0].revents & POLLIN);
 
 		if (now >= poll_last + IO_POLL_INTERVAL) {
 			/* run at 50-250Hz */
 			poll_last = now;
 
-			/* pull status and alarms from IO */
-			io_get_status();
-
-			/* get raw R/C input from IO */
-			io_publish_raw_rc();
+			/* send group 0 and pull status, alarms, PWM outputs and raw R/C input from IO */
+			io_exchange(controls_updated);
 
-			/* fetch PWM outputs from IO */
-			io_publish_pwm_outputs();
+			/* we're not nice to the lower-priority control groups and only check them
+			   when the primary group updated (which is now). */
+			if (controls_updated) {
+				(void)io_set_control_state(1);
+				(void)io_set_control_state(2);
+				(void)io_set_control_state(3);
+			}
 
 			/* check updates on uORB topics and handle it */
 			bool updated = false;
@@ -973,6 +1018,10 @@ PX4IO::task_main()
 			if (updated) {
 				io_set_arming_state();
 			}
+
+		} else if (controls_updated) {
+			/* group 0 goes out with the next exchange only at the poll rate */
+			(void)io_set_control_groups();
 		}
 
 		if (!_armed && (now >= orb_check_last + ORB_CHECK_INTERVAL)) {
@@ -1267,12 +1316,118 @@ PX4IO::io_set_control_groups()
 	return ret;
 }
 
+int
+PX4IO::io_exchange(bool send_controls)
+{
+#ifdef PX4IO_SERIAL_BASE
+	actuator_controls_s	controls;
+	uint16_t		out[PX4IO_PROTOCOL_MAX_CONTROL_COUNT];
+	unsigned		out_count = 0;
+
+	if (send_controls && io_get_control_state(0, controls, out) && !_test_fmu_fail) {
+		out_count = _max_controls;
+	}
+
+	/* ask for as many R/C channels as seen last time, limited by the transfer size */
+	const unsigned prolog = (PX4IO_P_RAW_RC_BASE - PX4IO_P_RAW_RC_COUNT);
+	unsigned in_count = PX4IO_P_EXCHANGE_RAW_RC + prolog + _rc_chan_count;
+
+	if (in_count > _max_transfer / sizeof(uint16_t)) {
+		in_count = _max_transfer / sizeof(uint16_t);
+	}
+
+	uint16_t in[PKT_MAX_REGS];
+
+	const hrt_abstime prepared = hrt_absolute_time();
+	int ret = PX4IO_serial_exchange(_interface, PX4IO_PAGE_EXCHANGE, out, out_count, in, in_count);
+
+	if (ret != (int)in_count) {
+		PX4_DEBUG("io_exchange(%u,%u): error %d", out_count, in_count, ret);
+		return -1;
+	}
+
+	/* IO mixes after the transfer, so trace up to the end of the exchange */
+	if (out_count > 0) {
+		_latency.update(controls, prepared, hrt_absolute_time());
+	}
+
+	io_handle_status(in[PX4IO_P_EXCHANGE_STATUS_FLAGS]);
+	io_handle_alarms(in[PX4IO_P_EXCHANGE_STATUS_ALARMS]);
+	io_handle_vservo(in[PX4IO_P_EXCHANGE_STATUS_VSERVO], in[PX4IO_P_EXCHANGE_STATUS_VRSSI]);
+
+	/* the reply carries the first PX4IO_P_EXCHANGE_SERVO_COUNT outputs, fetch the rest */
+	uint16_t servos[_max_actuators];
+
+	for (unsigned i = 0; i < _max_actuators && i < PX4IO_P_EXCHANGE_SERVO_COUNT; i++) {
+		servos[i] = in[PX4IO_P_EXCHANGE_SERVOS + i];
+	}
+
+	if (_max_actuators <= PX4IO_P_EXCHANGE_SERVO_COUNT
+	    || io_reg_get(PX4IO_PAGE_SERVOS, PX4IO_P_EXCHANGE_SERVO_COUNT, &servos[PX4IO_P_EXCHANGE_SERVO_COUNT],
+			  _max_actuators - PX4IO_P_EXCHANGE_SERVO_COUNT) == OK) {
+		io_publish_outputs(servos, _max_actuators);
+	}
+
+	io_publish_mixer_status(in[PX4IO_P_EXCHANGE_STATUS_MIXER]);
+
+	/* decode R/C input, reading any channels that did not fit */
+	input_rc_s	rc_val;
+	uint16_t	rc_regs[input_rc_s::RC_INPUT_MAX_CHANNELS + prolog];
+	const unsigned	rc_count = in_count - PX4IO_P_EXCHANGE_RAW_RC;
+
+	memcpy(rc_regs, &in[PX4IO_P_EXCHANGE_RAW_RC], rc_count * sizeof(uint16_t));
+
+	ret = io_decode_raw_rc_input(rc_regs, rc_count, rc_val);
+
+	if (ret != OK) {
+		return ret;
+	}
+
+	return io_publish_rc_input(rc_val);
+#else
+	/* the I2C link has no exchange page, use individual transfers */
+	if (send_controls) {
+		(void)io_set_control_state(0);
+	}
+
+	io_get_status();
+	io_publish_raw_rc();
+	io_publish_pwm_outputs();
+
+	return OK;
+#endif
+}
+
 int
 PX4IO::io_set_control_state(unsigned group)
 {
 	actuator_controls_s	controls;	///< actuator outputs
 	uint16_t 		regs[_max_actuators];
 
+	if (!io_get_control_state(group, controls, regs)) {
+		return -1;
+	}
+
+	if (!_test_fmu_fail) {
+		/* copy values to registers in IO */
+		const hrt_abstime prepared = hrt_absolute_time();
+		int ret = io_reg_set(PX4IO_PAGE_CONTROLS, group * PX4IO_PROTOCOL_MAX_CONTROL_COUNT, regs, _max_controls);
+
+		/* IO mixes after the transfer, so trace up to the register write */
+		if (group == 0 && ret == OK) {
+			_latency.update(controls, prepared, hrt_absolute_time());
+		}
+
+		return ret;
+
+	} else {
+		return OK;
+	}
+}
+
+bool
+PX4IO::io_get_control_state(unsigned group, actuator_controls_s &controls, uint16_t *regs)
+{
 	/* get controls */
 	bool changed = false;
 
@@ -1316,7 +1471,7 @@ PX4IO::io_set_control_state(unsigned group)
 	}
 
 	if (!changed && (!_in_esc_calibration_mode || group != 0)) {
-		return -1;
+		return false;
 
 	} else if (_in_esc_calibration_mode && group == 0) {
 		/* modify controls to get max pwm (full thrust) on every esc */
@@ -1341,13 +1496,7 @@ PX4IO::io_set_control_state(unsigned group)
 		regs[i] = FLOAT_TO_REG(ctrl);
 	}
 
-	if (!_test_fmu_fail) {
-		/* copy values to registers in IO */
-		return io_reg_set(PX4IO_PAGE_CONTROLS, group * PX4IO_PROTOCOL_MAX_CONTROL_COUNT, regs, _max_controls);
-
-	} else {
-		return OK;
-	}
+	return true;
 }
 
 
@@ -1745,7 +1894,6 @@ PX4IO::io_get_status()
 int
 PX4IO::io_get_raw_rc_input(input_rc_s &input_rc)
 {
-	uint32_t channel_count;
 	int	ret;
 
 	/* we don't have the status bits, so input_source has to be set elsewhere */
@@ -1765,6 +1913,17 @@ PX4IO::io_get_raw_rc_input(input_rc_s &input_rc)
 		return ret;
 	}
 
+	return io_decode_raw_rc_input(regs, prolog + 9, input_rc);
+}
+
+int
+PX4IO::io_decode_raw_rc_input(uint16_t *regs, unsigned num_regs, input_rc_s &input_rc)
+{
+	uint32_t channel_count;
+	int	ret = OK;
+
+	const unsigned prolog = (PX4IO_P_RAW_RC_BASE - PX4IO_P_RAW_RC_COUNT);
+
 	/*
 	 * Get the channel count any any extra channels. This is no more expensive than reading the
 	 * channel count once.
@@ -1815,8 +1974,10 @@ PX4IO::io_get_raw_rc_input(input_rc_s &input_rc)
 	/* FIELDS NOT SET HERE */
 	/* input_rc.input_source is set after this call XXX we might want to mirror the flags in the RC struct */
 
-	if (channel_count > 9) {
-		ret = io_reg_get(PX4IO_PAGE_RAW_RC_INPUT, PX4IO_P_RAW_RC_BASE + 9, &regs[prolog + 9], channel_count - 9);
+	if (prolog + channel_count > num_regs) {
+		const unsigned have = num_regs - prolog;
+
+		ret = io_reg_get(PX4IO_PAGE_RAW_RC_INPUT, PX4IO_P_RAW_RC_BASE + have, &regs[num_regs], channel_count - have);
 
 		if (ret != OK) {
 			return ret;
@@ -1861,6 +2022,12 @@ PX4IO::io_publish_raw_rc()
 		return ret;
 	}
 
+	return io_publish_rc_input(rc_val);
+}
+
+int
+PX4IO::io_publish_rc_input(input_rc_s &rc_val)
+{
 	/* sort out the source of the values */
 	if (_status & PX4IO_P_STATUS_FLAGS_RC_PPM) {
 		rc_val.input_source = input_rc_s::RC_INPUT_SOURCE_PX4IO_PPM;
@@ -1900,25 +2067,42 @@ PX4IO::io_publish_pwm_outputs()
 		return ret;
 	}
 
+	io_publish_outputs(ctl, _max_actuators);
+
+	/* get mixer status flags from IO */
+	uint16_t mixer_status;
+	ret = io_reg_get(PX4IO_PAGE_STATUS, PX4IO_P_STATUS_MIXER, &mixer_status, 1);
+
+	if (ret != OK) {
+		return ret;
+	}
+
+	io_publish_mixer_status(mixer_status);
+
+	return OK;
+}
+
+void
+PX4IO::io_publish_outputs(const uint16_t *servos, unsigned count)
+{
 	actuator_outputs_s outputs = {};
 	outputs.timestamp = hrt_absolute_time();
-	outputs.noutputs = _max_actuators;
+	outputs.noutputs = count;
 
 	/* convert from register format to float */
-	for (unsigned i = 0; i < _max_actuators; i++) {
-		outputs.output[i] = ctl[i];
+	for (unsigned i = 0; i < count; i++) {
+		outputs.output[i] = servos[i];
 	}
 
 	int instance;
 	orb_publish_auto(ORB_ID(actuator_outputs), &_to_outputs, &outputs, &instance, ORB_PRIO_DEFAULT);
+}
 
-	/* get mixer status flags from IO */
+void
+PX4IO::io_publish_mixer_status(uint16_t status)
+{
 	MultirotorMixer::saturation_status saturation_status;
-	ret = io_reg_get(PX4IO_PAGE_STATUS, PX4IO_P_STATUS_MIXER, &saturation_status.value, 1);
-
-	if (ret != OK) {
-		return ret;
-	}
+	saturation_status.value = status;
 
 	/* publish mixer status */
 	if (saturation_status.flags.valid) {
@@ -1926,10 +2110,9 @@ PX4IO::io_publish_pwm_outputs()
 		motor_limits.timestamp = hrt_absolute_time();
 		motor_limits.saturation_status = saturation_status.value;
 
+		int instance;
 		orb_publish_auto(ORB_ID(multirotor_motor_limits), &_to_mixer_status, &motor_limits, &instance, ORB_PRIO_DEFAULT);
 	}
-
-	return OK;
 }
 
 int
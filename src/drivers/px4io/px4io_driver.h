@@ -45,4 +45,10 @@
 #include <drivers/device/device.h>
 
 device::Device	*PX4IO_serial_interface();
+
+/**
+ * Combined write and read back transaction on the serial interface, see PX4IO_serial::exchange()
+ */
+int		PX4IO_serial_exchange(device::Device *interface, unsigned page, const void *out, unsigned out_count,
+				      void *in, unsigned in_count);
 #endif
@@ -49,6 +49,13 @@ device::Device
 	return new PX4IO_INTERFACE_CLASS();
 }
 
+int
+PX4IO_serial_exchange(device::Device *interface, unsigned page, const void *out, unsigned out_count, void *in,
+		      unsigned in_count)
+{
+	return static_cast<PX4IO_serial *>(interface)->exchange(page, out, out_count, in, in_count);
+}
+
 PX4IO_serial::PX4IO_serial() :
 	Device("PX4IO_serial"),
 	_pc_txns(perf_alloc(PC_ELAPSED, "io_txns")),
@@ -69,6 +76,7 @@ PX4IO_serial::PX4IO_serial() :
 	_pc_idle(nullptr),
 	_pc_badidle(nullptr),
 #endif
+	_pc_link_bytes(perf_alloc(PC_COUNT, "io_link_bytes")),
 	_bus_semaphore(SEM_INITIALIZER(0))
 {
 	g_interface = this;
@@ -87,6 +95,7 @@ PX4IO_serial::~PX4IO_serial()
 	perf_free(_pc_uerrs);
 	perf_free(_pc_idle);
 	perf_free(_pc_badidle);
+	perf_free(_pc_link_bytes);
 
 	if (g_interface == this) {
 		g_interface = nullptr;
@@ -133,10 +142,12 @@ PX4IO_serial::write(unsigned address, void *data, unsigned count)
 		_io_buffer_ptr->crc = crc_packet(_io_buffer_ptr);
 
 		/* start the transaction and wait for it to complete */
+		const size_t request_size = PKT_SIZE(*_io_buffer_ptr);
 		result = _bus_exchange(_io_buffer_ptr);
 
 		/* successful transaction? */
 		if (result == OK) {
+			_count_bytes(request_size);
 
 			/* check result in packet */
 			if (PKT_CODE(*_io_buffer_ptr) == PKT_CODE_ERROR) {
@@ -186,10 +197,12 @@ PX4IO_serial::read(unsigned address, void *data, unsigned count)
 		_io_buffer_ptr->crc = crc_packet(_io_buffer_ptr);
 
 		/* start the transaction and wait for it to complete */
+		const size_t request_size = PKT_SIZE(*_io_buffer_ptr);
 		result = _bus_exchange(_io_buffer_ptr);
 
 		/* successful transaction? */
 		if (result == OK) {
+			_count_bytes(request_size);
 
 			/* check result in packet */
 			if (PKT_CODE(*_io_buffer_ptr) == PKT_CODE_ERROR) {
@@ -228,3 +241,78 @@ PX4IO_serial::read(unsigned address, void *data, unsigned count)
 
 	return result;
 }
+
+int
+PX4IO_serial::exchange(unsigned page, const void *out, unsigned out_count, void *in, unsigned in_count)
+{
+	if (out_count > PKT_MAX_REGS || in_count > PKT_MAX_REGS) {
+		return -EINVAL;
+	}
+
+	px4_sem_wait(&_bus_semaphore);
+
+	int result;
+
+	for (unsigned retries = 0; retries < 3; retries++) {
+		_io_buffer_ptr->count_code = out_count | PKT_CODE_WRITE;
+		_io_buffer_ptr->page = page;
+		/* the offset carries the number of registers requested back */
+		_io_buffer_ptr->offset = in_count;
+		memcpy((void *)&_io_buffer_ptr->regs[0], out, (2 * out_count));
+
+		for (unsigned i = out_count; i < PKT_MAX_REGS; i++) {
+			_io_buffer_ptr->regs[i] = 0x55aa;
+		}
+
+		_io_buffer_ptr->crc = 0;
+		_io_buffer_ptr->crc = crc_packet(_io_buffer_ptr);
+
+		/* start the transaction and wait for it to complete */
+		const size_t request_size = PKT_SIZE(*_io_buffer_ptr);
+		result = _bus_exchange(_io_buffer_ptr);
+
+		/* successful transaction? */
+		if (result == OK) {
+			_count_bytes(request_size);
+
+			/* check result in packet */
+			if (PKT_CODE(*_io_buffer_ptr) == PKT_CODE_ERROR) {
+
+				/* IO didn't like it - no point retrying */
+				result = -EINVAL;
+				perf_count(_pc_protoerrs);
+
+			} else if (PKT_COUNT(*_io_buffer_ptr) != in_count) {
+
+				/* IO returned the wrong number of registers - no point retrying */
+				result = -EIO;
+				perf_count(_pc_protoerrs);
+
+			} else {
+
+				/* copy back the result */
+				memcpy(in, &_io_buffer_ptr->regs[0], (2 * in_count));
+			}
+
+			break;
+		}
+
+		perf_count(_pc_retries);
+	}
+
+	px4_sem_post(&_bus_semaphore);
+
+	if (result == OK) {
+		result = in_count;
+	}
+
+	return result;
+}
+
+void
+PX4IO_serial::_count_bytes(size_t request_size)
+{
+	/* the reply is in the same buffer now */
+	_link_bytes += request_size + PKT_SIZE(*_io_buffer_ptr);
+	perf_set_count(_pc_link_bytes, _link_bytes);
+}
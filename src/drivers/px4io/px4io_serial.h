@@ -71,6 +71,14 @@ public:
 	virtual int	read(unsigned offset, void *data, unsigned count = 1);
 	virtual int	write(unsigned address, void *data, unsigned count = 1);
 
+	/**
+	 * Write registers and read the reply registers back in the same transaction,
+	 * used for PX4IO_PAGE_EXCHANGE.
+	 *
+	 * @return number of registers read back, negative on error
+	 */
+	int		exchange(unsigned page, const void *out, unsigned out_count, void *in, unsigned in_count);
+
 protected:
 	/**
 	 * Does the PX4IO_serial instance initialization.
@@ -95,7 +103,15 @@ protected:
 	perf_counter_t		_pc_uerrs;
 	perf_counter_t		_pc_idle;
 	perf_counter_t		_pc_badidle;
+	perf_counter_t		_pc_link_bytes;
 private:
+	/**
+	 * Account the bytes of a completed transaction on the link.
+	 */
+	void		_count_bytes(size_t request_size);
+
+	uint64_t		_link_bytes{0};
+
 	/*
 	 * XXX tune this value
 	 *
@@ -53,11 +53,6 @@ RCInput::RCInput(bool run_as_task) :
 
 	// initialize it as RC lost
 	_rc_in.rc_lost = true;
-
-	// initialize raw_rc values and count
-	for (unsigned i = 0; i < input_rc_s::RC_INPUT_MAX_CHANNELS; i++) {
-		_raw_rc_values[i] = UINT16_MAX;
-	}
 }
 
 RCInput::~RCInput()
@@ -197,7 +192,7 @@ RCInput::cycle_trampoline(void *arg)
 
 void
 RCInput::fill_rc_in(uint16_t raw_rc_count_local,
-		    uint16_t raw_rc_values_local[input_rc_s::RC_INPUT_MAX_CHANNELS],
+		    const uint16_t raw_rc_values_local[input_rc_s::RC_INPUT_MAX_CHANNELS],
 		    hrt_abstime now, bool frame_drop, bool failsafe,
 		    unsigned frame_drops, int rssi = -1)
 {
@@ -216,9 +211,6 @@ RCInput::fill_rc_in(uint16_t raw_rc_count_local,
 		if (raw_rc_values_local[i] != UINT16_MAX) {
 			valid_chans++;
 		}
-
-		// once filled, reset values back to default
-		_raw_rc_values[i] = UINT16_MAX;
 	}
 
 	_rc_in.timestamp = now;
@@ -272,6 +264,86 @@ void RCInput::rc_io_invert(bool invert, uint32_t uxart_base)
 {
 	INVERT_RC_INPUT(invert, uxart_base);
 }
+
+void RCInput::configure_serial_port(RC_SCAN scan_state)
+{
+	switch (scan_state) {
+	case RC_SCAN_SBUS:
+		sbus_config(_rcs_fd, board_supports_single_wire(RC_UXART_BASE));
+		rc_io_invert(true, RC_UXART_BASE);
+		_rc_decoder.set_port_config(RCDecoder::PortConfig::SBUS);
+		break;
+
+	case RC_SCAN_SERIAL:
+		dsm_config(_rcs_fd);
+		rc_io_invert(false, RC_UXART_BASE);
+		_rc_decoder.set_port_config(RCDecoder::PortConfig::Serial);
+		break;
+
+	case RC_SCAN_CRSF:
+		crsf_config(_rcs_fd);
+		rc_io_invert(false, RC_UXART_BASE);
+		_rc_decoder.set_port_config(RCDecoder::PortConfig::CRSF);
+		break;
+
+	default:
+		break;
+	}
+}
+
+void RCInput::publish_frame(RCDecoder::Protocol protocol, const RCDecoder::Frame &frame, hrt_abstime now)
+{
+	switch (protocol) {
+	case RCDecoder::Protocol::SBUS:
+		_rc_in.input_source = input_rc_s::RC_INPUT_SOURCE_PX4FMU_SBUS;
+		break;
+
+	case RCDecoder::Protocol::DSM:
+		_rc_in.input_source = input_rc_s::RC_INPUT_SOURCE_PX4FMU_DSM;
+		break;
+
+	case RCDecoder::Protocol::ST24:
+		_rc_in.input_source = input_rc_s::RC_INPUT_SOURCE_PX4FMU_ST24;
+		break;
+
+	case RCDecoder::Protocol::SUMD:
+		_rc_in.input_source = input_rc_s::RC_INPUT_SOURCE_PX4FMU_SUMD;
+		break;
+
+	case RCDecoder::Protocol::CRSF:
+		_rc_in.input_source = input_rc_s::RC_INPUT_SOURCE_PX4FMU_CRSF;
+		break;
+
+	default:
+		return;
+	}
+
+	if (frame.rc_lost) {
+		// the ST24 keeps outputting RC channels and RSSI even if RC has been lost
+		_rc_in.rc_lost = true;
+		return;
+	}
+
+	fill_rc_in(frame.channel_count, frame.values, now, frame.frame_drop, frame.failsafe,
+		   frame.frame_drops, frame.rssi);
+
+	if (protocol == RCDecoder::Protocol::CRSF) {
+		// Enable CRSF Telemetry only on the Omnibus, because on Pixhawk (-related) boards
+		// we cannot write to the RC UART
+		// It might work on FMU-v5. Or another option is to use a different UART port
+#ifdef CONFIG_ARCH_BOARD_OMNIBUS_F4SD
+
+		if (!_rc_scan_locked && !_crsf_telemetry) {
+			_crsf_telemetry = new CRSFTelemetry(_rcs_fd);
+		}
+
+#endif /* CONFIG_ARCH_BOARD_OMNIBUS_F4SD */
+
+		if (_crsf_telemetry) {
+			_crsf_telemetry->update(now);
+		}
+	}
+}
 #endif
 
 void
@@ -371,10 +443,6 @@ RCInput::cycle()
 		// Scan for 300 msec, then switch protocol
 		constexpr hrt_abstime rc_scan_max = 300_ms;
 
-		bool sbus_failsafe, sbus_frame_drop;
-		unsigned frame_drops;
-		bool dsm_11_bit;
-
 		if (_report_lock && _rc_scan_locked) {
 			_report_lock = false;
 			//PX4_WARN("RCscan: %s RC input locked", RC_SCAN_STRING[_rc_scan_state]);
@@ -396,153 +464,31 @@ RCInput::cycle()
 
 		switch (_rc_scan_state) {
 		case RC_SCAN_SBUS:
+		case RC_SCAN_SERIAL:
+		case RC_SCAN_CRSF:
 			if (_rc_scan_begin == 0) {
 				_rc_scan_begin = cycle_timestamp;
-				// Configure serial port for SBUS
-				sbus_config(_rcs_fd, board_supports_single_wire(RC_UXART_BASE));
-				rc_io_invert(true, RC_UXART_BASE);
-
-			} else if (_rc_scan_locked
-				   || cycle_timestamp - _rc_scan_begin < rc_scan_max) {
-
-				// parse new data
-				if (newBytes > 0) {
-					rc_updated = sbus_parse(cycle_timestamp, &_rcs_buf[0], newBytes, &_raw_rc_values[0], &_raw_rc_count, &sbus_failsafe,
-								&sbus_frame_drop, &frame_drops, input_rc_s::RC_INPUT_MAX_CHANNELS);
-
-					if (rc_updated) {
-						// we have a new SBUS frame. Publish it.
-						_rc_in.input_source = input_rc_s::RC_INPUT_SOURCE_PX4FMU_SBUS;
-						fill_rc_in(_raw_rc_count, _raw_rc_values, cycle_timestamp,
-							   sbus_frame_drop, sbus_failsafe, frame_drops);
-						_rc_scan_locked = true;
-					}
-				}
-
-			} else {
-				// Scan the next protocol
-				set_rc_scan_state(RC_SCAN_DSM);
-			}
-
-			break;
-
-		case RC_SCAN_DSM:
-			if (_rc_scan_begin == 0) {
-				_rc_scan_begin = cycle_timestamp;
-				//			// Configure serial port for DSM
-				dsm_config(_rcs_fd);
-				rc_io_invert(false, RC_UXART_BASE);
-
-			} else if (_rc_scan_locked
-				   || cycle_timestamp - _rc_scan_begin < rc_scan_max) {
-
-				if (newBytes > 0) {
-					int8_t dsm_rssi;
-
-					// parse new data
-					rc_updated = dsm_parse(cycle_timestamp, &_rcs_buf[0], newBytes, &_raw_rc_values[0], &_raw_rc_count,
-							       &dsm_11_bit, &frame_drops, &dsm_rssi, input_rc_s::RC_INPUT_MAX_CHANNELS);
-
-					if (rc_updated) {
-						// we have a new DSM frame. Publish it.
-						_rc_in.input_source = input_rc_s::RC_INPUT_SOURCE_PX4FMU_DSM;
-						fill_rc_in(_raw_rc_count, _raw_rc_values, cycle_timestamp,
-							   false, false, frame_drops, dsm_rssi);
-						_rc_scan_locked = true;
-					}
-				}
-
-			} else {
-				// Scan the next protocol
-				set_rc_scan_state(RC_SCAN_ST24);
-			}
-
-			break;
-
-		case RC_SCAN_ST24:
-			if (_rc_scan_begin == 0) {
-				_rc_scan_begin = cycle_timestamp;
-				// Configure serial port for DSM
-				dsm_config(_rcs_fd);
-				rc_io_invert(false, RC_UXART_BASE);
-
-			} else if (_rc_scan_locked
-				   || cycle_timestamp - _rc_scan_begin < rc_scan_max) {
-
-				if (newBytes > 0) {
-					// parse new data
-					uint8_t st24_rssi, lost_count;
-
-					rc_updated = false;
-
-					for (unsigned i = 0; i < (unsigned)newBytes; i++) {
-						/* set updated flag if one complete packet was parsed */
-						st24_rssi = RC_INPUT_RSSI_MAX;
-						rc_updated = (OK == st24_decode(_rcs_buf[i], &st24_rssi, &lost_count,
-										&_raw_rc_count, _raw_rc_values, input_rc_s::RC_INPUT_MAX_CHANNELS));
-					}
-
-					// The st24 will keep outputting RC channels and RSSI even if RC has been lost.
-					// The only way to detect RC loss is therefore to look at the lost_count.
-
-					if (rc_updated) {
-						if (lost_count == 0) {
-							// we have a new ST24 frame. Publish it.
-							_rc_in.input_source = input_rc_s::RC_INPUT_SOURCE_PX4FMU_ST24;
-							fill_rc_in(_raw_rc_count, _raw_rc_values, cycle_timestamp,
-								   false, false, frame_drops, st24_rssi);
-							_rc_scan_locked = true;
-
-						} else {
-							// if the lost count > 0 means that there is an RC loss
-							_rc_in.rc_lost = true;
-						}
-					}
-				}
-
-			} else {
-				// Scan the next protocol
-				set_rc_scan_state(RC_SCAN_SUMD);
-			}
-
-			break;
-
-		case RC_SCAN_SUMD:
-			if (_rc_scan_begin == 0) {
-				_rc_scan_begin = cycle_timestamp;
-				// Configure serial port for DSM
-				dsm_config(_rcs_fd);
-				rc_io_invert(false, RC_UXART_BASE);
+				configure_serial_port(_rc_scan_state);
 
 			} else if (_rc_scan_locked
 				   || cycle_timestamp - _rc_scan_begin < rc_scan_max) {
 
+				// parse new data, all protocols sharing the port configuration are tried in parallel
 				if (newBytes > 0) {
-					// parse new data
-					uint8_t sumd_rssi, rx_count;
-					bool sumd_failsafe;
-
-					rc_updated = false;
+					RCDecoder::Frame frame;
+					const RCDecoder::Protocol protocol = _rc_decoder.parse(cycle_timestamp, &_rcs_buf[0], newBytes, frame);
 
-					for (unsigned i = 0; i < (unsigned)newBytes; i++) {
-						/* set updated flag if one complete packet was parsed */
-						sumd_rssi = RC_INPUT_RSSI_MAX;
-						rc_updated = (OK == sumd_decode(_rcs_buf[i], &sumd_rssi, &rx_count,
-										&_raw_rc_count, _raw_rc_values, input_rc_s::RC_INPUT_MAX_CHANNELS, &sumd_failsafe));
-					}
-
-					if (rc_updated) {
-						// we have a new SUMD frame. Publish it.
-						_rc_in.input_source = input_rc_s::RC_INPUT_SOURCE_PX4FMU_SUMD;
-						fill_rc_in(_raw_rc_count, _raw_rc_values, cycle_timestamp,
-							   false, sumd_failsafe, frame_drops, sumd_rssi);
+					if (protocol != RCDecoder::Protocol::None) {
+						rc_updated = true;
+						publish_frame(protocol, frame, cycle_timestamp);
 						_rc_scan_locked = true;
 					}
 				}
 
 			} else {
 				// Scan the next protocol
-				set_rc_scan_state(RC_SCAN_PPM);
+				set_rc_scan_state(_rc_scan_state == RC_SCAN_SBUS ? RC_SCAN_SERIAL :
+						  (_rc_scan_state == RC_SCAN_SERIAL ? RC_SCAN_PPM : RC_SCAN_SBUS));
 			}
 
 			break;
@@ -581,52 +527,6 @@ RCInput::cycle()
 
 #endif  // HRT_PPM_CHANNEL
 
-			break;
-
-		case RC_SCAN_CRSF:
-			if (_rc_scan_begin == 0) {
-				_rc_scan_begin = cycle_timestamp;
-				// Configure serial port for CRSF
-				crsf_config(_rcs_fd);
-				rc_io_invert(false, RC_UXART_BASE);
-
-			} else if (_rc_scan_locked
-				   || cycle_timestamp - _rc_scan_begin < rc_scan_max) {
-
-				// parse new data
-				if (newBytes > 0) {
-					rc_updated = crsf_parse(cycle_timestamp, &_rcs_buf[0], newBytes, &_raw_rc_values[0], &_raw_rc_count,
-								input_rc_s::RC_INPUT_MAX_CHANNELS);
-
-					if (rc_updated) {
-						// we have a new CRSF frame. Publish it.
-						_rc_in.input_source = input_rc_s::RC_INPUT_SOURCE_PX4FMU_CRSF;
-						fill_rc_in(_raw_rc_count, _raw_rc_values, cycle_timestamp, false, false, 0);
-
-						// Enable CRSF Telemetry only on the Omnibus, because on Pixhawk (-related) boards
-						// we cannot write to the RC UART
-						// It might work on FMU-v5. Or another option is to use a different UART port
-#ifdef CONFIG_ARCH_BOARD_OMNIBUS_F4SD
-
-						if (!_rc_scan_locked && !_crsf_telemetry) {
-							_crsf_telemetry = new CRSFTelemetry(_rcs_fd);
-						}
-
-#endif /* CONFIG_ARCH_BOARD_OMNIBUS_F4SD */
-
-						_rc_scan_locked = true;
-
-						if (_crsf_telemetry) {
-							_crsf_telemetry->update(cycle_timestamp);
-						}
-					}
-				}
-
-			} else {
-				// Scan the next protocol
-				set_rc_scan_state(RC_SCAN_SBUS);
-			}
-
 			break;
 		}
 
@@ -764,6 +664,8 @@ This module does the RC input parsing and auto-selecting the method. Supported m
 - ST24
 - TBS Crossfire (CRSF)
 
+DSM, ST24 and SUMD use the same serial port configuration and are detected in parallel on the same data.
+
 ### Implementation
 By default the module runs on the work queue, to reduce RAM usage. It can also be run in its own thread,
 specified via start flag -t, to reduce latency.
@@ -792,6 +694,7 @@ int RCInput::print_status()
 	}
 
 	PX4_INFO("RC scan state: %s, locked: %s", RC_SCAN_STRING[_rc_scan_state], _rc_scan_locked ? "yes" : "no");
+	_rc_decoder.print_status();
 	PX4_INFO("CRSF Telemetry: %s", _crsf_telemetry ? "yes" : "no");
 	PX4_INFO("SBUS frame drops: %u", sbus_dropped_frames());
 
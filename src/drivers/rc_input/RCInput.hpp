@@ -41,6 +41,7 @@
 #include <lib/perf/perf_counter.h>
 #include <lib/rc/crsf.h>
 #include <lib/rc/dsm.h>
+#include <lib/rc/rc_decoder.h>
 #include <lib/rc/sbus.h>
 #include <lib/rc/st24.h>
 #include <lib/rc/sumd.h>
@@ -95,18 +96,14 @@ private:
 	enum RC_SCAN {
 		RC_SCAN_PPM = 0,
 		RC_SCAN_SBUS,
-		RC_SCAN_DSM,
-		RC_SCAN_SUMD,
-		RC_SCAN_ST24,
+		RC_SCAN_SERIAL,		///< DSM, ST24 and SUMD, decoded in parallel
 		RC_SCAN_CRSF
 	} _rc_scan_state{RC_SCAN_SBUS};
 
-	static constexpr char const *RC_SCAN_STRING[6] {
+	static constexpr char const *RC_SCAN_STRING[4] {
 		"PPM",
 		"SBUS",
-		"DSM",
-		"SUMD",
-		"ST24",
+		"DSM/ST24/SUMD",
 		"CRSF"
 	};
 
@@ -135,8 +132,8 @@ private:
 
 	uint8_t _rcs_buf[SBUS_BUFFER_SIZE] {};
 
-	uint16_t _raw_rc_values[input_rc_s::RC_INPUT_MAX_CHANNELS] {};
-	uint16_t _raw_rc_count{};
+	RCDecoder _rc_decoder;
+	static_assert(RCDecoder::MAX_CHANNELS == input_rc_s::RC_INPUT_MAX_CHANNELS, "RC channel count mismatch");
 
 	CRSFTelemetry *_crsf_telemetry{nullptr};
 
@@ -147,7 +144,7 @@ private:
 	int 		start();
 
 	void fill_rc_in(uint16_t raw_rc_count_local,
-			uint16_t raw_rc_values_local[input_rc_s::RC_INPUT_MAX_CHANNELS],
+			const uint16_t raw_rc_values_local[input_rc_s::RC_INPUT_MAX_CHANNELS],
 			hrt_abstime now, bool frame_drop, bool failsafe,
 			unsigned frame_drops, int rssi);
 
@@ -155,4 +152,9 @@ private:
 
 	void rc_io_invert(bool invert, uint32_t uxart_base);
 
+	/** configure the serial port and the decoder for one of the serial scan states */
+	void configure_serial_port(RC_SCAN scan_state);
+
+	void publish_frame(RCDecoder::Protocol protocol, const RCDecoder::Frame &frame, hrt_abstime now);
+
 };
@@ -43,6 +43,7 @@
 #include <cmath>	// NAN
 #include <cstring>
 
+#include <lib/actuator_latency/actuator_latency.h>
 #include <lib/mathlib/mathlib.h>
 #include <lib/cdev/CDev.hpp>
 #include <perf/perf_counter.h>
@@ -121,6 +122,7 @@ private:
 	actuator_armed_s	_armed = {};
 
 	perf_counter_t	_perf_control_latency;
+	ActuatorLatency	_latency;
 
 	int			_control_subs[actuator_controls_s::NUM_ACTUATOR_CONTROL_GROUPS];
 	actuator_controls_s 	_controls[actuator_controls_s::NUM_ACTUATOR_CONTROL_GROUPS];
@@ -447,6 +449,7 @@ void TAP_ESC::cycle()
 		}
 
 		uint8_t num_outputs = _channels_count;
+		hrt_abstime mixed = 0;
 
 		/* can we mix? */
 		if (_is_armed && _mixers != nullptr) {
@@ -454,6 +457,7 @@ void TAP_ESC::cycle()
 			/* do mixing */
 			num_outputs = _mixers->mix(&_outputs.output[0], num_outputs);
 			_outputs.noutputs = num_outputs;
+			mixed = hrt_absolute_time();
 
 			/* publish mixer status */
 			multirotor_motor_limits_s multirotor_motor_limits = {};
@@ -555,6 +559,7 @@ void TAP_ESC::cycle()
 		_outputs.timestamp = hrt_absolute_time();
 
 		send_esc_outputs(motor_out, num_outputs);
+		const hrt_abstime written = hrt_absolute_time();
 		tap_esc_common::read_data_from_uart(_uart_fd, &_uartbuf);
 
 		if (!tap_esc_common::parse_tap_esc_feedback(&_uartbuf, &_packet)) {
@@ -586,6 +591,11 @@ void TAP_ESC::cycle()
 
 			if (required && (timestamp_sample > 0)) {
 				perf_set_elapsed(_perf_control_latency, _outputs.timestamp - timestamp_sample);
+
+				if (mixed > 0) {
+					_latency.update(_controls[i], mixed, written);
+				}
+
 				break;
 			}
 		}
@@ -83,13 +83,13 @@ int UavcanEscController::init()
 	return res;
 }
 
-void UavcanEscController::update_outputs(float *outputs, unsigned num_outputs)
+bool UavcanEscController::update_outputs(float *outputs, unsigned num_outputs)
 {
 	if ((outputs == nullptr) ||
 	    (num_outputs > uavcan::equipment::esc::RawCommand::FieldTypes::cmd::MaxSize) ||
 	    (num_outputs > esc_status_s::CONNECTED_ESC_MAX)) {
 		perf_count(_perfcnt_invalid_input);
-		return;
+		return false;
 	}
 
 	/*
@@ -98,7 +98,7 @@ void UavcanEscController::update_outputs(float *outputs, unsigned num_outputs)
 	const auto timestamp = _node.getMonotonicTime();
 
 	if ((timestamp - _prev_cmd_pub).toUSec() < (1000000 / MAX_RATE_HZ)) {
-		return;
+		return false;
 	}
 
 	_prev_cmd_pub = timestamp;
@@ -109,7 +109,8 @@ void UavcanEscController::update_outputs(float *outputs, unsigned num_outputs)
 	 */
 	uavcan::equipment::esc::RawCommand msg;
 
-	actuator_outputs_s actuator_outputs = {};
+	actuator_outputs_s &actuator_outputs = _actuator_outputs;
+	actuator_outputs = {};
 	actuator_outputs.noutputs = num_outputs;
 	actuator_outputs.timestamp = hrt_absolute_time();
 
@@ -167,16 +168,28 @@ void UavcanEscController::update_outputs(float *outputs, unsigned num_outputs)
 	 */
 	(void)_uavcan_pub_raw_cmd.broadcast(msg);
 
+	_actuator_outputs_pending = true;
+
+	return true;
+}
+
+void UavcanEscController::publish_outputs()
+{
+	if (!_actuator_outputs_pending) {
+		return;
+	}
+
+	_actuator_outputs_pending = false;
+
 	// Publish actuator outputs
 	if (_actuator_outputs_pub != nullptr) {
-		orb_publish(ORB_ID(actuator_outputs), _actuator_outputs_pub, &actuator_outputs);
+		orb_publish(ORB_ID(actuator_outputs), _actuator_outputs_pub, &_actuator_outputs);
 
 	} else {
 		int instance;
-		_actuator_outputs_pub = orb_advertise_multi(ORB_ID(actuator_outputs), &actuator_outputs,
+		_actuator_outputs_pub = orb_advertise_multi(ORB_ID(actuator_outputs), &_actuator_outputs,
 					&instance, ORB_PRIO_DEFAULT);
 	}
-
 }
 
 void UavcanEscController::arm_all_escs(bool arm)
@@ -60,7 +60,20 @@ public:
 
 	int init();
 
-	void update_outputs(float *outputs, unsigned num_outputs);
+	/**
+	 * Broadcast the ESC command, rate limited to MAX_RATE_HZ.
+	 *
+	 * Only the command goes out here, the matching actuator_outputs are published
+	 * by publish_outputs() so that this stays cheap for the caller.
+	 *
+	 * @return true if the command was handed to the CAN driver
+	 */
+	bool update_outputs(float *outputs, unsigned num_outputs);
+
+	/**
+	 * Publish the actuator outputs of the last command sent, if any.
+	 */
+	void publish_outputs();
 
 	void arm_all_escs(bool arm);
 	void arm_single_esc(int num, bool arm);
@@ -95,6 +108,8 @@ private:
 	esc_status_s	_esc_status = {};
 	orb_advert_t	_esc_status_pub = nullptr;
 	orb_advert_t _actuator_outputs_pub = nullptr;
+	actuator_outputs_s	_actuator_outputs = {};
+	bool		_actuator_outputs_pending = false;
 
 	/*
 	 * libuavcan related things
@@ -55,6 +55,7 @@
 #include <arch/board/board.h>
 #include <arch/chip/chip.h>
 
+#include <uORB/uORBManager.hpp>
 #include <uORB/topics/esc_status.h>
 #include <uORB/topics/parameter_update.h>
 
@@ -86,6 +87,9 @@ UavcanNode::UavcanNode(uavcan::ICanDriver &can_driver, uavcan::ISystemClock &sys
 	_time_sync_slave(_node),
 	_node_status_monitor(_node),
 	_perf_control_latency(perf_alloc(PC_ELAPSED, "uavcan control latency")),
+	_perf_esc_latency(perf_alloc(PC_ELAPSED, "uavcan esc cmd latency")),
+	_perf_esc_direct(perf_alloc(PC_COUNT, "uavcan esc cmd direct")),
+	_perf_esc_polled(perf_alloc(PC_COUNT, "uavcan esc cmd polled")),
 	_master_timer(_node),
 	_setget_response(0)
 {
@@ -100,6 +104,7 @@ UavcanNode::UavcanNode(uavcan::ICanDriver &can_driver, uavcan::ISystemClock &sys
 
 	for (int i = 0; i < NUM_ACTUATOR_CONTROL_GROUPS_UAVCAN; ++i) {
 		_control_subs[i] = -1;
+		_control_callbacks[i].init(this, i);
 	}
 
 	int res = pthread_mutex_init(&_node_mutex, nullptr);
@@ -167,6 +172,9 @@ UavcanNode::~UavcanNode()
 	}
 
 	perf_free(_perf_control_latency);
+	perf_free(_perf_esc_latency);
+	perf_free(_perf_esc_direct);
+	perf_free(_perf_esc_polled);
 }
 
 int UavcanNode::getHardwareVersion(uavcan::protocol::HardwareVersion &hwver)
@@ -875,8 +883,12 @@ int UavcanNode::run()
 			for (unsigned i = 0; i < actuator_controls_s::NUM_ACTUATOR_CONTROL_GROUPS; i++) {
 				if (_control_subs[i] >= 0) {
 					if (_poll_fds[_poll_ids[i]].revents & POLLIN) {
-						controls_updated = true;
 						orb_copy(_control_topics[i], _control_subs[i], &_controls[i]);
+
+						// already mixed and sent from the publication callback
+						if (_controls[i].timestamp != _direct_timestamp[i]) {
+							controls_updated = true;
+						}
 					}
 				}
 			}
@@ -910,58 +922,22 @@ int UavcanNode::run()
 				new_output = true;
 
 			} else if (controls_updated && (_mixers != nullptr)) {
-
-				// XXX one output group has 8 outputs max,
-				// but this driver could well serve multiple groups.
-				unsigned num_outputs_max = 8;
-
-				_mixers->set_airmode(_airmode);
-
-				// Do mixing
-				_outputs.noutputs = _mixers->mix(&_outputs.output[0], num_outputs_max);
-
-				new_output = true;
+				if (mix_and_output()) {
+					perf_count(_perf_esc_polled);
+				}
 			}
 		}
 
 		if (new_output) {
-			// iterate actuators, checking for valid values
-			for (uint8_t i = 0; i < _outputs.noutputs; i++) {
-				// last resort: catch NaN, INF and out-of-band errors
-				if (!isfinite(_outputs.output[i])) {
-					/*
-					 * Value is NaN, INF or out of band - set to the minimum value.
-					 * This will be clearly visible on the servo status and will limit the risk of accidentally
-					 * spinning motors. It would be deadly in flight.
-					 */
-					_outputs.output[i] = -1.0f;
-				}
-
-				// never go below min
-				if (_outputs.output[i] < -1.0f) {
-					_outputs.output[i] = -1.0f;
-				}
-
-				// never go above max
-				if (_outputs.output[i] > 1.0f) {
-					_outputs.output[i] = 1.0f;
-				}
-			}
-
-			// Output to the bus
-			_esc_controller.update_outputs(_outputs.output, _outputs.noutputs);
-			_outputs.timestamp = hrt_absolute_time();
+			output();
+		}
 
-			// use first valid timestamp_sample for latency tracking
-			for (int i = 0; i < actuator_controls_s::NUM_ACTUATOR_CONTROL_GROUPS; i++) {
-				const bool required = _groups_required & (1 << i);
-				const hrt_abstime &timestamp_sample = _controls[i].timestamp_sample;
+		// telemetry is published here, off the path from the controls to the bus
+		_esc_controller.publish_outputs();
 
-				if (required && (timestamp_sample > 0)) {
-					perf_set_elapsed(_perf_control_latency, _outputs.timestamp - timestamp_sample);
-					break;
-				}
-			}
+		if (_latency_written != 0) {
+			_latency.update(_latency_controls, _latency_mixed, _latency_written);
+			_latency_written = 0;
 		}
 
 
@@ -1007,6 +983,105 @@ int UavcanNode::run()
 	exit(0);
 }
 
+void
+UavcanNode::controls_published(uint8_t group, const actuator_controls_s &controls)
+{
+	// never block the publisher, the node thread picks the update up after its poll wakeup instead
+	if (pthread_mutex_trylock(&_node_mutex) != 0) {
+		return;
+	}
+
+	if (group < NUM_ACTUATOR_CONTROL_GROUPS_UAVCAN && _control_subs[group] >= 0 &&
+	    !_test_in_progress && (_mixers != nullptr)) {
+		_controls[group] = controls;
+		_direct_timestamp[group] = controls.timestamp;
+
+		if (mix_and_output()) {
+			perf_count(_perf_esc_direct);
+		}
+	}
+
+	(void)pthread_mutex_unlock(&_node_mutex);
+}
+
+bool
+UavcanNode::mix_and_output()
+{
+	// XXX one output group has 8 outputs max,
+	// but this driver could well serve multiple groups.
+	unsigned num_outputs_max = 8;
+
+	_mixers->set_airmode(_airmode);
+
+	// Do mixing
+	_outputs.noutputs = _mixers->mix(&_outputs.output[0], num_outputs_max);
+
+	const hrt_abstime mixed = hrt_absolute_time();
+
+	if (!output()) {
+		return false;
+	}
+
+	// latency from the controls publication to the frames queued in the CAN driver,
+	// the statistics are published later by the node thread
+	for (int i = 0; i < actuator_controls_s::NUM_ACTUATOR_CONTROL_GROUPS; i++) {
+		if ((_groups_required & (1 << i)) && (_controls[i].timestamp > 0)) {
+			perf_set_elapsed(_perf_esc_latency, _outputs.timestamp - _controls[i].timestamp);
+
+			_latency_controls = _controls[i];
+			_latency_mixed = mixed;
+			_latency_written = _outputs.timestamp;
+			break;
+		}
+	}
+
+	return true;
+}
+
+bool
+UavcanNode::output()
+{
+	// iterate actuators, checking for valid values
+	for (uint8_t i = 0; i < _outputs.noutputs; i++) {
+		// last resort: catch NaN, INF and out-of-band errors
+		if (!isfinite(_outputs.output[i])) {
+			/*
+			 * Value is NaN, INF or out of band - set to the minimum value.
+			 * This will be clearly visible on the servo status and will limit the risk of accidentally
+			 * spinning motors. It would be deadly in flight.
+			 */
+			_outputs.output[i] = -1.0f;
+		}
+
+		// never go below min
+		if (_outputs.output[i] < -1.0f) {
+			_outputs.output[i] = -1.0f;
+		}
+
+		// never go above max
+		if (_outputs.output[i] > 1.0f) {
+			_outputs.output[i] = 1.0f;
+		}
+	}
+
+	// Output to the bus
+	const bool sent = _esc_controller.update_outputs(_outputs.output, _outputs.noutputs);
+	_outputs.timestamp = hrt_absolute_time();
+
+	// use first valid timestamp_sample for latency tracking
+	for (int i = 0; i < actuator_controls_s::NUM_ACTUATOR_CONTROL_GROUPS; i++) {
+		const bool required = _groups_required & (1 << i);
+		const hrt_abstime &timestamp_sample = _controls[i].timestamp_sample;
+
+		if (required && (timestamp_sample > 0)) {
+			perf_set_elapsed(_perf_control_latency, _outputs.timestamp - timestamp_sample);
+			break;
+		}
+	}
+
+	return sent;
+}
+
 int
 UavcanNode::control_callback(uintptr_t handle, uint8_t control_group, uint8_t control_index, float &input)
 {
@@ -1023,6 +1098,8 @@ UavcanNode::teardown()
 
 	for (unsigned i = 0; i < actuator_controls_s::NUM_ACTUATOR_CONTROL_GROUPS; i++) {
 		if (_control_subs[i] >= 0) {
+			// returns once no publisher runs the callback anymore, so the node can be deleted
+			uORB::Manager::get_instance()->unregister_callback(_control_topics[i], 0, &_control_callbacks[i]);
 			orb_unsubscribe(_control_subs[i]);
 			_control_subs[i] = -1;
 		}
@@ -1051,10 +1128,16 @@ UavcanNode::subscribe()
 		if (sub_groups & (1 << i)) {
 			PX4_DEBUG("subscribe to actuator_controls_%d", i);
 			_control_subs[i] = orb_subscribe(_control_topics[i]);
+
+			// the subscription created the topic node, so the callback can attach to it
+			if ((_control_subs[i] >= 0) && (CallbackGroups & (1 << i))) {
+				uORB::Manager::get_instance()->register_callback(_control_topics[i], 0, &_control_callbacks[i]);
+			}
 		}
 
 		if (unsub_groups & (1 << i)) {
 			PX4_DEBUG("unsubscribe from actuator_controls_%d", i);
+			uORB::Manager::get_instance()->unregister_callback(_control_topics[i], 0, &_control_callbacks[i]);
 			orb_unsubscribe(_control_subs[i]);
 			_control_subs[i] = -1;
 		}
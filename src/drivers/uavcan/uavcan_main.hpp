@@ -54,7 +54,9 @@
 #include <uavcan/protocol/RestartNode.hpp>
 
 #include <drivers/device/device.h>
+#include <lib/actuator_latency/actuator_latency.h>
 #include <perf/perf_counter.h>
+#include <uORB/uORBDeviceNode.hpp>
 
 #include <uORB/topics/actuator_controls.h>
 #include <uORB/topics/actuator_outputs.h>
@@ -102,6 +104,13 @@ class UavcanNode : public cdev::CDev
 	static constexpr unsigned RxQueueLenPerIface	= FramePerMSecond * PollTimeoutMs; // At
 	static constexpr unsigned StackSize		= 2400;
 
+	/*
+	 * Control groups sent straight from the publication callback. Their publishers reserve
+	 * ACTUATOR_CONTROLS_CALLBACK_ADDED_STACK for it, all other groups go through the poll path.
+	 */
+	static constexpr uint32_t CallbackGroups	= (1 << 0) | (1 << 1);
+	static_assert(ACTUATOR_CONTROLS_CALLBACK_ADDED_STACK > 0, "BOARD_HAS_UAVCAN must be defined when building uavcan");
+
 public:
 	typedef UAVCAN_DRIVER::CanInitHelper<RxQueueLenPerIface> CanInitHelper;
 	enum eServerAction {None, Start, Stop, CheckFW, Busy};
@@ -153,6 +162,9 @@ private:
 	int		print_params(uavcan::protocol::param::GetSet::Response &resp);
 	int		get_set_param(int nodeid, const char *name, uavcan::protocol::param::GetSet::Request &req);
 	void 		update_params();
+	void		controls_published(uint8_t group, const actuator_controls_s &controls);
+	bool		mix_and_output();
+	bool		output();
 	void		set_setget_response(uavcan::protocol::param::GetSet::Response *resp)
 	{
 		_setget_response = resp;
@@ -209,6 +221,36 @@ private:
 	actuator_outputs_s		_outputs = {};
 
 	perf_counter_t			_perf_control_latency;
+	perf_counter_t			_perf_esc_latency;
+	perf_counter_t			_perf_esc_direct;		///< commands sent from the publication callback
+	perf_counter_t			_perf_esc_polled;		///< commands sent by the node thread after a poll wakeup
+
+	/*
+	 * Sends the ESC command straight from the actuator_controls publication, in the
+	 * publisher's context. If the node thread holds the mutex the update is left to it.
+	 */
+	class ControlsCallback : public uORB::PublicationCallback
+	{
+	public:
+		void init(UavcanNode *node, uint8_t group) { _node = node; _group = group; }
+
+		void published(const void *data) override
+		{
+			_node->controls_published(_group, *static_cast<const actuator_controls_s *>(data));
+		}
+
+	private:
+		UavcanNode	*_node{nullptr};
+		uint8_t		_group{0};
+	};
+
+	ControlsCallback		_control_callbacks[NUM_ACTUATOR_CONTROL_GROUPS_UAVCAN];
+	hrt_abstime			_direct_timestamp[NUM_ACTUATOR_CONTROL_GROUPS_UAVCAN] = {}; ///< controls already sent by the callback
+
+	ActuatorLatency			_latency;
+	actuator_controls_s		_latency_controls = {};		///< controls of the last command sent, traced by the node thread
+	hrt_abstime			_latency_mixed = 0;
+	hrt_abstime			_latency_written = 0;
 
 	Mixer::Airmode 			_airmode = Mixer::Airmode::disabled;
 
@@ -424,7 +424,7 @@ int rover_steering_control_main(int argc, char *argv[])
 		deamon_task = px4_task_spawn_cmd("rover_steering_control",
 						 SCHED_DEFAULT,
 						 SCHED_PRIORITY_MAX - 20,
-						 2048,
+						 2048 + ACTUATOR_CONTROLS_CALLBACK_ADDED_STACK,
 						 rover_steering_control_thread_main,
 						 (argv) ? (char *const *)&argv[2] : (char *const *)nullptr);
 		thread_running = true;
@@ -0,0 +1,115 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2018 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+/**
+ * @file actuator_latency.cpp
+ */
+
+#include "actuator_latency.h"
+
+#include <string.h>
+
+ActuatorLatency::~ActuatorLatency()
+{
+	if (_latency_pub != nullptr) {
+		orb_unadvertise(_latency_pub);
+	}
+}
+
+void ActuatorLatency::record(uint8_t stage, hrt_abstime latency)
+{
+	// power of two buckets starting at 128 us
+	uint8_t bucket = 0;
+	hrt_abstime limit = 128;
+
+	while (latency >= limit && bucket < actuator_latency_s::HISTOGRAM_BUCKETS - 1) {
+		limit <<= 1;
+		bucket++;
+	}
+
+	const uint32_t value = (latency < UINT32_MAX) ? latency : UINT32_MAX;
+
+	_latency.latency[stage] = value;
+
+	if (value > _latency.latency_max[stage]) {
+		_latency.latency_max[stage] = value;
+	}
+
+	uint16_t &count = _latency.histogram[stage * actuator_latency_s::HISTOGRAM_BUCKETS + bucket];
+
+	if (count < UINT16_MAX) {
+		count++;
+	}
+}
+
+hrt_abstime ActuatorLatency::update(const actuator_controls_s &controls, hrt_abstime mixed, hrt_abstime written)
+{
+	// ignore controls without (or with an inconsistent) sample timestamp
+	if (controls.timestamp_sample == 0 || controls.timestamp < controls.timestamp_sample
+	    || mixed < controls.timestamp || written < mixed) {
+		return 0;
+	}
+
+	// the controller stage starts when the estimate it used was published, or at the sensor sample
+	// if the controller runs on it directly (no estimator latency)
+	const hrt_abstime estimated = controls.timestamp_sample + controls.estimator_latency;
+
+	if (estimated <= controls.timestamp) {
+		if (controls.estimator_latency > 0) {
+			record(actuator_latency_s::STAGE_ESTIMATOR, controls.estimator_latency);
+		}
+
+		record(actuator_latency_s::STAGE_CONTROLLER, controls.timestamp - estimated);
+	}
+
+	record(actuator_latency_s::STAGE_MIXER, mixed - controls.timestamp);
+	record(actuator_latency_s::STAGE_OUTPUT, written - mixed);
+	record(actuator_latency_s::STAGE_TOTAL, written - controls.timestamp_sample);
+
+	if (_latency.samples < UINT16_MAX) {
+		_latency.samples++;
+	}
+
+	if (written >= _latency.timestamp + PUBLISH_INTERVAL) {
+		_latency.timestamp = written;
+		orb_publish_auto(ORB_ID(actuator_latency), &_latency_pub, &_latency, &_latency_instance, ORB_PRIO_DEFAULT);
+
+		// start a new accumulation period, keep the last latencies
+		_latency.samples = 0;
+		memset(_latency.latency_max, 0, sizeof(_latency.latency_max));
+		memset(_latency.histogram, 0, sizeof(_latency.histogram));
+	}
+
+	return written - controls.timestamp_sample;
+}
@@ -0,0 +1,77 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2018 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+/**
+ * @file actuator_latency.h
+ *
+ * Latency tracing of the actuator output pipeline for the output drivers.
+ */
+
+#pragma once
+
+#include <drivers/drv_hrt.h>
+#include <uORB/uORB.h>
+#include <uORB/topics/actuator_controls.h>
+#include <uORB/topics/actuator_latency.h>
+
+
+class ActuatorLatency
+{
+public:
+	ActuatorLatency() = default;
+	~ActuatorLatency();
+
+	ActuatorLatency(const ActuatorLatency &) = delete;
+	ActuatorLatency &operator=(const ActuatorLatency &) = delete;
+
+	/**
+	 * Record one output update and publish the accumulated statistics
+	 * at most every PUBLISH_INTERVAL.
+	 *
+	 * @param controls: actuator controls the outputs were computed from
+	 * @param mixed: time the mixing finished
+	 * @param written: time the outputs were written to the hardware
+	 * @return total latency from sensor sample to output write, 0 if the controls carry no sample timestamp
+	 */
+	hrt_abstime update(const actuator_controls_s &controls, hrt_abstime mixed, hrt_abstime written);
+
+private:
+	static constexpr hrt_abstime PUBLISH_INTERVAL = 100000; ///< us
+
+	void record(uint8_t stage, hrt_abstime latency);
+
+	actuator_latency_s _latency{};
+	orb_advert_t _latency_pub{nullptr};
+	int _latency_instance{0};
+};
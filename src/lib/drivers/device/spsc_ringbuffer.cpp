@@ -0,0 +1,199 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2018 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file spsc_ringbuffer.cpp
+ *
+ * Lock-free ringbuffer for exactly one producer and one consumer.
+ */
+
+#include "spsc_ringbuffer.h"
+#include <string.h>
+
+namespace ringbuffer
+{
+
+SPSCRingBuffer::SPSCRingBuffer(unsigned num_items, size_t item_size) :
+	_num_items(num_items),
+	_slots(num_items + 1),
+	_item_size(item_size),
+	_buf(new char[_slots * item_size])
+{}
+
+SPSCRingBuffer::~SPSCRingBuffer()
+{
+	if (_buf != nullptr) {
+		delete[] _buf;
+	}
+}
+
+unsigned
+SPSCRingBuffer::_free(unsigned head, unsigned tail) const
+{
+	return (tail > head) ? (tail - head - 1) : (_slots - (head - tail) - 1);
+}
+
+bool
+SPSCRingBuffer::put(const void *val, size_t val_size)
+{
+	if ((val_size == 0) || (val_size > _item_size)) {
+		val_size = _item_size;
+	}
+
+	const unsigned head = __atomic_load_n(&_head, __ATOMIC_RELAXED);
+	const unsigned tail = __atomic_load_n(&_tail, __ATOMIC_ACQUIRE);
+
+	if (_free(head, tail) == 0) {
+		return false;
+	}
+
+	memcpy(&_buf[head * _item_size], val, val_size);
+
+	/* hand over the item */
+	__atomic_store_n(&_head, (head + 1 == _slots) ? 0 : head + 1, __ATOMIC_RELEASE);
+	return true;
+}
+
+unsigned
+SPSCRingBuffer::put_n(const void *vals, unsigned n)
+{
+	const unsigned head = __atomic_load_n(&_head, __ATOMIC_RELAXED);
+	const unsigned tail = __atomic_load_n(&_tail, __ATOMIC_ACQUIRE);
+	const unsigned space = _free(head, tail);
+
+	if (n > space) {
+		n = space;
+	}
+
+	if (n == 0) {
+		return 0;
+	}
+
+	/* copy up to the end of the buffer, then the rest from the start */
+	const unsigned first = (n < _slots - head) ? n : (_slots - head);
+	const char *src = static_cast<const char *>(vals);
+
+	memcpy(&_buf[head * _item_size], src, first * _item_size);
+
+	if (n > first) {
+		memcpy(&_buf[0], src + first * _item_size, (n - first) * _item_size);
+	}
+
+	__atomic_store_n(&_head, (head + n) % _slots, __ATOMIC_RELEASE);
+	return n;
+}
+
+bool
+SPSCRingBuffer::get(void *val, size_t val_size)
+{
+	if ((val_size == 0) || (val_size > _item_size)) {
+		val_size = _item_size;
+	}
+
+	const unsigned tail = __atomic_load_n(&_tail, __ATOMIC_RELAXED);
+	const unsigned head = __atomic_load_n(&_head, __ATOMIC_ACQUIRE);
+
+	if (head == tail) {
+		return false;
+	}
+
+	if (val != nullptr) {
+		memcpy(val, &_buf[tail * _item_size], val_size);
+	}
+
+	/* release the slot only after the item was copied out */
+	__atomic_store_n(&_tail, (tail + 1 == _slots) ? 0 : tail + 1, __ATOMIC_RELEASE);
+	return true;
+}
+
+unsigned
+SPSCRingBuffer::get_n(void *vals, unsigned n)
+{
+	const unsigned tail = __atomic_load_n(&_tail, __ATOMIC_RELAXED);
+	const unsigned head = __atomic_load_n(&_head, __ATOMIC_ACQUIRE);
+	const unsigned available = _num_items - _free(head, tail);
+
+	if (n > available) {
+		n = available;
+	}
+
+	if (n == 0) {
+		return 0;
+	}
+
+	if (vals != nullptr) {
+		const unsigned first = (n < _slots - tail) ? n : (_slots - tail);
+		char *dst = static_cast<char *>(vals);
+
+		memcpy(dst, &_buf[tail * _item_size], first * _item_size);
+
+		if (n > first) {
+			memcpy(dst + first * _item_size, &_buf[0], (n - first) * _item_size);
+		}
+	}
+
+	__atomic_store_n(&_tail, (tail + n) % _slots, __ATOMIC_RELEASE);
+	return n;
+}
+
+unsigned
+SPSCRingBuffer::space()
+{
+	return _free(__atomic_load_n(&_head, __ATOMIC_ACQUIRE), __atomic_load_n(&_tail, __ATOMIC_ACQUIRE));
+}
+
+unsigned
+SPSCRingBuffer::count()
+{
+	return _num_items - space();
+}
+
+void
+SPSCRingBuffer::flush()
+{
+	get_n(nullptr, _num_items);
+}
+
+void
+SPSCRingBuffer::print_info(const char *name)
+{
+	printf("%s	%u/%lu (%u/%u @ %p)\n",
+	       name,
+	       _num_items,
+	       (unsigned long)_num_items * _item_size,
+	       __atomic_load_n(&_head, __ATOMIC_RELAXED),
+	       __atomic_load_n(&_tail, __ATOMIC_RELAXED),
+	       _buf);
+}
+
+} // namespace ringbuffer
@@ -0,0 +1,148 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2018 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file spsc_ringbuffer.h
+ *
+ * Lock-free ringbuffer for exactly one producer and one consumer.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+namespace ringbuffer __EXPORT
+{
+
+/**
+ * Ringbuffer for a single producer and a single consumer, which may run
+ * concurrently on different cores without any locking.
+ *
+ * The head index is only written by the producer and the tail index only
+ * by the consumer. Publishing an index uses release ordering and reading
+ * the other side's index acquire ordering, so the item data is visible
+ * before the index that hands it over.
+ *
+ * Unlike RingBuffer there is no force(): discarding old items from the
+ * producer side would make it a second consumer.
+ */
+class SPSCRingBuffer
+{
+public:
+	SPSCRingBuffer(unsigned num_items, size_t item_size);
+	~SPSCRingBuffer();
+
+	/**
+	 * Put an item into the buffer. Producer side only.
+	 *
+	 * @param val		Item to put
+	 * @return		true if the item was put, false if the buffer is full
+	 */
+	bool			put(const void *val, size_t val_size = 0);
+
+	/**
+	 * Put up to n items into the buffer with at most two copies. Producer side only.
+	 *
+	 * @param vals		Array of n items of the item size
+	 * @param n		Number of items to put
+	 * @return		The number of items put, less than n if the buffer became full
+	 */
+	unsigned		put_n(const void *vals, unsigned n);
+
+	/**
+	 * Get an item from the buffer. Consumer side only.
+	 *
+	 * @param val		Item that was gotten, nullptr to discard it
+	 * @return		true if an item was got, false if the buffer was empty.
+	 */
+	bool			get(void *val, size_t val_size = 0);
+
+	/**
+	 * Get up to n items from the buffer with at most two copies. Consumer side only.
+	 *
+	 * @param vals		Array for n items of the item size, nullptr to discard them
+	 * @param n		Maximum number of items to get
+	 * @return		The number of items got
+	 */
+	unsigned		get_n(void *vals, unsigned n);
+
+	/*
+	 * Get the number of slots free in the buffer. Exact on the producer side,
+	 * a lower bound on the consumer side.
+	 */
+	unsigned		space();
+
+	/*
+	 * Get the number of items in the buffer. Exact on the consumer side,
+	 * a lower bound on the producer side.
+	 */
+	unsigned		count();
+
+	bool			empty() { return count() == 0; }
+	bool			full() { return space() == 0; }
+
+	/*
+	 * Returns the capacity of the buffer, or zero if the buffer could
+	 * not be allocated.
+	 */
+	unsigned		size() { return (_buf != nullptr) ? _num_items : 0; }
+
+	/*
+	 * Empties the buffer. Consumer side only.
+	 */
+	void			flush();
+
+	/*
+	 * printf() some info on the buffer
+	 */
+	void			print_info(const char *name);
+
+private:
+	const unsigned		_num_items;
+	const unsigned		_slots;		/**< _num_items + 1, one slot is always kept free */
+	const size_t		_item_size;
+	char			*_buf;
+
+	unsigned		_head{0};	/**< insertion point, written by the producer */
+	unsigned		_tail{0};	/**< removal point, written by the consumer */
+
+	unsigned		_free(unsigned head, unsigned tail) const;
+
+	/* we don't want this class to be copied */
+	SPSCRingBuffer(const SPSCRingBuffer &);
+	SPSCRingBuffer operator=(const SPSCRingBuffer &);
+};
+
+} // namespace ringbuffer
@@ -0,0 +1,89 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2018 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file FilterBank.cpp
+ */
+
+#include "FilterBank.hpp"
+
+namespace math
+{
+
+BiquadCoefficients BiquadCoefficients::lowpass2p(float sample_freq, float cutoff_freq)
+{
+	BiquadCoefficients coeffs;
+
+	if (cutoff_freq <= 0.0f || sample_freq <= 0.0f) {
+		// no filtering
+		return coeffs;
+	}
+
+	const float fr = sample_freq / cutoff_freq;
+	const float ohm = tanf(M_PI_F / fr);
+	const float c = 1.0f + 2.0f * cosf(M_PI_F / 4.0f) * ohm + ohm * ohm;
+
+	coeffs.b0 = ohm * ohm / c;
+	coeffs.b1 = 2.0f * coeffs.b0;
+	coeffs.b2 = coeffs.b0;
+
+	coeffs.a1 = 2.0f * (ohm * ohm - 1.0f) / c;
+	coeffs.a2 = (1.0f - 2.0f * cosf(M_PI_F / 4.0f) * ohm + ohm * ohm) / c;
+
+	return coeffs;
+}
+
+BiquadCoefficients BiquadCoefficients::notch(float sample_freq, float notch_freq, float bandwidth)
+{
+	BiquadCoefficients coeffs;
+
+	if (notch_freq <= 0.0f || bandwidth <= 0.0f || notch_freq >= sample_freq / 2.0f) {
+		// no filtering
+		return coeffs;
+	}
+
+	const float omega = 2.0f * M_PI_F * notch_freq / sample_freq;
+	const float alpha = sinf(omega) * bandwidth / (2.0f * notch_freq);
+	const float a0 = 1.0f + alpha;
+
+	coeffs.b0 = 1.0f / a0;
+	coeffs.b1 = -2.0f * cosf(omega) / a0;
+	coeffs.b2 = coeffs.b0;
+
+	coeffs.a1 = coeffs.b1;
+	coeffs.a2 = (1.0f - alpha) / a0;
+
+	return coeffs;
+}
+
+} // namespace math
@@ -0,0 +1,275 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2018 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file FilterBank.hpp
+ *
+ * Second order low pass and notch filters on a block of samples of
+ * several channels at once, e.g. the three gyro and three accel axes of
+ * an IMU FIFO burst.
+ *
+ * The coefficients and delay elements of all channels are kept in
+ * separate arrays, so the inner loop over the channels of one sample
+ * has no dependencies and can be vectorized by the compiler.
+ */
+
+#pragma once
+
+#include <px4_defines.h>
+
+#include <stddef.h>
+#include <cmath>
+
+namespace math
+{
+
+/**
+ * Coefficients of a direct form II biquad, a0 normalized to 1.
+ */
+struct BiquadCoefficients {
+	float b0{1.0f};
+	float b1{0.0f};
+	float b2{0.0f};
+
+	float a1{0.0f};
+	float a2{0.0f};
+
+	/**
+	 * Butterworth low pass, same response as LowPassFilter2p.
+	 * A cutoff frequency <= 0 gives a pass through filter.
+	 */
+	static BiquadCoefficients lowpass2p(float sample_freq, float cutoff_freq);
+
+	/**
+	 * Notch centered on notch_freq with the -3 dB bandwidth given.
+	 * A notch frequency <= 0 or above Nyquist gives a pass through filter.
+	 */
+	static BiquadCoefficients notch(float sample_freq, float notch_freq, float bandwidth);
+};
+
+/**
+ * Filter bank of CHANNELS channels: up to NOTCHES notch stages
+ * followed by a low pass stage. Each channel has its own coefficients,
+ * a stage is only run if it is configured on any channel.
+ *
+ * The input block is sample major, block[n][channel], and filtered in place.
+ */
+template<size_t CHANNELS, size_t NOTCHES = 1>
+class FilterBank
+{
+public:
+
+	FilterBank() = default;
+
+	/**
+	 * Set the low pass cutoff of channels [first, first + count).
+	 * Resets the delay elements of these channels.
+	 */
+	void set_lowpass(size_t first, size_t count, float sample_freq, float cutoff_freq)
+	{
+		configure(_lowpass, first, count, BiquadCoefficients::lowpass2p(sample_freq, cutoff_freq));
+
+		for (size_t c = first; c < first + count && c < CHANNELS; c++) {
+			_cutoff_freq[c] = cutoff_freq;
+		}
+	}
+
+	/**
+	 * Set notch stage 'stage' of channels [first, first + count).
+	 * A notch frequency <= 0 disables the stage on these channels.
+	 */
+	void set_notch(size_t stage, size_t first, size_t count, float sample_freq, float notch_freq, float bandwidth)
+	{
+		if (stage < NOTCHES) {
+			configure(_notch[stage], first, count, BiquadCoefficients::notch(sample_freq, notch_freq, bandwidth));
+		}
+	}
+
+	// Return the low pass cutoff frequency of a channel
+	float get_cutoff_freq(size_t channel) const { return (channel < CHANNELS) ? _cutoff_freq[channel] : 0.0f; }
+
+	/**
+	 * Filter a block of samples in place.
+	 *
+	 * @param block		samples, block[n][channel]
+	 * @param samples	number of samples in the block
+	 */
+	void apply(float block[][CHANNELS], size_t samples)
+	{
+		for (size_t i = 0; i < NOTCHES; i++) {
+			if (_notch[i].active) {
+				apply_stage(_notch[i], block, samples);
+			}
+		}
+
+		if (_lowpass.active) {
+			apply_stage(_lowpass, block, samples);
+		}
+	}
+
+	// Filter a single sample of all channels in place
+	void apply(float sample[CHANNELS])
+	{
+		apply(reinterpret_cast<float (*)[CHANNELS]>(sample), 1);
+	}
+
+	/**
+	 * Reset the filter state to the steady state of a constant input.
+	 */
+	void reset(const float sample[CHANNELS])
+	{
+		float value[CHANNELS];
+
+		for (size_t c = 0; c < CHANNELS; c++) {
+			value[c] = sample[c];
+		}
+
+		for (size_t i = 0; i < NOTCHES; i++) {
+			reset_stage(_notch[i], value);
+		}
+
+		reset_stage(_lowpass, value);
+	}
+
+private:
+
+	struct Stage {
+		float b0[CHANNELS];
+		float b1[CHANNELS];
+		float b2[CHANNELS];
+		float a1[CHANNELS];
+		float a2[CHANNELS];
+
+		float delay_element_1[CHANNELS];	// buffered sample -1
+		float delay_element_2[CHANNELS];	// buffered sample -2
+
+		bool active;
+
+		Stage() : active(false)
+		{
+			for (size_t c = 0; c < CHANNELS; c++) {
+				b0[c] = 1.0f;
+				b1[c] = 0.0f;
+				b2[c] = 0.0f;
+				a1[c] = 0.0f;
+				a2[c] = 0.0f;
+				delay_element_1[c] = 0.0f;
+				delay_element_2[c] = 0.0f;
+			}
+		}
+	};
+
+	static void configure(Stage &stage, size_t first, size_t count, const BiquadCoefficients &coeffs)
+	{
+		for (size_t c = first; c < first + count && c < CHANNELS; c++) {
+			stage.b0[c] = coeffs.b0;
+			stage.b1[c] = coeffs.b1;
+			stage.b2[c] = coeffs.b2;
+			stage.a1[c] = coeffs.a1;
+			stage.a2[c] = coeffs.a2;
+
+			// reset delay elements on filter change
+			stage.delay_element_1[c] = 0.0f;
+			stage.delay_element_2[c] = 0.0f;
+		}
+
+		stage.active = false;
+
+		for (size_t c = 0; c < CHANNELS; c++) {
+			if (stage.b0[c] != 1.0f || stage.b1[c] != 0.0f || stage.b2[c] != 0.0f
+			    || stage.a1[c] != 0.0f || stage.a2[c] != 0.0f) {
+				stage.active = true;
+			}
+		}
+	}
+
+	static void apply_stage(Stage &stage, float block[][CHANNELS], size_t samples)
+	{
+		// local copies, so the compiler knows the state does not alias the block
+		float d1[CHANNELS];
+		float d2[CHANNELS];
+
+		for (size_t c = 0; c < CHANNELS; c++) {
+			d1[c] = stage.delay_element_1[c];
+			d2[c] = stage.delay_element_2[c];
+		}
+
+		for (size_t n = 0; n < samples; n++) {
+			float *x = block[n];
+
+			for (size_t c = 0; c < CHANNELS; c++) {
+				const float d0 = x[c] - d1[c] * stage.a1[c] - d2[c] * stage.a2[c];
+				x[c] = d0 * stage.b0[c] + d1[c] * stage.b1[c] + d2[c] * stage.b2[c];
+				d2[c] = d1[c];
+				d1[c] = d0;
+			}
+		}
+
+		// Checked once per block instead of every sample to keep the loop
+		// branch free. Don't allow bad values to propagate via the filter.
+		for (size_t c = 0; c < CHANNELS; c++) {
+			if (!PX4_ISFINITE(d1[c]) || !PX4_ISFINITE(d2[c])) {
+				d1[c] = 0.0f;
+				d2[c] = 0.0f;
+			}
+
+			stage.delay_element_1[c] = d1[c];
+			stage.delay_element_2[c] = d2[c];
+		}
+	}
+
+	static void reset_stage(Stage &stage, float value[CHANNELS])
+	{
+		for (size_t c = 0; c < CHANNELS; c++) {
+			// steady state of the delay elements for a constant input
+			const float dval = value[c] / (1.0f + stage.a1[c] + stage.a2[c]);
+
+			if (PX4_ISFINITE(dval)) {
+				stage.delay_element_1[c] = dval;
+				stage.delay_element_2[c] = dval;
+				value[c] = dval * (stage.b0[c] + stage.b1[c] + stage.b2[c]);
+
+			} else {
+				stage.delay_element_1[c] = value[c];
+				stage.delay_element_2[c] = value[c];
+			}
+		}
+	}
+
+	Stage _lowpass;
+	Stage _notch[NOTCHES];
+
+	float _cutoff_freq[CHANNELS] {};
+};
+
+} // namespace math
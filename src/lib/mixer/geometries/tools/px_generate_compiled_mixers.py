@@ -0,0 +1,337 @@
+#!/usr/bin/env python
+#############################################################################
+#
+#   Copyright (C) 2018 PX4 Development Team. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#
+# 1. Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+# 2. Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in
+#    the documentation and/or other materials provided with the
+#    distribution.
+# 3. Neither the name PX4 nor the names of its contributors may be
+#    used to endorse or promote products derived from this software
+#    without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+# "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+# FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+# COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+# INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+# BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+# OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+# AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+# LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+# ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+# POSSIBILITY OF SUCH DAMAGE.
+#
+#############################################################################
+
+"""
+px_generate_compiled_mixers.py
+Compiles mixer definition files (.mix format) into constant tables,
+which MixerGroup::load_from_buf() uses instead of parsing the text
+of a mixer file that matches one of them.
+"""
+
+from __future__ import print_function
+
+import os
+import re
+
+# must match the limits of the mixer command and MixerGroup
+MIXER_BUFFER_SIZE = 2048
+MIXER_LINE_SIZE = 120
+MIXER_COMPILED_MAX_MIXERS = 16
+
+# default output scaler of a simple mixer without O: line
+DEFAULT_OUTPUT_SCALER = [10000, 10000, 0, -10000, 10000]
+
+
+class MixerCompileError(Exception):
+    pass
+
+
+def load_mixer_text(filename):
+    '''
+    Returns the mixer definition text of a file the same way as load_mixer_file() does,
+    or None if the mixer command cannot load the file.
+    '''
+    text = ''
+
+    with open(filename, 'rb') as f:
+        content = f.read().decode('ascii', 'replace').replace('\r\n', '\n')
+
+    for full_line in content.splitlines(True):
+        # fgets() returns lines of at most MIXER_LINE_SIZE - 1 characters
+        for i in range(0, len(full_line), MIXER_LINE_SIZE - 1):
+            line = full_line[i:i + MIXER_LINE_SIZE - 1]
+
+            # if the line doesn't look like a mixer definition line, skip it
+            if len(line) < 2 or not ('A' <= line[0] <= 'Z') or line[1] != ':':
+                continue
+
+            # compact whitespace, and strip it at the end of the buffer
+            line = re.sub(' +', ' ', line)
+            line = re.sub(' +$', '', line) if not line.endswith('\n') else line
+
+            if len(line) + len(text) + 1 >= MIXER_BUFFER_SIZE:
+                return None
+
+            text += line
+
+    return text
+
+
+def parse_ints(line, tag, count):
+    fields = line.split()
+
+    if len(fields) < count + 1 or fields[0] != tag + ':':
+        raise MixerCompileError('expected {} values on "{}"'.format(count, line.strip()))
+
+    try:
+        return [int(v) for v in fields[1:count + 1]]
+
+    except ValueError:
+        raise MixerCompileError('invalid value on "{}"'.format(line.strip()))
+
+
+def compile_mixer_text(text):
+    '''
+    Compiles the text of a mixer file into a list of operations, with the same result
+    as MixerGroup::load_from_buf(). Raises MixerCompileError for anything that is
+    not supported, the file is then parsed at runtime.
+    '''
+    # the text parser requires every definition to end with a new line
+    if not text.endswith('\n'):
+        raise MixerCompileError('missing new line at the end')
+
+    lines = text.splitlines()
+    ops = []
+    i = 0
+
+    while i < len(lines):
+        line = lines[i]
+        tag = line[0]
+
+        if tag == 'Z':
+            ops.append({'type': 'NULL'})
+            i += 1
+
+        elif tag == 'M':
+            inputs = parse_ints(line, 'M', 1)[0]
+
+            if inputs < 1 or inputs > 32:
+                raise MixerCompileError('invalid number of inputs on "{}"'.format(line))
+
+            i += 1
+            output_scaler = DEFAULT_OUTPUT_SCALER
+
+            if i < len(lines) and lines[i].startswith('O:'):
+                output_scaler = parse_ints(lines[i], 'O', 5)
+                i += 1
+
+            controls = []
+
+            for _ in range(inputs):
+                if i >= len(lines):
+                    raise MixerCompileError('missing S: line for "{}"'.format(line))
+
+                s = parse_ints(lines[i], 'S', 7)
+
+                if not (0 <= s[0] <= 255 and 0 <= s[1] <= 255):
+                    raise MixerCompileError('invalid control on "{}"'.format(lines[i]))
+
+                controls.append(s)
+                i += 1
+
+            ops.append({'type': 'SIMPLE', 'output_scaler': output_scaler, 'controls': controls})
+
+        elif tag == 'R':
+            fields = line.split()
+
+            if len(fields) < 6 or len(fields[1]) > 7:
+                raise MixerCompileError('invalid multirotor mixer "{}"'.format(line))
+
+            if any(op['type'] == 'MULTIROTOR' for op in ops):
+                raise MixerCompileError('more than one multirotor mixer')
+
+            ops.append({'type': 'MULTIROTOR', 'geometry': fields[1], 'scales': parse_ints(' '.join([fields[0]] + fields[2:]), 'R', 4)})
+            i += 1
+
+        else:
+            # helicopter mixers and anything else is left to the text parser
+            raise MixerCompileError('unsupported mixer "{}"'.format(line))
+
+    if not ops:
+        raise MixerCompileError('no mixers')
+
+    if len(ops) > MIXER_COMPILED_MAX_MIXERS:
+        raise MixerCompileError('too many mixers')
+
+    return ops
+
+
+def format_scaler(s):
+    return '{{{}}}'.format(', '.join('{} / 10000.0f'.format(v) for v in s))
+
+
+def generate_mixer_compiled_header(mixer_files):
+    '''
+    Generate C header file with the compiled mixer tables
+    '''
+    from io import StringIO
+    buf = StringIO()
+
+    # Print Header
+    buf.write(u"/*\n")
+    buf.write(u"* This file is automatically generated by px_generate_compiled_mixers.py - do not edit.\n")
+    buf.write(u"*/\n")
+    buf.write(u"\n")
+    buf.write(u"#ifndef _MIXER_COMPILED_TABLES\n")
+    buf.write(u"#define _MIXER_COMPILED_TABLES\n")
+    buf.write(u"\n")
+    buf.write(u"namespace {\n")
+
+    compiled = []
+
+    for index, (name, text, ops) in enumerate(mixer_files):
+        buf.write(u"\n/* {} */\n".format(name))
+
+        buf.write(u"constexpr char _compiled_mixer_{}_text[] =".format(index))
+
+        for line in text.splitlines():
+            buf.write(u"\n\t\"{}\\n\"".format(line.replace('\\', '\\\\').replace('"', '\\"')))
+
+        buf.write(u";\n")
+
+        controls = []
+        multirotor = None
+
+        buf.write(u"constexpr mixer_compiled_op_s _compiled_mixer_{}_ops[] = {{\n".format(index))
+
+        for op in ops:
+            if op['type'] == 'SIMPLE':
+                buf.write(u"\t{{mixer_compiled_op_s::TYPE_SIMPLE, {}, {}, {}}},\n".format(
+                    len(op['controls']), len(controls), format_scaler(op['output_scaler'])))
+                controls += op['controls']
+
+            elif op['type'] == 'MULTIROTOR':
+                buf.write(u"\t{mixer_compiled_op_s::TYPE_MULTIROTOR, 0, 0, {}},\n")
+                multirotor = op
+
+            else:
+                buf.write(u"\t{mixer_compiled_op_s::TYPE_NULL, 0, 0, {}},\n")
+
+        buf.write(u"};\n")
+
+        if controls:
+            buf.write(u"constexpr mixer_control_s _compiled_mixer_{}_controls[] = {{\n".format(index))
+
+            for s in controls:
+                buf.write(u"\t{{{}, {}, {}}},\n".format(s[0], s[1], format_scaler(s[2:])))
+
+            buf.write(u"};\n")
+
+        compiled.append((name, text, ops, controls, multirotor))
+
+    # Print file index
+    buf.write(u"\nconst mixer_compiled_file_s _compiled_mixer_files[] = {\n")
+
+    for index, (name, text, ops, controls, multirotor) in enumerate(compiled):
+        if multirotor is not None:
+            multirotor_info = u"{{\"{}\", {}}}".format(multirotor['geometry'],
+                                                      ', '.join('{} / 10000.0f'.format(v) for v in multirotor['scales']))
+
+        else:
+            multirotor_info = u"{}"
+
+        buf.write(u"\t{{\"{}\", _compiled_mixer_{}_text, {}, {}, _compiled_mixer_{}_ops, {}, {}}},\n".format(
+            name, index, len(text), len(ops), index,
+            u"_compiled_mixer_{}_controls".format(index) if controls else u"nullptr",
+            multirotor_info))
+
+    buf.write(u"};\n\n")
+
+    # Print footer
+    buf.write(u"} // anonymous namespace\n\n")
+    buf.write(u"#endif /* _MIXER_COMPILED_TABLES */\n\n")
+
+    return buf.getvalue()
+
+
+if __name__ == '__main__':
+    import argparse
+    import glob
+
+    # Parse arguments
+    parser = argparse.ArgumentParser(
+        description='Compile mixer .mix files to constant tables')
+    parser.add_argument('-d', dest='dir',
+                        help='directory with mixer files')
+    parser.add_argument('-f', dest='files',
+                        help="files to compile (use only without -d)",
+                        nargs="+")
+    parser.add_argument('-o', dest='outputfile',
+                        help='output header file')
+    parser.add_argument('--verbose', help='Print details on standard output',
+                        action='store_true')
+    args = parser.parse_args()
+
+    # Find mixer files
+    if args.files is not None:
+        filenames = args.files
+    elif args.dir is not None:
+        filenames = glob.glob(os.path.join(args.dir, '*.mix'))
+    else:
+        parser.print_usage()
+        raise Exception("Missing input directory (-d) or list of mixer files (-f)")
+
+    # List of compiled mixer files, skipping the ones the text parser has to handle
+    mixer_files = []
+    texts = set()
+
+    for filename in sorted(filenames):
+        name = os.path.basename(filename)
+        text = load_mixer_text(filename)
+
+        if text is None:
+            if args.verbose:
+                print('{}: too long, not compiled'.format(name))
+            continue
+
+        # files with the same definitions compile to the same table
+        if text in texts:
+            if args.verbose:
+                print('{}: duplicate, not compiled'.format(name))
+            continue
+
+        try:
+            ops = compile_mixer_text(text)
+
+        except MixerCompileError as e:
+            if args.verbose:
+                print('{}: {}, not compiled'.format(name, e))
+            continue
+
+        texts.add(text)
+        mixer_files.append((name, text, ops))
+
+        if args.verbose:
+            print('{}: {} mixers'.format(name, len(ops)))
+
+    # Generate header file
+    header = generate_mixer_compiled_header(mixer_files)
+
+    if args.outputfile is not None:
+        # Write header file
+        with open(args.outputfile, 'w') as fd:
+            fd.write(header)
+    else:
+        # Print to standard output
+        print(header)
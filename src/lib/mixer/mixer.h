@@ -154,6 +154,46 @@ struct mixer_simple_s {
 
 #define MIXER_SIMPLE_SIZE(_icount)	(sizeof(struct mixer_simple_s) + (_icount) * sizeof(struct mixer_control_s))
 
+/** maximum number of mixers of a compiled mixer file */
+#define MIXER_COMPILED_MAX_MIXERS	16
+
+/** mixer of a compiled mixer file, producing one output (simple, null) or one per rotor (multirotor) */
+struct mixer_compiled_op_s {
+	enum type_e : uint8_t {
+		TYPE_NULL,
+		TYPE_SIMPLE,
+		TYPE_MULTIROTOR
+	};
+
+	uint8_t			type;		/**< one of type_e */
+	uint8_t			control_count;	/**< number of inputs of a simple mixer */
+	uint16_t		first_control;	/**< index of the first input of a simple mixer in the controls of the file */
+	struct mixer_scaler_s	output_scaler;	/**< scaling for the output of a simple mixer */
+};
+
+/** multirotor mixer of a compiled mixer file, as given by the R: line */
+struct mixer_compiled_multirotor_s {
+	const char		*geometry;	/**< geometry key */
+	float			roll_scale;
+	float			pitch_scale;
+	float			yaw_scale;
+	float			idle_speed;
+};
+
+/**
+ * Mixer file compiled into a flat table at build time by px_generate_compiled_mixers.py.
+ * It is identified by the text that load_mixer_file() reads from the file.
+ */
+struct mixer_compiled_file_s {
+	const char			*name;		/**< name of the mixer file */
+	const char			*text;		/**< mixer text the table was compiled from */
+	uint16_t			text_length;	/**< length of the mixer text */
+	uint8_t				op_count;	/**< number of mixers */
+	const mixer_compiled_op_s	*ops;		/**< mixers, in output order */
+	const mixer_control_s		*controls;	/**< inputs of the simple mixers */
+	mixer_compiled_multirotor_s	multirotor;	/**< configuration of the (at most one) multirotor mixer */
+};
+
 
 /**
  * Abstract class defining a mixer mixing zero or more inputs to
@@ -322,6 +362,8 @@ private:
 	Mixer &operator=(const Mixer &);
 };
 
+class MultirotorMixer;
+
 /**
  * Group of mixers, built up from single mixers and processed
  * in order when mixing.
@@ -403,12 +445,29 @@ public:
 	 *
 	 *   S: <angle (deg)> <normalized arm length> <scale> <offset> <lower limit> <upper limit>
 	 *
+	 * Compiled Mixers
+	 * ...............
+	 *
+	 * If the group is empty and the buffer holds exactly the text of a mixer file
+	 * that was compiled into the firmware, the mixers are taken from its table
+	 * instead, without parsing and allocating the individual mixers (only the state
+	 * of a multirotor mixer is allocated). They are then mixed by a single loop over
+	 * the table, see mix_compiled().
+	 *
 	 * @param buf			The mixer configuration buffer.
 	 * @param buflen		The length of the buffer, updated to reflect
 	 *				bytes as they are consumed.
+	 * @param allow_compiled	Use the compiled mixers matching the buffer, if any.
 	 * @return			Zero on successful load, nonzero otherwise.
 	 */
-	int				load_from_buf(const char *buf, unsigned &buflen);
+	int				load_from_buf(const char *buf, unsigned &buflen, bool allow_compiled = true);
+
+	/**
+	 * Get the compiled mixer file used by the group.
+	 *
+	 * @return			The compiled mixer file, or nullptr if the mixers were parsed from text.
+	 */
+	const mixer_compiled_file_s	*compiled() const { return _compiled; }
 
 	/**
 	 * @brief      Update slew rate parameter. This tells instances of the class MultirotorMixer
@@ -452,6 +511,30 @@ public:
 private:
 	Mixer				*_first;	/**< linked list of mixers */
 
+	const mixer_compiled_file_s	*_compiled{nullptr};		/**< compiled mixers, mixed before the linked list */
+	MultirotorMixer			*_compiled_multirotor{nullptr};	/**< state of the compiled multirotor mixer */
+	float				_compiled_offset[MIXER_COMPILED_MAX_MIXERS] {};	/**< output offsets (trims) of the compiled mixers */
+
+	/**
+	 * Look up the compiled mixer file with exactly the given text.
+	 *
+	 * @return			The compiled mixer file, or nullptr if there is none.
+	 */
+	static const mixer_compiled_file_s *find_compiled(const char *buf, unsigned buflen);
+
+	/**
+	 * Set up the group for mixing the compiled mixers of a file.
+	 *
+	 * @return			Zero on success, nonzero otherwise.
+	 */
+	int				load_compiled(const mixer_compiled_file_s *compiled);
+
+	/**
+	 * Mix the compiled mixers without virtual calls, simple mixers are evaluated
+	 * directly from the table.
+	 */
+	unsigned			mix_compiled(float *outputs, unsigned space);
+
 	/* do not allow to copy due to pointer data members */
 	MixerGroup(const MixerGroup &);
 	MixerGroup operator=(const MixerGroup &);
@@ -652,7 +735,7 @@ public:
 	 */
 	MultirotorMixer(ControlCallback control_cb,
 			uintptr_t cb_handle,
-			Rotor *rotors,
+			const Rotor *rotors,
 			unsigned rotor_count);
 
 	~MultirotorMixer();
@@ -676,6 +759,19 @@ public:
 	static MultirotorMixer		*from_text(Mixer::ControlCallback control_cb, uintptr_t cb_handle, const char *buf,
 			unsigned &buflen);
 
+	/**
+	 * Factory method for a compiled mixer file.
+	 *
+	 * @param control_cb		The callback to invoke when fetching a
+	 *				control value.
+	 * @param cb_handle		Handle passed to the control callback.
+	 * @param compiled		Multirotor configuration of the compiled mixer file.
+	 * @return			A new MultirotorMixer instance, or nullptr
+	 *				if the geometry is unknown.
+	 */
+	static MultirotorMixer		*from_compiled(Mixer::ControlCallback control_cb, uintptr_t cb_handle,
+			const mixer_compiled_multirotor_s &compiled);
+
 	unsigned		mix(float *outputs, unsigned space) override;
 	uint16_t		get_saturation_status(void) override;
 	void			groups_required(uint32_t &groups) override;
@@ -729,9 +825,15 @@ public:
 	};
 
 private:
+	/**
+	 * Copy the rotor mix into the structure-of-arrays layout used by the mixing kernels.
+	 */
+	void init_rotor_matrix(const Rotor *rotors);
+
 	/**
 	 * Computes the gain k by which desaturation_vector has to be multiplied
 	 * in order to unsaturate the output that has the greatest saturation.
+	 * The outputs are only looked at if their range is outside of [min_output, max_output].
 	 * @see also minimize_saturation().
 	 *
 	 * @return desaturation gain
@@ -739,6 +841,16 @@ private:
 	float compute_desaturation_gain(const float *desaturation_vector, const float *outputs, saturation_status &sat_status,
 					float min_output, float max_output) const;
 
+	/**
+	 * Adds gain * desaturation_vector to the outputs and updates their range.
+	 */
+	inline void add_to_outputs(float gain, const float *desaturation_vector, float *outputs);
+
+	/**
+	 * Mixes roll, pitch, yaw and thrust into the outputs and updates their range.
+	 */
+	inline void mix_outputs(float roll, float pitch, float yaw, float thrust, float *outputs);
+
 	/**
 	 * Minimize the saturation of the actuators by adding or substracting a fraction of desaturation_vector.
 	 * desaturation_vector is the vector that added to the output outputs, modifies the thrust or angular
@@ -758,7 +870,17 @@ private:
 	 * @param reduce_only if true, only allow to reduce (substract) a fraction of desaturation_vector
 	 */
 	void minimize_saturation(const float *desaturation_vector, float *outputs, saturation_status &sat_status,
-				 float min_output = 0.f, float max_output = 1.f, bool reduce_only = false) const;
+				 float min_output = 0.f, float max_output = 1.f, bool reduce_only = false)
+	{
+		desaturate(desaturation_vector, compute_desaturation_gain(desaturation_vector, outputs, sat_status, min_output,
+				max_output), outputs, sat_status, min_output, max_output, reduce_only);
+	}
+
+	/**
+	 * @see minimize_saturation(), for a desaturation gain k1 that is already known.
+	 */
+	void desaturate(const float *desaturation_vector, float k1, float *outputs, saturation_status &sat_status,
+			float min_output = 0.f, float max_output = 1.f, bool reduce_only = false);
 
 	/**
 	 * Mix roll, pitch, yaw, thrust and set the outputs vector.
@@ -799,7 +921,7 @@ private:
 	 */
 	inline void mix_yaw(float yaw, float *outputs);
 
-	void update_saturation_status(unsigned index, bool clipping_high, bool clipping_low);
+	inline void update_saturation_status(unsigned index, bool clipping_high, bool clipping_low);
 
 	float				_roll_scale;
 	float				_pitch_scale;
@@ -813,10 +935,19 @@ private:
 	saturation_status _saturation_status;
 
 	unsigned			_rotor_count;
-	const Rotor			*_rotors;
+
+	/* rotor mix as structure of arrays, so that each axis is a contiguous vector over the rotors */
+	float				*_rotor_matrix = nullptr;
+	const float			*_roll_scales = nullptr;
+	const float			*_pitch_scales = nullptr;
+	const float			*_yaw_scales = nullptr;
+	const float			*_thrust_scales = nullptr;
 
 	float 				*_outputs_prev = nullptr;
-	float 				*_tmp_array = nullptr;
+
+	/* range of the outputs of the current mix, kept up to date by every step that changes them */
+	float				_lowest_output{0.f};
+	float				_highest_output{0.f};
 
 	/* do not allow to copy due to ptr data members */
 	MultirotorMixer(const MultirotorMixer &);
@@ -53,6 +53,10 @@
 
 #include "mixer.h"
 
+#if defined(MIXER_COMPILED_TABLES)
+#include "mixer_compiled.generated.h"
+#endif
+
 #define debug(fmt, args...)	do { } while(0)
 //#define debug(fmt, args...)	do { printf("[mixer] " fmt "\n", ##args); } while(0)
 //#include <debug.h>
@@ -92,6 +96,10 @@ MixerGroup::reset()
 
 	/* flag mixer as invalid */
 	_first = nullptr;
+	_compiled = nullptr;
+
+	delete _compiled_multirotor;
+	_compiled_multirotor = nullptr;
 
 	/* discard sub-mixers */
 	while (next != nullptr) {
@@ -108,6 +116,10 @@ MixerGroup::mix(float *outputs, unsigned space)
 	Mixer	*mixer = _first;
 	unsigned index = 0;
 
+	if (_compiled != nullptr) {
+		index = mix_compiled(outputs, space);
+	}
+
 	while ((mixer != nullptr) && (index < space)) {
 		index += mixer->mix(outputs + index, space - index);
 		mixer = mixer->_next;
@@ -116,6 +128,50 @@ MixerGroup::mix(float *outputs, unsigned space)
 	return index;
 }
 
+unsigned
+MixerGroup::mix_compiled(float *outputs, unsigned space)
+{
+	const mixer_control_s *controls = _compiled->controls;
+	unsigned index = 0;
+
+	for (unsigned i = 0; (i < _compiled->op_count) && (index < space); i++) {
+		const mixer_compiled_op_s &op = _compiled->ops[i];
+
+		switch (op.type) {
+		case mixer_compiled_op_s::TYPE_SIMPLE: {
+				/* same as SimpleMixer::mix(), with the trim kept as output offset */
+				float sum = 0.0f;
+
+				for (unsigned j = op.first_control; j < op.first_control + op.control_count; j++) {
+					float input = 0.0f;
+
+					_control_cb(_cb_handle, controls[j].control_group, controls[j].control_index, input);
+
+					sum += scale(controls[j].scaler, input);
+				}
+
+				mixer_scaler_s output_scaler = op.output_scaler;
+				output_scaler.offset = _compiled_offset[i];
+
+				outputs[index++] = scale(output_scaler, sum);
+				break;
+			}
+
+		case mixer_compiled_op_s::TYPE_MULTIROTOR:
+			/* the type is known, so avoid the virtual call */
+			index += _compiled_multirotor->MultirotorMixer::mix(outputs + index, space - index);
+			break;
+
+		default:
+			/* same as NullMixer::mix() */
+			outputs[index++] = NAN;
+			break;
+		}
+	}
+
+	return index;
+}
+
 /*
  * set_trims() has no effect except for the SimpleMixer implementation for which set_trim()
  * always returns the value one.
@@ -127,8 +183,10 @@ MixerGroup::set_trims(int16_t *values, unsigned n)
 {
 	Mixer	*mixer = _first;
 	unsigned index = 0;
+	unsigned op = 0;
+	const unsigned op_count = (_compiled != nullptr) ? _compiled->op_count : 0;
 
-	while ((mixer != nullptr) && (index < n)) {
+	while (((op < op_count) || (mixer != nullptr)) && (index < n)) {
 		/* convert from integer to float */
 		float offset = (float)values[index] / 10000;
 
@@ -138,8 +196,26 @@ MixerGroup::set_trims(int16_t *values, unsigned n)
 		if (offset >  1.0f) { offset =  1.0f; }
 
 		debug("set trim: %d, offset: %5.3f", values[index], (double)offset);
-		index += mixer->set_trim(offset);
-		mixer = mixer->_next;
+
+		if (op < op_count) {
+			/* compiled mixers first, each feeds one output except for the multirotor mixer */
+			if (_compiled->ops[op].type == mixer_compiled_op_s::TYPE_MULTIROTOR) {
+				index += _compiled_multirotor->set_trim(offset);
+
+			} else {
+				if (_compiled->ops[op].type == mixer_compiled_op_s::TYPE_SIMPLE) {
+					_compiled_offset[op] = offset;
+				}
+
+				index++;
+			}
+
+			op++;
+
+		} else {
+			index += mixer->set_trim(offset);
+			mixer = mixer->_next;
+		}
 	}
 
 	return index;
@@ -159,6 +235,32 @@ MixerGroup::get_trims(int16_t *values)
 	unsigned index = 0;
 	float trim;
 
+	if (_compiled != nullptr) {
+		for (unsigned op = 0; op < _compiled->op_count; op++) {
+			trim = 0;
+
+			switch (_compiled->ops[op].type) {
+			case mixer_compiled_op_s::TYPE_SIMPLE:
+				trim = _compiled_offset[op];
+				index_mixer++;
+				break;
+
+			case mixer_compiled_op_s::TYPE_MULTIROTOR:
+				index_mixer += _compiled_multirotor->get_trim(&trim);
+				break;
+
+			default:
+				index_mixer++;
+				break;
+			}
+
+			while (index < index_mixer) {
+				values[index] = trim * 10000;
+				index++;
+			}
+		}
+	}
+
 	while (mixer != nullptr) {
 		trim = 0;
 		index_mixer += mixer->get_trim(&trim);
@@ -181,6 +283,10 @@ MixerGroup::set_thrust_factor(float val)
 {
 	Mixer	*mixer = _first;
 
+	if (_compiled_multirotor != nullptr) {
+		_compiled_multirotor->set_thrust_factor(val);
+	}
+
 	while (mixer != nullptr) {
 		mixer->set_thrust_factor(val);
 		mixer = mixer->_next;
@@ -192,6 +298,10 @@ MixerGroup::set_airmode(Airmode airmode)
 {
 	Mixer	*mixer = _first;
 
+	if (_compiled_multirotor != nullptr) {
+		_compiled_multirotor->set_airmode(airmode);
+	}
+
 	while (mixer != nullptr) {
 		mixer->set_airmode(airmode);
 		mixer = mixer->_next;
@@ -204,6 +314,10 @@ MixerGroup::get_saturation_status()
 	Mixer	*mixer = _first;
 	uint16_t sat = 0;
 
+	if (_compiled_multirotor != nullptr) {
+		sat |= _compiled_multirotor->get_saturation_status();
+	}
+
 	while (mixer != nullptr) {
 		sat |= mixer->get_saturation_status();
 		mixer = mixer->_next;
@@ -216,7 +330,7 @@ unsigned
 MixerGroup::count()
 {
 	Mixer	*mixer = _first;
-	unsigned index = 0;
+	unsigned index = (_compiled != nullptr) ? _compiled->op_count : 0;
 
 	while (mixer != nullptr) {
 		mixer = mixer->_next;
@@ -231,18 +345,89 @@ MixerGroup::groups_required(uint32_t &groups)
 {
 	Mixer	*mixer = _first;
 
+	if (_compiled != nullptr) {
+		for (unsigned op = 0; op < _compiled->op_count; op++) {
+			const mixer_compiled_op_s &compiled_op = _compiled->ops[op];
+
+			if (compiled_op.type == mixer_compiled_op_s::TYPE_SIMPLE) {
+				for (unsigned i = compiled_op.first_control; i < compiled_op.first_control + compiled_op.control_count; i++) {
+					groups |= 1 << _compiled->controls[i].control_group;
+				}
+
+			} else if (compiled_op.type == mixer_compiled_op_s::TYPE_MULTIROTOR) {
+				_compiled_multirotor->groups_required(groups);
+			}
+		}
+	}
+
 	while (mixer != nullptr) {
 		mixer->groups_required(groups);
 		mixer = mixer->_next;
 	}
 }
 
+const mixer_compiled_file_s *
+MixerGroup::find_compiled(const char *buf, unsigned buflen)
+{
+#if defined(MIXER_COMPILED_TABLES)
+
+	for (const mixer_compiled_file_s &compiled : _compiled_mixer_files) {
+		if ((compiled.text_length == buflen) && (memcmp(compiled.text, buf, buflen) == 0)) {
+			return &compiled;
+		}
+	}
+
+#else
+	(void)buf;
+	(void)buflen;
+#endif /* MIXER_COMPILED_TABLES */
+
+	return nullptr;
+}
+
 int
-MixerGroup::load_from_buf(const char *buf, unsigned &buflen)
+MixerGroup::load_compiled(const mixer_compiled_file_s *compiled)
+{
+	MultirotorMixer *multirotor = nullptr;
+
+	for (unsigned op = 0; op < compiled->op_count; op++) {
+		if (compiled->ops[op].type == mixer_compiled_op_s::TYPE_MULTIROTOR) {
+			multirotor = MultirotorMixer::from_compiled(_control_cb, _cb_handle, compiled->multirotor);
+
+			if (multirotor == nullptr) {
+				return -1;
+			}
+		}
+
+		_compiled_offset[op] = compiled->ops[op].output_scaler.offset;
+	}
+
+	_compiled_multirotor = multirotor;
+	_compiled = compiled;
+
+	return 0;
+}
+
+int
+MixerGroup::load_from_buf(const char *buf, unsigned &buflen, bool allow_compiled)
 {
 	int ret = -1;
 	const char *end = buf + buflen;
 
+	/*
+	 * A mixer file compiled into the firmware is used as a whole, so the group
+	 * has to be empty, and the buffer must hold the complete text of the file.
+	 */
+	if (allow_compiled && (_first == nullptr) && (_compiled == nullptr)) {
+		const mixer_compiled_file_s *compiled = find_compiled(buf, buflen);
+
+		if ((compiled != nullptr) && (load_compiled(compiled) == 0)) {
+			debug("loaded compiled mixer %s", compiled->name);
+			buflen = 0;
+			return 0;
+		}
+	}
+
 	/*
 	 * Loop until either we have emptied the buffer, or we have failed to
 	 * allocate something when we expected to.
@@ -309,6 +494,10 @@ void MixerGroup::set_max_delta_out_once(float delta_out_max)
 {
 	Mixer	*mixer = _first;
 
+	if (_compiled_multirotor != nullptr) {
+		_compiled_multirotor->set_max_delta_out_once(delta_out_max);
+	}
+
 	while (mixer != nullptr) {
 		mixer->set_max_delta_out_once(delta_out_max);
 		mixer = mixer->_next;
@@ -95,17 +95,17 @@ MultirotorMixer::MultirotorMixer(ControlCallback control_cb,
 	_thrust_factor(0.0f),
 	_airmode(Airmode::disabled),
 	_rotor_count(_config_rotor_count[(MultirotorGeometryUnderlyingType)geometry]),
-	_rotors(_config_index[(MultirotorGeometryUnderlyingType)geometry]),
-	_outputs_prev(new float[_rotor_count]),
-	_tmp_array(new float[_rotor_count])
+	_outputs_prev(new float[_rotor_count])
 {
+	init_rotor_matrix(_config_index[(MultirotorGeometryUnderlyingType)geometry]);
+
 	for (unsigned i = 0; i < _rotor_count; ++i) {
 		_outputs_prev[i] = _idle_speed;
 	}
 }
 MultirotorMixer::MultirotorMixer(ControlCallback control_cb,
 				 uintptr_t cb_handle,
-				 Rotor *rotors,
+				 const Rotor *rotors,
 				 unsigned rotor_count) :
 	Mixer(control_cb, cb_handle),
 	_roll_scale(1.f),
@@ -116,10 +116,10 @@ MultirotorMixer::MultirotorMixer(ControlCallback control_cb,
 	_thrust_factor(0.0f),
 	_airmode(Airmode::disabled),
 	_rotor_count(rotor_count),
-	_rotors(rotors),
-	_outputs_prev(new float[_rotor_count]),
-	_tmp_array(new float[_rotor_count])
+	_outputs_prev(new float[_rotor_count])
 {
+	init_rotor_matrix(rotors);
+
 	for (unsigned i = 0; i < _rotor_count; ++i) {
 		_outputs_prev[i] = _idle_speed;
 	}
@@ -128,7 +128,31 @@ MultirotorMixer::MultirotorMixer(ControlCallback control_cb,
 MultirotorMixer::~MultirotorMixer()
 {
 	delete[] _outputs_prev;
-	delete[] _tmp_array;
+	delete[] _rotor_matrix;
+}
+
+void MultirotorMixer::init_rotor_matrix(const Rotor *rotors)
+{
+	const unsigned stride = _rotor_count;
+
+	_rotor_matrix = new float[4 * stride];
+
+	float *roll_scales = &_rotor_matrix[0];
+	float *pitch_scales = &_rotor_matrix[stride];
+	float *yaw_scales = &_rotor_matrix[2 * stride];
+	float *thrust_scales = &_rotor_matrix[3 * stride];
+
+	for (unsigned i = 0; i < _rotor_count; i++) {
+		roll_scales[i] = rotors[i].roll_scale;
+		pitch_scales[i] = rotors[i].pitch_scale;
+		yaw_scales[i] = rotors[i].yaw_scale;
+		thrust_scales[i] = rotors[i].thrust_scale;
+	}
+
+	_roll_scales = roll_scales;
+	_pitch_scales = pitch_scales;
+	_yaw_scales = yaw_scales;
+	_thrust_scales = thrust_scales;
 }
 
 MultirotorMixer *
@@ -188,9 +212,36 @@ MultirotorMixer::from_text(Mixer::ControlCallback control_cb, uintptr_t cb_handl
 		       s[3] / 10000.0f);
 }
 
-float MultirotorMixer::compute_desaturation_gain(const float *desaturation_vector, const float *outputs,
+MultirotorMixer *
+MultirotorMixer::from_compiled(Mixer::ControlCallback control_cb, uintptr_t cb_handle,
+			       const mixer_compiled_multirotor_s &compiled)
+{
+	for (MultirotorGeometryUnderlyingType i = 0; i < (MultirotorGeometryUnderlyingType)MultirotorGeometry::MAX_GEOMETRY;
+	     i++) {
+		if (!strcmp(compiled.geometry, _config_key[i])) {
+			return new MultirotorMixer(
+				       control_cb,
+				       cb_handle,
+				       (MultirotorGeometry)i,
+				       compiled.roll_scale,
+				       compiled.pitch_scale,
+				       compiled.yaw_scale,
+				       compiled.idle_speed);
+		}
+	}
+
+	debug("unrecognised geometry '%s'", compiled.geometry);
+	return nullptr;
+}
+
+inline float MultirotorMixer::compute_desaturation_gain(const float *desaturation_vector, const float *outputs,
 		saturation_status &sat_status, float min_output, float max_output) const
 {
+	// Most of the time no output is saturated, which is known from the range without looking at the outputs again
+	if (_lowest_output >= min_output && _highest_output <= max_output) {
+		return 0.f;
+	}
+
 	float k_min = 0.f;
 	float k_max = 0.f;
 
@@ -225,28 +276,61 @@ float MultirotorMixer::compute_desaturation_gain(const float *desaturation_vecto
 	return k_min + k_max;
 }
 
-void MultirotorMixer::minimize_saturation(const float *desaturation_vector, float *outputs,
-		saturation_status &sat_status,
-		float min_output, float max_output, bool reduce_only) const
+inline void MultirotorMixer::add_to_outputs(float gain, const float *desaturation_vector, float *outputs)
 {
-	float k1 = compute_desaturation_gain(desaturation_vector, outputs, sat_status, min_output, max_output);
+	float lowest_output = FLT_MAX;
+	float highest_output = -FLT_MAX;
 
-	if (reduce_only && k1 > 0.f) {
-		return;
+	for (unsigned i = 0; i < _rotor_count; i++) {
+		outputs[i] += gain * desaturation_vector[i];
+
+		lowest_output = math::min(lowest_output, outputs[i]);
+		highest_output = math::max(highest_output, outputs[i]);
 	}
 
+	_lowest_output = lowest_output;
+	_highest_output = highest_output;
+}
+
+inline void MultirotorMixer::mix_outputs(float roll, float pitch, float yaw, float thrust, float *outputs)
+{
+	float lowest_output = FLT_MAX;
+	float highest_output = -FLT_MAX;
+
 	for (unsigned i = 0; i < _rotor_count; i++) {
-		outputs[i] += k1 * desaturation_vector[i];
+		outputs[i] = roll * _roll_scales[i] +
+			     pitch * _pitch_scales[i] +
+			     yaw * _yaw_scales[i] +
+			     thrust * _thrust_scales[i];
+
+		lowest_output = math::min(lowest_output, outputs[i]);
+		highest_output = math::max(highest_output, outputs[i]);
 	}
 
+	_lowest_output = lowest_output;
+	_highest_output = highest_output;
+}
+
+void MultirotorMixer::desaturate(const float *desaturation_vector, float k1, float *outputs,
+				 saturation_status &sat_status, float min_output, float max_output, bool reduce_only)
+{
+	// Nothing to do if there is no saturation, or if it is balanced on both sides
+	if ((reduce_only && k1 > 0.f) || fabsf(k1) < FLT_MIN) {
+		return;
+	}
+
+	add_to_outputs(k1, desaturation_vector, outputs);
+
 	// Compute the desaturation gain again based on the updated outputs.
 	// In most cases it will be zero. It won't be if max(outputs) - min(outputs) > max_output - min_output.
 	// In that case adding 0.5 of the gain will equilibrate saturations.
 	float k2 = 0.5f * compute_desaturation_gain(desaturation_vector, outputs, sat_status, min_output, max_output);
 
-	for (unsigned i = 0; i < _rotor_count; i++) {
-		outputs[i] += k2 * desaturation_vector[i];
+	if (fabsf(k2) < FLT_MIN) {
+		return;
 	}
+
+	add_to_outputs(k2, desaturation_vector, outputs);
 }
 
 void MultirotorMixer::mix_airmode_rp(float roll, float pitch, float yaw, float thrust, float *outputs)
@@ -254,16 +338,10 @@ void MultirotorMixer::mix_airmode_rp(float roll, float pitch, float yaw, float t
 	// Airmode for roll and pitch, but not yaw
 
 	// Mix without yaw
-	for (unsigned i = 0; i < _rotor_count; i++) {
-		outputs[i] = roll * _rotors[i].roll_scale +
-			     pitch * _rotors[i].pitch_scale +
-			     thrust * _rotors[i].thrust_scale;
-
-		// Thrust will be used to unsaturate if needed
-		_tmp_array[i] = _rotors[i].thrust_scale;
-	}
+	mix_outputs(roll, pitch, 0.f, thrust, outputs);
 
-	minimize_saturation(_tmp_array, outputs, _saturation_status);
+	// Thrust will be used to unsaturate if needed
+	minimize_saturation(_thrust_scales, outputs, _saturation_status);
 
 	// Mix yaw independently
 	mix_yaw(yaw, outputs);
@@ -274,17 +352,10 @@ void MultirotorMixer::mix_airmode_rpy(float roll, float pitch, float yaw, float
 	// Airmode for roll, pitch and yaw
 
 	// Do full mixing
-	for (unsigned i = 0; i < _rotor_count; i++) {
-		outputs[i] = roll * _rotors[i].roll_scale +
-			     pitch * _rotors[i].pitch_scale +
-			     yaw * _rotors[i].yaw_scale +
-			     thrust * _rotors[i].thrust_scale;
-
-		// Thrust will be used to unsaturate if needed
-		_tmp_array[i] = _rotors[i].thrust_scale;
-	}
+	mix_outputs(roll, pitch, yaw, thrust, outputs);
 
-	minimize_saturation(_tmp_array, outputs, _saturation_status);
+	// Thrust will be used to unsaturate if needed
+	minimize_saturation(_thrust_scales, outputs, _saturation_status);
 }
 
 void MultirotorMixer::mix_airmode_disabled(float roll, float pitch, float yaw, float thrust, float *outputs)
@@ -292,30 +363,15 @@ void MultirotorMixer::mix_airmode_disabled(float roll, float pitch, float yaw, f
 	// Airmode disabled: never allow to increase the thrust to unsaturate a motor
 
 	// Mix without yaw
-	for (unsigned i = 0; i < _rotor_count; i++) {
-		outputs[i] = roll * _rotors[i].roll_scale +
-			     pitch * _rotors[i].pitch_scale +
-			     thrust * _rotors[i].thrust_scale;
-
-		// Thrust will be used to unsaturate if needed
-		_tmp_array[i] = _rotors[i].thrust_scale;
-	}
+	mix_outputs(roll, pitch, 0.f, thrust, outputs);
 
 	// only reduce thrust
-	minimize_saturation(_tmp_array, outputs, _saturation_status, 0.f, 1.f, true);
+	minimize_saturation(_thrust_scales, outputs, _saturation_status, 0.f, 1.f, true);
 
 	// Reduce roll/pitch acceleration if needed to unsaturate
-	for (unsigned i = 0; i < _rotor_count; i++) {
-		_tmp_array[i] = _rotors[i].roll_scale;
-	}
-
-	minimize_saturation(_tmp_array, outputs, _saturation_status);
+	minimize_saturation(_roll_scales, outputs, _saturation_status);
 
-	for (unsigned i = 0; i < _rotor_count; i++) {
-		_tmp_array[i] = _rotors[i].pitch_scale;
-	}
-
-	minimize_saturation(_tmp_array, outputs, _saturation_status);
+	minimize_saturation(_pitch_scales, outputs, _saturation_status);
 
 	// Mix yaw independently
 	mix_yaw(yaw, outputs);
@@ -323,24 +379,15 @@ void MultirotorMixer::mix_airmode_disabled(float roll, float pitch, float yaw, f
 
 void MultirotorMixer::mix_yaw(float yaw, float *outputs)
 {
-	// Add yaw to outputs
-	for (unsigned i = 0; i < _rotor_count; i++) {
-		outputs[i] += yaw * _rotors[i].yaw_scale;
-
-		// Yaw will be used to unsaturate if needed
-		_tmp_array[i] = _rotors[i].yaw_scale;
-	}
+	// Add yaw to outputs, yaw will be used to unsaturate if needed
+	add_to_outputs(yaw, _yaw_scales, outputs);
 
 	// Change yaw acceleration to unsaturate the outputs if needed (do not change roll/pitch),
 	// and allow some yaw response at maximum thrust
-	minimize_saturation(_tmp_array, outputs, _saturation_status, 0.f, 1.15f);
-
-	for (unsigned i = 0; i < _rotor_count; i++) {
-		_tmp_array[i] = _rotors[i].thrust_scale;
-	}
+	minimize_saturation(_yaw_scales, outputs, _saturation_status, 0.f, 1.15f);
 
 	// reduce thrust only
-	minimize_saturation(_tmp_array, outputs, _saturation_status, 0.f, 1.f, true);
+	minimize_saturation(_thrust_scales, outputs, _saturation_status, 0.f, 1.f, true);
 }
 
 unsigned
@@ -439,31 +486,31 @@ MultirotorMixer::update_saturation_status(unsigned index, bool clipping_high, bo
 	// The motor is saturated at the upper limit
 	// check which control axes and which directions are contributing
 	if (clipping_high) {
-		if (_rotors[index].roll_scale > 0.0f) {
+		if (_roll_scales[index] > 0.0f) {
 			// A positive change in roll will increase saturation
 			_saturation_status.flags.roll_pos = true;
 
-		} else if (_rotors[index].roll_scale < 0.0f) {
+		} else if (_roll_scales[index] < 0.0f) {
 			// A negative change in roll will increase saturation
 			_saturation_status.flags.roll_neg = true;
 		}
 
 		// check if the pitch input is saturating
-		if (_rotors[index].pitch_scale > 0.0f) {
+		if (_pitch_scales[index] > 0.0f) {
 			// A positive change in pitch will increase saturation
 			_saturation_status.flags.pitch_pos = true;
 
-		} else if (_rotors[index].pitch_scale < 0.0f) {
+		} else if (_pitch_scales[index] < 0.0f) {
 			// A negative change in pitch will increase saturation
 			_saturation_status.flags.pitch_neg = true;
 		}
 
 		// check if the yaw input is saturating
-		if (_rotors[index].yaw_scale > 0.0f) {
+		if (_yaw_scales[index] > 0.0f) {
 			// A positive change in yaw will increase saturation
 			_saturation_status.flags.yaw_pos = true;
 
-		} else if (_rotors[index].yaw_scale < 0.0f) {
+		} else if (_yaw_scales[index] < 0.0f) {
 			// A negative change in yaw will increase saturation
 			_saturation_status.flags.yaw_neg = true;
 		}
@@ -477,31 +524,31 @@ MultirotorMixer::update_saturation_status(unsigned index, bool clipping_high, bo
 	// check which control axes and which directions are contributing
 	if (clipping_low) {
 		// check if the roll input is saturating
-		if (_rotors[index].roll_scale > 0.0f) {
+		if (_roll_scales[index] > 0.0f) {
 			// A negative change in roll will increase saturation
 			_saturation_status.flags.roll_neg = true;
 
-		} else if (_rotors[index].roll_scale < 0.0f) {
+		} else if (_roll_scales[index] < 0.0f) {
 			// A positive change in roll will increase saturation
 			_saturation_status.flags.roll_pos = true;
 		}
 
 		// check if the pitch input is saturating
-		if (_rotors[index].pitch_scale > 0.0f) {
+		if (_pitch_scales[index] > 0.0f) {
 			// A negative change in pitch will increase saturation
 			_saturation_status.flags.pitch_neg = true;
 
-		} else if (_rotors[index].pitch_scale < 0.0f) {
+		} else if (_pitch_scales[index] < 0.0f) {
 			// A positive change in pitch will increase saturation
 			_saturation_status.flags.pitch_pos = true;
 		}
 
 		// check if the yaw input is saturating
-		if (_rotors[index].yaw_scale > 0.0f) {
+		if (_yaw_scales[index] > 0.0f) {
 			// A negative change in yaw will increase saturation
 			_saturation_status.flags.yaw_neg = true;
 
-		} else if (_rotors[index].yaw_scale < 0.0f) {
+		} else if (_yaw_scales[index] < 0.0f) {
 			// A positive change in yaw will increase saturation
 			_saturation_status.flags.yaw_pos = true;
 		}
@@ -34,6 +34,11 @@
 /**
  * testing binary that runs the multirotor mixer through test cases given
  * via file or stdin and compares the mixer output against expected values.
+ *
+ * When built with MIXER_MULTIROTOR_BENCHMARK (make benchmark), --benchmark
+ * compares and times the mixer against the array-of-structs reference
+ * implementation for all geometries and airmodes, once with demands around
+ * hover and once with random demands over the full range.
  */
 
 #include "mixer.h"
@@ -55,8 +60,405 @@ mixer_callback(uintptr_t handle, uint8_t control_group, uint8_t control_index, f
 	return 0;
 }
 
+#ifdef MIXER_MULTIROTOR_BENCHMARK
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+
+#include <mathlib/mathlib.h>
+
+// geometry tables, the same the mixer is built with
+#include "mixer_multirotor_normalized.generated.h"
+
+/**
+ * Multirotor mixer as implemented before the structure-of-arrays kernels, iterating over the
+ * array of rotor structs once per step. Used as the reference for the outputs and timing.
+ * Configured like the testing constructor (no idle speed, thrust model or slew rate).
+ * Like MultirotorMixer, it reads the controls through Mixer::get_control(), so that only
+ * the mixing itself differs between the two.
+ */
+class ReferenceMultirotorMixer : public Mixer
+{
+public:
+	ReferenceMultirotorMixer(const MultirotorMixer::Rotor *rotors, unsigned rotor_count, Mixer::Airmode airmode) :
+		Mixer(mixer_callback, 0), _rotors(rotors), _rotor_count(rotor_count), _airmode(airmode) {}
+
+	unsigned mix(float *outputs, unsigned space) override
+	{
+		float roll    = math::constrain(get_control(0, 0), -1.0f, 1.0f);
+		float pitch   = math::constrain(get_control(0, 1), -1.0f, 1.0f);
+		float yaw     = math::constrain(get_control(0, 2), -1.0f, 1.0f);
+		float thrust  = math::constrain(get_control(0, 3), 0.0f, 1.0f);
+
+		_saturation_status.value = 0;
+
+		switch (_airmode) {
+		case Mixer::Airmode::roll_pitch:
+			mix_airmode_rp(roll, pitch, yaw, thrust, outputs);
+			break;
+
+		case Mixer::Airmode::roll_pitch_yaw:
+			mix_airmode_rpy(roll, pitch, yaw, thrust, outputs);
+			break;
+
+		default:
+			mix_airmode_disabled(roll, pitch, yaw, thrust, outputs);
+			break;
+		}
+
+		for (unsigned i = 0; i < _rotor_count; i++) {
+			if (_thrust_factor > 0.0f) {
+				outputs[i] = -(1.0f - _thrust_factor) / (2.0f * _thrust_factor) + sqrtf((1.0f - _thrust_factor) *
+						(1.0f - _thrust_factor) / (4.0f * _thrust_factor * _thrust_factor) + (outputs[i] < 0.0f ? 0.0f : outputs[i] /
+								_thrust_factor));
+			}
+
+			outputs[i] = math::constrain(_idle_speed + (outputs[i] * (1.0f - _idle_speed)), _idle_speed, 1.0f);
+		}
+
+		for (unsigned i = 0; i < _rotor_count; i++) {
+			bool clipping_high = false;
+			bool clipping_low = false;
+
+			if (outputs[i] > 0.99f) {
+				clipping_high = true;
+
+			} else if (outputs[i] < _idle_speed + 0.01f) {
+				clipping_low = true;
+			}
+
+			if (_delta_out_max > 0.0f) {
+				float delta_out = outputs[i] - _outputs_prev[i];
+
+				if (delta_out > _delta_out_max) {
+					outputs[i] = _outputs_prev[i] + _delta_out_max;
+					clipping_high = true;
+
+				} else if (delta_out < -_delta_out_max) {
+					outputs[i] = _outputs_prev[i] - _delta_out_max;
+					clipping_low = true;
+				}
+			}
+
+			_outputs_prev[i] = outputs[i];
+			update_saturation_status(i, clipping_high, clipping_low);
+		}
+
+		_delta_out_max = 0.0f;
+
+		return _rotor_count;
+	}
+
+	uint16_t get_saturation_status() override { return _saturation_status.value; }
+	void groups_required(uint32_t &groups) override { groups |= 1; }
+	unsigned set_trim(float trim) override { return _rotor_count; }
+	unsigned get_trim(float *trim) override { return _rotor_count; }
+
+private:
+	float compute_desaturation_gain(const float *desaturation_vector, const float *outputs, float min_output,
+					float max_output)
+	{
+		float k_min = 0.f;
+		float k_max = 0.f;
+
+		for (unsigned i = 0; i < _rotor_count; i++) {
+			if (fabsf(desaturation_vector[i]) < FLT_EPSILON) {
+				continue;
+			}
+
+			if (outputs[i] < min_output) {
+				float k = (min_output - outputs[i]) / desaturation_vector[i];
+
+				if (k < k_min) { k_min = k; }
+
+				if (k > k_max) { k_max = k; }
+
+				_saturation_status.flags.motor_neg = true;
+			}
+
+			if (outputs[i] > max_output) {
+				float k = (max_output - outputs[i]) / desaturation_vector[i];
+
+				if (k < k_min) { k_min = k; }
+
+				if (k > k_max) { k_max = k; }
+
+				_saturation_status.flags.motor_pos = true;
+			}
+		}
+
+		return k_min + k_max;
+	}
+
+	void minimize_saturation(const float *desaturation_vector, float *outputs, float min_output = 0.f,
+				 float max_output = 1.f, bool reduce_only = false)
+	{
+		float k1 = compute_desaturation_gain(desaturation_vector, outputs, min_output, max_output);
+
+		if (reduce_only && k1 > 0.f) {
+			return;
+		}
+
+		for (unsigned i = 0; i < _rotor_count; i++) {
+			outputs[i] += k1 * desaturation_vector[i];
+		}
+
+		float k2 = 0.5f * compute_desaturation_gain(desaturation_vector, outputs, min_output, max_output);
+
+		for (unsigned i = 0; i < _rotor_count; i++) {
+			outputs[i] += k2 * desaturation_vector[i];
+		}
+	}
+
+	void mix_airmode_rp(float roll, float pitch, float yaw, float thrust, float *outputs)
+	{
+		for (unsigned i = 0; i < _rotor_count; i++) {
+			outputs[i] = roll * _rotors[i].roll_scale +
+				     pitch * _rotors[i].pitch_scale +
+				     thrust * _rotors[i].thrust_scale;
+			_tmp_array[i] = _rotors[i].thrust_scale;
+		}
+
+		minimize_saturation(_tmp_array, outputs);
+		mix_yaw(yaw, outputs);
+	}
+
+	void mix_airmode_rpy(float roll, float pitch, float yaw, float thrust, float *outputs)
+	{
+		for (unsigned i = 0; i < _rotor_count; i++) {
+			outputs[i] = roll * _rotors[i].roll_scale +
+				     pitch * _rotors[i].pitch_scale +
+				     yaw * _rotors[i].yaw_scale +
+				     thrust * _rotors[i].thrust_scale;
+			_tmp_array[i] = _rotors[i].thrust_scale;
+		}
+
+		minimize_saturation(_tmp_array, outputs);
+	}
+
+	void mix_airmode_disabled(float roll, float pitch, float yaw, float thrust, float *outputs)
+	{
+		for (unsigned i = 0; i < _rotor_count; i++) {
+			outputs[i] = roll * _rotors[i].roll_scale +
+				     pitch * _rotors[i].pitch_scale +
+				     thrust * _rotors[i].thrust_scale;
+			_tmp_array[i] = _rotors[i].thrust_scale;
+		}
+
+		minimize_saturation(_tmp_array, outputs, 0.f, 1.f, true);
+
+		for (unsigned i = 0; i < _rotor_count; i++) {
+			_tmp_array[i] = _rotors[i].roll_scale;
+		}
+
+		minimize_saturation(_tmp_array, outputs);
+
+		for (unsigned i = 0; i < _rotor_count; i++) {
+			_tmp_array[i] = _rotors[i].pitch_scale;
+		}
+
+		minimize_saturation(_tmp_array, outputs);
+		mix_yaw(yaw, outputs);
+	}
+
+	void mix_yaw(float yaw, float *outputs)
+	{
+		for (unsigned i = 0; i < _rotor_count; i++) {
+			outputs[i] += yaw * _rotors[i].yaw_scale;
+			_tmp_array[i] = _rotors[i].yaw_scale;
+		}
+
+		minimize_saturation(_tmp_array, outputs, 0.f, 1.15f);
+
+		for (unsigned i = 0; i < _rotor_count; i++) {
+			_tmp_array[i] = _rotors[i].thrust_scale;
+		}
+
+		minimize_saturation(_tmp_array, outputs, 0.f, 1.f, true);
+	}
+
+	void update_saturation_status(unsigned index, bool clipping_high, bool clipping_low)
+	{
+		const MultirotorMixer::Rotor &rotor = _rotors[index];
+
+		if (clipping_high) {
+			if (rotor.roll_scale > 0.0f) { _saturation_status.flags.roll_pos = true; }
+
+			else if (rotor.roll_scale < 0.0f) { _saturation_status.flags.roll_neg = true; }
+
+			if (rotor.pitch_scale > 0.0f) { _saturation_status.flags.pitch_pos = true; }
+
+			else if (rotor.pitch_scale < 0.0f) { _saturation_status.flags.pitch_neg = true; }
+
+			if (rotor.yaw_scale > 0.0f) { _saturation_status.flags.yaw_pos = true; }
+
+			else if (rotor.yaw_scale < 0.0f) { _saturation_status.flags.yaw_neg = true; }
+
+			_saturation_status.flags.thrust_pos = true;
+		}
+
+		if (clipping_low) {
+			if (rotor.roll_scale > 0.0f) { _saturation_status.flags.roll_neg = true; }
+
+			else if (rotor.roll_scale < 0.0f) { _saturation_status.flags.roll_pos = true; }
+
+			if (rotor.pitch_scale > 0.0f) { _saturation_status.flags.pitch_neg = true; }
+
+			else if (rotor.pitch_scale < 0.0f) { _saturation_status.flags.pitch_pos = true; }
+
+			if (rotor.yaw_scale > 0.0f) { _saturation_status.flags.yaw_neg = true; }
+
+			else if (rotor.yaw_scale < 0.0f) { _saturation_status.flags.yaw_pos = true; }
+
+			_saturation_status.flags.thrust_neg = true;
+		}
+
+		_saturation_status.flags.valid = true;
+	}
+
+	const MultirotorMixer::Rotor *_rotors;
+	unsigned _rotor_count;
+	Mixer::Airmode _airmode;
+	MultirotorMixer::saturation_status _saturation_status {};
+	float _idle_speed{0.f};
+	float _thrust_factor{0.f};
+	float _delta_out_max{0.f};
+	float _outputs_prev[output_max] {};
+	float _tmp_array[output_max] {};
+};
+
+static constexpr int num_benchmark_inputs = 100000;
+static float benchmark_inputs[num_benchmark_inputs][4];
+
+/**
+ * Compare and time the mixer against the reference for all geometries and airmodes.
+ * @param hover true for small demands around hover thrust, false for random demands over the full range
+ * @return number of failed comparisons
+ */
+static int run_benchmark(bool hover)
+{
+	const Mixer::Airmode airmodes[] = {Mixer::Airmode::disabled, Mixer::Airmode::roll_pitch, Mixer::Airmode::roll_pitch_yaw};
+	const char *airmode_names[] = {"none", "rp", "rpy"};
+
+	int num_failed = 0;
+	volatile float sink = 0.f;
+
+	printf("%s inputs\n", hover ? "hover" : "full-scale");
+	printf("geometry airmode  reference [ns]  mixer [ns]  max diff  not bit-identical\n");
+
+	for (unsigned geometry = 0; geometry < (unsigned)MultirotorGeometry::MAX_GEOMETRY; geometry++) {
+		const MultirotorMixer::Rotor *rotors = _config_index[geometry];
+		const unsigned rotor_count = _config_rotor_count[geometry];
+
+		srand(geometry);
+
+		for (int i = 0; i < num_benchmark_inputs; i++) {
+			if (hover) {
+				// attitude corrections of a few percent around hover thrust, no motor saturates
+				for (int axis = 0; axis < 3; axis++) {
+					benchmark_inputs[i][axis] = 0.1f * rand() / (float)RAND_MAX - 0.05f;
+				}
+
+				benchmark_inputs[i][3] = 0.4f + 0.2f * rand() / (float)RAND_MAX;
+
+			} else {
+				// random demands, including some beyond the limits of the motors
+				for (int axis = 0; axis < 3; axis++) {
+					benchmark_inputs[i][axis] = 2.f * rand() / (float)RAND_MAX - 1.f;
+				}
+
+				benchmark_inputs[i][3] = rand() / (float)RAND_MAX;
+			}
+		}
+
+		for (unsigned mode = 0; mode < sizeof(airmodes) / sizeof(airmodes[0]); mode++) {
+			MultirotorMixer mixer(mixer_callback, 0, rotors, rotor_count);
+			mixer.set_airmode(airmodes[mode]);
+			ReferenceMultirotorMixer reference(rotors, rotor_count, airmodes[mode]);
+
+			float outputs[output_max];
+			float reference_outputs[output_max];
+			float max_diff = 0.f;
+			int not_identical = 0;
+			bool failed = false;
+
+			for (int i = 0; i < num_benchmark_inputs; i++) {
+				memcpy(actuator_controls, benchmark_inputs[i], sizeof(benchmark_inputs[i]));
+				mixer.mix(outputs, output_max);
+				reference.mix(reference_outputs, output_max);
+
+				if (memcmp(outputs, reference_outputs, rotor_count * sizeof(float)) != 0) {
+					++not_identical;
+				}
+
+				for (unsigned j = 0; j < rotor_count; j++) {
+					max_diff = math::max(max_diff, fabsf(outputs[j] - reference_outputs[j]));
+				}
+
+				if (mixer.get_saturation_status() != reference.get_saturation_status()) {
+					failed = true;
+				}
+			}
+
+			// alternate between the two and keep the fastest run of each, to reduce the influence
+			// of the order of the runs and of other load on the machine
+			double reference_ns = 1e9;
+			double mixer_ns = 1e9;
+
+			for (int run = 0; run < 5; run++) {
+				auto start = std::chrono::steady_clock::now();
+
+				for (int i = 0; i < num_benchmark_inputs; i++) {
+					memcpy(actuator_controls, benchmark_inputs[i], sizeof(benchmark_inputs[i]));
+					reference.mix(reference_outputs, output_max);
+					sink = sink + reference_outputs[0];
+				}
+
+				auto middle = std::chrono::steady_clock::now();
+
+				for (int i = 0; i < num_benchmark_inputs; i++) {
+					memcpy(actuator_controls, benchmark_inputs[i], sizeof(benchmark_inputs[i]));
+					mixer.mix(outputs, output_max);
+					sink = sink + outputs[0];
+				}
+
+				auto end = std::chrono::steady_clock::now();
+
+				reference_ns = math::min(reference_ns, std::chrono::duration<double, std::nano>(middle - start).count());
+				mixer_ns = math::min(mixer_ns, std::chrono::duration<double, std::nano>(end - middle).count());
+			}
+
+			if (max_diff > 0.00001f) {
+				failed = true;
+			}
+
+			printf("%-8s %-7s  %14.1f  %10.1f  %8.2g  %17i%s\n", _config_key[geometry], airmode_names[mode],
+			       reference_ns / num_benchmark_inputs, mixer_ns / num_benchmark_inputs,
+			       (double)max_diff, not_identical, failed ? "  FAILED" : "");
+
+			if (failed) {
+				++num_failed;
+			}
+		}
+	}
+
+	return num_failed;
+}
+
+#endif /* MIXER_MULTIROTOR_BENCHMARK */
+
 int main(int argc, char *argv[])
 {
+#ifdef MIXER_MULTIROTOR_BENCHMARK
+
+	if (argc > 1 && strcmp(argv[1], "--benchmark") == 0) {
+		const int num_failed = run_benchmark(true) + run_benchmark(false);
+		return num_failed > 0 ? -1 : 0;
+	}
+
+#endif /* MIXER_MULTIROTOR_BENCHMARK */
+
 	FILE *file_in = stdin;
 	FILE *file_out = stdout;
 
@@ -228,6 +228,14 @@ __EXPORT extern void		perf_reset_all(void);
  */
 __EXPORT extern uint64_t	perf_event_count(perf_counter_t handle);
 
+/**
+ * Return the mean elapsed time (PC_ELAPSED) or interval (PC_INTERVAL)
+ *
+ * @param handle		The counter returned from perf_alloc.
+ * @return			mean in seconds, 0 for other counter types
+ */
+__EXPORT extern float		perf_mean(perf_counter_t handle);
+
 __END_DECLS
 
 #endif
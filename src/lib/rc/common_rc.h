@@ -13,10 +13,15 @@
 typedef  struct rc_decode_buf_ {
 	union {
 		crsf_frame_t crsf_frame;
-		dsm_decode_t dsm;
 		sbus_frame_t sbus_frame;
-		ReceiverFcPacket _strxpacket;
-		ReceiverFcPacketHoTT _hottrxpacket;
+
+		/* DSM, ST24 and SUMD share the serial port configuration and can be
+		 * decoded in parallel over the same bytes, so they need separate storage */
+		struct {
+			dsm_decode_t dsm;
+			ReceiverFcPacket _strxpacket;
+			ReceiverFcPacketHoTT _hottrxpacket;
+		} serial;
 	};
 } rc_decode_buf_t;
 #pragma pack(pop)
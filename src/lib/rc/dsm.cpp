@@ -70,8 +70,8 @@ static enum DSM_DECODE_STATE {
 static int dsm_fd = -1;						/**< File handle to the DSM UART */
 static hrt_abstime dsm_last_rx_time;            /**< Timestamp when we last received data */
 static hrt_abstime dsm_last_frame_time;		/**< Timestamp for start of last valid dsm frame */
-static dsm_frame_t &dsm_frame = rc_decode_buf.dsm.frame;	/**< DSM_BUFFER_SIZE DSM dsm frame receive buffer */
-static dsm_buf_t &dsm_buf = rc_decode_buf.dsm.buf;	/**< DSM_BUFFER_SIZE DSM dsm frame receive buffer */
+static dsm_frame_t &dsm_frame = rc_decode_buf.serial.dsm.frame;	/**< DSM_BUFFER_SIZE DSM dsm frame receive buffer */
+static dsm_buf_t &dsm_buf = rc_decode_buf.serial.dsm.buf;	/**< DSM_BUFFER_SIZE DSM dsm frame receive buffer */
 
 static uint16_t dsm_chan_buf[DSM_MAX_CHANNEL_COUNT];
 static unsigned dsm_partial_frame_count;	/**< Count of bytes received for current dsm frame */
@@ -684,8 +684,10 @@ dsm_parse(const uint64_t now, const uint8_t *frame, const unsigned len, uint16_t
 		switch (dsm_decode_state) {
 		case DSM_DECODE_STATE_DESYNC:
 
-			/* we are de-synced and only interested in the frame marker */
-			if ((now - dsm_last_rx_time) > 5000) {
+			/* we are de-synced and only interested in the frame marker.
+			 * All bytes of a buffer share the same timestamp, so only the first
+			 * byte can follow an inter-frame gap. */
+			if (d == 0 && (now - dsm_last_rx_time) > 5000) {
 				dsm_decode_state = DSM_DECODE_STATE_SYNC;
 				dsm_partial_frame_count = 0;
 				dsm_chan_count = 0;
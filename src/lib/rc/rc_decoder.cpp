@@ -0,0 +1,292 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2018 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+/**
+ * @file rc_decoder.cpp
+ *
+ * Protocol independent front-end for the serial RC decoders.
+ */
+
+#include "rc_decoder.h"
+
+#include <px4_defines.h>
+#include <px4_log.h>
+
+#include "crsf.h"
+#include "dsm.h"
+#include "sbus.h"
+#include "st24.h"
+#include "sumd.h"
+
+static bool parse_sbus(hrt_abstime now, const uint8_t *buf, unsigned len, RCDecoder::Frame &frame)
+{
+	// sbus_parse() does not modify the input, it is just not declared const
+	return sbus_parse(now, const_cast<uint8_t *>(buf), len, frame.values, &frame.channel_count, &frame.failsafe,
+			  &frame.frame_drop, &frame.frame_drops, RCDecoder::MAX_CHANNELS);
+}
+
+static bool parse_dsm(hrt_abstime now, const uint8_t *buf, unsigned len, RCDecoder::Frame &frame)
+{
+	int8_t rssi;
+
+	if (dsm_parse(now, buf, len, frame.values, &frame.channel_count, &frame.dsm_11_bit, &frame.frame_drops, &rssi,
+		      RCDecoder::MAX_CHANNELS)) {
+		frame.rssi = rssi;
+		return true;
+	}
+
+	return false;
+}
+
+static bool parse_st24(hrt_abstime now, const uint8_t *buf, unsigned len, RCDecoder::Frame &frame)
+{
+	bool decoded = false;
+	uint8_t rssi;
+	uint8_t lost_count;
+
+	for (unsigned i = 0; i < len; i++) {
+		if (st24_decode(buf[i], &rssi, &lost_count, &frame.channel_count, frame.values, RCDecoder::MAX_CHANNELS) == OK) {
+			// The st24 will keep outputting RC channels and RSSI even if RC has been lost.
+			// The only way to detect RC loss is therefore to look at the lost_count.
+			frame.rssi = rssi;
+			frame.rc_lost = (lost_count > 0);
+			decoded = true;
+		}
+	}
+
+	return decoded;
+}
+
+static bool parse_sumd(hrt_abstime now, const uint8_t *buf, unsigned len, RCDecoder::Frame &frame)
+{
+	bool decoded = false;
+	uint8_t rssi;
+	uint8_t rx_count;
+
+	for (unsigned i = 0; i < len; i++) {
+		if (sumd_decode(buf[i], &rssi, &rx_count, &frame.channel_count, frame.values, RCDecoder::MAX_CHANNELS,
+				&frame.failsafe) == OK) {
+			frame.rssi = rssi;
+			decoded = true;
+		}
+	}
+
+	return decoded;
+}
+
+static bool parse_crsf(hrt_abstime now, const uint8_t *buf, unsigned len, RCDecoder::Frame &frame)
+{
+	return crsf_parse(now, buf, len, frame.values, &frame.channel_count, RCDecoder::MAX_CHANNELS);
+}
+
+const RCDecoder::ProtocolDecoder RCDecoder::_decoders[] = {
+	{ Protocol::SBUS, "SBUS", PortConfig::SBUS,   nullptr,        parse_sbus },
+	{ Protocol::DSM,  "DSM",  PortConfig::Serial, dsm_proto_init, parse_dsm },
+	{ Protocol::ST24, "ST24", PortConfig::Serial, nullptr,        parse_st24 },
+	{ Protocol::SUMD, "SUMD", PortConfig::Serial, nullptr,        parse_sumd },
+	{ Protocol::CRSF, "CRSF", PortConfig::CRSF,   nullptr,        parse_crsf },
+};
+
+const char *RCDecoder::protocol_name(Protocol protocol)
+{
+	for (const ProtocolDecoder &decoder : _decoders) {
+		if (decoder.protocol == protocol) {
+			return decoder.name;
+		}
+	}
+
+	return "none";
+}
+
+RCDecoder::PortConfig RCDecoder::protocol_port_config(Protocol protocol)
+{
+	for (const ProtocolDecoder &decoder : _decoders) {
+		if (decoder.protocol == protocol) {
+			return decoder.port;
+		}
+	}
+
+	return PortConfig::SBUS;
+}
+
+void RCDecoder::set_port_config(PortConfig port)
+{
+	_port = port;
+	reset();
+}
+
+void RCDecoder::reset()
+{
+	_locked = Protocol::None;
+	_candidate = Protocol::None;
+	_candidate_frames = 0;
+	_detect_start = 0;
+	_lock_time = 0;
+
+	_last_frame = 0;
+	_frames = 0;
+	_rejected_frames = 0;
+	_interval_sum = 0;
+	_interval_max = 0;
+	_decode_time_sum = 0;
+	_decode_count = 0;
+	_decode_time_max = 0;
+
+	reset_decoders();
+}
+
+void RCDecoder::reset_decoders()
+{
+	for (const ProtocolDecoder &decoder : _decoders) {
+		if (decoder.port == _port && decoder.reset) {
+			decoder.reset();
+		}
+	}
+}
+
+RCDecoder::Protocol RCDecoder::parse(hrt_abstime now, const uint8_t *buf, unsigned len, Frame &frame)
+{
+	if (len == 0) {
+		return Protocol::None;
+	}
+
+	const hrt_abstime decode_start = hrt_absolute_time();
+
+	if (_detect_start == 0) {
+		_detect_start = now;
+	}
+
+	// a single protocol on the port can lock on the first frame
+	unsigned candidates = 0;
+
+	for (const ProtocolDecoder &decoder : _decoders) {
+		if (decoder.port == _port) {
+			++candidates;
+		}
+	}
+
+	const unsigned lock_frames = candidates > 1 ? LOCK_FRAMES : 1;
+
+	Protocol decoded = Protocol::None;
+
+	for (const ProtocolDecoder &decoder : _decoders) {
+		if (decoder.port != _port || (_locked != Protocol::None && decoder.protocol != _locked)) {
+			continue;
+		}
+
+		_scratch.rssi = -1;
+		_scratch.failsafe = false;
+		_scratch.frame_drop = false;
+		_scratch.rc_lost = false;
+
+		if (!decoder.parse(now, buf, len, _scratch)) {
+			continue;
+		}
+
+		if (_locked == Protocol::None) {
+			if (decoder.protocol == _candidate) {
+				++_candidate_frames;
+
+			} else {
+				_candidate = decoder.protocol;
+				_candidate_frames = 1;
+			}
+
+			if (_candidate_frames < lock_frames) {
+				++_rejected_frames;
+				continue;
+			}
+
+			_locked = decoder.protocol;
+			_lock_time = now;
+		}
+
+		frame = _scratch;
+		decoded = decoder.protocol;
+	}
+
+	update_stats(decoded != Protocol::None ? now : 0, decode_start);
+
+	return decoded;
+}
+
+void RCDecoder::update_stats(hrt_abstime frame_time, hrt_abstime decode_start)
+{
+	const hrt_abstime decode_time = hrt_absolute_time() - decode_start;
+
+	_decode_time_sum += decode_time;
+	++_decode_count;
+
+	if (decode_time > _decode_time_max) {
+		_decode_time_max = decode_time;
+	}
+
+	if (frame_time == 0) {
+		return;
+	}
+
+	if (_last_frame != 0) {
+		const hrt_abstime interval = frame_time - _last_frame;
+		_interval_sum += interval;
+
+		if (interval > _interval_max) {
+			_interval_max = interval;
+		}
+	}
+
+	_last_frame = frame_time;
+	++_frames;
+}
+
+void RCDecoder::print_status() const
+{
+	static constexpr const char *port_names[] = {"SBUS", "serial 115200", "CRSF"};
+
+	PX4_INFO("RC decoder: port %s, protocol %s", port_names[(int)_port], protocol_name(_locked));
+
+	if (_locked != Protocol::None) {
+		PX4_INFO("lock latency: %.1f ms (%u frames decoded before)",
+			 (double)(lock_latency() / 1e3f), _rejected_frames);
+	}
+
+	if (_frames > 1) {
+		PX4_INFO("frames: %u, interval mean %.2f ms, max %.2f ms", _frames,
+			 (double)(_interval_sum / (_frames - 1) / 1e3f), (double)(_interval_max / 1e3f));
+	}
+
+	if (_decode_count > 0) {
+		PX4_INFO("decode time: mean %.1f us, max %u us per buffer", (double)((float)_decode_time_sum / _decode_count),
+			 (unsigned)_decode_time_max);
+	}
+}
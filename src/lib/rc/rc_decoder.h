@@ -0,0 +1,159 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2018 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+/**
+ * @file rc_decoder.h
+ *
+ * Protocol independent front-end for the serial RC decoders.
+ *
+ * Whole read buffers are passed to all decoders that can run with the
+ * current port configuration (baudrate, parity, inversion). The decoder
+ * locks onto the first protocol that returns consecutive valid frames and
+ * from then on only runs that one.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include <drivers/drv_hrt.h>
+
+class RCDecoder
+{
+public:
+	static constexpr unsigned MAX_CHANNELS = 18;
+
+	/** number of consecutive valid frames needed to lock onto a protocol */
+	static constexpr unsigned LOCK_FRAMES = 3;
+
+	enum class Protocol : uint8_t {
+		None = 0,
+		SBUS,
+		DSM,
+		ST24,
+		SUMD,
+		CRSF
+	};
+
+	/** serial port configurations, only protocols sharing one can be decoded in parallel */
+	enum class PortConfig : uint8_t {
+		SBUS = 0,	///< 100000 baud 8E2, inverted
+		Serial,		///< 115200 baud 8N1 (DSM, ST24, SUMD)
+		CRSF		///< 420000 baud 8N1
+	};
+
+	struct Frame {
+		uint16_t values[MAX_CHANNELS];
+		uint16_t channel_count;
+		int rssi;		///< RSSI in percent, -1 if not provided by the protocol
+		unsigned frame_drops;	///< total number of dropped frames reported by the protocol
+		bool failsafe;
+		bool frame_drop;
+		bool rc_lost;		///< the receiver reports a lost link, but still outputs values
+		bool dsm_11_bit;
+	};
+
+	RCDecoder() = default;
+
+	/**
+	 * Select the port configuration and restart the protocol detection.
+	 * The caller is responsible for configuring the serial port itself.
+	 */
+	void set_port_config(PortConfig port);
+
+	PortConfig port_config() const { return _port; }
+
+	/**
+	 * Drop the protocol lock and start detecting again on the current port configuration.
+	 */
+	void reset();
+
+	/**
+	 * Parse a buffer of received bytes.
+	 * @param now time at which the bytes were received
+	 * @param buf received bytes
+	 * @param len number of bytes in buf
+	 * @param frame set to the last decoded frame, if any
+	 * @return the protocol of the decoded frame, or Protocol::None if no frame (from the locked protocol) was decoded
+	 */
+	Protocol parse(hrt_abstime now, const uint8_t *buf, unsigned len, Frame &frame);
+
+	/** locked protocol, Protocol::None while still detecting */
+	Protocol locked() const { return _locked; }
+
+	/** time it took from the first received byte until the lock, 0 if not locked */
+	hrt_abstime lock_latency() const { return _locked != Protocol::None ? _lock_time - _detect_start : 0; }
+
+	static const char *protocol_name(Protocol protocol);
+
+	/** port configuration a protocol needs */
+	static PortConfig protocol_port_config(Protocol protocol);
+
+	void print_status() const;
+
+private:
+	struct ProtocolDecoder {
+		Protocol protocol;
+		const char *name;
+		PortConfig port;
+		void (*reset)();
+		bool (*parse)(hrt_abstime now, const uint8_t *buf, unsigned len, Frame &frame);
+	};
+
+	static const ProtocolDecoder _decoders[];
+
+	void reset_decoders();
+	void update_stats(hrt_abstime now, hrt_abstime decode_start);
+
+	PortConfig _port{PortConfig::SBUS};
+	Protocol _locked{Protocol::None};
+
+	Protocol _candidate{Protocol::None};	///< protocol with the most recent valid frame while detecting
+	unsigned _candidate_frames{0};
+
+	Frame _scratch{};			///< per-decoder output, the decoders must not overwrite each other
+
+	hrt_abstime _detect_start{0};
+	hrt_abstime _lock_time{0};
+
+	/* statistics since the last lock */
+	hrt_abstime _last_frame{0};
+	unsigned _frames{0};
+	unsigned _rejected_frames{0};		///< valid frames (of any protocol) seen before the lock
+	uint64_t _interval_sum{0};
+	hrt_abstime _interval_max{0};
+	uint64_t _decode_time_sum{0};
+	unsigned _decode_count{0};
+	hrt_abstime _decode_time_max{0};
+};
@@ -14,6 +14,7 @@
 #include <lib/rc/st24.h>
 #include <lib/rc/sumd.h>
 #include <lib/rc/crsf.h>
+#include <lib/rc/rc_decoder.h>
 
 #if defined(CONFIG_ARCH_BOARD_PX4_SITL)
 #define TEST_DATA_PATH "./test_data/"
@@ -36,6 +37,43 @@ private:
 	bool sbus2Test();
 	bool st24Test();
 	bool sumdTest();
+	bool decoderTest();
+	bool decoderCrsfTest();
+	bool decoderBenchmark();
+
+	struct Recording {
+		const char *filepath;
+		RCDecoder::PortConfig port;
+		RCDecoder::Protocol protocol;
+	};
+
+	static const Recording _recordings[];
+
+	struct DecoderRun {
+		RCDecoder::Protocol locked;
+		unsigned frames;
+		hrt_abstime lock_latency;
+		hrt_abstime latency_sum;	///< time from the last byte of a frame until the buffer is passed to the decoder
+		hrt_abstime latency_max;
+		hrt_abstime decode_time;
+		unsigned bytes;
+	};
+
+	/**
+	 * Feed a recording into the decoder in blocks, as a driver reading the UART every window us would.
+	 * The bytes of a block are delivered at the end of the window, window = 0 delivers every byte on its own.
+	 */
+	bool decodeRecording(const char *filepath, RCDecoder::PortConfig port, hrt_abstime window, DecoderRun &run);
+
+	RCDecoder _decoder;
+};
+
+const RCTest::Recording RCTest::_recordings[] = {
+	{ TEST_DATA_PATH "dsm_x_data.txt",      RCDecoder::PortConfig::Serial, RCDecoder::Protocol::DSM },
+	{ TEST_DATA_PATH "dsm_x_dx9_data.txt",  RCDecoder::PortConfig::Serial, RCDecoder::Protocol::DSM },
+	{ TEST_DATA_PATH "sbus2_r7008SB.txt",   RCDecoder::PortConfig::SBUS,   RCDecoder::Protocol::SBUS },
+	{ TEST_DATA_PATH "st24_data.txt",       RCDecoder::PortConfig::Serial, RCDecoder::Protocol::ST24 },
+	{ TEST_DATA_PATH "sumd_data.txt",       RCDecoder::PortConfig::Serial, RCDecoder::Protocol::SUMD },
 };
 
 bool RCTest::run_tests()
@@ -46,6 +84,9 @@ bool RCTest::run_tests()
 	ut_run_test(sbus2Test);
 	ut_run_test(st24Test);
 	ut_run_test(sumdTest);
+	ut_run_test(decoderTest);
+	ut_run_test(decoderCrsfTest);
+	ut_run_test(decoderBenchmark);
 
 	return (_tests_failed == 0);
 }
@@ -414,7 +455,209 @@ bool RCTest::sumdTest()
 	return true;
 }
 
+bool RCTest::decodeRecording(const char *filepath, RCDecoder::PortConfig port, hrt_abstime window, DecoderRun &run)
+{
+	FILE *fp = fopen(filepath, "rt");
+	ut_test(fp);
+
+	// Trash the first 20 lines
+	for (unsigned i = 0; i < 20; i++) {
+		char buf[200];
+		(void)fgets(buf, sizeof(buf), fp);
+	}
+
+	memset(&run, 0, sizeof(run));
+	_decoder.set_port_config(port);
+
+	uint8_t block[64];
+	unsigned len = 0;
+	hrt_abstime block_end = 0;
+	hrt_abstime last_byte = 0;
+	RCDecoder::Frame frame;
+
+	auto deliver = [&]() {
+		const hrt_abstime decode_start = hrt_absolute_time();
+
+		if (_decoder.parse(block_end, block, len, frame) != RCDecoder::Protocol::None) {
+			const hrt_abstime latency = block_end - last_byte;
+			run.latency_sum += latency;
+
+			if (latency > run.latency_max) {
+				run.latency_max = latency;
+			}
+
+			++run.frames;
+		}
+
+		run.decode_time += hrt_absolute_time() - decode_start;
+		run.bytes += len;
+		len = 0;
+	};
+
+	double t;
+	unsigned x;
+	int ret;
+
+	while ((ret = fscanf(fp, "%lf,%x,,", &t, &x)) == 2) {
+		const hrt_abstime timestamp = t * 1e6;
+
+		if (len > 0 && (timestamp >= block_end || len == sizeof(block))) {
+			deliver();
+		}
+
+		if (len == 0) {
+			block_end = (window > 0) ? (timestamp / window + 1) * window : timestamp;
+		}
 
+		block[len++] = x;
+		last_byte = timestamp;
+	}
+
+	if (len > 0) {
+		deliver();
+	}
+
+	fclose(fp);
+
+	ut_test(ret == EOF);
+
+	run.locked = _decoder.locked();
+	run.lock_latency = _decoder.lock_latency();
+
+	return true;
+}
+
+bool RCTest::decoderTest()
+{
+	static constexpr hrt_abstime windows[] = { 1000, 4000 };
+
+	for (const Recording &recording : _recordings) {
+		DecoderRun reference;
+
+		// byte by byte, like the protocol specific tests
+		ut_test(decodeRecording(recording.filepath, recording.port, 0, reference));
+
+		if (reference.locked != recording.protocol) {
+			PX4_ERR("%s: locked onto %s", recording.filepath, RCDecoder::protocol_name(reference.locked));
+			ut_compare("Wrong protocol", (int)reference.locked, (int)recording.protocol);
+		}
+
+		ut_test(reference.frames > 0);
+
+		// reading whole buffers must neither lose nor invent frames
+		for (hrt_abstime window : windows) {
+			DecoderRun run;
+			ut_test(decodeRecording(recording.filepath, recording.port, window, run));
+			ut_compare("Wrong protocol", (int)run.locked, (int)recording.protocol);
+
+			if (run.frames != reference.frames) {
+				PX4_ERR("%s: %u frames with %u us blocks, %u byte by byte", recording.filepath, run.frames, (unsigned)window,
+					reference.frames);
+				ut_compare("Frame count", run.frames, reference.frames);
+			}
+		}
+	}
+
+	// nothing may be detected when the port configuration is wrong for the protocol
+	DecoderRun run;
+	ut_test(decodeRecording(TEST_DATA_PATH "sumd_data.txt", RCDecoder::PortConfig::CRSF, 1000, run));
+	ut_compare("Locked on the wrong port", (int)run.locked, (int)RCDecoder::Protocol::None);
+	ut_compare("Frames on the wrong port", run.frames, 0);
+
+	return true;
+}
+
+bool RCTest::decoderCrsfTest()
+{
+	const char *filepath = TEST_DATA_PATH "crsf_rc_channels.txt";
+
+	FILE *fp = fopen(filepath, "rt");
+	ut_test(fp);
+
+	_decoder.set_port_config(RCDecoder::PortConfig::CRSF);
+
+	const int line_size = 500;
+	char line[line_size];
+	RCDecoder::Frame frame{};
+	unsigned decoded_frames = 0;
+	unsigned expected_frames = 0;
+	hrt_abstime now = 0;
+
+	while (fgets(line, line_size, fp) != nullptr)  {
+
+		if (strncmp(line, "INPUT ", 6) == 0) {
+			const char *file_buffer = line + 6;
+			unsigned frame_len = 0;
+			uint8_t buf[300];
+			int offset;
+			int number;
+
+			while (sscanf(file_buffer, "%x, %n", &number, &offset) > 0 && frame_len < sizeof(buf)) {
+				buf[frame_len++] = number;
+				file_buffer += offset;
+			}
+
+			// the recording has no timestamps, CRSF sends RC channels at 150Hz
+			now += 6667;
+
+			if (_decoder.parse(now, buf, frame_len, frame) == RCDecoder::Protocol::CRSF) {
+				++decoded_frames;
+			}
+
+		} else if (strncmp(line, "DECODED ", 8) == 0) {
+			const char *file_buffer = line + 8;
+			int offset;
+			int expected_rc_value;
+			int channel = 0;
+
+			while (sscanf(file_buffer, "%x, %n", &expected_rc_value, &offset) > 0) {
+				if (channel < frame.channel_count) {
+					ut_test(abs(expected_rc_value - (int)frame.values[channel]) <= 10);
+				}
+
+				file_buffer += offset;
+				++channel;
+			}
+
+			ut_compare("Unexpected number of decoded channels", channel, frame.channel_count);
+			++expected_frames;
+		}
+	}
+
+	fclose(fp);
+
+	ut_compare("Wrong protocol", (int)_decoder.locked(), (int)RCDecoder::Protocol::CRSF);
+	ut_compare("Frame count", decoded_frames, expected_frames);
+
+	return true;
+}
+
+bool RCTest::decoderBenchmark()
+{
+	// 0: every byte on its own, then typical work queue and polling intervals
+	static constexpr hrt_abstime windows[] = { 0, 1000, 2000, 4000, 8000 };
+
+	PX4_INFO("%-22s %6s %7s %9s %10s %10s %11s", "recording", "window", "frames", "lock [ms]",
+		 "lat [ms]", "max [ms]", "[us/byte]");
+
+	for (const Recording &recording : _recordings) {
+		const char *name = strrchr(recording.filepath, '/');
+		name = name ? name + 1 : recording.filepath;
+
+		for (hrt_abstime window : windows) {
+			DecoderRun run;
+			ut_test(decodeRecording(recording.filepath, recording.port, window, run));
+
+			PX4_INFO("%-22s %6.1f %7u %9.1f %10.2f %10.2f %11.3f", name, (double)(window / 1e3f), run.frames,
+				 (double)(run.lock_latency / 1e3f),
+				 (double)(run.frames > 0 ? run.latency_sum / 1e3f / run.frames : 0.f),
+				 (double)(run.latency_max / 1e3f),
+				 (double)(run.bytes > 0 ? (float)run.decode_time / run.bytes : 0.f));
+		}
+	}
+
+	return true;
+}
 
 ut_declare_test_c(rc_tests_main, RCTest)
 
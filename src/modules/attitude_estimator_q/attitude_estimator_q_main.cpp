@@ -448,6 +448,8 @@ void AttitudeEstimatorQ::task_main()
 		if (update(dt)) {
 			vehicle_attitude_s att = {};
 			att.timestamp = sensors.timestamp;
+			/* sensor_combined is timestamped with the gyro sample time */
+			att.timestamp_sample = sensors.timestamp;
 			att.rollspeed = _rates(0);
 			att.pitchspeed = _rates(1);
 			att.yawspeed = _rates(2);
@@ -237,25 +237,66 @@ int sphere_fit_least_squares(const float x[], const float y[], const float z[],
 	return 0;
 }
 
+// Stop a Levenberg-Marquardt fit once a step improved the fitness by less than
+// the relative delta, or the damping grew by 1e8 without any improvement.
+// A delta of 0 never stops early.
+static bool lm_fit_converged(float prev_fitness, float fitness, int failed_steps, float delta)
+{
+	static constexpr int max_failed_steps = 8;
+
+	if (delta <= 0.0f) {
+		return false;
+	}
+
+	if (failed_steps >= max_failed_steps) {
+		return true;
+	}
+
+	return failed_steps == 0 && prev_fitness < 1.0e30f && (prev_fitness - fitness) < delta * fitness;
+}
+
 int ellipsoid_fit_least_squares(const float x[], const float y[], const float z[],
 				unsigned int size, int max_iterations, float delta, float *offset_x, float *offset_y, float *offset_z,
 				float *sphere_radius, float *diag_x, float *diag_y, float *diag_z, float *offdiag_x, float *offdiag_y, float *offdiag_z)
 {
 	float _fitness = 1.0e30f, _sphere_lambda = 1.0f, _ellipsoid_lambda = 1.0f;
+	int failed_steps = 0;
 
 	for (int i = 0; i < max_iterations; i++) {
-		run_lm_sphere_fit(x, y, z, _fitness, _sphere_lambda,
-				  size, offset_x, offset_y, offset_z,
-				  sphere_radius, diag_x, diag_y, diag_z, offdiag_x, offdiag_y, offdiag_z);
+		const float prev_fitness = _fitness;
 
+		if (run_lm_sphere_fit(x, y, z, _fitness, _sphere_lambda,
+				      size, offset_x, offset_y, offset_z,
+				      sphere_radius, diag_x, diag_y, diag_z, offdiag_x, offdiag_y, offdiag_z) == 0) {
+			failed_steps = 0;
+
+		} else {
+			failed_steps++;
+		}
+
+		if (lm_fit_converged(prev_fitness, _fitness, failed_steps, delta)) {
+			break;
+		}
 	}
 
 	_fitness = 1.0e30f;
+	failed_steps = 0;
 
 	for (int i = 0; i < max_iterations; i++) {
-		run_lm_ellipsoid_fit(x, y, z, _fitness, _ellipsoid_lambda,
-				     size, offset_x, offset_y, offset_z,
-				     sphere_radius, diag_x, diag_y, diag_z, offdiag_x, offdiag_y, offdiag_z);
+		const float prev_fitness = _fitness;
+
+		if (run_lm_ellipsoid_fit(x, y, z, _fitness, _ellipsoid_lambda,
+					 size, offset_x, offset_y, offset_z,
+					 sphere_radius, diag_x, diag_y, diag_z, offdiag_x, offdiag_y, offdiag_z) == 0) {
+			failed_steps = 0;
+
+		} else {
+			failed_steps++;
+		}
+
+		if (lm_fit_converged(prev_fitness, _fitness, failed_steps, delta)) {
+			break;
+		}
 	}
 
 	return 0;
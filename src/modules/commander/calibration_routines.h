@@ -57,6 +57,18 @@
 int sphere_fit_least_squares(const float x[], const float y[], const float z[],
 			     unsigned int size, unsigned int max_iterations, float delta, float *sphere_x, float *sphere_y, float *sphere_z,
 			     float *sphere_radius);
+/**
+ * Levenberg-Marquardt fit of a sphere, then of an ellipsoid to a set of points.
+ *
+ * The offset, radius and ellipsoid parameters are used as the starting point
+ * and hold the result.
+ *
+ * @param max_iterations maximum iterations of each of the two fits
+ * @param delta stop a fit once an iteration improves the fitness by less than this fraction.
+ *              If unsure, set to 0 to run max_iterations times.
+ *
+ * @return 0 on success
+ */
 int ellipsoid_fit_least_squares(const float x[], const float y[], const float z[],
 				unsigned int size, int max_iterations, float delta, float *offset_x, float *offset_y, float *offset_z,
 				float *sphere_radius, float *diag_x, float *diag_y, float *diag_z, float *offdiag_x, float *offdiag_y,
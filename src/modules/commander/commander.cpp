@@ -67,6 +67,7 @@
 #include <drivers/drv_tone_alarm.h>
 #include <geo/geo.h>
 #include <navigator/navigation.h>
+#include <perf/perf_counter.h>
 #include <px4_defines.h>
 #include <px4_config.h>
 #include <px4_posix.h>
@@ -139,7 +140,7 @@ typedef enum VEHICLE_MODE_FLAG
 static constexpr uint8_t COMMANDER_MAX_GPS_NOISE = 60;		/**< Maximum percentage signal to noise ratio allowed for GPS reception */
 
 /* Decouple update interval and hysteresis counters, all depends on intervals */
-#define COMMANDER_MONITORING_INTERVAL 10000
+#define COMMANDER_MONITORING_INTERVAL 10000	/**< interval of the periodic checks, the loop also wakes up on state driving topic updates */
 #define COMMANDER_MONITORING_LOOPSPERMSEC (1/(COMMANDER_MONITORING_INTERVAL/1000.0f))
 
 #define MAVLINK_OPEN_INTERVAL 50000
@@ -247,6 +248,8 @@ static uint8_t main_state_prev = 0;
 static bool warning_action_on = false;
 static bool last_overload = false;
 
+static perf_counter_t _cmd_latency_perf = nullptr;	///< time from command publication to its acknowledgement
+
 static struct status_flags_s status_flags = {};
 
 static uint64_t rc_signal_lost_timestamp;		// Time at which the RC reception was lost
@@ -1819,151 +1822,561 @@ int commander_thread_main(int argc, char *argv[])
 
 	arm_auth_init(&mavlink_log_pub, &status.system_id);
 
-	while (!thread_should_exit) {
-
-		arming_ret = TRANSITION_NOT_CHANGED;
+	/* Check estimator status for signs of bad yaw induced post takeoff navigation failure
+	 * for a short time interval after takeoff. Fixed wing vehicles can recover using GPS heading,
+	 *  but rotary wing vehicles cannot so the position and velocity validity needs to be latched
+	 * to false after failure to prevent flyaway crashes */
+	auto check_estimator_status = [&]() {
+		bool estimator_status_updated = false;
+		orb_check(estimator_status_sub, &estimator_status_updated);
+		if (estimator_status_updated) {
+			orb_copy(ORB_ID(estimator_status), estimator_status_sub, &estimator_status);
+			if (!status_flags.circuit_breaker_engaged_posfailure_check && status.is_rotary_wing) {
+				if (status.arming_state == vehicle_status_s::ARMING_STATE_STANDBY) {
+					// reset flags and timer
+					time_at_takeoff = hrt_absolute_time();
+					nav_test_failed = false;
+					nav_test_passed = false;
+				} else if (land_detector.landed) {
+					// record time of takeoff
+					time_at_takeoff = hrt_absolute_time();
+				} else {
+					// if nav status is unconfirmed, confirm yaw angle as passed after 30 seconds or achieving 5 m/s of speed
+					bool sufficient_time = (hrt_absolute_time() - time_at_takeoff > 30*1000*1000);
+					bool sufficient_speed = local_position.vx*local_position.vx + local_position.vy*local_position.vy > 25.0f;
+					bool innovation_pass = estimator_status.vel_test_ratio < 1.0f && estimator_status.pos_test_ratio < 1.0f;
+					if (!nav_test_failed) {
+						if (!nav_test_passed) {
+							// pass if sufficient time or speed
+							if (sufficient_time || sufficient_speed) {
+								nav_test_passed = true;
+							}
 
-		/* update parameters */
-		orb_check(param_changed_sub, &updated);
+							// record the last time the innovation check passed
+							if (innovation_pass) {
+								time_last_innov_pass = hrt_absolute_time();
+							}
 
-		if (updated || param_init_forced) {
+							// if the innovation test has failed continuously, declare the nav as failed
+							if ((hrt_absolute_time() - time_last_innov_pass) > 1000*1000) {
+								nav_test_failed = true;
+								mavlink_log_emergency(&mavlink_log_pub, "CRITICAL NAVIGATION FAILURE - CHECK SENSOR CALIBRATION");
+							}
+						}
+					}
+				}
+			}
+		}
+	};
 
-			/* parameters changed */
-			struct parameter_update_s param_changed;
-			orb_copy(ORB_ID(parameter_update), param_changed_sub, &param_changed);
+	/* land detector update */
+	auto check_land_detector = [&]() {
+		orb_check(land_detector_sub, &updated);
+		if (updated) {
+			orb_copy(ORB_ID(vehicle_land_detected), land_detector_sub, &land_detector);
 
-			/* update parameters */
-			if (!armed.armed) {
-				if (param_get(_param_sys_type, &system_type) != OK) {
-					PX4_ERR("failed getting new system type");
+			if (was_landed != land_detector.landed) {
+				if (land_detector.landed) {
+					mavlink_and_console_log_info(&mavlink_log_pub, "Landing detected");
 				} else {
-					status.system_type = (uint8_t)system_type;
-				}
+					mavlink_and_console_log_info(&mavlink_log_pub, "Takeoff detected");
+					have_taken_off_since_arming = true;
 
-				/* disable manual override for all systems that rely on electronic stabilization */
-				if (is_rotary_wing(&status) || (is_vtol(&status) && vtol_status.vtol_in_rw_mode)) {
-					status.is_rotary_wing = true;
+					// Set all position and velocity test probation durations to takeoff value
+					// This is a larger value to give the vehicle time to complete a failsafe landing
+					// if faulty sensors cause loss of navigation shortly after takeoff.
+					gpos_probation_time_us = posctl_nav_loss_prob;
+					gvel_probation_time_us = posctl_nav_loss_prob;
+					lpos_probation_time_us = posctl_nav_loss_prob;
+					lvel_probation_time_us = posctl_nav_loss_prob;
+				}
+			}
 
-				} else {
-					status.is_rotary_wing = false;
+			if (was_falling != land_detector.freefall) {
+				if (land_detector.freefall) {
+					mavlink_and_console_log_info(&mavlink_log_pub, "Freefall detected");
 				}
+			}
 
-				/* set vehicle_status.is_vtol flag */
-				status.is_vtol = is_vtol(&status);
 
-				/* check and update system / component ID */
-				int32_t sys_id = 0;
-				param_get(_param_system_id, &sys_id);
-				status.system_id = sys_id;
+			was_landed = land_detector.landed;
+			was_falling = land_detector.freefall;
+		}
+	};
 
-				int32_t comp_id = 0;
-				param_get(_param_component_id, &comp_id);
-				status.component_id = comp_id;
+	/* battery status update, triggers the low battery failsafe actions */
+	auto check_battery = [&]() {
+		orb_check(battery_sub, &updated);
 
-				get_circuit_breaker_params();
+		if (updated) {
+			orb_copy(ORB_ID(battery_status), battery_sub, &battery);
 
-				status_changed = true;
-			}
+			/* only consider battery voltage if system has been running 6s (usb most likely detected) and battery voltage is valid */
+			if (hrt_absolute_time() > commander_boot_timestamp + 6000000
+			    && battery.voltage_filtered_v > 2.0f * FLT_EPSILON) {
 
-			/* Safety parameters */
-			param_get(_param_enable_datalink_loss, &datalink_loss_act);
-			param_get(_param_enable_rc_loss, &rc_loss_act);
-			param_get(_param_datalink_loss_timeout, &datalink_loss_timeout);
-			param_get(_param_rc_loss_timeout, &rc_loss_timeout);
-			param_get(_param_rc_in_off, &rc_in_off);
-			status.rc_input_mode = rc_in_off;
-			param_get(_param_rc_arm_hyst, &rc_arm_hyst);
-			param_get(_param_min_stick_change, &min_stick_change);
-			param_get(_param_rc_override, &rc_override);
-			// percentage (* 0.01) needs to be doubled because RC total interval is 2, not 1
-			min_stick_change *= 0.02f;
-			rc_arm_hyst *= COMMANDER_MONITORING_LOOPSPERMSEC;
-			param_get(_param_datalink_regain_timeout, &datalink_regain_timeout);
-			param_get(_param_ef_throttle_thres, &ef_throttle_thres);
-			param_get(_param_ef_current2throttle_thres, &ef_current2throttle_thres);
-			param_get(_param_ef_time_thres, &ef_time_thres);
-			param_get(_param_geofence_action, &geofence_action);
-			param_get(_param_disarm_land, &disarm_when_landed);
-			param_get(_param_flight_uuid, &flight_uuid);
+				/* if battery voltage is getting lower, warn using buzzer, etc. */
+				if (battery.warning == battery_status_s::BATTERY_WARNING_LOW &&
+				   !low_battery_voltage_actions_done) {
+					low_battery_voltage_actions_done = true;
+					if (armed.armed) {
+						if (low_bat_action == 2) {
+              if (TRANSITION_DENIED != main_state_transition(&status, commander_state_s::MAIN_STATE_AUTO_LAND, main_state_prev, &status_flags, &internal_state)) {
+                warning_action_on = true;
+                mavlink_log_emergency(&mavlink_log_pub, "CRITICAL BATTERY, LANDING AT CURRENT POSITION");
 
-			// If we update parameters the first time
-			// make sure the hysteresis time gets set.
-			// After that it will be set in the main state
-			// machine based on the arming state.
-			if (param_init_forced) {
-				auto_disarm_hysteresis.set_hysteresis_time_from(false,
-									(hrt_abstime)disarm_when_landed * 1000000);
-			}
+              } else {
+                mavlink_log_emergency(&mavlink_log_pub, "CRITICAL BATTERY, LANDING FAILED");
+              }
+            } else {
+              mavlink_log_critical(&mavlink_log_pub, "LOW BATTERY, RETURN TO LAND ADVISED");
+            }
+					} else {
+						mavlink_log_critical(&mavlink_log_pub, "LOW BATTERY, TAKEOFF DISCOURAGED");
+					}
+					status_changed = true;
+				} else if (!status_flags.usb_connected &&
+					   battery.warning == battery_status_s::BATTERY_WARNING_CRITICAL &&
+					   !critical_battery_voltage_actions_done) {
+					critical_battery_voltage_actions_done = true;
 
-			param_get(_param_low_bat_act, &low_bat_action);
-			param_get(_param_offboard_loss_timeout, &offboard_loss_timeout);
-			param_get(_param_offboard_loss_act, &offboard_loss_act);
-			param_get(_param_offboard_loss_rc_act, &offboard_loss_rc_act);
-			param_get(_param_arm_switch_is_button, &arm_switch_is_button);
+					if (!armed.armed) {
+						mavlink_log_critical(&mavlink_log_pub, "CRITICAL BATTERY, SHUT SYSTEM DOWN");
 
-			param_get(_param_arm_without_gps, &arm_without_gps_param);
-			arm_requirements = (arm_without_gps_param == 1) ? ARM_REQ_NONE : ARM_REQ_GPS_BIT;
-			param_get(_param_arm_mission_required, &arm_mission_required_param);
-			arm_requirements |= (arm_mission_required_param & (ARM_REQ_MISSION_BIT | ARM_REQ_ARM_AUTH_BIT));
+					} else {
+						if (low_bat_action == 1 || low_bat_action == 3) {
+							// let us send the critical message even if already in RTL
+							if (TRANSITION_DENIED != main_state_transition(&status, commander_state_s::MAIN_STATE_AUTO_RTL, main_state_prev, &status_flags, &internal_state)) {
+								warning_action_on = true;
+								mavlink_log_emergency(&mavlink_log_pub, "CRITICAL BATTERY, RETURNING TO LAND");
 
-			/* EPH / EPV */
-			param_get(_param_eph, &eph_threshold);
-			param_get(_param_epv, &epv_threshold);
+							} else {
+								mavlink_log_emergency(&mavlink_log_pub, "CRITICAL BATTERY, RTL FAILED");
+							}
 
-			/* flight mode slots */
-			param_get(_param_fmode_1, &_flight_mode_slots[0]);
-			param_get(_param_fmode_2, &_flight_mode_slots[1]);
-			param_get(_param_fmode_3, &_flight_mode_slots[2]);
-			param_get(_param_fmode_4, &_flight_mode_slots[3]);
-			param_get(_param_fmode_5, &_flight_mode_slots[4]);
-			param_get(_param_fmode_6, &_flight_mode_slots[5]);
+						} else if (low_bat_action == 2) {
+							if (TRANSITION_DENIED != main_state_transition(&status, commander_state_s::MAIN_STATE_AUTO_LAND, main_state_prev, &status_flags, &internal_state)) {
+								warning_action_on = true;
+								mavlink_log_emergency(&mavlink_log_pub, "CRITICAL BATTERY, LANDING AT CURRENT POSITION");
 
-			/* pre-flight EKF checks */
-			param_get(_param_max_ekf_pos_ratio, &max_ekf_pos_ratio);
-			param_get(_param_max_ekf_vel_ratio, &max_ekf_vel_ratio);
-			param_get(_param_max_ekf_hgt_ratio, &max_ekf_hgt_ratio);
-			param_get(_param_max_ekf_yaw_ratio, &max_ekf_yaw_ratio);
-			param_get(_param_max_ekf_dvel_bias, &max_ekf_dvel_bias);
-			param_get(_param_max_ekf_dang_bias, &max_ekf_dang_bias);
+							} else {
+								mavlink_log_emergency(&mavlink_log_pub, "CRITICAL BATTERY, LANDING FAILED");
+							}
 
-			/* pre-flight IMU consistency checks */
-			param_get(_param_max_imu_acc_diff, &max_imu_acc_diff);
-			param_get(_param_max_imu_gyr_diff, &max_imu_gyr_diff);
+						} else {
+							mavlink_log_emergency(&mavlink_log_pub, "CRITICAL BATTERY, RETURN TO LAUNCH ADVISED!");
+						}
+					}
 
-			/* failsafe response to loss of navigation accuracy */
-			param_get(_param_posctl_nav_loss_act, &posctl_nav_loss_act);
+					status_changed = true;
 
-			param_init_forced = false;
-		}
+				} else if (!status_flags.usb_connected &&
+					   battery.warning == battery_status_s::BATTERY_WARNING_EMERGENCY &&
+					   !emergency_battery_voltage_actions_done) {
+					emergency_battery_voltage_actions_done = true;
 
-		/* handle power button state */
-		orb_check(power_button_state_sub, &updated);
+					if (!armed.armed) {
+						mavlink_log_critical(&mavlink_log_pub, "DANGEROUSLY LOW BATTERY, SHUT SYSTEM DOWN");
+						usleep(200000);
+						int ret_val = px4_shutdown_request(false, false);
+						if (ret_val) {
+							mavlink_log_critical(&mavlink_log_pub, "SYSTEM DOES NOT SUPPORT SHUTDOWN");
+						} else {
+							while(1) { usleep(1); }
+						}
 
-		if (updated) {
-			power_button_state_s button_state;
-			orb_copy(ORB_ID(power_button_state), power_button_state_sub, &button_state);
-			if (button_state.event == power_button_state_s::PWR_BUTTON_STATE_REQUEST_SHUTDOWN) {
-				px4_shutdown_request(false, false);
-			}
-		}
+					} else {
+						if (low_bat_action == 2 || low_bat_action == 3) {
+							if (TRANSITION_CHANGED == main_state_transition(&status, commander_state_s::MAIN_STATE_AUTO_LAND, main_state_prev, &status_flags, &internal_state)) {
+								warning_action_on = true;
+								mavlink_log_emergency(&mavlink_log_pub, "DANGEROUS BATTERY LEVEL, LANDING IMMEDIATELY");
 
-		orb_check(sp_man_sub, &updated);
+							} else {
+								mavlink_log_emergency(&mavlink_log_pub, "DANGEROUS BATTERY LEVEL, LANDING FAILED");
+							}
 
-		if (updated) {
-			orb_copy(ORB_ID(manual_control_setpoint), sp_man_sub, &sp_man);
-		}
+						} else {
+							mavlink_log_emergency(&mavlink_log_pub, "DANGEROUS BATTERY LEVEL, LANDING ADVISED!");
+						}
+					}
 
-		orb_check(offboard_control_mode_sub, &updated);
+					status_changed = true;
+				}
 
-		if (updated) {
-			orb_copy(ORB_ID(offboard_control_mode), offboard_control_mode_sub, &offboard_control_mode);
+				/* End battery voltage check */
+			}
 		}
+	};
 
-		if (offboard_control_mode.timestamp != 0 &&
-		    offboard_control_mode.timestamp + OFFBOARD_TIMEOUT > hrt_absolute_time()) {
-			if (status_flags.offboard_control_signal_lost) {
-				status_flags.offboard_control_signal_lost = false;
-				status_flags.offboard_control_loss_timeout = false;
+	/* RC input check, also runs on manual control setpoint updates between the monitoring ticks */
+	auto check_rc_input = [&](bool monitoring_tick) {
+		if (!status_flags.rc_input_blocked && sp_man.timestamp != 0 &&
+		    (hrt_absolute_time() < sp_man.timestamp + (uint64_t)(rc_loss_timeout * 1e6f))) {
+			/* handle the case where RC signal was regained */
+			if (!status_flags.rc_signal_found_once) {
+				status_flags.rc_signal_found_once = true;
+				status_changed = true;
+
+			} else {
+				if (status.rc_signal_lost) {
+					mavlink_log_info(&mavlink_log_pub, "MANUAL CONTROL REGAINED after %llums",
+							     (hrt_absolute_time() - rc_signal_lost_timestamp) / 1000);
+					status_changed = true;
+				}
+			}
+
+			status.rc_signal_lost = false;
+
+			const bool in_armed_state = status.arming_state == vehicle_status_s::ARMING_STATE_ARMED || status.arming_state == vehicle_status_s::ARMING_STATE_ARMED_ERROR;
+			const bool arm_button_pressed = arm_switch_is_button == 1 && sp_man.arm_switch == manual_control_setpoint_s::SWITCH_POS_ON;
+
+			/* DISARM
+			 * check if left stick is in lower left position or arm button is pushed or arm switch has transition from arm to disarm
+			 * and we are in MANUAL, Rattitude, or AUTO_READY mode or (ASSIST mode and landed)
+			 * do it only for rotary wings in manual mode or fixed wing if landed */
+			const bool stick_in_lower_left = sp_man.r < -STICK_ON_OFF_LIMIT && sp_man.z < 0.1f;
+			const bool arm_switch_to_disarm_transition =  arm_switch_is_button == 0 &&
+					_last_sp_man_arm_switch == manual_control_setpoint_s::SWITCH_POS_ON &&
+					sp_man.arm_switch == manual_control_setpoint_s::SWITCH_POS_OFF;
+
+			/* the stick hysteresis is evaluated on monitoring ticks only, once per counter step like the 10 ms loop did,
+			 * switch transitions are edges and act on every update */
+			const bool stick_disarm = monitoring_tick && stick_off_counter == rc_arm_hyst && stick_on_counter < rc_arm_hyst;
+
+			if (in_armed_state &&
+				status.rc_input_mode != vehicle_status_s::RC_IN_MODE_OFF &&
+				(status.is_rotary_wing || (!status.is_rotary_wing && land_detector.landed)) &&
+				(stick_in_lower_left || arm_button_pressed || arm_switch_to_disarm_transition) ) {
+
+				if (internal_state.main_state != commander_state_s::MAIN_STATE_MANUAL &&
+						internal_state.main_state != commander_state_s::MAIN_STATE_ACRO &&
+						internal_state.main_state != commander_state_s::MAIN_STATE_STAB &&
+						internal_state.main_state != commander_state_s::MAIN_STATE_RATTITUDE &&
+						!land_detector.landed) {
+					print_reject_arm("NOT DISARMING: Not in manual mode or landed yet.");
+
+				} else if (stick_disarm || arm_switch_to_disarm_transition) {
+					/* disarm to STANDBY if ARMED or to STANDBY_ERROR if ARMED_ERROR */
+					arming_state_t new_arming_state = (status.arming_state == vehicle_status_s::ARMING_STATE_ARMED ? vehicle_status_s::ARMING_STATE_STANDBY :
+									   vehicle_status_s::ARMING_STATE_STANDBY_ERROR);
+					arming_ret = arming_state_transition(&status,
+									     &battery,
+									     &safety,
+									     new_arming_state,
+									     &armed,
+									     true /* fRunPreArmChecks */,
+									     &mavlink_log_pub,
+									     &status_flags,
+									     avionics_power_rail_voltage,
+									     arm_requirements,
+									     hrt_elapsed_time(&commander_boot_timestamp));
+				}
+				/* the arm hysteresis counts monitoring ticks */
+				if (monitoring_tick) {
+					stick_off_counter++;
+				}
+			/* do not reset the counter when holding the arm button longer than needed */
+			} else if (!(arm_switch_is_button == 1 && sp_man.arm_switch == manual_control_setpoint_s::SWITCH_POS_ON)) {
+				stick_off_counter = 0;
+			}
+
+			/* ARM
+			 * check if left stick is in lower right position or arm button is pushed or arm switch has transition from disarm to arm
+			 * and we're in MANUAL mode */
+			const bool stick_in_lower_right = (sp_man.r > STICK_ON_OFF_LIMIT && sp_man.z < 0.1f);
+			const bool arm_switch_to_arm_transition = arm_switch_is_button == 0 &&
+					_last_sp_man_arm_switch == manual_control_setpoint_s::SWITCH_POS_OFF &&
+					sp_man.arm_switch == manual_control_setpoint_s::SWITCH_POS_ON;
+
+			const bool stick_arm = monitoring_tick && stick_on_counter == rc_arm_hyst && stick_off_counter < rc_arm_hyst;
+
+			if (!in_armed_state &&
+				status.rc_input_mode != vehicle_status_s::RC_IN_MODE_OFF &&
+				(stick_in_lower_right || arm_button_pressed || arm_switch_to_arm_transition) ) {
+				if (stick_arm || arm_switch_to_arm_transition) {
+
+					/* we check outside of the transition function here because the requirement
+					 * for being in manual mode only applies to manual arming actions.
+					 * the system can be armed in auto if armed via the GCS.
+					 */
+
+					if ((internal_state.main_state != commander_state_s::MAIN_STATE_MANUAL)
+						&& (internal_state.main_state != commander_state_s::MAIN_STATE_ACRO)
+						&& (internal_state.main_state != commander_state_s::MAIN_STATE_STAB)
+						&& (internal_state.main_state != commander_state_s::MAIN_STATE_ALTCTL)
+						&& (internal_state.main_state != commander_state_s::MAIN_STATE_POSCTL)
+						&& (internal_state.main_state != commander_state_s::MAIN_STATE_RATTITUDE)
+						) {
+						print_reject_arm("NOT ARMING: Switch to a manual mode first.");
+
+					} else if (!status_flags.condition_home_position_valid &&
+								geofence_action == geofence_result_s::GF_ACTION_RTL) {
+						print_reject_arm("NOT ARMING: Geofence RTL requires valid home");
+
+					} else if (status.arming_state == vehicle_status_s::ARMING_STATE_STANDBY) {
+						arming_ret = arming_state_transition(&status,
+										     &battery,
+										     &safety,
+										     vehicle_status_s::ARMING_STATE_ARMED,
+										     &armed,
+										     true /* fRunPreArmChecks */,
+										     &mavlink_log_pub,
+										     &status_flags,
+										     avionics_power_rail_voltage,
+										     arm_requirements,
+										     hrt_elapsed_time(&commander_boot_timestamp));
+
+						if (arming_ret != TRANSITION_CHANGED) {
+							usleep(100000);
+							print_reject_arm("NOT ARMING: Preflight checks failed");
+						}
+					}
+				}
+				/* the arm hysteresis counts monitoring ticks */
+				if (monitoring_tick) {
+					stick_on_counter++;
+				}
+			/* do not reset the counter when holding the arm button longer than needed */
+			} else if (!(arm_switch_is_button == 1 && sp_man.arm_switch == manual_control_setpoint_s::SWITCH_POS_ON)) {
+				stick_on_counter = 0;
+			}
+
+			_last_sp_man_arm_switch = sp_man.arm_switch;
+
+			if (arming_ret == TRANSITION_DENIED) {
+				/*
+				 * the arming transition can be denied to a number of reasons:
+				 *  - pre-flight check failed (sensors not ok or not calibrated)
+				 *  - safety not disabled
+				 *  - system not in manual mode
+				 */
+				tune_negative(true);
+			}
+
+			/* evaluate the main state machine according to mode switches */
+			bool first_rc_eval = (_last_sp_man.timestamp == 0) && (sp_man.timestamp > 0);
+			transition_result_t main_res = set_main_state(&status, &global_position, &local_position, &status_changed);
+
+			/* store last position lock state */
+			_last_condition_global_position_valid = status_flags.condition_global_position_valid;
+
+			/* play tune on mode change only if armed, blink LED always */
+			if (main_res == TRANSITION_CHANGED || first_rc_eval) {
+				tune_positive(armed.armed);
+				main_state_changed = true;
+
+			} else if (main_res == TRANSITION_DENIED) {
+				/* DENIED here indicates bug in the commander */
+				mavlink_log_critical(&mavlink_log_pub, "Switching to this mode is currently not possible");
+			}
+
+			/* check throttle kill switch */
+			if (sp_man.kill_switch == manual_control_setpoint_s::SWITCH_POS_ON) {
+				/* set lockdown flag */
+				if (!armed.manual_lockdown) {
+					mavlink_log_emergency(&mavlink_log_pub, "MANUAL KILL SWITCH ENGAGED");
+				}
+				armed.manual_lockdown = true;
+			} else if (sp_man.kill_switch == manual_control_setpoint_s::SWITCH_POS_OFF) {
+				if (armed.manual_lockdown) {
+					mavlink_log_emergency(&mavlink_log_pub, "MANUAL KILL SWITCH OFF");
+				}
+				armed.manual_lockdown = false;
+			}
+			/* no else case: do not change lockdown flag in unconfigured case */
+		} else {
+			if (!status_flags.rc_input_blocked && !status.rc_signal_lost) {
+				mavlink_log_critical(&mavlink_log_pub, "MANUAL CONTROL LOST (at t=%llums)", hrt_absolute_time() / 1000);
+				status.rc_signal_lost = true;
+				rc_signal_lost_timestamp = sp_man.timestamp;
+				status_changed = true;
+			}
+		}
+	};
+
+	/* vehicle command handling */
+	auto check_commands = [&]() {
+		orb_check(cmd_sub, &updated);
+
+		if (updated) {
+			struct vehicle_command_s cmd;
+
+			/* got command */
+			orb_copy(ORB_ID(vehicle_command), cmd_sub, &cmd);
+
+			/* handle it */
+			if (handle_command(&status, &safety, &cmd, &armed, &_home, &global_position, &local_position,
+					&attitude, &home_pub, &command_ack_pub, &status_changed)) {
+				status_changed = true;
+			}
+		}
+	};
+
+	/* the topics driving state transitions wake up the main loop between the monitoring ticks */
+	px4_pollfd_struct_t fds[5] = {};
+	fds[0].fd = cmd_sub;
+	fds[0].events = POLLIN;
+	fds[1].fd = sp_man_sub;
+	fds[1].events = POLLIN;
+	fds[2].fd = battery_sub;
+	fds[2].events = POLLIN;
+	fds[3].fd = land_detector_sub;
+	fds[3].events = POLLIN;
+	fds[4].fd = estimator_status_sub;
+	fds[4].events = POLLIN;
+
+	/* a pass is a monitoring tick unless it was run early for a state change,
+	 * counter and the stick hysteresis only advance on ticks */
+	bool monitoring_tick = true;
+	hrt_abstime next_monitoring_tick = 0;
+
+	_cmd_latency_perf = perf_alloc(PC_ELAPSED, "commander cmd latency");
+
+	while (!thread_should_exit) {
+
+		arming_ret = TRANSITION_NOT_CHANGED;
+
+		/* update parameters */
+		orb_check(param_changed_sub, &updated);
+
+		if (updated || param_init_forced) {
+
+			/* parameters changed */
+			struct parameter_update_s param_changed;
+			orb_copy(ORB_ID(parameter_update), param_changed_sub, &param_changed);
+
+			/* update parameters */
+			if (!armed.armed) {
+				if (param_get(_param_sys_type, &system_type) != OK) {
+					PX4_ERR("failed getting new system type");
+				} else {
+					status.system_type = (uint8_t)system_type;
+				}
+
+				/* disable manual override for all systems that rely on electronic stabilization */
+				if (is_rotary_wing(&status) || (is_vtol(&status) && vtol_status.vtol_in_rw_mode)) {
+					status.is_rotary_wing = true;
+
+				} else {
+					status.is_rotary_wing = false;
+				}
+
+				/* set vehicle_status.is_vtol flag */
+				status.is_vtol = is_vtol(&status);
+
+				/* check and update system / component ID */
+				int32_t sys_id = 0;
+				param_get(_param_system_id, &sys_id);
+				status.system_id = sys_id;
+
+				int32_t comp_id = 0;
+				param_get(_param_component_id, &comp_id);
+				status.component_id = comp_id;
+
+				get_circuit_breaker_params();
+
+				status_changed = true;
+			}
+
+			/* Safety parameters */
+			param_get(_param_enable_datalink_loss, &datalink_loss_act);
+			param_get(_param_enable_rc_loss, &rc_loss_act);
+			param_get(_param_datalink_loss_timeout, &datalink_loss_timeout);
+			param_get(_param_rc_loss_timeout, &rc_loss_timeout);
+			param_get(_param_rc_in_off, &rc_in_off);
+			status.rc_input_mode = rc_in_off;
+			param_get(_param_rc_arm_hyst, &rc_arm_hyst);
+			param_get(_param_min_stick_change, &min_stick_change);
+			param_get(_param_rc_override, &rc_override);
+			// percentage (* 0.01) needs to be doubled because RC total interval is 2, not 1
+			min_stick_change *= 0.02f;
+			rc_arm_hyst *= COMMANDER_MONITORING_LOOPSPERMSEC;
+			param_get(_param_datalink_regain_timeout, &datalink_regain_timeout);
+			param_get(_param_ef_throttle_thres, &ef_throttle_thres);
+			param_get(_param_ef_current2throttle_thres, &ef_current2throttle_thres);
+			param_get(_param_ef_time_thres, &ef_time_thres);
+			param_get(_param_geofence_action, &geofence_action);
+			param_get(_param_disarm_land, &disarm_when_landed);
+			param_get(_param_flight_uuid, &flight_uuid);
+
+			// If we update parameters the first time
+			// make sure the hysteresis time gets set.
+			// After that it will be set in the main state
+			// machine based on the arming state.
+			if (param_init_forced) {
+				auto_disarm_hysteresis.set_hysteresis_time_from(false,
+									(hrt_abstime)disarm_when_landed * 1000000);
+			}
+
+			param_get(_param_low_bat_act, &low_bat_action);
+			param_get(_param_offboard_loss_timeout, &offboard_loss_timeout);
+			param_get(_param_offboard_loss_act, &offboard_loss_act);
+			param_get(_param_offboard_loss_rc_act, &offboard_loss_rc_act);
+			param_get(_param_arm_switch_is_button, &arm_switch_is_button);
+
+			param_get(_param_arm_without_gps, &arm_without_gps_param);
+			arm_requirements = (arm_without_gps_param == 1) ? ARM_REQ_NONE : ARM_REQ_GPS_BIT;
+			param_get(_param_arm_mission_required, &arm_mission_required_param);
+			arm_requirements |= (arm_mission_required_param & (ARM_REQ_MISSION_BIT | ARM_REQ_ARM_AUTH_BIT));
+
+			/* EPH / EPV */
+			param_get(_param_eph, &eph_threshold);
+			param_get(_param_epv, &epv_threshold);
+
+			/* flight mode slots */
+			param_get(_param_fmode_1, &_flight_mode_slots[0]);
+			param_get(_param_fmode_2, &_flight_mode_slots[1]);
+			param_get(_param_fmode_3, &_flight_mode_slots[2]);
+			param_get(_param_fmode_4, &_flight_mode_slots[3]);
+			param_get(_param_fmode_5, &_flight_mode_slots[4]);
+			param_get(_param_fmode_6, &_flight_mode_slots[5]);
+
+			/* pre-flight EKF checks */
+			param_get(_param_max_ekf_pos_ratio, &max_ekf_pos_ratio);
+			param_get(_param_max_ekf_vel_ratio, &max_ekf_vel_ratio);
+			param_get(_param_max_ekf_hgt_ratio, &max_ekf_hgt_ratio);
+			param_get(_param_max_ekf_yaw_ratio, &max_ekf_yaw_ratio);
+			param_get(_param_max_ekf_dvel_bias, &max_ekf_dvel_bias);
+			param_get(_param_max_ekf_dang_bias, &max_ekf_dang_bias);
+
+			/* pre-flight IMU consistency checks */
+			param_get(_param_max_imu_acc_diff, &max_imu_acc_diff);
+			param_get(_param_max_imu_gyr_diff, &max_imu_gyr_diff);
+
+			/* failsafe response to loss of navigation accuracy */
+			param_get(_param_posctl_nav_loss_act, &posctl_nav_loss_act);
+
+			param_init_forced = false;
+		}
+
+		/* handle power button state */
+		orb_check(power_button_state_sub, &updated);
+
+		if (updated) {
+			power_button_state_s button_state;
+			orb_copy(ORB_ID(power_button_state), power_button_state_sub, &button_state);
+			if (button_state.event == power_button_state_s::PWR_BUTTON_STATE_REQUEST_SHUTDOWN) {
+				px4_shutdown_request(false, false);
+			}
+		}
+
+		orb_check(sp_man_sub, &updated);
+
+		if (updated) {
+			orb_copy(ORB_ID(manual_control_setpoint), sp_man_sub, &sp_man);
+		}
+
+		orb_check(offboard_control_mode_sub, &updated);
+
+		if (updated) {
+			orb_copy(ORB_ID(offboard_control_mode), offboard_control_mode_sub, &offboard_control_mode);
+		}
+
+		if (offboard_control_mode.timestamp != 0 &&
+		    offboard_control_mode.timestamp + OFFBOARD_TIMEOUT > hrt_absolute_time()) {
+			if (status_flags.offboard_control_signal_lost) {
+				status_flags.offboard_control_signal_lost = false;
+				status_flags.offboard_control_loss_timeout = false;
 				status_changed = true;
 			}
 
@@ -2202,50 +2615,7 @@ int commander_thread_main(int argc, char *argv[])
 			status_flags.condition_global_velocity_valid = false;
 		}
 
-		/* Check estimator status for signs of bad yaw induced post takeoff navigation failure
-		 * for a short time interval after takeoff. Fixed wing vehicles can recover using GPS heading,
-		 *  but rotary wing vehicles cannot so the position and velocity validity needs to be latched
-		 * to false after failure to prevent flyaway crashes */
-		if (run_quality_checks && status.is_rotary_wing) {
-			bool estimator_status_updated = false;
-			orb_check(estimator_status_sub, &estimator_status_updated);
-			if (estimator_status_updated) {
-				orb_copy(ORB_ID(estimator_status), estimator_status_sub, &estimator_status);
-				if (status.arming_state == vehicle_status_s::ARMING_STATE_STANDBY) {
-					// reset flags and timer
-					time_at_takeoff = hrt_absolute_time();
-					nav_test_failed = false;
-					nav_test_passed = false;
-				} else if (land_detector.landed) {
-					// record time of takeoff
-					time_at_takeoff = hrt_absolute_time();
-				} else {
-					// if nav status is unconfirmed, confirm yaw angle as passed after 30 seconds or achieving 5 m/s of speed
-					bool sufficient_time = (hrt_absolute_time() - time_at_takeoff > 30*1000*1000);
-					bool sufficient_speed = local_position.vx*local_position.vx + local_position.vy*local_position.vy > 25.0f;
-					bool innovation_pass = estimator_status.vel_test_ratio < 1.0f && estimator_status.pos_test_ratio < 1.0f;
-					if (!nav_test_failed) {
-						if (!nav_test_passed) {
-							// pass if sufficient time or speed
-							if (sufficient_time || sufficient_speed) {
-								nav_test_passed = true;
-							}
-
-							// record the last time the innovation check passed
-							if (innovation_pass) {
-								time_last_innov_pass = hrt_absolute_time();
-							}
-
-							// if the innovation test has failed continuously, declare the nav as failed
-							if ((hrt_absolute_time() - time_last_innov_pass) > 1000*1000) {
-								nav_test_failed = true;
-								mavlink_log_emergency(&mavlink_log_pub, "CRITICAL NAVIGATION FAILURE - CHECK SENSOR CALIBRATION");
-							}
-						}
-					}
-				}
-			}
-		}
+		check_estimator_status();
 
 		/* run global position accuracy checks */
 		if (gpos_updated) {
@@ -2296,37 +2666,7 @@ int commander_thread_main(int argc, char *argv[])
 			    &(status_flags.condition_local_altitude_valid), &status_changed);
 
 		/* Update land detector */
-		orb_check(land_detector_sub, &updated);
-		if (updated) {
-			orb_copy(ORB_ID(vehicle_land_detected), land_detector_sub, &land_detector);
-
-			if (was_landed != land_detector.landed) {
-				if (land_detector.landed) {
-					mavlink_and_console_log_info(&mavlink_log_pub, "Landing detected");
-				} else {
-					mavlink_and_console_log_info(&mavlink_log_pub, "Takeoff detected");
-					have_taken_off_since_arming = true;
-
-					// Set all position and velocity test probation durations to takeoff value
-					// This is a larger value to give the vehicle time to complete a failsafe landing
-					// if faulty sensors cause loss of navigation shortly after takeoff.
-					gpos_probation_time_us = posctl_nav_loss_prob;
-					gvel_probation_time_us = posctl_nav_loss_prob;
-					lpos_probation_time_us = posctl_nav_loss_prob;
-					lvel_probation_time_us = posctl_nav_loss_prob;
-				}
-			}
-
-			if (was_falling != land_detector.freefall) {
-				if (land_detector.freefall) {
-					mavlink_and_console_log_info(&mavlink_log_pub, "Freefall detected");
-				}
-			}
-
-
-			was_landed = land_detector.landed;
-			was_falling = land_detector.freefall;
-		}
+		check_land_detector();
 
 		/* Update hysteresis time. Use a time of factor 5 longer if we have not taken off yet. */
 		hrt_abstime timeout_time = disarm_when_landed * 1000000;
@@ -2335,139 +2675,40 @@ int commander_thread_main(int argc, char *argv[])
 			timeout_time *= 5;
 		}
 
-		auto_disarm_hysteresis.set_hysteresis_time_from(false, timeout_time);
-
-		// Check for auto-disarm
-		if (armed.armed && land_detector.landed && disarm_when_landed > 0) {
-			auto_disarm_hysteresis.set_state_and_update(true);
-		} else {
-			auto_disarm_hysteresis.set_state_and_update(false);
-		}
-
-		if (auto_disarm_hysteresis.get_state()) {
-			arm_disarm(false, &mavlink_log_pub, "auto disarm on land");
-		}
-
-		if (!warning_action_on) {
-			// store the last good main_state when not in an navigation
-			// hold state
-			main_state_before_rtl = internal_state.main_state;
-
-		} else if (internal_state.main_state != commander_state_s::MAIN_STATE_AUTO_RTL
-			&& internal_state.main_state != commander_state_s::MAIN_STATE_AUTO_LOITER
-			&& internal_state.main_state != commander_state_s::MAIN_STATE_AUTO_LAND) {
-			// reset flag again when we switched out of it
-			warning_action_on = false;
-		}
-
-		orb_check(cpuload_sub, &updated);
-
-		if (updated) {
-			orb_copy(ORB_ID(cpuload), cpuload_sub, &cpuload);
-		}
-
-		/* update battery status */
-		orb_check(battery_sub, &updated);
-
-		if (updated) {
-			orb_copy(ORB_ID(battery_status), battery_sub, &battery);
-
-			/* only consider battery voltage if system has been running 6s (usb most likely detected) and battery voltage is valid */
-			if (hrt_absolute_time() > commander_boot_timestamp + 6000000
-			    && battery.voltage_filtered_v > 2.0f * FLT_EPSILON) {
-
-				/* if battery voltage is getting lower, warn using buzzer, etc. */
-				if (battery.warning == battery_status_s::BATTERY_WARNING_LOW &&
-				   !low_battery_voltage_actions_done) {
-					low_battery_voltage_actions_done = true;
-					if (armed.armed) {
-						if (low_bat_action == 2) {
-              if (TRANSITION_DENIED != main_state_transition(&status, commander_state_s::MAIN_STATE_AUTO_LAND, main_state_prev, &status_flags, &internal_state)) {
-                warning_action_on = true;
-                mavlink_log_emergency(&mavlink_log_pub, "CRITICAL BATTERY, LANDING AT CURRENT POSITION");
-
-              } else {
-                mavlink_log_emergency(&mavlink_log_pub, "CRITICAL BATTERY, LANDING FAILED");
-              }
-            } else {
-              mavlink_log_critical(&mavlink_log_pub, "LOW BATTERY, RETURN TO LAND ADVISED");
-            }
-					} else {
-						mavlink_log_critical(&mavlink_log_pub, "LOW BATTERY, TAKEOFF DISCOURAGED");
-					}
-					status_changed = true;
-				} else if (!status_flags.usb_connected &&
-					   battery.warning == battery_status_s::BATTERY_WARNING_CRITICAL &&
-					   !critical_battery_voltage_actions_done) {
-					critical_battery_voltage_actions_done = true;
-
-					if (!armed.armed) {
-						mavlink_log_critical(&mavlink_log_pub, "CRITICAL BATTERY, SHUT SYSTEM DOWN");
-
-					} else {
-						if (low_bat_action == 1 || low_bat_action == 3) {
-							// let us send the critical message even if already in RTL
-							if (TRANSITION_DENIED != main_state_transition(&status, commander_state_s::MAIN_STATE_AUTO_RTL, main_state_prev, &status_flags, &internal_state)) {
-								warning_action_on = true;
-								mavlink_log_emergency(&mavlink_log_pub, "CRITICAL BATTERY, RETURNING TO LAND");
-
-							} else {
-								mavlink_log_emergency(&mavlink_log_pub, "CRITICAL BATTERY, RTL FAILED");
-							}
-
-						} else if (low_bat_action == 2) {
-							if (TRANSITION_DENIED != main_state_transition(&status, commander_state_s::MAIN_STATE_AUTO_LAND, main_state_prev, &status_flags, &internal_state)) {
-								warning_action_on = true;
-								mavlink_log_emergency(&mavlink_log_pub, "CRITICAL BATTERY, LANDING AT CURRENT POSITION");
-
-							} else {
-								mavlink_log_emergency(&mavlink_log_pub, "CRITICAL BATTERY, LANDING FAILED");
-							}
-
-						} else {
-							mavlink_log_emergency(&mavlink_log_pub, "CRITICAL BATTERY, RETURN TO LAUNCH ADVISED!");
-						}
-					}
-
-					status_changed = true;
-
-				} else if (!status_flags.usb_connected &&
-					   battery.warning == battery_status_s::BATTERY_WARNING_EMERGENCY &&
-					   !emergency_battery_voltage_actions_done) {
-					emergency_battery_voltage_actions_done = true;
+		auto_disarm_hysteresis.set_hysteresis_time_from(false, timeout_time);
 
-					if (!armed.armed) {
-						mavlink_log_critical(&mavlink_log_pub, "DANGEROUSLY LOW BATTERY, SHUT SYSTEM DOWN");
-						usleep(200000);
-						int ret_val = px4_shutdown_request(false, false);
-						if (ret_val) {
-							mavlink_log_critical(&mavlink_log_pub, "SYSTEM DOES NOT SUPPORT SHUTDOWN");
-						} else {
-							while(1) { usleep(1); }
-						}
+		// Check for auto-disarm
+		if (armed.armed && land_detector.landed && disarm_when_landed > 0) {
+			auto_disarm_hysteresis.set_state_and_update(true);
+		} else {
+			auto_disarm_hysteresis.set_state_and_update(false);
+		}
 
-					} else {
-						if (low_bat_action == 2 || low_bat_action == 3) {
-							if (TRANSITION_CHANGED == main_state_transition(&status, commander_state_s::MAIN_STATE_AUTO_LAND, main_state_prev, &status_flags, &internal_state)) {
-								warning_action_on = true;
-								mavlink_log_emergency(&mavlink_log_pub, "DANGEROUS BATTERY LEVEL, LANDING IMMEDIATELY");
+		if (auto_disarm_hysteresis.get_state()) {
+			arm_disarm(false, &mavlink_log_pub, "auto disarm on land");
+		}
 
-							} else {
-								mavlink_log_emergency(&mavlink_log_pub, "DANGEROUS BATTERY LEVEL, LANDING FAILED");
-							}
+		if (!warning_action_on) {
+			// store the last good main_state when not in an navigation
+			// hold state
+			main_state_before_rtl = internal_state.main_state;
 
-						} else {
-							mavlink_log_emergency(&mavlink_log_pub, "DANGEROUS BATTERY LEVEL, LANDING ADVISED!");
-						}
-					}
+		} else if (internal_state.main_state != commander_state_s::MAIN_STATE_AUTO_RTL
+			&& internal_state.main_state != commander_state_s::MAIN_STATE_AUTO_LOITER
+			&& internal_state.main_state != commander_state_s::MAIN_STATE_AUTO_LAND) {
+			// reset flag again when we switched out of it
+			warning_action_on = false;
+		}
 
-					status_changed = true;
-				}
+		orb_check(cpuload_sub, &updated);
 
-				/* End battery voltage check */
-			}
+		if (updated) {
+			orb_copy(ORB_ID(cpuload), cpuload_sub, &cpuload);
 		}
 
+		/* update battery status */
+		check_battery();
+
 		/* update subsystem */
 		orb_check(subsys_sub, &updated);
 
@@ -2731,7 +2972,7 @@ int commander_thread_main(int argc, char *argv[])
 				flight_termination_printed = true;
 			}
 
-			if (counter % (1000000 / COMMANDER_MONITORING_INTERVAL) == 0) {
+			if (monitoring_tick && counter % (1000000 / COMMANDER_MONITORING_INTERVAL) == 0) {
 				mavlink_log_critical(&mavlink_log_pub, "Flight termination active");
 			}
 		}
@@ -2761,176 +3002,7 @@ int commander_thread_main(int argc, char *argv[])
 		}
 
 		/* RC input check */
-		if (!status_flags.rc_input_blocked && sp_man.timestamp != 0 &&
-		    (hrt_absolute_time() < sp_man.timestamp + (uint64_t)(rc_loss_timeout * 1e6f))) {
-			/* handle the case where RC signal was regained */
-			if (!status_flags.rc_signal_found_once) {
-				status_flags.rc_signal_found_once = true;
-				status_changed = true;
-
-			} else {
-				if (status.rc_signal_lost) {
-					mavlink_log_info(&mavlink_log_pub, "MANUAL CONTROL REGAINED after %llums",
-							     (hrt_absolute_time() - rc_signal_lost_timestamp) / 1000);
-					status_changed = true;
-				}
-			}
-
-			status.rc_signal_lost = false;
-
-			const bool in_armed_state = status.arming_state == vehicle_status_s::ARMING_STATE_ARMED || status.arming_state == vehicle_status_s::ARMING_STATE_ARMED_ERROR;
-			const bool arm_button_pressed = arm_switch_is_button == 1 && sp_man.arm_switch == manual_control_setpoint_s::SWITCH_POS_ON;
-
-			/* DISARM
-			 * check if left stick is in lower left position or arm button is pushed or arm switch has transition from arm to disarm
-			 * and we are in MANUAL, Rattitude, or AUTO_READY mode or (ASSIST mode and landed)
-			 * do it only for rotary wings in manual mode or fixed wing if landed */
-			const bool stick_in_lower_left = sp_man.r < -STICK_ON_OFF_LIMIT && sp_man.z < 0.1f;
-			const bool arm_switch_to_disarm_transition =  arm_switch_is_button == 0 &&
-					_last_sp_man_arm_switch == manual_control_setpoint_s::SWITCH_POS_ON &&
-					sp_man.arm_switch == manual_control_setpoint_s::SWITCH_POS_OFF;
-
-			if (in_armed_state &&
-				status.rc_input_mode != vehicle_status_s::RC_IN_MODE_OFF &&
-				(status.is_rotary_wing || (!status.is_rotary_wing && land_detector.landed)) &&
-				(stick_in_lower_left || arm_button_pressed || arm_switch_to_disarm_transition) ) {
-
-				if (internal_state.main_state != commander_state_s::MAIN_STATE_MANUAL &&
-						internal_state.main_state != commander_state_s::MAIN_STATE_ACRO &&
-						internal_state.main_state != commander_state_s::MAIN_STATE_STAB &&
-						internal_state.main_state != commander_state_s::MAIN_STATE_RATTITUDE &&
-						!land_detector.landed) {
-					print_reject_arm("NOT DISARMING: Not in manual mode or landed yet.");
-
-				} else if ((stick_off_counter == rc_arm_hyst && stick_on_counter < rc_arm_hyst) || arm_switch_to_disarm_transition) {
-					/* disarm to STANDBY if ARMED or to STANDBY_ERROR if ARMED_ERROR */
-					arming_state_t new_arming_state = (status.arming_state == vehicle_status_s::ARMING_STATE_ARMED ? vehicle_status_s::ARMING_STATE_STANDBY :
-									   vehicle_status_s::ARMING_STATE_STANDBY_ERROR);
-					arming_ret = arming_state_transition(&status,
-									     &battery,
-									     &safety,
-									     new_arming_state,
-									     &armed,
-									     true /* fRunPreArmChecks */,
-									     &mavlink_log_pub,
-									     &status_flags,
-									     avionics_power_rail_voltage,
-									     arm_requirements,
-									     hrt_elapsed_time(&commander_boot_timestamp));
-				}
-				stick_off_counter++;
-			/* do not reset the counter when holding the arm button longer than needed */
-			} else if (!(arm_switch_is_button == 1 && sp_man.arm_switch == manual_control_setpoint_s::SWITCH_POS_ON)) {
-				stick_off_counter = 0;
-			}
-
-			/* ARM
-			 * check if left stick is in lower right position or arm button is pushed or arm switch has transition from disarm to arm
-			 * and we're in MANUAL mode */
-			const bool stick_in_lower_right = (sp_man.r > STICK_ON_OFF_LIMIT && sp_man.z < 0.1f);
-			const bool arm_switch_to_arm_transition = arm_switch_is_button == 0 &&
-					_last_sp_man_arm_switch == manual_control_setpoint_s::SWITCH_POS_OFF &&
-					sp_man.arm_switch == manual_control_setpoint_s::SWITCH_POS_ON;
-
-			if (!in_armed_state &&
-				status.rc_input_mode != vehicle_status_s::RC_IN_MODE_OFF &&
-				(stick_in_lower_right || arm_button_pressed || arm_switch_to_arm_transition) ) {
-				if ((stick_on_counter == rc_arm_hyst && stick_off_counter < rc_arm_hyst) || arm_switch_to_arm_transition) {
-
-					/* we check outside of the transition function here because the requirement
-					 * for being in manual mode only applies to manual arming actions.
-					 * the system can be armed in auto if armed via the GCS.
-					 */
-
-					if ((internal_state.main_state != commander_state_s::MAIN_STATE_MANUAL)
-						&& (internal_state.main_state != commander_state_s::MAIN_STATE_ACRO)
-						&& (internal_state.main_state != commander_state_s::MAIN_STATE_STAB)
-						&& (internal_state.main_state != commander_state_s::MAIN_STATE_ALTCTL)
-						&& (internal_state.main_state != commander_state_s::MAIN_STATE_POSCTL)
-						&& (internal_state.main_state != commander_state_s::MAIN_STATE_RATTITUDE)
-						) {
-						print_reject_arm("NOT ARMING: Switch to a manual mode first.");
-
-					} else if (!status_flags.condition_home_position_valid &&
-								geofence_action == geofence_result_s::GF_ACTION_RTL) {
-						print_reject_arm("NOT ARMING: Geofence RTL requires valid home");
-
-					} else if (status.arming_state == vehicle_status_s::ARMING_STATE_STANDBY) {
-						arming_ret = arming_state_transition(&status,
-										     &battery,
-										     &safety,
-										     vehicle_status_s::ARMING_STATE_ARMED,
-										     &armed,
-										     true /* fRunPreArmChecks */,
-										     &mavlink_log_pub,
-										     &status_flags,
-										     avionics_power_rail_voltage,
-										     arm_requirements,
-										     hrt_elapsed_time(&commander_boot_timestamp));
-
-						if (arming_ret != TRANSITION_CHANGED) {
-							usleep(100000);
-							print_reject_arm("NOT ARMING: Preflight checks failed");
-						}
-					}
-				}
-				stick_on_counter++;
-			/* do not reset the counter when holding the arm button longer than needed */
-			} else if (!(arm_switch_is_button == 1 && sp_man.arm_switch == manual_control_setpoint_s::SWITCH_POS_ON)) {
-				stick_on_counter = 0;
-			}
-
-			_last_sp_man_arm_switch = sp_man.arm_switch;
-
-			if (arming_ret == TRANSITION_DENIED) {
-				/*
-				 * the arming transition can be denied to a number of reasons:
-				 *  - pre-flight check failed (sensors not ok or not calibrated)
-				 *  - safety not disabled
-				 *  - system not in manual mode
-				 */
-				tune_negative(true);
-			}
-
-			/* evaluate the main state machine according to mode switches */
-			bool first_rc_eval = (_last_sp_man.timestamp == 0) && (sp_man.timestamp > 0);
-			transition_result_t main_res = set_main_state(&status, &global_position, &local_position, &status_changed);
-
-			/* store last position lock state */
-			_last_condition_global_position_valid = status_flags.condition_global_position_valid;
-
-			/* play tune on mode change only if armed, blink LED always */
-			if (main_res == TRANSITION_CHANGED || first_rc_eval) {
-				tune_positive(armed.armed);
-				main_state_changed = true;
-
-			} else if (main_res == TRANSITION_DENIED) {
-				/* DENIED here indicates bug in the commander */
-				mavlink_log_critical(&mavlink_log_pub, "Switching to this mode is currently not possible");
-			}
-
-			/* check throttle kill switch */
-			if (sp_man.kill_switch == manual_control_setpoint_s::SWITCH_POS_ON) {
-				/* set lockdown flag */
-				if (!armed.manual_lockdown) {
-					mavlink_log_emergency(&mavlink_log_pub, "MANUAL KILL SWITCH ENGAGED");
-				}
-				armed.manual_lockdown = true;
-			} else if (sp_man.kill_switch == manual_control_setpoint_s::SWITCH_POS_OFF) {
-				if (armed.manual_lockdown) {
-					mavlink_log_emergency(&mavlink_log_pub, "MANUAL KILL SWITCH OFF");
-				}
-				armed.manual_lockdown = false;
-			}
-			/* no else case: do not change lockdown flag in unconfigured case */
-		} else {
-			if (!status_flags.rc_input_blocked && !status.rc_signal_lost) {
-				mavlink_log_critical(&mavlink_log_pub, "MANUAL CONTROL LOST (at t=%llums)", hrt_absolute_time() / 1000);
-				status.rc_signal_lost = true;
-				rc_signal_lost_timestamp = sp_man.timestamp;
-				status_changed = true;
-			}
-		}
+		check_rc_input(monitoring_tick);
 
 		/* data links check */
 		bool have_link = false;
@@ -3057,20 +3129,7 @@ int commander_thread_main(int argc, char *argv[])
 		}
 
 		/* handle commands last, as the system needs to be updated to handle them */
-		orb_check(cmd_sub, &updated);
-
-		if (updated) {
-			struct vehicle_command_s cmd;
-
-			/* got command */
-			orb_copy(ORB_ID(vehicle_command), cmd_sub, &cmd);
-
-			/* handle it */
-			if (handle_command(&status, &safety, &cmd, &armed, &_home, &global_position, &local_position,
-					&attitude, &home_pub, &command_ack_pub, &status_changed)) {
-				status_changed = true;
-			}
-		}
+		check_commands();
 
 		/* Check for failure combinations which lead to flight termination */
 		if (armed.armed &&
@@ -3095,7 +3154,7 @@ int commander_thread_main(int argc, char *argv[])
 					flight_termination_printed = true;
 				}
 
-				if (counter % (1000000 / COMMANDER_MONITORING_INTERVAL) == 0) {
+				if (monitoring_tick && counter % (1000000 / COMMANDER_MONITORING_INTERVAL) == 0) {
 					mavlink_log_critical(&mavlink_log_pub, "DL and GPS lost: flight termination");
 				}
 			}
@@ -3120,7 +3179,7 @@ int commander_thread_main(int argc, char *argv[])
 					flight_termination_printed = true;
 				}
 
-				if (counter % (1000000 / COMMANDER_MONITORING_INTERVAL) == 0) {
+				if (monitoring_tick && counter % (1000000 / COMMANDER_MONITORING_INTERVAL) == 0) {
 					mavlink_log_critical(&mavlink_log_pub, "RC and GPS lost: flight termination");
 				}
 			}
@@ -3273,7 +3332,9 @@ int commander_thread_main(int argc, char *argv[])
 			status_changed = true;
 		}
 
-		counter++;
+		if (monitoring_tick) {
+			counter++;
+		}
 
 		int blink_state = blink_msg_state();
 
@@ -3309,7 +3370,55 @@ int commander_thread_main(int argc, char *argv[])
 
 		arm_auth_update(now);
 
-		usleep(COMMANDER_MONITORING_INTERVAL);
+		/* wait for the next monitoring tick, run only the handler of a state driving topic when it updates.
+		 * An early pass does not move the tick. */
+		if (monitoring_tick) {
+			next_monitoring_tick = hrt_absolute_time() + COMMANDER_MONITORING_INTERVAL;
+		}
+
+		monitoring_tick = true;
+		hrt_abstime wait_start;
+
+		while (!thread_should_exit && (wait_start = hrt_absolute_time()) < next_monitoring_tick) {
+			int pret = px4_poll(&fds[0], sizeof(fds) / sizeof(fds[0]), (next_monitoring_tick - wait_start + 999) / 1000);
+
+			if (pret < 0) {
+				/* poll error, fall back to the monitoring interval */
+				usleep(COMMANDER_MONITORING_INTERVAL);
+				break;
+			}
+
+			if (pret == 0) {
+				break;
+			}
+
+			if (fds[0].revents & POLLIN) {
+				check_commands();
+			}
+
+			if (fds[1].revents & POLLIN) {
+				orb_copy(ORB_ID(manual_control_setpoint), sp_man_sub, &sp_man);
+				check_rc_input(false);
+			}
+
+			if (fds[2].revents & POLLIN) {
+				check_battery();
+			}
+
+			if (fds[3].revents & POLLIN) {
+				check_land_detector();
+			}
+
+			if (fds[4].revents & POLLIN) {
+				check_estimator_status();
+			}
+
+			/* state changes are published by the monitoring pass, run it right away */
+			if (status_changed || main_state_changed || was_armed != armed.armed) {
+				monitoring_tick = false;
+				break;
+			}
+		}
 	}
 
 	/* wait for threads to complete */
@@ -3319,6 +3428,10 @@ int commander_thread_main(int argc, char *argv[])
 		warn("join failed: %d", ret);
 	}
 
+	/* the low priority thread acknowledges commands as well, free the counter after it exited */
+	perf_free(_cmd_latency_perf);
+	_cmd_latency_perf = nullptr;
+
 	rgbled_set_color_and_mode(led_control_s::COLOR_WHITE, led_control_s::MODE_OFF);
 
 	/* close fds */
@@ -3337,6 +3450,7 @@ int commander_thread_main(int argc, char *argv[])
 	px4_close(param_changed_sub);
 	px4_close(battery_sub);
 	px4_close(land_detector_sub);
+	px4_close(estimator_status_sub);
 
 	thread_running = false;
 
@@ -4252,6 +4366,9 @@ void answer_command(struct vehicle_command_s &cmd, unsigned result,
 	} else {
 		command_ack_pub = orb_advertise_queue(ORB_ID(vehicle_command_ack), &command_ack, vehicle_command_ack_s::ORB_QUEUE_LENGTH);
 	}
+
+	/* time from command publication to its acknowledgement */
+	perf_set_elapsed(_cmd_latency_perf, hrt_elapsed_time(&cmd.timestamp));
 }
 
 void *commander_low_prio_loop(void *arg)
@@ -41,6 +41,7 @@
 
 #include <systemlib/err.h>
 
+#include "mag_calibration_streaming_test.h"
 #include "state_machine_helper_test.h"
 
 extern "C" __EXPORT int commander_tests_main(int argc, char *argv[]);
@@ -48,5 +49,8 @@ extern "C" __EXPORT int commander_tests_main(int argc, char *argv[]);
 
 int commander_tests_main(int argc, char *argv[])
 {
-	return stateMachineHelperTest() ? 0 : -1;
+	bool success = stateMachineHelperTest();
+	success = magCalibrationStreamingTest() && success;
+
+	return success ? 0 : -1;
 }
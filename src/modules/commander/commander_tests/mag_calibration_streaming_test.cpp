@@ -0,0 +1,202 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2018 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file mag_calibration_streaming_test.cpp
+ * Unit tests for the streaming magnetometer calibration helpers.
+ */
+
+#include "mag_calibration_streaming_test.h"
+
+#include <unit_test.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "../mag_calibration_streaming.h"
+
+class MagCalibrationStreamingTest : public UnitTest
+{
+public:
+	virtual bool run_tests();
+
+private:
+	bool gridMatchesBruteForceTest();
+	bool sphereFitTest();
+	bool coverageTest();
+
+	static float random_float(float min, float max)
+	{
+		return min + (max - min) * (float)rand() / (float)RAND_MAX;
+	}
+};
+
+bool MagCalibrationStreamingTest::gridMatchesBruteForceTest()
+{
+	static constexpr unsigned max_count = 240;
+	const float min_dist = 0.04f;
+
+	float x[max_count];
+	float y[max_count];
+	float z[max_count];
+	unsigned count = 0;
+
+	MagSampleGrid grid;
+	grid.reset(min_dist);
+
+	srand(1234);
+
+	for (int i = 0; i < 5000 && count < max_count; i++) {
+		const float sx = random_float(-0.6f, 0.6f);
+		const float sy = random_float(-0.6f, 0.6f);
+		const float sz = random_float(-0.6f, 0.6f);
+
+		bool expected = false;
+
+		for (unsigned k = 0; k < count; k++) {
+			const float dx = sx - x[k];
+			const float dy = sy - y[k];
+			const float dz = sz - z[k];
+
+			if (sqrtf(dx * dx + dy * dy + dz * dz) < min_dist) {
+				expected = true;
+				break;
+			}
+		}
+
+		ut_assert("grid and brute force rejection differ", grid.reject(sx, sy, sz, x, y, z) == expected);
+
+		if (!expected) {
+			x[count] = sx;
+			y[count] = sy;
+			z[count] = sz;
+			ut_assert_true(grid.insert(sx, sy, sz, count));
+			count++;
+		}
+	}
+
+	ut_assert("samples accepted", count > 100);
+
+	// the same sample again is always rejected
+	ut_assert_true(grid.reject(x[0], y[0], z[0], x, y, z));
+
+	return true;
+}
+
+bool MagCalibrationStreamingTest::sphereFitTest()
+{
+	const float cx = 0.12f;
+	const float cy = -0.31f;
+	const float cz = 0.05f;
+	const float r = 0.48f;
+
+	IncrementalSphereFit fit;
+	float fx, fy, fz, fr;
+
+	ut_assert_false(fit.solve(fx, fy, fz, fr));
+
+	srand(42);
+
+	for (int i = 0; i < 200; i++) {
+		// random direction, small noise on the radius
+		float vx = random_float(-1.0f, 1.0f);
+		float vy = random_float(-1.0f, 1.0f);
+		float vz = random_float(-1.0f, 1.0f);
+		const float len = sqrtf(vx * vx + vy * vy + vz * vz);
+
+		if (len < 0.1f) {
+			continue;
+		}
+
+		const float noisy_r = r + random_float(-0.005f, 0.005f);
+		fit.add(cx + vx / len * noisy_r, cy + vy / len * noisy_r, cz + vz / len * noisy_r);
+	}
+
+	ut_assert_true(fit.solve(fx, fy, fz, fr));
+	ut_assert("center x", fabsf(fx - cx) < 0.01f);
+	ut_assert("center y", fabsf(fy - cy) < 0.01f);
+	ut_assert("center z", fabsf(fz - cz) < 0.01f);
+	ut_assert("radius", fabsf(fr - r) < 0.01f);
+
+	// samples on a plane don't define a sphere
+	IncrementalSphereFit planar;
+
+	for (int i = 0; i < 20; i++) {
+		planar.add(cosf(i * 0.3f), sinf(i * 0.3f), 0.0f);
+	}
+
+	ut_assert_false(planar.solve(fx, fy, fz, fr));
+
+	return true;
+}
+
+bool MagCalibrationStreamingTest::coverageTest()
+{
+	// one sample per cube face quadrant covers everything
+	float x[24];
+	float y[24];
+	float z[24];
+	unsigned count = 0;
+
+	for (int axis = 0; axis < 3; axis++) {
+		for (int sign = -1; sign <= 1; sign += 2) {
+			for (int q = 0; q < 4; q++) {
+				float v[3];
+				v[axis] = sign * 1.0f;
+				v[(axis + 1) % 3] = (q & 1) ? -0.5f : 0.5f;
+				v[(axis + 2) % 3] = (q & 2) ? -0.5f : 0.5f;
+				x[count] = v[0] + 1.0f;
+				y[count] = v[1];
+				z[count] = v[2];
+				count++;
+			}
+		}
+	}
+
+	ut_compare_float("full coverage", IncrementalSphereFit::coverage(x, y, z, count, 1.0f, 0.0f, 0.0f), 1.0f, 3);
+
+	// only the -x face (the first four samples)
+	ut_compare_float("one face", IncrementalSphereFit::coverage(x, y, z, 4, 1.0f, 0.0f, 0.0f), 4.0f / 24.0f, 3);
+
+	return true;
+}
+
+bool MagCalibrationStreamingTest::run_tests()
+{
+	ut_run_test(gridMatchesBruteForceTest);
+	ut_run_test(sphereFitTest);
+	ut_run_test(coverageTest);
+
+	return (_tests_failed == 0);
+}
+
+ut_declare_test(magCalibrationStreamingTest, MagCalibrationStreamingTest)
@@ -41,6 +41,7 @@
 #include "commander_helper.h"
 #include "calibration_routines.h"
 #include "calibration_messages.h"
+#include "mag_calibration_streaming.h"
 
 #include <px4_defines.h>
 #include <px4_posix.h>
@@ -93,6 +94,8 @@ typedef struct  {
 	float		*x[max_mags];
 	float		*y[max_mags];
 	float		*z[max_mags];
+	MagSampleGrid	*grid[max_mags];		///< accepted samples for the minimum distance check
+	IncrementalSphereFit *sphere_fit[max_mags];	///< live fit of the accepted samples
 } mag_worker_data_t;
 
 
@@ -267,23 +270,9 @@ int do_mag_calibration(orb_advert_t *mavlink_log_pub)
 	return result;
 }
 
-static bool reject_sample(float sx, float sy, float sz, float x[], float y[], float z[], unsigned count,
-			  unsigned max_count)
+static float min_sample_distance(unsigned max_count)
 {
-	float min_sample_dist = fabsf(5.4f * mag_sphere_radius / sqrtf(max_count)) / 3.0f;
-
-	for (size_t i = 0; i < count; i++) {
-		float dx = sx - x[i];
-		float dy = sy - y[i];
-		float dz = sz - z[i];
-		float dist = sqrtf(dx * dx + dy * dy + dz * dz);
-
-		if (dist < min_sample_dist) {
-			return true;
-		}
-	}
-
-	return false;
+	return fabsf(5.4f * mag_sphere_radius / sqrtf(max_count)) / 3.0f;
 }
 
 static unsigned progress_percentage(mag_worker_data_t *worker_data)
@@ -453,39 +442,36 @@ static calibrate_return mag_calibration_worker(detect_orientation_return orienta
 
 		if (poll_ret > 0) {
 
-			int prev_count[max_mags];
+			struct mag_report mag[max_mags];
 			bool rejected = false;
 
 			for (size_t cur_mag = 0; cur_mag < max_mags; cur_mag++) {
 
-				prev_count[cur_mag] = worker_data->calibration_counter_total[cur_mag];
-
 				if (worker_data->sub_mag[cur_mag] >= 0) {
-					struct mag_report mag;
-
-					orb_copy(ORB_ID(sensor_mag), worker_data->sub_mag[cur_mag], &mag);
+					orb_copy(ORB_ID(sensor_mag), worker_data->sub_mag[cur_mag], &mag[cur_mag]);
 
 					// Check if this measurement is good to go in
-					rejected = rejected || reject_sample(mag.x, mag.y, mag.z,
-									     worker_data->x[cur_mag], worker_data->y[cur_mag], worker_data->z[cur_mag],
-									     worker_data->calibration_counter_total[cur_mag],
-									     calibration_sides * worker_data->calibration_points_perside);
-
-					worker_data->x[cur_mag][worker_data->calibration_counter_total[cur_mag]] = mag.x;
-					worker_data->y[cur_mag][worker_data->calibration_counter_total[cur_mag]] = mag.y;
-					worker_data->z[cur_mag][worker_data->calibration_counter_total[cur_mag]] = mag.z;
-					worker_data->calibration_counter_total[cur_mag]++;
+					rejected = rejected || worker_data->grid[cur_mag]->reject(mag[cur_mag].x, mag[cur_mag].y, mag[cur_mag].z,
+							worker_data->x[cur_mag], worker_data->y[cur_mag], worker_data->z[cur_mag]);
 				}
 			}
 
-			// Keep calibration of all mags in lockstep
-			if (rejected) {
-				// Reset counts, since one of the mags rejected the measurement
+			// Keep calibration of all mags in lockstep, only store the measurement if none rejected it
+			if (!rejected) {
 				for (size_t cur_mag = 0; cur_mag < max_mags; cur_mag++) {
-					worker_data->calibration_counter_total[cur_mag] = prev_count[cur_mag];
+
+					if (worker_data->sub_mag[cur_mag] >= 0) {
+						const unsigned index = worker_data->calibration_counter_total[cur_mag];
+
+						worker_data->x[cur_mag][index] = mag[cur_mag].x;
+						worker_data->y[cur_mag][index] = mag[cur_mag].y;
+						worker_data->z[cur_mag][index] = mag[cur_mag].z;
+						worker_data->grid[cur_mag]->insert(mag[cur_mag].x, mag[cur_mag].y, mag[cur_mag].z, index);
+						worker_data->sphere_fit[cur_mag]->add(mag[cur_mag].x, mag[cur_mag].y, mag[cur_mag].z);
+						worker_data->calibration_counter_total[cur_mag]++;
+					}
 				}
 
-			} else {
 				calibration_counter_side++;
 
 				unsigned new_progress = progress_percentage(worker_data) +
@@ -515,6 +501,22 @@ static calibrate_return mag_calibration_worker(detect_orientation_return orienta
 	}
 
 	if (result == calibrate_return_ok) {
+		// live feedback of the fit so far, the final fit starts from it
+		for (size_t cur_mag = 0; cur_mag < max_mags; cur_mag++) {
+			float center_x, center_y, center_z, radius;
+
+			if (worker_data->sub_mag[cur_mag] >= 0
+			    && worker_data->sphere_fit[cur_mag]->solve(center_x, center_y, center_z, radius)) {
+
+				const float coverage = IncrementalSphereFit::coverage(worker_data->x[cur_mag], worker_data->y[cur_mag],
+						       worker_data->z[cur_mag], worker_data->calibration_counter_total[cur_mag],
+						       center_x, center_y, center_z);
+
+				calibration_log_info(worker_data->mavlink_log_pub, "[cal] mag #%u coverage %u%%, radius %.2f Ga",
+						     (unsigned)cur_mag, (unsigned)(coverage * 100.0f), (double)radius);
+			}
+		}
+
 		calibration_log_info(worker_data->mavlink_log_pub, "[cal] %s side done, rotate to a different side",
 				     detect_orientation_str(orientation));
 
@@ -534,9 +536,6 @@ calibrate_return mag_calibrate_all(orb_advert_t *mavlink_log_pub)
 
 	worker_data.mavlink_log_pub = mavlink_log_pub;
 	worker_data.done_count = 0;
-	worker_data.calibration_points_perside = calibration_total_points / calibration_sides;
-	worker_data.calibration_interval_perside_seconds = calibraton_duration_seconds / calibration_sides;
-	worker_data.calibration_interval_perside_useconds = worker_data.calibration_interval_perside_seconds * 1000 * 1000;
 
 	// Collect: As defined by configuration
 	// start with a full mask, all six bits set
@@ -563,6 +562,16 @@ calibrate_return mag_calibrate_all(orb_advert_t *mavlink_log_pub)
 		}
 	}
 
+	if (calibration_sides == 0) {
+		calibration_log_critical(mavlink_log_pub, "ERROR: config: CAL_MAG_SIDES selects no side");
+		return calibrate_return_error;
+	}
+
+	// split the point and time budget over the sides of this run
+	worker_data.calibration_points_perside = calibration_total_points / calibration_sides;
+	worker_data.calibration_interval_perside_seconds = calibraton_duration_seconds / calibration_sides;
+	worker_data.calibration_interval_perside_useconds = worker_data.calibration_interval_perside_seconds * 1000 * 1000;
+
 	for (size_t cur_mag = 0; cur_mag < max_mags; cur_mag++) {
 		// Initialize to no subscription
 		worker_data.sub_mag[cur_mag] = -1;
@@ -571,6 +580,8 @@ calibrate_return mag_calibrate_all(orb_advert_t *mavlink_log_pub)
 		worker_data.x[cur_mag] = nullptr;
 		worker_data.y[cur_mag] = nullptr;
 		worker_data.z[cur_mag] = nullptr;
+		worker_data.grid[cur_mag] = nullptr;
+		worker_data.sphere_fit[cur_mag] = nullptr;
 		worker_data.calibration_counter_total[cur_mag] = 0;
 	}
 
@@ -578,6 +589,13 @@ calibrate_return mag_calibrate_all(orb_advert_t *mavlink_log_pub)
 
 	char str[30];
 
+	// the sample grid has a fixed capacity
+	if (calibration_points_maxcount > MagSampleGrid::MAX_SAMPLES) {
+		calibration_log_critical(mavlink_log_pub, "ERROR: config: %u calibration points exceed the limit of %u", calibration_points_maxcount,
+					 MagSampleGrid::MAX_SAMPLES);
+		result = calibrate_return_error;
+	}
+
 	// Get actual mag count and alloate only as much memory as needed
 	const unsigned orb_mag_count = orb_group_count(ORB_ID(sensor_mag));
 
@@ -590,10 +608,16 @@ calibrate_return mag_calibrate_all(orb_advert_t *mavlink_log_pub)
 		worker_data.x[cur_mag] = reinterpret_cast<float *>(malloc(sizeof(float) * calibration_points_maxcount));
 		worker_data.y[cur_mag] = reinterpret_cast<float *>(malloc(sizeof(float) * calibration_points_maxcount));
 		worker_data.z[cur_mag] = reinterpret_cast<float *>(malloc(sizeof(float) * calibration_points_maxcount));
+		worker_data.grid[cur_mag] = new MagSampleGrid();
+		worker_data.sphere_fit[cur_mag] = new IncrementalSphereFit();
 
-		if (worker_data.x[cur_mag] == nullptr || worker_data.y[cur_mag] == nullptr || worker_data.z[cur_mag] == nullptr) {
+		if (worker_data.x[cur_mag] == nullptr || worker_data.y[cur_mag] == nullptr || worker_data.z[cur_mag] == nullptr
+		    || worker_data.grid[cur_mag] == nullptr || worker_data.sphere_fit[cur_mag] == nullptr) {
 			calibration_log_critical(mavlink_log_pub, "ERROR: out of memory");
 			result = calibrate_return_error;
+
+		} else {
+			worker_data.grid[cur_mag]->reset(min_sample_distance(calibration_points_maxcount));
 		}
 	}
 
@@ -726,9 +750,20 @@ calibrate_return mag_calibrate_all(orb_advert_t *mavlink_log_pub)
 			if (device_ids[cur_mag] != 0) {
 				// Mag in this slot is available and we should have values for it to calibrate
 
+				// start from the sphere fitted while collecting, the fit then
+				// converges in a few iterations and stops early
+				float center_x, center_y, center_z, radius;
+
+				if (worker_data.sphere_fit[cur_mag]->solve(center_x, center_y, center_z, radius)) {
+					sphere_x[cur_mag] = center_x;
+					sphere_y[cur_mag] = center_y;
+					sphere_z[cur_mag] = center_z;
+					sphere_radius[cur_mag] = radius;
+				}
+
 				ellipsoid_fit_least_squares(worker_data.x[cur_mag], worker_data.y[cur_mag], worker_data.z[cur_mag],
 							    worker_data.calibration_counter_total[cur_mag],
-							    100, 0.0f,
+							    100, 1e-6f,
 							    &sphere_x[cur_mag], &sphere_y[cur_mag], &sphere_z[cur_mag],
 							    &sphere_radius[cur_mag],
 							    &diag_x[cur_mag], &diag_y[cur_mag], &diag_z[cur_mag],
@@ -797,6 +832,8 @@ calibrate_return mag_calibrate_all(orb_advert_t *mavlink_log_pub)
 		free(worker_data.x[cur_mag]);
 		free(worker_data.y[cur_mag]);
 		free(worker_data.z[cur_mag]);
+		delete worker_data.grid[cur_mag];
+		delete worker_data.sphere_fit[cur_mag];
 	}
 
 	if (result == calibrate_return_ok) {
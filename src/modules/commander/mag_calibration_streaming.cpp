@@ -0,0 +1,215 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2018 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file mag_calibration_streaming.cpp
+ */
+
+#include "mag_calibration_streaming.h"
+
+#include <px4_defines.h>
+#include <float.h>
+#include <cmath>
+
+#include <matrix/math.hpp>
+
+void MagSampleGrid::reset(float min_sample_dist)
+{
+	_cell_size = (min_sample_dist > FLT_EPSILON) ? min_sample_dist : FLT_EPSILON;
+
+	for (unsigned i = 0; i < BUCKETS; i++) {
+		_head[i] = EMPTY;
+	}
+}
+
+int32_t MagSampleGrid::cell(float v) const
+{
+	return (int32_t)floorf(v / _cell_size);
+}
+
+unsigned MagSampleGrid::bucket(int32_t cx, int32_t cy, int32_t cz) const
+{
+	const uint32_t h = ((uint32_t)cx * 73856093u) ^ ((uint32_t)cy * 19349663u) ^ ((uint32_t)cz * 83492791u);
+	return h % BUCKETS;
+}
+
+bool MagSampleGrid::reject(float sx, float sy, float sz, const float x[], const float y[], const float z[]) const
+{
+	const int32_t cx = cell(sx);
+	const int32_t cy = cell(sy);
+	const int32_t cz = cell(sz);
+
+	for (int32_t dx = -1; dx <= 1; dx++) {
+		for (int32_t dy = -1; dy <= 1; dy++) {
+			for (int32_t dz = -1; dz <= 1; dz++) {
+				// buckets are shared by distant cells too, the distance check sorts them out
+				for (uint16_t i = _head[bucket(cx + dx, cy + dy, cz + dz)]; i != EMPTY; i = _next[i]) {
+					const float ex = sx - x[i];
+					const float ey = sy - y[i];
+					const float ez = sz - z[i];
+
+					if (ex * ex + ey * ey + ez * ez < _cell_size * _cell_size) {
+						return true;
+					}
+				}
+			}
+		}
+	}
+
+	return false;
+}
+
+bool MagSampleGrid::insert(float sx, float sy, float sz, unsigned index)
+{
+	if (index >= MAX_SAMPLES) {
+		return false;
+	}
+
+	const unsigned b = bucket(cell(sx), cell(sy), cell(sz));
+	_next[index] = _head[b];
+	_head[b] = index;
+	return true;
+}
+
+void IncrementalSphereFit::reset()
+{
+	_count = 0;
+
+	for (int i = 0; i < 4; i++) {
+		for (int j = 0; j < 4; j++) {
+			_ata[i][j] = 0.0f;
+		}
+
+		_atb[i] = 0.0f;
+	}
+}
+
+void IncrementalSphereFit::add(float x, float y, float z)
+{
+	if (_count == 0) {
+		_ref[0] = x;
+		_ref[1] = y;
+		_ref[2] = z;
+	}
+
+	x -= _ref[0];
+	y -= _ref[1];
+	z -= _ref[2];
+
+	const float a[4] = {2.0f * x, 2.0f * y, 2.0f * z, 1.0f};
+	const float b = x * x + y * y + z * z;
+
+	for (int i = 0; i < 4; i++) {
+		for (int j = i; j < 4; j++) {
+			_ata[i][j] += a[i] * a[j];
+		}
+
+		_atb[i] += a[i] * b;
+	}
+
+	_count++;
+}
+
+bool IncrementalSphereFit::solve(float &center_x, float &center_y, float &center_z, float &radius) const
+{
+	if (_count < 4) {
+		return false;
+	}
+
+	matrix::SquareMatrix<float, 4> ata;
+
+	for (int i = 0; i < 4; i++) {
+		for (int j = i; j < 4; j++) {
+			ata(i, j) = _ata[i][j];
+			ata(j, i) = _ata[i][j];
+		}
+	}
+
+	if (!ata.I(ata)) {
+		// all samples in a plane or on a line
+		return false;
+	}
+
+	float p[4] = {};
+
+	for (int i = 0; i < 4; i++) {
+		for (int j = 0; j < 4; j++) {
+			p[i] += ata(i, j) * _atb[j];
+		}
+	}
+
+	// p[3] = r^2 - |c|^2
+	const float radius_sq = p[3] + p[0] * p[0] + p[1] * p[1] + p[2] * p[2];
+
+	if (!PX4_ISFINITE(radius_sq) || radius_sq <= 0.0f) {
+		return false;
+	}
+
+	center_x = p[0] + _ref[0];
+	center_y = p[1] + _ref[1];
+	center_z = p[2] + _ref[2];
+	radius = sqrtf(radius_sq);
+	return true;
+}
+
+float IncrementalSphereFit::coverage(const float x[], const float y[], const float z[], unsigned count,
+				     float center_x, float center_y, float center_z)
+{
+	// 6 cube faces split into 4 quadrants each
+	uint32_t bins = 0;
+
+	for (unsigned i = 0; i < count; i++) {
+		const float v[3] = {x[i] - center_x, y[i] - center_y, z[i] - center_z};
+
+		int axis = 0;
+
+		for (int k = 1; k < 3; k++) {
+			if (fabsf(v[k]) > fabsf(v[axis])) {
+				axis = k;
+			}
+		}
+
+		const int face = 2 * axis + ((v[axis] < 0.0f) ? 1 : 0);
+		const int quadrant = ((v[(axis + 1) % 3] < 0.0f) ? 1 : 0) + ((v[(axis + 2) % 3] < 0.0f) ? 2 : 0);
+
+		bins |= 1u << (4 * face + quadrant);
+	}
+
+	unsigned covered = 0;
+
+	for (; bins != 0; bins &= bins - 1) {
+		covered++;
+	}
+
+	return covered / 24.0f;
+}
@@ -0,0 +1,135 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2018 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file mag_calibration_streaming.h
+ *
+ * Helpers to process magnetometer calibration samples as they arrive:
+ * a spatial hash for the minimum sample distance check and an
+ * incremental sphere fit for live feedback and as the starting point
+ * of the final ellipsoid fit.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+/**
+ * Spatial hash over the accepted samples of one magnetometer.
+ *
+ * The cell size equals the minimum sample distance, so all samples closer
+ * than that to a new one are in the 27 cells around it. A rejection check
+ * only looks at these cells instead of every accepted sample.
+ * The samples themselves are stored by the caller, the grid only links
+ * their indices.
+ */
+class MagSampleGrid
+{
+public:
+	static constexpr unsigned MAX_SAMPLES = 256;
+
+	MagSampleGrid() { reset(1.0f); }
+
+	/**
+	 * Remove all samples and set the minimum sample distance.
+	 */
+	void reset(float min_sample_dist);
+
+	/**
+	 * Check if a sample is closer than the minimum distance to any inserted sample.
+	 *
+	 * @param x, y, z	arrays of the inserted samples, indexed as inserted
+	 */
+	bool reject(float sx, float sy, float sz, const float x[], const float y[], const float z[]) const;
+
+	/**
+	 * Insert the sample stored at index.
+	 *
+	 * @return false if index is out of range
+	 */
+	bool insert(float sx, float sy, float sz, unsigned index);
+
+private:
+	static constexpr unsigned BUCKETS = 128;
+	static constexpr uint16_t EMPTY = UINT16_MAX;
+
+	unsigned bucket(int32_t cx, int32_t cy, int32_t cz) const;
+	int32_t cell(float v) const;
+
+	float _cell_size{1.0f};
+
+	uint16_t _head[BUCKETS];	///< first sample index of each bucket
+	uint16_t _next[MAX_SAMPLES];	///< next sample index in the same bucket
+};
+
+/**
+ * Linear least squares sphere fit, updated with every sample.
+ *
+ * Solves |p|^2 = 2 c.p + (r^2 - |c|^2) for the center c and radius r from
+ * accumulated normal equations, so adding a sample and solving are both
+ * independent of the number of samples. Samples are taken relative to the
+ * first one to keep the sums well conditioned in single precision.
+ */
+class IncrementalSphereFit
+{
+public:
+	IncrementalSphereFit() { reset(); }
+
+	void reset();
+
+	void add(float x, float y, float z);
+
+	unsigned count() const { return _count; }
+
+	/**
+	 * Solve for the sphere with the samples so far.
+	 *
+	 * @return false if there are too few or degenerate samples
+	 */
+	bool solve(float &center_x, float &center_y, float &center_z, float &radius) const;
+
+	/**
+	 * Fraction of 24 direction bins around a center that contain at least one
+	 * of the given samples, 0..1. Tells how much of the sphere was covered.
+	 */
+	static float coverage(const float x[], const float y[], const float z[], unsigned count,
+			      float center_x, float center_y, float center_z);
+
+private:
+	unsigned _count{0};
+
+	float _ref[3] {};	///< first sample, others are accumulated relative to it
+
+	float _ata[4][4] {};	///< sum of a * a^T with a = [2x 2y 2z 1]
+	float _atb[4] {};	///< sum of a * |p|^2
+};
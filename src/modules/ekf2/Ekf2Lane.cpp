@@ -0,0 +1,499 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2018 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+/**
+ * @file Ekf2Lane.cpp
+ * Secondary ekf2 estimator lane.
+ */
+
+#include "Ekf2Lane.hpp"
+
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+
+#include <lib/conversion/rotation.h>
+#include <parameters/param.h>
+#include <px4_defines.h>
+#include <px4_log.h>
+#include <px4_posix.h>
+#include <px4_tasks.h>
+#include <uORB/topics/parameter_update.h>
+#include <uORB/topics/sensor_accel.h>
+#include <uORB/topics/sensor_gyro.h>
+#include <uORB/topics/sensor_mag.h>
+#include <uORB/topics/vehicle_air_data.h>
+#include <uORB/topics/vehicle_gps_position.h>
+#include <uORB/topics/vehicle_land_detected.h>
+
+Ekf2Lane::Ekf2Lane(uint8_t lane, uint8_t imu_instance, uint8_t mag_instance) :
+	_lane(lane),
+	_imu_instance(imu_instance),
+	_mag_instance(mag_instance)
+{
+	pthread_mutex_init(&_mutex, nullptr);
+
+	_status.lane = _lane;
+	_status.score = INFINITY;
+}
+
+Ekf2Lane::~Ekf2Lane()
+{
+	stop();
+
+	if (_status_pub != nullptr) {
+		orb_unadvertise(_status_pub);
+	}
+
+	pthread_mutex_destroy(&_mutex);
+}
+
+int Ekf2Lane::start(const parameters &params)
+{
+	*_ekf.getParamHandle() = params;
+
+	/* real-time scheduling like px4_task_spawn_cmd(), the default attributes would inherit the caller's */
+	pthread_attr_t thr_attr;
+	pthread_attr_init(&thr_attr);
+	pthread_attr_setinheritsched(&thr_attr, PTHREAD_EXPLICIT_SCHED);
+	pthread_attr_setschedpolicy(&thr_attr, SCHED_FIFO);
+
+	sched_param param;
+	(void)pthread_attr_getschedparam(&thr_attr, &param);
+	/* below the primary estimator, the lanes must never delay the voted output */
+	param.sched_priority = SCHED_PRIORITY_ESTIMATOR - 10;
+	(void)pthread_attr_setschedparam(&thr_attr, &param);
+
+	/* a lane runs the full filter update like the ekf2 task */
+	pthread_attr_setstacksize(&thr_attr, PX4_STACK_ADJUSTED(STACK_SIZE));
+
+	int ret = pthread_create(&_thread, &thr_attr, &Ekf2Lane::run_helper, this);
+
+	if (ret == EPERM) {
+		/* not allowed to use real-time scheduling (not root), same fallback as px4_task_spawn_cmd() */
+		pthread_attr_setinheritsched(&thr_attr, PTHREAD_INHERIT_SCHED);
+		ret = pthread_create(&_thread, &thr_attr, &Ekf2Lane::run_helper, this);
+	}
+
+	pthread_attr_destroy(&thr_attr);
+
+	if (ret != 0) {
+		_thread = 0;
+	}
+
+	return ret;
+}
+
+void Ekf2Lane::stop()
+{
+	if (_thread == 0) {
+		return;
+	}
+
+	_exit_thread = true;
+
+	int ret = pthread_join(_thread, nullptr);
+
+	if (ret) {
+		PX4_WARN("lane %u join failed: %d", _lane, ret);
+	}
+
+	_thread = 0;
+}
+
+void Ekf2Lane::set_params(const parameters &params)
+{
+	pthread_mutex_lock(&_mutex);
+	_params_pending = params;
+	_params_updated = true;
+	pthread_mutex_unlock(&_mutex);
+}
+
+bool Ekf2Lane::get_status(ekf2_lane_status_s &status)
+{
+	pthread_mutex_lock(&_mutex);
+	status = _status;
+	pthread_mutex_unlock(&_mutex);
+
+	return status.timestamp != 0;
+}
+
+void Ekf2Lane::print_status()
+{
+	ekf2_lane_status_s status;
+	get_status(status);
+
+	PX4_INFO("lane %u: imu %u (gyro %u, accel %u), mag %u (%u), score %.2f, att %s, lpos %s",
+		 _lane, _imu_instance, status.gyro_device_id, status.accel_device_id, _mag_instance, status.mag_device_id,
+		 (double)status.score, status.attitude_valid ? "valid" : "invalid", status.local_position_valid ? "valid" : "invalid");
+	PX4_INFO("lane %u: update %u us avg at %.1f Hz (%.1f%% CPU)", _lane, status.update_us_avg,
+		 (double)status.update_rate_hz, (double)(status.update_us_avg * status.update_rate_hz * 1e-4f));
+}
+
+float Ekf2Lane::health_score(bool attitude_valid, uint16_t filter_fault_flags, float mag_test_ratio,
+			     float vel_test_ratio, float pos_test_ratio, float hgt_test_ratio)
+{
+	if (!attitude_valid || filter_fault_flags != 0) {
+		return INFINITY;
+	}
+
+	const float score = fmaxf(fmaxf(mag_test_ratio, vel_test_ratio), fmaxf(pos_test_ratio, hgt_test_ratio));
+
+	return PX4_ISFINITE(score) ? score : INFINITY;
+}
+
+void *Ekf2Lane::run_helper(void *context)
+{
+	px4_prctl(PR_SET_NAME, "ekf2_lane", px4_getpid());
+
+	reinterpret_cast<Ekf2Lane *>(context)->run();
+	return nullptr;
+}
+
+void Ekf2Lane::update_rotations()
+{
+	int32_t board_rotation = 0;
+	float board_offset[3] = {};
+	param_get(param_find("SENS_BOARD_ROT"), &board_rotation);
+	param_get(param_find("SENS_BOARD_X_OFF"), &board_offset[0]);
+	param_get(param_find("SENS_BOARD_Y_OFF"), &board_offset[1]);
+	param_get(param_find("SENS_BOARD_Z_OFF"), &board_offset[2]);
+
+	/* same composition as the sensors module applies to the voted data */
+	const matrix::Dcmf board_rotation_offset = matrix::Eulerf(
+				M_DEG_TO_RAD_F * board_offset[0],
+				M_DEG_TO_RAD_F * board_offset[1],
+				M_DEG_TO_RAD_F * board_offset[2]);
+
+	_board_rotation = board_rotation_offset * get_rot_matrix((enum Rotation)board_rotation);
+
+	/* internal mags use the board rotation, external ones their own */
+	_mag_rotation = _board_rotation;
+
+	for (unsigned i = 0; i < 4; i++) {
+		char str[20] {};
+		int32_t device_id = 0;
+		(void)sprintf(str, "CAL_MAG%u_ID", i);
+
+		if (param_get(param_find(str), &device_id) != PX4_OK || (uint32_t)device_id != _mag_device_id) {
+			continue;
+		}
+
+		int32_t mag_rotation = -1;
+		(void)sprintf(str, "CAL_MAG%u_ROT", i);
+		param_get(param_find(str), &mag_rotation);
+
+		if (mag_rotation >= 0) {
+			_mag_rotation = get_rot_matrix((enum Rotation)mag_rotation);
+		}
+
+		break;
+	}
+}
+
+void Ekf2Lane::run()
+{
+	int gyro_sub = orb_subscribe_multi(ORB_ID(sensor_gyro), _imu_instance);
+	int accel_sub = orb_subscribe_multi(ORB_ID(sensor_accel), _imu_instance);
+	int mag_sub = orb_subscribe_multi(ORB_ID(sensor_mag), _mag_instance);
+	int airdata_sub = orb_subscribe(ORB_ID(vehicle_air_data));
+	int gps_sub = orb_subscribe_multi(ORB_ID(vehicle_gps_position), 0);
+	int land_detected_sub = orb_subscribe(ORB_ID(vehicle_land_detected));
+	int params_sub = orb_subscribe(ORB_ID(parameter_update));
+
+	update_rotations();
+
+	px4_pollfd_struct_t fds[1] = {};
+	fds[0].fd = gyro_sub;
+	fds[0].events = POLLIN;
+
+	while (!_exit_thread) {
+		int ret = px4_poll(fds, sizeof(fds) / sizeof(fds[0]), 100);
+
+		if (ret <= 0 || !(fds[0].revents & POLLIN)) {
+			continue;
+		}
+
+		// apply parameters handed over by the primary estimator
+		pthread_mutex_lock(&_mutex);
+
+		if (_params_updated) {
+			*_ekf.getParamHandle() = _params_pending;
+			_params_updated = false;
+		}
+
+		pthread_mutex_unlock(&_mutex);
+
+		bool updated = false;
+		orb_check(params_sub, &updated);
+
+		if (updated) {
+			parameter_update_s update;
+			orb_copy(ORB_ID(parameter_update), params_sub, &update);
+			update_rotations();
+		}
+
+		sensor_gyro_s gyro;
+
+		if (orb_copy(ORB_ID(sensor_gyro), gyro_sub, &gyro) != PX4_OK) {
+			continue;
+		}
+
+		_gyro_device_id = gyro.device_id;
+
+		// accumulate the accel integrals until the next gyro sample
+		orb_check(accel_sub, &updated);
+
+		if (updated) {
+			sensor_accel_s accel;
+
+			if (orb_copy(ORB_ID(sensor_accel), accel_sub, &accel) == PX4_OK) {
+				const matrix::Vector3f delta_vel = _board_rotation * matrix::Vector3f(accel.x_integral, accel.y_integral,
+								   accel.z_integral);
+				_accel_integral[0] += delta_vel(0);
+				_accel_integral[1] += delta_vel(1);
+				_accel_integral[2] += delta_vel(2);
+				_accel_integral_dt += accel.integral_dt;
+				_accel_device_id = accel.device_id;
+			}
+		}
+
+		if (gyro.integral_dt == 0 || _accel_integral_dt == 0) {
+			continue;
+		}
+
+		const matrix::Vector3f delta_ang = _board_rotation * matrix::Vector3f(gyro.x_integral, gyro.y_integral,
+						   gyro.z_integral);
+		float gyro_integral[3] = {delta_ang(0), delta_ang(1), delta_ang(2)};
+
+		_ekf.setIMUData(gyro.timestamp, gyro.integral_dt, _accel_integral_dt, gyro_integral, _accel_integral);
+
+		_accel_integral[0] = 0.0f;
+		_accel_integral[1] = 0.0f;
+		_accel_integral[2] = 0.0f;
+		_accel_integral_dt = 0;
+
+		const parameters *params = _ekf.getParamHandle();
+
+		// down sample magnetometer data in the same way as the primary estimator
+		orb_check(mag_sub, &updated);
+
+		if (updated) {
+			sensor_mag_s mag;
+
+			if (orb_copy(ORB_ID(sensor_mag), mag_sub, &mag) == PX4_OK && mag.timestamp != 0) {
+				if (mag.device_id != _mag_device_id) {
+					_mag_device_id = mag.device_id;
+					update_rotations();
+				}
+
+				const matrix::Vector3f field = _mag_rotation * matrix::Vector3f(mag.x, mag.y, mag.z);
+
+				_mag_time_sum_ms += mag.timestamp / 1000;
+				_mag_sample_count++;
+				_mag_data_sum[0] += field(0);
+				_mag_data_sum[1] += field(1);
+				_mag_data_sum[2] += field(2);
+				int32_t mag_time_ms = _mag_time_sum_ms / _mag_sample_count;
+
+				if ((mag_time_ms - _mag_time_ms_last_used) > params->sensor_interval_min_ms) {
+					const float mag_sample_count_inv = 1.0f / _mag_sample_count;
+					float mag_data_avg_ga[3] = {_mag_data_sum[0] *mag_sample_count_inv,
+								    _mag_data_sum[1] *mag_sample_count_inv,
+								    _mag_data_sum[2] *mag_sample_count_inv
+								   };
+
+					_ekf.setMagData(1000 * (uint64_t)mag_time_ms, mag_data_avg_ga);
+
+					_mag_time_ms_last_used = mag_time_ms;
+					_mag_time_sum_ms = 0;
+					_mag_sample_count = 0;
+					_mag_data_sum[0] = 0.0f;
+					_mag_data_sum[1] = 0.0f;
+					_mag_data_sum[2] = 0.0f;
+				}
+			}
+		}
+
+		orb_check(airdata_sub, &updated);
+
+		if (updated) {
+			vehicle_air_data_s airdata;
+
+			if (orb_copy(ORB_ID(vehicle_air_data), airdata_sub, &airdata) == PX4_OK) {
+				const uint32_t balt_time_ms = airdata.timestamp / 1000;
+
+				if (balt_time_ms - _balt_time_ms_last_used > (uint32_t)params->sensor_interval_min_ms) {
+					_ekf.set_air_density(airdata.rho);
+					_ekf.setBaroData(1000 * (uint64_t)balt_time_ms, airdata.baro_alt_meter);
+					_balt_time_ms_last_used = balt_time_ms;
+				}
+			}
+		}
+
+		orb_check(gps_sub, &updated);
+
+		if (updated) {
+			vehicle_gps_position_s gps;
+
+			if (orb_copy(ORB_ID(vehicle_gps_position), gps_sub, &gps) == PX4_OK) {
+				gps_message gps_msg{};
+				gps_msg.time_usec = gps.timestamp;
+				gps_msg.lat = gps.lat;
+				gps_msg.lon = gps.lon;
+				gps_msg.alt = gps.alt;
+				gps_msg.yaw = gps.heading;
+				gps_msg.yaw_offset = gps.heading_offset;
+				gps_msg.fix_type = gps.fix_type;
+				gps_msg.eph = gps.eph;
+				gps_msg.epv = gps.epv;
+				gps_msg.sacc = gps.s_variance_m_s;
+				gps_msg.vel_m_s = gps.vel_m_s;
+				gps_msg.vel_ned[0] = gps.vel_n_m_s;
+				gps_msg.vel_ned[1] = gps.vel_e_m_s;
+				gps_msg.vel_ned[2] = gps.vel_d_m_s;
+				gps_msg.vel_ned_valid = gps.vel_ned_valid;
+				gps_msg.nsats = gps.satellites_used;
+				gps_msg.gdop = 0.0f;
+
+				_ekf.setGpsData(gps_msg.time_usec, &gps_msg);
+			}
+		}
+
+		orb_check(land_detected_sub, &updated);
+
+		if (updated) {
+			vehicle_land_detected_s vehicle_land_detected;
+
+			if (orb_copy(ORB_ID(vehicle_land_detected), land_detected_sub, &vehicle_land_detected) == PX4_OK) {
+				_ekf.set_in_air_status(!vehicle_land_detected.landed);
+			}
+		}
+
+		const hrt_abstime update_start = hrt_absolute_time();
+		const bool ekf_updated = _ekf.update();
+		const hrt_abstime now = hrt_absolute_time();
+
+		_update_time_sum_us += now - update_start;
+		_update_count++;
+
+		if (ekf_updated) {
+			update_status(now);
+		}
+	}
+
+	orb_unsubscribe(gyro_sub);
+	orb_unsubscribe(accel_sub);
+	orb_unsubscribe(mag_sub);
+	orb_unsubscribe(airdata_sub);
+	orb_unsubscribe(gps_sub);
+	orb_unsubscribe(land_detected_sub);
+	orb_unsubscribe(params_sub);
+}
+
+void Ekf2Lane::update_status(const hrt_abstime &now)
+{
+	ekf2_lane_status_s status = _status;
+
+	status.timestamp = now;
+	status.gyro_device_id = _gyro_device_id;
+	status.accel_device_id = _accel_device_id;
+	status.mag_device_id = _mag_device_id;
+
+	uint16_t innovation_check_flags;
+	float tas_test_ratio;
+	float hagl_test_ratio;
+	float beta_test_ratio;
+	_ekf.get_filter_fault_status(&status.filter_fault_flags);
+	_ekf.get_ekf_soln_status(&status.solution_status_flags);
+	_ekf.get_innovation_test_status(&innovation_check_flags, &status.mag_test_ratio,
+					&status.vel_test_ratio, &status.pos_test_ratio,
+					&status.hgt_test_ratio, &tas_test_ratio,
+					&hagl_test_ratio, &beta_test_ratio);
+
+	status.attitude_valid = _ekf.attitude_valid();
+	status.local_position_valid = _ekf.local_position_is_valid();
+	status.score = health_score(status.attitude_valid, status.filter_fault_flags, status.mag_test_ratio,
+				    status.vel_test_ratio, status.pos_test_ratio, status.hgt_test_ratio);
+
+	// origin of the lane local frame, so that the lane output can be expressed in the primary frame
+	map_projection_reference_s origin;
+	uint64_t origin_time;
+	status.ref_valid = _ekf.get_ekf_origin(&origin_time, &origin, &status.ref_alt);
+	status.ref_lat = origin.lat_rad * 180.0 / M_PI;
+	status.ref_lon = origin.lon_rad * 180.0 / M_PI;
+
+	_ekf.get_posNE_reset(&status.delta_xy[0], &status.xy_reset_counter);
+	_ekf.get_posD_reset(&status.delta_z, &status.z_reset_counter);
+	_ekf.get_velNE_reset(&status.delta_vxy[0], &status.vxy_reset_counter);
+	_ekf.get_velD_reset(&status.delta_vz, &status.vz_reset_counter);
+
+	const matrix::Quatf q{_ekf.calculate_quaternion()};
+	q.copyTo(status.q);
+
+	float position[3];
+	_ekf.get_position(position);
+	status.x = position[0];
+	status.y = position[1];
+	status.z = position[2];
+
+	float velocity[3];
+	_ekf.get_velocity(velocity);
+	status.vx = velocity[0];
+	status.vy = velocity[1];
+	status.vz = velocity[2];
+
+	// CPU cost of this lane, averaged over one second windows
+	if (_update_count_start == 0) {
+		_update_count_start = now;
+
+	} else if (now - _update_count_start > 1000000) {
+		status.update_us_avg = _update_time_sum_us / _update_count;
+		status.update_rate_hz = _update_count * 1e6f / (now - _update_count_start);
+		_update_time_sum_us = 0;
+		_update_count = 0;
+		_update_count_start = now;
+	}
+
+	pthread_mutex_lock(&_mutex);
+	_status = status;
+	pthread_mutex_unlock(&_mutex);
+
+	if (now - _status_published >= STATUS_INTERVAL) {
+		_status_published = now;
+
+		int instance;
+		orb_publish_auto(ORB_ID(ekf2_lane_status), &_status_pub, &status, &instance, ORB_PRIO_LOW);
+	}
+}
@@ -0,0 +1,152 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2018 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+/**
+ * @file Ekf2Lane.hpp
+ * Secondary ekf2 estimator lane running on its own thread and fed from a
+ * single IMU/magnetometer combination.
+ */
+
+#pragma once
+
+#include <pthread.h>
+
+#include <drivers/drv_hrt.h>
+#include <lib/ecl/EKF/ekf.h>
+#include <uORB/uORB.h>
+#include <uORB/topics/ekf2_lane_status.h>
+
+class Ekf2Lane
+{
+public:
+	static constexpr int STACK_SIZE = 6600; ///< stack of the ekf2 task, a lane thread runs the same filter update
+
+	/**
+	 * @param lane		lane index, published in ekf2_lane_status.lane (the uORB instance
+	 *			follows the order of advertisement and can differ)
+	 * @param imu_instance	sensor_gyro/sensor_accel uORB instance feeding the lane
+	 * @param mag_instance	sensor_mag uORB instance feeding the lane
+	 */
+	Ekf2Lane(uint8_t lane, uint8_t imu_instance, uint8_t mag_instance);
+	~Ekf2Lane();
+
+	/**
+	 * Start the lane thread.
+	 * @param params initial estimator parameters, copied into the lane
+	 * @return 0 on success, pthread error code otherwise
+	 */
+	int start(const parameters &params);
+
+	/**
+	 * Request the lane thread to exit and wait for it.
+	 */
+	void stop();
+
+	/**
+	 * Hand a new set of estimator parameters to the lane. They are applied
+	 * by the lane thread before its next update.
+	 */
+	void set_params(const parameters &params);
+
+	/**
+	 * Copy the latest lane status.
+	 * @return false if the lane has not produced an estimate yet
+	 */
+	bool get_status(ekf2_lane_status_s &status);
+
+	uint8_t imu_instance() const { return _imu_instance; }
+	uint8_t mag_instance() const { return _mag_instance; }
+
+	void print_status();
+
+	/**
+	 * Combined health score of an estimator, the largest of its innovation test ratios.
+	 * @return INFINITY if the solution must not be used, lower is better otherwise
+	 */
+	static float health_score(bool attitude_valid, uint16_t filter_fault_flags, float mag_test_ratio,
+				  float vel_test_ratio, float pos_test_ratio, float hgt_test_ratio);
+
+private:
+	static void *run_helper(void *context);
+
+	void run();
+
+	void update_rotations();
+	void update_status(const hrt_abstime &now);
+
+	static constexpr hrt_abstime STATUS_INTERVAL = 20000;	///< minimum interval between lane status publications (uSec)
+
+	const uint8_t _lane;
+	const uint8_t _imu_instance;
+	const uint8_t _mag_instance;
+
+	Ekf _ekf;
+
+	pthread_t _thread{0};
+	pthread_mutex_t _mutex;
+	volatile bool _exit_thread{false};
+
+	// parameters pending to be applied by the lane thread, protected by _mutex
+	parameters _params_pending{};
+	bool _params_updated{false};
+
+	// latest published status, protected by _mutex
+	ekf2_lane_status_s _status{};
+
+	orb_advert_t _status_pub{nullptr};
+	hrt_abstime _status_published{0};
+
+	uint32_t _gyro_device_id{0};
+	uint32_t _accel_device_id{0};
+	uint32_t _mag_device_id{0};
+
+	matrix::Dcmf _board_rotation;	///< rotation applied to the IMU data
+	matrix::Dcmf _mag_rotation;	///< rotation applied to the magnetometer data
+
+	// accumulated accel data, the gyro drives the update
+	float _accel_integral[3] {};
+	uint32_t _accel_integral_dt{0};
+
+	// down sampled magnetometer and barometer data
+	float _mag_data_sum[3] {};
+	uint64_t _mag_time_sum_ms{0};
+	uint8_t _mag_sample_count{0};
+	int32_t _mag_time_ms_last_used{0};
+	uint32_t _balt_time_ms_last_used{0};
+
+	// CPU cost accounting
+	uint64_t _update_time_sum_us{0};
+	uint32_t _update_count{0};
+	hrt_abstime _update_count_start{0};
+};
@@ -40,6 +40,8 @@
 
 #include <cfloat>
 
+#include "Ekf2Lane.hpp"
+
 #include <drivers/drv_hrt.h>
 #include <lib/ecl/EKF/ekf.h>
 #include <lib/mathlib/mathlib.h>
@@ -63,6 +65,8 @@
 #include <uORB/topics/parameter_update.h>
 #include <uORB/topics/sensor_bias.h>
 #include <uORB/topics/sensor_combined.h>
+#include <uORB/topics/sensor_gyro.h>
+#include <uORB/topics/sensor_mag.h>
 #include <uORB/topics/sensor_selection.h>
 #include <uORB/topics/vehicle_air_data.h>
 #include <uORB/topics/vehicle_attitude.h>
@@ -84,6 +88,9 @@
 #define GPS_MAX_RECEIVERS 2
 #define GPS_BLENDED_INSTANCE 2
 
+// max number of secondary estimator lanes
+#define EKF2_LANES_MAX 4
+
 using math::constrain;
 using namespace time_literals;
 
@@ -165,6 +172,46 @@ private:
 	 */
 	float filter_altitude_ellipsoid(float amsl_hgt);
 
+	/*
+	 * Start one secondary estimator lane per IMU/magnetometer combination, up to EKF2_LANES.
+	 */
+	void start_lanes();
+	void stop_lanes();
+
+	/*
+	 * Compare the health of the primary estimator against the lanes and switch the output source
+	 * when the current one fails its innovation checks and a clearly better one has been available
+	 * for long enough. The attitude difference is carried over as an offset that decays to zero.
+	 * Position and velocity step to the new source and the step is published as a state reset,
+	 * so that controllers can compensate it like an estimator reset.
+	 */
+	void update_lane_selection(const hrt_abstime &now);
+
+	/*
+	 * Position, velocity and attitude of an output source (0 = primary, n = lane n - 1) without offsets.
+	 * Lane positions are expressed in the local frame of the primary estimator.
+	 */
+	void get_source_states(uint8_t source, Vector3f &position, Vector3f &velocity, Quatf &q);
+
+	/*
+	 * Position of the lane local frame origin in the local frame of the primary estimator.
+	 * Zero if either frame has no WGS-84 origin yet (both then start at the vehicle position).
+	 */
+	Vector3f lane_origin_offset(const ekf2_lane_status_s &status);
+
+	/*
+	 * Replace the primary position and velocity by the output of the selected source.
+	 */
+	void lane_output(float position[3], float velocity[3]);
+	Quatf lane_output_quaternion();
+	bool lane_output_attitude_valid();
+	bool lane_output_local_position_valid();
+
+	/*
+	 * Set the state reset fields of the local position from the selected source and from source switches.
+	 */
+	void lane_output_resets(vehicle_local_position_s &lpos);
+
 	bool 	_replay_mode = false;			///< true when we use replay data from a log
 
 	// time slip monitoring
@@ -175,6 +222,26 @@ private:
 	perf_counter_t _perf_update_data;
 	perf_counter_t _perf_ekf_update;
 
+	// secondary estimator lanes
+	static constexpr float LANE_SCORE_FAIL = 1.0f;		///< score above which an output source is considered to have failed
+	static constexpr float LANE_SWITCH_RATIO = 0.5f;	///< a lane must score at most this fraction of the failed source
+	static constexpr hrt_abstime LANE_SWITCH_DELAY = 1000000;	///< time a better source must persist before switching (uSec)
+	static constexpr hrt_abstime LANE_TIMEOUT = 500000;	///< lane status older than this is not used (uSec)
+	static constexpr float LANE_OFFSET_TAU = 2.0f;		///< time constant of the attitude offset decay after a switch (sec)
+
+	Ekf2Lane *_lanes[EKF2_LANES_MAX] {};
+	ekf2_lane_status_s _lane_status[EKF2_LANES_MAX] {};
+	uint8_t _lane_count = 0;
+	uint8_t _output_source = 0;		///< 0 = primary estimator, n = lane n - 1
+	uint8_t _output_candidate = 0;		///< output source waiting for its switch delay to elapse
+	hrt_abstime _output_candidate_since = 0;
+	hrt_abstime _lane_selection_last = 0;
+	Quatf _lane_q_offset{};			///< output attitude offset carried over from the previous source
+	Vector3f _switch_delta_pos{};		///< position step of the last source switch, not yet published (m)
+	Vector3f _switch_delta_vel{};		///< velocity step of the last source switch, not yet published (m/sec)
+	bool _switch_reset_pending = false;
+	uint8_t _source_reset_counters[4] {};	///< last xy, z, vxy and vz reset counters seen from the output source
+
 	// Initialise time stamps used to send sensor data to the EKF and for logging
 	uint8_t _invalid_mag_id_count = 0;	///< number of times an invalid magnetomer device ID has been detected
 
@@ -498,7 +565,10 @@ private:
 
 		// Test used to determine if the vehicle is static or moving
 		(ParamExtFloat<px4::params::EKF2_MOVE_TEST>)
-		_is_moving_scaler	///< scaling applied to IMU data thresholds used to determine if the vehicle is static or moving.
+		_is_moving_scaler,	///< scaling applied to IMU data thresholds used to determine if the vehicle is static or moving.
+
+		// Secondary estimator lanes
+		(ParamInt<px4::params::EKF2_LANES>) _lanes_max	///< maximum number of secondary estimator lanes
 
 	)
 
@@ -630,6 +700,8 @@ Ekf2::Ekf2():
 
 Ekf2::~Ekf2()
 {
+	stop_lanes();
+
 	perf_free(_perf_update_data);
 	perf_free(_perf_ekf_update);
 
@@ -664,6 +736,19 @@ int Ekf2::print_status()
 	perf_print_counter(_perf_update_data);
 	perf_print_counter(_perf_ekf_update);
 
+	if (_lane_count > 0) {
+		if (_output_source == 0) {
+			PX4_INFO("output source: primary");
+
+		} else {
+			PX4_INFO("output source: lane %u", _output_source - 1);
+		}
+
+		for (uint8_t i = 0; i < _lane_count; i++) {
+			_lanes[i]->print_status();
+		}
+	}
+
 	return 0;
 }
 
@@ -717,6 +802,11 @@ void Ekf2::run()
 	vehicle_status_s vehicle_status = {};
 	sensor_selection_s sensor_selection = {};
 
+	// lanes run on the system clock, they are not supported in replay
+	if (!_replay_mode) {
+		start_lanes();
+	}
+
 	while (!should_exit()) {
 		int ret = px4_poll(fds, sizeof(fds) / sizeof(fds[0]), 1000);
 
@@ -745,6 +835,10 @@ void Ekf2::run()
 			parameter_update_s update;
 			orb_copy(ORB_ID(parameter_update), _params_sub, &update);
 			updateParams();
+
+			for (uint8_t i = 0; i < _lane_count; i++) {
+				_lanes[i]->set_params(*_params);
+			}
 		}
 
 		orb_copy(ORB_ID(sensor_combined), _sensors_sub, &sensors);
@@ -1279,6 +1373,10 @@ void Ekf2::run()
 		const bool updated = _ekf.update();
 		perf_end(_perf_ekf_update);
 
+		if (_lane_count > 0) {
+			update_lane_selection(now);
+		}
+
 		// integrate time to monitor time slippage
 		if (_start_time_us == 0) {
 			_start_time_us = now;
@@ -1307,13 +1405,20 @@ void Ekf2::run()
 
 				odom.local_frame = odom.LOCAL_FRAME_NED;
 
-				// Position of body origin in local NED frame
+				// Position and velocity of body origin in local NED frame
 				float position[3];
+				float velocity[3];
 				_ekf.get_position(position);
+				_ekf.get_velocity(velocity);
+				lane_output(position, velocity);
+
+				const bool local_position_valid = (_lane_count == 0) ? _ekf.local_position_is_valid() :
+								  lane_output_local_position_valid();
+
 				const float lpos_x_prev = lpos.x;
 				const float lpos_y_prev = lpos.y;
-				lpos.x = (_ekf.local_position_is_valid()) ? position[0] : 0.0f;
-				lpos.y = (_ekf.local_position_is_valid()) ? position[1] : 0.0f;
+				lpos.x = local_position_valid ? position[0] : 0.0f;
+				lpos.y = local_position_valid ? position[1] : 0.0f;
 				lpos.z = position[2];
 
 				// Vehicle odometry position
@@ -1322,8 +1427,6 @@ void Ekf2::run()
 				odom.z = lpos.z;
 
 				// Velocity of body origin in local NED frame (m/s)
-				float velocity[3];
-				_ekf.get_velocity(velocity);
 				lpos.vx = velocity[0];
 				lpos.vy = velocity[1];
 				lpos.vz = velocity[2];
@@ -1344,9 +1447,9 @@ void Ekf2::run()
 				lpos.az = vel_deriv[2];
 
 				// TODO: better status reporting
-				lpos.xy_valid = _ekf.local_position_is_valid() && !_preflt_horiz_fail;
+				lpos.xy_valid = local_position_valid && !_preflt_horiz_fail;
 				lpos.z_valid = !_preflt_vert_fail;
-				lpos.v_xy_valid = _ekf.local_position_is_valid() && !_preflt_horiz_fail;
+				lpos.v_xy_valid = local_position_valid && !_preflt_horiz_fail;
 				lpos.v_z_valid = !_preflt_vert_fail;
 
 				// Position of local NED origin in GPS / WGS84 frame
@@ -1368,6 +1471,10 @@ void Ekf2::run()
 				matrix::Quatf q;
 				_ekf.copy_quaternion(q.data());
 
+				if (_lane_count > 0) {
+					q = lane_output_quaternion();
+				}
+
 				lpos.yaw = matrix::Eulerf(q).psi();
 
 				// Vehicle odometry quaternion
@@ -1397,10 +1504,15 @@ void Ekf2::run()
 				_ekf.get_ekf_vel_accuracy(&lpos.evh, &lpos.evv);
 
 				// get state reset information of position and velocity
-				_ekf.get_posD_reset(&lpos.delta_z, &lpos.z_reset_counter);
-				_ekf.get_velD_reset(&lpos.delta_vz, &lpos.vz_reset_counter);
-				_ekf.get_posNE_reset(&lpos.delta_xy[0], &lpos.xy_reset_counter);
-				_ekf.get_velNE_reset(&lpos.delta_vxy[0], &lpos.vxy_reset_counter);
+				if (_lane_count == 0) {
+					_ekf.get_posD_reset(&lpos.delta_z, &lpos.z_reset_counter);
+					_ekf.get_velD_reset(&lpos.delta_vz, &lpos.vz_reset_counter);
+					_ekf.get_posNE_reset(&lpos.delta_xy[0], &lpos.xy_reset_counter);
+					_ekf.get_velNE_reset(&lpos.delta_vxy[0], &lpos.vxy_reset_counter);
+
+				} else {
+					lane_output_resets(lpos);
+				}
 
 				// get control limit information
 				_ekf.get_ekf_ctrl_limits(&lpos.vxy_max, &lpos.vz_max, &lpos.hagl_min, &lpos.hagl_max);
@@ -1794,12 +1906,13 @@ int Ekf2::getRangeSubIndex(const int *subs)
 
 bool Ekf2::publish_attitude(const sensor_combined_s &sensors, const hrt_abstime &now)
 {
-	if (_ekf.attitude_valid()) {
+	if ((_lane_count == 0) ? _ekf.attitude_valid() : lane_output_attitude_valid()) {
 		// generate vehicle attitude quaternion data
 		vehicle_attitude_s att;
 		att.timestamp = now;
+		att.timestamp_sample = sensors.timestamp;
 
-		const Quatf q{_ekf.calculate_quaternion()};
+		const Quatf q{(_lane_count == 0) ? Quatf(_ekf.calculate_quaternion()) : lane_output_quaternion()};
 		q.copyTo(att.q);
 
 		_ekf.get_quat_reset(&att.delta_q_reset[0], &att.quat_reset_counter);
@@ -2448,6 +2561,268 @@ float Ekf2::filter_altitude_ellipsoid(float amsl_hgt)
 	return amsl_hgt + _wgs84_hgt_offset;
 }
 
+void Ekf2::start_lanes()
+{
+	const int lanes_max = math::constrain(_lanes_max.get(), 0, EKF2_LANES_MAX);
+
+	if (lanes_max == 0) {
+		return;
+	}
+
+	const int imu_count = math::max(orb_group_count(ORB_ID(sensor_gyro)), 1);
+	const int mag_count = math::max(orb_group_count(ORB_ID(sensor_mag)), 1);
+
+	for (int i = 0; i < lanes_max && i < imu_count * mag_count; i++) {
+		Ekf2Lane *lane = new Ekf2Lane(i, i / mag_count, i % mag_count);
+
+		if (lane == nullptr) {
+			PX4_ERR("lane %d alloc failed", i);
+			break;
+		}
+
+		int ret = lane->start(*_params);
+
+		if (ret != 0) {
+			PX4_ERR("lane %d start failed (%i)", i, ret);
+			delete lane;
+			break;
+		}
+
+		_lanes[_lane_count++] = lane;
+	}
+
+	PX4_INFO("%u estimator lanes", _lane_count);
+}
+
+void Ekf2::stop_lanes()
+{
+	for (uint8_t i = 0; i < _lane_count; i++) {
+		delete _lanes[i];
+		_lanes[i] = nullptr;
+	}
+
+	_lane_count = 0;
+	_output_source = 0;
+}
+
+void Ekf2::get_source_states(uint8_t source, Vector3f &position, Vector3f &velocity, Quatf &q)
+{
+	if (source == 0) {
+		_ekf.get_position(position.data());
+		_ekf.get_velocity(velocity.data());
+		q = Quatf(_ekf.calculate_quaternion());
+
+	} else {
+		const ekf2_lane_status_s &status = _lane_status[source - 1];
+		position = Vector3f(status.x, status.y, status.z) + lane_origin_offset(status);
+		velocity = Vector3f(status.vx, status.vy, status.vz);
+		q = Quatf(status.q);
+	}
+}
+
+Vector3f Ekf2::lane_origin_offset(const ekf2_lane_status_s &status)
+{
+	map_projection_reference_s ekf_origin;
+	uint64_t origin_time;
+	float ref_alt;
+
+	if (!status.ref_valid || !_ekf.get_ekf_origin(&origin_time, &ekf_origin, &ref_alt)) {
+		return Vector3f();
+	}
+
+	Vector3f offset;
+	map_projection_project(&ekf_origin, status.ref_lat, status.ref_lon, &offset(0), &offset(1));
+	offset(2) = ref_alt - status.ref_alt;
+
+	return offset;
+}
+
+void Ekf2::update_lane_selection(const hrt_abstime &now)
+{
+	// decay the attitude offset left by the last switch
+	const float dt = (_lane_selection_last > 0) ? constrain((now - _lane_selection_last) * 1e-6f, 0.0f, 0.1f) : 0.0f;
+	_lane_selection_last = now;
+
+	const float decay = 1.0f - dt / LANE_OFFSET_TAU;
+	const Vector3f q_offset_rot = AxisAnglef(_lane_q_offset) * decay;
+	_lane_q_offset = Quatf(AxisAnglef(q_offset_rot));
+
+	// score all output sources, index 0 is the primary estimator
+	float scores[EKF2_LANES_MAX + 1];
+
+	uint16_t filter_fault_flags;
+	uint16_t innovation_check_flags;
+	float mag_test_ratio, vel_test_ratio, pos_test_ratio, hgt_test_ratio, tas_test_ratio, hagl_test_ratio, beta_test_ratio;
+	_ekf.get_filter_fault_status(&filter_fault_flags);
+	_ekf.get_innovation_test_status(&innovation_check_flags, &mag_test_ratio, &vel_test_ratio, &pos_test_ratio,
+					&hgt_test_ratio, &tas_test_ratio, &hagl_test_ratio, &beta_test_ratio);
+	scores[0] = Ekf2Lane::health_score(_ekf.attitude_valid(), filter_fault_flags, mag_test_ratio, vel_test_ratio,
+					   pos_test_ratio, hgt_test_ratio);
+
+	uint8_t best = 0;
+
+	for (uint8_t i = 0; i < _lane_count; i++) {
+		ekf2_lane_status_s &status = _lane_status[i];
+
+		if (_lanes[i]->get_status(status) && (now - status.timestamp < LANE_TIMEOUT)) {
+			scores[i + 1] = status.score;
+
+		} else {
+			scores[i + 1] = INFINITY;
+			status.attitude_valid = false;
+		}
+
+		if (scores[i + 1] < scores[best]) {
+			best = i + 1;
+		}
+	}
+
+	uint8_t candidate = _output_source;
+
+	if (_output_source != 0 && scores[0] < LANE_SCORE_FAIL) {
+		// return to the primary estimator as soon as it is healthy again
+		candidate = 0;
+
+	} else if (scores[_output_source] >= LANE_SCORE_FAIL && scores[best] < LANE_SWITCH_RATIO * scores[_output_source]) {
+		candidate = best;
+	}
+
+	if (candidate == _output_source || candidate != _output_candidate) {
+		_output_candidate = candidate;
+		_output_candidate_since = now;
+		return;
+	}
+
+	if (now - _output_candidate_since < LANE_SWITCH_DELAY) {
+		return;
+	}
+
+	// position and velocity step to the new source and are published as a reset, the attitude
+	// is carried over so that it converges to the new source instead of stepping
+	Vector3f pos_old, vel_old, pos_new, vel_new;
+	Quatf q_old, q_new;
+	get_source_states(_output_source, pos_old, vel_old, q_old);
+	get_source_states(candidate, pos_new, vel_new, q_new);
+
+	_switch_delta_pos = pos_new - pos_old;
+	_switch_delta_vel = vel_new - vel_old;
+	_switch_reset_pending = true;
+
+	_lane_q_offset = _lane_q_offset * q_old * q_new.inversed();
+	_lane_q_offset.normalize();
+
+	PX4_WARN("output source %u -> %u, score %.2f -> %.2f", _output_source, candidate,
+		 (double)scores[_output_source], (double)scores[candidate]);
+
+	_output_source = candidate;
+}
+
+void Ekf2::lane_output(float position[3], float velocity[3])
+{
+	if (_lane_count == 0) {
+		return;
+	}
+
+	Vector3f pos, vel;
+	Quatf q;
+	get_source_states(_output_source, pos, vel, q);
+
+	pos.copyTo(position);
+	vel.copyTo(velocity);
+}
+
+Quatf Ekf2::lane_output_quaternion()
+{
+	const Quatf q_source = (_output_source == 0) ? Quatf(_ekf.calculate_quaternion()) :
+			       Quatf(_lane_status[_output_source - 1].q);
+
+	Quatf q = _lane_q_offset * q_source;
+	q.normalize();
+
+	return q;
+}
+
+bool Ekf2::lane_output_attitude_valid()
+{
+	return (_output_source == 0) ? _ekf.attitude_valid() : _lane_status[_output_source - 1].attitude_valid;
+}
+
+bool Ekf2::lane_output_local_position_valid()
+{
+	return (_output_source == 0) ? _ekf.local_position_is_valid() :
+	       _lane_status[_output_source - 1].local_position_valid;
+}
+
+void Ekf2::lane_output_resets(vehicle_local_position_s &lpos)
+{
+	float delta_xy[2];
+	float delta_z;
+	float delta_vxy[2];
+	float delta_vz;
+	uint8_t counters[4];
+
+	if (_output_source == 0) {
+		_ekf.get_posNE_reset(delta_xy, &counters[0]);
+		_ekf.get_posD_reset(&delta_z, &counters[1]);
+		_ekf.get_velNE_reset(delta_vxy, &counters[2]);
+		_ekf.get_velD_reset(&delta_vz, &counters[3]);
+
+	} else {
+		const ekf2_lane_status_s &status = _lane_status[_output_source - 1];
+		delta_xy[0] = status.delta_xy[0];
+		delta_xy[1] = status.delta_xy[1];
+		delta_z = status.delta_z;
+		delta_vxy[0] = status.delta_vxy[0];
+		delta_vxy[1] = status.delta_vxy[1];
+		delta_vz = status.delta_vz;
+		counters[0] = status.xy_reset_counter;
+		counters[1] = status.z_reset_counter;
+		counters[2] = status.vxy_reset_counter;
+		counters[3] = status.vz_reset_counter;
+	}
+
+	if (_switch_reset_pending) {
+		// resets of the new source before the switch are contained in the switch step
+		lpos.delta_xy[0] = _switch_delta_pos(0);
+		lpos.delta_xy[1] = _switch_delta_pos(1);
+		lpos.xy_reset_counter++;
+		lpos.delta_z = _switch_delta_pos(2);
+		lpos.z_reset_counter++;
+		lpos.delta_vxy[0] = _switch_delta_vel(0);
+		lpos.delta_vxy[1] = _switch_delta_vel(1);
+		lpos.vxy_reset_counter++;
+		lpos.delta_vz = _switch_delta_vel(2);
+		lpos.vz_reset_counter++;
+		_switch_reset_pending = false;
+
+	} else {
+		// forward the resets of the selected source with the output counters
+		if (counters[0] != _source_reset_counters[0]) {
+			lpos.delta_xy[0] = delta_xy[0];
+			lpos.delta_xy[1] = delta_xy[1];
+			lpos.xy_reset_counter++;
+		}
+
+		if (counters[1] != _source_reset_counters[1]) {
+			lpos.delta_z = delta_z;
+			lpos.z_reset_counter++;
+		}
+
+		if (counters[2] != _source_reset_counters[2]) {
+			lpos.delta_vxy[0] = delta_vxy[0];
+			lpos.delta_vxy[1] = delta_vxy[1];
+			lpos.vxy_reset_counter++;
+		}
+
+		if (counters[3] != _source_reset_counters[3]) {
+			lpos.delta_vz = delta_vz;
+			lpos.vz_reset_counter++;
+		}
+	}
+
+	memcpy(_source_reset_counters, counters, sizeof(_source_reset_counters));
+}
+
 Ekf2 *Ekf2::instantiate(int argc, char *argv[])
 {
 	Ekf2 *instance = new Ekf2();
@@ -2497,7 +2872,7 @@ int Ekf2::task_spawn(int argc, char *argv[])
 	_task_id = px4_task_spawn_cmd("ekf2",
 				      SCHED_DEFAULT,
 				      SCHED_PRIORITY_ESTIMATOR,
-				      6600,
+				      Ekf2Lane::STACK_SIZE,
 				      (px4_main_t)&run_trampoline,
 				      (char *const *)argv);
 
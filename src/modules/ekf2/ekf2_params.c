@@ -1316,3 +1316,15 @@ PARAM_DEFINE_FLOAT(EKF2_GPS_TAU, 10.0f);
  * @decimal 1
  */
 PARAM_DEFINE_FLOAT(EKF2_MOVE_TEST, 1.0f);
+
+/**
+ * Number of secondary estimator lanes
+ *
+ * Runs additional estimator instances on their own threads, one per IMU and magnetometer combination (lane n uses IMU n / mag count and magnetometer n % mag count). The lanes are monitored using their innovation test ratios and the published output is switched to the healthiest lane when the primary estimator fails its innovation checks. Set to zero to disable. Each lane costs about as much CPU as the primary estimator, see 'ekf2 status'.
+ *
+ * @group EKF2
+ * @min 0
+ * @max 4
+ * @reboot_required true
+ */
+PARAM_DEFINE_INT32(EKF2_LANES, 0);
@@ -144,9 +144,8 @@ int TemperatureCalibrationBaro::update_sensor_instance(PerSensorData &data, int
 			 (double)(data.high_temp - data.low_temp));
 	}
 
-	//update linear fit matrices
-	double relative_temperature = (double)data.sensor_sample_filt[1] - (double)data.ref_temp;
-	data.P[0].update(relative_temperature, (double)data.sensor_sample_filt[0]);
+	//update the fit
+	update_polyfit(data);
 
 	return 1;
 }
@@ -174,11 +173,12 @@ int TemperatureCalibrationBaro::finish_sensor_instance(PerSensorData &data, int
 	}
 
 	double res[POLYFIT_ORDER + 1] = {};
-	data.P[0].fit(res);
+	fit_axis(data, 0, res);
 	res[POLYFIT_ORDER] =
 		0.0; // normalise the correction to be zero at the reference temperature by setting the X^0 coefficient to zero
 	PX4_INFO("Result baro %u %.20f %.20f %.20f %.20f %.20f %.20f", sensor_index, (double)res[0],
 		 (double)res[1], (double)res[2], (double)res[3], (double)res[4], (double)res[5]);
+	print_band_residuals("Baro", data, sensor_index);
 	data.tempcal_complete = true;
 
 	char str[30];
@@ -47,6 +47,11 @@
 
 #define SENSOR_COUNT_MAX		3
 
+#define TC_BAND_COUNT			8 ///< number of temperature bands the calibration range is split into
+#define TC_BAND_MIN_SAMPLES		50 ///< minimum number of samples for a band to be used in the convergence check
+#define TC_CONVERGED_BANDS		2 ///< number of latest bands that must be predicted within the noise floor
+#define TC_CONVERGED_RESIDUAL_RATIO	1.5 ///< allowed ratio of the latest band residuals to the noise floor
+
 
 #define TC_ERROR_INITIAL_TEMP_TOO_HIGH 110 ///< starting temperature was above the configured allowed temperature
 #define TC_ERROR_COMMUNICATION         112 ///< no sensors found
@@ -80,6 +85,12 @@ public:
 	/** reset all driver-level calibration parameters */
 	virtual void reset_calibration() = 0;
 
+	/**
+	 * allow a sensor to finish its soak before the full temperature rise once its fit has converged
+	 * @param early_temperature_rise minimum temperature rise before the soak may end (deg C), 0 to disable
+	 */
+	void set_early_termination(float early_temperature_rise) { _early_temperature_rise = early_temperature_rise; }
+
 protected:
 
 	/**
@@ -94,6 +105,7 @@ protected:
 	float _min_temperature_rise; ///< minimum difference in temperature before the process finishes
 	float _min_start_temperature; ///< minimum temperature before the process starts
 	float _max_start_temperature; ///< maximum temperature above which the process does not start and an error is declared
+	float _early_temperature_rise{0.f}; ///< minimum temperature rise before the soak may end early, 0 if disabled
 };
 
 
@@ -152,6 +164,10 @@ public:
 			for (unsigned uorb_index = 0; uorb_index < _num_sensor_instances; uorb_index++) {
 				float cur_diff = _data[uorb_index].high_temp - _data[uorb_index].low_temp;
 
+				if (_data[uorb_index].converged) {
+					cur_diff = _min_temperature_rise;
+				}
+
 				if (cur_diff < min_diff) {
 					min_diff = cur_diff;
 				}
@@ -167,7 +183,10 @@ protected:
 
 	struct PerSensorData {
 		float sensor_sample_filt[Dim + 1]; ///< last value is the temperature
-		polyfitter < PolyfitOrder + 1 > P[Dim];
+		incremental_polyfitter < PolyfitOrder + 1 > P[Dim];
+		unsigned band_samples[TC_BAND_COUNT] {}; ///< number of samples in each temperature band
+		double band_residual_sq[Dim][TC_BAND_COUNT] {}; ///< sum of squared recursive residuals in each temperature band
+		int band = 0; ///< temperature band of the latest sample
 		unsigned hot_soak_sat = 0; /**< counter that increments every time the sensor temperature reduces
 									from the last reading */
 		uint32_t device_id = 0; ///< ID for the sensor being calibrated
@@ -175,10 +194,12 @@ protected:
 		/// verified and the starting temperature set
 		bool hot_soaked = false; ///< true when the sensor has achieved the specified temperature increase
 		bool tempcal_complete = false; ///< true when the calibration has been completed
+		bool converged = false; ///< true when the soak was ended early because the fit converged
 		float low_temp = 0.f; ///< low temperature recorded at start of calibration (deg C)
 		float high_temp = 0.f; ///< highest temperature recorded during calibration (deg C)
 		float ref_temp = 0.f; /**< calibration reference temperature, nominally in the middle of the
 							calibration temperature range (deg C) */
+		float fit_ref_shift = 0.f; ///< ref_temp relative to the temperature the fit was computed about (deg C)
 	};
 
 	PerSensorData _data[SENSOR_COUNT_MAX];
@@ -189,6 +210,116 @@ protected:
 	 */
 	virtual int update_sensor_instance(PerSensorData &data, int sensor_sub) = 0;
 
+	/**
+	 * add the latest filtered sample to the fit of each axis and accumulate the residuals of the
+	 * temperature band it falls into. Ends the soak early once the fit has converged.
+	 */
+	void update_polyfit(PerSensorData &data)
+	{
+		const float temperature = data.sensor_sample_filt[Dim];
+		const double relative_temperature = (double)temperature - (double)data.ref_temp;
+		const int band = math::constrain((int)((temperature - data.low_temp) / _min_temperature_rise * TC_BAND_COUNT),
+						 0, TC_BAND_COUNT - 1);
+
+		for (int axis = 0; axis < Dim; axis++) {
+			const double residual = data.P[axis].update(relative_temperature, (double)data.sensor_sample_filt[axis]);
+			data.band_residual_sq[axis][band] += residual * residual;
+		}
+
+		data.band_samples[band]++;
+
+		if (band != data.band) {
+			data.band = band;
+
+			if (fit_converged(data)) {
+				data.converged = true;
+				data.hot_soaked = true;
+
+				// reference the fit to the middle of the range that was actually covered
+				const float ref_temp = 0.5f * (data.low_temp + data.high_temp);
+				data.fit_ref_shift = ref_temp - data.ref_temp;
+				data.ref_temp = ref_temp;
+
+				PX4_INFO("Sensor 0x%x fit converged after %.1f deg C rise, ending soak", data.device_id,
+					 (double)(data.high_temp - data.low_temp));
+			}
+		}
+	}
+
+	/**
+	 * The fit has converged when each of the latest completed temperature bands is predicted by the fit
+	 * of the colder samples about as well as the best band, i.e. the recursive residuals of the newly
+	 * reached temperatures are down to the measurement noise.
+	 */
+	bool fit_converged(const PerSensorData &data) const
+	{
+		if (_early_temperature_rise <= 0.f || (data.high_temp - data.low_temp) < _early_temperature_rise
+		    || data.band <= TC_CONVERGED_BANDS) {
+			return false;
+		}
+
+		for (int band = data.band - TC_CONVERGED_BANDS; band < data.band; band++) {
+			if (data.band_samples[band] < TC_BAND_MIN_SAMPLES) {
+				return false;
+			}
+		}
+
+		for (int axis = 0; axis < Dim; axis++) {
+			double noise_floor = INFINITY;
+
+			for (int band = 0; band < data.band; band++) {
+				if (data.band_samples[band] >= TC_BAND_MIN_SAMPLES) {
+					noise_floor = math::min(noise_floor, band_residual_rms(data, axis, band));
+				}
+			}
+
+			for (int band = data.band - TC_CONVERGED_BANDS; band < data.band; band++) {
+				if (band_residual_rms(data, axis, band) > TC_CONVERGED_RESIDUAL_RATIO * noise_floor) {
+					return false;
+				}
+			}
+		}
+
+		return true;
+	}
+
+	double band_residual_rms(const PerSensorData &data, int axis, int band) const
+	{
+		return data.band_samples[band] > 0 ? sqrt(data.band_residual_sq[axis][band] / data.band_samples[band]) : 0.0;
+	}
+
+	/**
+	 * current best fit of one axis, highest order coefficient first and referenced to data.ref_temp
+	 * @return false if there is not enough data for a fit
+	 */
+	bool fit_axis(const PerSensorData &data, int axis, double res[]) const
+	{
+		if (!data.P[axis].fit(res)) {
+			return false;
+		}
+
+		incremental_polyfitter < PolyfitOrder + 1 >::shift(res, (double)data.fit_ref_shift);
+		return true;
+	}
+
+	/** print the fit residuals of each axis per temperature band */
+	void print_band_residuals(const char *sensor_name, const PerSensorData &data, int sensor_index) const
+	{
+		const float band_width = _min_temperature_rise / TC_BAND_COUNT;
+
+		for (int axis = 0; axis < Dim; axis++) {
+			char str[TC_BAND_COUNT * 12];
+			int len = 0;
+
+			for (int band = 0; band < TC_BAND_COUNT && len < (int)sizeof(str); band++) {
+				len += snprintf(str + len, sizeof(str) - len, " %.3g", band_residual_rms(data, axis, band));
+			}
+
+			PX4_INFO("%s %d Axis %d residual RMS %.3g, per %.1f deg C band:%s%s", sensor_name, sensor_index, axis,
+				 data.P[axis].residual_rms(), (double)band_width, str, data.converged ? " (converged early)" : "");
+		}
+	}
+
 	unsigned _num_sensor_instances{0};
 	int _sensor_subs[SENSOR_COUNT_MAX];
 };
@@ -144,11 +144,8 @@ int TemperatureCalibrationGyro::update_sensor_instance(PerSensorData &data, int
 			 (double)(data.high_temp - data.low_temp));
 	}
 
-	//update linear fit matrices
-	double relative_temperature = (double)data.sensor_sample_filt[3] - (double)data.ref_temp;
-	data.P[0].update(relative_temperature, (double)data.sensor_sample_filt[0]);
-	data.P[1].update(relative_temperature, (double)data.sensor_sample_filt[1]);
-	data.P[2].update(relative_temperature, (double)data.sensor_sample_filt[2]);
+	//update the fits
+	update_polyfit(data);
 
 	return 1;
 }
@@ -176,18 +173,19 @@ int TemperatureCalibrationGyro::finish_sensor_instance(PerSensorData &data, int
 	}
 
 	double res[3][4] = {};
-	data.P[0].fit(res[0]);
+	fit_axis(data, 0, res[0]);
 	PX4_INFO("Result Gyro %d Axis 0: %.20f %.20f %.20f %.20f", sensor_index, (double)res[0][0], (double)res[0][1],
 		 (double)res[0][2],
 		 (double)res[0][3]);
-	data.P[1].fit(res[1]);
+	fit_axis(data, 1, res[1]);
 	PX4_INFO("Result Gyro %d Axis 1: %.20f %.20f %.20f %.20f", sensor_index, (double)res[1][0], (double)res[1][1],
 		 (double)res[1][2],
 		 (double)res[1][3]);
-	data.P[2].fit(res[2]);
+	fit_axis(data, 2, res[2]);
 	PX4_INFO("Result Gyro %d Axis 2: %.20f %.20f %.20f %.20f", sensor_index, (double)res[2][0], (double)res[2][1],
 		 (double)res[2][2],
 		 (double)res[2][3]);
+	print_band_residuals("Gyro", data, sensor_index);
 	data.tempcal_complete = true;
 
 	char str[30];
@@ -201,3 +201,144 @@ private:
 		}
 	}
 };
+
+/*
+
+Incremental least squares fit of the same polynomial, without forming VTV.
+
+VTV squares the condition number of V, which for a 5th order baro fit over a
+24 deg C span leaves only a few significant digits in the solution. Instead an
+upper triangular factor R with V = Q.R is kept and updated with Givens
+rotations for every new row [xi^n ... xi 1 | yi]:
+
+ __       __        __          __
+| R   QT.Y  |  <-  |  R      QT.Y  |   rotated so that the new row becomes
+| 0    ei   |      | vi       yi   |   zero apart from the last element ei
+|__       __|      |__          __|
+
+A = inv(R)*(QT.Y) is found by back substitution whenever a fit is needed, so a
+current best fit is available at any time for O(n^2) operations.
+
+The element ei left over after the rotations is the recursive residual of
+sample i, i.e. its prediction error against the fit of all previous samples
+scaled by sqrt(1 + vi.inv(RT.R).viT). For a model that fits, these are white
+with the measurement noise variance, and their sum of squares is the residual
+sum of squares of the current fit.
+
+*/
+
+template<int _forder>
+class incremental_polyfitter
+{
+public:
+	incremental_polyfitter() {}
+
+	/**
+	 * add a sample to the fit
+	 * @return recursive residual of the sample (0 while the fit is underdetermined)
+	 */
+	double update(double x, double y)
+	{
+		double v[_forder];
+		double temp = 1.0;
+
+		for (int i = _forder - 1; i >= 0; i--) {
+			v[i] = temp;
+			temp *= x;
+		}
+
+		for (int k = 0; k < _forder; k++) {
+			if (fabs(v[k]) <= 0.0) {
+				continue;
+			}
+
+			const double r_kk = _R[index(k, k)];
+
+			if (fabs(r_kk) <= 0.0) {
+				// first sample with a non-zero entry in this column, take the row as is
+				for (int j = k; j < _forder; j++) {
+					_R[index(k, j)] = v[j];
+				}
+
+				_QTY[k] = y;
+				_count++;
+				return 0.0;
+			}
+
+			const double rho = sqrt(r_kk * r_kk + v[k] * v[k]);
+			const double c = r_kk / rho;
+			const double s = v[k] / rho;
+
+			_R[index(k, k)] = rho;
+
+			for (int j = k + 1; j < _forder; j++) {
+				const double r_kj = _R[index(k, j)];
+				_R[index(k, j)] = c * r_kj + s * v[j];
+				v[j] = c * v[j] - s * r_kj;
+			}
+
+			const double qty_k = _QTY[k];
+			_QTY[k] = c * qty_k + s * y;
+			y = c * y - s * qty_k;
+		}
+
+		_rss += y * y;
+		_count++;
+		return y;
+	}
+
+	/**
+	 * solve for the coefficients of the current fit, highest order first
+	 * @return false if there are not enough distinct samples yet
+	 */
+	bool fit(double res[]) const
+	{
+		for (int i = _forder - 1; i >= 0; i--) {
+			const double r_ii = _R[index(i, i)];
+
+			if (fabs(r_ii) <= 0.0) {
+				return false;
+			}
+
+			double sum = _QTY[i];
+
+			for (int j = i + 1; j < _forder; j++) {
+				sum -= _R[index(i, j)] * res[j];
+			}
+
+			res[i] = sum / r_ii;
+			PF_DEBUG("%.10f ", res[i]);
+		}
+
+		return true;
+	}
+
+	/**
+	 * re-expand fit coefficients (highest order first) about a new origin, so that the
+	 * polynomial evaluated at x equals the original one evaluated at x + dx
+	 */
+	static void shift(double res[], double dx)
+	{
+		for (int i = 0; i < _forder - 1; i++) {
+			for (int j = 1; j < _forder - i; j++) {
+				res[j] += dx * res[j - 1];
+			}
+		}
+	}
+
+	unsigned sample_count() const { return _count; }
+
+	/** RMS of the residuals of the current fit */
+	double residual_rms() const
+	{
+		return (_count > (unsigned)_forder) ? sqrt(_rss / (double)(_count - _forder)) : 0.0;
+	}
+
+private:
+	static constexpr int index(int row, int col) { return row * _forder - row * (row - 1) / 2 + col - row; }
+
+	double _R[_forder * (_forder + 1) / 2] {}; ///< upper triangle of R, packed row by row
+	double _QTY[_forder] {};
+	double _rss{0.0};
+	unsigned _count{0};
+};
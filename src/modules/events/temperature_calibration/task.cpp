@@ -134,6 +134,13 @@ void TemperatureCalibration::task_main()
 	int32_t max_start_temp = 10;
 	param_get(param_find("SYS_CAL_TMAX"), &max_start_temp);
 
+	int32_t early_temp_rise = 0;
+	param_get(param_find("SYS_CAL_TEARLY"), &early_temp_rise);
+
+	if (early_temp_rise > 0) {
+		PX4_INFO("Ending soak of converged sensors after %i degrees difference", early_temp_rise);
+	}
+
 	//init calibrators
 	TemperatureCalibrationBase *calibrators[3];
 	bool error_reported[3] = {};
@@ -176,6 +183,7 @@ void TemperatureCalibration::task_main()
 	// reset params
 	for (int i = 0; i < num_calibrators; ++i) {
 		calibrators[i]->reset_calibration();
+		calibrators[i]->set_early_termination(early_temp_rise);
 	}
 
 	// make sure the system updates the changed parameters
@@ -884,9 +884,13 @@ void FixedwingAttitudeControl::run()
 
 			/* lazily publish the setpoint only once available */
 			_actuators.timestamp = hrt_absolute_time();
-			_actuators.timestamp_sample = _att.timestamp;
+			/* estimators that do not report the sensor sample time leave timestamp_sample 0 */
+			_actuators.timestamp_sample = (_att.timestamp_sample > 0) ? _att.timestamp_sample : _att.timestamp;
+			_actuators.estimator_latency = (_att.timestamp_sample > 0 && _att.timestamp >= _att.timestamp_sample) ?
+						       _att.timestamp - _att.timestamp_sample : 0;
 			_actuators_airframe.timestamp = hrt_absolute_time();
-			_actuators_airframe.timestamp_sample = _att.timestamp;
+			_actuators_airframe.timestamp_sample = _actuators.timestamp_sample;
+			_actuators_airframe.estimator_latency = _actuators.estimator_latency;
 
 			/* Only publish if any of the proper modes are enabled */
 			if (_vcontrol_mode.flag_control_rates_enabled ||
@@ -982,7 +986,7 @@ int FixedwingAttitudeControl::task_spawn(int argc, char *argv[])
 	_task_id = px4_task_spawn_cmd("fw_att_controol",
 				      SCHED_DEFAULT,
 				      SCHED_PRIORITY_ATTITUDE_CONTROL,
-				      1500,
+				      1500 + ACTUATOR_CONTROLS_CALLBACK_ADDED_STACK,
 				      (px4_main_t)&run_trampoline,
 				      (char *const *)argv);
 
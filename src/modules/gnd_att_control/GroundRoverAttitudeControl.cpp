@@ -323,7 +323,10 @@ GroundRoverAttitudeControl::task_main()
 
 			/* lazily publish the setpoint only once available */
 			_actuators.timestamp = hrt_absolute_time();
-			_actuators.timestamp_sample = _att.timestamp;
+			/* estimators that do not report the sensor sample time leave timestamp_sample 0 */
+			_actuators.timestamp_sample = (_att.timestamp_sample > 0) ? _att.timestamp_sample : _att.timestamp;
+			_actuators.estimator_latency = (_att.timestamp_sample > 0 && _att.timestamp >= _att.timestamp_sample) ?
+						       _att.timestamp - _att.timestamp_sample : 0;
 
 			/* Only publish if any of the proper modes are enabled */
 			if (_vcontrol_mode.flag_control_attitude_enabled ||
@@ -358,7 +361,7 @@ GroundRoverAttitudeControl::start()
 	_control_task = px4_task_spawn_cmd("gnd_att_control",
 					   SCHED_DEFAULT,
 					   SCHED_PRIORITY_MAX - 5,
-					   1500,
+					   1500 + ACTUATOR_CONTROLS_CALLBACK_ADDED_STACK,
 					   (px4_main_t)&GroundRoverAttitudeControl::task_main_trampoline,
 					   nullptr);
 
@@ -140,7 +140,11 @@ BlockLocalPositionEstimator::BlockLocalPositionEstimator() :
 	_global_ref_timestamp(0.0),
 	_ref_lat(0.0),
 	_ref_lon(0.0),
-	_ref_alt(0.0)
+	_ref_alt(0.0),
+
+	// cpu time accounting
+	_perf_predict(perf_alloc(PC_ELAPSED, "lpe predict")),
+	_perf_correct(perf_alloc(PC_ELAPSED, "lpe correct"))
 {
 	// assign distance subs to array
 	_dist_subs[0] = &_sub_dist0;
@@ -180,6 +184,18 @@ BlockLocalPositionEstimator::BlockLocalPositionEstimator() :
 	       (_fusion.get() & FUSE_BARO) != 0);
 }
 
+BlockLocalPositionEstimator::~BlockLocalPositionEstimator()
+{
+	perf_free(_perf_predict);
+	perf_free(_perf_correct);
+}
+
+void BlockLocalPositionEstimator::print_status()
+{
+	perf_print_counter(_perf_predict);
+	perf_print_counter(_perf_correct);
+}
+
 Vector<float, BlockLocalPositionEstimator::n_x> BlockLocalPositionEstimator::dynamics(
 	float t,
 	const Vector<float, BlockLocalPositionEstimator::n_x> &x,
@@ -387,38 +403,13 @@ void BlockLocalPositionEstimator::update()
 		mavlink_and_console_log_info(&mavlink_log_pub, "%sreinit x", msg_label);
 	}
 
-	// force P symmetry and reinitialize P if necessary
-	bool reinit_P = false;
-
-	for (size_t i = 0; i < n_x; i++) {
-		for (size_t j = 0; j <= i; j++) {
-			if (!PX4_ISFINITE(_P(i, j))) {
-				mavlink_and_console_log_info(&mavlink_log_pub,
-							     "%sreinit P (%zu, %zu) not finite", msg_label, i, j);
-				reinit_P = true;
-			}
-
-			if (i == j) {
-				// make sure diagonal elements are positive
-				if (_P(i, i) <= 0) {
-					mavlink_and_console_log_info(&mavlink_log_pub,
-								     "%sreinit P (%zu, %zu) negative", msg_label, i, j);
-					reinit_P = true;
-				}
-
-			} else {
-				// copy elememnt from upper triangle to force
-				// symmetry
-				_P(j, i) = _P(i, j);
-			}
-
-			if (reinit_P) { break; }
-		}
+	// reinitialize P if necessary, symmetry holds by construction
+	size_t P_row = 0;
+	size_t P_col = 0;
 
-		if (reinit_P) { break; }
-	}
-
-	if (reinit_P) {
+	if (!_P.valid(P_row, P_col)) {
+		mavlink_and_console_log_info(&mavlink_log_pub, "%sreinit P (%zu, %zu) %s", msg_label, P_row, P_col,
+					     PX4_ISFINITE(_P(P_row, P_col)) ? "negative" : "not finite");
 		initP();
 	}
 
@@ -904,6 +895,8 @@ void BlockLocalPositionEstimator::updateSSParams()
 
 void BlockLocalPositionEstimator::predict()
 {
+	perf_begin(_perf_predict);
+
 	// get acceleration
 	_R_att = matrix::Dcm<float>(matrix::Quatf(_sub_att.get().q));
 	Vector3f a(_sub_sensor.get().accelerometer_m_s2);
@@ -966,23 +959,23 @@ void BlockLocalPositionEstimator::predict()
 
 	// propagate
 	_x += dx;
-	Matrix<float, n_x, n_x> dP = (_A * _P + _P * _A.transpose() +
-				      _B * _R * _B.transpose() + _Q) * getDt();
 
-	// covariance propagation logic
-	for (size_t i = 0; i < n_x; i++) {
-		if (_P(i, i) > P_MAX) {
-			// if diagonal element greater than max, stop propagating
-			dP(i, i) = 0;
+	// dP = (A * P + P * A' + B * R * B' + Q) * dt, using the sparsity of A.
+	// B maps the input noise onto the velocity states, R and Q are diagonal.
+	Vector<float, n_x> q;
 
-			for (size_t j = 0; j < n_x; j++) {
-				dP(i, j) = 0;
-				dP(j, i) = 0;
-			}
-		}
+	for (size_t i = 0; i < n_x; i++) {
+		q(i) = _Q(i, i);
 	}
 
-	_P += dP;
+	q(X_vx) += _R(U_ax, U_ax);
+	q(X_vy) += _R(U_ay, U_ay);
+	q(X_vz) += _R(U_az, U_az);
+
+	_P.predict(_A, q, getDt(), P_MAX);
+
+	perf_end(_perf_predict);
+
 	_xLowPass.update(_x);
 	_aglLowPass.update(agl());
 }
@@ -7,6 +7,9 @@
 #include <mathlib/mathlib.h>
 #include <lib/ecl/geo/geo.h>
 #include <matrix/Matrix.hpp>
+#include <perf/perf_counter.h>
+
+#include "SymmetricCovariance.hpp"
 
 // uORB Subscriptions
 #include <uORB/Subscription.hpp>
@@ -150,7 +153,8 @@ public:
 	// public methods
 	BlockLocalPositionEstimator();
 	void update();
-	virtual ~BlockLocalPositionEstimator() = default;
+	void print_status();
+	virtual ~BlockLocalPositionEstimator();
 
 private:
 	BlockLocalPositionEstimator(const BlockLocalPositionEstimator &) = delete;
@@ -171,6 +175,54 @@ private:
 	// predict the next state
 	void predict();
 
+	// diagonal of the innovation covariance C * P * C' + R
+	template<size_t n_y>
+	Vector<float, n_y> innovationVariance(const Matrix<float, n_y, n_x> &C, const Matrix<float, n_y, n_y> &R) const
+	{
+		Vector<float, n_y> S_diag;
+
+		for (size_t i = 0; i < n_y; i++) {
+			S_diag(i) = _P.quadratic(measurementRow(C, i)) + R(i, i);
+		}
+
+		return S_diag;
+	}
+
+	// sequential scalar kalman correction, one measurement at a time (R must be diagonal),
+	// staged in _P_corr and _dx_corr until applyCorrection() so that faulty data can be
+	// rejected, returns the fault detection statistic r' * inv(C * P * C' + R) * r
+	template<size_t n_y>
+	float computeCorrection(const Matrix<float, n_y, n_x> &C, const Matrix<float, n_y, n_y> &R,
+				const Vector<float, n_y> &r, float *beta_i = nullptr)
+	{
+		perf_begin(_perf_correct);
+
+		_P_corr = _P;
+		const float beta = _P_corr.sequentialUpdate(C, R, r, _dx_corr, beta_i);
+
+		perf_end(_perf_correct);
+
+		return beta;
+	}
+
+	void applyCorrection()
+	{
+		_x += _dx_corr;
+		_P = _P_corr;
+	}
+
+	template<size_t n_y>
+	static Vector<float, n_x> measurementRow(const Matrix<float, n_y, n_x> &C, size_t i)
+	{
+		Vector<float, n_x> h;
+
+		for (size_t j = 0; j < n_x; j++) {
+			h(j) = C(i, j);
+		}
+
+		return h;
+	}
+
 	// lidar
 	int  lidarMeasure(Vector<float, n_y_lidar> &y);
 	void lidarCorrect();
@@ -436,7 +488,14 @@ private:
 	// state space
 	Vector<float, n_x>  _x;	// state vector
 	Vector<float, n_u>  _u;	// input vector
-	Matrix<float, n_x, n_x>  _P;	// state covariance matrix
+	SymmetricCovariance<float, n_x>  _P;	// state covariance matrix, upper triangle
+
+	// staged sequential correction, see computeCorrection()
+	SymmetricCovariance<float, n_x>  _P_corr;
+	Vector<float, n_x>  _dx_corr;
+
+	perf_counter_t _perf_predict;
+	perf_counter_t _perf_correct;
 
 	matrix::Dcm<float> _R_att;
 
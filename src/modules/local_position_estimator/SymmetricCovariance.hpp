@@ -0,0 +1,295 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2018 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+/**
+ * @file SymmetricCovariance.hpp
+ *
+ * Covariance matrix storing only the upper triangle, with a sequential
+ * scalar measurement update.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cmath>
+
+#include <matrix/Matrix.hpp>
+
+template<typename Type, size_t N>
+class SymmetricCovariance
+{
+public:
+	static constexpr size_t SIZE = N * (N + 1) / 2;
+
+	SymmetricCovariance()
+	{
+		setZero();
+	}
+
+	Type &operator()(size_t i, size_t j)
+	{
+		return _data[index(i, j)];
+	}
+
+	const Type &operator()(size_t i, size_t j) const
+	{
+		return _data[index(i, j)];
+	}
+
+	void setZero()
+	{
+		for (size_t k = 0; k < SIZE; k++) {
+			_data[k] = 0;
+		}
+	}
+
+	/**
+	 * Find the first element that is not finite or variance that is not positive.
+	 * @return false and the offending element if found
+	 */
+	bool valid(size_t &row, size_t &col) const
+	{
+		size_t k = 0;
+
+		for (size_t i = 0; i < N; i++) {
+			for (size_t j = i; j < N; j++, k++) {
+				if (!std::isfinite(_data[k]) || (i == j && _data[k] <= 0)) {
+					row = i;
+					col = j;
+					return false;
+				}
+			}
+		}
+
+		return true;
+	}
+
+	/**
+	 * Quadratic form h' P h, only the non-zero elements of h are visited.
+	 */
+	Type quadratic(const matrix::Vector<Type, N> &h) const
+	{
+		size_t nz[N];
+		const size_t n_nz = nonzero(h, nz);
+
+		Type sum = 0;
+
+		for (size_t a = 0; a < n_nz; a++) {
+			for (size_t b = 0; b < n_nz; b++) {
+				sum += h(nz[a]) * (*this)(nz[a], nz[b]) * h(nz[b]);
+			}
+		}
+
+		return sum;
+	}
+
+	/**
+	 * Scalar Kalman update for a measurement y = h' x with noise variance r:
+	 * P -= P h h' P / s, with s = h' P h + r.
+	 *
+	 * @param h measurement row, usually with one or two non-zero elements
+	 * @param r measurement noise variance
+	 * @param K returns the Kalman gain P h / s
+	 * @return the innovation variance s
+	 */
+	Type scalarUpdate(const matrix::Vector<Type, N> &h, Type r, matrix::Vector<Type, N> &K)
+	{
+		size_t nz[N];
+		const size_t n_nz = nonzero(h, nz);
+
+		// P h
+		Type ph[N];
+
+		for (size_t i = 0; i < N; i++) {
+			ph[i] = 0;
+
+			for (size_t a = 0; a < n_nz; a++) {
+				ph[i] += (*this)(i, nz[a]) * h(nz[a]);
+			}
+		}
+
+		Type s = r;
+
+		for (size_t a = 0; a < n_nz; a++) {
+			s += h(nz[a]) * ph[nz[a]];
+		}
+
+		// rank one downdate of the upper triangle
+		size_t k = 0;
+
+		for (size_t i = 0; i < N; i++) {
+			const Type ph_i_s = ph[i] / s;
+			K(i) = ph_i_s;
+
+			for (size_t j = i; j < N; j++, k++) {
+				_data[k] -= ph_i_s * ph[j];
+			}
+		}
+
+		return s;
+	}
+
+	/**
+	 * Sequential Kalman correction, one scalar measurement at a time. R must be
+	 * diagonal, the result is then the same as the batch update with C P C' + R.
+	 *
+	 * @param C measurement matrix
+	 * @param R measurement noise covariance (only the diagonal is used)
+	 * @param r innovation y - C x
+	 * @param dx returns the state correction
+	 * @param beta_i optional, returns the fault detection statistic of each measurement
+	 * @return the fault detection statistic r' * inv(C P C' + R) * r
+	 */
+	template<size_t M>
+	Type sequentialUpdate(const matrix::Matrix<Type, M, N> &C, const matrix::Matrix<Type, M, M> &R,
+			      const matrix::Vector<Type, M> &r, matrix::Vector<Type, N> &dx, Type *beta_i = nullptr)
+	{
+		dx.setZero();
+
+		Type beta = 0;
+		matrix::Vector<Type, N> K;
+
+		for (size_t i = 0; i < M; i++) {
+			matrix::Vector<Type, N> h;
+
+			for (size_t j = 0; j < N; j++) {
+				h(j) = C(i, j);
+			}
+
+			// residual with respect to the state corrected by the previous measurements
+			const Type r_i = r(i) - h.dot(dx);
+			const Type s = scalarUpdate(h, R(i, i), K);
+			dx += K * r_i;
+
+			const Type beta_ii = r_i * r_i / s;
+			beta += beta_ii;
+
+			if (beta_i != nullptr) {
+				beta_i[i] = beta_ii;
+			}
+		}
+
+		return beta;
+	}
+
+	/**
+	 * Continuous time prediction P += (A P + P A' + diag(q)) dt. Only the non-zero
+	 * elements of A are visited, and P A' is the transpose of A P. Rows and columns
+	 * whose variance exceeds p_max are not propagated.
+	 *
+	 * @param A dynamics matrix
+	 * @param q diagonal of the noise B R B' + Q
+	 * @param dt time step
+	 * @param p_max variance above which a state is not propagated any more
+	 */
+	void predict(const matrix::Matrix<Type, N, N> &A, const matrix::Vector<Type, N> &q, Type dt, Type p_max)
+	{
+		Type AP[N][N];
+		size_t nz[N];
+
+		for (size_t i = 0; i < N; i++) {
+			size_t n_nz = 0;
+
+			for (size_t k = 0; k < N; k++) {
+				if (A(i, k) != 0) {
+					nz[n_nz++] = k;
+				}
+			}
+
+			for (size_t j = 0; j < N; j++) {
+				Type sum = 0;
+
+				for (size_t a = 0; a < n_nz; a++) {
+					sum += A(i, nz[a]) * (*this)(nz[a], j);
+				}
+
+				AP[i][j] = sum;
+			}
+		}
+
+		bool frozen[N];
+
+		for (size_t i = 0; i < N; i++) {
+			frozen[i] = (*this)(i, i) > p_max;
+		}
+
+		size_t k = 0;
+
+		for (size_t i = 0; i < N; i++) {
+			for (size_t j = i; j < N; j++, k++) {
+				if (frozen[i] || frozen[j]) {
+					continue;
+				}
+
+				Type dP = AP[i][j] + AP[j][i];
+
+				if (i == j) {
+					dP += q(i);
+				}
+
+				_data[k] += dP * dt;
+			}
+		}
+	}
+
+private:
+	/**
+	 * Row major upper triangle index, the lower triangle maps onto it.
+	 */
+	static size_t index(size_t i, size_t j)
+	{
+		if (i > j) {
+			const size_t tmp = i;
+			i = j;
+			j = tmp;
+		}
+
+		return i * N - (i * (i - 1)) / 2 + (j - i);
+	}
+
+	static size_t nonzero(const matrix::Vector<Type, N> &h, size_t nz[N])
+	{
+		size_t n = 0;
+
+		for (size_t i = 0; i < N; i++) {
+			if (h(i) != 0) {
+				nz[n++] = i;
+			}
+		}
+
+		return n;
+	}
+
+	Type _data[SIZE];
+};
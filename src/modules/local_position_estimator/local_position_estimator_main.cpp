@@ -68,6 +68,9 @@ public:
 	/** @see ModuleBase::run() */
 	void run() override;
 
+	/** @see ModuleBase::print_status() */
+	int print_status() override;
+
 private:
 	BlockLocalPositionEstimator _estimator;
 };
@@ -126,6 +129,12 @@ LocalPositionEstimatorModule *LocalPositionEstimatorModule::instantiate(int argc
 	return instance;
 }
 
+int LocalPositionEstimatorModule::print_status()
+{
+	_estimator.print_status();
+	return 0;
+}
+
 void LocalPositionEstimatorModule::run()
 {
 	while (!should_exit()) {
@@ -67,12 +67,10 @@ void BlockLocalPositionEstimator::baroCorrect()
 	R(0, 0) = _baro_stddev.get() * _baro_stddev.get();
 
 	// residual
-	Matrix<float, n_y_baro, n_y_baro> S_I =
-		inv<float, n_y_baro>((C * _P * C.transpose()) + R);
 	Vector<float, n_y_baro> r = y - (C * _x);
 
-	// fault detection
-	float beta = (r.transpose() * (S_I * r))(0, 0);
+	// sequential correction and fault detection
+	float beta = computeCorrection(C, R, r);
 
 	if (beta > BETA_TABLE[n_y_baro]) {
 		if (!(_sensorFault & SENSOR_BARO)) {
@@ -87,10 +85,7 @@ void BlockLocalPositionEstimator::baroCorrect()
 	}
 
 	// kalman filter correction always
-	Matrix<float, n_x, n_y_baro> K = _P * C.transpose() * S_I;
-	Vector<float, n_x> dx = K * r;
-	_x += dx;
-	_P -= K * C * _P;
+	applyCorrection();
 }
 
 void BlockLocalPositionEstimator::baroCheckTimeout()
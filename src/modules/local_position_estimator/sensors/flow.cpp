@@ -171,19 +171,16 @@ void BlockLocalPositionEstimator::flowCorrect()
 	Vector<float, 2> r = y - C * _x;
 
 	// residual covariance
-	Matrix<float, n_y_flow, n_y_flow> S = C * _P * C.transpose() + R;
+	Vector<float, n_y_flow> S = innovationVariance(C, R);
 
 	// publish innovations
 	_pub_innov.get().flow_innov[0] = r(0);
 	_pub_innov.get().flow_innov[1] = r(1);
-	_pub_innov.get().flow_innov_var[0] = S(0, 0);
-	_pub_innov.get().flow_innov_var[1] = S(1, 1);
+	_pub_innov.get().flow_innov_var[0] = S(0);
+	_pub_innov.get().flow_innov_var[1] = S(1);
 
-	// residual covariance, (inverse)
-	Matrix<float, n_y_flow, n_y_flow> S_I = inv<float, n_y_flow>(S);
-
-	// fault detection
-	float beta = (r.transpose() * (S_I * r))(0, 0);
+	// sequential correction and fault detection
+	float beta = computeCorrection(C, R, r);
 
 	if (beta > BETA_TABLE[n_y_flow]) {
 		if (!(_sensorFault & SENSOR_FLOW)) {
@@ -197,11 +194,7 @@ void BlockLocalPositionEstimator::flowCorrect()
 	}
 
 	if (!(_sensorFault & SENSOR_FLOW)) {
-		Matrix<float, n_x, n_y_flow> K =
-			_P * C.transpose() * S_I;
-		Vector<float, n_x> dx = K * r;
-		_x += dx;
-		_P -= K * C * _P;
+		applyCorrection();
 	}
 }
 
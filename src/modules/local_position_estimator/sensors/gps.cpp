@@ -186,19 +186,17 @@ void BlockLocalPositionEstimator::gpsCorrect()
 	Vector<float, n_y_gps> r = y - C * x0;
 
 	// residual covariance
-	Matrix<float, n_y_gps, n_y_gps> S = C * _P * C.transpose() + R;
+	Vector<float, n_y_gps> S = innovationVariance(C, R);
 
 	// publish innovations
 	for (size_t i = 0; i < 6; i++) {
 		_pub_innov.get().vel_pos_innov[i] = r(i);
-		_pub_innov.get().vel_pos_innov_var[i] = S(i, i);
+		_pub_innov.get().vel_pos_innov_var[i] = S(i);
 	}
 
-	// residual covariance, (inverse)
-	Matrix<float, n_y_gps, n_y_gps> S_I = inv<float, n_y_gps>(S);
-
-	// fault detection
-	float beta = (r.transpose() * (S_I * r))(0, 0);
+	// sequential correction and fault detection
+	float beta_i[n_y_gps];
+	float beta = computeCorrection(C, R, r, beta_i);
 
 	// artifically increase beta threshhold to prevent fault during landing
 	float beta_thresh = 1e2f;
@@ -206,8 +204,8 @@ void BlockLocalPositionEstimator::gpsCorrect()
 	if (beta / BETA_TABLE[n_y_gps] > beta_thresh) {
 		if (!(_sensorFault & SENSOR_GPS)) {
 			mavlink_log_critical(&mavlink_log_pub, "[lpe] gps fault %3g %3g %3g %3g %3g %3g",
-					     double(r(0) * r(0) / S_I(0, 0)),  double(r(1) * r(1) / S_I(1, 1)), double(r(2) * r(2) / S_I(2, 2)),
-					     double(r(3) * r(3) / S_I(3, 3)),  double(r(4) * r(4) / S_I(4, 4)), double(r(5) * r(5) / S_I(5, 5)));
+					     double(beta_i[0]), double(beta_i[1]), double(beta_i[2]),
+					     double(beta_i[3]), double(beta_i[4]), double(beta_i[5]));
 			_sensorFault |= SENSOR_GPS;
 		}
 
@@ -217,10 +215,7 @@ void BlockLocalPositionEstimator::gpsCorrect()
 	}
 
 	// kalman filter correction always for GPS
-	Matrix<float, n_x, n_y_gps> K = _P * C.transpose() * S_I;
-	Vector<float, n_x> dx = K * r;
-	_x += dx;
-	_P -= K * C * _P;
+	applyCorrection();
 }
 
 void BlockLocalPositionEstimator::gpsCheckTimeout()
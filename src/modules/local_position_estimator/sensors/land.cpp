@@ -59,13 +59,12 @@ void BlockLocalPositionEstimator::landCorrect()
 	R(Y_land_agl, Y_land_agl) = _land_z_stddev.get() * _land_z_stddev.get();
 
 	// residual
-	Matrix<float, n_y_land, n_y_land> S_I = inv<float, n_y_land>((C * _P * C.transpose()) + R);
 	Vector<float, n_y_land> r = y - C * _x;
 	_pub_innov.get().hagl_innov = r(Y_land_agl);
 	_pub_innov.get().hagl_innov_var = R(Y_land_agl, Y_land_agl);
 
-	// fault detection
-	float beta = (r.transpose() * (S_I * r))(0, 0);
+	// sequential correction and fault detection
+	float beta = computeCorrection(C, R, r);
 
 	// artifically increase beta threshhold to prevent fault during landing
 	float beta_thresh = 1e2f;
@@ -85,10 +84,7 @@ void BlockLocalPositionEstimator::landCorrect()
 	}
 
 	// kalman filter correction always for land detector
-	Matrix<float, n_x, n_y_land> K = _P * C.transpose() * S_I;
-	Vector<float, n_x> dx = K * r;
-	_x += dx;
-	_P -= K * C * _P;
+	applyCorrection();
 }
 
 void BlockLocalPositionEstimator::landCheckTimeout()
@@ -80,12 +80,8 @@ void BlockLocalPositionEstimator::landingTargetCorrect()
 	// residual
 	Vector<float, n_y_target> r = y - C * _x;
 
-	// residual covariance, (inverse)
-	Matrix<float, n_y_target, n_y_target> S_I =
-		inv<float, n_y_target>(C * _P * C.transpose() + R);
-
-	// fault detection
-	float beta = (r.transpose()  * (S_I * r))(0, 0);
+	// sequential correction and fault detection
+	float beta = computeCorrection(C, R, r);
 
 	if (beta > BETA_TABLE[n_y_target]) {
 		if (!(_sensorFault & SENSOR_LAND_TARGET)) {
@@ -102,12 +98,7 @@ void BlockLocalPositionEstimator::landingTargetCorrect()
 	}
 
 	// kalman filter correction
-	Matrix<float, n_x, n_y_target> K =
-		_P * C.transpose() * S_I;
-	Vector<float, n_x> dx = K * r;
-	_x += dx;
-	_P -= K * C * _P;
-
+	applyCorrection();
 }
 
 void BlockLocalPositionEstimator::landingTargetCheckTimeout()
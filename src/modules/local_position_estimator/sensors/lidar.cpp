@@ -89,17 +89,14 @@ void BlockLocalPositionEstimator::lidarCorrect()
 	// residual
 	Vector<float, n_y_lidar> r = y - C * _x;
 	// residual covariance
-	Matrix<float, n_y_lidar, n_y_lidar> S = C * _P * C.transpose() + R;
+	Vector<float, n_y_lidar> S = innovationVariance(C, R);
 
 	// publish innovations
 	_pub_innov.get().hagl_innov = r(0);
-	_pub_innov.get().hagl_innov_var = S(0, 0);
+	_pub_innov.get().hagl_innov_var = S(0);
 
-	// residual covariance, (inverse)
-	Matrix<float, n_y_lidar, n_y_lidar> S_I = inv<float, n_y_lidar>(S);
-
-	// fault detection
-	float beta = (r.transpose() * (S_I * r))(0, 0);
+	// sequential correction and fault detection
+	float beta = computeCorrection(C, R, r);
 
 	if (beta > BETA_TABLE[n_y_lidar]) {
 		if (!(_sensorFault & SENSOR_LIDAR)) {
@@ -116,10 +113,7 @@ void BlockLocalPositionEstimator::lidarCorrect()
 	}
 
 	// kalman filter correction always
-	Matrix<float, n_x, n_y_lidar> K = _P * C.transpose() * S_I;
-	Vector<float, n_x> dx = K * r;
-	_x += dx;
-	_P -= K * C * _P;
+	applyCorrection();
 }
 
 void BlockLocalPositionEstimator::lidarCheckTimeout()
@@ -141,12 +141,12 @@ void BlockLocalPositionEstimator::mocapCorrect()
 	// residual
 	Vector<float, n_y_mocap> r = y - C * _x;
 	// residual covariance
-	Matrix<float, n_y_mocap, n_y_mocap> S = C * _P * C.transpose() + R;
+	Vector<float, n_y_mocap> S = innovationVariance(C, R);
 
 	// publish innovations
 	for (size_t i = 0; i < 3; i++) {
 		_pub_innov.get().vel_pos_innov[i] = r(i);
-		_pub_innov.get().vel_pos_innov_var[i] = S(i, i);
+		_pub_innov.get().vel_pos_innov_var[i] = S(i);
 	}
 
 	for (size_t i = 3; i < 6; i++) {
@@ -154,11 +154,8 @@ void BlockLocalPositionEstimator::mocapCorrect()
 		_pub_innov.get().vel_pos_innov_var[i] = 1;
 	}
 
-	// residual covariance, (inverse)
-	Matrix<float, n_y_mocap, n_y_mocap> S_I = inv<float, n_y_mocap>(S);
-
-	// fault detection
-	float beta = (r.transpose() * (S_I * r))(0, 0);
+	// sequential correction and fault detection
+	float beta = computeCorrection(C, R, r);
 
 	if (beta > BETA_TABLE[n_y_mocap]) {
 		if (!(_sensorFault & SENSOR_MOCAP)) {
@@ -172,10 +169,7 @@ void BlockLocalPositionEstimator::mocapCorrect()
 	}
 
 	// kalman filter correction always
-	Matrix<float, n_x, n_y_mocap> K = _P * C.transpose() * S_I;
-	Vector<float, n_x> dx = K * r;
-	_x += dx;
-	_P -= K * C * _P;
+	applyCorrection();
 }
 
 void BlockLocalPositionEstimator::mocapCheckTimeout()
@@ -156,14 +156,14 @@ void BlockLocalPositionEstimator::visionCorrect()
 	Vector<float, n_x> x0 = _xDelay.get(i_hist);
 
 	// residual
-	Matrix<float, n_y_vision, 1> r = y - C * x0;
+	Vector<float, n_y_vision> r = y - C * x0;
 	// residual covariance
-	Matrix<float, n_y_vision, n_y_vision> S = C * _P * C.transpose() + R;
+	Vector<float, n_y_vision> S = innovationVariance(C, R);
 
 	// publish innovations
 	for (size_t i = 0; i < 3; i++) {
-		_pub_innov.get().vel_pos_innov[i] = r(i, 0);
-		_pub_innov.get().vel_pos_innov_var[i] = S(i, i);
+		_pub_innov.get().vel_pos_innov[i] = r(i);
+		_pub_innov.get().vel_pos_innov_var[i] = S(i);
 	}
 
 	for (size_t i = 3; i < 6; i++) {
@@ -171,11 +171,8 @@ void BlockLocalPositionEstimator::visionCorrect()
 		_pub_innov.get().vel_pos_innov_var[i] = 1;
 	}
 
-	// residual covariance, (inverse)
-	Matrix<float, n_y_vision, n_y_vision> S_I = inv<float, n_y_vision>(S);
-
-	// fault detection
-	float beta = (r.transpose() * (S_I * r))(0, 0);
+	// sequential correction and fault detection
+	float beta = computeCorrection(C, R, r);
 
 	if (beta > BETA_TABLE[n_y_vision]) {
 		if (!(_sensorFault & SENSOR_VISION)) {
@@ -190,10 +187,7 @@ void BlockLocalPositionEstimator::visionCorrect()
 
 	// kalman filter correction if no fault
 	if (!(_sensorFault & SENSOR_VISION)) {
-		Matrix<float, n_x, n_y_vision> K = _P * C.transpose() * S_I;
-		Vector<float, n_x> dx = K * r;
-		_x += dx;
-		_P -= K * C * _P;
+		applyCorrection();
 	}
 }
 
@@ -87,6 +87,7 @@ void LogWriterMavlink::start_log()
 	_ulog_stream_data.sequence = 0;
 	_ulog_stream_data.length = 0;
 	_ulog_stream_data.first_message_offset = 0;
+	_next_ack_sequence = 0;
 	_is_started = true;
 }
 
@@ -133,6 +134,12 @@ void LogWriterMavlink::set_need_reliable_transfer(bool need_reliable)
 			// make sure to send previous data using reliable transfer
 			publish_message();
 		}
+
+		// all reliable data must be acked before switching
+		if (is_started() && wait_for_acks(0)) {
+			PX4_ERR("Ack timeout. Stopping mavlink log");
+			stop_log();
+		}
 	}
 
 	_need_reliable_transfer = need_reliable;
@@ -154,49 +161,60 @@ int LogWriterMavlink::publish_message()
 		orb_publish(ORB_ID(ulog_stream), _ulog_stream_pub, &_ulog_stream_data);
 	}
 
+	_ulog_stream_data.sequence++;
+	_ulog_stream_data.length = 0;
+	_ulog_stream_data.first_message_offset = 255;
+
 	if (_need_reliable_transfer) {
-		// we need to wait for an ack. Note that this blocks the main logger thread, so if a file logging
-		// is already running, it will miss samples.
-		px4_pollfd_struct_t fds[1];
-		fds[0].fd = _ulog_stream_ack_sub;
-		fds[0].events = POLLIN;
-		bool got_ack = false;
-		const int timeout_ms = ulog_stream_ack_s::ACK_TIMEOUT * ulog_stream_ack_s::ACK_MAX_TRIES;
+		// Mavlink sends the queued messages in order, each one once the previous one is acked, so we only
+		// need to block once the number of unacked messages reaches the queue size (otherwise the queue
+		// would overflow).
+		// Note that this blocks the main logger thread, so if a file logging is already running,
+		// it might miss samples.
+		if (wait_for_acks(_queue_size - 1)) {
+			PX4_ERR("Ack timeout. Stopping mavlink log");
+			stop_log();
+			return -2;
+		}
+
+	} else {
+		_next_ack_sequence = _ulog_stream_data.sequence;
+	}
 
-		hrt_abstime started = hrt_absolute_time();
+	return 0;
+}
 
-		do {
-			int ret = px4_poll(fds, sizeof(fds) / sizeof(fds[0]), timeout_ms);
+int LogWriterMavlink::wait_for_acks(unsigned max_outstanding)
+{
+	px4_pollfd_struct_t fds[1];
+	fds[0].fd = _ulog_stream_ack_sub;
+	fds[0].events = POLLIN;
+	const int timeout_ms = ulog_stream_ack_s::ACK_TIMEOUT * ulog_stream_ack_s::ACK_MAX_TRIES;
 
-			if (ret <= 0) {
-				break;
-			}
+	// number of published reliable messages that are not acked yet
+	auto outstanding = [this]() { return (uint16_t)(_ulog_stream_data.sequence - _next_ack_sequence); };
 
-			if (fds[0].revents & POLLIN) {
-				ulog_stream_ack_s ack;
-				orb_copy(ORB_ID(ulog_stream_ack), _ulog_stream_ack_sub, &ack);
+	hrt_abstime last_progress = hrt_absolute_time();
 
-				if (ack.sequence == _ulog_stream_data.sequence) {
-					got_ack = true;
-				}
+	while (outstanding() > max_outstanding) {
+		int ret = px4_poll(fds, sizeof(fds) / sizeof(fds[0]), timeout_ms);
 
-			} else {
-				break;
-			}
-		} while (!got_ack && hrt_elapsed_time(&started) / 1000 < timeout_ms);
+		if (ret > 0 && (fds[0].revents & POLLIN)) {
+			ulog_stream_ack_s ack;
+			orb_copy(ORB_ID(ulog_stream_ack), _ulog_stream_ack_sub, &ack);
 
-		if (!got_ack) {
-			PX4_ERR("Ack timeout. Stopping mavlink log");
-			stop_log();
-			return -2;
+			// only accept acks for published messages that are not acked yet
+			if ((uint16_t)(ack.sequence - _next_ack_sequence) < outstanding()) {
+				_next_ack_sequence = ack.sequence + 1;
+				last_progress = hrt_absolute_time();
+			}
 		}
 
-		PX4_DEBUG("got ack in %i ms", (int)(hrt_elapsed_time(&started) / 1000));
+		if (ret < 0 || hrt_elapsed_time(&last_progress) / 1000 >= (hrt_abstime)timeout_ms) {
+			return -1;
+		}
 	}
 
-	_ulog_stream_data.sequence++;
-	_ulog_stream_data.length = 0;
-	_ulog_stream_data.first_message_offset = 255;
 	return 0;
 }
 
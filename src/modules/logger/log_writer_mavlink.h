@@ -75,9 +75,17 @@ private:
 	/** publish message, wait for ack if needed & reset message */
 	int publish_message();
 
+	/**
+	 * Wait until at most max_outstanding reliable messages are not acked yet.
+	 * Acks are cumulative: an ack for a sequence acknowledges all previous messages as well.
+	 * @return 0 on success, <0 on timeout
+	 */
+	int wait_for_acks(unsigned max_outstanding);
+
 	ulog_stream_s _ulog_stream_data;
 	orb_advert_t _ulog_stream_pub = nullptr;
 	int _ulog_stream_ack_sub = -1;
+	uint16_t _next_ack_sequence = 0; ///< oldest reliable sequence not acked yet
 	bool _need_reliable_transfer = false;
 	bool _is_started = false;
 	const unsigned int _queue_size;
@@ -452,6 +452,8 @@ Logger::~Logger()
 	if (_msg_buffer) {
 		delete[](_msg_buffer);
 	}
+
+	deinit_print_load_s(&_load);
 }
 
 bool Logger::request_stop_static()
@@ -617,6 +619,7 @@ void Logger::add_default_topics()
 	// Note: try to avoid setting the interval where possible, as it increases RAM usage
 	add_topic("actuator_controls_0", 100);
 	add_topic("actuator_controls_1", 100);
+	add_topic("actuator_latency");
 	add_topic("actuator_outputs", 100);
 	add_topic("airspeed", 200);
 	add_topic("battery_status", 500);
@@ -1714,6 +1717,7 @@ void Logger::initialize_load_output(PrintLoadReason reason)
 	callback_data.buffer = nullptr;
 	char buffer[140];
 	hrt_abstime curr_time = hrt_absolute_time();
+	deinit_print_load_s(&_load);
 	init_print_load_s(curr_time, &_load);
 	// this will not yet print anything
 	print_load_buffer(curr_time, buffer, sizeof(buffer), print_load_callback, &callback_data, &_load);
@@ -0,0 +1,323 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2018 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+/**
+ * @file mavlink_frame_parser.cpp
+ */
+
+#include "mavlink_frame_parser.h"
+
+#include <string.h>
+
+/// CRC-16/MCRF4XX lookup table (reflected polynomial 0x8408), equivalent to crc_accumulate()
+static const uint16_t crc_table[256] = {
+	0x0000, 0x1189, 0x2312, 0x329b, 0x4624, 0x57ad, 0x6536, 0x74bf,
+	0x8c48, 0x9dc1, 0xaf5a, 0xbed3, 0xca6c, 0xdbe5, 0xe97e, 0xf8f7,
+	0x1081, 0x0108, 0x3393, 0x221a, 0x56a5, 0x472c, 0x75b7, 0x643e,
+	0x9cc9, 0x8d40, 0xbfdb, 0xae52, 0xdaed, 0xcb64, 0xf9ff, 0xe876,
+	0x2102, 0x308b, 0x0210, 0x1399, 0x6726, 0x76af, 0x4434, 0x55bd,
+	0xad4a, 0xbcc3, 0x8e58, 0x9fd1, 0xeb6e, 0xfae7, 0xc87c, 0xd9f5,
+	0x3183, 0x200a, 0x1291, 0x0318, 0x77a7, 0x662e, 0x54b5, 0x453c,
+	0xbdcb, 0xac42, 0x9ed9, 0x8f50, 0xfbef, 0xea66, 0xd8fd, 0xc974,
+	0x4204, 0x538d, 0x6116, 0x709f, 0x0420, 0x15a9, 0x2732, 0x36bb,
+	0xce4c, 0xdfc5, 0xed5e, 0xfcd7, 0x8868, 0x99e1, 0xab7a, 0xbaf3,
+	0x5285, 0x430c, 0x7197, 0x601e, 0x14a1, 0x0528, 0x37b3, 0x263a,
+	0xdecd, 0xcf44, 0xfddf, 0xec56, 0x98e9, 0x8960, 0xbbfb, 0xaa72,
+	0x6306, 0x728f, 0x4014, 0x519d, 0x2522, 0x34ab, 0x0630, 0x17b9,
+	0xef4e, 0xfec7, 0xcc5c, 0xddd5, 0xa96a, 0xb8e3, 0x8a78, 0x9bf1,
+	0x7387, 0x620e, 0x5095, 0x411c, 0x35a3, 0x242a, 0x16b1, 0x0738,
+	0xffcf, 0xee46, 0xdcdd, 0xcd54, 0xb9eb, 0xa862, 0x9af9, 0x8b70,
+	0x8408, 0x9581, 0xa71a, 0xb693, 0xc22c, 0xd3a5, 0xe13e, 0xf0b7,
+	0x0840, 0x19c9, 0x2b52, 0x3adb, 0x4e64, 0x5fed, 0x6d76, 0x7cff,
+	0x9489, 0x8500, 0xb79b, 0xa612, 0xd2ad, 0xc324, 0xf1bf, 0xe036,
+	0x18c1, 0x0948, 0x3bd3, 0x2a5a, 0x5ee5, 0x4f6c, 0x7df7, 0x6c7e,
+	0xa50a, 0xb483, 0x8618, 0x9791, 0xe32e, 0xf2a7, 0xc03c, 0xd1b5,
+	0x2942, 0x38cb, 0x0a50, 0x1bd9, 0x6f66, 0x7eef, 0x4c74, 0x5dfd,
+	0xb58b, 0xa402, 0x9699, 0x8710, 0xf3af, 0xe226, 0xd0bd, 0xc134,
+	0x39c3, 0x284a, 0x1ad1, 0x0b58, 0x7fe7, 0x6e6e, 0x5cf5, 0x4d7c,
+	0xc60c, 0xd785, 0xe51e, 0xf497, 0x8028, 0x91a1, 0xa33a, 0xb2b3,
+	0x4a44, 0x5bcd, 0x6956, 0x78df, 0x0c60, 0x1de9, 0x2f72, 0x3efb,
+	0xd68d, 0xc704, 0xf59f, 0xe416, 0x90a9, 0x8120, 0xb3bb, 0xa232,
+	0x5ac5, 0x4b4c, 0x79d7, 0x685e, 0x1ce1, 0x0d68, 0x3ff3, 0x2e7a,
+	0xe70e, 0xf687, 0xc41c, 0xd595, 0xa12a, 0xb0a3, 0x8238, 0x93b1,
+	0x6b46, 0x7acf, 0x4854, 0x59dd, 0x2d62, 0x3ceb, 0x0e70, 0x1ff9,
+	0xf78f, 0xe606, 0xd49d, 0xc514, 0xb1ab, 0xa022, 0x92b9, 0x8330,
+	0x7bc7, 0x6a4e, 0x58d5, 0x495c, 0x3de3, 0x2c6a, 0x1ef1, 0x0f78,
+};
+
+uint16_t
+MavlinkFrameParser::crc_calculate(const uint8_t *buf, size_t len, uint16_t crc)
+{
+	for (size_t i = 0; i < len; i++) {
+		crc = (crc >> 8) ^ crc_table[(crc ^ buf[i]) & 0xff];
+	}
+
+	return crc;
+}
+
+int
+MavlinkFrameParser::frame_size(const uint8_t *buf, size_t len)
+{
+	if (buf[0] == MAVLINK_STX_MAVLINK1) {
+		if (len < 2) {
+			return 0;
+		}
+
+		return MAVLINK_CORE_HEADER_MAVLINK1_LEN + 1 + buf[1] + MAVLINK_NUM_CHECKSUM_BYTES;
+	}
+
+	if (len < 3) {
+		return 0;
+	}
+
+	// a frame with a feature we do not understand (mavlink_parse_char() drops it as well)
+	if (buf[2] & ~MAVLINK_IFLAG_SIGNED) {
+		return -1;
+	}
+
+	int size = MAVLINK_NUM_HEADER_BYTES + buf[1] + MAVLINK_NUM_CHECKSUM_BYTES;
+
+	if (buf[2] & MAVLINK_IFLAG_SIGNED) {
+		size += MAVLINK_SIGNATURE_BLOCK_LEN;
+	}
+
+	return size;
+}
+
+bool
+MavlinkFrameParser::decode(const uint8_t *frame, mavlink_message_t *msg)
+{
+	const bool mavlink1 = frame[0] == MAVLINK_STX_MAVLINK1;
+	const uint8_t payload_len = frame[1];
+	const size_t header_len = mavlink1 ? MAVLINK_CORE_HEADER_MAVLINK1_LEN + 1 : MAVLINK_NUM_HEADER_BYTES;
+	uint32_t msgid;
+
+	if (mavlink1) {
+		msgid = frame[5];
+
+	} else {
+		msgid = frame[7] | (frame[8] << 8) | ((uint32_t)frame[9] << 16);
+	}
+
+	// the CRC extra byte is only known for messages in our dialect
+	const mavlink_msg_entry_t *entry = mavlink_get_msg_entry(msgid);
+
+	if (entry == nullptr) {
+		return false;
+	}
+
+	uint16_t crc = crc_calculate(frame + 1, header_len - 1 + payload_len, X25_INIT_CRC);
+	crc = crc_calculate(&entry->crc_extra, 1, crc);
+
+	const uint8_t *ck = frame + header_len + payload_len;
+
+	if (ck[0] != (crc & 0xff) || ck[1] != (crc >> 8)) {
+		return false;
+	}
+
+	msg->magic = frame[0];
+	msg->len = payload_len;
+	msg->msgid = msgid;
+
+	if (mavlink1) {
+		msg->incompat_flags = 0;
+		msg->compat_flags = 0;
+		msg->seq = frame[2];
+		msg->sysid = frame[3];
+		msg->compid = frame[4];
+
+	} else {
+		msg->incompat_flags = frame[2];
+		msg->compat_flags = frame[3];
+		msg->seq = frame[4];
+		msg->sysid = frame[5];
+		msg->compid = frame[6];
+	}
+
+	// MAVLink 2 truncates trailing zeros of the payload, restore them
+	uint8_t *payload = (uint8_t *)_MAV_PAYLOAD_NON_CONST(msg);
+	memcpy(payload, frame + header_len, payload_len);
+
+	if (payload_len < entry->max_msg_len) {
+		memset(payload + payload_len, 0, entry->max_msg_len - payload_len);
+	}
+
+	msg->checksum = crc;
+	msg->ck[0] = ck[0];
+	msg->ck[1] = ck[1];
+
+	if (msg->incompat_flags & MAVLINK_IFLAG_SIGNED) {
+		memcpy(msg->signature, ck + MAVLINK_NUM_CHECKSUM_BYTES, MAVLINK_SIGNATURE_BLOCK_LEN);
+	}
+
+	_frames_received++;
+
+	if (_status) {
+		if (mavlink1) {
+			_status->flags |= MAVLINK_STATUS_FLAG_IN_MAVLINK1;
+
+		} else {
+			_status->flags &= ~MAVLINK_STATUS_FLAG_IN_MAVLINK1;
+		}
+
+		_status->msg_received = MAVLINK_FRAMING_OK;
+		_status->current_rx_seq = msg->seq;
+
+		if (_status->packet_rx_success_count == 0) {
+			_status->packet_rx_drop_count = 0;
+		}
+
+		_status->packet_rx_success_count++;
+	}
+
+	return true;
+}
+
+void
+MavlinkFrameParser::frame_dropped()
+{
+	_frames_dropped++;
+
+	if (_status) {
+		_status->msg_received = MAVLINK_FRAMING_BAD_CRC;
+		_status->parse_error++;
+		_status->packet_rx_drop_count++;
+	}
+}
+
+bool
+MavlinkFrameParser::next_from_carry(mavlink_message_t *msg)
+{
+	const size_t carry_len = _carry_len;
+	const size_t input_pos = _input_pos;
+	int size = frame_size(_carry, _carry_len);
+
+	// complete the frame with bytes from the input (the header first, if it's incomplete)
+	while (size >= 0 && (size == 0 || (size_t)size > _carry_len) && _input_pos < _input_len) {
+		size_t n = (size == 0) ? 1 : size - _carry_len;
+
+		if (n > _input_len - _input_pos) {
+			n = _input_len - _input_pos;
+		}
+
+		memcpy(_carry + _carry_len, _input + _input_pos, n);
+		_carry_len += n;
+		_input_pos += n;
+		size = frame_size(_carry, _carry_len);
+	}
+
+	if (size == 0 || (size > 0 && (size_t)size > _carry_len)) {
+		// input exhausted
+		return false;
+	}
+
+	if (size > 0) {
+		if (decode(_carry, msg)) {
+			_carry_len = 0;
+			return true;
+		}
+
+		frame_dropped();
+	}
+
+	// not a valid frame: give the bytes taken from the input back and rescan the ones from the
+	// previous input after the start marker
+	_input_pos = input_pos;
+	size_t skip = 1;
+
+	while (skip < carry_len && !is_start_marker(_carry[skip])) {
+		skip++;
+	}
+
+	_carry_len = carry_len - skip;
+	memmove(_carry, _carry + skip, _carry_len);
+	return false;
+}
+
+bool
+MavlinkFrameParser::next(mavlink_message_t *msg)
+{
+	while (_carry_len > 0) {
+		if (next_from_carry(msg)) {
+			return true;
+		}
+
+		if (_carry_len > 0 && _input_pos == _input_len) {
+			// still incomplete
+			return false;
+		}
+	}
+
+	while (_input_pos < _input_len) {
+		// find the next start marker
+		const uint8_t *p = _input + _input_pos;
+		const uint8_t *end = _input + _input_len;
+
+		while (p < end && !is_start_marker(*p)) {
+			p++;
+		}
+
+		_input_pos = p - _input;
+
+		if (p == end) {
+			break;
+		}
+
+		const size_t available = _input_len - _input_pos;
+		const int size = frame_size(p, available);
+
+		if (size < 0) {
+			_input_pos++;
+			continue;
+		}
+
+		if (size == 0 || (size_t)size > available) {
+			// the rest of the frame comes with the next input
+			memcpy(_carry, p, available);
+			_carry_len = available;
+			_input_pos = _input_len;
+			break;
+		}
+
+		if (decode(p, msg)) {
+			_input_pos += size;
+			return true;
+		}
+
+		frame_dropped();
+		_input_pos++;
+	}
+
+	return false;
+}
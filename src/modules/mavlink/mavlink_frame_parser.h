@@ -0,0 +1,137 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2018 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+/**
+ * @file mavlink_frame_parser.h
+ * Frame-level MAVLink parser for buffers of received bytes
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "mavlink_bridge_header.h"
+
+/**
+ * @class MavlinkFrameParser
+ * Extracts MAVLink v1 and v2 frames from buffers of received bytes.
+ *
+ * Instead of running the byte-wise state machine of mavlink_parse_char() for
+ * every byte, the input is scanned for start markers, and once a complete
+ * frame is available its length is known from the header and the checksum is
+ * computed over the whole frame at once (table-driven CRC). Frames that fail
+ * the checksum are skipped by one byte, so the scan resynchronizes on the next
+ * start marker. A frame split across two buffers is kept in a small carry
+ * buffer until the rest arrives; all other frames are decoded straight out of
+ * the input buffer. The parser does not allocate.
+ *
+ * Usage:
+ * @code
+ * parser.set_input(buf, nread);
+ * while (parser.next(&msg)) { handle(&msg); }
+ * @endcode
+ *
+ * The accepted frames and the status updates (MAVLINK_STATUS_FLAG_IN_MAVLINK1,
+ * sequence, success and drop counters) match mavlink_parse_char(). Signed frames
+ * are accepted with their signature copied but not verified, as with a channel
+ * without signing setup.
+ */
+class MavlinkFrameParser
+{
+public:
+	/**
+	 * @param status channel status to update, may be nullptr
+	 */
+	MavlinkFrameParser(mavlink_status_t *status = nullptr) : _status(status) {}
+
+	/**
+	 * Set the next buffer of received bytes. It must stay valid until next() returns false.
+	 */
+	void set_input(const uint8_t *buf, size_t len)
+	{
+		_input = buf;
+		_input_len = len;
+		_input_pos = 0;
+	}
+
+	/**
+	 * Get the next valid message out of the input.
+	 * @return false if the input is exhausted (an incomplete frame at the end is kept for the next input)
+	 */
+	bool next(mavlink_message_t *msg);
+
+	/** reset the parser state, dropping any incomplete frame */
+	void reset() { _carry_len = 0; }
+
+	uint32_t frames_received() const { return _frames_received; }
+	uint32_t frames_dropped() const { return _frames_dropped; }
+
+	/**
+	 * CRC-16/MCRF4XX (X.25) over a buffer, same as crc_accumulate_buffer().
+	 */
+	static uint16_t crc_calculate(const uint8_t *buf, size_t len, uint16_t crc);
+
+private:
+	/**
+	 * Size of the frame starting with a start marker at buf[0].
+	 * @return frame size, 0 if there are not enough bytes to tell, -1 if it is not a valid frame start
+	 */
+	static int frame_size(const uint8_t *buf, size_t len);
+
+	/**
+	 * Validate a complete frame (as sized by frame_size()) and decode it into msg.
+	 * @return true if the frame is valid
+	 */
+	bool decode(const uint8_t *frame, mavlink_message_t *msg);
+
+	/** complete the frame in the carry buffer with input bytes */
+	bool next_from_carry(mavlink_message_t *msg);
+
+	void frame_dropped();
+
+	static bool is_start_marker(uint8_t c) { return c == MAVLINK_STX || c == MAVLINK_STX_MAVLINK1; }
+
+	mavlink_status_t *_status;
+
+	const uint8_t *_input{nullptr};
+	size_t _input_len{0};
+	size_t _input_pos{0};
+
+	uint8_t _carry[MAVLINK_MAX_PACKET_LEN]; ///< start of a frame which did not fit into the previous input
+	size_t _carry_len{0};
+
+	uint32_t _frames_received{0};
+	uint32_t _frames_dropped{0};
+};
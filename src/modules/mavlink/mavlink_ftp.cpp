@@ -37,26 +37,54 @@
 #include <crc32.h>
 #include <unistd.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <fcntl.h>
 #include <sys/stat.h>
 #include <errno.h>
+#include <pthread.h>
 #include <cstring>
 
+#include <mathlib/mathlib.h>
+
 #include "mavlink_ftp.h"
 #include "mavlink_main.h"
 #include "mavlink_tests/mavlink_ftp_test.h"
 
 constexpr const char MavlinkFTP::_root_dir[];
 
+/// Protects the read-ahead blocks and CRC job state shared with the work queue. It is static, because a pending
+/// worker may outlive the MavlinkFTP instance that queued it.
+static pthread_mutex_t ftp_work_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/// Runs a background job. In unit test mode it runs inline, since the tests expect replies synchronously.
+static void
+ftp_queue_work(struct work_s *work, worker_t worker, void *arg)
+{
+#ifdef MAVLINK_FTP_UNIT_TEST
+	(void)work;
+	worker(arg);
+#else
+	work_queue(LPWORK, work, worker, arg, 0);
+#endif
+}
+
 MavlinkFTP::MavlinkFTP(Mavlink *mavlink) :
 	_mavlink(mavlink)
 {
-	// initialize session
-	_session_info.fd = -1;
+	// initialize sessions
+	for (int i = 0; i < kMaxSessions; i++) {
+		_session_info[i].fd = -1;
+	}
 }
 
 MavlinkFTP::~MavlinkFTP()
 {
+	for (int i = 0; i < kMaxSessions; i++) {
+		_close_session(_session_info[i]);
+	}
+
+	_drop_crc_job();
+
 	if (_work_buffer1) {
 		delete[] _work_buffer1;
 	}
@@ -69,12 +97,13 @@ MavlinkFTP::~MavlinkFTP()
 unsigned
 MavlinkFTP::get_size()
 {
-	if (_session_info.stream_download) {
-		return MAVLINK_MSG_ID_FILE_TRANSFER_PROTOCOL_LEN + MAVLINK_NUM_NON_PAYLOAD_BYTES;
-
-	} else {
-		return 0;
+	for (int i = 0; i < kMaxSessions; i++) {
+		if (_session_info[i].stream_download) {
+			return MAVLINK_MSG_ID_FILE_TRANSFER_PROTOCOL_LEN + MAVLINK_NUM_NON_PAYLOAD_BYTES;
+		}
 	}
+
+	return 0;
 }
 
 #ifdef MAVLINK_FTP_UNIT_TEST
@@ -176,6 +205,14 @@ MavlinkFTP::_process_request(mavlink_file_transfer_protocol_t *ftp_req, uint8_t
 		}
 	}
 
+	// a resent CRC request while the checksum is still being computed: the reply follows once it's done
+	if (_crc_job && payload->opcode == kCmdCalcFileCRC32) {
+		PayloadHeader *crc_payload = reinterpret_cast<PayloadHeader *>(&_crc_job->reply.payload[0]);
+
+		if (payload->seq_number + 1 == crc_payload->seq_number) {
+			return;
+		}
+	}
 
 
 #ifdef MAVLINK_FTP_DEBUG
@@ -246,6 +283,8 @@ MavlinkFTP::_process_request(mavlink_file_transfer_protocol_t *ftp_req, uint8_t
 
 	case kCmdCalcFileCRC32:
 		errorCode = _workCalcFileCRC32(payload);
+		// the checksum is computed in the background, send() replies once it's done
+		stream_send = true;
 		break;
 
 	default:
@@ -282,11 +321,16 @@ out:
 
 	_last_reply_valid = false;
 
+	ftp_req->target_system = target_system_id;
+
 	// Stream download replies are sent through mavlink stream mechanism. Unless we need to Nack.
 	if (!stream_send || errorCode != kErrNone) {
 		// respond to the request
-		ftp_req->target_system = target_system_id;
 		_reply(ftp_req);
+
+	} else if (payload->req_opcode == kCmdCalcFileCRC32) {
+		// keep the prepared ack: the worker never touches it and send() runs on this thread
+		memcpy(&_crc_job->reply, ftp_req, sizeof(_crc_job->reply));
 	}
 }
 
@@ -501,7 +545,13 @@ MavlinkFTP::_workList(PayloadHeader *payload, bool list_hidden)
 MavlinkFTP::ErrorCode
 MavlinkFTP::_workOpen(PayloadHeader *payload, int oflag)
 {
-	if (_session_info.fd >= 0) {
+	int session_id = 0;
+
+	while (session_id < kMaxSessions && _session_info[session_id].is_open()) {
+		session_id++;
+	}
+
+	if (session_id == kMaxSessions) {
 		PX4_ERR("FTP: Open failed - out of sessions\n");
 		return kErrNoSessionsAvailable;
 	}
@@ -515,6 +565,7 @@ MavlinkFTP::_workOpen(PayloadHeader *payload, int oflag)
 
 	uint32_t fileSize = 0;
 	struct stat st;
+	char *path = nullptr;
 
 	if (stat(_work_buffer1, &st) != 0) {
 		// fail only if requested open for read
@@ -528,18 +579,31 @@ MavlinkFTP::_workOpen(PayloadHeader *payload, int oflag)
 
 	fileSize = st.st_size;
 
+	// bursts are read in the background, which opens the file again by name
+	if (oflag == O_RDONLY) {
+		path = strdup(_work_buffer1);
+
+		if (path == nullptr) {
+			errno = ENOMEM;
+			return kErrFailErrno;
+		}
+	}
+
 	// Set mode to 666 incase oflag has O_CREAT
 	int fd = ::open(_work_buffer1, oflag, PX4_O_MODE_666);
 
 	if (fd < 0) {
+		free(path);
 		return kErrFailErrno;
 	}
 
-	_session_info.fd = fd;
-	_session_info.file_size = fileSize;
-	_session_info.stream_download = false;
+	SessionInfo &session = _session_info[session_id];
+	session.fd = fd;
+	session.path = path;
+	session.file_size = fileSize;
+	session.stream_download = false;
 
-	payload->session = 0;
+	payload->session = session_id;
 	payload->size = sizeof(uint32_t);
 	std::memcpy(payload->data, &fileSize, payload->size);
 
@@ -550,7 +614,9 @@ MavlinkFTP::_workOpen(PayloadHeader *payload, int oflag)
 MavlinkFTP::ErrorCode
 MavlinkFTP::_workRead(PayloadHeader *payload)
 {
-	if (payload->session != 0 || _session_info.fd < 0) {
+	SessionInfo *session = _get_session(payload->session);
+
+	if (session == nullptr) {
 		return kErrInvalidSession;
 	}
 
@@ -559,17 +625,33 @@ MavlinkFTP::_workRead(PayloadHeader *payload)
 #endif
 
 	// We have to test seek past EOF ourselves, lseek will allow seek past EOF
-	if (payload->offset >= _session_info.file_size) {
+	if (payload->offset >= session->file_size) {
 		PX4_ERR("request past EOF");
 		return kErrEOF;
 	}
 
-	if (lseek(_session_info.fd, payload->offset, SEEK_SET) < 0) {
-		PX4_ERR("seek fail");
+	// the read-ahead owns the file after a burst, so that a session holds a single descriptor
+	const bool temporary = (session->fd < 0);
+	int fd = temporary ? ::open(session->read_ahead->path, O_RDONLY) : session->fd;
+
+	if (fd < 0) {
 		return kErrFailErrno;
 	}
 
-	int bytes_read = ::read(_session_info.fd, &payload->data[0], kMaxDataLength);
+	int bytes_read = -1;
+
+	if (lseek(fd, payload->offset, SEEK_SET) < 0) {
+		PX4_ERR("seek fail");
+
+	} else {
+		bytes_read = ::read(fd, &payload->data[0], kMaxDataLength);
+	}
+
+	if (temporary) {
+		int read_errno = errno;
+		::close(fd);
+		errno = read_errno;
+	}
 
 	if (bytes_read < 0) {
 		// Negative return indicates error other than eof
@@ -586,19 +668,58 @@ MavlinkFTP::_workRead(PayloadHeader *payload)
 MavlinkFTP::ErrorCode
 MavlinkFTP::_workBurst(PayloadHeader *payload, uint8_t target_system_id)
 {
-	if (payload->session != 0 && _session_info.fd < 0) {
+	SessionInfo *session = _get_session(payload->session);
+
+	if (session == nullptr) {
 		return kErrInvalidSession;
 	}
 
+	// write sessions can not be streamed
+	if (session->read_ahead == nullptr && session->path == nullptr) {
+		errno = EBADF;
+		return kErrFailErrno;
+	}
+
 #ifdef MAVLINK_FTP_DEBUG
 	PX4_INFO("FTP: burst offset:%d", payload->offset);
 #endif
-	// Setup for streaming sends
-	_session_info.stream_download = true;
-	_session_info.stream_offset = payload->offset;
-	_session_info.stream_chunk_transmitted = 0;
-	_session_info.stream_seq_number = payload->seq_number + 1;
-	_session_info.stream_target_system_id = target_system_id;
+
+	if (session->read_ahead == nullptr) {
+		ReadAhead *read_ahead = new ReadAhead{};
+
+		if (read_ahead == nullptr) {
+			errno = ENOMEM;
+			return kErrFailErrno;
+		}
+
+		read_ahead->path = nullptr;
+		read_ahead->fd = -1;
+
+		for (int i = 0; i < 2; i++) {
+			read_ahead->blocks[i].data = new uint8_t[kReadAheadBlockSize];
+		}
+
+		if (read_ahead->blocks[0].data == nullptr || read_ahead->blocks[1].data == nullptr) {
+			_free_read_ahead(read_ahead);
+			errno = ENOMEM;
+			return kErrFailErrno;
+		}
+
+		// the read-ahead owns the file from now on, the worker opens it in its own context
+		read_ahead->path = session->path;
+		session->path = nullptr;
+		session->read_ahead = read_ahead;
+
+		::close(session->fd);
+		session->fd = -1;
+	}
+
+	// Setup for streaming sends. Blocks read ahead for a previous burst are reused if they cover the new offset.
+	session->stream_download = true;
+	session->stream_offset = payload->offset;
+	session->stream_chunk_transmitted = 0;
+	session->stream_seq_number = payload->seq_number + 1;
+	session->stream_target_system_id = target_system_id;
 
 	return kErrNone;
 }
@@ -607,17 +728,19 @@ MavlinkFTP::_workBurst(PayloadHeader *payload, uint8_t target_system_id)
 MavlinkFTP::ErrorCode
 MavlinkFTP::_workWrite(PayloadHeader *payload)
 {
-	if (payload->session != 0 && _session_info.fd < 0) {
+	SessionInfo *session = _get_session(payload->session);
+
+	if (session == nullptr) {
 		return kErrInvalidSession;
 	}
 
-	if (lseek(_session_info.fd, payload->offset, SEEK_SET) < 0) {
+	if (lseek(session->fd, payload->offset, SEEK_SET) < 0) {
 		// Unable to see to the specified location
 		PX4_ERR("seek fail");
 		return kErrFailErrno;
 	}
 
-	int bytes_written = ::write(_session_info.fd, &payload->data[0], payload->size);
+	int bytes_written = ::write(session->fd, &payload->data[0], payload->size);
 
 	if (bytes_written < 0) {
 		// Negative return indicates error other than eof
@@ -747,13 +870,13 @@ MavlinkFTP::_workTruncateFile(PayloadHeader *payload)
 MavlinkFTP::ErrorCode
 MavlinkFTP::_workTerminate(PayloadHeader *payload)
 {
-	if (payload->session != 0 || _session_info.fd < 0) {
+	SessionInfo *session = _get_session(payload->session);
+
+	if (session == nullptr) {
 		return kErrInvalidSession;
 	}
 
-	::close(_session_info.fd);
-	_session_info.fd = -1;
-	_session_info.stream_download = false;
+	_close_session(*session);
 
 	payload->size = 0;
 
@@ -764,10 +887,8 @@ MavlinkFTP::_workTerminate(PayloadHeader *payload)
 MavlinkFTP::ErrorCode
 MavlinkFTP::_workReset(PayloadHeader *payload)
 {
-	if (_session_info.fd != -1) {
-		::close(_session_info.fd);
-		_session_info.fd = -1;
-		_session_info.stream_download = false;
+	for (int i = 0; i < kMaxSessions; i++) {
+		_close_session(_session_info[i]);
 	}
 
 	payload->size = 0;
@@ -775,6 +896,60 @@ MavlinkFTP::_workReset(PayloadHeader *payload)
 	return kErrNone;
 }
 
+/// @brief Returns the open session with the given id, nullptr if there is none
+MavlinkFTP::SessionInfo *
+MavlinkFTP::_get_session(uint8_t session_id)
+{
+	if (session_id >= kMaxSessions || !_session_info[session_id].is_open()) {
+		return nullptr;
+	}
+
+	return &_session_info[session_id];
+}
+
+/// @brief Closes a session and releases its read-ahead. The worker frees a read-ahead that is pending or holds
+/// an open descriptor itself.
+void
+MavlinkFTP::_close_session(SessionInfo &session)
+{
+	if (session.read_ahead) {
+		ReadAhead *read_ahead = session.read_ahead;
+		bool schedule = false;
+
+		pthread_mutex_lock(&ftp_work_mutex);
+
+		if (read_ahead->work_pending) {
+			read_ahead->orphaned = true;
+
+		} else if (read_ahead->fd >= 0) {
+			// the descriptor can only be closed in the worker's context
+			read_ahead->orphaned = true;
+			read_ahead->work_pending = true;
+			schedule = true;
+
+		} else {
+			_free_read_ahead(read_ahead);
+		}
+
+		pthread_mutex_unlock(&ftp_work_mutex);
+		session.read_ahead = nullptr;
+
+		if (schedule) {
+			ftp_queue_work(&read_ahead->work, &MavlinkFTP::_read_ahead_worker, read_ahead);
+		}
+	}
+
+	free(session.path);
+	session.path = nullptr;
+
+	if (session.fd >= 0) {
+		::close(session.fd);
+		session.fd = -1;
+	}
+
+	session.stream_download = false;
+}
+
 /// @brief Responds to a Rename command
 MavlinkFTP::ErrorCode
 MavlinkFTP::_workRename(PayloadHeader *payload)
@@ -841,41 +1016,163 @@ MavlinkFTP::_workCreateDirectory(PayloadHeader *payload)
 	}
 }
 
-/// @brief Responds to a CalcFileCRC32 command
+/// @brief Responds to a CalcFileCRC32 command. The checksum is computed incrementally on the work queue so that
+/// large files do not stall the mavlink thread; send() replies once it is done.
 MavlinkFTP::ErrorCode
 MavlinkFTP::_workCalcFileCRC32(PayloadHeader *payload)
 {
-	uint32_t checksum = 0;
-	ssize_t bytes_read;
 	strncpy(_work_buffer2, _root_dir, _work_buffer2_len);
 	strncpy(_work_buffer2 + _root_dir_len, _data_as_cstring(payload), _work_buffer2_len - _root_dir_len);
 	// ensure termination
 	_work_buffer2[_work_buffer2_len - 1] = '\0';
 
-	int fd = ::open(_work_buffer2, O_RDONLY);
+	// the worker opens the file, this only rejects a bad path right away
+	struct stat st;
 
-	if (fd < 0) {
+	if (stat(_work_buffer2, &st) != 0) {
 		return kErrFailErrno;
 	}
 
-	do {
-		bytes_read = ::read(fd, _work_buffer2, _work_buffer2_len);
+	CrcJob *job = new CrcJob{};
+
+	if (job == nullptr) {
+		errno = ENOMEM;
+		return kErrFailErrno;
+	}
+
+	job->fd = -1;
+	job->path = strdup(_work_buffer2);
+
+	if (job->path == nullptr) {
+		_free_crc_job(job);
+		errno = ENOMEM;
+		return kErrFailErrno;
+	}
+
+	// the GCS gave up on a previous request
+	_drop_crc_job();
+
+	_crc_job = job;
+	ftp_queue_work(&job->work, &MavlinkFTP::_crc_worker, job);
+
+	payload->size = 0;
+	return kErrNone;
+}
+
+void
+MavlinkFTP::_crc_worker(void *arg)
+{
+	CrcJob *job = static_cast<CrcJob *>(arg);
+	bool done = false;
+
+	// the fd, buffer and checksum belong to the worker until it sets done
+	if (job->fd < 0) {
+		job->fd = ::open(job->path, O_RDONLY);
+
+		if (job->fd < 0) {
+			job->read_errno = errno;
+			done = true;
+		}
+	}
+
+	for (int i = 0; i < kCrcChunksPerRun && !done; i++) {
+		ssize_t bytes_read = ::read(job->fd, job->buffer, kCrcChunkSize);
 
 		if (bytes_read < 0) {
-			int r_errno = errno;
-			::close(fd);
-			errno = r_errno;
-			return kErrFailErrno;
+			job->read_errno = errno;
+			done = true;
+
+		} else {
+			job->checksum = crc32part(job->buffer, bytes_read, job->checksum);
+			done = bytes_read < kCrcChunkSize;
 		}
+	}
 
-		checksum = crc32part((uint8_t *)_work_buffer2, bytes_read, checksum);
-	} while (bytes_read == _work_buffer2_len);
+	if (done && job->fd >= 0) {
+		::close(job->fd);
+		job->fd = -1;
+	}
 
-	::close(fd);
+	pthread_mutex_lock(&ftp_work_mutex);
 
-	payload->size = sizeof(uint32_t);
-	std::memcpy(payload->data, &checksum, payload->size);
-	return kErrNone;
+	if (job->orphaned) {
+		pthread_mutex_unlock(&ftp_work_mutex);
+
+		if (job->fd >= 0) {
+			::close(job->fd);
+		}
+
+		_free_crc_job(job);
+		return;
+	}
+
+	job->done = done;
+	pthread_mutex_unlock(&ftp_work_mutex);
+
+	if (!done) {
+		// requeue, so that other work queue items get to run in between
+		ftp_queue_work(&job->work, &MavlinkFTP::_crc_worker, job);
+	}
+}
+
+/// @brief Frees a CRC job. The worker has closed its descriptor by then.
+void
+MavlinkFTP::_free_crc_job(CrcJob *job)
+{
+	free(job->path);
+	delete job;
+}
+
+/// @brief Discards the current CRC job without replying. A running worker frees it itself.
+void
+MavlinkFTP::_drop_crc_job()
+{
+	if (_crc_job == nullptr) {
+		return;
+	}
+
+	pthread_mutex_lock(&ftp_work_mutex);
+
+	if (_crc_job->done) {
+		_free_crc_job(_crc_job);
+
+	} else {
+		_crc_job->orphaned = true;
+	}
+
+	pthread_mutex_unlock(&ftp_work_mutex);
+	_crc_job = nullptr;
+}
+
+/// @brief Sends the reply of a finished CRC job
+void
+MavlinkFTP::_send_crc_reply()
+{
+	pthread_mutex_lock(&ftp_work_mutex);
+	bool done = _crc_job->done;
+	pthread_mutex_unlock(&ftp_work_mutex);
+
+	if (!done) {
+		return;
+	}
+
+	PayloadHeader *payload = reinterpret_cast<PayloadHeader *>(&_crc_job->reply.payload[0]);
+
+	if (_crc_job->read_errno == 0) {
+		payload->size = sizeof(uint32_t);
+		std::memcpy(payload->data, &_crc_job->checksum, payload->size);
+
+	} else {
+		payload->opcode = kRspNak;
+		payload->size = 2;
+		payload->data[0] = kErrFailErrno;
+		payload->data[1] = _crc_job->read_errno;
+	}
+
+	_reply(&_crc_job->reply);
+
+	_free_crc_job(_crc_job);
+	_crc_job = nullptr;
 }
 
 /// @brief Guarantees that the payload data is null terminated.
@@ -956,6 +1253,271 @@ MavlinkFTP::_copy_file(const char *src_path, const char *dst_path, size_t length
 	return (length > 0) ? -1 : 0;
 }
 
+void
+MavlinkFTP::_read_ahead_worker(void *arg)
+{
+	ReadAhead *read_ahead = static_cast<ReadAhead *>(arg);
+
+	pthread_mutex_lock(&ftp_work_mutex);
+
+	for (;;) {
+		if (read_ahead->orphaned) {
+			pthread_mutex_unlock(&ftp_work_mutex);
+			_free_read_ahead(read_ahead);
+			return;
+		}
+
+		// serve the lower offset first, that's the one the stream is waiting for
+		ReadAhead::Block *block = nullptr;
+
+		for (int i = 0; i < 2; i++) {
+			ReadAhead::Block &candidate = read_ahead->blocks[i];
+
+			if (candidate.state == ReadAhead::BlockState::Requested && (block == nullptr || candidate.offset < block->offset)) {
+				block = &candidate;
+			}
+		}
+
+		if (block == nullptr) {
+			break;
+		}
+
+		const uint32_t offset = block->offset;
+		pthread_mutex_unlock(&ftp_work_mutex);
+
+		int read_errno = 0;
+		ssize_t bytes_read = -1;
+
+		if (read_ahead->fd < 0) {
+			read_ahead->fd = ::open(read_ahead->path, O_RDONLY);
+		}
+
+		if (read_ahead->fd >= 0 && lseek(read_ahead->fd, offset, SEEK_SET) >= 0) {
+			bytes_read = ::read(read_ahead->fd, block->data, kReadAheadBlockSize);
+		}
+
+		if (bytes_read < 0) {
+			read_errno = errno;
+			bytes_read = 0;
+		}
+
+		pthread_mutex_lock(&ftp_work_mutex);
+		block->length = bytes_read;
+		block->read_errno = read_errno;
+		block->state = ReadAhead::BlockState::Ready;
+	}
+
+	read_ahead->work_pending = false;
+	pthread_mutex_unlock(&ftp_work_mutex);
+}
+
+/// @brief Frees a read-ahead. Only called in the worker's context while the descriptor is open.
+void
+MavlinkFTP::_free_read_ahead(ReadAhead *read_ahead)
+{
+	if (read_ahead->fd >= 0) {
+		::close(read_ahead->fd);
+	}
+
+	free(read_ahead->path);
+
+	for (int i = 0; i < 2; i++) {
+		delete[] read_ahead->blocks[i].data;
+	}
+
+	delete read_ahead;
+}
+
+/// @brief Copies the next burst packet of a session out of its read-ahead blocks and requests the blocks that will
+/// be needed next. Must be called with the work lock held.
+///	@param schedule set to true if the read-ahead worker needs to be queued
+///	@return false if the data is not available yet
+bool
+MavlinkFTP::_stream_read(SessionInfo &session, PayloadHeader *payload, ErrorCode &error_code, bool &schedule)
+{
+	ReadAhead *read_ahead = session.read_ahead;
+	const uint32_t offset = session.stream_offset;
+
+	auto request = [read_ahead, &schedule](ReadAhead::Block &block, uint32_t block_offset) {
+		block.offset = block_offset;
+		block.length = 0;
+		block.read_errno = 0;
+		block.state = ReadAhead::BlockState::Requested;
+
+		if (!read_ahead->work_pending) {
+			read_ahead->work_pending = true;
+			schedule = true;
+		}
+	};
+
+	ReadAhead::Block *current = nullptr;
+
+	for (int i = 0; i < 2; i++) {
+		ReadAhead::Block &block = read_ahead->blocks[i];
+
+		if (block.state == ReadAhead::BlockState::Ready && offset >= block.offset
+		    && offset < block.offset + kReadAheadBlockSize) {
+			current = &block;
+		}
+	}
+
+	if (current == nullptr) {
+		const uint32_t block_offset = offset & ~(kReadAheadAlign - 1);
+
+		for (int i = 0; i < 2; i++) {
+			if (read_ahead->blocks[i].state == ReadAhead::BlockState::Requested && read_ahead->blocks[i].offset == block_offset) {
+				// on its way
+				return false;
+			}
+		}
+
+		// the stream moved on (or the GCS restarted the burst elsewhere): anything read so far is stale
+		for (int i = 0; i < 2; i++) {
+			if (read_ahead->blocks[i].state == ReadAhead::BlockState::Ready) {
+				read_ahead->blocks[i].state = ReadAhead::BlockState::Empty;
+			}
+		}
+
+		for (int i = 0; i < 2; i++) {
+			if (read_ahead->blocks[i].state == ReadAhead::BlockState::Empty) {
+				request(read_ahead->blocks[i], block_offset);
+				break;
+			}
+		}
+
+		return false;
+	}
+
+	if (current->read_errno != 0) {
+		current->state = ReadAhead::BlockState::Empty;
+		errno = current->read_errno;
+		error_code = kErrFailErrno;
+		return true;
+	}
+
+	if (offset >= current->offset + current->length) {
+		// the file got shorter since it was opened
+		error_code = kErrEOF;
+		return true;
+	}
+
+	// keep the other block busy with the data following this one
+	ReadAhead::Block *next = (current == &read_ahead->blocks[0]) ? &read_ahead->blocks[1] : &read_ahead->blocks[0];
+	const uint32_t next_offset = current->offset + kReadAheadBlockSize;
+	const bool has_next = current->length == kReadAheadBlockSize && next_offset < session.file_size;
+	const bool next_ready = next->state == ReadAhead::BlockState::Ready && next->offset == next_offset;
+
+	if (has_next && !next_ready && next->state != ReadAhead::BlockState::Requested) {
+		request(*next, next_offset);
+	}
+
+	uint32_t length = math::min(current->offset + current->length - offset, (uint32_t)kMaxDataLength);
+
+	if (length < kMaxDataLength && has_next) {
+		// the packet spans both blocks: wait for the second one, so that only the last packet of a file is short
+		if (!next_ready) {
+			return false;
+		}
+
+		if (next->read_errno != 0) {
+			next->state = ReadAhead::BlockState::Empty;
+			errno = next->read_errno;
+			error_code = kErrFailErrno;
+			return true;
+		}
+
+		const uint32_t next_length = math::min(kMaxDataLength - length, next->length);
+		memcpy(&payload->data[0], current->data + (offset - current->offset), length);
+		memcpy(&payload->data[length], next->data, next_length);
+		current->state = ReadAhead::BlockState::Empty;
+		length += next_length;
+
+	} else {
+		memcpy(&payload->data[0], current->data + (offset - current->offset), length);
+
+		if (has_next && offset + length == next_offset) {
+			current->state = ReadAhead::BlockState::Empty;
+		}
+	}
+
+	payload->size = length;
+	return true;
+}
+
+/// @brief Prepares the next burst packet of a session
+///	@return false if the session has to wait for the read-ahead
+bool
+MavlinkFTP::_stream_packet(uint8_t session_id, mavlink_file_transfer_protocol_t *ftp_msg)
+{
+	SessionInfo &session = _session_info[session_id];
+	PayloadHeader *payload = reinterpret_cast<PayloadHeader *>(&ftp_msg->payload[0]);
+	ErrorCode error_code = kErrNone;
+
+	payload->seq_number = session.stream_seq_number;
+	payload->session = session_id;
+	payload->opcode = kRspAck;
+	payload->req_opcode = kCmdBurstReadFile;
+	payload->burst_complete = false;
+	payload->offset = session.stream_offset;
+
+#ifdef MAVLINK_FTP_DEBUG
+	PX4_INFO("stream send: session %d offset %d", session_id, session.stream_offset);
+#endif
+
+	// We have to test seek past EOF ourselves, the read-ahead would happily read past EOF
+	if (session.stream_offset >= session.file_size) {
+		error_code = kErrEOF;
+#ifdef MAVLINK_FTP_DEBUG
+		PX4_INFO("stream download: sending Nak EOF");
+#endif
+
+	} else {
+		bool ready;
+		bool schedule;
+
+		// retry as long as the worker got queued: it runs inline in unit test mode, and otherwise the next
+		// attempt finds the block in flight and gives up
+		do {
+			schedule = false;
+			pthread_mutex_lock(&ftp_work_mutex);
+			ready = _stream_read(session, payload, error_code, schedule);
+			pthread_mutex_unlock(&ftp_work_mutex);
+
+			if (schedule) {
+				ftp_queue_work(&session.read_ahead->work, &MavlinkFTP::_read_ahead_worker, session.read_ahead);
+			}
+		} while (!ready && schedule);
+
+		if (!ready) {
+			return false;
+		}
+	}
+
+	session.stream_seq_number++;
+
+	if (error_code != kErrNone) {
+		payload->opcode = kRspNak;
+		payload->size = 1;
+		uint8_t *pData = &payload->data[0];
+		*pData = error_code; // Straight reference to data[0] is causing bogus gcc array subscript error
+
+		if (error_code == kErrFailErrno) {
+			int r_errno = errno;
+			payload->size = 2;
+			payload->data[1] = r_errno;
+		}
+
+		session.stream_download = false;
+
+	} else {
+		session.stream_offset += payload->size;
+		session.stream_chunk_transmitted += payload->size;
+	}
+
+	ftp_msg->target_system = session.stream_target_system_id;
+	return true;
+}
+
 void MavlinkFTP::send(const hrt_abstime t)
 {
 
@@ -974,8 +1536,12 @@ void MavlinkFTP::send(const hrt_abstime t)
 		}
 	}
 
+	if (_crc_job) {
+		_send_crc_reply();
+	}
+
 	// Anything to stream?
-	if (!_session_info.stream_download) {
+	if (get_size() == 0) {
 		return;
 	}
 
@@ -992,102 +1558,55 @@ void MavlinkFTP::send(const hrt_abstime t)
 
 #endif
 
-	// Send stream packets until buffer is full
+	// Send stream packets until buffer is full, serving the streaming sessions round-robin. Sessions whose data is
+	// still being read are skipped.
 
 	bool more_data;
 
 	do {
 		more_data = false;
 
-		ErrorCode error_code = kErrNone;
-
-		mavlink_file_transfer_protocol_t ftp_msg;
-		PayloadHeader *payload = reinterpret_cast<PayloadHeader *>(&ftp_msg.payload[0]);
-
-		payload->seq_number = _session_info.stream_seq_number;
-		payload->session = 0;
-		payload->opcode = kRspAck;
-		payload->req_opcode = kCmdBurstReadFile;
-		payload->offset = _session_info.stream_offset;
-		_session_info.stream_seq_number++;
+		for (int i = 0; i < kMaxSessions; i++) {
+			const uint8_t session_id = (_stream_session_next + i) % kMaxSessions;
+			SessionInfo &session = _session_info[session_id];
 
-#ifdef MAVLINK_FTP_DEBUG
-		PX4_INFO("stream send: offset %d", _session_info.stream_offset);
-#endif
-
-		// We have to test seek past EOF ourselves, lseek will allow seek past EOF
-		if (_session_info.stream_offset >= _session_info.file_size) {
-			error_code = kErrEOF;
-#ifdef MAVLINK_FTP_DEBUG
-			PX4_INFO("stream download: sending Nak EOF");
-#endif
-		}
-
-		if (error_code == kErrNone) {
-			if (lseek(_session_info.fd, payload->offset, SEEK_SET) < 0) {
-				error_code = kErrFailErrno;
-#ifdef MAVLINK_FTP_DEBUG
-				PX4_WARN("stream download: seek fail");
-#endif
-			}
-		}
-
-		if (error_code == kErrNone) {
-			int bytes_read = ::read(_session_info.fd, &payload->data[0], kMaxDataLength);
-
-			if (bytes_read < 0) {
-				// Negative return indicates error other than eof
-				error_code = kErrFailErrno;
-#ifdef MAVLINK_FTP_DEBUG
-				PX4_WARN("stream download: read fail");
-#endif
-
-			} else {
-				payload->size = bytes_read;
-				_session_info.stream_offset += bytes_read;
-				_session_info.stream_chunk_transmitted += bytes_read;
+			if (!session.stream_download) {
+				continue;
 			}
-		}
 
-		if (error_code != kErrNone) {
-			payload->opcode = kRspNak;
-			payload->size = 1;
-			uint8_t *pData = &payload->data[0];
-			*pData = error_code; // Straight reference to data[0] is causing bogus gcc array subscript error
+			mavlink_file_transfer_protocol_t ftp_msg;
 
-			if (error_code == kErrFailErrno) {
-				int r_errno = errno;
-				payload->size = 2;
-				payload->data[1] = r_errno;
+			if (!_stream_packet(session_id, &ftp_msg)) {
+				continue;
 			}
 
-			_session_info.stream_download = false;
+			_stream_session_next = (session_id + 1) % kMaxSessions;
 
-		} else {
 #ifndef MAVLINK_FTP_UNIT_TEST
+			PayloadHeader *payload = reinterpret_cast<PayloadHeader *>(&ftp_msg.payload[0]);
 
 			if (max_bytes_to_send < (get_size() * 2)) {
 				more_data = false;
 
 				/* perform transfers in 35K chunks - this is determined empirical */
-				if (_session_info.stream_chunk_transmitted > 35000) {
+				if (payload->opcode == kRspAck && session.stream_chunk_transmitted > 35000) {
 					payload->burst_complete = true;
-					_session_info.stream_download = false;
-					_session_info.stream_chunk_transmitted = 0;
+					session.stream_download = false;
+					session.stream_chunk_transmitted = 0;
 				}
 
 			} else {
 #endif
+				// keep going, also after a Nak ended this session: there may be others
 				more_data = true;
-				payload->burst_complete = false;
 #ifndef MAVLINK_FTP_UNIT_TEST
 				max_bytes_to_send -= get_size();
 			}
 
 #endif
-		}
 
-		ftp_msg.target_system = _session_info.stream_target_system_id;
-		_reply(&ftp_msg);
+			_reply(&ftp_msg);
+			break;
+		}
 	} while (more_data);
 }
@@ -40,6 +40,7 @@
 #include <queue.h>
 
 #include <px4_defines.h>
+#include <px4_workqueue.h>
 #include <systemlib/err.h>
 #include <drivers/drv_hrt.h>
 
@@ -146,6 +147,15 @@ private:
 	ErrorCode	_workRename(PayloadHeader *payload);
 	ErrorCode	_workCalcFileCRC32(PayloadHeader *payload);
 
+	struct SessionInfo;
+
+	SessionInfo	*_get_session(uint8_t session_id);
+	void		_close_session(SessionInfo &session);
+	bool		_stream_packet(uint8_t session_id, mavlink_file_transfer_protocol_t *ftp_msg);
+	bool		_stream_read(SessionInfo &session, PayloadHeader *payload, ErrorCode &error_code, bool &schedule);
+	void		_send_crc_reply();
+	void		_drop_crc_job();
+
 	uint8_t _getServerSystemId(void);
 	uint8_t _getServerComponentId(void);
 	uint8_t _getServerChannel(void);
@@ -163,16 +173,81 @@ private:
 	/// @brief Maximum data size in RequestHeader::data
 	static const uint8_t	kMaxDataLength = MAVLINK_MSG_FILE_TRANSFER_PROTOCOL_FIELD_PAYLOAD_LEN - sizeof(PayloadHeader);
 
+#ifdef __PX4_NUTTX
+	static constexpr int		kMaxSessions = 2;		///< Maximum number of concurrently open sessions
+	static constexpr uint32_t	kReadAheadBlockSize = 1024;	///< Size of each of the two read-ahead blocks of a burst
+	static constexpr int		kCrcChunkSize = 512;		///< Read size of the CRC computation
+#else
+	static constexpr int		kMaxSessions = 4;
+	static constexpr uint32_t	kReadAheadBlockSize = 16384;
+	static constexpr int		kCrcChunkSize = 4096;
+#endif
+	static constexpr uint32_t	kReadAheadAlign = 512;		///< Block offsets are aligned to the sector size
+	static constexpr int		kCrcChunksPerRun = 8;		///< Chunks per work queue cycle, then the job yields
+
+	/// @brief Double-buffered read-ahead of a burst session. The blocks are filled on the LP work queue, while the
+	/// mavlink thread copies packets out of them. All fields are protected by the read-ahead lock, except the data
+	/// of a block in state Requested and the descriptor, which belong to the worker. On NuttX a descriptor is only
+	/// valid in the task group that opened it, so the worker opens and closes the file itself.
+	struct ReadAhead {
+		enum class BlockState : uint8_t {
+			Empty,
+			Requested,	///< queued for reading by the worker
+			Ready		///< filled, owned by the mavlink thread
+		};
+
+		struct Block {
+			uint8_t		*data;
+			uint32_t	offset;		///< file offset of data[0]
+			uint32_t	length;		///< valid bytes, less than kReadAheadBlockSize at the end of the file
+			int		read_errno;	///< errno if the read failed, 0 otherwise
+			BlockState	state;
+		};
+
+		Block		blocks[2];
+		char		*path;		///< file of the session, taken over from it on the first burst
+		int		fd;		///< opened by the worker on its first run, -1 before
+		struct work_s	work;
+		bool		work_pending;	///< worker is queued or running
+		bool		orphaned;	///< session closed while the worker was pending: the worker frees the object
+	};
+
+	/// @brief Incremental CRC32 computation of a file, run on the LP work queue. The reply is sent from send() once
+	/// the job is done.
+	struct CrcJob {
+		char		*path;
+		int		fd;		///< opened and closed by the worker
+		uint32_t	checksum;
+		int		read_errno;	///< errno if a read failed, 0 otherwise
+		bool		done;
+		bool		orphaned;	///< superseded while running: the worker frees the object
+		struct work_s	work;
+		mavlink_file_transfer_protocol_t reply;	///< prepared (n)ack, completed with the result
+		uint8_t		buffer[kCrcChunkSize];
+	};
+
+	static void	_read_ahead_worker(void *arg);
+	static void	_crc_worker(void *arg);
+	static void	_free_read_ahead(ReadAhead *read_ahead);
+	static void	_free_crc_job(CrcJob *job);
+
 	struct SessionInfo {
-		int		fd;
+		int		fd;		///< -1 once the read-ahead took over the file
+		char		*path;		///< file of a read session, handed to the read-ahead on the first burst
 		uint32_t	file_size;
 		bool		stream_download;
 		uint32_t	stream_offset;
 		uint16_t	stream_seq_number;
 		uint8_t		stream_target_system_id;
 		unsigned	stream_chunk_transmitted;
+		ReadAhead	*read_ahead;	///< allocated on the first burst of the session
+
+		bool is_open() const { return fd >= 0 || read_ahead != nullptr; }
 	};
-	struct SessionInfo _session_info {};	///< Session info, fd=-1 for no active session
+	struct SessionInfo _session_info[kMaxSessions] {};	///< Session info, see SessionInfo::is_open()
+	uint8_t _stream_session_next{0};	///< round-robin start for streaming sessions
+
+	CrcJob *_crc_job{nullptr};	///< CRC computation in progress or waiting for its reply to be sent
 
 	ReceiveMessageFunc_t	_utRcvMsgFunc{};	///< Unit test override for mavlink message sending
 	void			*_worker_data{nullptr};	///< Additional parameter to _utRcvMsgFunc;
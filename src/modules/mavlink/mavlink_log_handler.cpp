@@ -37,8 +37,11 @@
 #include "mavlink_log_handler.h"
 #include "mavlink_main.h"
 #include <sys/stat.h>
+#include <fcntl.h>
 #include <time.h>
 
+#include <mathlib/mathlib.h>
+
 #define MOUNTPOINT PX4_STORAGEDIR
 
 static const char *kLogRoot    = MOUNTPOINT "/log";
@@ -132,7 +135,7 @@ void
 MavlinkLogHandler::send(const hrt_abstime /*t*/)
 {
 	//-- An arbitrary count of max bytes in one go (one of the two below but never both)
-#define MAX_BYTES_SEND 256 * 1024
+#define MAX_BYTES_SEND (256 * 1024)
 	size_t count = 0;
 
 	//-- Log Entries
@@ -141,9 +144,10 @@ MavlinkLogHandler::send(const hrt_abstime /*t*/)
 		count += _log_send_listing();
 	}
 
-	//-- Log Data
-	while (_pLogHandlerHelper && _pLogHandlerHelper->current_status == LogListHelper::LOG_HANDLER_SENDING_DATA
-	       && _mavlink->get_free_tx_buf() > get_size() && count < MAX_BYTES_SEND) {
+	//-- Log Data: burst as much as fits into the TX buffer (the file is read ahead in large blocks)
+	const size_t burst_bytes = math::min((size_t)_mavlink->get_free_tx_buf(), (size_t)MAX_BYTES_SEND);
+
+	while (is_sending_data() && _mavlink->get_free_tx_buf() > get_size() && count < burst_bytes) {
 		count += _log_send_data();
 	}
 }
@@ -207,6 +211,38 @@ MavlinkLogHandler::_log_request_data(const mavlink_message_t *msg)
 		return;
 	}
 
+	const bool was_sending_data = _pLogHandlerHelper->current_status == LogListHelper::LOG_HANDLER_SENDING_DATA;
+
+	if (was_sending_data && _pLogHandlerHelper->current_log_index == request.id
+	    && request.ofs < _pLogHandlerHelper->current_log_data_offset
+	    && _pLogHandlerHelper->current_log_data_remaining > 0) {
+		//-- Gap-fill request for data we already sent: send the missing chunk first, then resume with
+		//   the part of the current range that the request does not cover
+		const uint32_t current_end = _pLogHandlerHelper->current_log_data_offset +
+					     _pLogHandlerHelper->current_log_data_remaining;
+		const uint32_t request_end = (request.count > current_end - request.ofs) ? current_end : request.ofs + request.count;
+
+		if (request_end < current_end) {
+			const uint32_t resume_offset = math::max(request_end, _pLogHandlerHelper->current_log_data_offset);
+
+			if (!_pLogHandlerHelper->push_pending_range(resume_offset, current_end - resume_offset)) {
+				//-- Keep sending the current range, the GCS repeats the request after its timeout
+				PX4LOG_WARN("MavlinkLogHandler::_log_request_data too many gap-fill requests, ignored.\n");
+				return;
+			}
+		}
+
+		//-- Ranges queued by earlier gap-fills that this request sends again (e.g. the GCS restarted the download)
+		const uint32_t log_size = _pLogHandlerHelper->current_log_size;
+		_pLogHandlerHelper->discard_pending_ranges(request.ofs, request.ofs + math::min(request.count, log_size - request.ofs));
+
+		_pLogHandlerHelper->transfer_gap_requests++;
+
+	} else {
+		//-- A new request replaces whatever was left to send
+		_pLogHandlerHelper->discard_pending_ranges(0, _pLogHandlerHelper->current_log_size);
+	}
+
 	//-- If we were sending log entries, stop it
 	_pLogHandlerHelper->current_status = LogListHelper::LOG_HANDLER_IDLE;
 
@@ -324,13 +360,36 @@ MavlinkLogHandler::_log_send_data()
 	_pLogHandlerHelper->current_log_data_offset    += read_size;
 	_pLogHandlerHelper->current_log_data_remaining -= read_size;
 
+	_pLogHandlerHelper->transfer_bytes += read_size;
+
 	if (read_size < sizeof(response.data) || _pLogHandlerHelper->current_log_data_remaining == 0) {
-		_pLogHandlerHelper->current_status = LogListHelper::LOG_HANDLER_IDLE;
+		_log_data_range_done();
 	}
 
 	return sizeof(response);
 }
 
+//-------------------------------------------------------------------
+void
+MavlinkLogHandler::_log_data_range_done()
+{
+	//-- Continue with a range that was interrupted by a gap-fill request
+	if (_pLogHandlerHelper->pop_pending_range()) {
+		return;
+	}
+
+	_pLogHandlerHelper->current_status = LogListHelper::LOG_HANDLER_IDLE;
+
+	const float elapsed = hrt_elapsed_time(&_pLogHandlerHelper->transfer_start_time) * 1e-6f;
+
+	if (elapsed > 0.f) {
+		PX4_INFO("log %u: sent %u bytes in %.1f s (%.1f kB/s, %u gap requests)",
+			 _pLogHandlerHelper->current_log_index, (unsigned)_pLogHandlerHelper->transfer_bytes,
+			 (double)elapsed, (double)(_pLogHandlerHelper->transfer_bytes / elapsed / 1024.f),
+			 (unsigned)_pLogHandlerHelper->transfer_gap_requests);
+	}
+}
+
 //-------------------------------------------------------------------
 LogListHelper::LogListHelper()
 	: next_entry(0)
@@ -341,7 +400,10 @@ LogListHelper::LogListHelper()
 	, current_log_size(0)
 	, current_log_data_offset(0)
 	, current_log_data_remaining(0)
-	, current_log_filep(nullptr)
+	, current_log_fd(-1)
+	, transfer_start_time(0)
+	, transfer_bytes(0)
+	, transfer_gap_requests(0)
 {
 	_init();
 }
@@ -349,6 +411,12 @@ LogListHelper::LogListHelper()
 //-------------------------------------------------------------------
 LogListHelper::~LogListHelper()
 {
+	if (current_log_fd >= 0) {
+		::close(current_log_fd);
+	}
+
+	delete[] _read_buffer;
+
 	// Remove log data files (if any)
 	unlink(kLogData);
 	unlink(kTmpData);
@@ -397,14 +465,30 @@ LogListHelper::get_entry(int idx, uint32_t &size, uint32_t &date, char *filename
 bool
 LogListHelper::open_for_transmit()
 {
-	if (current_log_filep) {
-		::fclose(current_log_filep);
-		current_log_filep = nullptr;
+	if (current_log_fd >= 0) {
+		::close(current_log_fd);
+		current_log_fd = -1;
 	}
 
-	current_log_filep = ::fopen(current_log_filename, "rb");
+	_read_buffer_offset = 0;
+	_read_buffer_len = 0;
+	_num_pending_ranges = 0;
+	transfer_start_time = hrt_absolute_time();
+	transfer_bytes = 0;
+	transfer_gap_requests = 0;
+
+	if (!_read_buffer) {
+		_read_buffer = new uint8_t[READ_BUFFER_SIZE];
+
+		if (!_read_buffer) {
+			PX4LOG_WARN("MavlinkLogHandler::open_for_transmit Could not allocate read buffer\n");
+			return false;
+		}
+	}
 
-	if (!current_log_filep) {
+	current_log_fd = ::open(current_log_filename, O_RDONLY);
+
+	if (current_log_fd < 0) {
 		PX4LOG_WARN("MavlinkLogHandler::open_for_transmit Could not open %s\n", current_log_filename);
 		return false;
 	}
@@ -420,24 +504,107 @@ LogListHelper::get_log_data(uint8_t len, uint8_t *buffer)
 		return 0;
 	}
 
-	if (!current_log_filep) {
+	if (current_log_fd < 0 || !_read_buffer) {
 		PX4LOG_WARN("MavlinkLogHandler::get_log_data file not open %s\n", current_log_filename);
 		return 0;
 	}
 
-	long int offset = current_log_data_offset - ftell(current_log_filep);
+	const uint32_t offset = current_log_data_offset;
+
+	if (offset < _read_buffer_offset || offset + len > _read_buffer_offset + _read_buffer_len) {
+		//-- Refill the read-ahead buffer with one large read, starting at the block containing offset
+		const uint32_t aligned_offset = offset - (offset % READ_ALIGNMENT);
+
+		if (::lseek(current_log_fd, aligned_offset, SEEK_SET) < 0) {
+			::close(current_log_fd);
+			current_log_fd = -1;
+			PX4LOG_WARN("MavlinkLogHandler::get_log_data Seek error in %s\n", current_log_filename);
+			return 0;
+		}
+
+		ssize_t read_len = ::read(current_log_fd, _read_buffer, READ_BUFFER_SIZE);
+		_read_buffer_offset = aligned_offset;
+		_read_buffer_len = read_len > 0 ? read_len : 0;
+	}
 
-	if (offset && fseek(current_log_filep, offset, SEEK_CUR)) {
-		fclose(current_log_filep);
-		current_log_filep = nullptr;
-		PX4LOG_WARN("MavlinkLogHandler::get_log_data Seek error in %s\n", current_log_filename);
+	//-- End of file
+	if (offset >= _read_buffer_offset + _read_buffer_len) {
 		return 0;
 	}
 
-	size_t result = fread(buffer, 1, len, current_log_filep);
+	size_t result = _read_buffer_offset + _read_buffer_len - offset;
+
+	if (result > len) {
+		result = len;
+	}
+
+	memcpy(buffer, _read_buffer + (offset - _read_buffer_offset), result);
 	return result;
 }
 
+//-------------------------------------------------------------------
+bool
+LogListHelper::push_pending_range(uint32_t offset, uint32_t count)
+{
+	if (_num_pending_ranges >= MAX_PENDING_RANGES) {
+		return false;
+	}
+
+	_pending_ranges[_num_pending_ranges].offset = offset;
+	_pending_ranges[_num_pending_ranges].count = count;
+	_num_pending_ranges++;
+	return true;
+}
+
+//-------------------------------------------------------------------
+bool
+LogListHelper::pop_pending_range()
+{
+	if (_num_pending_ranges == 0) {
+		return false;
+	}
+
+	current_log_data_offset = _pending_ranges[0].offset;
+	current_log_data_remaining = _pending_ranges[0].count;
+
+	for (int i = 1; i < _num_pending_ranges; i++) {
+		_pending_ranges[i - 1] = _pending_ranges[i];
+	}
+
+	_num_pending_ranges--;
+	return true;
+}
+
+//-------------------------------------------------------------------
+void
+LogListHelper::discard_pending_ranges(uint32_t offset, uint32_t end)
+{
+	int num_kept = 0;
+
+	for (int i = 0; i < _num_pending_ranges; i++) {
+		Range range = _pending_ranges[i];
+		const uint32_t range_end = range.offset + range.count;
+
+		if (range.offset >= offset && range_end <= end) {
+			//-- fully covered
+			continue;
+
+		} else if (range.offset >= offset && range.offset < end) {
+			//-- head covered
+			range.count = range_end - end;
+			range.offset = end;
+
+		} else if (range_end > offset && range_end <= end) {
+			//-- tail covered
+			range.count = offset - range.offset;
+		}
+
+		_pending_ranges[num_kept++] = range;
+	}
+
+	_num_pending_ranges = num_kept;
+}
+
 //-------------------------------------------------------------------
 void
 LogListHelper::_init()
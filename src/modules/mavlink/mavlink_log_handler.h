@@ -62,6 +62,25 @@ public:
 	bool        open_for_transmit();
 	size_t      get_log_data(uint8_t len, uint8_t *buffer);
 
+	/**
+	 * Queue a range that has to be sent after the current one (the current
+	 * range is interrupted by a gap-fill request from the GCS).
+	 * @return false if there are too many pending ranges
+	 */
+	bool        push_pending_range(uint32_t offset, uint32_t count);
+
+	/**
+	 * Make the next pending range the current one.
+	 * @return false if there is no pending range
+	 */
+	bool        pop_pending_range();
+
+	/**
+	 * Drop the parts of the pending ranges that a new request for the range
+	 * [offset, end) sends again. A range that contains the request is kept.
+	 */
+	void        discard_pending_ranges(uint32_t offset, uint32_t end);
+
 	enum {
 		LOG_HANDLER_IDLE,
 		LOG_HANDLER_LISTING,
@@ -77,10 +96,35 @@ public:
 	uint32_t    current_log_size;
 	uint32_t    current_log_data_offset;
 	uint32_t    current_log_data_remaining;
-	FILE       *current_log_filep;
+	int         current_log_fd;
 	char        current_log_filename[128];
 
+	// download statistics
+	hrt_abstime transfer_start_time;
+	uint32_t    transfer_bytes;
+	uint32_t    transfer_gap_requests;
+
 private:
+#ifdef __PX4_NUTTX
+	static constexpr uint32_t READ_BUFFER_SIZE = 4096;
+#else
+	static constexpr uint32_t READ_BUFFER_SIZE = 64 * 1024;
+#endif
+	static constexpr uint32_t READ_ALIGNMENT = 512; ///< file system block size
+	static constexpr int MAX_PENDING_RANGES = 8;
+
+	struct Range {
+		uint32_t offset;
+		uint32_t count;
+	};
+
+	uint8_t    *_read_buffer{nullptr};   ///< read-ahead buffer, allocated while transmitting
+	uint32_t    _read_buffer_offset{0};  ///< file offset of the first byte in _read_buffer
+	uint32_t    _read_buffer_len{0};     ///< number of valid bytes in _read_buffer
+
+	Range       _pending_ranges[MAX_PENDING_RANGES];
+	int         _num_pending_ranges{0};
+
 	void        _init();
 	bool        _get_session_date(const char *path, const char *dir, time_t &date);
 	void        _scan_logs(FILE *f, const char *dir, time_t &date);
@@ -104,6 +148,12 @@ public:
 
 	unsigned get_size();
 
+	/** @return true while log data is being sent, i.e. send() should be called as often as possible */
+	bool is_sending_data() const
+	{
+		return _pLogHandlerHelper && _pLogHandlerHelper->current_status == LogListHelper::LOG_HANDLER_SENDING_DATA;
+	}
+
 private:
 	void _log_message(const mavlink_message_t *msg);
 	void _log_request_list(const mavlink_message_t *msg);
@@ -113,6 +163,7 @@ private:
 
 	size_t _log_send_listing();
 	size_t _log_send_data();
+	void _log_data_range_done();
 
 	LogListHelper    *_pLogHandlerHelper;
 	Mavlink *_mavlink;
@@ -2792,6 +2792,8 @@ Mavlink::display_status()
 	if (_mavlink_ulog) {
 		printf("\tULog rate: %.1f%% of max %.1f%%\n", (double)_mavlink_ulog->current_data_rate() * 100.,
 		       (double)_mavlink_ulog->maximum_data_rate() * 100.);
+		printf("\tULog acked rtt: %.1f ms, retransmissions: %u\n", (double)_mavlink_ulog->round_trip_time() * 1000.,
+		       (unsigned)_mavlink_ulog->retransmissions());
 	}
 
 	printf("\tFTP enabled: %s, TX enabled: %s\n",
@@ -119,7 +119,7 @@ MavlinkReceiver::MavlinkReceiver(Mavlink *parent) :
 	_mavlink_ftp(parent),
 	_mavlink_log_handler(parent),
 	_mavlink_timesync(parent),
-	_status{},
+	_frame_parser(parent->get_status()),
 	_hil_local_pos{},
 	_hil_land_detector{},
 	_control_mode{},
@@ -212,144 +212,31 @@ void MavlinkReceiver::acknowledge(uint8_t sysid, uint8_t compid, uint16_t comman
 	}
 }
 
+constexpr MavlinkReceiver::MessageHandler MavlinkReceiver::_message_handlers[];
+
 void
 MavlinkReceiver::handle_message(mavlink_message_t *msg)
 {
-	switch (msg->msgid) {
-	case MAVLINK_MSG_ID_COMMAND_LONG:
-		handle_message_command_long(msg);
-		break;
-
-	case MAVLINK_MSG_ID_COMMAND_INT:
-		handle_message_command_int(msg);
-		break;
-
-	case MAVLINK_MSG_ID_COMMAND_ACK:
-		handle_message_command_ack(msg);
-		break;
-
-	case MAVLINK_MSG_ID_OPTICAL_FLOW_RAD:
-		handle_message_optical_flow_rad(msg);
-		break;
-
-	case MAVLINK_MSG_ID_PING:
-		handle_message_ping(msg);
-		break;
-
-	case MAVLINK_MSG_ID_SET_MODE:
-		handle_message_set_mode(msg);
-		break;
-
-	case MAVLINK_MSG_ID_ATT_POS_MOCAP:
-		handle_message_att_pos_mocap(msg);
-		break;
-
-	case MAVLINK_MSG_ID_SET_POSITION_TARGET_LOCAL_NED:
-		handle_message_set_position_target_local_ned(msg);
-		break;
-
-	case MAVLINK_MSG_ID_SET_ATTITUDE_TARGET:
-		handle_message_set_attitude_target(msg);
-		break;
-
-	case MAVLINK_MSG_ID_SET_ACTUATOR_CONTROL_TARGET:
-		handle_message_set_actuator_control_target(msg);
-		break;
-
-	case MAVLINK_MSG_ID_VISION_POSITION_ESTIMATE:
-		handle_message_vision_position_estimate(msg);
-		break;
-
-	case MAVLINK_MSG_ID_ODOMETRY:
-		handle_message_odometry(msg);
-		break;
+	static_assert(message_handlers_sorted(), "message handler table must be sorted by message id");
 
-	case MAVLINK_MSG_ID_GPS_GLOBAL_ORIGIN:
-		handle_message_gps_global_origin(msg);
-		break;
-
-	case MAVLINK_MSG_ID_RADIO_STATUS:
-		handle_message_radio_status(msg);
-		break;
-
-	case MAVLINK_MSG_ID_MANUAL_CONTROL:
-		handle_message_manual_control(msg);
-		break;
+	// binary search in the handler table
+	int low = 0;
+	int high = _num_message_handlers - 1;
 
-	case MAVLINK_MSG_ID_RC_CHANNELS_OVERRIDE:
-		handle_message_rc_channels_override(msg);
-		break;
-
-	case MAVLINK_MSG_ID_HEARTBEAT:
-		handle_message_heartbeat(msg);
-		break;
-
-	case MAVLINK_MSG_ID_DISTANCE_SENSOR:
-		handle_message_distance_sensor(msg);
-		break;
-
-	case MAVLINK_MSG_ID_FOLLOW_TARGET:
-		handle_message_follow_target(msg);
-		break;
-
-	case MAVLINK_MSG_ID_LANDING_TARGET:
-		handle_message_landing_target(msg);
-		break;
+	while (low <= high) {
+		const int mid = (low + high) / 2;
+		const uint32_t msgid = _message_handlers[mid].msgid;
 
-	case MAVLINK_MSG_ID_ADSB_VEHICLE:
-		handle_message_adsb_vehicle(msg);
-		break;
-
-	case MAVLINK_MSG_ID_COLLISION:
-		handle_message_collision(msg);
-		break;
-
-	case MAVLINK_MSG_ID_GPS_RTCM_DATA:
-		handle_message_gps_rtcm_data(msg);
-		break;
-
-	case MAVLINK_MSG_ID_BATTERY_STATUS:
-		handle_message_battery_status(msg);
-		break;
-
-	case MAVLINK_MSG_ID_SERIAL_CONTROL:
-		handle_message_serial_control(msg);
-		break;
-
-	case MAVLINK_MSG_ID_LOGGING_ACK:
-		handle_message_logging_ack(msg);
-		break;
-
-	case MAVLINK_MSG_ID_PLAY_TUNE:
-		handle_message_play_tune(msg);
-		break;
-
-	case MAVLINK_MSG_ID_OBSTACLE_DISTANCE:
-		handle_message_obstacle_distance(msg);
-		break;
-
-	case MAVLINK_MSG_ID_TRAJECTORY_REPRESENTATION_WAYPOINTS:
-		handle_message_trajectory_representation_waypoints(msg);
-		break;
-
-	case MAVLINK_MSG_ID_NAMED_VALUE_FLOAT:
-		handle_message_named_value_float(msg);
-		break;
+		if (msgid == msg->msgid) {
+			(this->*_message_handlers[mid].handle)(msg);
+			break;
 
-	case MAVLINK_MSG_ID_DEBUG:
-		handle_message_debug(msg);
-		break;
+		} else if (msgid < msg->msgid) {
+			low = mid + 1;
 
-	case MAVLINK_MSG_ID_DEBUG_VECT:
-		handle_message_debug_vect(msg);
-		break;
-
-	case MAVLINK_MSG_ID_DEBUG_FLOAT_ARRAY:
-		handle_message_debug_float_array(msg);
-		break;
-
-	default:
-		break;
+		} else {
+			high = mid - 1;
+		}
 	}
 
 	/*
@@ -2648,9 +2535,13 @@ MavlinkReceiver::receive_thread(void *arg)
 #endif
 	ssize_t nread = 0;
 	hrt_abstime last_send_update = 0;
+	hrt_abstime last_log_send_update = 0;
 
 	while (!_mavlink->_task_should_exit) {
-		if (poll(&fds[0], 1, timeout) > 0) {
+		// while a log download is active, wake up often to keep the TX buffer filled
+		const int poll_timeout = _mavlink_log_handler.is_sending_data() ? 1 : timeout;
+
+		if (poll(&fds[0], 1, poll_timeout) > 0) {
 			if (_mavlink->get_protocol() == SERIAL) {
 
 				/*
@@ -2702,39 +2593,38 @@ MavlinkReceiver::receive_thread(void *arg)
 
 			if (_mavlink->get_client_source_initialized()) {
 				/* if read failed, this loop won't execute */
-				for (ssize_t i = 0; i < nread; i++) {
-					if (mavlink_parse_char(_mavlink->get_channel(), buf[i], &msg, &_status)) {
+				_frame_parser.set_input(buf, nread > 0 ? nread : 0);
 
-						/* check if we received version 2 and request a switch. */
-						if (!(_mavlink->get_status()->flags & MAVLINK_STATUS_FLAG_IN_MAVLINK1)) {
-							/* this will only switch to proto version 2 if allowed in settings */
-							_mavlink->set_proto_version(2);
-						}
+				while (_frame_parser.next(&msg)) {
+					/* check if we received version 2 and request a switch. */
+					if (!(_mavlink->get_status()->flags & MAVLINK_STATUS_FLAG_IN_MAVLINK1)) {
+						/* this will only switch to proto version 2 if allowed in settings */
+						_mavlink->set_proto_version(2);
+					}
 
-						/* handle generic messages and commands */
-						handle_message(&msg);
+					/* handle generic messages and commands */
+					handle_message(&msg);
 
-						/* handle packet with mission manager */
-						_mission_manager.handle_message(&msg);
+					/* handle packet with mission manager */
+					_mission_manager.handle_message(&msg);
 
 
-						/* handle packet with parameter component */
-						_parameters_manager.handle_message(&msg);
+					/* handle packet with parameter component */
+					_parameters_manager.handle_message(&msg);
 
-						if (_mavlink->ftp_enabled()) {
-							/* handle packet with ftp component */
-							_mavlink_ftp.handle_message(&msg);
-						}
+					if (_mavlink->ftp_enabled()) {
+						/* handle packet with ftp component */
+						_mavlink_ftp.handle_message(&msg);
+					}
 
-						/* handle packet with log component */
-						_mavlink_log_handler.handle_message(&msg);
+					/* handle packet with log component */
+					_mavlink_log_handler.handle_message(&msg);
 
-						/* handle packet with timesync component */
-						_mavlink_timesync.handle_message(&msg);
+					/* handle packet with timesync component */
+					_mavlink_timesync.handle_message(&msg);
 
-						/* handle packet with parent object */
-						_mavlink->handle_message(&msg);
-					}
+					/* handle packet with parent object */
+					_mavlink->handle_message(&msg);
 				}
 
 				/* count received bytes (nread will be -1 on read error) */
@@ -2756,10 +2646,14 @@ MavlinkReceiver::receive_thread(void *arg)
 				_mavlink_ftp.send(t);
 			}
 
-			_mavlink_log_handler.send(t);
 			last_send_update = t;
 		}
 
+		if (t - last_log_send_update > timeout * 1000 || _mavlink_log_handler.is_sending_data()) {
+			_mavlink_log_handler.send(t);
+			last_log_send_update = t;
+		}
+
 	}
 
 	return nullptr;
@@ -2798,7 +2692,7 @@ MavlinkReceiver::receive_start(pthread_t *thread, Mavlink *parent)
 	param.sched_priority = SCHED_PRIORITY_MAX - 80;
 	(void)pthread_attr_setschedparam(&receiveloop_attr, &param);
 
-	pthread_attr_setstacksize(&receiveloop_attr, PX4_STACK_ADJUSTED(2840 + MAVLINK_RECEIVER_NET_ADDED_STACK));
+	pthread_attr_setstacksize(&receiveloop_attr, PX4_STACK_ADJUSTED(2840 + MAVLINK_RECEIVER_NET_ADDED_STACK + ACTUATOR_CONTROLS_CALLBACK_ADDED_STACK));
 	pthread_create(thread, &receiveloop_attr, MavlinkReceiver::start_helper, (void *)parent);
 
 	pthread_attr_destroy(&receiveloop_attr);
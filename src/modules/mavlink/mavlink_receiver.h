@@ -83,6 +83,7 @@
 #include <uORB/topics/vehicle_rates_setpoint.h>
 #include <uORB/topics/vehicle_status.h>
 
+#include "mavlink_frame_parser.h"
 #include "mavlink_ftp.h"
 #include "mavlink_log_handler.h"
 #include "mavlink_mission.h"
@@ -195,6 +196,56 @@ private:
 
 	void send_storage_information(int storage_id);
 
+	/// Handler of a generic (non-HIL) message, the table is sorted by message id
+	struct MessageHandler {
+		uint32_t msgid;
+		void (MavlinkReceiver::*handle)(mavlink_message_t *msg);
+	};
+
+	static constexpr MessageHandler _message_handlers[] = {
+		{MAVLINK_MSG_ID_HEARTBEAT, &MavlinkReceiver::handle_message_heartbeat},
+		{MAVLINK_MSG_ID_PING, &MavlinkReceiver::handle_message_ping},
+		{MAVLINK_MSG_ID_SET_MODE, &MavlinkReceiver::handle_message_set_mode},
+		{MAVLINK_MSG_ID_GPS_GLOBAL_ORIGIN, &MavlinkReceiver::handle_message_gps_global_origin},
+		{MAVLINK_MSG_ID_MANUAL_CONTROL, &MavlinkReceiver::handle_message_manual_control},
+		{MAVLINK_MSG_ID_RC_CHANNELS_OVERRIDE, &MavlinkReceiver::handle_message_rc_channels_override},
+		{MAVLINK_MSG_ID_COMMAND_INT, &MavlinkReceiver::handle_message_command_int},
+		{MAVLINK_MSG_ID_COMMAND_LONG, &MavlinkReceiver::handle_message_command_long},
+		{MAVLINK_MSG_ID_COMMAND_ACK, &MavlinkReceiver::handle_message_command_ack},
+		{MAVLINK_MSG_ID_SET_ATTITUDE_TARGET, &MavlinkReceiver::handle_message_set_attitude_target},
+		{MAVLINK_MSG_ID_SET_POSITION_TARGET_LOCAL_NED, &MavlinkReceiver::handle_message_set_position_target_local_ned},
+		{MAVLINK_MSG_ID_VISION_POSITION_ESTIMATE, &MavlinkReceiver::handle_message_vision_position_estimate},
+		{MAVLINK_MSG_ID_OPTICAL_FLOW_RAD, &MavlinkReceiver::handle_message_optical_flow_rad},
+		{MAVLINK_MSG_ID_RADIO_STATUS, &MavlinkReceiver::handle_message_radio_status},
+		{MAVLINK_MSG_ID_SERIAL_CONTROL, &MavlinkReceiver::handle_message_serial_control},
+		{MAVLINK_MSG_ID_DISTANCE_SENSOR, &MavlinkReceiver::handle_message_distance_sensor},
+		{MAVLINK_MSG_ID_ATT_POS_MOCAP, &MavlinkReceiver::handle_message_att_pos_mocap},
+		{MAVLINK_MSG_ID_SET_ACTUATOR_CONTROL_TARGET, &MavlinkReceiver::handle_message_set_actuator_control_target},
+		{MAVLINK_MSG_ID_FOLLOW_TARGET, &MavlinkReceiver::handle_message_follow_target},
+		{MAVLINK_MSG_ID_BATTERY_STATUS, &MavlinkReceiver::handle_message_battery_status},
+		{MAVLINK_MSG_ID_LANDING_TARGET, &MavlinkReceiver::handle_message_landing_target},
+		{MAVLINK_MSG_ID_GPS_RTCM_DATA, &MavlinkReceiver::handle_message_gps_rtcm_data},
+		{MAVLINK_MSG_ID_ADSB_VEHICLE, &MavlinkReceiver::handle_message_adsb_vehicle},
+		{MAVLINK_MSG_ID_COLLISION, &MavlinkReceiver::handle_message_collision},
+		{MAVLINK_MSG_ID_DEBUG_VECT, &MavlinkReceiver::handle_message_debug_vect},
+		{MAVLINK_MSG_ID_NAMED_VALUE_FLOAT, &MavlinkReceiver::handle_message_named_value_float},
+		{MAVLINK_MSG_ID_DEBUG, &MavlinkReceiver::handle_message_debug},
+		{MAVLINK_MSG_ID_PLAY_TUNE, &MavlinkReceiver::handle_message_play_tune},
+		{MAVLINK_MSG_ID_LOGGING_ACK, &MavlinkReceiver::handle_message_logging_ack},
+		{MAVLINK_MSG_ID_OBSTACLE_DISTANCE, &MavlinkReceiver::handle_message_obstacle_distance},
+		{MAVLINK_MSG_ID_ODOMETRY, &MavlinkReceiver::handle_message_odometry},
+		{MAVLINK_MSG_ID_TRAJECTORY_REPRESENTATION_WAYPOINTS, &MavlinkReceiver::handle_message_trajectory_representation_waypoints},
+		{MAVLINK_MSG_ID_DEBUG_FLOAT_ARRAY, &MavlinkReceiver::handle_message_debug_float_array},
+	};
+
+	static constexpr int _num_message_handlers = sizeof(_message_handlers) / sizeof(_message_handlers[0]);
+
+	static constexpr bool message_handlers_sorted(int i = 0)
+	{
+		return i + 1 >= _num_message_handlers
+		       || (_message_handlers[i].msgid < _message_handlers[i + 1].msgid && message_handlers_sorted(i + 1));
+	}
+
 	Mavlink	*_mavlink;
 
 	MavlinkMissionManager		_mission_manager;
@@ -203,7 +254,7 @@ private:
 	MavlinkLogHandler		_mavlink_log_handler;
 	MavlinkTimesync		_mavlink_timesync;
 
-	mavlink_status_t _status; ///< receiver status, used for mavlink_parse_char()
+	MavlinkFrameParser _frame_parser;
 	struct vehicle_attitude_s _att;
 	struct vehicle_local_position_s _hil_local_pos;
 	struct vehicle_land_detected_s _hil_land_detector;
@@ -596,6 +596,120 @@ bool MavlinkFtpTest::_burst_test()
 	return true;
 }
 
+/// @brief Tests that two files can be open at the same time, in separate sessions.
+bool MavlinkFtpTest::_open_multiple_test()
+{
+	MavlinkFTP::PayloadHeader		payload;
+	const MavlinkFTP::PayloadHeader		*reply;
+	uint8_t					sessions[2];
+
+	for (size_t i = 0; i < 2; i++) {
+		const char *file = _rgDownloadTestCases[i].file;
+
+		payload.opcode = MavlinkFTP::kCmdOpenFileRO;
+		payload.offset = 0;
+
+		bool success = _send_receive_msg(&payload,		// FTP payload header
+						 strlen(file) + 1,	// size in bytes of data
+						 (uint8_t *)file,	// Data to start into FTP message payload
+						 &reply);		// Payload inside FTP message response
+
+		if (!success) {
+			return false;
+		}
+
+		ut_compare("Didn't get Ack back", reply->opcode, MavlinkFTP::kRspAck);
+		sessions[i] = reply->session;
+	}
+
+	ut_assert("Sessions not distinct", sessions[0] != sessions[1]);
+
+	// each session reads its own file
+	for (size_t i = 0; i < 2; i++) {
+		payload.opcode = MavlinkFTP::kCmdReadFile;
+		payload.session = sessions[i];
+		payload.offset = 0;
+
+		bool success = _send_receive_msg(&payload,	// FTP payload header
+						 0,		// size in bytes of data
+						 nullptr,	// Data to start into FTP message payload
+						 &reply);	// Payload inside FTP message response
+
+		if (!success) {
+			return false;
+		}
+
+		ut_compare("Didn't get Ack back", reply->opcode, MavlinkFTP::kRspAck);
+		ut_compare("Payload size incorrect", reply->size, _rgDownloadTestCases[i].length);
+	}
+
+	for (size_t i = 0; i < 2; i++) {
+		payload.opcode = MavlinkFTP::kCmdTerminateSession;
+		payload.session = sessions[i];
+		payload.size = 0;
+
+		bool success = _send_receive_msg(&payload,	// FTP payload header
+						 0,		// size in bytes of data
+						 nullptr,	// Data to start into FTP message payload
+						 &reply);	// Payload inside FTP message response
+
+		if (!success) {
+			return false;
+		}
+
+		ut_compare("Didn't get Ack back", reply->opcode, MavlinkFTP::kRspAck);
+	}
+
+	return true;
+}
+
+/// @brief Tests for correct reponse to a CalcFileCRC32 command. The reply is sent from the stream mechanism.
+bool MavlinkFtpTest::_crc32_test()
+{
+	MavlinkFTP::PayloadHeader		payload;
+	const MavlinkFTP::PayloadHeader		*reply;
+
+	for (size_t i = 0; i < sizeof(_rgDownloadTestCases) / sizeof(_rgDownloadTestCases[0]); i++) {
+		struct stat st;
+		const DownloadTestCase *test = &_rgDownloadTestCases[i];
+
+		// Read in the file so we can compare the checksum
+		ut_compare("stat failed", stat(test->file, &st), 0);
+		uint8_t *bytes = new uint8_t[st.st_size];
+		ut_assert("new failed", bytes != nullptr);
+		int fd = ::open(test->file, O_RDONLY);
+		ut_assert("open failed", fd != -1);
+		int bytes_read = ::read(fd, bytes, st.st_size);
+		ut_compare("read failed", bytes_read, st.st_size);
+		::close(fd);
+
+		uint32_t expected_crc = crc32part(bytes, st.st_size, 0);
+		delete[] bytes;
+
+		payload.opcode = MavlinkFTP::kCmdCalcFileCRC32;
+		payload.offset = 0;
+
+		mavlink_message_t msg;
+		_setup_ftp_msg(&payload, strlen(test->file) + 1, (const uint8_t *)test->file, &msg);
+		memset(&_reply_msg, 0, sizeof(_reply_msg));
+		_ftp_server->handle_message(&msg);
+
+		// Reply is sent once the checksum is done, we need to force it out ourselves
+		hrt_abstime t = 0;
+		_ftp_server->send(t);
+
+		if (!_decode_message(&_reply_msg, &reply)) {
+			return false;
+		}
+
+		ut_compare("Didn't get Ack back", reply->opcode, MavlinkFTP::kRspAck);
+		ut_compare("Incorrect payload size", reply->size, sizeof(uint32_t));
+		ut_compare("Checksum incorrect", *((uint32_t *)&reply->data[0]), expected_crc);
+	}
+
+	return true;
+}
+
 /// @brief Tests for correct reponse to a Read command on an invalid session.
 bool MavlinkFtpTest::_read_badsession_test()
 {
@@ -963,6 +1077,8 @@ bool MavlinkFtpTest::run_tests()
 	ut_run_test(_read_test);
 	ut_run_test(_read_badsession_test);
 	ut_run_test(_burst_test);
+	ut_run_test(_open_multiple_test);
+	ut_run_test(_crc32_test);
 	ut_run_test(_removedirectory_test);
 
 	// TODO FIX: Didn't get Nak back - (reply->opcode:128) (MavlinkFTP::kRspNak:129) (../../src/modules/mavlink/mavlink_tests/mavlink_ftp_test.cpp:730)
@@ -0,0 +1,370 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2018 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+/// @file mavlink_parser_test.cpp
+/// Compares the frame-level MAVLink parser with the byte-wise parser on a generated byte stream
+
+#include <string.h>
+
+#include <drivers/drv_hrt.h>
+#include <mathlib/mathlib.h>
+
+#include "mavlink_parser_test.h"
+
+namespace
+{
+
+/// Deterministic pseudo random generator, so that the stream is reproducible
+class Random
+{
+public:
+	uint32_t next()
+	{
+		_state ^= _state << 13;
+		_state ^= _state >> 17;
+		_state ^= _state << 5;
+		return _state;
+	}
+
+	uint32_t range(uint32_t n) { return next() % n; }
+
+	bool chance(uint32_t percent) { return range(100) < percent; }
+
+private:
+	uint32_t _state{2463534242u};
+};
+
+/// Traffic mix of an onboard computer: setpoints, vision, obstacle data, RTCM and heartbeats
+const uint32_t stream_msgids[] = {
+	MAVLINK_MSG_ID_HEARTBEAT,
+	MAVLINK_MSG_ID_ATTITUDE,
+	MAVLINK_MSG_ID_SET_POSITION_TARGET_LOCAL_NED,
+	MAVLINK_MSG_ID_VISION_POSITION_ESTIMATE,
+	MAVLINK_MSG_ID_TIMESYNC,
+	MAVLINK_MSG_ID_DISTANCE_SENSOR,
+	MAVLINK_MSG_ID_GPS_RTCM_DATA,
+	MAVLINK_MSG_ID_OBSTACLE_DISTANCE,
+	MAVLINK_MSG_ID_ODOMETRY,
+	MAVLINK_MSG_ID_DEBUG_FLOAT_ARRAY,
+};
+
+/// Encode a frame with the reference CRC implementation, independent of the parser under test
+int encode_frame(uint8_t *out, bool mavlink1, uint32_t msgid, uint8_t seq, const uint8_t *payload, uint8_t len,
+		 uint8_t crc_extra)
+{
+	int n = 0;
+
+	if (mavlink1) {
+		out[n++] = MAVLINK_STX_MAVLINK1;
+		out[n++] = len;
+		out[n++] = seq;
+		out[n++] = 1; // sysid
+		out[n++] = 191; // compid
+		out[n++] = msgid;
+
+	} else {
+		out[n++] = MAVLINK_STX;
+		out[n++] = len;
+		out[n++] = 0; // incompat_flags
+		out[n++] = 0; // compat_flags
+		out[n++] = seq;
+		out[n++] = 1;
+		out[n++] = 191;
+		out[n++] = msgid & 0xff;
+		out[n++] = (msgid >> 8) & 0xff;
+		out[n++] = (msgid >> 16) & 0xff;
+	}
+
+	memcpy(&out[n], payload, len);
+	n += len;
+
+	uint16_t crc;
+	crc_init(&crc);
+
+	for (int i = 1; i < n; i++) {
+		crc_accumulate(out[i], &crc);
+	}
+
+	crc_accumulate(crc_extra, &crc);
+	out[n++] = crc & 0xff;
+	out[n++] = crc >> 8;
+	return n;
+}
+
+} // namespace
+
+MavlinkParserTest::~MavlinkParserTest()
+{
+	delete[] _stream;
+	delete[] _frames;
+}
+
+bool MavlinkParserTest::_init_stream()
+{
+	if (_stream) {
+		return true;
+	}
+
+	_stream = new uint8_t[kStreamSize];
+	_frames = new ExpectedFrame[kMaxFrames];
+
+	if (!_stream || !_frames) {
+		return false;
+	}
+
+	Random random;
+	uint8_t payload[MAVLINK_MAX_PAYLOAD_LEN];
+	uint8_t seq = 0;
+
+	while (_num_frames < kMaxFrames) {
+		// line noise, including bytes that look like start markers
+		if (random.chance(5)) {
+			const int garbage = 1 + random.range(20);
+
+			if (_stream_len + garbage > kStreamSize) {
+				break;
+			}
+
+			for (int i = 0; i < garbage; i++) {
+				_stream[_stream_len++] = random.chance(30) ? MAVLINK_STX : random.range(256);
+			}
+		}
+
+		const uint32_t msgid = stream_msgids[random.range(sizeof(stream_msgids) / sizeof(stream_msgids[0]))];
+		const mavlink_msg_entry_t *entry = mavlink_get_msg_entry(msgid);
+
+		if (entry == nullptr) {
+			return false;
+		}
+
+		const bool mavlink1 = msgid < 256 && random.chance(10);
+		uint8_t len = mavlink1 ? entry->min_msg_len : entry->max_msg_len;
+
+		for (int i = 0; i < len; i++) {
+			payload[i] = random.range(256);
+		}
+
+		if (!mavlink1) {
+			// MAVLink 2 drops trailing zeros
+			if (random.chance(30)) {
+				memset(&payload[len / 2], 0, len - len / 2);
+			}
+
+			while (len > 1 && payload[len - 1] == 0) {
+				len--;
+			}
+		}
+
+		if (_stream_len + MAVLINK_MAX_PACKET_LEN > kStreamSize) {
+			break;
+		}
+
+		uint8_t *frame = &_stream[_stream_len];
+		const int frame_len = encode_frame(frame, mavlink1, msgid, seq, payload, len, entry->crc_extra);
+
+		if (random.chance(3)) {
+			// corrupted in transit
+			frame[1 + random.range(frame_len - 1)] ^= 1 << random.range(8);
+
+		} else {
+			ExpectedFrame &expected = _frames[_num_frames++];
+			expected.msgid = msgid;
+			expected.seq = seq;
+			expected.len = len;
+			expected.max_len = mavlink1 ? entry->min_msg_len : entry->max_msg_len;
+			expected.payload_offset = _stream_len + (mavlink1 ? MAVLINK_CORE_HEADER_MAVLINK1_LEN + 1 : MAVLINK_NUM_HEADER_BYTES);
+		}
+
+		_stream_len += frame_len;
+		seq++;
+	}
+
+	return true;
+}
+
+bool MavlinkParserTest::_check_message(const mavlink_message_t &msg, int index)
+{
+	ut_assert("Too many messages", index < _num_frames);
+
+	const ExpectedFrame &expected = _frames[index];
+	const uint8_t *payload = (const uint8_t *)_MAV_PAYLOAD(&msg);
+
+	ut_compare("Message id mismatch", msg.msgid, expected.msgid);
+	ut_compare("Sequence mismatch", msg.seq, expected.seq);
+	ut_compare("Length mismatch", msg.len, expected.len);
+	ut_compare("Payload mismatch", memcmp(payload, &_stream[expected.payload_offset], expected.len), 0);
+
+	for (int i = expected.len; i < expected.max_len; i++) {
+		ut_compare("Payload not zero-filled", payload[i], 0);
+	}
+
+	return true;
+}
+
+bool MavlinkParserTest::_frame_parser_test()
+{
+	ut_assert("stream setup failed", _init_stream());
+
+	// feed the stream in chunks of varying size, so that frames get split across inputs
+	mavlink_status_t status{};
+	MavlinkFrameParser parser(&status);
+	mavlink_message_t msg;
+	Random random;
+	int received = 0;
+	int offset = 0;
+
+	while (offset < _stream_len) {
+		int chunk = 1 + random.range(300);
+
+		if (chunk > _stream_len - offset) {
+			chunk = _stream_len - offset;
+		}
+
+		parser.set_input(&_stream[offset], chunk);
+
+		while (parser.next(&msg)) {
+			if (!_check_message(msg, received)) {
+				return false;
+			}
+
+			received++;
+		}
+
+		offset += chunk;
+	}
+
+	ut_compare("Missing messages", received, _num_frames);
+	ut_compare("Success count mismatch", (int)status.packet_rx_success_count, _num_frames);
+	ut_assert("No drops counted", status.packet_rx_drop_count > 0);
+
+	return true;
+}
+
+bool MavlinkParserTest::_byte_parser_test()
+{
+	ut_assert("stream setup failed", _init_stream());
+
+	// the byte-wise parser may lose a good frame following a false start marker, but must never
+	// return anything that was not sent
+	mavlink_message_t rxmsg{};
+	mavlink_status_t status{};
+	mavlink_message_t msg;
+	mavlink_status_t msg_status;
+	int received = 0;
+	int next_expected = 0;
+
+	for (int i = 0; i < _stream_len; i++) {
+		if (mavlink_frame_char_buffer(&rxmsg, &status, _stream[i], &msg, &msg_status) == MAVLINK_FRAMING_OK) {
+			while (next_expected < _num_frames && _frames[next_expected].seq != msg.seq) {
+				next_expected++;
+			}
+
+			if (!_check_message(msg, next_expected)) {
+				return false;
+			}
+
+			next_expected++;
+			received++;
+		}
+	}
+
+	PX4_INFO("byte-wise parser: %i of %i messages", received, _num_frames);
+
+	return true;
+}
+
+bool MavlinkParserTest::_benchmark_test()
+{
+	ut_assert("stream setup failed", _init_stream());
+
+	static constexpr int repetitions = 50;
+	static constexpr int chunk_size = 1600; // a UDP datagram, as in the receive thread
+	mavlink_message_t msg;
+	int received_frame = 0;
+	int received_byte = 0;
+
+	hrt_abstime start = hrt_absolute_time();
+
+	for (int r = 0; r < repetitions; r++) {
+		MavlinkFrameParser parser;
+
+		for (int offset = 0; offset < _stream_len; offset += chunk_size) {
+			const int chunk = (_stream_len - offset < chunk_size) ? _stream_len - offset : chunk_size;
+			parser.set_input(&_stream[offset], chunk);
+
+			while (parser.next(&msg)) {
+				received_frame++;
+			}
+		}
+	}
+
+	const hrt_abstime frame_time = hrt_elapsed_time(&start);
+
+	start = hrt_absolute_time();
+
+	for (int r = 0; r < repetitions; r++) {
+		mavlink_message_t rxmsg{};
+		mavlink_status_t status{};
+		mavlink_status_t msg_status;
+
+		for (int i = 0; i < _stream_len; i++) {
+			if (mavlink_frame_char_buffer(&rxmsg, &status, _stream[i], &msg, &msg_status) == MAVLINK_FRAMING_OK) {
+				received_byte++;
+			}
+		}
+	}
+
+	const hrt_abstime byte_time = hrt_elapsed_time(&start);
+
+	ut_compare("Frame parser message count", received_frame, repetitions * _num_frames);
+
+	const double bytes = (double)_stream_len * repetitions;
+	PX4_INFO("replayed %i generated bytes x %i: byte-wise %.1f MB/s (%i msgs), frame parser %.1f MB/s (%i msgs), speedup %.1fx",
+		 _stream_len, repetitions, bytes / (double)math::max(byte_time, (hrt_abstime)1), received_byte,
+		 bytes / (double)math::max(frame_time, (hrt_abstime)1), received_frame,
+		 (double)byte_time / (double)math::max(frame_time, (hrt_abstime)1));
+
+	return true;
+}
+
+bool MavlinkParserTest::run_tests(void)
+{
+	ut_run_test(_frame_parser_test);
+	ut_run_test(_byte_parser_test);
+	ut_run_test(_benchmark_test);
+
+	return (_tests_failed == 0);
+}
+
+ut_declare_test(mavlink_parser_test, MavlinkParserTest)
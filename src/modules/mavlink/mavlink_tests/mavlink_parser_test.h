@@ -0,0 +1,82 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2018 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+/// @file mavlink_parser_test.h
+/// Compares the frame-level MAVLink parser with the byte-wise parser on a generated byte stream
+///
+/// The stream is generated rather than captured from a vehicle, so that every frame in it is
+/// known and the parsed messages can be checked one by one. It models the traffic of an
+/// onboard computer, with line noise and corrupted frames mixed in.
+
+#pragma once
+
+#include <unit_test.h>
+#include "../mavlink_frame_parser.h"
+
+class MavlinkParserTest : public UnitTest
+{
+public:
+	MavlinkParserTest() = default;
+	virtual ~MavlinkParserTest();
+
+	virtual bool run_tests(void);
+
+private:
+	bool _init_stream(void);
+	bool _frame_parser_test(void);
+	bool _byte_parser_test(void);
+	bool _benchmark_test(void);
+
+	/// Frame that was written intact into the stream
+	struct ExpectedFrame {
+		uint32_t	msgid;
+		uint8_t		seq;
+		uint8_t		len;		///< payload length on the wire
+		uint8_t		max_len;	///< payload length after zero-filling
+		uint32_t	payload_offset;	///< offset of the payload in the stream
+	};
+
+	/// Check a parsed message against the next expected frame
+	bool _check_message(const mavlink_message_t &msg, int index);
+
+	static constexpr int kStreamSize = 32 * 1024;
+	static constexpr int kMaxFrames = kStreamSize / 12;
+
+	uint8_t		*_stream{nullptr};
+	int		_stream_len{0};
+	ExpectedFrame	*_frames{nullptr};
+	int		_num_frames{0};
+};
+
+bool mavlink_parser_test(void);
@@ -38,10 +38,16 @@
 #include <systemlib/err.h>
 
 #include "mavlink_ftp_test.h"
+#include "mavlink_ulog_test.h"
+#include "mavlink_parser_test.h"
 
 extern "C" __EXPORT int mavlink_tests_main(int argc, char *argv[]);
 
 int mavlink_tests_main(int argc, char *argv[])
 {
-	return mavlink_ftp_test() ? 0 : -1;
+	bool success = mavlink_ftp_test();
+	success = mavlink_ulog_test() && success;
+	success = mavlink_parser_test() && success;
+
+	return success ? 0 : -1;
 }
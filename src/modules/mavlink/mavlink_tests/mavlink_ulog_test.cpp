@@ -0,0 +1,438 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2018 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+/// @file mavlink_ulog_test.cpp
+/// Tests of the acked ULog streaming: retransmission timer, a loopback simulation with injected
+/// latency and loss, and the send/ack path through MavlinkULog
+
+#include <string.h>
+#include <px4_time.h>
+
+#include "mavlink_ulog_test.h"
+
+namespace
+{
+
+/// Deterministic pseudo random generator, so that the loss pattern is reproducible
+class LossGenerator
+{
+public:
+	explicit LossGenerator(float probability) : _threshold((uint32_t)(probability * 65536.f)) {}
+
+	bool drop()
+	{
+		_state = _state * 1103515245u + 12345u;
+		return ((_state >> 16) & 0xffff) < _threshold;
+	}
+
+private:
+	uint32_t _threshold;
+	uint32_t _state{42};
+};
+
+/// Packets travelling over the simulated link, ordered by arrival time
+template<int N>
+class DelayLine
+{
+public:
+	bool push(uint16_t sequence, hrt_abstime arrival)
+	{
+		if (_count >= N) {
+			return false;
+		}
+
+		_items[(_head + _count) % N] = {sequence, arrival};
+		++_count;
+		return true;
+	}
+
+	bool pop(hrt_abstime now, uint16_t &sequence)
+	{
+		if (_count == 0 || _items[_head].arrival > now) {
+			return false;
+		}
+
+		sequence = _items[_head].sequence;
+		_head = (_head + 1) % N;
+		--_count;
+		return true;
+	}
+
+private:
+	struct Item {
+		uint16_t sequence;
+		hrt_abstime arrival;
+	};
+
+	Item _items[N] {};
+	int _head{0};
+	int _count{0};
+};
+
+} // namespace
+
+MavlinkULogTest::LinkResult MavlinkULogTest::_simulate(bool adaptive, int num_msgs, uint32_t latency_us, float loss)
+{
+	static constexpr hrt_abstime tick_us = 1000;
+	static constexpr hrt_abstime max_duration_us = 3600 * 1000000ull;
+	static constexpr hrt_abstime fixed_timeout_us = ulog_stream_ack_s::ACK_TIMEOUT * 1000;
+
+	MavlinkULogRetransmit retransmit;
+	LossGenerator loss_generator(loss);
+	DelayLine<512> data_link;
+	DelayLine<512> ack_link;
+
+	// receiver, see Tools/mavlink_ulog_streaming.py
+	int last_sequence = -1;
+	int drops = 0;
+
+	// sender with a fixed timeout
+	bool fixed_in_flight = false;
+	uint16_t fixed_sequence = 0;
+	hrt_abstime fixed_sent_time = 0;
+
+	int next_to_send = 0;
+	int num_acked = 0;
+	uint32_t transmissions = 0;
+	bool timed_out = false;
+
+	ulog_stream_s msg{};
+	msg.flags = ulog_stream_s::FLAGS_NEED_ACK;
+
+	hrt_abstime now = 1;
+
+	while (num_acked < num_msgs && !timed_out && now < max_duration_us) {
+		uint16_t sequence;
+
+		// receiver: keep messages newer than the last one, count the skipped ones as dropped, ack everything
+		while (data_link.pop(now, sequence)) {
+			if (sequence > last_sequence) {
+				drops += sequence - last_sequence - 1;
+				last_sequence = sequence;
+			}
+
+			if (!loss_generator.drop()) {
+				ack_link.push(sequence, now + latency_us);
+			}
+		}
+
+		// sender: handle acks
+		while (ack_link.pop(now, sequence)) {
+			if (adaptive) {
+				if (retransmit.ack(sequence, now)) {
+					++num_acked;
+				}
+
+			} else if (fixed_in_flight && sequence == fixed_sequence) {
+				fixed_in_flight = false;
+				++num_acked;
+			}
+		}
+
+		// sender: retransmission, or the next message once the previous one is acked
+		bool send = false;
+
+		if (adaptive) {
+			const ulog_stream_s *resend = retransmit.next_retransmission(now, timed_out);
+
+			if (resend) {
+				sequence = resend->sequence;
+				send = true;
+
+			} else if (!retransmit.in_flight() && next_to_send < num_msgs) {
+				msg.sequence = next_to_send++;
+				retransmit.sent(msg, now);
+				sequence = msg.sequence;
+				send = true;
+			}
+
+		} else {
+			if (fixed_in_flight && now - fixed_sent_time >= fixed_timeout_us) {
+				fixed_sent_time = now;
+				sequence = fixed_sequence;
+				send = true;
+
+			} else if (!fixed_in_flight && next_to_send < num_msgs) {
+				fixed_sequence = next_to_send++;
+				fixed_sent_time = now;
+				fixed_in_flight = true;
+				sequence = fixed_sequence;
+				send = true;
+			}
+		}
+
+		if (send) {
+			++transmissions;
+
+			if (!loss_generator.drop()) {
+				data_link.push(sequence, now + latency_us);
+			}
+		}
+
+		now += tick_us;
+	}
+
+	LinkResult result;
+	result.complete = num_acked == num_msgs && last_sequence == num_msgs - 1;
+	result.drops = drops;
+	result.throughput = num_msgs / (now * 1e-6f);
+	result.transmissions = transmissions;
+	return result;
+}
+
+bool MavlinkULogTest::_ack_test(void)
+{
+	MavlinkULogRetransmit retransmit;
+	ulog_stream_s msg{};
+
+	ut_assert_false(retransmit.in_flight());
+	ut_assert_false(retransmit.ack(10, 1000));
+
+	msg.sequence = 10;
+	retransmit.sent(msg, 1000);
+	ut_assert_true(retransmit.in_flight());
+
+	// acks for other messages are ignored
+	ut_assert_false(retransmit.ack(9, 2000));
+	ut_assert_true(retransmit.in_flight());
+
+	ut_assert_true(retransmit.ack(10, 21000));
+	ut_assert_false(retransmit.in_flight());
+	ut_compare("rtt", (int)retransmit.srtt_us(), 20000);
+	ut_compare("rto", retransmit.rto_us(), 20000 + 4 * 10000);
+
+	// a duplicate ack (e.g. for a retransmission) is ignored
+	ut_assert_false(retransmit.ack(10, 22000));
+
+	return true;
+}
+
+bool MavlinkULogTest::_retransmission_test(void)
+{
+	MavlinkULogRetransmit retransmit;
+	ulog_stream_s msg{};
+	bool timed_out;
+
+	msg.sequence = 3;
+	retransmit.sent(msg, 0);
+
+	const uint32_t rto = retransmit.rto_us();
+	ut_assert("no retransmission before timeout", retransmit.next_retransmission(rto - 1, timed_out) == nullptr);
+
+	const ulog_stream_s *resend = retransmit.next_retransmission(rto, timed_out);
+	ut_assert("message resent", resend != nullptr && resend->sequence == 3);
+	ut_assert_false(timed_out);
+	ut_compare("timer backed off", retransmit.rto_us(), 2 * rto);
+	ut_assert("resent only once", retransmit.next_retransmission(rto, timed_out) == nullptr);
+
+	// Karn: the ack of a retransmitted message gives no rtt sample
+	ut_assert_true(retransmit.ack(3, rto + 5000));
+	ut_compare("no rtt sample", (int)retransmit.srtt_us(), 0);
+	ut_compare("retransmissions", retransmit.retransmissions(), 1);
+
+	return true;
+}
+
+bool MavlinkULogTest::_timeout_test(void)
+{
+	MavlinkULogRetransmit retransmit;
+	ulog_stream_s msg{};
+	bool timed_out = false;
+	const hrt_abstime timeout = (hrt_abstime)ulog_stream_ack_s::ACK_TIMEOUT * ulog_stream_ack_s::ACK_MAX_TRIES * 1000;
+	hrt_abstime now = 0;
+
+	retransmit.sent(msg, now);
+
+	// keep resending until giving up, like the logger does after the same time without an ack
+	while (!timed_out && now < 2 * timeout) {
+		now += 1000;
+		retransmit.next_retransmission(now, timed_out);
+	}
+
+	ut_assert_true(timed_out);
+	ut_assert("not given up early", now >= timeout);
+
+	return true;
+}
+
+bool MavlinkULogTest::_in_order_vs_latency_test(void)
+{
+	static constexpr int num_msgs = 200;
+	const uint32_t latencies_us[] = {1000, 10000, 50000, 200000};
+
+	PX4_INFO("latency [ms] | fixed timeout [msg/s] | sent | adaptive timeout [msg/s] | sent");
+
+	for (uint32_t latency : latencies_us) {
+		LinkResult fixed = _simulate(false, num_msgs, latency, 0.f);
+		LinkResult adaptive = _simulate(true, num_msgs, latency, 0.f);
+
+		PX4_INFO("%12.1f | %21.1f | %4u | %24.1f | %4u", (double)(latency * 1e-3f), (double)fixed.throughput,
+			 (unsigned)fixed.transmissions, (double)adaptive.throughput, (unsigned)adaptive.transmissions);
+
+		ut_assert_true(fixed.complete);
+		ut_assert_true(adaptive.complete);
+		ut_compare("no gaps at the receiver", adaptive.drops, 0);
+		ut_assert("not slower", adaptive.throughput >= fixed.throughput * 0.99f);
+
+		// a round trip longer than ACK_TIMEOUT makes the fixed timeout resend every message several times
+		ut_assert("no spurious retransmissions", adaptive.transmissions < num_msgs + 10);
+	}
+
+	return true;
+}
+
+bool MavlinkULogTest::_in_order_vs_loss_test(void)
+{
+	static constexpr int num_msgs = 500;
+	static constexpr uint32_t latency_us = 2000;
+	const float losses[] = {0.f, 0.01f, 0.05f, 0.1f};
+
+	PX4_INFO("loss [%%] | fixed timeout [msg/s] | adaptive timeout [msg/s] | sent");
+
+	for (float loss : losses) {
+		LinkResult fixed = _simulate(false, num_msgs, latency_us, loss);
+		LinkResult adaptive = _simulate(true, num_msgs, latency_us, loss);
+
+		PX4_INFO("%8.1f | %21.1f | %24.1f | %4u", (double)(loss * 100.f), (double)fixed.throughput,
+			 (double)adaptive.throughput, (unsigned)adaptive.transmissions);
+
+		ut_assert_true(fixed.complete);
+		ut_assert_true(adaptive.complete);
+		ut_compare("no gaps at the receiver", adaptive.drops, 0);
+		ut_assert("not slower", adaptive.throughput >= fixed.throughput * 0.99f);
+
+		if (loss >= 0.05f) {
+			// a lost message is resent after a few round trips instead of ACK_TIMEOUT
+			ut_assert("faster recovery", adaptive.throughput > 1.5f * fixed.throughput);
+		}
+	}
+
+	return true;
+}
+
+void MavlinkULogTest::_send_callback(const ulog_stream_s &msg, bool acked, void *user)
+{
+	MavlinkULogTest *test = static_cast<MavlinkULogTest *>(user);
+
+	if (test->_num_sent < _max_sent) {
+		test->_sent[test->_num_sent].sequence = msg.sequence;
+		test->_sent[test->_num_sent].acked = acked;
+	}
+
+	++test->_num_sent;
+}
+
+bool MavlinkULogTest::_send_ack_path_test(void)
+{
+	MavlinkULog::initialize();
+	MavlinkULog *ulog = MavlinkULog::try_start(100000, 1.f, 1, 1);
+	ut_assert("stream started (is a mavlink log stream running?)", ulog != nullptr);
+
+	ulog->set_unittest_sender(_send_callback, this);
+	ulog->start_ack_received();
+	_num_sent = 0;
+
+	int ack_sub = orb_subscribe(ORB_ID(ulog_stream_ack));
+	ulog_stream_ack_s stream_ack;
+	bool updated = false;
+
+	// the logger queues two acked messages followed by an unacked one
+	ulog_stream_s msg{};
+	msg.timestamp = hrt_absolute_time();
+	msg.flags = ulog_stream_s::FLAGS_NEED_ACK;
+	msg.sequence = 0;
+	orb_advert_t pub = orb_advertise_queue(ORB_ID(ulog_stream), &msg, 14);
+	msg.sequence = 1;
+	orb_publish(ORB_ID(ulog_stream), pub, &msg);
+	msg.flags = 0;
+	msg.sequence = 2;
+	orb_publish(ORB_ID(ulog_stream), pub, &msg);
+
+	mavlink_logging_ack_t ack{};
+
+	ulog->handle_update(MAVLINK_COMM_0);
+	ut_compare("first message sent", _num_sent, 1);
+	ut_assert("acked message", _sent[0].sequence == 0 && _sent[0].acked);
+
+	ulog->handle_update(MAVLINK_COMM_0);
+	ut_compare("nothing sent while waiting for the ack", _num_sent, 1);
+
+	px4_usleep(ulog_stream_ack_s::ACK_TIMEOUT * 1000 + 10000);
+	ulog->handle_update(MAVLINK_COMM_0);
+	ut_compare("resent after the timeout", _num_sent, 2);
+	ut_assert("same message resent", _sent[1].sequence == 0 && _sent[1].acked);
+
+	// an ack for a message that is not in flight is not passed on to the logger
+	ack.sequence = 1;
+	ulog->handle_ack(ack);
+	orb_check(ack_sub, &updated);
+	ut_assert_false(updated);
+
+	ack.sequence = 0;
+	ulog->handle_ack(ack);
+	orb_check(ack_sub, &updated);
+	ut_assert_true(updated);
+	orb_copy(ORB_ID(ulog_stream_ack), ack_sub, &stream_ack);
+	ut_compare("logger acked", stream_ack.sequence, 0);
+
+	ulog->handle_update(MAVLINK_COMM_0);
+	ut_compare("next message sent once acked", _num_sent, 3);
+	ut_assert("acked message", _sent[2].sequence == 1 && _sent[2].acked);
+
+	ack.sequence = 1;
+	ulog->handle_ack(ack);
+	ulog->handle_update(MAVLINK_COMM_0);
+	ut_compare("unacked message sent", _num_sent, 4);
+	ut_assert("unacked message", _sent[3].sequence == 2 && !_sent[3].acked);
+
+	orb_unadvertise(pub);
+	orb_unsubscribe(ack_sub);
+	ulog->stop();
+
+	return true;
+}
+
+bool MavlinkULogTest::run_tests(void)
+{
+	ut_run_test(_ack_test);
+	ut_run_test(_retransmission_test);
+	ut_run_test(_timeout_test);
+	ut_run_test(_in_order_vs_latency_test);
+	ut_run_test(_in_order_vs_loss_test);
+	ut_run_test(_send_ack_path_test);
+
+	return (_tests_failed == 0);
+}
+
+ut_declare_test(mavlink_ulog_test, MavlinkULogTest)
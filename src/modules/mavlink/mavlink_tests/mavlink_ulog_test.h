@@ -0,0 +1,87 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2018 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+/// @file mavlink_ulog_test.h
+/// Tests of the acked ULog streaming: retransmission timer, a loopback simulation with injected
+/// latency and loss, and the send/ack path through MavlinkULog
+
+#pragma once
+
+#include <unit_test.h>
+#include "../mavlink_ulog.h"
+
+class MavlinkULogTest : public UnitTest
+{
+public:
+	MavlinkULogTest() = default;
+	virtual ~MavlinkULogTest() = default;
+
+	virtual bool run_tests(void);
+
+private:
+	bool _ack_test(void);
+	bool _retransmission_test(void);
+	bool _timeout_test(void);
+	bool _in_order_vs_latency_test(void);
+	bool _in_order_vs_loss_test(void);
+	bool _send_ack_path_test(void);
+
+	/// Result of a simulated transfer
+	struct LinkResult {
+		bool		complete;	///< all messages delivered and acked
+		int		drops;		///< messages the receiver counted as dropped
+		bool		in_order;	///< the receiver accepted every message in sequence order
+		float		throughput;	///< messages per second
+		uint32_t	transmissions;	///< sent messages, including retransmissions
+	};
+
+	/// Simulate the transfer of num_msgs acked messages over a link with the given one-way latency and
+	/// loss probability. The receiver behaves like Tools/mavlink_ulog_streaming.py.
+	/// @param adaptive use MavlinkULogRetransmit, otherwise a fixed ACK_TIMEOUT (the previous behavior)
+	LinkResult _simulate(bool adaptive, int num_msgs, uint32_t latency_us, float loss);
+
+	static void _send_callback(const ulog_stream_s &msg, bool acked, void *user);
+
+	static constexpr int _max_sent = 8;
+
+	struct SentMessage {
+		uint16_t sequence;
+		bool acked;
+	};
+
+	SentMessage	_sent[_max_sent] {};
+	int		_num_sent{0};
+};
+
+bool mavlink_ulog_test(void);
@@ -90,7 +90,6 @@ MavlinkULog::~MavlinkULog()
 void MavlinkULog::start_ack_received()
 {
 	if (_waiting_for_initial_ack) {
-		_last_sent_time = 0;
 		_waiting_for_initial_ack = false;
 		PX4_DEBUG("got logger ack");
 	}
@@ -112,84 +111,54 @@ int MavlinkULog::handle_update(mavlink_channel_t channel)
 		return 0;
 	}
 
-	// check if we're waiting for an ACK
-	if (_last_sent_time) {
-		bool check_for_updates = false;
+	const hrt_abstime now = hrt_absolute_time();
 
-		if (_ack_received) {
-			_last_sent_time = 0;
-			check_for_updates = true;
+	lock();
 
-		} else {
+	if (_retransmit.in_flight()) {
+		bool timed_out;
+		const ulog_stream_s *resend = _retransmit.next_retransmission(now, timed_out);
 
-			if (hrt_elapsed_time(&_last_sent_time) > ulog_stream_ack_s::ACK_TIMEOUT * 1000) {
-				if (++_sent_tries > ulog_stream_ack_s::ACK_MAX_TRIES) {
-					return -ETIMEDOUT;
-
-				} else {
-					PX4_DEBUG("re-sending ulog mavlink message (try=%i)", _sent_tries);
-					_last_sent_time = hrt_absolute_time();
-					mavlink_logging_data_acked_t msg;
-					msg.sequence = _ulog_data.sequence;
-					msg.length = _ulog_data.length;
-					msg.first_message_offset = _ulog_data.first_message_offset;
-					msg.target_system = _target_system;
-					msg.target_component = _target_component;
-					memcpy(msg.data, _ulog_data.data, sizeof(msg.data));
-					mavlink_msg_logging_data_acked_send_struct(channel, &msg);
-				}
-			}
+		if (timed_out) {
+			unlock();
+			return -ETIMEDOUT;
 		}
 
-		if (!check_for_updates) {
-			return 0;
+		if (resend) {
+			PX4_DEBUG("re-sending ulog mavlink message (seq=%i)", resend->sequence);
+			send_acked(channel, *resend);
+			++_current_num_msgs;
 		}
 	}
 
-	bool updated = false;
-	int ret = orb_check(_ulog_stream_sub, &updated);
+	// The receiver drops messages older than the newest one it got, so nothing is sent while an acked
+	// message is in flight. The logger keeps publishing into the queue meanwhile.
+	while (!_retransmit.in_flight() && _current_num_msgs < _max_num_messages) {
+		bool updated = false;
+
+		if (orb_check(_ulog_stream_sub, &updated) != 0 || !updated) {
+			break;
+		}
 
-	while (updated && !ret && _current_num_msgs < _max_num_messages) {
 		orb_copy(ORB_ID(ulog_stream), _ulog_stream_sub, &_ulog_data);
 
 		if (_ulog_data.timestamp > 0) {
 			if (_ulog_data.flags & ulog_stream_s::FLAGS_NEED_ACK) {
-				_sent_tries = 1;
-				_last_sent_time = hrt_absolute_time();
-				lock();
-				_wait_for_ack_sequence = _ulog_data.sequence;
-				_ack_received = false;
-				unlock();
-
-				mavlink_logging_data_acked_t msg;
-				msg.sequence = _ulog_data.sequence;
-				msg.length = _ulog_data.length;
-				msg.first_message_offset = _ulog_data.first_message_offset;
-				msg.target_system = _target_system;
-				msg.target_component = _target_component;
-				memcpy(msg.data, _ulog_data.data, sizeof(msg.data));
-				mavlink_msg_logging_data_acked_send_struct(channel, &msg);
+				_retransmit.sent(_ulog_data, now);
+				send_acked(channel, _ulog_data);
 
 			} else {
-				mavlink_logging_data_t msg;
-				msg.sequence = _ulog_data.sequence;
-				msg.length = _ulog_data.length;
-				msg.first_message_offset = _ulog_data.first_message_offset;
-				msg.target_system = _target_system;
-				msg.target_component = _target_component;
-				memcpy(msg.data, _ulog_data.data, sizeof(msg.data));
-				mavlink_msg_logging_data_send_struct(channel, &msg);
+				send_unacked(channel, _ulog_data);
 			}
 		}
 
 		++_current_num_msgs;
-		ret = orb_check(_ulog_stream_sub, &updated);
 	}
 
-	//need to update the rate?
-	hrt_abstime t = hrt_absolute_time();
+	unlock();
 
-	if (t > _next_rate_check) {
+	//need to update the rate?
+	if (now > _next_rate_check) {
 		if (_current_num_msgs < _max_num_messages) {
 			_current_rate_factor = _max_rate_factor * (float)_current_num_msgs / _max_num_messages;
 
@@ -198,7 +167,7 @@ int MavlinkULog::handle_update(mavlink_channel_t channel)
 		}
 
 		_current_num_msgs = 0;
-		_next_rate_check = t + _rate_calculation_delta_t * 1.e6f;
+		_next_rate_check = now + _rate_calculation_delta_t * 1.e6f;
 		PX4_DEBUG("current rate=%.3f (max=%i msgs in %.3fs)", (double)_current_rate_factor, _max_num_messages,
 			  (double)_rate_calculation_delta_t);
 	}
@@ -257,8 +226,7 @@ void MavlinkULog::handle_ack(mavlink_logging_ack_t ack)
 	lock();
 
 	if (_instance) { // make sure stop() was not called right before
-		if (_wait_for_ack_sequence == ack.sequence) {
-			_ack_received = true;
+		if (_retransmit.ack(ack.sequence, hrt_absolute_time())) {
 			publish_ack(ack.sequence);
 		}
 	}
@@ -266,6 +234,64 @@ void MavlinkULog::handle_ack(mavlink_logging_ack_t ack)
 	unlock();
 }
 
+float MavlinkULog::round_trip_time()
+{
+	lock();
+	const float rtt = _retransmit.srtt_us() * 1e-6f;
+	unlock();
+	return rtt;
+}
+
+uint32_t MavlinkULog::retransmissions()
+{
+	lock();
+	const uint32_t retransmissions = _retransmit.retransmissions();
+	unlock();
+	return retransmissions;
+}
+
+#ifdef MAVLINK_ULOG_UNIT_TEST
+void MavlinkULog::set_unittest_sender(SendMessageFunc_t send_func, void *user)
+{
+	_utSendMsgFunc = send_func;
+	_utSendMsgUser = user;
+}
+#endif
+
+void MavlinkULog::send_acked(mavlink_channel_t channel, const ulog_stream_s &data)
+{
+#ifdef MAVLINK_ULOG_UNIT_TEST
+	// Unit test hook is set, call that instead
+	_utSendMsgFunc(data, true, _utSendMsgUser);
+#else
+	mavlink_logging_data_acked_t msg;
+	msg.sequence = data.sequence;
+	msg.length = data.length;
+	msg.first_message_offset = data.first_message_offset;
+	msg.target_system = _target_system;
+	msg.target_component = _target_component;
+	memcpy(msg.data, data.data, sizeof(msg.data));
+	mavlink_msg_logging_data_acked_send_struct(channel, &msg);
+#endif
+}
+
+void MavlinkULog::send_unacked(mavlink_channel_t channel, const ulog_stream_s &data)
+{
+#ifdef MAVLINK_ULOG_UNIT_TEST
+	// Unit test hook is set, call that instead
+	_utSendMsgFunc(data, false, _utSendMsgUser);
+#else
+	mavlink_logging_data_t msg;
+	msg.sequence = data.sequence;
+	msg.length = data.length;
+	msg.first_message_offset = data.first_message_offset;
+	msg.target_system = _target_system;
+	msg.target_component = _target_component;
+	memcpy(msg.data, data.data, sizeof(msg.data));
+	mavlink_msg_logging_data_send_struct(channel, &msg);
+#endif
+}
+
 void MavlinkULog::publish_ack(uint16_t sequence)
 {
 	ulog_stream_ack_s ack;
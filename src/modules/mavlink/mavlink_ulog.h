@@ -50,10 +50,13 @@
 #include <uORB/topics/ulog_stream_ack.h>
 
 #include "mavlink_bridge_header.h"
+#include "mavlink_ulog_retransmit.h"
 
 /**
  * @class MavlinkULog
  * ULog streaming class. At most one instance (stream) can exist, assigned to a specific mavlink channel.
+ * Messages are sent in order. Once a message that needs an ack is sent, nothing else is sent
+ * until it is acked (see MavlinkULogRetransmit).
  */
 class MavlinkULog
 {
@@ -96,6 +99,19 @@ public:
 	float current_data_rate() const { return _current_rate_factor; }
 	float maximum_data_rate() const { return _max_rate_factor; }
 
+	/** smoothed round-trip time of acked messages [s], thread-safe */
+	float round_trip_time();
+
+	/** number of retransmitted acked messages, thread-safe */
+	uint32_t retransmissions();
+
+#ifdef MAVLINK_ULOG_UNIT_TEST
+	typedef void (*SendMessageFunc_t)(const ulog_stream_s &msg, bool acked, void *user);
+
+	/** Sets up the send hook for unit testing, which replaces sending on a mavlink channel */
+	void set_unittest_sender(SendMessageFunc_t send_func, void *user);
+#endif
+
 	int get_ulog_stream_fd() const { return _ulog_stream_sub; }
 private:
 
@@ -115,6 +131,9 @@ private:
 
 	void publish_ack(uint16_t sequence);
 
+	void send_acked(mavlink_channel_t channel, const ulog_stream_s &data);
+	void send_unacked(mavlink_channel_t channel, const ulog_stream_s &data);
+
 	static px4_sem_t _lock;
 	static bool _init;
 	static MavlinkULog *_instance;
@@ -122,10 +141,7 @@ private:
 
 	int _ulog_stream_sub = -1;
 	orb_advert_t _ulog_stream_ack_pub = nullptr;
-	uint16_t _wait_for_ack_sequence;
-	uint8_t _sent_tries = 0;
-	volatile bool _ack_received = false; ///< set to true if a matching ack received
-	hrt_abstime _last_sent_time = 0; ///< last time we sent a message that requires an ack
+	hrt_abstime _last_sent_time = 0; ///< used during initialization to time out waiting for the logger
 	ulog_stream_s _ulog_data;
 	bool _waiting_for_initial_ack = false;
 	const uint8_t _target_system;
@@ -137,6 +153,13 @@ private:
 	int _current_num_msgs = 0;  ///< number of messages sent within the current time interval
 	hrt_abstime _next_rate_check; ///< next timestamp at which to update the rate
 
+	MavlinkULogRetransmit _retransmit; ///< acked message in flight, protected by _lock
+
+#ifdef MAVLINK_ULOG_UNIT_TEST
+	SendMessageFunc_t _utSendMsgFunc = nullptr;
+	void *_utSendMsgUser = nullptr;
+#endif
+
 	/* do not allow copying this class */
 	MavlinkULog(const MavlinkULog &) = delete;
 	MavlinkULog operator=(const MavlinkULog &) = delete;
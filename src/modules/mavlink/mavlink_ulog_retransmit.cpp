@@ -0,0 +1,116 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2018 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+/**
+ * @file mavlink_ulog_retransmit.cpp
+ * Retransmission of acked ULog messages with a round-trip time based timeout
+ */
+
+#include "mavlink_ulog_retransmit.h"
+
+#include <mathlib/mathlib.h>
+
+constexpr uint32_t MavlinkULogRetransmit::MIN_RTO_US;
+constexpr uint32_t MavlinkULogRetransmit::MAX_RTO_US;
+
+void MavlinkULogRetransmit::reset()
+{
+	_in_flight = false;
+	_retransmitted = false;
+	_have_rtt = false;
+	_srtt_us = 0.f;
+	_rttvar_us = 0.f;
+	_rto_us = ulog_stream_ack_s::ACK_TIMEOUT * 1000;
+	_retransmissions = 0;
+}
+
+void MavlinkULogRetransmit::sent(const ulog_stream_s &msg, hrt_abstime now)
+{
+	_msg = msg;
+	_first_sent_time = now;
+	_sent_time = now;
+	_retransmitted = false;
+	_in_flight = true;
+}
+
+bool MavlinkULogRetransmit::ack(uint16_t sequence, hrt_abstime now)
+{
+	if (!_in_flight || sequence != _msg.sequence) {
+		return false;
+	}
+
+	// Karn: only use samples of messages that were not retransmitted
+	if (!_retransmitted) {
+		update_rtt((float)(now - _sent_time));
+	}
+
+	_in_flight = false;
+	return true;
+}
+
+const ulog_stream_s *MavlinkULogRetransmit::next_retransmission(hrt_abstime now, bool &timed_out)
+{
+	timed_out = false;
+
+	if (!_in_flight || now - _sent_time < _rto_us) {
+		return nullptr;
+	}
+
+	if (now - _first_sent_time >= (hrt_abstime)ulog_stream_ack_s::ACK_TIMEOUT * ulog_stream_ack_s::ACK_MAX_TRIES * 1000) {
+		timed_out = true;
+		return nullptr;
+	}
+
+	// back off until a new clean rtt sample is available
+	_rto_us = math::min(_rto_us * 2, MAX_RTO_US);
+	_sent_time = now;
+	_retransmitted = true;
+	++_retransmissions;
+	return &_msg;
+}
+
+void MavlinkULogRetransmit::update_rtt(float rtt_us)
+{
+	if (!_have_rtt) {
+		_srtt_us = rtt_us;
+		_rttvar_us = rtt_us / 2.f;
+		_have_rtt = true;
+
+	} else {
+		_rttvar_us = 0.75f * _rttvar_us + 0.25f * fabsf(_srtt_us - rtt_us);
+		_srtt_us = 0.875f * _srtt_us + 0.125f * rtt_us;
+	}
+
+	_rto_us = math::constrain((uint32_t)(_srtt_us + 4.f * _rttvar_us), MIN_RTO_US, MAX_RTO_US);
+}
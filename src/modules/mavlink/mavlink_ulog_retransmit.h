@@ -0,0 +1,117 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2018 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+/**
+ * @file mavlink_ulog_retransmit.h
+ * Retransmission of acked ULog messages with a round-trip time based timeout
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <drivers/drv_hrt.h>
+
+#include <uORB/topics/ulog_stream.h>
+#include <uORB/topics/ulog_stream_ack.h>
+
+/**
+ * @class MavlinkULogRetransmit
+ * Keeps track of the acked ulog_stream message that is in flight.
+ *
+ * The receiver only keeps messages that are newer than the last one it got, and
+ * counts everything in between as dropped. So an acked message must be acked
+ * before any later message is sent, and at most one message is in flight.
+ *
+ * The retransmission timeout follows the measured round-trip time (RFC 6298
+ * smoothing, Karn's rule) instead of a fixed ACK_TIMEOUT, so a lost message is
+ * resent sooner on a fast link, and a slow link is not flooded with duplicates.
+ *
+ * The class does no I/O and takes the time as argument, so it can be used
+ * in a simulation with injected latency and loss.
+ */
+class MavlinkULogRetransmit
+{
+public:
+	MavlinkULogRetransmit() = default;
+
+	void reset();
+
+	/** @return true if an acked message is waiting for its ack */
+	bool in_flight() const { return _in_flight; }
+
+	/**
+	 * Track a new message that was just sent for the first time.
+	 * Must only be called if in_flight() returns false.
+	 */
+	void sent(const ulog_stream_s &msg, hrt_abstime now);
+
+	/**
+	 * Handle an ack.
+	 * @param sequence acked sequence number
+	 * @return true if it acks the message in flight, which is then no longer in flight
+	 */
+	bool ack(uint16_t sequence, hrt_abstime now);
+
+	/**
+	 * Get the message in flight if its retransmission timeout expired.
+	 * Its send time is updated, the caller is expected to send it.
+	 * @param timed_out set to true if the message was not acked within ACK_TIMEOUT * ACK_MAX_TRIES,
+	 *                  the time the logger waits for an ack
+	 * @return message or nullptr if nothing needs to be resent
+	 */
+	const ulog_stream_s *next_retransmission(hrt_abstime now, bool &timed_out);
+
+	uint32_t rto_us() const { return _rto_us; }
+	float srtt_us() const { return _srtt_us; }
+	uint32_t retransmissions() const { return _retransmissions; }
+
+private:
+	void update_rtt(float rtt_us);
+
+	static constexpr uint32_t MIN_RTO_US = 10000;
+	static constexpr uint32_t MAX_RTO_US = 1000000;
+
+	ulog_stream_s _msg{};
+	hrt_abstime _first_sent_time{0};
+	hrt_abstime _sent_time{0};
+	bool _retransmitted{false};
+	bool _in_flight{false};
+
+	bool _have_rtt{false};
+	float _srtt_us{0.f};
+	float _rttvar_us{0.f};
+	uint32_t _rto_us{ulog_stream_ack_s::ACK_TIMEOUT * 1000};
+
+	uint32_t _retransmissions{0};
+};
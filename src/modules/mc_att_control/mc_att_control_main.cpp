@@ -775,7 +775,9 @@ MulticopterAttitudeControl::publish_actuator_controls()
 	_actuators.control[3] = (PX4_ISFINITE(_thrust_sp)) ? _thrust_sp : 0.0f;
 	_actuators.control[7] = (float)_landing_gear.landing_gear;
 	_actuators.timestamp = hrt_absolute_time();
+	/* the rate loop runs on the gyro sample, there is no estimator stage: the controller stage is gyro to controls */
 	_actuators.timestamp_sample = _sensor_gyro.timestamp;
+	_actuators.estimator_latency = 0;
 
 	/* scale effort by battery status */
 	if (_bat_scale_en.get() && _battery_status.scale > 0.0f) {
@@ -1006,7 +1008,7 @@ int MulticopterAttitudeControl::task_spawn(int argc, char *argv[])
 	_task_id = px4_task_spawn_cmd("mc_att_control",
 					   SCHED_DEFAULT,
 					   SCHED_PRIORITY_ATTITUDE_CONTROL,
-					   1700,
+					   1700 + ACTUATOR_CONTROLS_CALLBACK_ADDED_STACK,
 					   (px4_main_t)&run_trampoline,
 					   (char *const *)argv);
 
@@ -34,6 +34,7 @@
 #include "px4muorb.hpp"
 #include "uORBFastRpcChannel.hpp"
 #include "uORBManager.hpp"
+#include "uORBBatchedChannel.hpp"
 
 #include <px4_middleware.h>
 #include <px4_tasks.h>
@@ -56,9 +57,11 @@ int px4muorb_orb_initialize()
 
 	// The uORB Manager needs to be initialized first up, otherwise the instance is nullptr.
 	uORB::Manager::initialize();
-	// Register the fastrpc muorb with uORBManager.
-	uORB::Manager::get_instance()->set_uorb_communicator(
-		uORB::FastRpcChannel::GetInstance());
+	// Register the fastrpc muorb with uORBManager. The batching layer passes
+	// publications through until the apps side sends batches ('muorb start -b').
+	static uORB::BatchedChannel batched_channel(uORB::FastRpcChannel::GetInstance());
+	batched_channel.set_auto_start(true);
+	uORB::Manager::get_instance()->set_uorb_communicator(&batched_channel);
 
 	// Now continue with the usual dspal startup.
 	const char *argv[] = { "dspal", "start" };
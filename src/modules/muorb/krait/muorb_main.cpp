@@ -31,15 +31,21 @@
  *
  ****************************************************************************/
 
+#include <stdlib.h>
 #include <string.h>
+#include <px4_getopt.h>
 #include "modules/uORB/uORBManager.hpp"
+#include "modules/uORB/uORBBatchedChannel.hpp"
 #include "uORBKraitFastRpcChannel.hpp"
 
 extern "C" { __EXPORT int muorb_main(int argc, char *argv[]); }
 
+/* wraps the fast rpc channel; only batches after 'start -b', or once the DSP sends batches */
+static uORB::BatchedChannel *g_batched_channel = nullptr;
+
 static void usage()
 {
-	warnx("Usage: muorb 'start', 'stop', 'status'");
+	warnx("Usage: muorb 'start [-b <flush interval us>]', 'stop', 'status'");
 }
 
 
@@ -61,8 +67,43 @@ muorb_main(int argc, char *argv[])
 			PX4_WARN("muorb already running");
 
 		} else {
-			// register the fast rpc channel with UORB.
-			uORB::Manager::get_instance()->set_uorb_communicator(uORB::KraitFastRpcChannel::GetInstance());
+			uint32_t flush_interval_us = 0;
+			int myoptind = 1;
+			const char *myoptarg = nullptr;
+			int ch;
+
+			while ((ch = px4_getopt(argc, argv, "b:", &myoptind, &myoptarg)) != EOF) {
+				switch (ch) {
+				case 'b':
+					flush_interval_us = strtoul(myoptarg, nullptr, 10);
+					break;
+
+				default:
+					usage();
+					return -EINVAL;
+				}
+			}
+
+			// register the fast rpc channel with UORB, through the batching layer. The uORB
+			// manager keeps a pointer to it, so it is never deleted, but reused on restart.
+			if (g_batched_channel == nullptr) {
+				g_batched_channel = new uORB::BatchedChannel(uORB::KraitFastRpcChannel::GetInstance(),
+						flush_interval_us > 0 ? flush_interval_us : 2000);
+
+				if (g_batched_channel == nullptr) {
+					return -ENOMEM;
+				}
+
+			} else {
+				g_batched_channel->set_flush_interval(flush_interval_us > 0 ? flush_interval_us : 2000);
+			}
+
+			g_batched_channel->set_auto_start(true);
+			uORB::Manager::get_instance()->set_uorb_communicator(g_batched_channel);
+
+			if (flush_interval_us > 0 && g_batched_channel->start() != 0) {
+				PX4_ERR("failed to start batching");
+			}
 
 			// start the KaitFastRPC channel thread.
 			uORB::KraitFastRpcChannel::GetInstance()->Start();
@@ -75,6 +116,10 @@ muorb_main(int argc, char *argv[])
 	if (!strcmp(argv[1], "stop")) {
 
 		if (uORB::KraitFastRpcChannel::isInstance()) {
+			if (g_batched_channel) {
+				g_batched_channel->stop();
+			}
+
 			uORB::KraitFastRpcChannel::GetInstance()->Stop();
 
 		} else {
@@ -91,6 +136,10 @@ muorb_main(int argc, char *argv[])
 		if (uORB::KraitFastRpcChannel::isInstance()) {
 			PX4_WARN("muorb running");
 
+			if (g_batched_channel) {
+				g_batched_channel->print_status();
+			}
+
 		} else {
 			PX4_WARN("muorb not running");
 		}
@@ -452,6 +452,9 @@ Mission::update_offboard_mission()
 
 	struct mission_s old_offboard_mission = _offboard_mission;
 
+	/* the items in dataman may have changed even if the mission id did not */
+	_item_cache.invalidate();
+
 	if (orb_copy(ORB_ID(mission), _navigator->get_offboard_mission_sub(), &_offboard_mission) == OK) {
 		/* determine current index */
 		if (_offboard_mission.current_seq >= 0 && _offboard_mission.current_seq < (int)_offboard_mission.count) {
@@ -537,9 +540,8 @@ Mission::advance_mission()
 
 				for (int32_t i = _current_offboard_mission_index - 1; i >= 0; i--) {
 					struct mission_item_s missionitem = {};
-					const ssize_t len = sizeof(missionitem);
 
-					if (dm_read(dm_current, i, &missionitem, len) != len) {
+					if (!_item_cache.read(dm_current, i, missionitem)) {
 						/* not supposed to happen unless the datamanager can't access the SD card, etc. */
 						PX4_ERR("dataman read failure");
 						break;
@@ -1457,8 +1459,8 @@ Mission::read_mission_item(int offset, struct mission_item_s *mission_item)
 		/* read mission item to temp storage first to not overwrite current mission item if data damaged */
 		struct mission_item_s mission_item_tmp;
 
-		/* read mission item from datamanager */
-		if (dm_read(dm_item, *mission_index_ptr, &mission_item_tmp, len) != len) {
+		/* read mission item from the cache, which falls back to the datamanager */
+		if (!_item_cache.read(dm_item, *mission_index_ptr, mission_item_tmp)) {
 			/* not supposed to happen unless the datamanager can't access the SD card, etc. */
 			mavlink_log_critical(_navigator->get_mavlink_log_pub(), "Waypoint could not be read.");
 			return false;
@@ -1483,6 +1485,8 @@ Mission::read_mission_item(int offset, struct mission_item_s *mission_item)
 						return false;
 					}
 
+					_item_cache.update(dm_item, *mission_index_ptr, mission_item_tmp);
+
 					report_do_jump_mission_changed(*mission_index_ptr, mission_item_tmp.do_jump_repeat_count);
 				}
 
@@ -1516,6 +1520,19 @@ Mission::read_mission_item(int offset, struct mission_item_s *mission_item)
 	return false;
 }
 
+void
+Mission::prefetch_mission_items()
+{
+	if (_offboard_mission.count == 0 || _current_offboard_mission_index < 0) {
+		return;
+	}
+
+	const int direction = (_mission_execution_mode == mission_result_s::MISSION_EXECUTION_MODE_REVERSE) ? -1 : 1;
+
+	_item_cache.prefetch((dm_item_t)_offboard_mission.dataman_id, _current_offboard_mission_index,
+			     _offboard_mission.count, direction);
+}
+
 void
 Mission::save_offboard_mission_state()
 {
@@ -1626,6 +1643,9 @@ Mission::check_mission_valid(bool force)
 void
 Mission::reset_offboard_mission(struct mission_s &mission)
 {
+	/* the jump counters get reset below */
+	_item_cache.invalidate();
+
 	dm_lock(DM_KEY_MISSION_STATE);
 
 	if (dm_read(DM_KEY_MISSION_STATE, 0, &mission, sizeof(mission_s)) == sizeof(mission_s)) {
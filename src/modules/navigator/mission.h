@@ -46,6 +46,7 @@
 
 #include "mission_block.h"
 #include "mission_feasibility_checker.h"
+#include "mission_item_cache.h"
 #include "navigator_mode.h"
 
 #include <cfloat>
@@ -107,6 +108,11 @@ public:
 	 * For a list of the different modes refer to mission_result.msg
 	 */
 	void set_execution_mode(const uint8_t mode);
+
+	/**
+	 * Load the upcoming mission items into the cache, call after the setpoints are published
+	 */
+	void prefetch_mission_items();
 private:
 
 	/**
@@ -185,7 +191,7 @@ private:
 
 	/**
 	 * Read current (offset == 0) or a specific (offset > 0) mission item
-	 * from the dataman and watch out for DO_JUMPS
+	 * from the item cache (or the dataman) and watch out for DO_JUMPS
 	 *
 	 * @return true if successful
 	 */
@@ -254,6 +260,8 @@ private:
 
 	int32_t _current_offboard_mission_index{-1};
 
+	MissionItemCache _item_cache;	/**< decoded mission items from the current index on */
+
 	// track location of planned mission landing
 	bool	_land_start_available{false};
 	uint16_t _land_start_index{UINT16_MAX};		/**< index of DO_LAND_START, INVALID_DO_LAND_START if no planned landing */
@@ -0,0 +1,132 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2018 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file mission_item_cache.cpp
+ */
+
+#include "mission_item_cache.h"
+
+#include <string.h>
+
+MissionItemCache::MissionItemCache() :
+	_miss_perf(perf_alloc(PC_COUNT, "navigator mission item cache miss"))
+{
+}
+
+MissionItemCache::~MissionItemCache()
+{
+	perf_free(_miss_perf);
+}
+
+void
+MissionItemCache::invalidate()
+{
+	for (int i = 0; i < CACHE_SIZE; i++) {
+		_entries[i].index = -1;
+	}
+
+	_dm_item = -1;
+}
+
+bool
+MissionItemCache::read(dm_item_t dm_item, int index, mission_item_s &item)
+{
+	if (index < 0) {
+		return false;
+	}
+
+	if (_dm_item != (int)dm_item) {
+		invalidate();
+		_dm_item = dm_item;
+	}
+
+	/* direct mapped, a window of consecutive items never collides */
+	Entry &entry = _entries[index % CACHE_SIZE];
+
+	if (entry.index != index) {
+		perf_count(_miss_perf);
+
+		const ssize_t len = sizeof(mission_item_s);
+
+		if (dm_read(dm_item, index, &entry.item, len) != len) {
+			entry.index = -1;
+			return false;
+		}
+
+		entry.index = index;
+	}
+
+	memcpy(&item, &entry.item, sizeof(mission_item_s));
+	return true;
+}
+
+void
+MissionItemCache::update(dm_item_t dm_item, int index, const mission_item_s &item)
+{
+	Entry &entry = _entries[index % CACHE_SIZE];
+
+	if (_dm_item == (int)dm_item && entry.index == index) {
+		memcpy(&entry.item, &item, sizeof(mission_item_s));
+	}
+}
+
+void
+MissionItemCache::prefetch(dm_item_t dm_item, int index, int count, int direction)
+{
+	if (_dm_item != (int)dm_item) {
+		invalidate();
+		_dm_item = dm_item;
+	}
+
+	for (int i = 0; i < CACHE_SIZE; i++) {
+		const int item_index = index + i * direction;
+
+		if (item_index < 0 || item_index >= count) {
+			break;
+		}
+
+		Entry &entry = _entries[item_index % CACHE_SIZE];
+
+		if (entry.index != item_index) {
+			const ssize_t len = sizeof(mission_item_s);
+
+			if (dm_read(dm_item, item_index, &entry.item, len) != len) {
+				entry.index = -1;
+				break;
+			}
+
+			entry.index = item_index;
+		}
+	}
+}
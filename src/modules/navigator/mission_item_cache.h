@@ -0,0 +1,92 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2018 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file mission_item_cache.h
+ *
+ * Cache of decoded mission items around the current mission index,
+ * so mission item transitions do not have to wait for dataman.
+ */
+
+#pragma once
+
+#include "navigation.h"
+
+#include <dataman/dataman.h>
+#include <perf/perf_counter.h>
+
+class MissionItemCache
+{
+public:
+	static constexpr int CACHE_SIZE = 8;	/**< number of cached items, a window ahead of the current item */
+
+	MissionItemCache();
+	~MissionItemCache();
+
+	MissionItemCache(const MissionItemCache &) = delete;
+	MissionItemCache &operator=(const MissionItemCache &) = delete;
+
+	/**
+	 * Drop all cached items, needs to be called whenever the mission in dataman changes
+	 */
+	void invalidate();
+
+	/**
+	 * Read a mission item from the cache, falls back to dataman on a miss
+	 *
+	 * @return true if successful
+	 */
+	bool read(dm_item_t dm_item, int index, mission_item_s &item);
+
+	/**
+	 * Update a cached item after it was written to dataman
+	 */
+	void update(dm_item_t dm_item, int index, const mission_item_s &item);
+
+	/**
+	 * Load the window of CACHE_SIZE items starting at index in the given direction (1 or -1)
+	 * from dataman. Items which are already cached are not read again.
+	 */
+	void prefetch(dm_item_t dm_item, int index, int count, int direction);
+
+private:
+	struct Entry {
+		mission_item_s item;
+		int index{-1};
+	};
+
+	Entry _entries[CACHE_SIZE] {};
+	int _dm_item{-1};
+
+	perf_counter_t _miss_perf;
+};
@@ -212,12 +212,18 @@ Navigator::run()
 	params_update();
 
 	/* wakeup source(s) */
-	px4_pollfd_struct_t fds[1] = {};
+	px4_pollfd_struct_t fds[3] = {};
 
 	/* Setup of loop */
 	fds[0].fd = _local_pos_sub;
 	fds[0].events = POLLIN;
 
+	/* react to mode changes and commands without waiting for the next position update */
+	fds[1].fd = _vstatus_sub;
+	fds[1].events = POLLIN;
+	fds[2].fd = _vehicle_command_sub;
+	fds[2].events = POLLIN;
+
 	/* rate-limit position subscription to 20 Hz / 50 ms */
 	orb_set_interval(_local_pos_sub, 50);
 
@@ -775,6 +781,10 @@ Navigator::run()
 			publish_mission_result();
 		}
 
+		/* read ahead the upcoming mission items while the setpoints are already out,
+		 * so the next mission item transition does not wait for dataman */
+		_mission.prefetch_mission_items();
+
 		perf_end(_loop_perf);
 	}
 
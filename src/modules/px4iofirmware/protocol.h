@@ -80,7 +80,7 @@
 
 #define REG_TO_BOOL(_reg) 	((bool)(_reg))
 
-#define PX4IO_PROTOCOL_VERSION		4
+#define PX4IO_PROTOCOL_VERSION		5
 
 /* maximum allowable sizes on this protocol version */
 #define PX4IO_PROTOCOL_MAX_CONTROL_COUNT	8	/**< The protocol does not support more than set here, individual units might support less - see PX4IO_P_CONFIG_CONTROL_COUNT */
@@ -283,6 +283,22 @@ enum {							/* DSM bind states */
 #define PX4IO_PAGE_SENSORS			56		/**< Sensors connected to PX4IO */
 #define PX4IO_P_SENSORS_ALTITUDE		0		/**< Altitude of an external sensor (HoTT or S.BUS2) */
 
+/*
+ * Combined per cycle transaction (serial only): a write to this page sets the group 0
+ * controls (may be empty), the offset is the number of registers requested back.
+ * The reply carries a snapshot of the registers below, the raw R/C input page is
+ * truncated to the requested size.
+ */
+#define PX4IO_PAGE_EXCHANGE			57
+#define PX4IO_P_EXCHANGE_STATUS_FLAGS		0	/**< PX4IO_P_STATUS_FLAGS */
+#define PX4IO_P_EXCHANGE_STATUS_ALARMS		1	/**< PX4IO_P_STATUS_ALARMS */
+#define PX4IO_P_EXCHANGE_STATUS_VSERVO		2	/**< PX4IO_P_STATUS_VSERVO */
+#define PX4IO_P_EXCHANGE_STATUS_VRSSI		3	/**< PX4IO_P_STATUS_VRSSI */
+#define PX4IO_P_EXCHANGE_STATUS_MIXER		4	/**< PX4IO_P_STATUS_MIXER */
+#define PX4IO_P_EXCHANGE_SERVOS			5	/**< PX4IO_PAGE_SERVOS, PX4IO_P_EXCHANGE_SERVO_COUNT outputs */
+#define PX4IO_P_EXCHANGE_SERVO_COUNT		8
+#define PX4IO_P_EXCHANGE_RAW_RC			(PX4IO_P_EXCHANGE_SERVOS + PX4IO_P_EXCHANGE_SERVO_COUNT)	/**< PX4IO_PAGE_RAW_RC_INPUT from PX4IO_P_RAW_RC_COUNT on */
+
 /* Debug and test page - not used in normal operation */
 #define PX4IO_PAGE_TEST				127
 #define PX4IO_P_TEST_LED			0		/**< set the amber LED on/off */
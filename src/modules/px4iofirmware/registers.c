@@ -832,6 +832,52 @@ registers_set_one(uint8_t page, uint8_t offset, uint16_t value)
 	return 0;
 }
 
+/**
+ * Handle a PX4IO_PAGE_EXCHANGE transaction: apply the group 0 controls in values,
+ * then overwrite values with the reply registers.
+ *
+ * @return number of reply registers, negative on error
+ */
+int
+registers_exchange(uint8_t reply_count, uint16_t *values, unsigned num_values)
+{
+	if (reply_count < PX4IO_P_EXCHANGE_RAW_RC + PX4IO_P_RAW_RC_BASE) {
+		return -1;
+	}
+
+	if (reply_count > PKT_MAX_REGS) {
+		reply_count = PKT_MAX_REGS;
+	}
+
+	/* an empty write only reads back, it must not refresh the FMU timeout */
+	if (num_values > 0) {
+		registers_set(PX4IO_PAGE_CONTROLS, PX4IO_P_CONTROLS_GROUP_0, values, num_values);
+	}
+
+	/* the status page has registers sampled at read time */
+	uint16_t *status;
+	unsigned status_count;
+	registers_get(PX4IO_PAGE_STATUS, 0, &status, &status_count);
+
+	values[PX4IO_P_EXCHANGE_STATUS_FLAGS] = status[PX4IO_P_STATUS_FLAGS];
+	values[PX4IO_P_EXCHANGE_STATUS_ALARMS] = status[PX4IO_P_STATUS_ALARMS];
+	values[PX4IO_P_EXCHANGE_STATUS_VSERVO] = status[PX4IO_P_STATUS_VSERVO];
+	values[PX4IO_P_EXCHANGE_STATUS_VRSSI] = status[PX4IO_P_STATUS_VRSSI];
+	values[PX4IO_P_EXCHANGE_STATUS_MIXER] = status[PX4IO_P_STATUS_MIXER];
+
+	memcpy(&values[PX4IO_P_EXCHANGE_SERVOS], r_page_servos, PX4IO_P_EXCHANGE_SERVO_COUNT * sizeof(uint16_t));
+
+	unsigned rc_count = reply_count - PX4IO_P_EXCHANGE_RAW_RC;
+
+	if (rc_count > sizeof(r_page_raw_rc_input) / sizeof(r_page_raw_rc_input[0])) {
+		rc_count = sizeof(r_page_raw_rc_input) / sizeof(r_page_raw_rc_input[0]);
+	}
+
+	memcpy(&values[PX4IO_P_EXCHANGE_RAW_RC], r_page_raw_rc_input, rc_count * sizeof(uint16_t));
+
+	return PX4IO_P_EXCHANGE_RAW_RC + rc_count;
+}
+
 uint8_t last_page;
 uint8_t last_offset;
 
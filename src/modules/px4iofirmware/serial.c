@@ -170,6 +170,22 @@ rx_handle_packet(void)
 		return;
 	}
 
+	if (PKT_CODE(dma_packet) == PKT_CODE_WRITE && dma_packet.page == PX4IO_PAGE_EXCHANGE) {
+
+		/* combined control write and status read back */
+		int count = registers_exchange(dma_packet.offset, &dma_packet.regs[0], PKT_COUNT(dma_packet));
+
+		if (count < 0) {
+			perf_count(pc_regerr);
+			dma_packet.count_code = PKT_CODE_ERROR;
+
+		} else {
+			dma_packet.count_code = count | PKT_CODE_SUCCESS;
+		}
+
+		return;
+	}
+
 	if (PKT_CODE(dma_packet) == PKT_CODE_WRITE) {
 
 		/* it's a blind write - pass it on */
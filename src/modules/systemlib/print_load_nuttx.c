@@ -78,6 +78,10 @@ void init_print_load_s(uint64_t t, struct print_load_s *s)
 	s->interval_time_ms_inv = 0.f;
 }
 
+void deinit_print_load_s(struct print_load_s *s)
+{
+}
+
 static const char *
 tstate_name(const tstate_t s)
 {
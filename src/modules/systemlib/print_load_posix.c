@@ -41,10 +41,12 @@
 
 #include <px4_posix.h>
 
+#include <errno.h>
 #include <unistd.h>
 #include <string.h>
 #include <stdio.h>
 #include <stdbool.h>
+#include <stdlib.h>
 
 #include <systemlib/cpuload.h>
 #include <systemlib/printload.h>
@@ -79,8 +81,193 @@ void init_print_load_s(uint64_t t, struct print_load_s *s)
 	}
 
 	s->interval_time_ms_inv = 0.f;
+
+#if defined(__PX4_LINUX)
+
+	for (int i = 0; i < 2; i++) {
+		s->threads[i] = NULL;
+		s->thread_capacity[i] = 0;
+		s->thread_count[i] = 0;
+	}
+
+	s->current_sample = 0;
+#endif
+}
+
+void deinit_print_load_s(struct print_load_s *s)
+{
+#if defined(__PX4_LINUX)
+
+	for (int i = 0; i < 2; i++) {
+		free(s->threads[i]);
+		s->threads[i] = NULL;
+		s->thread_capacity[i] = 0;
+		s->thread_count[i] = 0;
+	}
+
+#endif
+}
+
+#if defined(__PX4_LINUX)
+
+struct thread_load_s {
+	int index;		///< index into the latest sample
+	uint64_t run_time;	///< [us] run time within the interval
+	float load;		///< fraction of one CPU
+	float wakeups;		///< [1/s]
+	float preemptions;	///< [1/s]
+	float latency;		///< [us] mean time from ready to running, <0 if unknown
+};
+
+static const px4_task_stats_t empty_stats;
+
+static int thread_load_compare(const void *a, const void *b)
+{
+	const struct thread_load_s *load_a = (const struct thread_load_s *)a;
+	const struct thread_load_s *load_b = (const struct thread_load_s *)b;
+
+	if (load_a->run_time != load_b->run_time) {
+		return load_a->run_time < load_b->run_time ? 1 : -1;
+	}
+
+	return load_a->index - load_b->index;
 }
 
+/**
+ * Fill the statistics buffer of one sample with all threads, growing it if the process has more threads than fit.
+ * @return number of threads, <0 on error
+ */
+static int sample_threads(struct print_load_s *print_state, int sample)
+{
+	for (;;) {
+		int count = px4_task_get_stats(print_state->threads[sample], print_state->thread_capacity[sample]);
+
+		if (count <= print_state->thread_capacity[sample]) {
+			return count;
+		}
+
+		// leave some room for threads started until the next sample
+		const int capacity = count + 8;
+		px4_task_stats_t *threads = (px4_task_stats_t *)realloc(print_state->threads[sample], capacity * sizeof(px4_task_stats_t));
+
+		if (threads == NULL) {
+			return -ENOMEM;
+		}
+
+		print_state->threads[sample] = threads;
+		print_state->thread_capacity[sample] = capacity;
+	}
+}
+
+/**
+ * Take a new sample of the thread statistics and get the per-thread load since the previous one,
+ * sorted by CPU usage.
+ * @param loads set to the allocated per-thread loads, which the caller must free (only if the return value is >0)
+ * @return number of threads in loads, 0 if there is no previous sample yet, <0 on error
+ */
+static int update_thread_loads(uint64_t t, struct print_load_s *print_state, struct thread_load_s **loads_out)
+{
+	const int last = print_state->current_sample;
+	const int current = 1 - last;
+
+	int count = sample_threads(print_state, current);
+
+	if (count < 0) {
+		return count;
+	}
+
+	const px4_task_stats_t *last_threads = print_state->threads[last];
+	const px4_task_stats_t *threads = print_state->threads[current];
+
+	print_state->new_time = t;
+	print_state->thread_count[current] = count;
+	print_state->current_sample = current;
+
+	if (print_state->thread_count[last] == 0 || print_state->new_time <= print_state->interval_start_time) {
+		print_state->interval_start_time = print_state->new_time;
+		return 0;
+	}
+
+	struct thread_load_s *loads = (struct thread_load_s *)malloc(count * sizeof(struct thread_load_s));
+
+	if (loads == NULL) {
+		return -ENOMEM;
+	}
+
+	const float interval = (print_state->new_time - print_state->interval_start_time) * 1e-6f;
+	print_state->interval_time_ms_inv = 1.f / (interval * 1000.f);
+
+	print_state->running_count = 0;
+	print_state->blocked_count = 0;
+	print_state->total_user_time = 0;
+
+	for (int i = 0; i < count; i++) {
+		const px4_task_stats_t *thread = &threads[i];
+		const px4_task_stats_t *last_thread = NULL;
+
+		for (int j = 0; j < print_state->thread_count[last]; j++) {
+			if (last_threads[j].tid == thread->tid) {
+				last_thread = &last_threads[j];
+				break;
+			}
+		}
+
+		// a thread started within the interval accumulated all its statistics in it
+		if (last_thread == NULL) {
+			last_thread = &empty_stats;
+		}
+
+		const uint64_t wait_time = thread->wait_time - last_thread->wait_time;
+		const uint64_t timeslices = thread->timeslices - last_thread->timeslices;
+
+		loads[i].index = i;
+		loads[i].run_time = thread->run_time - last_thread->run_time;
+		loads[i].load = loads[i].run_time * 1e-6f / interval;
+		loads[i].wakeups = (thread->voluntary_switches - last_thread->voluntary_switches) / interval;
+		loads[i].preemptions = (thread->involuntary_switches - last_thread->involuntary_switches) / interval;
+		loads[i].latency = (thread->timeslices == 0) ? -1.f : ((timeslices > 0) ? (float)wait_time / timeslices : 0.f);
+
+		print_state->total_user_time += loads[i].run_time;
+
+		if (thread->state == 'R') {
+			print_state->running_count++;
+
+		} else {
+			print_state->blocked_count++;
+		}
+	}
+
+	qsort(loads, count, sizeof(loads[0]), thread_load_compare);
+
+	print_state->interval_start_time = print_state->new_time;
+	*loads_out = loads;
+
+	return count;
+}
+
+#endif /* __PX4_LINUX */
+
+#if defined(__PX4_LINUX)
+
+struct print_load_callback_data_s {
+	int fd;
+	char buffer[140];
+};
+
+static void print_load_callback(void *user)
+{
+	char *clear_line = "";
+	struct print_load_callback_data_s *data = (struct print_load_callback_data_s *)user;
+
+	if (data->fd == 1) {
+		clear_line = CL;
+	}
+
+	dprintf(data->fd, "%s%s\n", clear_line, data->buffer);
+}
+
+#endif /* __PX4_LINUX */
+
 void print_load(uint64_t t, int fd, struct print_load_s *print_state)
 {
 	char *clear_line = "";
@@ -91,8 +278,21 @@ void print_load(uint64_t t, int fd, struct print_load_s *print_state)
 		clear_line = CL;
 	}
 
-#if defined(__PX4_LINUX) || defined(__PX4_CYGWIN) || defined(__PX4_QURT)
-	dprintf(fd, "%sTOP NOT IMPLEMENTED ON LINUX, QURT, WINDOWS (ONLY ON NUTTX, APPLE)\n", clear_line);
+#if defined(__PX4_LINUX)
+	struct print_load_callback_data_s data;
+
+	data.fd = fd;
+
+	print_load_buffer(t, data.buffer, sizeof(data.buffer), print_load_callback, &data, print_state);
+
+	if (fd == 1) {
+		dprintf(fd, "\033[J"); /* clear the rest of the screen, the number of threads can change */
+	}
+
+	(void)clear_line;
+
+#elif defined(__PX4_CYGWIN) || defined(__PX4_QURT)
+	dprintf(fd, "%sTOP NOT IMPLEMENTED ON QURT, WINDOWS (ONLY ON NUTTX, LINUX, APPLE)\n", clear_line);
 
 #elif defined(__PX4_DARWIN)
 	pid_t pid = getpid();   //-- this is the process id you need info for
@@ -178,6 +378,120 @@ void print_load(uint64_t t, int fd, struct print_load_s *print_state)
 void print_load_buffer(uint64_t t, char *buffer, int buffer_length, print_load_callback_f cb, void *user,
 		       struct print_load_s *print_state)
 {
+#if defined(__PX4_LINUX)
+	struct thread_load_s *loads = NULL;
+
+	int count = update_thread_loads(t, print_state, &loads);
+
+	if (count <= 0) {
+		// first run, not enough data yet
+		return;
+	}
+
+	const px4_task_stats_t *threads = print_state->threads[print_state->current_sample];
+
+	/* header for thread list */
+	snprintf(buffer, buffer_length, "%6s %-15s %9s %6s %7s %9s %7s %4s %5s",
+		 "TID",
+		 "COMMAND",
+		 "CPU(ms)",
+		 "CPU(%)",
+		 "WAKE/s",
+		 "PREEMPT/s",
+		 "LAT(us)",
+		 "PRIO",
+		 "STATE");
+	cb(user);
+
+	for (int i = 0; i < count; i++) {
+		const px4_task_stats_t *thread = &threads[loads[i].index];
+		char latency[16];
+
+		if (loads[i].latency < 0.f) {
+			snprintf(latency, sizeof(latency), "-");
+
+		} else {
+			snprintf(latency, sizeof(latency), "%.1f", (double)loads[i].latency);
+		}
+
+		snprintf(buffer, buffer_length, "%6d %-15s %9llu %6.2f %7.1f %9.1f %7s %4d %5c",
+			 thread->tid,
+			 thread->name,
+			 (unsigned long long)(thread->run_time / 1000),
+			 (double)(loads[i].load * 100.f),
+			 (double)loads[i].wakeups,
+			 (double)loads[i].preemptions,
+			 latency,
+			 thread->priority,
+			 thread->state);
+		cb(user);
+	}
 
+	// Print footer
+	buffer[0] = 0;
+	cb(user);
+
+	snprintf(buffer, buffer_length, "Threads: %d total, %d running, %d sleeping",
+		 count,
+		 print_state->running_count,
+		 print_state->blocked_count);
+	cb(user);
+	snprintf(buffer, buffer_length, "CPU usage: %.2f%% (100%% per core)",
+		 (double)(print_state->total_user_time * print_state->interval_time_ms_inv * 0.1f));
+	cb(user);
+	snprintf(buffer, buffer_length, "Uptime: %.3fs total", (double)t / 1000000.0);
+	cb(user);
+
+	free(loads);
+#endif
+}
+
+int print_load_json(uint64_t t, int fd, struct print_load_s *print_state)
+{
+#if defined(__PX4_LINUX)
+	struct thread_load_s *loads = NULL;
+
+	int count = update_thread_loads(t, print_state, &loads);
+
+	if (count <= 0) {
+		return count;
+	}
+
+	const px4_task_stats_t *threads = print_state->threads[print_state->current_sample];
+
+	dprintf(fd, "{\"timestamp\": %llu, \"interval_us\": %u, \"threads\": [",
+		(unsigned long long)t, (unsigned)(1000.f / print_state->interval_time_ms_inv));
+
+	for (int i = 0; i < count; i++) {
+		const px4_task_stats_t *thread = &threads[loads[i].index];
+		char name[sizeof(thread->name)];
+
+		for (unsigned j = 0; j < sizeof(name); j++) {
+			name[j] = (thread->name[j] == '"' || thread->name[j] == '\\') ? '_' : thread->name[j];
+		}
+
+		dprintf(fd, "%s\n{\"tid\": %d, \"task\": %d, \"name\": \"%s\", \"state\": \"%c\", \"priority\": %d, "
+			"\"cpu_time_us\": %llu, \"cpu_percent\": %.2f, \"wakeups_per_s\": %.1f, \"preemptions_per_s\": %.1f, "
+			"\"sched_latency_us\": %.1f}",
+			i == 0 ? "" : ",",
+			thread->tid,
+			thread->task,
+			name,
+			thread->state,
+			thread->priority,
+			(unsigned long long)thread->run_time,
+			(double)(loads[i].load * 100.f),
+			(double)loads[i].wakeups,
+			(double)loads[i].preemptions,
+			(double)loads[i].latency);
+	}
+
+	dprintf(fd, "\n]}\n");
+
+	free(loads);
+	return 0;
+#else
+	return -ENOSYS;
+#endif
 }
 
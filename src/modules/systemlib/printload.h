@@ -45,6 +45,10 @@
 
 #include <stdint.h>
 
+#if defined(__PX4_LINUX)
+#include <px4_tasks.h>
+#endif
+
 #ifndef CONFIG_MAX_TASKS
 #define CONFIG_MAX_TASKS 64
 #endif
@@ -59,15 +63,35 @@ struct print_load_s {
 	uint64_t interval_start_time;
 	uint32_t last_times[CONFIG_MAX_TASKS]; // in [ms]. This wraps if a process needs more than 49 days of CPU
 	float interval_time_ms_inv;
+
+#if defined(__PX4_LINUX)
+	px4_task_stats_t *threads[2]; ///< thread statistics of the last two samples, grown to the number of threads
+	int thread_capacity[2];
+	int thread_count[2];
+	int current_sample; ///< index into threads of the latest sample
+#endif
 };
 
 __BEGIN_DECLS
 
 __EXPORT void init_print_load_s(uint64_t t, struct print_load_s *s);
 
+/**
+ * Release the memory held by s. Must be called before s goes out of scope or is initialized again.
+ */
+__EXPORT void deinit_print_load_s(struct print_load_s *s);
+
 __EXPORT void print_load(uint64_t t, int fd, struct print_load_s *print_state);
 
 
+/**
+ * Print the load of all tasks as a single JSON object, sorted by CPU usage.
+ * The first call only takes the initial sample and prints nothing.
+ * @return 0 on success, <0 on error (-ENOSYS if not supported on this platform)
+ */
+__EXPORT int print_load_json(uint64_t t, int fd, struct print_load_s *print_state);
+
+
 typedef void (*print_load_callback_f)(void *user);
 
 /**
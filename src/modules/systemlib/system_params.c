@@ -219,6 +219,20 @@ PARAM_DEFINE_INT32(SYS_CAL_BARO, 0);
  */
 PARAM_DEFINE_INT32(SYS_CAL_TDEL, 24);
 
+/**
+ * Temperature rise after which thermal calibration may end early
+ *
+ * Once the temperature increase above the starting temperature exceeds this value, calibration will complete for each sensor
+ * as soon as its fit predicts the newly reached temperatures as well as the colder ones, instead of waiting for SYS_CAL_TDEL.
+ * The calibrated temperature range is then limited to the range actually reached.
+ * Set to 0 to always wait for the full temperature rise.
+ *
+ * @unit deg C
+ * @min 0
+ * @group System
+ */
+PARAM_DEFINE_INT32(SYS_CAL_TEARLY, 0);
+
 /**
  * Minimum starting temperature for thermal calibration
  *
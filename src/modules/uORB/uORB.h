@@ -254,6 +254,12 @@ __END_DECLS
 
 /* Diverse uORB header defines */ //XXX: move to better location
 #define ORB_ID_VEHICLE_ATTITUDE_CONTROLS    ORB_ID(actuator_controls_0)
+/* stack publishers of actuator_controls_0/1 reserve for publication callbacks (uavcan ESC mixing and broadcast) */
+#ifdef BOARD_HAS_UAVCAN
+#define ACTUATOR_CONTROLS_CALLBACK_ADDED_STACK	1000
+#else
+#define ACTUATOR_CONTROLS_CALLBACK_ADDED_STACK	0
+#endif
 typedef uint8_t arming_state_t;
 typedef uint8_t main_state_t;
 typedef uint8_t hil_state_t;
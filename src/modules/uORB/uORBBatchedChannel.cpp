@@ -0,0 +1,539 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2018 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+#include "uORBBatchedChannel.hpp"
+#include "uORBTopics.h"
+
+#include <string.h>
+#include <px4_defines.h>
+#include <px4_log.h>
+#include <px4_posix.h>
+#include <px4_tasks.h>
+
+constexpr const char *uORB::BatchedChannel::BATCH_MESSAGE_NAME;
+
+uORB::BatchedChannel::BatchedChannel(uORBCommunicator::IChannel *transport, uint32_t flush_interval_us,
+				     uint16_t max_batch_size) :
+	_transport(transport),
+	_topics(orb_get_topics()),
+	_num_topics(orb_topics_count()),
+	_flush_interval_us(flush_interval_us),
+	_max_batch_size(max_batch_size)
+{
+	pthread_mutex_init(&_mutex, nullptr);
+	pthread_mutex_init(&_flush_mutex, nullptr);
+	pthread_mutex_init(&_control_mutex, nullptr);
+}
+
+uORB::BatchedChannel::~BatchedChannel()
+{
+	stop();
+
+	if (_slots) {
+		for (int i = 0; i < _num_topics; ++i) {
+			delete[] _slots[i].data;
+		}
+
+		delete[] _slots;
+	}
+
+	delete[] _id_table;
+	delete[] _batch_buffer;
+
+	pthread_mutex_destroy(&_mutex);
+	pthread_mutex_destroy(&_flush_mutex);
+	pthread_mutex_destroy(&_control_mutex);
+}
+
+int uORB::BatchedChannel::start()
+{
+	pthread_mutex_lock(&_control_mutex);
+	const int ret = start_locked();
+	pthread_mutex_unlock(&_control_mutex);
+	return ret;
+}
+
+int uORB::BatchedChannel::start_locked()
+{
+	if (_running) {
+		return 0;
+	}
+
+	if (_transport == nullptr) {
+		return -EINVAL;
+	}
+
+	if (_slots == nullptr) {
+		uint32_t table_size = 1;
+
+		while (table_size < 2u * _num_topics) {
+			table_size <<= 1;
+		}
+
+		_id_table = new int16_t[table_size];
+		_slots = new TopicSlot[_num_topics];
+
+		if (_id_table == nullptr || _slots == nullptr) {
+			return -ENOMEM;
+		}
+
+		_id_table_mask = table_size - 1;
+
+		for (uint32_t i = 0; i < table_size; ++i) {
+			_id_table[i] = -1;
+		}
+
+		uint16_t max_record = 0;
+
+		for (int i = 0; i < _num_topics; ++i) {
+			uint32_t h = (uint32_t)(((uintptr_t)_topics[i] >> 3) * 2654435761u) & _id_table_mask;
+
+			while (_id_table[h] != -1) {
+				h = (h + 1) & _id_table_mask;
+			}
+
+			_id_table[h] = i;
+
+			if (_topics[i]->o_size > max_record) {
+				max_record = _topics[i]->o_size;
+			}
+		}
+
+		/* every topic must fit into a batch on its own */
+		const uint32_t min_size = sizeof(BatchHeader) + sizeof(RecordHeader) + max_record;
+		_batch_buffer = new uint8_t[_max_batch_size > min_size ? _max_batch_size : min_size];
+
+		if (_batch_buffer == nullptr) {
+			return -ENOMEM;
+		}
+	}
+
+	_should_exit = false;
+
+	pthread_attr_t thr_attr;
+	pthread_attr_init(&thr_attr);
+
+	sched_param param;
+	(void)pthread_attr_getschedparam(&thr_attr, &param);
+	param.sched_priority = SCHED_PRIORITY_DEFAULT;
+	(void)pthread_attr_setschedparam(&thr_attr, &param);
+
+	pthread_attr_setstacksize(&thr_attr, PX4_STACK_ADJUSTED(1500));
+
+	int ret = pthread_create(&_thread, &thr_attr, &BatchedChannel::run_helper, this);
+	pthread_attr_destroy(&thr_attr);
+
+	if (ret != 0) {
+		PX4_ERR("failed to create sender thread (%i)", ret);
+		return -ret;
+	}
+
+	pthread_mutex_lock(&_mutex);
+	_running = true;
+	pthread_mutex_unlock(&_mutex);
+	return 0;
+}
+
+void uORB::BatchedChannel::stop()
+{
+	pthread_mutex_lock(&_control_mutex);
+	_auto_start = false;
+
+	if (_running) {
+		_should_exit = true;
+		pthread_join(_thread, nullptr);
+
+		/* publishers check _running under _mutex: once it is cleared they pass through, but
+		 * only after the samples still in the slots are sent */
+		pthread_mutex_lock(&_flush_mutex);
+		pthread_mutex_lock(&_mutex);
+		_running = false;
+		send_pending(true);
+		pthread_mutex_unlock(&_mutex);
+		pthread_mutex_unlock(&_flush_mutex);
+	}
+
+	pthread_mutex_unlock(&_control_mutex);
+}
+
+bool uORB::BatchedChannel::running()
+{
+	pthread_mutex_lock(&_mutex);
+	const bool running = _running;
+	pthread_mutex_unlock(&_mutex);
+	return running;
+}
+
+void uORB::BatchedChannel::set_auto_start(bool auto_start)
+{
+	pthread_mutex_lock(&_control_mutex);
+	_auto_start = auto_start;
+	pthread_mutex_unlock(&_control_mutex);
+}
+
+int uORB::BatchedChannel::set_flush_interval(uint32_t flush_interval_us)
+{
+	int ret = -EBUSY;
+	pthread_mutex_lock(&_control_mutex);
+
+	/* the sender thread reads the interval without locking */
+	if (!_running) {
+		_flush_interval_us = flush_interval_us;
+		ret = 0;
+	}
+
+	pthread_mutex_unlock(&_control_mutex);
+	return ret;
+}
+
+void *uORB::BatchedChannel::run_helper(void *context)
+{
+	px4_prctl(PR_SET_NAME, "orb_batch", px4_getpid());
+	static_cast<BatchedChannel *>(context)->run();
+	return nullptr;
+}
+
+void uORB::BatchedChannel::run()
+{
+	while (!_should_exit) {
+		const hrt_abstime start = hrt_absolute_time();
+
+		flush();
+
+		const hrt_abstime elapsed = hrt_elapsed_time(&start);
+
+		if (elapsed < _flush_interval_us) {
+			px4_usleep(_flush_interval_us - elapsed);
+		}
+	}
+}
+
+int uORB::BatchedChannel::topic_id(const struct orb_metadata *meta) const
+{
+	if (_id_table == nullptr || meta == nullptr) {
+		return -1;
+	}
+
+	uint32_t h = (uint32_t)(((uintptr_t)meta >> 3) * 2654435761u) & _id_table_mask;
+
+	while (_id_table[h] != -1) {
+		if (_topics[_id_table[h]] == meta) {
+			return _id_table[h];
+		}
+
+		h = (h + 1) & _id_table_mask;
+	}
+
+	return -1;
+}
+
+int uORB::BatchedChannel::topic_id(const char *name) const
+{
+	for (int i = 0; i < _num_topics; ++i) {
+		if (strcmp(_topics[i]->o_name, name) == 0) {
+			return i;
+		}
+	}
+
+	return -1;
+}
+
+int uORB::BatchedChannel::flush()
+{
+	if (_slots == nullptr) {
+		return 0;
+	}
+
+	/* the batch buffer is shared by all callers, but _mutex is released while
+	 * sending so that publishers are not blocked by the transport */
+	pthread_mutex_lock(&_flush_mutex);
+	pthread_mutex_lock(&_mutex);
+
+	const int num_sent = send_pending(false);
+
+	pthread_mutex_unlock(&_mutex);
+	pthread_mutex_unlock(&_flush_mutex);
+
+	return num_sent;
+}
+
+int uORB::BatchedChannel::send_pending(bool stopping)
+{
+	BatchHeader *header = (BatchHeader *)_batch_buffer;
+	header->magic = BATCH_MAGIC;
+	header->num_topics = _num_topics;
+	header->num_records = 0;
+
+	uint32_t offset = sizeof(BatchHeader);
+	int num_sent = 0;
+
+	const hrt_abstime now = hrt_absolute_time();
+
+	for (int i = 0; i < _num_topics; ++i) {
+		TopicSlot &slot = _slots[i];
+
+		if (!slot.pending || (!stopping && slot.min_interval_us > 0 && now - slot.last_sent < slot.min_interval_us)) {
+			continue;
+		}
+
+		const uint16_t size = _topics[i]->o_size;
+		const uint32_t record_size = sizeof(RecordHeader) + size;
+
+		if (offset + record_size > _max_batch_size && header->num_records > 0) {
+			/* send the full batch without blocking publishers */
+			if (!stopping) {
+				pthread_mutex_unlock(&_mutex);
+			}
+
+			_transport->send_message(BATCH_MESSAGE_NAME, offset, _batch_buffer);
+			++_sent_batches;
+
+			if (!stopping) {
+				pthread_mutex_lock(&_mutex);
+			}
+
+			header->num_records = 0;
+			offset = sizeof(BatchHeader);
+		}
+
+		RecordHeader record{(uint16_t)i, size};
+		memcpy(_batch_buffer + offset, &record, sizeof(record));
+		memcpy(_batch_buffer + offset + sizeof(record), slot.data, size);
+		offset += record_size;
+		++header->num_records;
+
+		slot.pending = false;
+		slot.last_sent = now;
+		++num_sent;
+	}
+
+	_sent_samples += num_sent;
+
+	if (header->num_records > 0) {
+		if (!stopping) {
+			pthread_mutex_unlock(&_mutex);
+		}
+
+		_transport->send_message(BATCH_MESSAGE_NAME, offset, _batch_buffer);
+		++_sent_batches;
+
+		if (!stopping) {
+			pthread_mutex_lock(&_mutex);
+		}
+	}
+
+	return num_sent;
+}
+
+int uORB::BatchedChannel::unpack_batch(const uint8_t *buffer, int32_t length)
+{
+	BatchHeader header;
+
+	if (length < (int32_t)sizeof(header)) {
+		return -1;
+	}
+
+	memcpy(&header, buffer, sizeof(header));
+
+	if (header.magic != BATCH_MAGIC || header.num_topics != _num_topics) {
+		PX4_ERR("batch from incompatible peer (%i topics, expected %i)", header.num_topics, _num_topics);
+		return -1;
+	}
+
+	int32_t offset = sizeof(header);
+
+	for (int i = 0; i < header.num_records; ++i) {
+		RecordHeader record;
+
+		if (offset + (int32_t)sizeof(record) > length) {
+			return -1;
+		}
+
+		memcpy(&record, buffer + offset, sizeof(record));
+		offset += sizeof(record);
+
+		if (record.topic_id >= _num_topics || offset + record.length > length
+		    || record.length != _topics[record.topic_id]->o_size) {
+			return -1;
+		}
+
+		if (_rx_handler) {
+			_rx_handler->process_received_topic(_topics[record.topic_id], record.length, (uint8_t *)buffer + offset);
+		}
+
+		offset += record.length;
+		++_received_samples;
+	}
+
+	return 0;
+}
+
+int16_t uORB::BatchedChannel::topic_advertised(const char *messageName)
+{
+	return _transport->topic_advertised(messageName);
+}
+
+int16_t uORB::BatchedChannel::add_subscription(const char *messageName, int32_t msgRateInHz)
+{
+	return _transport->add_subscription(messageName, msgRateInHz);
+}
+
+int16_t uORB::BatchedChannel::remove_subscription(const char *messageName)
+{
+	return _transport->remove_subscription(messageName);
+}
+
+int16_t uORB::BatchedChannel::register_handler(uORBCommunicator::IChannelRxHandler *handler)
+{
+	_rx_handler = handler;
+	return _transport->register_handler(this);
+}
+
+int16_t uORB::BatchedChannel::send_message(const char *messageName, int32_t length, uint8_t *data)
+{
+	const int id = topic_id(messageName);
+
+	if (id < 0) {
+		/* not a known topic: pass through unbatched */
+		return _transport->send_message(messageName, length, data);
+	}
+
+	return send_topic(_topics[id], length, data);
+}
+
+int16_t uORB::BatchedChannel::send_topic(const struct orb_metadata *meta, int32_t length, uint8_t *data)
+{
+	pthread_mutex_lock(&_mutex);
+
+	if (!_running) {
+		/* not batching: pass through unbatched. stop() holds _mutex until the slots are sent,
+		 * so this cannot overtake a batched sample */
+		pthread_mutex_unlock(&_mutex);
+		return _transport->send_message(meta->o_name, length, data);
+	}
+
+	const int id = topic_id(meta);
+
+	if (id < 0 || length != meta->o_size) {
+		pthread_mutex_unlock(&_mutex);
+		return -1;
+	}
+
+	TopicSlot &slot = _slots[id];
+
+	if (slot.data == nullptr) {
+		slot.data = new uint8_t[length];
+
+		if (slot.data == nullptr) {
+			pthread_mutex_unlock(&_mutex);
+			return -1;
+		}
+	}
+
+	if (slot.pending) {
+		++_superseded;
+	}
+
+	memcpy(slot.data, data, length);
+	slot.pending = true;
+	++_published;
+
+	pthread_mutex_unlock(&_mutex);
+
+	return 0;
+}
+
+int16_t uORB::BatchedChannel::process_remote_topic(const char *topic_name, bool isAdvertisement)
+{
+	return _rx_handler ? _rx_handler->process_remote_topic(topic_name, isAdvertisement) : -1;
+}
+
+int16_t uORB::BatchedChannel::process_add_subscription(const char *messageName, int32_t msgRateInHz)
+{
+	const int id = topic_id(messageName);
+
+	if (id >= 0 && _slots) {
+		pthread_mutex_lock(&_mutex);
+		_slots[id].min_interval_us = msgRateInHz > 0 ? 1000000 / msgRateInHz : 0;
+		pthread_mutex_unlock(&_mutex);
+	}
+
+	return _rx_handler ? _rx_handler->process_add_subscription(messageName, msgRateInHz) : -1;
+}
+
+int16_t uORB::BatchedChannel::process_remove_subscription(const char *messageName)
+{
+	const int id = topic_id(messageName);
+
+	if (id >= 0 && _slots) {
+		pthread_mutex_lock(&_mutex);
+		_slots[id].min_interval_us = 0;
+		_slots[id].pending = false;
+		pthread_mutex_unlock(&_mutex);
+	}
+
+	return _rx_handler ? _rx_handler->process_remove_subscription(messageName) : -1;
+}
+
+int16_t uORB::BatchedChannel::process_received_message(const char *messageName, int32_t length, uint8_t *data)
+{
+	if (strcmp(messageName, BATCH_MESSAGE_NAME) == 0) {
+		pthread_mutex_lock(&_control_mutex);
+
+		if (_auto_start && !running()) {
+			PX4_INFO("peer sends batches, batching enabled");
+			start_locked();
+		}
+
+		pthread_mutex_unlock(&_control_mutex);
+
+		if (unpack_batch(data, length) != 0) {
+			++_rx_errors;
+			return -1;
+		}
+
+		return 0;
+	}
+
+	return _rx_handler ? _rx_handler->process_received_message(messageName, length, data) : -1;
+}
+
+void uORB::BatchedChannel::print_status()
+{
+	PX4_INFO("batching: %s, flush interval: %u us, max batch size: %u bytes", running() ? "on" : "off",
+		 (unsigned)_flush_interval_us, _max_batch_size);
+	PX4_INFO("published: %u, superseded: %u, sent: %u in %u batches",
+		 (unsigned)_published, (unsigned)_superseded, (unsigned)_sent_samples, (unsigned)_sent_batches);
+	PX4_INFO("received: %u, rx errors: %u", (unsigned)_received_samples, (unsigned)_rx_errors);
+}
@@ -0,0 +1,212 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2018 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+#pragma once
+
+#include <stdint.h>
+#include <pthread.h>
+
+#include <drivers/drv_hrt.h>
+
+#include "uORBCommunicator.hpp"
+
+namespace uORB
+{
+class BatchedChannel;
+}
+
+/**
+ * Transport layer on top of an existing uORBCommunicator::IChannel.
+ *
+ * Publications are not forwarded synchronously from the publisher's thread.
+ * Instead the latest sample of each topic is stored in a per-topic slot and a
+ * sender thread packs all pending slots into a single batch message once per
+ * flush interval. Topics are identified by their index in orb_get_topics(),
+ * so both ends must be built from the same set of messages.
+ *
+ * The rate passed to process_add_subscription() by the remote side is
+ * honored: a topic is sent at most once per 1/rate seconds and samples
+ * published in between supersede each other (only the latest is sent).
+ *
+ * The class is both the IChannel used by the local uORB::Manager and the
+ * IChannelRxHandler registered with the underlying transport, so control
+ * messages are passed through and batches are unpacked transparently.
+ */
+class uORB::BatchedChannel : public uORBCommunicator::IChannel, public uORBCommunicator::IChannelRxHandler
+{
+public:
+	/**
+	 * @param transport underlying channel used to send batches and control messages
+	 * @param flush_interval_us interval at which pending topics are sent
+	 * @param max_batch_size maximum size of a single batch message in bytes
+	 */
+	BatchedChannel(uORBCommunicator::IChannel *transport, uint32_t flush_interval_us = 2000,
+		       uint16_t max_batch_size = 4096);
+	~BatchedChannel() override;
+
+	BatchedChannel(const BatchedChannel &) = delete;
+	BatchedChannel &operator=(const BatchedChannel &) = delete;
+
+	/**
+	 * Allocate the buffers and start the sender thread.
+	 * @return 0 on success, <0 otherwise
+	 */
+	int start();
+
+	/**
+	 * Stop the sender thread. Pending samples are flushed before returning.
+	 * Publications are then passed through to the transport unbatched, and
+	 * batching is not started automatically anymore (see set_auto_start()).
+	 */
+	void stop();
+
+	bool running();
+
+	/**
+	 * Start batching as soon as the first batch arrives from the peer, so that
+	 * only one end of the link needs to be configured. Until then (and while
+	 * stopped) publications are passed through to the transport unbatched.
+	 */
+	void set_auto_start(bool auto_start);
+
+	/**
+	 * Change the flush interval. Only possible while stopped.
+	 * @return 0 on success, -EBUSY if the sender thread is running
+	 */
+	int set_flush_interval(uint32_t flush_interval_us);
+
+	/**
+	 * Pack and send all pending topics whose rate limit allows it.
+	 * Called periodically by the sender thread, but can also be called directly.
+	 * @return number of topic samples sent
+	 */
+	int flush();
+
+	void print_status();
+
+	/**
+	 * Name of the data message carrying a batch over the underlying transport.
+	 */
+	static constexpr const char *BATCH_MESSAGE_NAME = "_orb_batch";
+
+	// IChannel
+	int16_t topic_advertised(const char *messageName) override;
+	int16_t add_subscription(const char *messageName, int32_t msgRateInHz) override;
+	int16_t remove_subscription(const char *messageName) override;
+	int16_t register_handler(uORBCommunicator::IChannelRxHandler *handler) override;
+	int16_t send_message(const char *messageName, int32_t length, uint8_t *data) override;
+	int16_t send_topic(const struct orb_metadata *meta, int32_t length, uint8_t *data) override;
+
+	// IChannelRxHandler
+	int16_t process_remote_topic(const char *topic_name, bool isAdvertisement) override;
+	int16_t process_add_subscription(const char *messageName, int32_t msgRateInHz) override;
+	int16_t process_remove_subscription(const char *messageName) override;
+	int16_t process_received_message(const char *messageName, int32_t length, uint8_t *data) override;
+
+private:
+
+	struct BatchHeader {
+		uint16_t magic;
+		uint16_t num_topics; ///< orb_topics_count() of the sender, must match on the receiver
+		uint16_t num_records;
+	};
+
+	struct RecordHeader {
+		uint16_t topic_id;
+		uint16_t length;
+	};
+
+	static constexpr uint16_t BATCH_MAGIC = 0xb5a7;
+
+	struct TopicSlot {
+		uint8_t *data{nullptr};
+		hrt_abstime last_sent{0};
+		uint32_t min_interval_us{0}; ///< 0 = no rate limit
+		bool pending{false};
+	};
+
+	/**
+	 * Find the numeric id of a topic.
+	 * @return id or -1 if not found
+	 */
+	int topic_id(const struct orb_metadata *meta) const;
+	int topic_id(const char *name) const;
+
+	int unpack_batch(const uint8_t *buffer, int32_t length);
+
+	int start_locked();
+
+	/**
+	 * Pack and send the pending topics. Must be called with _flush_mutex and _mutex held.
+	 * @param stopping send all pending topics regardless of their rate limit, and keep _mutex
+	 *                 held while sending, so that no publication can overtake them
+	 * @return number of topic samples sent
+	 */
+	int send_pending(bool stopping);
+
+	static void *run_helper(void *context);
+	void run();
+
+	uORBCommunicator::IChannel *_transport;
+	uORBCommunicator::IChannelRxHandler *_rx_handler{nullptr};
+
+	const struct orb_metadata *const *_topics;
+	const uint16_t _num_topics;
+
+	/* open-addressing hash table from metadata pointer to topic id */
+	int16_t *_id_table{nullptr};
+	uint32_t _id_table_mask{0};
+
+	TopicSlot *_slots{nullptr};
+	uint8_t *_batch_buffer{nullptr};
+
+	uint32_t _flush_interval_us;
+	const uint16_t _max_batch_size;
+
+	pthread_mutex_t _mutex;		///< protects the slots and _running
+	pthread_mutex_t _flush_mutex;	///< serializes flush() callers, protects _batch_buffer
+	pthread_mutex_t _control_mutex;	///< serializes start() and stop(), protects _auto_start
+	pthread_t _thread{};
+	volatile bool _should_exit{false};
+	bool _running{false};
+	bool _auto_start{false};
+
+	// statistics
+	uint32_t _published{0};
+	uint32_t _superseded{0};
+	uint32_t _sent_samples{0};
+	uint32_t _sent_batches{0};
+	uint32_t _received_samples{0};
+	uint32_t _rx_errors{0};
+};
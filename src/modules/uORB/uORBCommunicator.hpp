@@ -36,6 +36,7 @@
 
 #include <stdint.h>
 
+#include "uORB.h"
 
 namespace uORBCommunicator
 {
@@ -91,7 +92,7 @@ public:
 	 * 	This represents the uORB message name; This message name should be
 	 * 	globally unique.
 	 * @param msgRate
-	 * 	The max rate at which the subscriber can accept the messages.
+	 * 	The max rate at which the subscriber can accept the messages (0 = no limit).
 	 * @return
 	 * 	0 = success; This means the messages is successfully sent to the receiver
 	 * 		Note: This does not mean that the receiver as received it.
@@ -144,6 +145,23 @@ public:
 
 	virtual int16_t send_message(const char *messageName, int32_t length, uint8_t *data) = 0;
 
+	/**
+	 * @brief Sends the data message of a topic identified by its metadata.
+	 * Channels that can identify topics without a name lookup (e.g. by numeric
+	 * id) should override this; the default forwards to send_message().
+	 * @param meta
+	 * 	The uORB metadata of the topic.
+	 * @param length
+	 * 	The length of the data buffer to be sent.
+	 * @param data
+	 * 	The actual data to be sent.
+	 * @return
+	 *  0 = success; This means the message is accepted by the channel.
+	 *  otherwise = failure.
+	 */
+	virtual int16_t send_topic(const struct orb_metadata *meta, int32_t length, uint8_t *data);
+
+	virtual ~IChannel() = default;
 };
 
 /**
@@ -175,7 +193,7 @@ public:
 	 * 	This represents the uORB message Name; This message Name should be
 	 * 	globally unique.
 	 * @param msgRate
-	 * 	The max rate at which the subscriber can accept the messages.
+	 * 	The max rate at which the subscriber can accept the messages (0 = no limit).
 	 * @return
 	 *  0 = success; This means the messages is successfully handled in the
 	 *  	handler.
@@ -216,6 +234,33 @@ public:
 
 	virtual int16_t process_received_message(const char *messageName, int32_t length, uint8_t *data) = 0;
 
+	/**
+	 * Interface to process a received data message for which the channel
+	 * already resolved the topic metadata. The default forwards to
+	 * process_received_message().
+	 * @param meta
+	 * 	The uORB metadata of the topic.
+	 * @param length
+	 * 	The length of the data buffer.
+	 * @param data
+	 * 	The received data.
+	 * @return
+	 *  0 = success; otherwise = failure.
+	 */
+	virtual int16_t process_received_topic(const struct orb_metadata *meta, int32_t length, uint8_t *data);
+
+	virtual ~IChannelRxHandler() = default;
 };
 
+inline int16_t uORBCommunicator::IChannel::send_topic(const struct orb_metadata *meta, int32_t length, uint8_t *data)
+{
+	return send_message(meta->o_name, length, data);
+}
+
+inline int16_t uORBCommunicator::IChannelRxHandler::process_received_topic(const struct orb_metadata *meta,
+		int32_t length, uint8_t *data)
+{
+	return process_received_message(meta->o_name, length, data);
+}
+
 #endif /* _uORBCommunicator_hpp_ */
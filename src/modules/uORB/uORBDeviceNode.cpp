@@ -279,6 +279,24 @@ uORB::DeviceNode::write(cdev::file_t *filp, const char *buffer, size_t buflen)
 
 	ATOMIC_LEAVE;
 
+	/*
+	 * Run the publication hooks before waking the poll waiters, except for writes from
+	 * interrupt context. A waiter of higher priority than the publisher would otherwise
+	 * run first and take the update the hook is there to handle.
+	 */
+#ifdef __PX4_NUTTX
+	if ((_callbacks != nullptr) && !up_interrupt_context())
+#else
+	if (_callbacks != nullptr)
+#endif
+	{
+		for (PublicationCallback *cb = callbacks_enter(); cb != nullptr; cb = cb->getSibling()) {
+			cb->published(buffer);
+		}
+
+		callbacks_leave();
+	}
+
 	/* notify any poll waiters */
 	poll_notify(POLLIN);
 
@@ -417,7 +435,7 @@ uORB::DeviceNode::publish(const orb_metadata *meta, orb_advert_t handle, const v
 	uORBCommunicator::IChannel *ch = uORB::Manager::get_instance()->get_uorb_communicator();
 
 	if (ch != nullptr) {
-		if (ch->send_message(meta->o_name, meta->o_size, (uint8_t *)data) != 0) {
+		if (ch->send_topic(meta, meta->o_size, (uint8_t *)data) != 0) {
 			PX4_ERR("Error Sending [%s] topic data over comm_channel", meta->o_name);
 			return PX4_ERROR;
 		}
@@ -694,7 +712,7 @@ void uORB::DeviceNode::add_internal_subscriber()
 
 	if (ch != nullptr && _subscriber_count > 0) {
 		unlock(); //make sure we cannot deadlock if add_subscription calls back into DeviceNode
-		ch->add_subscription(_meta->o_name, 1);
+		ch->add_subscription(_meta->o_name, 0); // 0: no rate limit
 
 	} else
 #endif /* ORB_COMMUNICATOR */
@@ -723,6 +741,71 @@ void uORB::DeviceNode::remove_internal_subscriber()
 	}
 }
 
+void uORB::DeviceNode::register_callback(PublicationCallback *callback)
+{
+	/* the sibling is set before the head changes, so a concurrent write() sees a valid list */
+	ATOMIC_ENTER;
+	callback->setSibling(_callbacks);
+	_callbacks = callback;
+	ATOMIC_LEAVE;
+}
+
+void uORB::DeviceNode::unregister_callback(PublicationCallback *callback)
+{
+	/* the sibling of the removed hook is left intact for a write() still walking the list */
+	ATOMIC_ENTER;
+
+	if (_callbacks == callback) {
+		_callbacks = callback->getSibling();
+
+	} else {
+		for (PublicationCallback *cb = _callbacks; cb != nullptr; cb = cb->getSibling()) {
+			if (cb->getSibling() == callback) {
+				cb->setSibling(callback->getSibling());
+				break;
+			}
+		}
+	}
+
+	ATOMIC_LEAVE;
+
+	/* wait for writes still walking the old list, the hook can be freed once this returns */
+	while (callbacks_running()) {
+		px4_usleep(100);
+	}
+}
+
+/*
+ * The hook list accessors each hold one atomic section: on NuttX ATOMIC_ENTER declares
+ * the interrupt state, so it can only appear once per scope.
+ */
+uORB::PublicationCallback *uORB::DeviceNode::callbacks_enter()
+{
+	/* mark the walk, so unregister_callback() does not return while a hook still runs */
+	ATOMIC_ENTER;
+	PublicationCallback *cb = _callbacks;
+	_callbacks_running++;
+	ATOMIC_LEAVE;
+
+	return cb;
+}
+
+void uORB::DeviceNode::callbacks_leave()
+{
+	ATOMIC_ENTER;
+	_callbacks_running--;
+	ATOMIC_LEAVE;
+}
+
+bool uORB::DeviceNode::callbacks_running()
+{
+	ATOMIC_ENTER;
+	const bool running = (_callbacks_running > 0);
+	ATOMIC_LEAVE;
+
+	return running;
+}
+
 #ifdef ORB_COMMUNICATOR
 int16_t uORB::DeviceNode::process_add_subscription(int32_t rateInHz)
 {
@@ -732,7 +815,7 @@ int16_t uORB::DeviceNode::process_add_subscription(int32_t rateInHz)
 	uORBCommunicator::IChannel *ch = uORB::Manager::get_instance()->get_uorb_communicator();
 
 	if (_data != nullptr && ch != nullptr) { // _data will not be null if there is a publisher.
-		ch->send_message(_meta->o_name, _meta->o_size, _data);
+		ch->send_topic(_meta, _meta->o_size, _data);
 	}
 
 	return PX4_OK;
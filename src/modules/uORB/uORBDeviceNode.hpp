@@ -45,8 +45,29 @@ namespace uORB
 class DeviceNode;
 class DeviceMaster;
 class Manager;
+class PublicationCallback;
 }
 
+/**
+ * Hook run in the publisher's context right after new data was written to a topic,
+ * before the poll waiters of the topic are woken up.
+ *
+ * For consumers that must not wait for a poll wakeup, e.g. output drivers forwarding
+ * actuator controls. It runs on the publisher's stack (never from interrupt context),
+ * so it must be short and must not block. The object has to stay valid until it is
+ * unregistered.
+ */
+class uORB::PublicationCallback : public ListNode<uORB::PublicationCallback *>
+{
+public:
+	virtual ~PublicationCallback() = default;
+
+	/**
+	 * @param data	the published data, o_size bytes
+	 */
+	virtual void published(const void *data) = 0;
+};
+
 /**
  * Per-object device instance.
  */
@@ -155,6 +176,19 @@ public:
 	 */
 	void remove_internal_subscriber();
 
+	/**
+	 * Add a hook called after each publication to this node.
+	 */
+	void register_callback(PublicationCallback *callback);
+
+	/**
+	 * Remove a hook added with register_callback().
+	 *
+	 * Blocks until no write() is running the hooks anymore, so the hook can be freed
+	 * afterwards. Must not be called from a hook.
+	 */
+	void unregister_callback(PublicationCallback *callback);
+
 	/**
 	 * Return true if this topic has been published.
 	 *
@@ -222,6 +256,18 @@ private:
 		{ if (update_interval) { update_interval->update_reported = update_reported_flag; } }
 	};
 
+	/**
+	 * Start a walk of the hook list.
+	 * @return first hook, callbacks_leave() must follow once the walk is done
+	 */
+	PublicationCallback *callbacks_enter();
+	void callbacks_leave();
+
+	/**
+	 * @return true while a write() is walking the hook list
+	 */
+	bool callbacks_running();
+
 	const orb_metadata *_meta; /**< object metadata information */
 	const uint8_t _instance; /**< orb multi instance identifier */
 	uint8_t     *_data{nullptr};   /**< allocated object buffer */
@@ -232,6 +278,9 @@ private:
 	uint8_t _queue_size; /**< maximum number of elements in the queue */
 	int8_t _subscriber_count{0};
 
+	PublicationCallback *_callbacks{nullptr}; /**< hooks run by the publisher after each write */
+	uint8_t _callbacks_running{0}; /**< number of writes currently running the hooks */
+
 	px4_task_t _publisher{0}; /**< if nonzero, current publisher. Only used inside the advertise call.
 						We allow one publisher to have an open file descriptor at the same time. */
 
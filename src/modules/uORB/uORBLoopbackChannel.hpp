@@ -0,0 +1,120 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2018 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+#pragma once
+
+#include <stdint.h>
+
+#include "uORBCommunicator.hpp"
+
+namespace uORB
+{
+class LoopbackChannel;
+}
+
+/**
+ * In-process uORBCommunicator::IChannel implementation. Two instances are
+ * connected to each other and every message sent on one end is delivered
+ * synchronously to the handler registered on the other end.
+ *
+ * This allows to exercise and measure the multi-ORB transport (e.g. the
+ * uORB::BatchedChannel) on a plain Linux host without a remote processor.
+ */
+class uORB::LoopbackChannel : public uORBCommunicator::IChannel
+{
+public:
+	LoopbackChannel() = default;
+	~LoopbackChannel() override = default;
+
+	/**
+	 * Connect two channel ends with each other.
+	 */
+	static void connect(LoopbackChannel &a, LoopbackChannel &b)
+	{
+		a._peer = &b;
+		b._peer = &a;
+	}
+
+	int16_t topic_advertised(const char *messageName) override
+	{
+		++_control_messages;
+		return has_peer_handler() ? _peer->_rx_handler->process_remote_topic(messageName, true) : -1;
+	}
+
+	int16_t add_subscription(const char *messageName, int32_t msgRateInHz) override
+	{
+		++_control_messages;
+		return has_peer_handler() ? _peer->_rx_handler->process_add_subscription(messageName, msgRateInHz) : -1;
+	}
+
+	int16_t remove_subscription(const char *messageName) override
+	{
+		++_control_messages;
+		return has_peer_handler() ? _peer->_rx_handler->process_remove_subscription(messageName) : -1;
+	}
+
+	int16_t register_handler(uORBCommunicator::IChannelRxHandler *handler) override
+	{
+		_rx_handler = handler;
+		return 0;
+	}
+
+	int16_t send_message(const char *messageName, int32_t length, uint8_t *data) override
+	{
+		++_data_messages;
+		_data_bytes += length;
+		return has_peer_handler() ? _peer->_rx_handler->process_received_message(messageName, length, data) : -1;
+	}
+
+	uint32_t control_messages() const { return _control_messages; }
+	uint32_t data_messages() const { return _data_messages; }
+	uint64_t data_bytes() const { return _data_bytes; }
+
+	void reset_statistics()
+	{
+		_control_messages = 0;
+		_data_messages = 0;
+		_data_bytes = 0;
+	}
+
+private:
+	bool has_peer_handler() const { return _peer != nullptr && _peer->_rx_handler != nullptr; }
+
+	LoopbackChannel *_peer{nullptr};
+	uORBCommunicator::IChannelRxHandler *_rx_handler{nullptr};
+
+	uint32_t _control_messages{0};
+	uint32_t _data_messages{0};
+	uint64_t _data_bytes{0};
+};
@@ -40,9 +40,138 @@
 #include <px4_log.h>
 #include <px4_module.h>
 
+#ifdef __PX4_LINUX
+#include <px4_getopt.h>
+#include <stdlib.h>
+#include "uORBShmBridge.hpp"
+#include "uORBTopics.h"
+#endif
+
 extern "C" { __EXPORT int uorb_main(int argc, char *argv[]); }
 
 static uORB::DeviceMaster *g_dev = nullptr;
+static void usage();
+
+#ifdef __PX4_LINUX
+static uORB::ShmBridge *g_shm_bridge = nullptr;
+
+/**
+ * Find the metadata of a topic given as 'name' or 'name:instance'.
+ */
+static const struct orb_metadata *shm_find_topic(const char *arg, uint8_t &instance)
+{
+	const char *separator = strchr(arg, ':');
+	const size_t len = separator ? (size_t)(separator - arg) : strlen(arg);
+	instance = separator ? (uint8_t)strtol(separator + 1, nullptr, 10) : 0;
+
+	const struct orb_metadata *const *topics = orb_get_topics();
+
+	for (size_t i = 0; i < orb_topics_count(); i++) {
+		if (strlen(topics[i]->o_name) == len && strncmp(topics[i]->o_name, arg, len) == 0) {
+			return topics[i];
+		}
+	}
+
+	PX4_ERR("unknown topic %s", arg);
+	return nullptr;
+}
+
+static int shm_command(int argc, char *argv[])
+{
+	if (argc < 1) {
+		usage();
+		return -EINVAL;
+	}
+
+	if (!strcmp(argv[0], "start")) {
+		if (g_shm_bridge != nullptr) {
+			PX4_WARN("already running");
+			return 0;
+		}
+
+		uORB::ShmBridge *bridge = new uORB::ShmBridge();
+
+		if (bridge == nullptr) {
+			return -ENOMEM;
+		}
+
+		const char *segment_name = "px4_uorb";
+		int queue_size = 8;
+		int myoptind = 1;
+		const char *myoptarg = nullptr;
+		int ch;
+		int ret = 0;
+
+		while (ret == 0 && (ch = px4_getopt(argc, argv, "s:q:e:i:", &myoptind, &myoptarg)) != EOF) {
+			const struct orb_metadata *meta = nullptr;
+			uint8_t instance = 0;
+
+			switch (ch) {
+			case 's':
+				segment_name = myoptarg;
+				break;
+
+			case 'q':
+				queue_size = atoi(myoptarg);
+				break;
+
+			case 'e':
+				meta = shm_find_topic(myoptarg, instance);
+				ret = meta ? bridge->add_export(meta, instance) : -ENOENT;
+				break;
+
+			case 'i':
+				meta = shm_find_topic(myoptarg, instance);
+				ret = meta ? bridge->add_import(meta) : -ENOENT;
+				break;
+
+			default:
+				usage();
+				delete bridge;
+				return -EINVAL;
+			}
+		}
+
+		if (ret == 0 && (queue_size <= 0 || queue_size > 255)) {
+			PX4_ERR("queue size must be 1-255");
+			ret = -EINVAL;
+		}
+
+		if (ret == 0) {
+			ret = bridge->start(segment_name, queue_size);
+		}
+
+		if (ret != 0) {
+			PX4_ERR("start failed (%i)", ret);
+			delete bridge;
+			return ret;
+		}
+
+		g_shm_bridge = bridge;
+		return 0;
+	}
+
+	if (!strcmp(argv[0], "stop")) {
+		delete g_shm_bridge;
+		g_shm_bridge = nullptr;
+		return 0;
+	}
+
+	if (!strcmp(argv[0], "status")) {
+		if (g_shm_bridge != nullptr) {
+			g_shm_bridge->print_status();
+
+		} else {
+			PX4_INFO("shm bridge is not running");
+		}
+
+		return 0;
+	}
+
+	usage();
+	return -EINVAL;
+}
+#endif /* __PX4_LINUX */
 static void usage()
 {
 	PRINT_MODULE_DESCRIPTION(
@@ -68,9 +197,16 @@ Messages are defined in the `/msg` directory. They are converted into C/C++ code
 If compiled with ORB_USE_PUBLISHER_RULES, a file with uORB publication rules can be used to configure which
 modules are allowed to publish which topics. This is used for system-wide replay.
 
+On Linux, selected topics can be shared with external processes through a POSIX shared-memory segment
+(`uorb shm`). Exported topics are copied into the segment by the publisher, imported topics are published by
+one external process each. Clients use the header-only library in `src/modules/uORB/uORBShmClient.hpp`.
+
 ### Examples
 Monitor topic publication rates. Besides `top`, this is an important command for general system inspection:
 $ uorb top
+
+Share the odometry with external processes and accept trajectory setpoints from one of them:
+$ uorb shm start -e vehicle_odometry -i trajectory_setpoint
 )DESCR_STR");
 
 	PRINT_MODULE_USAGE_NAME("uorb", "communication");
@@ -79,6 +215,14 @@ $ uorb top
 	PRINT_MODULE_USAGE_COMMAND_DESCR("top", "Monitor topic publication rates");
 	PRINT_MODULE_USAGE_PARAM_FLAG('a', "print all instead of only currently publishing topics", true);
 	PRINT_MODULE_USAGE_ARG("<filter1> [<filter2>]", "topic(s) to match (implies -a)", true);
+#ifdef __PX4_LINUX
+	PRINT_MODULE_USAGE_COMMAND_DESCR("shm", "Shared-memory transport to external processes");
+	PRINT_MODULE_USAGE_ARG("start|stop|status", "", false);
+	PRINT_MODULE_USAGE_PARAM_STRING('s', "px4_uorb", nullptr, "Shared-memory segment name", true);
+	PRINT_MODULE_USAGE_PARAM_INT('q', 8, 1, 255, "Samples buffered per topic", true);
+	PRINT_MODULE_USAGE_PARAM_STRING('e', nullptr, "<topic>[:<instance>]", "Export a topic (repeatable)", true);
+	PRINT_MODULE_USAGE_PARAM_STRING('i', nullptr, "<topic>", "Import a topic published externally (repeatable)", true);
+#endif
 }
 
 int
@@ -147,6 +291,20 @@ uorb_main(int argc, char *argv[])
 		return OK;
 	}
 
+#ifdef __PX4_LINUX
+
+	if (!strcmp(argv[1], "shm")) {
+		if (g_dev == nullptr) {
+			PX4_INFO("uorb is not running");
+			return -EINVAL;
+		}
+
+		/* prints the usage itself on malformed commands, other errors are returned as they are */
+		return shm_command(argc - 2, argv + 2);
+	}
+
+#endif
+
 	usage();
 	return -EINVAL;
 }
@@ -316,6 +316,30 @@ int uORB::Manager::orb_get_interval(int handle, unsigned *interval)
 	return ret;
 }
 
+int uORB::Manager::register_callback(const struct orb_metadata *meta, int instance, PublicationCallback *callback)
+{
+	uORB::DeviceNode *node = get_device_master() ? _device_master->getDeviceNode(meta, instance) : nullptr;
+
+	if (node == nullptr) {
+		return PX4_ERROR;
+	}
+
+	node->register_callback(callback);
+	return PX4_OK;
+}
+
+int uORB::Manager::unregister_callback(const struct orb_metadata *meta, int instance, PublicationCallback *callback)
+{
+	uORB::DeviceNode *node = get_device_master() ? _device_master->getDeviceNode(meta, instance) : nullptr;
+
+	if (node == nullptr) {
+		return PX4_ERROR;
+	}
+
+	node->unregister_callback(callback);
+	return PX4_OK;
+}
+
 int uORB::Manager::node_advertise(const struct orb_metadata *meta, int *instance, int priority)
 {
 	int ret = PX4_ERROR;
@@ -518,6 +542,25 @@ int16_t uORB::Manager::process_received_message(const char *messageName, int32_t
 	return rc;
 }
 
+int16_t uORB::Manager::process_received_topic(const struct orb_metadata *meta, int32_t length, uint8_t *data)
+{
+	DeviceMaster *device_master = get_device_master();
+
+	if (device_master == nullptr || meta == nullptr) {
+		return -1;
+	}
+
+	uORB::DeviceNode *node = device_master->getDeviceNode(meta, 0);
+
+	if (node == nullptr) {
+		PX4_DEBUG("No existing subscriber found for message: [%s]", meta->o_name);
+		return -1;
+	}
+
+	node->process_received_message(length, data);
+	return 0;
+}
+
 bool uORB::Manager::is_remote_subscriber_present(const char *messageName)
 {
 #ifdef __PX4_NUTTX
@@ -54,6 +54,7 @@
 namespace uORB
 {
 class Manager;
+class PublicationCallback;
 }
 
 /**
@@ -359,6 +360,26 @@ public:
 	 */
 	int	orb_get_interval(int handle, unsigned *interval);
 
+	/**
+	 * Run a hook in the publisher's context after each publication of a topic
+	 * instance, see uORB::PublicationCallback.
+	 *
+	 * The topic node must exist, i.e. it has to be subscribed or advertised first.
+	 *
+	 * @param meta    The uORB metadata (usually from the ORB_ID() macro) for the topic.
+	 * @param instance  ORB instance
+	 * @param callback  The hook, it must stay valid until unregistered.
+	 * @return    OK on success, PX4_ERROR otherwise.
+	 */
+	int	register_callback(const struct orb_metadata *meta, int instance, PublicationCallback *callback);
+
+	/**
+	 * Remove a hook added with register_callback().
+	 *
+	 * @return    OK on success, PX4_ERROR otherwise.
+	 */
+	int	unregister_callback(const struct orb_metadata *meta, int instance, PublicationCallback *callback);
+
 #ifdef ORB_COMMUNICATOR
 	/**
 	 * Method to set the uORBCommunicator::IChannel instance.
@@ -474,6 +495,12 @@ private: //class methods
 	 *  otherwise = failure.
 	 */
 	virtual int16_t process_received_message(const char *messageName, int32_t length, uint8_t *data);
+
+	/**
+	 * Interface to process a received data message whose topic is already
+	 * resolved by the channel (e.g. batched transport). Skips the node path lookup.
+	 */
+	virtual int16_t process_received_topic(const struct orb_metadata *meta, int32_t length, uint8_t *data);
 #endif /* ORB_COMMUNICATOR */
 
 #ifdef ORB_USE_PUBLISHER_RULES
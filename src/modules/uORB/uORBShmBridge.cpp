@@ -0,0 +1,385 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2018 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+#include "uORBShmBridge.hpp"
+#include "uORBManager.hpp"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <new>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <px4_defines.h>
+#include <px4_log.h>
+#include <px4_posix.h>
+#include <px4_tasks.h>
+
+uORB::ShmBridge::~ShmBridge()
+{
+	stop();
+
+	for (int i = 0; i < _topic_count; ++i) {
+		pthread_mutex_destroy(&_topics[i].lock);
+	}
+}
+
+int uORB::ShmBridge::add_export(const struct orb_metadata *meta, uint8_t instance)
+{
+	return add_topic(meta, instance, shm::Direction::Export);
+}
+
+int uORB::ShmBridge::add_import(const struct orb_metadata *meta)
+{
+	return add_topic(meta, 0, shm::Direction::Import);
+}
+
+int uORB::ShmBridge::add_topic(const struct orb_metadata *meta, uint8_t instance, shm::Direction direction)
+{
+	if (running() || meta == nullptr || strlen(meta->o_name) >= shm::MAX_NAME_LEN) {
+		return -EINVAL;
+	}
+
+	if (_topic_count >= shm::MAX_TOPICS) {
+		return -ENOMEM;
+	}
+
+	for (int i = 0; i < _topic_count; ++i) {
+		if (_topics[i].meta == meta && _topics[i].instance == instance && _topics[i].direction == direction) {
+			return -EEXIST;
+		}
+	}
+
+	TopicState &topic = _topics[_topic_count];
+	topic.meta = meta;
+	topic.instance = instance;
+	topic.direction = direction;
+	topic.hook.bridge = this;
+	topic.hook.index = _topic_count;
+	pthread_mutex_init(&topic.lock, nullptr);
+
+	++_topic_count;
+	return 0;
+}
+
+int uORB::ShmBridge::start(const char *segment_name, uint16_t queue_size)
+{
+	if (running() || _topic_count == 0 || queue_size == 0) {
+		return -EINVAL;
+	}
+
+	snprintf(_segment_name, sizeof(_segment_name), "%s%s", segment_name[0] == '/' ? "" : "/", segment_name);
+
+	/* directory, followed by the slots of every topic */
+	uint32_t size = shm::align(sizeof(shm::Header));
+	uint32_t max_size = 0;
+
+	for (int i = 0; i < _topic_count; ++i) {
+		size += queue_size * shm::slot_stride(_topics[i].meta->o_size);
+
+		if (_topics[i].meta->o_size > max_size) {
+			max_size = _topics[i].meta->o_size;
+		}
+	}
+
+	_buffer = new uint8_t[max_size];
+
+	if (_buffer == nullptr) {
+		return -ENOMEM;
+	}
+
+	/* replace a stale segment, e.g. after a crash */
+	shm_unlink(_segment_name);
+
+	int fd = shm_open(_segment_name, O_CREAT | O_EXCL | O_RDWR, 0660);
+
+	if (fd < 0 || ftruncate(fd, size) != 0) {
+		const int err = errno;
+		PX4_ERR("failed to create %s (%i)", _segment_name, err);
+
+		if (fd >= 0) {
+			close(fd);
+			shm_unlink(_segment_name);
+		}
+
+		delete[] _buffer;
+		_buffer = nullptr;
+		return -err;
+	}
+
+	void *mapping = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+
+	if (mapping == MAP_FAILED) {
+		const int err = errno;
+		PX4_ERR("mmap failed (%i)", err);
+		shm_unlink(_segment_name);
+		delete[] _buffer;
+		_buffer = nullptr;
+		return -err;
+	}
+
+	/* the segment is zero-filled, which is a valid initial state of the atomics */
+	_header = new (mapping) shm::Header();
+	_size = size;
+
+	_header->magic = shm::MAGIC;
+	_header->version = shm::VERSION;
+	_header->size = size;
+	_header->topic_count = _topic_count;
+
+	uint32_t offset = shm::align(sizeof(shm::Header));
+
+	for (int i = 0; i < _topic_count; ++i) {
+		TopicState &state = _topics[i];
+		shm::Topic &topic = _header->topics[i];
+
+		strncpy(topic.name, state.meta->o_name, sizeof(topic.name) - 1);
+		topic.size = state.meta->o_size;
+		topic.fields_hash = shm::fields_hash(state.meta->o_fields);
+		topic.offset = offset;
+		topic.slot_stride = shm::slot_stride(topic.size);
+		topic.queue_size = queue_size;
+		topic.instance = state.instance;
+		topic.direction = (uint8_t)state.direction;
+
+		offset += queue_size * topic.slot_stride;
+
+		state.samples = 0;
+		state.lost = 0;
+		state.next = 0;
+	}
+
+	_header->ready.store(1);
+
+	/* exported topics: the subscription creates the node if nobody advertised it yet */
+	for (int i = 0; i < _topic_count; ++i) {
+		TopicState &state = _topics[i];
+
+		if (state.direction != shm::Direction::Export) {
+			continue;
+		}
+
+		state.subscription = orb_subscribe_multi(state.meta, state.instance);
+
+		if (state.subscription < 0) {
+			PX4_ERR("failed to subscribe to %s", state.meta->o_name);
+			stop();
+			return -ENOENT;
+		}
+
+		/* hook first, so no publication between the initial copy and the registration is lost */
+		if (Manager::get_instance()->register_callback(state.meta, state.instance, &state.hook) != PX4_OK) {
+			PX4_ERR("failed to hook %s", state.meta->o_name);
+			orb_unsubscribe(state.subscription);
+			state.subscription = -1;
+			stop();
+			return -ENOENT;
+		}
+
+		/*
+		 * Make the current value available right away, unless the hook already wrote a newer one.
+		 * The lock keeps a concurrent hook from being overtaken by this older copy.
+		 */
+		pthread_mutex_lock(&state.lock);
+		bool updated = false;
+
+		if (state.samples == 0 && orb_check(state.subscription, &updated) == PX4_OK && updated
+		    && orb_copy(state.meta, state.subscription, _buffer) == PX4_OK) {
+			shm::write(_header, _header->topics[i], _buffer);
+			++state.samples;
+		}
+
+		pthread_mutex_unlock(&state.lock);
+	}
+
+	_should_exit = false;
+
+	/* real-time scheduling like px4_task_spawn_cmd(), the default attributes would inherit the caller's */
+	pthread_attr_t thr_attr;
+	pthread_attr_init(&thr_attr);
+	pthread_attr_setinheritsched(&thr_attr, PTHREAD_EXPLICIT_SCHED);
+	pthread_attr_setschedpolicy(&thr_attr, SCHED_FIFO);
+
+	sched_param param;
+	(void)pthread_attr_getschedparam(&thr_attr, &param);
+	param.sched_priority = SCHED_PRIORITY_DEFAULT;
+	(void)pthread_attr_setschedparam(&thr_attr, &param);
+
+	pthread_attr_setstacksize(&thr_attr, PX4_STACK_ADJUSTED(1500));
+
+	int ret = pthread_create(&_thread, &thr_attr, &ShmBridge::run_helper, this);
+
+	if (ret == EPERM) {
+		/* not allowed to use real-time scheduling (not root), same fallback as px4_task_spawn_cmd() */
+		PX4_WARN("no permission for real-time scheduling, import thread runs with default priority");
+		pthread_attr_setinheritsched(&thr_attr, PTHREAD_INHERIT_SCHED);
+		ret = pthread_create(&_thread, &thr_attr, &ShmBridge::run_helper, this);
+	}
+
+	pthread_attr_destroy(&thr_attr);
+
+	if (ret != 0) {
+		PX4_ERR("failed to create import thread (%i)", ret);
+		stop();
+		return -ret;
+	}
+
+	_thread_running = true;
+	return 0;
+}
+
+void uORB::ShmBridge::stop()
+{
+	if (_thread_running) {
+		_should_exit = true;
+		_header->import_futex.fetch_add(1);
+		shm::futex_wake(_header->import_futex);
+		pthread_join(_thread, nullptr);
+		_thread_running = false;
+	}
+
+	for (int i = 0; i < _topic_count; ++i) {
+		TopicState &state = _topics[i];
+
+		if (state.subscription >= 0) {
+			Manager::get_instance()->unregister_callback(state.meta, state.instance, &state.hook);
+			orb_unsubscribe(state.subscription);
+			state.subscription = -1;
+		}
+
+		if (state.advertiser != nullptr) {
+			orb_unadvertise(state.advertiser);
+			state.advertiser = nullptr;
+		}
+	}
+
+	/* a publisher might still be inside a hook, detach the segment under the topic locks */
+	shm::Header *header = _header;
+
+	for (int i = 0; i < _topic_count; ++i) {
+		pthread_mutex_lock(&_topics[i].lock);
+	}
+
+	_header = nullptr;
+
+	for (int i = 0; i < _topic_count; ++i) {
+		pthread_mutex_unlock(&_topics[i].lock);
+	}
+
+	if (header != nullptr) {
+		munmap(header, _size);
+		shm_unlink(_segment_name);
+	}
+
+	delete[] _buffer;
+	_buffer = nullptr;
+}
+
+void uORB::ShmBridge::write_export(int index, const void *data)
+{
+	TopicState &state = _topics[index];
+
+	pthread_mutex_lock(&state.lock);
+
+	if (_header != nullptr) {
+		shm::write(_header, _header->topics[index], data);
+		++state.samples;
+	}
+
+	pthread_mutex_unlock(&state.lock);
+}
+
+void *uORB::ShmBridge::run_helper(void *context)
+{
+	px4_prctl(PR_SET_NAME, "orb_shm", px4_getpid());
+	static_cast<ShmBridge *>(context)->run();
+	return nullptr;
+}
+
+void uORB::ShmBridge::run()
+{
+	while (!_should_exit) {
+		const uint32_t seen = _header->import_futex.load();
+		bool received = false;
+
+		for (int i = 0; i < _topic_count; ++i) {
+			TopicState &state = _topics[i];
+
+			if (state.direction != shm::Direction::Import) {
+				continue;
+			}
+
+			while (shm::read(_header, _header->topics[i], state.next, _buffer, state.lost)) {
+				if (state.advertiser == nullptr) {
+					state.advertiser = orb_advertise(state.meta, _buffer);
+
+				} else {
+					orb_publish(state.meta, state.advertiser, _buffer);
+				}
+
+				++state.samples;
+				received = true;
+			}
+		}
+
+		if (!received) {
+			shm::futex_wait(_header->import_futex, _header->import_waiters, seen, 100000000);
+		}
+	}
+}
+
+void uORB::ShmBridge::print_status() const
+{
+	if (!running()) {
+		PX4_INFO("not running");
+		return;
+	}
+
+	PX4_INFO("segment %s, %u bytes", _segment_name, (unsigned)_size);
+
+	for (int i = 0; i < _topic_count; ++i) {
+		const TopicState &state = _topics[i];
+		const shm::Topic &topic = _header->topics[i];
+
+		if (state.direction == shm::Direction::Export) {
+			PX4_INFO("export %s (%i): %u samples", state.meta->o_name, state.instance, (unsigned)state.samples);
+
+		} else {
+			PX4_INFO("import %s: %u samples, %u lost, writer pid %u", state.meta->o_name, (unsigned)state.samples,
+				 (unsigned)state.lost, (unsigned)topic.writer.load());
+		}
+	}
+}
@@ -0,0 +1,145 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2018 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+#pragma once
+
+#include <stdint.h>
+#include <pthread.h>
+
+#include "uORB.h"
+#include "uORBDeviceNode.hpp"
+#include "uORBShmSegment.hpp"
+
+namespace uORB
+{
+class ShmBridge;
+}
+
+/**
+ * Exchange uORB topics with external processes through a POSIX shared-memory
+ * segment (Linux only), without serialization.
+ *
+ * Exported topics are copied into the segment by a publication hook, in the
+ * context of the PX4 publisher. Imported topics are written into the segment
+ * by one external process each, a bridge thread sleeps on the import futex and
+ * republishes new samples with orb_publish().
+ *
+ * See uORBShmSegment.hpp for the layout and uORBShmClient.hpp for the client side.
+ */
+class uORB::ShmBridge
+{
+public:
+	ShmBridge() = default;
+	~ShmBridge();
+
+	ShmBridge(const ShmBridge &) = delete;
+	ShmBridge &operator=(const ShmBridge &) = delete;
+
+	/**
+	 * Export a topic instance to external processes. Must be called before start().
+	 * @return 0 on success, <0 otherwise
+	 */
+	int add_export(const struct orb_metadata *meta, uint8_t instance = 0);
+
+	/**
+	 * Import a topic published by an external process (as instance 0). Must be called before start().
+	 * @return 0 on success, <0 otherwise
+	 */
+	int add_import(const struct orb_metadata *meta);
+
+	/**
+	 * Create the segment, register the publication hooks and start the import thread.
+	 * An existing segment with the same name is replaced.
+	 * @param segment_name shm_open() name, a leading '/' is optional
+	 * @param queue_size number of samples buffered per topic
+	 * @return 0 on success, <0 otherwise
+	 */
+	int start(const char *segment_name, uint16_t queue_size = 8);
+
+	/**
+	 * Unregister the hooks, stop the import thread and remove the segment.
+	 */
+	void stop();
+
+	bool running() const { return _header != nullptr; }
+
+	void print_status() const;
+
+private:
+	class ExportHook : public PublicationCallback
+	{
+	public:
+		void published(const void *data) override { bridge->write_export(index, data); }
+
+		ShmBridge *bridge{nullptr};
+		int index{0};
+	};
+
+	struct TopicState {
+		const struct orb_metadata *meta{nullptr};
+		uint8_t instance{0};
+		shm::Direction direction{shm::Direction::Export};
+
+		/* export */
+		ExportHook hook;
+		int subscription{-1};
+		pthread_mutex_t lock;		///< serializes concurrent publishers of the topic
+
+		/* import */
+		orb_advert_t advertiser{nullptr};
+		uint64_t next{0};
+		uint64_t lost{0};
+
+		uint32_t samples{0};
+	};
+
+	int add_topic(const struct orb_metadata *meta, uint8_t instance, shm::Direction direction);
+
+	void write_export(int index, const void *data);
+
+	static void *run_helper(void *context);
+	void run();
+
+	TopicState _topics[shm::MAX_TOPICS];
+	int _topic_count{0};
+
+	char _segment_name[shm::MAX_NAME_LEN + 1] {};
+	shm::Header *_header{nullptr};
+	uint32_t _size{0};
+	uint8_t *_buffer{nullptr};		///< import sample buffer, the size of the largest imported topic
+
+	pthread_t _thread{};
+	volatile bool _should_exit{false};
+	bool _thread_running{false};
+};
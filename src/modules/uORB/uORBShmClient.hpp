@@ -0,0 +1,302 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2018 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+/**
+ * @file uORBShmClient.hpp
+ *
+ * Client library for external Linux processes to access uORB topics
+ * exported by the uORB shared-memory bridge ('uorb shm start').
+ *
+ * Header-only and without PX4 dependencies, the message structs can be taken
+ * from the generated uORB topic headers. Example:
+ *
+ *     uORB::ShmClient client;
+ *     client.open("px4_uorb");
+ *     int odom = client.subscribe("vehicle_odometry", 0, sizeof(vehicle_odometry_s));
+ *     int setpoint = client.advertise("trajectory_setpoint", sizeof(vehicle_local_position_setpoint_s));
+ *
+ *     vehicle_odometry_s odometry;
+ *
+ *     if (client.wait(odom, 100000) && client.update(odom, &odometry)) {
+ *         ...
+ *         client.publish(setpoint, &sp);
+ *     }
+ */
+
+#pragma once
+
+#include "uORBShmSegment.hpp"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace uORB
+{
+
+class ShmClient
+{
+public:
+	ShmClient() = default;
+	~ShmClient() { close(); }
+
+	ShmClient(const ShmClient &) = delete;
+	ShmClient &operator=(const ShmClient &) = delete;
+
+	/**
+	 * Map the segment created by the bridge.
+	 * @param segment_name name passed to 'uorb shm start -s'
+	 * @return 0 on success, -errno otherwise (-EAGAIN if the bridge is not ready yet)
+	 */
+	int open(const char *segment_name)
+	{
+		close();
+
+		char path[shm::MAX_NAME_LEN + 1];
+		snprintf(path, sizeof(path), "%s%s", segment_name[0] == '/' ? "" : "/", segment_name);
+
+		int fd = shm_open(path, O_RDWR, 0);
+
+		if (fd < 0) {
+			return -errno;
+		}
+
+		struct stat st;
+
+		if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(shm::Header)) {
+			::close(fd);
+			return -EAGAIN;
+		}
+
+		void *mapping = mmap(nullptr, st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+		::close(fd);
+
+		if (mapping == MAP_FAILED) {
+			return -errno;
+		}
+
+		_header = static_cast<shm::Header *>(mapping);
+		_size = st.st_size;
+
+		if (_header->magic != shm::MAGIC || _header->version != shm::VERSION || _header->size > _size) {
+			close();
+			return -EPROTO;
+		}
+
+		if (!_header->ready.load()) {
+			close();
+			return -EAGAIN;
+		}
+
+		return 0;
+	}
+
+	void close()
+	{
+		if (_header) {
+			for (int i = 0; i < shm::MAX_TOPICS; i++) {
+				if (_handles[i].publisher) {
+					_header->topics[i].writer.store(0);
+				}
+			}
+
+			munmap(_header, _size);
+			_header = nullptr;
+		}
+
+		memset(_handles, 0, sizeof(_handles));
+	}
+
+	bool is_open() const { return _header != nullptr; }
+
+	/**
+	 * Subscribe to a topic exported by PX4.
+	 * Samples published before subscribing are not returned, except the latest one.
+	 * @param size sizeof() the message struct, must match
+	 * @param fields optional o_fields string of the message to check the definition
+	 * @return handle >= 0, or -errno
+	 */
+	int subscribe(const char *name, uint8_t instance, uint32_t size, const char *fields = nullptr)
+	{
+		const int handle = find(name, instance, shm::Direction::Export, size, fields);
+
+		if (handle >= 0) {
+			const uint64_t generation = _header->topics[handle].generation.load();
+			_handles[handle].next = generation > 0 ? generation - 1 : 0;
+			_handles[handle].lost = 0;
+		}
+
+		return handle;
+	}
+
+	/**
+	 * Become the publisher of a topic imported into PX4 (instance 0).
+	 * There can be only one publisher per topic.
+	 * @return handle >= 0, or -errno (-EBUSY if another process publishes the topic)
+	 */
+	int advertise(const char *name, uint32_t size, const char *fields = nullptr)
+	{
+		const int handle = find(name, 0, shm::Direction::Import, size, fields);
+
+		if (handle < 0) {
+			return handle;
+		}
+
+		uint32_t expected = 0;
+
+		if (!_header->topics[handle].writer.compare_exchange_strong(expected, (uint32_t)getpid())) {
+			return -EBUSY;
+		}
+
+		_handles[handle].publisher = true;
+		return handle;
+	}
+
+	/**
+	 * Copy the next sample of a subscribed topic.
+	 * @param write_time_ns optional CLOCK_MONOTONIC time at which PX4 published the sample
+	 * @return true if a new sample was copied
+	 */
+	bool update(int handle, void *data, uint64_t *write_time_ns = nullptr)
+	{
+		return valid(handle) && shm::read(_header, _header->topics[handle], _handles[handle].next, data,
+						  _handles[handle].lost, write_time_ns);
+	}
+
+	template<typename T>
+	bool update(int handle, T &data, uint64_t *write_time_ns = nullptr)
+	{
+		return valid(handle) && _header->topics[handle].size == sizeof(T) && update(handle, &data, write_time_ns);
+	}
+
+	/** check for a new sample without copying it */
+	bool updated(int handle) const
+	{
+		return valid(handle) && _header->topics[handle].generation.load() != _handles[handle].next;
+	}
+
+	/**
+	 * Wait for a new sample of a subscribed topic. Busy-waits for a short time
+	 * (shm::SPIN_NS) before sleeping, for the lowest latency at high rates.
+	 * @return true if a new sample is available
+	 */
+	bool wait(int handle, uint32_t timeout_us)
+	{
+		if (!valid(handle)) {
+			return false;
+		}
+
+		const shm::Topic &topic = _header->topics[handle];
+		std::atomic<uint32_t> &word = shm::futex_word(_header, topic);
+		const uint64_t start = shm::monotonic_ns();
+		const uint64_t deadline = start + (uint64_t)timeout_us * 1000;
+
+		for (;;) {
+			const uint32_t seen = word.load();
+
+			if (updated(handle)) {
+				return true;
+			}
+
+			const uint64_t now = shm::monotonic_ns();
+
+			if (now >= deadline) {
+				return false;
+			}
+
+			if (now - start < shm::SPIN_NS) {
+				continue;
+			}
+
+			shm::futex_wait(word, shm::futex_waiters(_header, topic), seen, deadline - now);
+		}
+	}
+
+	/**
+	 * Publish a sample of an advertised topic.
+	 * @return true on success
+	 */
+	bool publish(int handle, const void *data)
+	{
+		if (!valid(handle) || !_handles[handle].publisher) {
+			return false;
+		}
+
+		shm::write(_header, _header->topics[handle], data);
+		return true;
+	}
+
+	/** number of samples of a subscribed topic that were overwritten before they were read */
+	uint64_t lost(int handle) const { return valid(handle) ? _handles[handle].lost : 0; }
+
+private:
+	bool valid(int handle) const { return _header && handle >= 0 && handle < (int)_header->topic_count; }
+
+	int find(const char *name, uint8_t instance, shm::Direction direction, uint32_t size, const char *fields) const
+	{
+		if (!_header) {
+			return -ENOTCONN;
+		}
+
+		for (int i = 0; i < (int)_header->topic_count; i++) {
+			const shm::Topic &topic = _header->topics[i];
+
+			if (strncmp(topic.name, name, sizeof(topic.name)) == 0 && topic.instance == instance
+			    && topic.direction == (uint8_t)direction) {
+
+				if (topic.size != size || (fields && topic.fields_hash != shm::fields_hash(fields))) {
+					return -EPROTO;
+				}
+
+				return i;
+			}
+		}
+
+		return -ENOENT;
+	}
+
+	struct Handle {
+		uint64_t next;		///< next sample to read
+		uint64_t lost;
+		bool publisher;
+	};
+
+	shm::Header *_header{nullptr};
+	size_t _size{0};
+	Handle _handles[shm::MAX_TOPICS] {};
+};
+
+} // namespace uORB
@@ -0,0 +1,281 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2018 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+/**
+ * @file uORBShmSegment.hpp
+ *
+ * Layout of the shared-memory segment used to exchange uORB topics with
+ * external processes on Linux, and the lock-free access protocol.
+ *
+ * This header has no PX4 dependencies, it is shared between the uORB
+ * module (uORB::ShmBridge) and the client library (uORB::ShmClient).
+ *
+ * Every topic has a ring of queue_size slots with a single writer. A slot
+ * is protected by a sequence counter (seqlock): the writer makes it odd
+ * before and even after copying the data, a reader copies the data and
+ * retries if the counter changed in between. Readers never block the
+ * writer. New samples are signaled with a futex word per direction, which
+ * is only woken if a reader is actually sleeping on it.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <limits.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace uORB
+{
+namespace shm
+{
+
+static constexpr uint32_t MAGIC = 0x5342524f; ///< "ORBS"
+static constexpr uint32_t VERSION = 1;
+static constexpr int MAX_TOPICS = 32;
+static constexpr int MAX_NAME_LEN = 48;
+
+/** time a reader busy-waits for a new sample before sleeping on the futex */
+static constexpr uint64_t SPIN_NS = 20000;
+
+/** attempts a reader makes to get a consistent copy of a slot before giving up, e.g. when
+ * the writer died in the middle of a write and left the slot marked as being written */
+static constexpr int READ_RETRIES = 100;
+
+static_assert(ATOMIC_INT_LOCK_FREE == 2 && ATOMIC_LLONG_LOCK_FREE == 2, "shared atomics must be lock-free");
+
+enum class Direction : uint8_t {
+	Export = 0,	///< published in PX4, read by external processes
+	Import = 1	///< published by an external process, republished in PX4
+};
+
+/** header of a sample slot, the data follows */
+struct Slot {
+	std::atomic<uint32_t> sequence;	///< odd while the slot is written
+	uint32_t reserved;
+	uint64_t index;			///< sample number, slot = index % queue_size
+	uint64_t write_time_ns;		///< CLOCK_MONOTONIC time of the write
+};
+
+struct Topic {
+	char name[MAX_NAME_LEN];
+	uint32_t size;			///< o_size of the message
+	uint32_t fields_hash;		///< hash of the orb_metadata o_fields, see fields_hash()
+	uint32_t offset;		///< offset of the first slot from the start of the segment
+	uint32_t slot_stride;
+	uint16_t queue_size;
+	uint8_t instance;
+	uint8_t direction;		///< Direction
+	std::atomic<uint32_t> writer;	///< pid of the external writer of an imported topic, 0 if none
+	std::atomic<uint64_t> generation; ///< number of samples written
+};
+
+struct Header {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t size;			///< total size of the segment
+	uint32_t topic_count;
+	std::atomic<uint32_t> ready;	///< set once the directory is complete
+
+	std::atomic<uint32_t> export_futex;	///< incremented after each write of an exported topic
+	std::atomic<uint32_t> export_waiters;
+	std::atomic<uint32_t> import_futex;	///< incremented after each write of an imported topic
+	std::atomic<uint32_t> import_waiters;
+
+	Topic topics[MAX_TOPICS];
+};
+
+static inline uint32_t align(uint32_t value, uint32_t alignment = 64)
+{
+	return (value + alignment - 1) & ~(alignment - 1);
+}
+
+static inline uint32_t slot_stride(uint32_t size)
+{
+	return align(sizeof(Slot) + size);
+}
+
+static inline uint64_t monotonic_ns()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+/** FNV-1a hash of the field definition, to detect mismatching message definitions */
+static inline uint32_t fields_hash(const char *fields)
+{
+	uint32_t hash = 2166136261u;
+
+	for (; fields && *fields; ++fields) {
+		hash = (hash ^ (uint8_t) * fields) * 16777619u;
+	}
+
+	return hash;
+}
+
+static inline Slot *slot(Header *header, const Topic &topic, uint64_t index)
+{
+	return reinterpret_cast<Slot *>(reinterpret_cast<uint8_t *>(header) + topic.offset +
+					(index % topic.queue_size) * topic.slot_stride);
+}
+
+/** the message data follows the slot header */
+static inline uint8_t *slot_data(Slot *s) { return reinterpret_cast<uint8_t *>(s) + sizeof(Slot); }
+static inline const uint8_t *slot_data(const Slot *s) { return reinterpret_cast<const uint8_t *>(s) + sizeof(Slot); }
+
+static inline std::atomic<uint32_t> &futex_word(Header *header, const Topic &topic)
+{
+	return topic.direction == (uint8_t)Direction::Export ? header->export_futex : header->import_futex;
+}
+
+static inline std::atomic<uint32_t> &futex_waiters(Header *header, const Topic &topic)
+{
+	return topic.direction == (uint8_t)Direction::Export ? header->export_waiters : header->import_waiters;
+}
+
+/**
+ * Sleep until the futex word differs from seen, or the timeout expires.
+ * The segment is mapped in several processes, so the futex must not be private.
+ */
+static inline void futex_wait(std::atomic<uint32_t> &word, std::atomic<uint32_t> &waiters, uint32_t seen,
+			      uint64_t timeout_ns)
+{
+	struct timespec timeout;
+	timeout.tv_sec = timeout_ns / 1000000000ull;
+	timeout.tv_nsec = timeout_ns % 1000000000ull;
+
+	waiters.fetch_add(1);
+	syscall(SYS_futex, reinterpret_cast<uint32_t *>(&word), FUTEX_WAIT, seen, &timeout, nullptr, 0);
+	waiters.fetch_sub(1);
+}
+
+/**
+ * Wake all processes sleeping on the futex word.
+ */
+static inline void futex_wake(std::atomic<uint32_t> &word)
+{
+	syscall(SYS_futex, reinterpret_cast<uint32_t *>(&word), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+}
+
+/**
+ * Write a new sample. There must be only one writer per topic at a time.
+ */
+static inline void write(Header *header, Topic &topic, const void *data)
+{
+	const uint64_t index = topic.generation.load(std::memory_order_relaxed);
+	Slot *s = slot(header, topic, index);
+
+	const uint32_t sequence = s->sequence.load(std::memory_order_relaxed);
+	s->sequence.store(sequence + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+
+	s->index = index;
+	s->write_time_ns = monotonic_ns();
+	memcpy(slot_data(s), data, topic.size);
+
+	s->sequence.store(sequence + 2, std::memory_order_release);
+	topic.generation.store(index + 1);
+
+	std::atomic<uint32_t> &word = futex_word(header, topic);
+	word.fetch_add(1);
+
+	if (futex_waiters(header, topic).load() > 0) {
+		futex_wake(word);
+	}
+}
+
+/**
+ * Read the oldest sample that was not read yet.
+ * @param next index of the next sample to read, advanced on success
+ * @param data buffer of topic.size bytes
+ * @param lost incremented by the number of samples that were overwritten before they were read
+ * @param write_time_ns optional CLOCK_MONOTONIC time the sample was written
+ * @return true if a sample was copied, false if there is none or no consistent copy could be made
+ *         within READ_RETRIES attempts (the sample is then tried again on the next call)
+ */
+static inline bool read(Header *header, const Topic &topic, uint64_t &next, void *data, uint64_t &lost,
+			uint64_t *write_time_ns = nullptr)
+{
+	for (int retry = 0; retry < READ_RETRIES; ++retry) {
+		const uint64_t generation = topic.generation.load(std::memory_order_acquire);
+
+		if (generation == next) {
+			return false;
+		}
+
+		if (generation - next > topic.queue_size) {
+			lost += generation - topic.queue_size - next;
+			next = generation - topic.queue_size;
+		}
+
+		const Slot *s = slot(header, topic, next);
+
+		const uint32_t sequence = s->sequence.load(std::memory_order_acquire);
+
+		if (sequence & 1) {
+			continue; // being written
+		}
+
+		const uint64_t index = s->index;
+		const uint64_t time = s->write_time_ns;
+		memcpy(data, slot_data(s), topic.size);
+
+		std::atomic_thread_fence(std::memory_order_acquire);
+
+		if (s->sequence.load(std::memory_order_relaxed) != sequence) {
+			continue; // overwritten while copying
+		}
+
+		if (index != next) {
+			continue; // the writer lapped us, start over with the new generation
+		}
+
+		if (write_time_ns) {
+			*write_time_ns = time;
+		}
+
+		++next;
+		return true;
+	}
+
+	return false;
+}
+
+} // namespace shm
+} // namespace uORB
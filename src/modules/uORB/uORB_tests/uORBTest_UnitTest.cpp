@@ -33,6 +33,8 @@
 
 #include "uORBTest_UnitTest.hpp"
 #include "../uORBCommon.hpp"
+#include "../uORBDeviceNode.hpp"
+#include "../uORBManager.hpp"
 #include <px4_config.h>
 #include <px4_time.h>
 #include <stdio.h>
@@ -40,8 +42,23 @@
 #include <poll.h>
 #include <lib/cdev/CDev.hpp>
 
+#ifndef __PX4_NUTTX
+#include "../uORBBatchedChannel.hpp"
+#include "../uORBLoopbackChannel.hpp"
+#include <uORB/topics/sensor_combined.h>
+#include <uORB/topics/vehicle_attitude.h>
+#endif
+
+#ifdef __PX4_LINUX
+#include "../uORBShmBridge.hpp"
+#include "../uORBShmClient.hpp"
+#include <signal.h>
+#include <sys/wait.h>
+#endif
+
 ORB_DEFINE(orb_test, struct orb_test, sizeof(orb_test), "ORB_TEST:int val;hrt_abstime time;");
 ORB_DEFINE(orb_multitest, struct orb_test, sizeof(orb_test), "ORB_MULTITEST:int val;hrt_abstime time;");
+ORB_DEFINE(orb_test_callback, struct orb_test, sizeof(orb_test), "ORB_TEST_CALLBACK:int val;hrt_abstime time;");
 
 ORB_DEFINE(orb_test_medium, struct orb_test_medium, sizeof(orb_test_medium),
 	   "ORB_TEST_MEDIUM:int val;hrt_abstime time;char[64] junk;");
@@ -223,7 +240,13 @@ int uORBTest::UnitTest::test()
 		return ret;
 	}
 
-	return test_queue_poll_notify();
+	ret = test_queue_poll_notify();
+
+	if (ret != OK) {
+		return ret;
+	}
+
+	return test_publication_callback();
 }
 
 int uORBTest::UnitTest::test_unadvertise()
@@ -842,6 +865,668 @@ int uORBTest::UnitTest::test_queue_poll_notify()
 	return test_note("PASS orb queuing (poll & notify), got %i messages", next_expected_val);
 }
 
+namespace
+{
+/**
+ * Hook of the publication callback test: counts the calls and flags while one is running.
+ */
+class CountingPublicationCallback : public uORB::PublicationCallback
+{
+public:
+	void published(const void *data) override
+	{
+		running = true;
+		last_val = static_cast<const orb_test *>(data)->val;
+
+		if (waiter_woken) {
+			woken_before_hook = true;
+		}
+
+		++calls;
+
+		if (slow) {
+			px4_usleep(1000);
+		}
+
+		running = false;
+	}
+
+	volatile int calls{0};
+	volatile int last_val{-1};
+	volatile bool running{false};
+	volatile bool slow{false};
+
+	volatile bool waiter_woken{false}; /**< set by the poll waiter of the ordering test */
+	volatile bool woken_before_hook{false};
+};
+
+CountingPublicationCallback callback_test_hook;
+}
+
+int uORBTest::UnitTest::sub_test_callback_entry(int argc, char *argv[])
+{
+	uORBTest::UnitTest &t = uORBTest::UnitTest::instance();
+	return t.sub_test_callback_main();
+}
+
+int uORBTest::UnitTest::sub_test_callback_main()
+{
+	int sfd = orb_subscribe(ORB_ID(orb_test_callback));
+	struct orb_test t = {};
+	orb_copy(ORB_ID(orb_test_callback), sfd, &t);
+
+	px4_pollfd_struct_t fds[1] = {};
+	fds[0].fd = sfd;
+	fds[0].events = POLLIN;
+
+	_thread_should_exit = false;
+
+	if (px4_poll(fds, 1, 1000) > 0) {
+		callback_test_hook.waiter_woken = true;
+	}
+
+	orb_unsubscribe(sfd);
+	_thread_should_exit = true;
+	return 0;
+}
+
+int uORBTest::UnitTest::pub_test_callback_entry(int argc, char *argv[])
+{
+	uORBTest::UnitTest &t = uORBTest::UnitTest::instance();
+	return t.pub_test_callback_main();
+}
+
+int uORBTest::UnitTest::pub_test_callback_main()
+{
+	struct orb_test t = {};
+	orb_advert_t ptopic = orb_advertise(ORB_ID(orb_test_callback), &t);
+
+	if (ptopic == nullptr) {
+		_thread_should_exit = true;
+		return test_fail("advertise failed: %d", errno);
+	}
+
+	while (!_thread_should_exit) {
+		++t.val;
+		orb_publish(ORB_ID(orb_test_callback), ptopic, &t);
+		px4_usleep(500);
+	}
+
+	orb_unadvertise(ptopic);
+	return 0;
+}
+
+int uORBTest::UnitTest::test_publication_callback()
+{
+	test_note("Testing publication callback");
+
+	uORB::Manager *manager = uORB::Manager::get_instance();
+	CountingPublicationCallback &hook = callback_test_hook;
+	struct orb_test t = {};
+
+	/* the hook attaches to an existing node, the subscription creates it */
+	int sfd = orb_subscribe(ORB_ID(orb_test_callback));
+
+	if (sfd < 0) {
+		return test_fail("subscribe failed: %d", errno);
+	}
+
+	if (manager->register_callback(ORB_ID(orb_test_callback), 0, &hook) != PX4_OK) {
+		return test_fail("register_callback failed");
+	}
+
+	orb_advert_t ptopic = orb_advertise(ORB_ID(orb_test_callback), &t);
+
+	if (ptopic == nullptr) {
+		return test_fail("advertise failed: %d", errno);
+	}
+
+	/* the hook runs synchronously in the publisher's context */
+	const int calls_advertised = hook.calls;
+	t.val = 42;
+	orb_publish(ORB_ID(orb_test_callback), ptopic, &t);
+
+	if (hook.calls != calls_advertised + 1 || hook.last_val != 42) {
+		return test_fail("hook not called on publish (calls %i, val %i)", hook.calls - calls_advertised, hook.last_val);
+	}
+
+	if (manager->unregister_callback(ORB_ID(orb_test_callback), 0, &hook) != PX4_OK) {
+		return test_fail("unregister_callback failed");
+	}
+
+	t.val = 43;
+	orb_publish(ORB_ID(orb_test_callback), ptopic, &t);
+
+	if (hook.calls != calls_advertised + 1) {
+		return test_fail("hook called after unregister");
+	}
+
+	/* the hook runs before a poll waiter of higher priority than the publisher is woken up */
+	if (manager->register_callback(ORB_ID(orb_test_callback), 0, &hook) != PX4_OK) {
+		return test_fail("register_callback failed");
+	}
+
+	_thread_should_exit = true;
+
+	char *const sub_args[1] = { nullptr };
+	int sub_task = px4_task_spawn_cmd("uorb_test_callback_sub",
+					  SCHED_DEFAULT,
+					  SCHED_PRIORITY_MAX - 1,
+					  1500,
+					  (px4_main_t)&uORBTest::UnitTest::sub_test_callback_entry,
+					  sub_args);
+
+	if (sub_task < 0) {
+		return test_fail("failed launching task");
+	}
+
+	/* the waiter clears the flag once it is subscribed and about to poll */
+	for (int i = 0; i < 1000 && _thread_should_exit; i++) {
+		px4_usleep(1000);
+	}
+
+	px4_usleep(10 * 1000);
+
+	t.val = 44;
+	orb_publish(ORB_ID(orb_test_callback), ptopic, &t);
+
+	for (int i = 0; i < 1000 && !_thread_should_exit; i++) {
+		px4_usleep(1000);
+	}
+
+	manager->unregister_callback(ORB_ID(orb_test_callback), 0, &hook);
+
+	if (!hook.waiter_woken) {
+		return test_fail("poll waiter not woken up");
+	}
+
+	if (hook.woken_before_hook) {
+		return test_fail("poll waiter woken up before the hook ran");
+	}
+
+	orb_unadvertise(ptopic);
+
+	/* unregister from another thread while a publisher runs a slow hook */
+	hook.calls = 0;
+	hook.slow = true;
+
+	if (manager->register_callback(ORB_ID(orb_test_callback), 0, &hook) != PX4_OK) {
+		return test_fail("register_callback failed");
+	}
+
+	_thread_should_exit = false;
+
+	char *const args[1] = { nullptr };
+	int pub_task = px4_task_spawn_cmd("uorb_test_callback",
+					  SCHED_DEFAULT,
+					  SCHED_PRIORITY_MAX - 5,
+					  1500,
+					  (px4_main_t)&uORBTest::UnitTest::pub_test_callback_entry,
+					  args);
+
+	if (pub_task < 0) {
+		return test_fail("failed launching task");
+	}
+
+	for (int i = 0; i < 1000 && hook.calls < 10; i++) {
+		px4_usleep(1000);
+	}
+
+	if (hook.calls < 10) {
+		_thread_should_exit = true;
+		return test_fail("hook not called by the publisher task");
+	}
+
+	manager->unregister_callback(ORB_ID(orb_test_callback), 0, &hook);
+
+	const bool running = hook.running;
+	const int calls = hook.calls;
+	px4_usleep(20 * 1000);
+	_thread_should_exit = true;
+	px4_usleep(20 * 1000);
+
+	if (running) {
+		return test_fail("unregister_callback returned while the hook was running");
+	}
+
+	if (hook.calls != calls) {
+		return test_fail("hook called after unregister (%i calls)", hook.calls - calls);
+	}
+
+	orb_unsubscribe(sfd);
+
+	return test_note("PASS publication callback");
+}
+
+
+#ifndef __PX4_NUTTX
+namespace
+{
+/**
+ * Receive side of the batch test: counts the samples that arrive per topic.
+ */
+class CountingRxHandler : public uORBCommunicator::IChannelRxHandler
+{
+public:
+	int16_t process_remote_topic(const char *topic_name, bool isAdvertisement) override { return 0; }
+	int16_t process_add_subscription(const char *messageName, int32_t msgRateInHz) override { return 0; }
+	int16_t process_remove_subscription(const char *messageName) override { return 0; }
+
+	int16_t process_received_message(const char *messageName, int32_t length, uint8_t *data) override
+	{
+		++by_name;
+		return 0;
+	}
+
+	int16_t process_received_topic(const struct orb_metadata *meta, int32_t length, uint8_t *data) override
+	{
+		if (meta == ORB_ID(sensor_combined)) {
+			++sensor_combined;
+
+		} else if (meta == ORB_ID(vehicle_attitude)) {
+			++vehicle_attitude;
+		}
+
+		return 0;
+	}
+
+	void reset() { by_name = sensor_combined = vehicle_attitude = 0; }
+
+	volatile int by_name{0};
+	volatile int sensor_combined{0};
+	volatile int vehicle_attitude{0};
+};
+}
+
+int uORBTest::UnitTest::batch_test()
+{
+	test_note("---------------- BATCHED TRANSPORT TEST ------------------");
+
+	static constexpr int num_samples = 20000;
+
+	sensor_combined_s sensors{};
+	vehicle_attitude_s attitude{};
+
+	uORB::LoopbackChannel local_end;
+	uORB::LoopbackChannel remote_end;
+	uORB::LoopbackChannel::connect(local_end, remote_end);
+
+	CountingRxHandler receiver;
+
+	/* reference: every publication is sent synchronously by name */
+	remote_end.register_handler(&receiver);
+
+	hrt_abstime start = hrt_absolute_time();
+
+	for (int i = 0; i < num_samples; ++i) {
+		sensors.timestamp = hrt_absolute_time();
+		local_end.send_message((ORB_ID(sensor_combined))->o_name, sizeof(sensors), (uint8_t *)&sensors);
+	}
+
+	const hrt_abstime direct_time = hrt_elapsed_time(&start);
+
+	test_note("direct:  %i samples, %u transport messages, publisher time %.3f us/sample",
+		  receiver.by_name, (unsigned)local_end.data_messages(), (double)direct_time / num_samples);
+
+	if (receiver.by_name != num_samples) {
+		return test_fail("direct: received %i of %i samples", receiver.by_name, num_samples);
+	}
+
+	/* batched: publications are coalesced on the publisher side and unpacked by the remote end */
+	local_end.reset_statistics();
+	receiver.reset();
+
+	uORB::BatchedChannel sender(&local_end, 1000);
+	uORB::BatchedChannel unpacker(&remote_end, 1000);
+
+	/* the remote end only unpacks until it sees the first batch */
+	unpacker.set_auto_start(true);
+
+	if (sender.start() != 0) {
+		return test_fail("failed to start batched channel");
+	}
+
+	sender.register_handler(&receiver); // local rx path is unused in this test
+	unpacker.register_handler(&receiver);
+
+	start = hrt_absolute_time();
+
+	for (int i = 0; i < num_samples; ++i) {
+		sensors.timestamp = hrt_absolute_time();
+		sender.send_topic(ORB_ID(sensor_combined), sizeof(sensors), (uint8_t *)&sensors);
+
+		if (i % 4 == 0) {
+			attitude.timestamp = sensors.timestamp;
+			sender.send_topic(ORB_ID(vehicle_attitude), sizeof(attitude), (uint8_t *)&attitude);
+		}
+
+		if (i % 10 == 0) {
+			/* ~100 kHz publication rate */
+			px4_usleep(100);
+		}
+	}
+
+	const hrt_abstime batched_time = hrt_elapsed_time(&start);
+
+	sender.stop();
+
+	test_note("batched: %i + %i samples, %u transport messages (%llu bytes), publisher time %.3f us/sample",
+		  receiver.sensor_combined, receiver.vehicle_attitude, (unsigned)local_end.data_messages(),
+		  (unsigned long long)local_end.data_bytes(), (double)batched_time / num_samples);
+	sender.print_status();
+
+	if (receiver.sensor_combined == 0 || receiver.vehicle_attitude == 0 || receiver.by_name != 0) {
+		return test_fail("batched: samples missing or not resolved by id");
+	}
+
+	if (local_end.data_messages() >= (unsigned)num_samples) {
+		return test_fail("batched: publications were not coalesced");
+	}
+
+	if (!unpacker.running()) {
+		return test_fail("batched: remote end did not start batching");
+	}
+
+	/* rate limit requested by the remote subscriber */
+	local_end.reset_statistics();
+	receiver.reset();
+
+	static constexpr int rate_hz = 50;
+	static constexpr hrt_abstime duration = 500000;
+
+	if (sender.start() != 0) {
+		return test_fail("failed to restart batched channel");
+	}
+
+	remote_end.add_subscription((ORB_ID(sensor_combined))->o_name, rate_hz);
+
+	start = hrt_absolute_time();
+
+	while (hrt_elapsed_time(&start) < duration) {
+		sensors.timestamp = hrt_absolute_time();
+		sender.send_topic(ORB_ID(sensor_combined), sizeof(sensors), (uint8_t *)&sensors);
+		px4_usleep(1000);
+	}
+
+	sender.stop();
+	unpacker.stop();
+
+	const int expected = rate_hz * duration / 1000000;
+
+	test_note("rate limited: received %i samples at %i Hz over %.1f s", receiver.sensor_combined, rate_hz,
+		  (double)duration / 1e6);
+
+	if (receiver.sensor_combined > expected + 2 || receiver.sensor_combined < expected / 2) {
+		return test_fail("rate limit not honored (received %i, expected ~%i)", receiver.sensor_combined, expected);
+	}
+
+	return test_note("PASS batched transport");
+}
+#endif /* __PX4_NUTTX */
+
+#ifdef __PX4_LINUX
+namespace
+{
+struct ShmClientResult {
+	uint32_t received;
+	uint32_t lost;
+	uint32_t errors;
+};
+
+static void shm_fill_pattern(orb_test_medium &sample)
+{
+	for (unsigned i = 0; i < sizeof(sample.junk); i++) {
+		sample.junk[i] = (char)(sample.val + i);
+	}
+}
+
+static bool shm_check_pattern(const orb_test_medium &sample)
+{
+	for (unsigned i = 0; i < sizeof(sample.junk); i++) {
+		if (sample.junk[i] != (char)(sample.val + i)) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/**
+ * External side of the shm test. It runs in a forked process and must only use the client library.
+ * Every ping is echoed with the measured one-way latency, then a burst is read and the result is
+ * sent back with the echo of the terminating sample (val = -1).
+ */
+static int shm_client_main(const char *segment_name, int num_pings)
+{
+	uORB::ShmClient client;
+
+	if (client.open(segment_name) != 0) {
+		return 1;
+	}
+
+	const struct orb_metadata *medium_meta = ORB_ID(orb_test_medium);
+	const int sub = client.subscribe(medium_meta->o_name, 0, medium_meta->o_size, medium_meta->o_fields);
+	const int pub = client.advertise("orb_test_large", sizeof(orb_test_large));
+
+	if (sub < 0 || pub < 0) {
+		return 2;
+	}
+
+	orb_test_medium medium;
+	orb_test_large large{};
+	ShmClientResult result{};
+	uint64_t write_time_ns = 0;
+
+	// samples published before the subscription are not part of the test
+	while (client.update(sub, medium)) {}
+
+	large.val = -2; // hello
+	client.publish(pub, &large);
+
+	for (int i = 0; i < num_pings; i++) {
+		if (!client.wait(sub, 1000000) || !client.update(sub, medium, &write_time_ns)) {
+			return 3;
+		}
+
+		const uint64_t latency_ns = uORB::shm::monotonic_ns() - write_time_ns;
+
+		if (medium.val != i || !shm_check_pattern(medium)) {
+			++result.errors;
+		}
+
+		large.val = medium.val;
+		large.time = medium.time;
+		memcpy(large.junk, &latency_ns, sizeof(latency_ns));
+		client.publish(pub, &large);
+	}
+
+	int last = num_pings - 1;
+
+	for (;;) {
+		if (!client.wait(sub, 2000000)) {
+			return 4;
+		}
+
+		while (client.update(sub, medium)) {
+			if (medium.val == -1) {
+				result.lost = client.lost(sub);
+				large.val = -1;
+				memcpy(large.junk, &result, sizeof(result));
+				client.publish(pub, &large);
+				return result.errors > 0 ? 5 : 0;
+			}
+
+			// samples can be lost, but never reordered or torn
+			if (medium.val <= last || !shm_check_pattern(medium)) {
+				++result.errors;
+			}
+
+			last = medium.val;
+			++result.received;
+		}
+	}
+}
+}
+
+int uORBTest::UnitTest::shm_test()
+{
+	test_note("---------------- SHARED MEMORY TRANSPORT TEST ------------------");
+
+	static constexpr int num_pings = 1000;
+	static constexpr int num_burst = 100000;
+
+	char segment_name[32];
+	snprintf(segment_name, sizeof(segment_name), "px4_uorb_test_%i", (int)getpid());
+
+	orb_test_medium medium{};
+	orb_advert_t pub = orb_advertise(ORB_ID(orb_test_medium), &medium);
+	int sub = orb_subscribe(ORB_ID(orb_test_large));
+
+	if (pub == nullptr || sub < 0) {
+		return test_fail("advertise/subscribe failed (%i)", errno);
+	}
+
+	uORB::ShmBridge bridge;
+
+	if (bridge.add_export(ORB_ID(orb_test_medium)) != 0 || bridge.add_import(ORB_ID(orb_test_large)) != 0
+	    || bridge.start(segment_name) != 0) {
+		orb_unsubscribe(sub);
+		return test_fail("failed to start the shm bridge");
+	}
+
+	const pid_t child = fork();
+
+	if (child == 0) {
+		_exit(shm_client_main(segment_name, num_pings));
+	}
+
+	if (child < 0) {
+		orb_unsubscribe(sub);
+		return test_fail("fork failed (%i)", errno);
+	}
+
+	orb_test_large large{};
+
+	/* wait for an echo with the given value */
+	auto wait_echo = [&](int val, hrt_abstime timeout) {
+		const hrt_abstime start = hrt_absolute_time();
+		px4_pollfd_struct_t fds[1] {};
+		fds[0].fd = sub;
+		fds[0].events = POLLIN;
+
+		while (hrt_elapsed_time(&start) < timeout) {
+			if (px4_poll(fds, 1, 100) > 0) {
+				orb_copy(ORB_ID(orb_test_large), sub, &large);
+
+				if (large.val == val) {
+					return true;
+				}
+			}
+		}
+
+		return false;
+	};
+
+	int ret = OK;
+
+	if (!wait_echo(-2, 3000000)) {
+		ret = test_fail("client did not connect");
+	}
+
+	/* ping-pong: round trip through the client and the import thread */
+	hrt_abstime rtt_sum = 0;
+	hrt_abstime rtt_max = 0;
+	uint64_t one_way_sum_ns = 0;
+	uint64_t one_way_max_ns = 0;
+
+	for (int i = 0; i < num_pings && ret == OK; i++) {
+		medium.val = i;
+		medium.time = hrt_absolute_time();
+		shm_fill_pattern(medium);
+		orb_publish(ORB_ID(orb_test_medium), pub, &medium);
+
+		if (!wait_echo(i, 1000000)) {
+			ret = test_fail("no echo for ping %i", i);
+			break;
+		}
+
+		const hrt_abstime rtt = hrt_elapsed_time(&medium.time);
+		rtt_sum += rtt;
+
+		if (rtt > rtt_max) {
+			rtt_max = rtt;
+		}
+
+		uint64_t one_way_ns;
+		memcpy(&one_way_ns, large.junk, sizeof(one_way_ns));
+		one_way_sum_ns += one_way_ns;
+
+		if (one_way_ns > one_way_max_ns) {
+			one_way_max_ns = one_way_ns;
+		}
+	}
+
+	if (ret == OK) {
+		test_note("PX4 -> client: mean %.2f us, max %.2f us", (double)one_way_sum_ns / num_pings / 1e3,
+			  (double)one_way_max_ns / 1e3);
+		test_note("round trip: mean %.2f us, max %.2f us", (double)rtt_sum / num_pings, (double)rtt_max);
+
+		/* burst: the client reads concurrently and must never see a torn or reordered sample */
+		const hrt_abstime start = hrt_absolute_time();
+
+		for (int i = 0; i < num_burst; i++) {
+			medium.val = num_pings + i;
+			shm_fill_pattern(medium);
+			orb_publish(ORB_ID(orb_test_medium), pub, &medium);
+		}
+
+		const hrt_abstime burst_time = hrt_elapsed_time(&start);
+
+		medium.val = -1;
+		orb_publish(ORB_ID(orb_test_medium), pub, &medium);
+
+		if (!wait_echo(-1, 3000000)) {
+			ret = test_fail("no result from the client");
+
+		} else {
+			ShmClientResult result;
+			memcpy(&result, large.junk, sizeof(result));
+
+			test_note("burst: %i samples in %.3f us/sample, client received %u, lost %u, errors %u", num_burst,
+				  (double)burst_time / num_burst, result.received, result.lost, result.errors);
+
+			if (result.errors > 0 || result.received + result.lost != (uint32_t)num_burst) {
+				ret = test_fail("client saw inconsistent samples");
+			}
+		}
+	}
+
+	bridge.print_status();
+
+	/* collect the client */
+	int status = -1;
+	const hrt_abstime start = hrt_absolute_time();
+
+	while (waitpid(child, &status, WNOHANG) == 0) {
+		if (hrt_elapsed_time(&start) > 3000000) {
+			kill(child, SIGKILL);
+			waitpid(child, &status, 0);
+			break;
+		}
+
+		px4_usleep(10000);
+	}
+
+	bridge.stop();
+	orb_unsubscribe(sub);
+
+	if (ret == OK && (!WIFEXITED(status) || WEXITSTATUS(status) != 0)) {
+		ret = test_fail("client failed (status %i)", status);
+	}
+
+	return ret == OK ? test_note("PASS shared-memory transport") : ret;
+}
+#endif /* __PX4_LINUX */
 
 int uORBTest::UnitTest::test_fail(const char *fmt, ...)
 {
@@ -45,6 +45,7 @@ struct orb_test {
 };
 ORB_DECLARE(orb_test);
 ORB_DECLARE(orb_multitest);
+ORB_DECLARE(orb_test_callback);
 
 
 struct orb_test_medium {
@@ -81,6 +82,21 @@ public:
 	template<typename S> int latency_test(orb_id_t T, bool print);
 	int info();
 
+#ifndef __PX4_NUTTX
+	/**
+	 * Throughput and rate limiting test of the batched multi-ORB transport
+	 * over an in-process loopback channel.
+	 */
+	int batch_test();
+#endif
+
+#ifdef __PX4_LINUX
+	/**
+	 * Publish/subscribe through the shared-memory bridge with a forked client process.
+	 */
+	int shm_test();
+#endif
+
 private:
 	UnitTest() : pubsubtest_passed(false), pubsubtest_print(false) {}
 
@@ -117,6 +133,13 @@ private:
 	int test_queue_poll_notify();
 	volatile int _num_messages_sent = 0;
 
+	/* publication callback (hook) test */
+	int test_publication_callback();
+	static int pub_test_callback_entry(int argc, char *argv[]);
+	int pub_test_callback_main();
+	static int sub_test_callback_entry(int argc, char *argv[]);
+	int sub_test_callback_main();
+
 	int test_fail(const char *fmt, ...);
 	int test_note(const char *fmt, ...);
 };
@@ -44,7 +44,7 @@ extern "C" { __EXPORT int uorb_tests_main(int argc, char *argv[]); }
 
 static void usage()
 {
-	PX4_INFO("Usage: uorb_tests [latency_test]");
+	PX4_INFO("Usage: uorb_tests [latency_test|batch_test|shm_test]");
 }
 
 int
@@ -90,6 +90,26 @@ uorb_tests_main(int argc, char *argv[])
 		}
 	}
 
+#ifndef __PX4_NUTTX
+
+	/*
+	 * Test the batched multi-ORB transport.
+	 */
+	if (argc > 1 && !strcmp(argv[1], "batch_test")) {
+		return uORBTest::UnitTest::instance().batch_test();
+	}
+
+#endif
+#ifdef __PX4_LINUX
+
+	/*
+	 * Test the shared-memory transport to external processes.
+	 */
+	if (argc > 1 && !strcmp(argv[1], "shm_test")) {
+		return uORBTest::UnitTest::instance().shm_test();
+	}
+
+#endif
 #endif
 
 	usage();
@@ -397,6 +397,7 @@ void Standard::fill_actuator_outputs()
 	// multirotor controls
 	_actuators_out_0->timestamp = hrt_absolute_time();
 	_actuators_out_0->timestamp_sample = _actuators_mc_in->timestamp_sample;
+	_actuators_out_0->estimator_latency = _actuators_mc_in->estimator_latency;
 
 	// roll
 	_actuators_out_0->control[actuator_controls_s::INDEX_ROLL] =
@@ -415,6 +416,7 @@ void Standard::fill_actuator_outputs()
 	// fixed wing controls
 	_actuators_out_1->timestamp = hrt_absolute_time();
 	_actuators_out_1->timestamp_sample = _actuators_fw_in->timestamp_sample;
+	_actuators_out_1->estimator_latency = _actuators_fw_in->estimator_latency;
 
 	if (_vtol_schedule.flight_mode != MC_MODE) {
 		// roll
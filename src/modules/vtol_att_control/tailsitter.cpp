@@ -308,10 +308,12 @@ void Tailsitter::fill_actuator_outputs()
 =======
 	_actuators_out_0->timestamp = hrt_absolute_time();
 	_actuators_out_0->timestamp_sample = _actuators_mc_in->timestamp_sample;
+	_actuators_out_0->estimator_latency = _actuators_mc_in->estimator_latency;
 >>>>>>> upstream/master
 
 	_actuators_out_1->timestamp = hrt_absolute_time();
 	_actuators_out_1->timestamp_sample = _actuators_fw_in->timestamp_sample;
+	_actuators_out_1->estimator_latency = _actuators_fw_in->estimator_latency;
 
 	_actuators_out_0->control[actuator_controls_s::INDEX_ROLL] = _actuators_mc_in->control[actuator_controls_s::INDEX_ROLL]
 			* _mc_roll_weight;
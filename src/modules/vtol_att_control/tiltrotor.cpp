@@ -336,6 +336,7 @@ void Tiltrotor::fill_actuator_outputs()
 {
 	_actuators_out_0->timestamp = hrt_absolute_time();
 	_actuators_out_0->timestamp_sample = _actuators_mc_in->timestamp_sample;
+	_actuators_out_0->estimator_latency = _actuators_mc_in->estimator_latency;
 
 	_actuators_out_0->control[actuator_controls_s::INDEX_ROLL] = _actuators_mc_in->control[actuator_controls_s::INDEX_ROLL]
 			* _mc_roll_weight;
@@ -361,6 +362,7 @@ void Tiltrotor::fill_actuator_outputs()
 
 	_actuators_out_1->timestamp = hrt_absolute_time();
 	_actuators_out_1->timestamp_sample = _actuators_fw_in->timestamp_sample;
+	_actuators_out_1->estimator_latency = _actuators_fw_in->estimator_latency;
 
 	_actuators_out_1->control[actuator_controls_s::INDEX_ROLL] =
 		-_actuators_fw_in->control[actuator_controls_s::INDEX_ROLL];
@@ -43,6 +43,7 @@
 #pragma once
 
 #include <stdbool.h>
+#include <stdint.h>
 
 #ifdef __PX4_ROS
 
@@ -185,6 +186,30 @@ __EXPORT bool px4_task_is_running(const char *taskname);
 #ifdef __PX4_POSIX
 /** set process (and thread) options */
 __EXPORT int px4_prctl(int option, const char *arg2, px4_task_t pid);
+
+/** Scheduling statistics of a single thread of the process */
+typedef struct {
+	int tid;			///< kernel thread id
+	px4_task_t task;		///< px4 task id, -1 if the thread was not started with px4_task_spawn_cmd()
+	char name[16];
+	char state;			///< 'R' running/ready, 'S' sleeping, 'D' uninterruptible, ...
+	int priority;			///< realtime priority, 0 for non-realtime threads
+	uint64_t run_time;		///< [us] time spent running on a CPU
+	uint64_t wait_time;		///< [us] time spent ready to run, waiting for a CPU (0 if unavailable)
+	uint64_t timeslices;		///< number of times the thread was scheduled in (0 if unavailable)
+	uint64_t voluntary_switches;	///< number of times the thread blocked (and was woken up again)
+	uint64_t involuntary_switches;	///< number of times the thread was preempted
+} px4_task_stats_t;
+
+/**
+ * Get the scheduling statistics of all threads of the process.
+ * @param stats array to fill
+ * @param max_count size of stats
+ * @return number of threads filled in, or <0 on error (-ENOSYS if not supported on this platform).
+ *         If the process has more than max_count threads, stats holds the first max_count of them and the
+ *         total number of threads is returned (> max_count), so the caller can retry with a larger array.
+ */
+__EXPORT int px4_task_get_stats(px4_task_stats_t *stats, int max_count);
 #endif
 
 /** return the name of the current task */
@@ -39,6 +39,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <fcntl.h>
 #include <unistd.h>
 
@@ -50,11 +51,32 @@
 
 #include <drivers/drv_hrt.h>
 
+/** write latency histogram with 4 logarithmic buckets per power of 2, up to ~134s */
+#define LATENCY_BUCKETS 104
+
+struct latency_s {
+	uint32_t histogram[LATENCY_BUCKETS];
+	uint32_t count;
+	uint32_t max; ///< [us]
+};
+
 static void	usage(void);
 
 /** sequential write speed test */
 static void	write_test(int fd, uint8_t *block, int block_size);
 
+/**
+ * Write pattern of the logger (LogWriterFile): data is produced at a fixed rate into a ring buffer,
+ * all available data is written once at least 4 KiB are available, and fsync is called periodically.
+ */
+static void	logger_pattern_test(int fd, uint8_t *block);
+
+/** replay the writes and fsyncs of a trace file with their original timing */
+static void	trace_test(int fd, uint8_t *block, const char *trace_file);
+
+/** sequential writes for a range of block sizes and fsync intervals */
+static void	sweep_test(uint8_t *block);
+
 /**
  * Measure the time for fsync.
  * @param fd
@@ -62,24 +84,66 @@ static void	write_test(int fd, uint8_t *block, int block_size);
  */
 static inline unsigned int time_fsync(int fd);
 
+/**
+ * Measure the time for fsync, and add it to the latency statistics.
+ * @param fd
+ * @return time in us
+ */
+static uint32_t time_fsync_us(int fd, struct latency_s *latency);
+
+/**
+ * Print the buffer size the logger needs to bridge the worst-case latency at a given logging rate.
+ */
+static void	recommend(double rate_kbs, uint32_t worst_latency_us);
+
+static void	latency_reset(struct latency_s *latency);
+static void	latency_add(struct latency_s *latency, uint32_t us);
+static uint32_t	latency_percentile(const struct latency_s *latency, double percentile);
+static void	latency_print(const char *name, const struct latency_s *latency);
+
 __EXPORT int	sd_bench_main(int argc, char *argv[]);
 
 static const char *BENCHMARK_FILE = PX4_STORAGEDIR"/benchmark.tmp";
 
+static const int LOGGER_MIN_WRITE_CHUNK = 4096; ///< LogWriterFile::_min_write_chunk
+
+static const int sweep_block_sizes[] = {1024, 2048, 4096, 8192, 16384};
+static const int sweep_fsync_intervals[] = {0, 1000, 100}; ///< [ms], 0: at the end of the run only
+
 static int num_runs; ///< number of runs
 static int run_duration; ///< duration of a single run [ms]
 static bool synchronized; ///< call fsync after each block?
+static int logger_rate; ///< logging rate to simulate [KB/s]
+static int logger_buffer; ///< logger buffer size [KiB]
+static int fsync_interval; ///< fsync interval of the logger pattern [ms]
+
+static struct latency_s write_latency;
+static struct latency_s fsync_latency;
 
 static void
 usage()
 {
-	PRINT_MODULE_DESCRIPTION("Test the speed of an SD Card");
+	PRINT_MODULE_DESCRIPTION("Test the speed of an SD Card\n"
+				 "\n"
+				 "By default a fixed block size is written sequentially. To qualify a storage medium for logging, "
+				 "use the logger's write pattern (-p), replay a recorded write trace (-t) or sweep block size and "
+				 "fsync interval (-S). These report write and fsync latency percentiles, and recommend the logger "
+				 "buffer size (logger -b, set with LOGGER_BUF in the startup script).\n"
+				 "\n"
+				 "The trace file lists one write per line as '<timestamp in us> <size in bytes>', with size 0 for "
+				 "an fsync. Lines starting with '#' are ignored. Such a trace can for example be extracted from "
+				 "'strace -ttt -e trace=write,fsync' of the logger on Linux.");
 
 	PRINT_MODULE_USAGE_NAME_SIMPLE("sd_bench", "command");
 	PRINT_MODULE_USAGE_PARAM_INT('b', 4096, 1, 1000000, "Block size for each read/write", true);
 	PRINT_MODULE_USAGE_PARAM_INT('r', 5, 1, 1000, "Number of runs", true);
 	PRINT_MODULE_USAGE_PARAM_INT('d', 2000, 1, 100000, "Duration of a run in ms", true);
 	PRINT_MODULE_USAGE_PARAM_FLAG('s', "Call fsync after each block (default=at end of each run)", true);
+	PRINT_MODULE_USAGE_PARAM_INT('p', 0, 1, 100000, "Simulate the logger's write pattern at this rate in KB/s (as shown by 'logger status')", true);
+	PRINT_MODULE_USAGE_PARAM_INT('B', 12, 4, 10000, "Logger buffer size in KiB (with -p)", true);
+	PRINT_MODULE_USAGE_PARAM_INT('f', 1000, 1, 100000, "fsync interval in ms (with -p)", true);
+	PRINT_MODULE_USAGE_PARAM_STRING('t', NULL, "<file>", "Replay the write pattern of a trace file", true);
+	PRINT_MODULE_USAGE_PARAM_FLAG('S', "Sweep block size and fsync interval", true);
 }
 
 int
@@ -89,11 +153,16 @@ sd_bench_main(int argc, char *argv[])
 	int myoptind = 1;
 	int ch;
 	const char *myoptarg = NULL;
+	const char *trace_file = NULL;
+	bool sweep = false;
 	synchronized = false;
 	num_runs = 5;
 	run_duration = 2000;
+	logger_rate = 0;
+	logger_buffer = 12;
+	fsync_interval = 1000;
 
-	while ((ch = px4_getopt(argc, argv, "b:r:d:s", &myoptind, &myoptarg)) != EOF) {
+	while ((ch = px4_getopt(argc, argv, "b:r:d:sp:B:f:t:S", &myoptind, &myoptarg)) != EOF) {
 		switch (ch) {
 		case 'b':
 			block_size = strtol(myoptarg, NULL, 0);
@@ -111,6 +180,26 @@ sd_bench_main(int argc, char *argv[])
 			synchronized = true;
 			break;
 
+		case 'p':
+			logger_rate = strtol(myoptarg, NULL, 0);
+			break;
+
+		case 'B':
+			logger_buffer = strtol(myoptarg, NULL, 0);
+			break;
+
+		case 'f':
+			fsync_interval = strtol(myoptarg, NULL, 0);
+			break;
+
+		case 't':
+			trace_file = myoptarg;
+			break;
+
+		case 'S':
+			sweep = true;
+			break;
+
 		default:
 			usage();
 			return -1;
@@ -118,16 +207,22 @@ sd_bench_main(int argc, char *argv[])
 		}
 	}
 
-	if (block_size <= 0 || num_runs <= 0) {
+	if (block_size <= 0 || num_runs <= 0 || logger_rate < 0 || logger_buffer * 1024 < LOGGER_MIN_WRITE_CHUNK
+	    || fsync_interval <= 0) {
 		PX4_ERR("invalid argument");
 		return -1;
 	}
 
-	int bench_fd = open(BENCHMARK_FILE, O_CREAT | O_WRONLY | O_TRUNC, PX4_O_MODE_666);
+	if (logger_rate > 0) {
+		// the logger writes at most the whole buffer at once
+		block_size = logger_buffer * 1024;
 
-	if (bench_fd < 0) {
-		PX4_ERR("Can't open benchmark file %s", BENCHMARK_FILE);
-		return -1;
+	} else if (trace_file) {
+		// writes larger than the block are split
+		block_size = 16384;
+
+	} else if (sweep) {
+		block_size = sweep_block_sizes[sizeof(sweep_block_sizes) / sizeof(sweep_block_sizes[0]) - 1];
 	}
 
 	//create some data block
@@ -135,7 +230,6 @@ sd_bench_main(int argc, char *argv[])
 
 	if (!block) {
 		PX4_ERR("Failed to allocate memory block");
-		close(bench_fd);
 		return -1;
 	}
 
@@ -143,8 +237,32 @@ sd_bench_main(int argc, char *argv[])
 		block[i] = (uint8_t)i;
 	}
 
-	PX4_INFO("Using block size = %i bytes, sync=%i", block_size, (int)synchronized);
-	write_test(bench_fd, block, block_size);
+	if (sweep) {
+		// opens the file for each configuration
+		sweep_test(block);
+		free(block);
+		return 0;
+	}
+
+	int bench_fd = open(BENCHMARK_FILE, O_CREAT | O_WRONLY | O_TRUNC, PX4_O_MODE_666);
+
+	if (bench_fd < 0) {
+		PX4_ERR("Can't open benchmark file %s", BENCHMARK_FILE);
+		free(block);
+		return -1;
+	}
+
+	if (logger_rate > 0) {
+		PX4_INFO("Logger pattern: %i KB/s, buffer = %i KiB, fsync every %i ms", logger_rate, logger_buffer, fsync_interval);
+		logger_pattern_test(bench_fd, block);
+
+	} else if (trace_file) {
+		trace_test(bench_fd, block, trace_file);
+
+	} else {
+		PX4_INFO("Using block size = %i bytes, sync=%i", block_size, (int)synchronized);
+		write_test(bench_fd, block, block_size);
+	}
 
 	free(block);
 	close(bench_fd);
@@ -153,6 +271,67 @@ sd_bench_main(int argc, char *argv[])
 	return 0;
 }
 
+void latency_reset(struct latency_s *latency)
+{
+	memset(latency, 0, sizeof(*latency));
+}
+
+static unsigned latency_bucket(uint32_t us)
+{
+	if (us < 4) {
+		return us;
+	}
+
+	const unsigned msb = 31 - __builtin_clz(us);
+	const unsigned bucket = (msb - 1) * 4 + ((us >> (msb - 2)) & 3);
+
+	return bucket < LATENCY_BUCKETS ? bucket : LATENCY_BUCKETS - 1;
+}
+
+/** largest value in a bucket [us] */
+static uint32_t latency_bucket_max(unsigned bucket)
+{
+	if (bucket < 4) {
+		return bucket;
+	}
+
+	return ((5 + bucket % 4) << (bucket / 4 - 1)) - 1;
+}
+
+void latency_add(struct latency_s *latency, uint32_t us)
+{
+	latency->histogram[latency_bucket(us)]++;
+	latency->count++;
+
+	if (us > latency->max) {
+		latency->max = us;
+	}
+}
+
+uint32_t latency_percentile(const struct latency_s *latency, double percentile)
+{
+	const double threshold = latency->count * percentile / 100.;
+	uint32_t sum = 0;
+
+	for (unsigned i = 0; i < LATENCY_BUCKETS; ++i) {
+		sum += latency->histogram[i];
+
+		if (sum > 0 && sum >= threshold) {
+			const uint32_t bucket_max = latency_bucket_max(i);
+			return bucket_max < latency->max ? bucket_max : latency->max;
+		}
+	}
+
+	return latency->max;
+}
+
+void latency_print(const char *name, const struct latency_s *latency)
+{
+	PX4_INFO("  %s latency: p50 %.2lf ms, p99 %.2lf ms, p99.9 %.2lf ms, max %.2lf ms (%u samples)", name,
+		 latency_percentile(latency, 50.) / 1000., latency_percentile(latency, 99.) / 1000.,
+		 latency_percentile(latency, 99.9) / 1000., latency->max / 1000., latency->count);
+}
+
 unsigned int time_fsync(int fd)
 {
 	hrt_abstime fsync_start = hrt_absolute_time();
@@ -160,12 +339,37 @@ unsigned int time_fsync(int fd)
 	return hrt_elapsed_time(&fsync_start) / 1000;
 }
 
+uint32_t time_fsync_us(int fd, struct latency_s *latency)
+{
+	hrt_abstime fsync_start = hrt_absolute_time();
+	fsync(fd);
+	uint32_t fsync_time = hrt_elapsed_time(&fsync_start);
+	latency_add(latency, fsync_time);
+	return fsync_time;
+}
+
+void recommend(double rate_kbs, uint32_t worst_latency_us)
+{
+	// the buffer has to take all data logged while a write or fsync blocks, plus the minimum write chunk,
+	// with a margin of 50%
+	const double needed = rate_kbs * 1024. * worst_latency_us / 1e6 * 1.5 + LOGGER_MIN_WRITE_CHUNK;
+	int buffer_kib = (int)(needed / 1024.) + 1;
+
+	if (buffer_kib < 12) {
+		buffer_kib = 12;
+	}
+
+	PX4_INFO("  Logger buffer for %.0lf KB/s: >= %i KiB (set LOGGER_BUF or logger start -b %i)",
+		 rate_kbs, buffer_kib, buffer_kib);
+}
+
 void write_test(int fd, uint8_t *block, int block_size)
 {
 	PX4_INFO("");
 	PX4_INFO("Testing Sequential Write Speed...");
 	double total_elapsed = 0.;
 	unsigned int total_blocks = 0;
+	latency_reset(&write_latency);
 
 	for (int run = 0; run < num_runs; ++run) {
 		hrt_abstime start = hrt_absolute_time();
@@ -177,7 +381,9 @@ void write_test(int fd, uint8_t *block, int block_size)
 
 			hrt_abstime write_start = hrt_absolute_time();
 			size_t written = write(fd, block, block_size);
-			unsigned int write_time = hrt_elapsed_time(&write_start) / 1000;
+			uint32_t write_time_us = hrt_elapsed_time(&write_start);
+			unsigned int write_time = write_time_us / 1000;
+			latency_add(&write_latency, write_time_us);
 
 			if (write_time > max_write_time) {
 				max_write_time = write_time;
@@ -211,4 +417,287 @@ void write_test(int fd, uint8_t *block, int block_size)
 	}
 
 	PX4_INFO("  Avg   : %8.2lf KB/s", (double)block_size * total_blocks / total_elapsed / 1024.);
+	latency_print("Write", &write_latency);
+}
+
+void logger_pattern_test(int fd, uint8_t *block)
+{
+	PX4_INFO("");
+	PX4_INFO("Testing Logger Write Pattern...");
+	const uint32_t buffer_size = logger_buffer * 1024;
+	const double rate = logger_rate * 1024.; // [B/s]
+	double total_elapsed = 0.;
+	uint64_t total_written = 0;
+	unsigned total_dropouts = 0;
+	latency_reset(&write_latency);
+	latency_reset(&fsync_latency);
+
+	for (int run = 0; run < num_runs; ++run) {
+		hrt_abstime start = hrt_absolute_time();
+		hrt_abstime last_fsync = start;
+		uint64_t written = 0;
+		uint64_t dropped = 0;
+		uint32_t high_water = 0;
+		unsigned dropouts = 0;
+		bool in_dropout = false;
+
+		while ((int64_t)hrt_elapsed_time(&start) < run_duration * 1000) {
+			const hrt_abstime now = hrt_absolute_time();
+
+			// data produced since the start that did not fit into the buffer is dropped
+			const uint64_t produced = (uint64_t)(rate * (now - start) / 1e6);
+			uint64_t fill = produced - dropped - written;
+
+			if (fill > buffer_size) {
+				dropped += fill - buffer_size;
+				fill = buffer_size;
+
+				if (!in_dropout) {
+					++dropouts;
+					in_dropout = true;
+				}
+
+			} else {
+				in_dropout = false;
+			}
+
+			if (fill > high_water) {
+				high_water = fill;
+			}
+
+			const bool call_fsync = now - last_fsync >= (hrt_abstime)fsync_interval * 1000;
+
+			if (call_fsync) {
+				last_fsync = now;
+			}
+
+			if (fill >= (uint64_t)LOGGER_MIN_WRITE_CHUNK) {
+				// write up to the end of the ring buffer, as the logger does
+				const uint32_t to_end = buffer_size - written % buffer_size;
+				const uint32_t size = fill < to_end ? fill : to_end;
+
+				hrt_abstime write_start = hrt_absolute_time();
+				ssize_t ret = write(fd, block, size);
+				latency_add(&write_latency, hrt_elapsed_time(&write_start));
+
+				if (ret != (ssize_t)size) {
+					PX4_ERR("Write error");
+					return;
+				}
+
+				written += size;
+
+				if (call_fsync) {
+					time_fsync_us(fd, &fsync_latency);
+				}
+
+			} else {
+				if (call_fsync) {
+					time_fsync_us(fd, &fsync_latency);
+				}
+
+				px4_usleep(1000);
+			}
+		}
+
+		time_fsync_us(fd, &fsync_latency);
+
+		double elapsed = hrt_elapsed_time(&start) / 1.e6;
+		PX4_INFO("  Run %2i: %8.2lf KB/s written, %u dropouts (%.1lf KB lost), buffer high water: %.1lf KiB", run,
+			 written / elapsed / 1024., dropouts, dropped / 1024., high_water / 1024.);
+
+		total_elapsed += elapsed;
+		total_written += written;
+		total_dropouts += dropouts;
+	}
+
+	PX4_INFO("  Avg   : %8.2lf KB/s written, %u dropouts", total_written / total_elapsed / 1024., total_dropouts);
+	latency_print("Write", &write_latency);
+	latency_print("fsync", &fsync_latency);
+
+	PX4_INFO("Recommendation:");
+
+	if (total_dropouts > 0) {
+		PX4_WARN("  Dropouts at %i KB/s: increase the buffer or reduce the logged data (SDLOG_PROFILE)", logger_rate);
+	}
+
+	const uint32_t worst = write_latency.max > fsync_latency.max ? write_latency.max : fsync_latency.max;
+	recommend(logger_rate, worst);
+}
+
+void trace_test(int fd, uint8_t *block, const char *trace_file)
+{
+	const int block_size = 16384;
+
+	FILE *trace = fopen(trace_file, "r");
+
+	if (!trace) {
+		PX4_ERR("Can't open trace file %s", trace_file);
+		return;
+	}
+
+	PX4_INFO("");
+	PX4_INFO("Replaying %s...", trace_file);
+	latency_reset(&write_latency);
+	latency_reset(&fsync_latency);
+
+	char line[64];
+	bool first = true;
+	uint64_t first_timestamp = 0;
+	uint64_t last_timestamp = 0;
+	uint64_t total_written = 0;
+	uint32_t max_lag = 0; // [us] how far the replay fell behind the trace
+	unsigned num_writes = 0;
+	hrt_abstime start = hrt_absolute_time();
+
+	while (fgets(line, sizeof(line), trace)) {
+		unsigned long long timestamp;
+		unsigned size;
+
+		if (line[0] == '#' || sscanf(line, "%llu %u", &timestamp, &size) != 2) {
+			continue;
+		}
+
+		if (first) {
+			first_timestamp = timestamp;
+			first = false;
+		}
+
+		if (timestamp < last_timestamp) {
+			PX4_ERR("trace is not ordered by time");
+			break;
+		}
+
+		last_timestamp = timestamp;
+
+		// wait until the write is due, or record how late it is
+		const hrt_abstime due = start + (timestamp - first_timestamp);
+		const hrt_abstime now = hrt_absolute_time();
+
+		if (now < due) {
+			px4_usleep(due - now);
+
+		} else if (now - due > max_lag) {
+			max_lag = now - due;
+		}
+
+		if (size == 0) {
+			time_fsync_us(fd, &fsync_latency);
+			continue;
+		}
+
+		while (size > 0) {
+			const unsigned chunk = size < (unsigned)block_size ? size : (unsigned)block_size;
+
+			hrt_abstime write_start = hrt_absolute_time();
+			ssize_t ret = write(fd, block, chunk);
+			latency_add(&write_latency, hrt_elapsed_time(&write_start));
+
+			if (ret != (ssize_t)chunk) {
+				PX4_ERR("Write error");
+				fclose(trace);
+				return;
+			}
+
+			size -= chunk;
+			total_written += chunk;
+		}
+
+		++num_writes;
+	}
+
+	fclose(trace);
+	time_fsync_us(fd, &fsync_latency);
+
+	const double duration = (last_timestamp - first_timestamp) / 1e6;
+	const double elapsed = hrt_elapsed_time(&start) / 1.e6;
+	const double rate = duration > 0. ? total_written / duration / 1024. : 0.;
+
+	PX4_INFO("  %u writes, %.1lf KB in %.2lf s (trace: %.2lf s, %.2lf KB/s), max. lag: %.2lf ms", num_writes,
+		 total_written / 1024., elapsed, duration, rate, max_lag / 1000.);
+	latency_print("Write", &write_latency);
+	latency_print("fsync", &fsync_latency);
+
+	PX4_INFO("Recommendation:");
+
+	if (elapsed > duration * 1.05 + 1.) {
+		PX4_WARN("  Replay took longer than the trace: storage too slow, reduce the logged data (SDLOG_PROFILE)");
+	}
+
+	const uint32_t worst = write_latency.max > fsync_latency.max ? write_latency.max : fsync_latency.max;
+	recommend(rate, worst > max_lag ? worst : max_lag);
+}
+
+void sweep_test(uint8_t *block)
+{
+	PX4_INFO("");
+	PX4_INFO("Sweeping Block Size and fsync Interval...");
+	PX4_INFO("  %6s %6s %9s %10s %10s %10s %10s", "block", "fsync", "KB/s", "p99 [ms]", "p99.9 [ms]", "max [ms]",
+		 "fsync [ms]");
+
+	double logger_throughput = 0.;
+	uint32_t logger_worst = 0;
+
+	for (unsigned i = 0; i < sizeof(sweep_block_sizes) / sizeof(sweep_block_sizes[0]); ++i) {
+		for (unsigned j = 0; j < sizeof(sweep_fsync_intervals) / sizeof(sweep_fsync_intervals[0]); ++j) {
+			const int block_size = sweep_block_sizes[i];
+			const int interval = sweep_fsync_intervals[j];
+
+			// start each configuration on an empty file
+			int fd = open(BENCHMARK_FILE, O_CREAT | O_WRONLY | O_TRUNC, PX4_O_MODE_666);
+
+			if (fd < 0) {
+				PX4_ERR("Can't open benchmark file %s", BENCHMARK_FILE);
+				return;
+			}
+
+			latency_reset(&write_latency);
+			latency_reset(&fsync_latency);
+
+			hrt_abstime start = hrt_absolute_time();
+			hrt_abstime last_fsync = start;
+			uint64_t written = 0;
+
+			while ((int64_t)hrt_elapsed_time(&start) < run_duration * 1000) {
+				hrt_abstime write_start = hrt_absolute_time();
+				ssize_t ret = write(fd, block, block_size);
+				latency_add(&write_latency, hrt_elapsed_time(&write_start));
+
+				if (ret != block_size) {
+					PX4_ERR("Write error");
+					close(fd);
+					unlink(BENCHMARK_FILE);
+					return;
+				}
+
+				written += block_size;
+
+				if (interval > 0 && hrt_elapsed_time(&last_fsync) >= (hrt_abstime)interval * 1000) {
+					last_fsync = hrt_absolute_time();
+					time_fsync_us(fd, &fsync_latency);
+				}
+			}
+
+			time_fsync_us(fd, &fsync_latency);
+			close(fd);
+
+			const double throughput = written / (hrt_elapsed_time(&start) / 1.e6) / 1024.;
+			PX4_INFO("  %6i %6i %9.1lf %10.2lf %10.2lf %10.2lf %10.2lf", block_size, interval, throughput,
+				 latency_percentile(&write_latency, 99.) / 1000., latency_percentile(&write_latency, 99.9) / 1000.,
+				 write_latency.max / 1000., fsync_latency.max / 1000.);
+
+			if (block_size == LOGGER_MIN_WRITE_CHUNK && interval == 1000) {
+				logger_throughput = throughput;
+				logger_worst = write_latency.max > fsync_latency.max ? write_latency.max : fsync_latency.max;
+			}
+		}
+	}
+
+	unlink(BENCHMARK_FILE);
+
+	// the logger writes chunks of at least 4 KiB and calls fsync every second
+	PX4_INFO("Recommendation:");
+	PX4_INFO("  Keep the logging rate below %.0lf KB/s (50%% of the throughput with the logger's write pattern)",
+		 logger_throughput / 2.);
+	recommend(logger_throughput / 2., logger_worst);
 }
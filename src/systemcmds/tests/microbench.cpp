@@ -0,0 +1,95 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2018 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+/**
+ * @file microbench.cpp
+ */
+
+#include "microbench.h"
+
+#include <stdio.h>
+
+namespace microbench
+{
+
+static FILE *report_file = nullptr;
+static const char *report_suite_name = "";
+static bool report_first = true;
+
+int report_open(const char *path)
+{
+	report_close();
+
+	report_file = fopen(path, "w");
+
+	if (report_file == nullptr) {
+		return -1;
+	}
+
+	fprintf(report_file, "{\n\"benchmarks\": [\n");
+	report_first = true;
+
+	return 0;
+}
+
+void report_close()
+{
+	if (report_file == nullptr) {
+		return;
+	}
+
+	fprintf(report_file, "\n]\n}\n");
+	fclose(report_file);
+	report_file = nullptr;
+}
+
+void report_suite(const char *suite)
+{
+	report_suite_name = suite;
+}
+
+void report(const char *name, perf_counter_t p)
+{
+	if (report_file == nullptr) {
+		return;
+	}
+
+	fprintf(report_file, "%s{\"suite\": \"%s\", \"name\": \"%s\", \"count\": %llu, \"mean_us\": %.4f}",
+		report_first ? "" : ",\n", report_suite_name, name,
+		(unsigned long long)perf_event_count(p), (double)(perf_mean(p) * 1e6f));
+
+	report_first = false;
+}
+
+} // namespace microbench
@@ -0,0 +1,99 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2018 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+/**
+ * @file microbench.h
+ *
+ * Machine-readable results of the microbenchmarks.
+ */
+
+#pragma once
+
+#include <perf/perf_counter.h>
+#include <px4_time.h>
+
+/**
+ * Time count runs of op, print the statistics and record them in the report.
+ *
+ * Expects lock(), unlock() and reset() in the calling scope: lock()/unlock()
+ * enclose each single measurement, reset() restores the state between the runs.
+ */
+#define PERF(name, op, count) do { \
+		px4_usleep(1000); \
+		reset(); \
+		perf_counter_t p = perf_alloc(PC_ELAPSED, name); \
+		for (int i = 0; i < count; i++) { \
+			lock(); \
+			perf_begin(p); \
+			op; \
+			perf_end(p); \
+			unlock(); \
+			reset(); \
+		} \
+		perf_print_counter(p); \
+		microbench::report(name, p); \
+		perf_free(p); \
+	} while (0)
+
+namespace microbench
+{
+
+/**
+ * Write the results of all following benchmarks to a JSON file,
+ * until report_close() is called.
+ *
+ * @param path	output file
+ * @return	0 on success
+ */
+int report_open(const char *path);
+
+/**
+ * Finish and close the JSON file.
+ */
+void report_close();
+
+/**
+ * Set the suite name the following results are listed under.
+ */
+void report_suite(const char *suite);
+
+/**
+ * Record the result of one benchmark, does nothing without an open report.
+ *
+ * @param name	benchmark name
+ * @param p	PC_ELAPSED counter holding one sample per iteration
+ */
+void report(const char *name, perf_counter_t p);
+
+} // namespace microbench
@@ -0,0 +1,93 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2018 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+/**
+ * @file test_microbench.cpp
+ *
+ * Run all microbenchmarks, optionally writing the results to a JSON file
+ * for comparison against a baseline (see Tools/microbench_compare.py).
+ */
+
+#include <px4_config.h>
+#include <px4_log.h>
+
+#include "microbench.h"
+#include "tests_main.h"
+
+static const struct {
+	const char *name;
+	int (*fn)(int argc, char *argv[]);
+} suites[] = {
+	{"covariance",	test_microbench_covariance},
+	{"dataman",	test_microbench_dataman},
+	{"filter",	test_microbench_filter},
+	{"hrt",		test_microbench_hrt},
+	{"math",	test_microbench_math},
+	{"matrix",	test_microbench_matrix},
+	{"mixer",	test_microbench_mixer},
+	{"param",	test_microbench_param},
+	{"perf",	test_microbench_perf},
+	{"polyfit",	test_microbench_polyfit},
+	{"poll",	test_microbench_poll},
+	{"uorb",	test_microbench_uorb},
+};
+
+int test_microbench(int argc, char *argv[])
+{
+	if (argc > 1) {
+		if (microbench::report_open(argv[1]) != 0) {
+			PX4_ERR("failed to open %s", argv[1]);
+			return 1;
+		}
+	}
+
+	int failed = 0;
+
+	for (const auto &suite : suites) {
+		microbench::report_suite(suite.name);
+
+		if (suite.fn(0, nullptr) != 0) {
+			PX4_ERR("microbench %s failed", suite.name);
+			failed++;
+		}
+	}
+
+	microbench::report_close();
+
+	if (argc > 1) {
+		PX4_INFO("results written to %s", argv[1]);
+	}
+
+	return failed;
+}
@@ -0,0 +1,375 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2018 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+/**
+ * @file test_microbench_covariance.cpp
+ * Tests and benchmark of the local position estimator covariance prediction and
+ * correction (SymmetricCovariance, as used by the estimator) against the dense
+ * matrix expressions they replace.
+ */
+
+#include <unit_test.h>
+
+#include <time.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <drivers/drv_hrt.h>
+#include <mathlib/mathlib.h>
+#include <matrix/math.hpp>
+#include <perf/perf_counter.h>
+#include <px4_config.h>
+#include <px4_micro_hal.h>
+
+#include "../../modules/local_position_estimator/SymmetricCovariance.hpp"
+#include "microbench.h"
+
+using namespace matrix;
+
+namespace MicroBenchCovariance
+{
+
+#ifdef __PX4_NUTTX
+#include <nuttx/irq.h>
+static irqstate_t flags;
+#endif
+
+void lock()
+{
+#ifdef __PX4_NUTTX
+	flags = px4_enter_critical_section();
+#endif
+}
+
+void unlock()
+{
+#ifdef __PX4_NUTTX
+	px4_leave_critical_section(flags);
+#endif
+}
+
+static constexpr size_t n_x = 10;	// LPE state size
+static constexpr size_t n_y = 6;	// GPS measures position and velocity
+static constexpr float P_MAX = 1.0e6f;	// see BlockLocalPositionEstimator
+static constexpr float dt = 0.004f;
+
+// LPE state indices
+enum {X_x = 0, X_y, X_z, X_vx, X_vy, X_vz, X_bx, X_by, X_bz, X_tz};
+
+class MicroBenchCovariance : public UnitTest
+{
+public:
+	virtual bool run_tests();
+
+private:
+
+	bool sequential_matches_dense();
+	bool predict_matches_dense();
+	bool replay_matches_dense();
+	bool time_corrections();
+	bool time_predictions();
+
+	void reset();
+	void reset_dynamics();
+
+	float dense_correct();
+	float sequential_correct();
+
+	void dense_predict();
+	void sparse_predict();
+
+	bool covariance_matches(float tolerance);
+
+	SquareMatrix<float, n_x> _P_dense;
+	SymmetricCovariance<float, n_x> _P_sym;
+	Vector<float, n_x> _dx_dense;
+	Vector<float, n_x> _dx_sym;
+
+	Matrix<float, n_y, n_x> _C;
+	SquareMatrix<float, n_y> _R;
+	Vector<float, n_y> _r;
+
+	// dynamics with the LPE structure: position from velocity, velocity from the rotated accel bias
+	SquareMatrix<float, n_x> _A;
+	Vector<float, n_x> _q;
+};
+
+bool MicroBenchCovariance::run_tests()
+{
+	ut_run_test(sequential_matches_dense);
+	ut_run_test(predict_matches_dense);
+	ut_run_test(replay_matches_dense);
+	ut_run_test(time_corrections);
+	ut_run_test(time_predictions);
+
+	return (_tests_failed == 0);
+}
+
+template<typename T>
+T random(T min, T max)
+{
+	const T scale = rand() / (T) RAND_MAX; /* [0, 1.0] */
+	return min + scale * (max - min);      /* [min, max] */
+}
+
+void MicroBenchCovariance::reset()
+{
+	// random positive definite covariance P = A * A' + I
+	SquareMatrix<float, n_x> A;
+
+	for (size_t i = 0; i < n_x; i++) {
+		for (size_t j = 0; j < n_x; j++) {
+			A(i, j) = random(-0.5f, 0.5f);
+		}
+	}
+
+	_P_dense = A * A.transpose();
+
+	for (size_t i = 0; i < n_x; i++) {
+		_P_dense(i, i) += 1.0f;
+
+		for (size_t j = i; j < n_x; j++) {
+			_P_sym(i, j) = _P_dense(i, j);
+		}
+	}
+
+	// gps measurement of position and velocity
+	_C.setZero();
+	_R.setZero();
+
+	for (size_t i = 0; i < n_y; i++) {
+		_C(i, i) = 1.0f;
+		_R(i, i) = random(0.1f, 1.0f);
+		_r(i) = random(-1.0f, 1.0f);
+	}
+}
+
+void MicroBenchCovariance::reset_dynamics()
+{
+	const Dcmf R_att(Eulerf(random(-0.5f, 0.5f), random(-0.5f, 0.5f), random(-3.14f, 3.14f)));
+
+	_A.setZero();
+	_A(X_x, X_vx) = 1;
+	_A(X_y, X_vy) = 1;
+	_A(X_z, X_vz) = 1;
+
+	for (size_t i = 0; i < 3; i++) {
+		for (size_t j = 0; j < 3; j++) {
+			_A(X_vx + i, X_bx + j) = -R_att(i, j);
+		}
+	}
+
+	for (size_t i = 0; i < n_x; i++) {
+		_q(i) = random(1e-6f, 1e-2f);
+	}
+}
+
+float MicroBenchCovariance::dense_correct()
+{
+	const SquareMatrix<float, n_y> S_I = inv<float, n_y>(_C * _P_dense * _C.transpose() + _R);
+	const Matrix<float, n_x, n_y> K = _P_dense * _C.transpose() * S_I;
+	_dx_dense = K * _r;
+	_P_dense -= K * _C * _P_dense;
+
+	return (_r.transpose() * (S_I * _r))(0, 0);
+}
+
+float MicroBenchCovariance::sequential_correct()
+{
+	return _P_sym.sequentialUpdate(_C, _R, _r, _dx_sym);
+}
+
+void MicroBenchCovariance::dense_predict()
+{
+	SquareMatrix<float, n_x> dP = (_A * _P_dense + _P_dense * _A.transpose()) * dt;
+
+	for (size_t i = 0; i < n_x; i++) {
+		dP(i, i) += _q(i) * dt;
+	}
+
+	for (size_t i = 0; i < n_x; i++) {
+		if (_P_dense(i, i) > P_MAX) {
+			for (size_t j = 0; j < n_x; j++) {
+				dP(i, j) = 0;
+				dP(j, i) = 0;
+			}
+		}
+	}
+
+	_P_dense += dP;
+}
+
+void MicroBenchCovariance::sparse_predict()
+{
+	_P_sym.predict(_A, _q, dt, P_MAX);
+}
+
+bool MicroBenchCovariance::covariance_matches(float tolerance)
+{
+	for (size_t i = 0; i < n_x; i++) {
+		for (size_t j = i; j < n_x; j++) {
+			if (fabsf(_P_dense(i, j) - _P_sym(i, j)) > tolerance * (1.0f + fabsf(_P_dense(i, j)))) {
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+ut_declare_test_c(test_microbench_covariance, MicroBenchCovariance)
+
+bool MicroBenchCovariance::sequential_matches_dense()
+{
+	srand(time(nullptr));
+
+	for (int n = 0; n < 100; n++) {
+		reset();
+
+		const float beta_dense = dense_correct();
+		const float beta_sym = sequential_correct();
+
+		ut_assert("beta differs", fabsf(beta_dense - beta_sym) < 1e-4f * (1.0f + beta_dense));
+
+		for (size_t i = 0; i < n_x; i++) {
+			ut_assert("state correction differs", fabsf(_dx_dense(i) - _dx_sym(i)) < 1e-4f);
+
+			for (size_t j = i; j < n_x; j++) {
+				ut_assert("covariance differs", fabsf(_P_dense(i, j) - _P_sym(i, j)) < 1e-4f);
+			}
+		}
+	}
+
+	return true;
+}
+
+bool MicroBenchCovariance::predict_matches_dense()
+{
+	for (int n = 0; n < 100; n++) {
+		reset();
+		reset_dynamics();
+
+		if (n % 10 == 0) {
+			// a state that is not propagated any more
+			_P_dense(X_tz, X_tz) = 2.0f * P_MAX;
+			_P_sym(X_tz, X_tz) = 2.0f * P_MAX;
+		}
+
+		dense_predict();
+		sparse_predict();
+
+		ut_assert("predicted covariance differs", covariance_matches(1e-6f));
+	}
+
+	return true;
+}
+
+bool MicroBenchCovariance::replay_matches_dense()
+{
+	// a sequence of predictions with gps corrections at 10 Hz, as in flight
+	static constexpr int steps = 5000;
+
+	reset();
+	reset_dynamics();
+
+	Vector<float, n_x> x_dense;
+	Vector<float, n_x> x_sym;
+	float beta_max_diff = 0.0f;
+	hrt_abstime dense_time = 0;
+	hrt_abstime sym_time = 0;
+
+	for (int n = 0; n < steps; n++) {
+		if (n % 100 == 0) {
+			reset_dynamics(); // attitude change
+		}
+
+		hrt_abstime start = hrt_absolute_time();
+		dense_predict();
+		dense_time += hrt_elapsed_time(&start);
+
+		start = hrt_absolute_time();
+		sparse_predict();
+		sym_time += hrt_elapsed_time(&start);
+
+		if (n % 25 == 0) {
+			for (size_t i = 0; i < n_y; i++) {
+				_r(i) = random(-1.0f, 1.0f);
+			}
+
+			start = hrt_absolute_time();
+			const float beta_dense = dense_correct();
+			dense_time += hrt_elapsed_time(&start);
+
+			start = hrt_absolute_time();
+			const float beta_sym = sequential_correct();
+			sym_time += hrt_elapsed_time(&start);
+
+			x_dense += _dx_dense;
+			x_sym += _dx_sym;
+			beta_max_diff = math::max(beta_max_diff, fabsf(beta_dense - beta_sym) / (1.0f + beta_dense));
+		}
+	}
+
+	PX4_INFO("replay of %i steps: dense %.3f ms, symmetric %.3f ms, max rel. beta difference %.2e",
+		 steps, (double)dense_time / 1e3, (double)sym_time / 1e3, (double)beta_max_diff);
+
+	ut_assert("fault statistic differs", beta_max_diff < 1e-4f);
+	ut_assert("covariance differs after replay", covariance_matches(1e-4f));
+
+	for (size_t i = 0; i < n_x; i++) {
+		ut_assert("state differs after replay", fabsf(x_dense(i) - x_sym(i)) < 1e-3f * (1.0f + fabsf(x_dense(i))));
+	}
+
+	return true;
+}
+
+bool MicroBenchCovariance::time_predictions()
+{
+	reset_dynamics();
+
+	PERF("dense prediction (10 states)", dense_predict(), 1000);
+	PERF("sparse prediction (10 states)", sparse_predict(), 1000);
+
+	return true;
+}
+
+bool MicroBenchCovariance::time_corrections()
+{
+	PERF("dense correction (gps, 10 states)", dense_correct(), 1000);
+	PERF("sequential correction (gps, 10 states)", sequential_correct(), 1000);
+
+	return true;
+}
+
+} // namespace MicroBenchCovariance
@@ -0,0 +1,101 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2018 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+#include <unit_test.h>
+
+#include <time.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <dataman/dataman.h>
+#include <drivers/drv_hrt.h>
+#include <perf/perf_counter.h>
+#include <px4_config.h>
+#include <px4_micro_hal.h>
+
+#include "microbench.h"
+
+namespace MicroBenchDataman
+{
+
+// dataman requests are handed to the dataman task and waited for,
+// which must not be done with interrupts disabled
+void lock() {}
+void unlock() {}
+
+class MicroBenchDataman : public UnitTest
+{
+public:
+	virtual bool run_tests();
+
+private:
+
+	bool time_px4_dataman();
+
+	void reset();
+
+	mission_item_s item;
+};
+
+bool MicroBenchDataman::run_tests()
+{
+	ut_run_test(time_px4_dataman);
+
+	return (_tests_failed == 0);
+}
+
+void MicroBenchDataman::reset()
+{
+}
+
+ut_declare_test_c(test_microbench_dataman, MicroBenchDataman)
+
+bool MicroBenchDataman::time_px4_dataman()
+{
+	// the alternate offboard mission slot is only written while a new mission is uploaded,
+	// read it and write the same content back so no stored mission is modified
+	ssize_t ret = dm_read(DM_KEY_WAYPOINTS_OFFBOARD_1, 0, &item, sizeof(item));
+
+	if (ret != sizeof(item)) {
+		memset(&item, 0, sizeof(item));
+	}
+
+	PERF("dm_read mission item", ret = dm_read(DM_KEY_WAYPOINTS_OFFBOARD_1, 0, &item, sizeof(item)), 1000);
+	PERF("dm_write mission item", ret = dm_write(DM_KEY_WAYPOINTS_OFFBOARD_1, 0, DM_PERSIST_POWER_ON_RESET, &item,
+			sizeof(item)), 100);
+
+	return true;
+}
+
+} // namespace MicroBenchDataman
@@ -0,0 +1,241 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2018 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file test_microbench_filter.cpp
+ * Benchmark of the IMU filter bank against the per axis low pass filters,
+ * filtering FIFO bursts of 6 channels (accel + gyro).
+ */
+
+#include <unit_test.h>
+
+#include <time.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <drivers/drv_hrt.h>
+#include <perf/perf_counter.h>
+#include <px4_config.h>
+#include <px4_micro_hal.h>
+
+#include <lib/mathlib/math/filter/FilterBank.hpp>
+#include <lib/mathlib/math/filter/LowPassFilter2p.hpp>
+#include <lib/mathlib/math/filter/LowPassFilter2pVector3f.hpp>
+
+#include "microbench.h"
+
+namespace MicroBenchFilter
+{
+
+#ifdef __PX4_NUTTX
+#include <nuttx/irq.h>
+static irqstate_t flags;
+#endif
+
+void lock()
+{
+#ifdef __PX4_NUTTX
+	flags = px4_enter_critical_section();
+#endif
+}
+
+void unlock()
+{
+#ifdef __PX4_NUTTX
+	px4_leave_critical_section(flags);
+#endif
+}
+
+static constexpr float SAMPLE_RATE = 8000.0f;
+static constexpr float ACCEL_CUTOFF = 30.0f;
+static constexpr float GYRO_CUTOFF = 80.0f;
+static constexpr float NOTCH_FREQ = 250.0f;
+static constexpr float NOTCH_BANDWIDTH = 40.0f;
+
+static constexpr size_t CHANNELS = 6;	// accel x, y, z, gyro x, y, z
+static constexpr size_t BURST = 16;	// samples per FIFO burst at 8 kHz
+
+class MicroBenchFilter : public UnitTest
+{
+public:
+	virtual bool run_tests();
+
+private:
+
+	bool filter_bank_matches_lowpass();
+	bool time_filters();
+
+	void reset();
+
+	void apply_lowpass2p();
+	void apply_lowpass2p_vector3f();
+
+	float _block[BURST][CHANNELS] {};
+
+	math::LowPassFilter2p _lp[CHANNELS] {
+		{SAMPLE_RATE, ACCEL_CUTOFF}, {SAMPLE_RATE, ACCEL_CUTOFF}, {SAMPLE_RATE, ACCEL_CUTOFF},
+		{SAMPLE_RATE, GYRO_CUTOFF}, {SAMPLE_RATE, GYRO_CUTOFF}, {SAMPLE_RATE, GYRO_CUTOFF}
+	};
+
+	math::LowPassFilter2pVector3f _accel_lp{SAMPLE_RATE, ACCEL_CUTOFF};
+	math::LowPassFilter2pVector3f _gyro_lp{SAMPLE_RATE, GYRO_CUTOFF};
+
+	math::FilterBank<CHANNELS> _bank;
+	math::FilterBank<CHANNELS> _bank_notch;
+};
+
+bool MicroBenchFilter::run_tests()
+{
+	ut_run_test(filter_bank_matches_lowpass);
+	ut_run_test(time_filters);
+
+	return (_tests_failed == 0);
+}
+
+template<typename T>
+T random(T min, T max)
+{
+	const T scale = rand() / (T) RAND_MAX; /* [0, 1.0] */
+	return min + scale * (max - min);      /* [min, max] */
+}
+
+void MicroBenchFilter::reset()
+{
+	// initialize with random data
+	for (size_t n = 0; n < BURST; n++) {
+		for (size_t c = 0; c < CHANNELS; c++) {
+			_block[n][c] = random(-20.0f, 20.0f);
+		}
+	}
+}
+
+void MicroBenchFilter::apply_lowpass2p()
+{
+	for (size_t n = 0; n < BURST; n++) {
+		for (size_t c = 0; c < CHANNELS; c++) {
+			_block[n][c] = _lp[c].apply(_block[n][c]);
+		}
+	}
+}
+
+void MicroBenchFilter::apply_lowpass2p_vector3f()
+{
+	for (size_t n = 0; n < BURST; n++) {
+		const matrix::Vector3f accel = _accel_lp.apply(matrix::Vector3f(&_block[n][0]));
+		const matrix::Vector3f gyro = _gyro_lp.apply(matrix::Vector3f(&_block[n][3]));
+
+		for (size_t i = 0; i < 3; i++) {
+			_block[n][i] = accel(i);
+			_block[n][i + 3] = gyro(i);
+		}
+	}
+}
+
+ut_declare_test_c(test_microbench_filter, MicroBenchFilter)
+
+bool MicroBenchFilter::filter_bank_matches_lowpass()
+{
+	srand(time(nullptr));
+
+	math::FilterBank<CHANNELS> bank;
+	bank.set_lowpass(0, 3, SAMPLE_RATE, ACCEL_CUTOFF);
+	bank.set_lowpass(3, 3, SAMPLE_RATE, GYRO_CUTOFF);
+
+	ut_compare_float("accel cutoff", bank.get_cutoff_freq(0), ACCEL_CUTOFF, 3);
+	ut_compare_float("gyro cutoff", bank.get_cutoff_freq(5), GYRO_CUTOFF, 3);
+
+	for (int burst = 0; burst < 100; burst++) {
+		reset();
+
+		float expected[BURST][CHANNELS];
+
+		for (size_t n = 0; n < BURST; n++) {
+			for (size_t c = 0; c < CHANNELS; c++) {
+				expected[n][c] = _lp[c].apply(_block[n][c]);
+			}
+		}
+
+		bank.apply(_block, BURST);
+
+		for (size_t n = 0; n < BURST; n++) {
+			for (size_t c = 0; c < CHANNELS; c++) {
+				ut_assert("filter bank output differs", fabsf(_block[n][c] - expected[n][c]) < 1e-4f);
+			}
+		}
+	}
+
+	// a sine on the notch frequency is removed once the filter settled
+	math::FilterBank<CHANNELS> notch;
+	notch.set_notch(0, 3, 3, SAMPLE_RATE, NOTCH_FREQ, NOTCH_BANDWIDTH);
+
+	float max_amplitude = 0.0f;
+
+	for (int n = 0; n < (int)SAMPLE_RATE; n++) {
+		float sample[CHANNELS];
+
+		for (size_t c = 0; c < CHANNELS; c++) {
+			sample[c] = sinf(2.0f * M_PI_F * NOTCH_FREQ * n / SAMPLE_RATE);
+		}
+
+		notch.apply(sample);
+
+		if (n > (int)SAMPLE_RATE / 2) {
+			// accel channels have no notch configured
+			ut_compare_float("pass through", sample[0], sinf(2.0f * M_PI_F * NOTCH_FREQ * n / SAMPLE_RATE), 3);
+			max_amplitude = fmaxf(max_amplitude, fabsf(sample[3]));
+		}
+	}
+
+	ut_assert("notch attenuation", max_amplitude < 0.01f);
+
+	return true;
+}
+
+bool MicroBenchFilter::time_filters()
+{
+	_bank.set_lowpass(0, 3, SAMPLE_RATE, ACCEL_CUTOFF);
+	_bank.set_lowpass(3, 3, SAMPLE_RATE, GYRO_CUTOFF);
+
+	_bank_notch.set_lowpass(0, 3, SAMPLE_RATE, ACCEL_CUTOFF);
+	_bank_notch.set_lowpass(3, 3, SAMPLE_RATE, GYRO_CUTOFF);
+	_bank_notch.set_notch(0, 3, 3, SAMPLE_RATE, NOTCH_FREQ, NOTCH_BANDWIDTH);
+
+	PERF("LowPassFilter2p x6 (16 samples)", apply_lowpass2p(), 1000);
+	PERF("LowPassFilter2pVector3f x2 (16 samples)", apply_lowpass2p_vector3f(), 1000);
+	PERF("FilterBank<6> (16 samples)", _bank.apply(_block, BURST), 1000);
+	PERF("FilterBank<6> + gyro notch (16 samples)", _bank_notch.apply(_block, BURST), 1000);
+
+	return true;
+}
+
+} // namespace MicroBenchFilter
@@ -42,6 +42,8 @@
 #include <px4_config.h>
 #include <px4_micro_hal.h>
 
+#include "microbench.h"
+
 namespace MicroBenchHRT
 {
 
@@ -64,22 +66,6 @@ void unlock()
 #endif
 }
 
-#define PERF(name, op, count) do { \
-		px4_usleep(1000); \
-		reset(); \
-		perf_counter_t p = perf_alloc(PC_ELAPSED, name); \
-		for (int i = 0; i < count; i++) { \
-			lock(); \
-			perf_begin(p); \
-			op; \
-			perf_end(p); \
-			unlock(); \
-			reset(); \
-		} \
-		perf_print_counter(p); \
-		perf_free(p); \
-	} while (0)
-
 class MicroBenchHRT : public UnitTest
 {
 public:
@@ -0,0 +1,161 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2018 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+#include <unit_test.h>
+
+#include <time.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <drivers/drv_hrt.h>
+#include <mixer/mixer.h>
+#include <perf/perf_counter.h>
+#include <px4_config.h>
+#include <px4_micro_hal.h>
+
+#include "microbench.h"
+
+namespace MicroBenchMixer
+{
+
+#ifdef __PX4_NUTTX
+#include <nuttx/irq.h>
+static irqstate_t flags;
+#endif
+
+void lock()
+{
+#ifdef __PX4_NUTTX
+	flags = px4_enter_critical_section();
+#endif
+}
+
+void unlock()
+{
+#ifdef __PX4_NUTTX
+	px4_leave_critical_section(flags);
+#endif
+}
+
+static float controls[8];
+
+static int control_cb(uintptr_t handle, uint8_t control_group, uint8_t control_index, float &control)
+{
+	if (control_group != 0 || control_index >= sizeof(controls) / sizeof(controls[0])) {
+		control = 0.0f;
+		return -1;
+	}
+
+	control = controls[control_index];
+	return 0;
+}
+
+static const char *quad_x = "R: 4x 10000 10000 10000 0\n";
+
+static const char *aert =
+	"M: 1\n"
+	"S: 0 0  10000  10000      0 -10000  10000\n"
+	"M: 1\n"
+	"S: 0 1  10000  10000      0 -10000  10000\n"
+	"M: 1\n"
+	"S: 0 2  10000  10000      0 -10000  10000\n"
+	"M: 1\n"
+	"S: 0 3  10000  10000      0 -10000  10000\n";
+
+class MicroBenchMixer : public UnitTest
+{
+public:
+	virtual bool run_tests();
+
+private:
+
+	bool time_px4_mixer();
+
+	void reset();
+
+	bool load(MixerGroup &group, const char *text, bool allow_compiled);
+
+	float outputs[16];
+	unsigned mixed;
+};
+
+bool MicroBenchMixer::run_tests()
+{
+	ut_run_test(time_px4_mixer);
+
+	return (_tests_failed == 0);
+}
+
+template<typename T>
+T random(T min, T max)
+{
+	const T scale = rand() / (T) RAND_MAX; /* [0, 1.0] */
+	return min + scale * (max - min);      /* [min, max] */
+}
+
+void MicroBenchMixer::reset()
+{
+	srand(time(nullptr));
+
+	// initialize with random data
+	controls[0] = random(-1.0f, 1.0f);
+	controls[1] = random(-1.0f, 1.0f);
+	controls[2] = random(-1.0f, 1.0f);
+	controls[3] = random(0.0f, 1.0f);
+}
+
+bool MicroBenchMixer::load(MixerGroup &group, const char *text, bool allow_compiled)
+{
+	unsigned len = strlen(text);
+	return (group.load_from_buf(text, len, allow_compiled) == 0) && (group.count() > 0);
+}
+
+ut_declare_test_c(test_microbench_mixer, MicroBenchMixer)
+
+bool MicroBenchMixer::time_px4_mixer()
+{
+	MixerGroup multirotor(control_cb, 0);
+	MixerGroup simple(control_cb, 0);
+
+	ut_assert_true(load(multirotor, quad_x, false));
+	ut_assert_true(load(simple, aert, false));
+
+	PERF("mix multirotor quad x", mixed = multirotor.mix(outputs, 16), 1000);
+	PERF("mix simple 4 outputs", mixed = simple.mix(outputs, 16), 1000);
+
+	return true;
+}
+
+} // namespace MicroBenchMixer
@@ -0,0 +1,112 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2018 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+#include <unit_test.h>
+
+#include <time.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <drivers/drv_hrt.h>
+#include <parameters/param.h>
+#include <perf/perf_counter.h>
+#include <px4_config.h>
+#include <px4_micro_hal.h>
+
+#include "microbench.h"
+
+namespace MicroBenchParam
+{
+
+// param_get() takes the parameter lock, which must not be done
+// with interrupts disabled
+void lock() {}
+void unlock() {}
+
+class MicroBenchParam : public UnitTest
+{
+public:
+	virtual bool run_tests();
+
+private:
+
+	bool time_px4_param();
+
+	void reset();
+
+	int32_t i_32;
+	float f_32;
+
+	param_t handle;
+	int ret;
+};
+
+bool MicroBenchParam::run_tests()
+{
+	ut_run_test(time_px4_param);
+
+	return (_tests_failed == 0);
+}
+
+void MicroBenchParam::reset()
+{
+	srand(time(nullptr));
+
+	// initialize with random data
+	i_32 = rand();
+	f_32 = rand();
+}
+
+ut_declare_test_c(test_microbench_param, MicroBenchParam)
+
+bool MicroBenchParam::time_px4_param()
+{
+	const param_t sys_autostart = param_find("SYS_AUTOSTART");
+	const param_t mc_rollrate_p = param_find("MC_ROLLRATE_P");
+
+	PERF("param_find SYS_AUTOSTART", handle = param_find("SYS_AUTOSTART"), 1000);
+	PERF("param_find_no_notification MC_ROLLRATE_P", handle = param_find_no_notification("MC_ROLLRATE_P"), 1000);
+
+	if (sys_autostart != PARAM_INVALID) {
+		PERF("param_get SYS_AUTOSTART", ret = param_get(sys_autostart, &i_32), 1000);
+	}
+
+	if (mc_rollrate_p != PARAM_INVALID) {
+		PERF("param_get MC_ROLLRATE_P", ret = param_get(mc_rollrate_p, &f_32), 1000);
+	}
+
+	return true;
+}
+
+} // namespace MicroBenchParam
@@ -0,0 +1,116 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2018 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+#include <unit_test.h>
+
+#include <time.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <drivers/drv_hrt.h>
+#include <perf/perf_counter.h>
+#include <px4_config.h>
+#include <px4_micro_hal.h>
+
+#include "microbench.h"
+
+namespace MicroBenchPerf
+{
+
+#ifdef __PX4_NUTTX
+#include <nuttx/irq.h>
+static irqstate_t flags;
+#endif
+
+void lock()
+{
+#ifdef __PX4_NUTTX
+	flags = px4_enter_critical_section();
+#endif
+}
+
+void unlock()
+{
+#ifdef __PX4_NUTTX
+	px4_leave_critical_section(flags);
+#endif
+}
+
+class MicroBenchPerf : public UnitTest
+{
+public:
+	virtual bool run_tests();
+
+private:
+
+	bool time_px4_perf();
+
+	void reset();
+
+	perf_counter_t _elapsed{nullptr};
+	perf_counter_t _count{nullptr};
+	perf_counter_t _interval{nullptr};
+};
+
+bool MicroBenchPerf::run_tests()
+{
+	_elapsed = perf_alloc(PC_ELAPSED, "microbench elapsed");
+	_count = perf_alloc(PC_COUNT, "microbench count");
+	_interval = perf_alloc(PC_INTERVAL, "microbench interval");
+
+	ut_run_test(time_px4_perf);
+
+	perf_free(_elapsed);
+	perf_free(_count);
+	perf_free(_interval);
+
+	return (_tests_failed == 0);
+}
+
+void MicroBenchPerf::reset()
+{
+}
+
+ut_declare_test_c(test_microbench_perf, MicroBenchPerf)
+
+bool MicroBenchPerf::time_px4_perf()
+{
+	PERF("perf_begin/perf_end", perf_begin(_elapsed); perf_end(_elapsed), 1000);
+	PERF("perf_count PC_COUNT", perf_count(_count), 1000);
+	PERF("perf_count PC_INTERVAL", perf_count(_interval), 1000);
+
+	return true;
+}
+
+} // namespace MicroBenchPerf
@@ -0,0 +1,108 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2018 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+#include <unit_test.h>
+
+#include <time.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <drivers/drv_hrt.h>
+#include <perf/perf_counter.h>
+#include <px4_config.h>
+#include <px4_micro_hal.h>
+#include <px4_posix.h>
+
+#include <uORB/topics/sensor_gyro.h>
+#include <uORB/topics/vehicle_status.h>
+
+#include "microbench.h"
+
+namespace MicroBenchPoll
+{
+
+// px4_poll() sets up and waits on a semaphore, which must not be done
+// with interrupts disabled
+void lock() {}
+void unlock() {}
+
+class MicroBenchPoll : public UnitTest
+{
+public:
+	virtual bool run_tests();
+
+private:
+
+	bool time_px4_poll();
+
+	void reset();
+
+	int ret;
+};
+
+bool MicroBenchPoll::run_tests()
+{
+	ut_run_test(time_px4_poll);
+
+	return (_tests_failed == 0);
+}
+
+void MicroBenchPoll::reset()
+{
+}
+
+ut_declare_test_c(test_microbench_poll, MicroBenchPoll)
+
+bool MicroBenchPoll::time_px4_poll()
+{
+	int fd_status = orb_subscribe(ORB_ID(vehicle_status));
+	int fd_gyro = orb_subscribe(ORB_ID(sensor_gyro));
+
+	px4_pollfd_struct_t fds[2] = {};
+	fds[0].fd = fd_status;
+	fds[0].events = POLLIN;
+	fds[1].fd = fd_gyro;
+	fds[1].events = POLLIN;
+
+	// timeout 0: measures the poll setup and teardown, not the wait
+	PERF("px4_poll 1 fd", ret = px4_poll(fds, 1, 0), 1000);
+	PERF("px4_poll 2 fds", ret = px4_poll(fds, 2, 0), 1000);
+
+	orb_unsubscribe(fd_status);
+	orb_unsubscribe(fd_gyro);
+
+	return true;
+}
+
+} // namespace MicroBenchPoll
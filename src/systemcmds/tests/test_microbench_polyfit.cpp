@@ -0,0 +1,241 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2018 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+/**
+ * @file test_microbench_polyfit.cpp
+ * Benchmark of the thermal calibration fitters, accumulated normal equations
+ * against the incrementally updated QR factorisation, over a simulated soak.
+ */
+
+#include <unit_test.h>
+
+#include <time.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <drivers/drv_hrt.h>
+#include <perf/perf_counter.h>
+#include <px4_config.h>
+#include <px4_micro_hal.h>
+
+#include "../../modules/events/temperature_calibration/polyfit.hpp"
+#include "microbench.h"
+
+namespace MicroBenchPolyfit
+{
+
+#ifdef __PX4_NUTTX
+#include <nuttx/irq.h>
+static irqstate_t flags;
+#endif
+
+void lock()
+{
+#ifdef __PX4_NUTTX
+	flags = px4_enter_critical_section();
+#endif
+}
+
+void unlock()
+{
+#ifdef __PX4_NUTTX
+	px4_leave_critical_section(flags);
+#endif
+}
+
+// setup runs outside of the measurement, to exclude generating the next sample
+#define PERF_SETUP(name, setup, op, count) do { \
+		px4_usleep(1000); \
+		perf_counter_t p = perf_alloc(PC_ELAPSED, name); \
+		for (int i = 0; i < count; i++) { \
+			setup; \
+			lock(); \
+			perf_begin(p); \
+			op; \
+			perf_end(p); \
+			unlock(); \
+		} \
+		perf_print_counter(p); \
+		microbench::report(name, p); \
+		perf_free(p); \
+	} while (0)
+
+static constexpr int soak_samples = 20000;	// samples over the simulated soak
+static constexpr double soak_rise = 24.0;	// SYS_CAL_TDEL default (deg C)
+
+// gyro (3rd order) and baro (5th order) drift, highest order coefficient first
+static constexpr double gyro_coef[4] = {2e-6, -3e-5, 1e-3, 0.02};
+static constexpr double baro_coef[6] = {2e-5, -1e-4, 3e-3, -0.05, 4.0, 101325.0};
+
+class MicroBenchPolyfit : public UnitTest
+{
+public:
+	virtual bool run_tests();
+
+private:
+
+	bool incremental_matches_batch();
+	bool incremental_recovers_baro();
+	bool time_fitters();
+
+	template<int N>
+	static double eval(const double coef[N], double x)
+	{
+		double y = 0.0;
+
+		for (int i = 0; i < N; i++) {
+			y = y * x + coef[i];
+		}
+
+		return y;
+	}
+
+	// heated board: temperature approaches its final value exponentially, relative to the reference temperature
+	static double soak_temperature(int i)
+	{
+		return soak_rise * (1.0 - exp(-3.0 * i / soak_samples)) / (1.0 - exp(-3.0)) - 0.5 * soak_rise;
+	}
+
+	static double noise(double amplitude)
+	{
+		return amplitude * (rand() / (double)RAND_MAX - 0.5);
+	}
+
+	template<int N>
+	void next_sample(const double (&coef)[N], double amplitude)
+	{
+		_x = soak_temperature(_sample);
+		_y = eval<N>(coef, _x) + noise(amplitude);
+		_sample = (_sample + 1) % soak_samples;
+	}
+
+	int _sample{0};
+	double _x{0.0};
+	double _y{0.0};
+	double _res[6] {};
+
+	polyfitter<4> _gyro_batch;
+	incremental_polyfitter<4> _gyro_incremental;
+	polyfitter<6> _baro_batch;
+	incremental_polyfitter<6> _baro_incremental;
+};
+
+bool MicroBenchPolyfit::run_tests()
+{
+	ut_run_test(incremental_matches_batch);
+	ut_run_test(incremental_recovers_baro);
+	ut_run_test(time_fitters);
+
+	return (_tests_failed == 0);
+}
+
+ut_declare_test_c(test_microbench_polyfit, MicroBenchPolyfit)
+
+bool MicroBenchPolyfit::incremental_matches_batch()
+{
+	srand(0);
+
+	polyfitter<4> batch;
+	incremental_polyfitter<4> incremental;
+
+	for (int i = 0; i < soak_samples; i++) {
+		const double x = soak_temperature(i);
+		const double y = eval<4>(gyro_coef, x) + noise(0.01);
+		batch.update(x, y);
+		incremental.update(x, y);
+	}
+
+	double res_batch[4];
+	double res_incremental[4];
+	ut_assert_true(batch.fit(res_batch));
+	ut_assert_true(incremental.fit(res_incremental));
+
+	for (int i = 0; i < 4; i++) {
+		ut_assert("coefficient differs", fabs(res_batch[i] - res_incremental[i]) < 1e-6 * (1.0 + fabs(res_batch[i])));
+	}
+
+	// uniform noise of width 0.01 has a standard deviation of 0.01 / sqrt(12)
+	ut_assert("residual rms", fabs(incremental.residual_rms() - 0.01 / sqrt(12.0)) < 1e-4);
+
+	return true;
+}
+
+bool MicroBenchPolyfit::incremental_recovers_baro()
+{
+	incremental_polyfitter<6> incremental;
+
+	for (int i = 0; i < soak_samples; i++) {
+		const double x = soak_temperature(i);
+		incremental.update(x, eval<6>(baro_coef, x));
+	}
+
+	double res[6];
+	ut_assert_true(incremental.fit(res));
+
+	for (int i = 0; i < 6; i++) {
+		ut_assert("coefficient differs", fabs(res[i] - baro_coef[i]) < 1e-6 * (1.0 + fabs(baro_coef[i])));
+	}
+
+	// the same fit expressed about x = 3 must evaluate identically
+	incremental_polyfitter<6>::shift(res, 3.0);
+	ut_assert("shifted fit differs", fabs(eval<6>(res, -1.0) - eval<6>(baro_coef, 2.0)) < 1e-3);
+
+	return true;
+}
+
+bool MicroBenchPolyfit::time_fitters()
+{
+	PX4_INFO("memory per axis: polyfitter<4> %u B, incremental_polyfitter<4> %u B",
+		 (unsigned)sizeof(polyfitter<4>), (unsigned)sizeof(incremental_polyfitter<4>));
+	PX4_INFO("memory per axis: polyfitter<6> %u B, incremental_polyfitter<6> %u B",
+		 (unsigned)sizeof(polyfitter<6>), (unsigned)sizeof(incremental_polyfitter<6>));
+
+	srand(0);
+
+	PERF_SETUP("polyfitter<4> update", next_sample(gyro_coef, 0.01), _gyro_batch.update(_x, _y), soak_samples);
+	PERF_SETUP("incremental_polyfitter<4> update", next_sample(gyro_coef, 0.01), _gyro_incremental.update(_x, _y),
+	     soak_samples);
+	PERF_SETUP("polyfitter<6> update", next_sample(baro_coef, 5.0), _baro_batch.update(_x, _y), soak_samples);
+	PERF_SETUP("incremental_polyfitter<6> update", next_sample(baro_coef, 5.0), _baro_incremental.update(_x, _y),
+	     soak_samples);
+
+	PERF_SETUP("polyfitter<4> fit", , _gyro_batch.fit(_res), 100);
+	PERF_SETUP("incremental_polyfitter<4> fit", , _gyro_incremental.fit(_res), 100);
+	PERF_SETUP("polyfitter<6> fit", , _baro_batch.fit(_res), 100);
+	PERF_SETUP("incremental_polyfitter<6> fit", , _baro_incremental.fit(_res), 100);
+
+	return true;
+}
+
+} // namespace MicroBenchPolyfit
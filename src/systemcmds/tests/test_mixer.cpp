@@ -39,6 +39,7 @@
 
 #include <limits>
 #include <dirent.h>
+#include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
 
@@ -108,6 +109,7 @@ private:
 	bool load_mixer(const char *filename, unsigned expected_count, bool verbose = false);
 	bool load_mixer(const char *filename, const char *buf, unsigned loaded, unsigned expected_count,
 			const unsigned chunk_size, bool verbose);
+	bool check_compiled(const char *buf, unsigned loaded);
 
 	MixerGroup mixer_group;
 };
@@ -247,6 +249,71 @@ bool MixerTest::load_mixer(const char *filename, unsigned expected_count, bool v
 		}
 	}
 
+	return check_compiled(buf, loaded);
+}
+
+bool MixerTest::check_compiled(const char *buf, unsigned loaded)
+{
+	/* the mixers compiled from the file have to behave exactly like the ones parsed from its text */
+	MixerGroup compiled_group(mixer_callback, 0);
+	MixerGroup text_group(mixer_callback, 0);
+
+	unsigned compiled_resid = loaded;
+	unsigned text_resid = loaded;
+	compiled_group.load_from_buf(&buf[0], compiled_resid);
+	text_group.load_from_buf(&buf[0], text_resid, false);
+
+	if (compiled_group.compiled() == nullptr) {
+		/* not compiled into this build */
+		return true;
+	}
+
+	ut_compare("check number of compiled mixers", compiled_group.count(), text_group.count());
+
+	uint32_t compiled_groups = 0;
+	uint32_t text_groups = 0;
+	compiled_group.groups_required(compiled_groups);
+	text_group.groups_required(text_groups);
+	ut_compare("check compiled groups required", compiled_groups, text_groups);
+
+	/* like the output drivers, get_trims() fills one value per output of the group */
+	int16_t compiled_trims[PWM_OUTPUT_MAX_CHANNELS];
+	int16_t text_trims[PWM_OUTPUT_MAX_CHANNELS];
+	unsigned trim_count = text_group.get_trims(&text_trims[0]);
+	ut_compare("check number of compiled trims", compiled_group.get_trims(&compiled_trims[0]), trim_count);
+	ut_assert("check compiled trims", memcmp(compiled_trims, text_trims, trim_count * sizeof(int16_t)) == 0);
+
+	float compiled_outputs[output_max];
+	float text_outputs[output_max];
+
+	for (unsigned i = 0; i < 1000; i++) {
+		if (i == 500) {
+			/* the second half with trims changed at runtime, as done by the output drivers */
+			for (unsigned j = 0; j < trim_count; j++) {
+				text_trims[j] = (rand() % 2001) - 1000;
+			}
+
+			ut_compare("check number of compiled trims set", compiled_group.set_trims(&text_trims[0], trim_count),
+				   text_group.set_trims(&text_trims[0], trim_count));
+
+			text_group.get_trims(&text_trims[0]);
+			compiled_group.get_trims(&compiled_trims[0]);
+			ut_assert("check compiled trims set", memcmp(compiled_trims, text_trims, trim_count * sizeof(int16_t)) == 0);
+		}
+
+		for (unsigned j = 0; j < output_max; j++) {
+			actuator_controls[j] = 2.0f * rand() / (float)RAND_MAX - 1.0f;
+		}
+
+		unsigned compiled_mixed = compiled_group.mix(&compiled_outputs[0], output_max);
+		unsigned text_mixed = text_group.mix(&text_outputs[0], output_max);
+
+		ut_compare("check number of compiled outputs", compiled_mixed, text_mixed);
+		ut_assert("check compiled outputs", memcmp(compiled_outputs, text_outputs, text_mixed * sizeof(float)) == 0);
+		ut_compare("check compiled saturation status", compiled_group.get_saturation_status(),
+			   text_group.get_saturation_status());
+	}
+
 	return true;
 }
 
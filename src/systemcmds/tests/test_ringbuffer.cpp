@@ -0,0 +1,256 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2018 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file test_ringbuffer.cpp
+ * Tests for the single producer single consumer ringbuffer, including a
+ * stress test with the producer and consumer on separate threads.
+ */
+
+#include <unit_test.h>
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <lib/drivers/device/spsc_ringbuffer.h>
+
+namespace
+{
+
+struct Item {
+	uint32_t seq;
+	uint32_t check;		// ~seq, detects torn items
+	uint64_t payload;	// seq * 3, makes the item span several words
+};
+
+static constexpr unsigned STRESS_ITEMS = 200000;
+static constexpr unsigned STRESS_BATCH = 16;
+
+static void fill(Item &item, uint32_t seq)
+{
+	item.seq = seq;
+	item.check = ~seq;
+	item.payload = (uint64_t)seq * 3;
+}
+
+static bool valid(const Item &item, uint32_t seq)
+{
+	return item.seq == seq && item.check == ~seq && item.payload == (uint64_t)seq * 3;
+}
+
+static void *stress_producer(void *arg)
+{
+	ringbuffer::SPSCRingBuffer *rb = static_cast<ringbuffer::SPSCRingBuffer *>(arg);
+	Item batch[STRESS_BATCH];
+	uint32_t seq = 0;
+
+	while (seq < STRESS_ITEMS) {
+		// alternate between single puts and batches of random size
+		unsigned n = (rand() % STRESS_BATCH) + 1;
+
+		if (n > STRESS_ITEMS - seq) {
+			n = STRESS_ITEMS - seq;
+		}
+
+		for (unsigned i = 0; i < n; i++) {
+			fill(batch[i], seq + i);
+		}
+
+		unsigned put = (n == 1) ? (rb->put(&batch[0]) ? 1 : 0) : rb->put_n(batch, n);
+
+		seq += put;
+
+		if (put < n) {
+			// full, let the consumer catch up
+			sched_yield();
+		}
+	}
+
+	return nullptr;
+}
+
+} // namespace
+
+class RingBufferTest : public UnitTest
+{
+public:
+	virtual bool run_tests();
+
+private:
+	bool spsc_basic();
+	bool spsc_wrap_around();
+	bool spsc_stress();
+};
+
+bool RingBufferTest::run_tests()
+{
+	ut_run_test(spsc_basic);
+	ut_run_test(spsc_wrap_around);
+	ut_run_test(spsc_stress);
+
+	return (_tests_failed == 0);
+}
+
+bool RingBufferTest::spsc_basic()
+{
+	ringbuffer::SPSCRingBuffer rb(4, sizeof(Item));
+	Item item;
+
+	ut_compare("size", rb.size(), 4);
+	ut_assert_true(rb.empty());
+	ut_assert_false(rb.get(&item));
+
+	for (uint32_t i = 0; i < 4; i++) {
+		fill(item, i);
+		ut_assert_true(rb.put(&item));
+	}
+
+	ut_assert_true(rb.full());
+	ut_compare("space", rb.space(), 0);
+	ut_compare("count", rb.count(), 4);
+
+	fill(item, 4);
+	ut_assert_false(rb.put(&item));
+
+	for (uint32_t i = 0; i < 4; i++) {
+		ut_assert_true(rb.get(&item));
+		ut_assert_true(valid(item, i));
+	}
+
+	ut_assert_true(rb.empty());
+
+	// partial transfers when the buffer fills up or runs empty
+	Item items[6];
+
+	for (uint32_t i = 0; i < 6; i++) {
+		fill(items[i], i);
+	}
+
+	ut_compare("put_n partial", rb.put_n(items, 6), 4);
+
+	memset(items, 0, sizeof(items));
+	ut_compare("get_n partial", rb.get_n(items, 6), 4);
+
+	for (uint32_t i = 0; i < 4; i++) {
+		ut_assert_true(valid(items[i], i));
+	}
+
+	rb.put_n(items, 3);
+	rb.flush();
+	ut_assert_true(rb.empty());
+
+	return true;
+}
+
+bool RingBufferTest::spsc_wrap_around()
+{
+	ringbuffer::SPSCRingBuffer rb(7, sizeof(Item));
+	Item in[5];
+	Item out[5];
+	uint32_t put_seq = 0;
+	uint32_t get_seq = 0;
+
+	// batches not matching the buffer size end up split at every position
+	for (int round = 0; round < 50; round++) {
+		for (unsigned i = 0; i < 5; i++) {
+			fill(in[i], put_seq + i);
+		}
+
+		ut_compare("put_n", rb.put_n(in, 5), 5);
+		put_seq += 5;
+
+		ut_compare("get_n", rb.get_n(out, 5), 5);
+
+		for (unsigned i = 0; i < 5; i++) {
+			ut_assert_true(valid(out[i], get_seq + i));
+		}
+
+		get_seq += 5;
+		ut_assert_true(rb.empty());
+	}
+
+	return true;
+}
+
+bool RingBufferTest::spsc_stress()
+{
+	// small buffer so the producer and consumer keep running into each other
+	ringbuffer::SPSCRingBuffer rb(STRESS_BATCH * 2, sizeof(Item));
+
+	pthread_t producer;
+	ut_assert("producer start", pthread_create(&producer, nullptr, stress_producer, &rb) == 0);
+
+	Item batch[STRESS_BATCH];
+	uint32_t seq = 0;
+	bool ok = true;
+
+	while (seq < STRESS_ITEMS && ok) {
+		unsigned n = (rand() % STRESS_BATCH) + 1;
+		unsigned got = (n == 1) ? (rb.get(&batch[0]) ? 1 : 0) : rb.get_n(batch, n);
+
+		for (unsigned i = 0; i < got; i++) {
+			if (!valid(batch[i], seq + i)) {
+				PX4_ERR("item %u invalid: seq %u", seq + i, batch[i].seq);
+				ok = false;
+				break;
+			}
+		}
+
+		seq += got;
+
+		if (got == 0) {
+			sched_yield();
+		}
+	}
+
+	// on failure drain the rest, so the producer can finish
+	while (seq < STRESS_ITEMS) {
+		const unsigned got = rb.get_n(nullptr, STRESS_BATCH);
+		seq += got;
+
+		if (got == 0) {
+			sched_yield();
+		}
+	}
+
+	pthread_join(producer, nullptr);
+
+	ut_assert("all items in order", ok);
+	ut_assert_true(rb.empty());
+
+	return true;
+}
+
+ut_declare_test_c(test_ringbuffer, RingBufferTest)
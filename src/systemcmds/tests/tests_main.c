@@ -87,6 +87,7 @@ const struct {
 	{"uart_break",		test_uart_break,	OPT_NOJIGTEST | OPT_NOALLTEST},
 	{"uart_console",	test_uart_console,	OPT_NOJIGTEST | OPT_NOALLTEST},
 #else
+	{"gps",			gps_tests_main,	OPT_NOJIGTEST | OPT_NOALLTEST},
 	{"rc",			rc_tests_main,	0},
 #endif /* __PX4_NUTTX */
 
@@ -114,9 +115,18 @@ const struct {
 	{"jig_voltages",	test_jig_voltages,	OPT_NOALLTEST},
 	{"mathlib",		test_mathlib,	0},
 	{"matrix",		test_matrix,	0},
+	{"microbench",			test_microbench,	OPT_NOJIGTEST | OPT_NOALLTEST},
+	{"microbench_covariance",	test_microbench_covariance,	0},
+	{"microbench_dataman",		test_microbench_dataman,	OPT_NOJIGTEST | OPT_NOALLTEST},
+	{"microbench_filter",		test_microbench_filter,	0},
 	{"microbench_hrt",		test_microbench_hrt,	0},
 	{"microbench_math",		test_microbench_math,	0},
 	{"microbench_matrix",		test_microbench_matrix,	0},
+	{"microbench_mixer",		test_microbench_mixer,	0},
+	{"microbench_param",		test_microbench_param,	0},
+	{"microbench_perf",		test_microbench_perf,	0},
+	{"microbench_polyfit",		test_microbench_polyfit,	0},
+	{"microbench_poll",		test_microbench_poll,	0},
 	{"microbench_uorb",		test_microbench_uorb,	0},
 	{"mount",		test_mount,	OPT_NOJIGTEST | OPT_NOALLTEST},
 	{"param",		test_param,	0},
@@ -125,6 +135,7 @@ const struct {
 	{"ppm",			test_ppm,	OPT_NOJIGTEST | OPT_NOALLTEST},
 	{"ppm_loopback",	test_ppm_loopback,	OPT_NOALLTEST},
 	{"rc",			test_rc,	OPT_NOJIGTEST | OPT_NOALLTEST},
+	{"ringbuffer",		test_ringbuffer,	0},
 	{"search_min",	test_search_min, 0},
 	{"servo",		test_servo,	OPT_NOJIGTEST | OPT_NOALLTEST},
 	{"sleep",		test_sleep,	OPT_NOJIGTEST},
@@ -69,9 +69,18 @@ extern int	test_jig_voltages(int argc, char *argv[]);
 extern int	test_led(int argc, char *argv[]);
 extern int	test_mathlib(int argc, char *argv[]);
 extern int	test_matrix(int argc, char *argv[]);
+extern int	test_microbench(int argc, char *argv[]);
+extern int	test_microbench_covariance(int argc, char *argv[]);
+extern int	test_microbench_dataman(int argc, char *argv[]);
+extern int	test_microbench_filter(int argc, char *argv[]);
 extern int	test_microbench_hrt(int argc, char *argv[]);
 extern int	test_microbench_math(int argc, char *argv[]);
 extern int	test_microbench_matrix(int argc, char *argv[]);
+extern int	test_microbench_mixer(int argc, char *argv[]);
+extern int	test_microbench_param(int argc, char *argv[]);
+extern int	test_microbench_perf(int argc, char *argv[]);
+extern int	test_microbench_polyfit(int argc, char *argv[]);
+extern int	test_microbench_poll(int argc, char *argv[]);
 extern int	test_microbench_uorb(int argc, char *argv[]);
 extern int	test_mixer(int argc, char *argv[]);
 extern int	test_mount(int argc, char *argv[]);
@@ -80,6 +89,7 @@ extern int	test_perf(int argc, char *argv[]);
 extern int	test_ppm(int argc, char *argv[]);
 extern int	test_ppm_loopback(int argc, char *argv[]);
 extern int	test_rc(int argc, char *argv[]);
+extern int	test_ringbuffer(int argc, char *argv[]);
 extern int	test_search_min(int argc, char *argv[]);
 extern int	test_sensors(int argc, char *argv[]);
 extern int	test_servo(int argc, char *argv[]);
@@ -101,6 +111,7 @@ extern int commander_tests_main(int argc, char *argv[]);
 extern int mavlink_tests_main(int argc, char *argv[]);
 extern int controllib_test_main(int argc, char *argv[]);
 extern int uorb_tests_main(int argc, char *argv[]);
+extern int gps_tests_main(int argc, char *argv[]);
 extern int rc_tests_main(int argc, char *argv[]);
 extern int sf0x_tests_main(int argc, char *argv[]);
 
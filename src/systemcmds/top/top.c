@@ -60,28 +60,41 @@ __EXPORT int top_main(int argc, char *argv[]);
 
 static void print_usage(void)
 {
-	PRINT_MODULE_DESCRIPTION("Monitor running processes and their CPU, stack usage, priority and state");
+	PRINT_MODULE_DESCRIPTION("Monitor running processes and their CPU, stack usage, priority and state.\n"
+				 "On Linux, all threads are listed sorted by CPU usage, with their wakeup and preemption rates "
+				 "and the mean time from being ready to running (scheduling latency)");
 
 	PRINT_MODULE_USAGE_NAME_SIMPLE("top", "command");
 	PRINT_MODULE_USAGE_COMMAND_DESCR("once", "print load only once");
+	PRINT_MODULE_USAGE_PARAM_FLAG('j', "print load once as JSON (Linux only)", true);
 }
 
-int
-top_main(int argc, char *argv[])
+static int
+top_run(int argc, char *argv[], hrt_abstime curr_time, struct print_load_s *load)
 {
-	hrt_abstime curr_time = hrt_absolute_time();
+#ifndef __PX4_NUTTX
 
-	struct print_load_s load;
-	init_print_load_s(curr_time, &load);
+	if (argc > 1 && !strcmp(argv[1], "-j")) {
+		if (print_load_json(curr_time, 1, load) < 0) {
+			PX4_ERR("not supported on this platform");
+			return 1;
+		}
+
+		px4_sleep(1);
+		print_load_json(hrt_absolute_time(), 1, load);
+		return 0;
+	}
+
+#endif
 
 	/* clear screen */
 	dprintf(1, "\033[2J\n");
 
 	if (argc > 1) {
 		if (!strcmp(argv[1], "once")) {
-			print_load(curr_time, 1, &load);
+			print_load(curr_time, 1, load);
 			px4_sleep(1);
-			print_load(hrt_absolute_time(), 1, &load);
+			print_load(hrt_absolute_time(), 1, load);
 
 		} else {
 			print_usage();
@@ -91,7 +104,7 @@ top_main(int argc, char *argv[])
 	}
 
 	for (;;) {
-		print_load(curr_time, 1, &load);
+		print_load(curr_time, 1, load);
 
 		/* Sleep 200 ms waiting for user input five times ~ 1s */
 		for (int k = 0; k < 5; k++) {
@@ -129,3 +142,17 @@ top_main(int argc, char *argv[])
 
 	return 0;
 }
+
+int
+top_main(int argc, char *argv[])
+{
+	hrt_abstime curr_time = hrt_absolute_time();
+
+	struct print_load_s load;
+	init_print_load_s(curr_time, &load);
+
+	int ret = top_run(argc, argv, curr_time, &load);
+
+	deinit_print_load_s(&load);
+	return ret;
+}